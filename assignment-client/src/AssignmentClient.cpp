@@ -13,7 +13,9 @@
 
 #include <assert.h>
 
+#include <QDir>
 #include <QProcess>
+#include <QProcessEnvironment>
 #include <QSharedMemory>
 #include <QThread>
 #include <QTimer>
@@ -31,6 +33,7 @@
 #include <ShutdownEventListener.h>
 
 #include <Trace.h>
+#include <TraceRecorder.h>
 #include <StatTracker.h>
 
 #include "AssignmentClientLogging.h"
@@ -39,6 +42,8 @@
 
 const QString ASSIGNMENT_CLIENT_TARGET_NAME = "assignment-client";
 const long long ASSIGNMENT_REQUEST_INTERVAL_MSECS = 1 * 1000;
+const QString FLIGHT_RECORDER_THRESHOLD_ENV = "HIFI_FLIGHT_RECORDER_THRESHOLD_MSECS";
+const QString FLIGHT_RECORDER_DIRECTORY_ENV = "HIFI_FLIGHT_RECORDER_DIRECTORY";
 
 AssignmentClient::AssignmentClient(Assignment::Type requestAssignmentType, QString assignmentPool,
                                    quint16 listenPort, QUuid walletUUID, QString assignmentServerHostname,
@@ -49,6 +54,18 @@ AssignmentClient::AssignmentClient(Assignment::Type requestAssignmentType, QStri
 
     DependencyManager::set<tracing::Tracer>();
     DependencyManager::set<StatTracker>();
+
+    // keep the last few seconds of trace events, and dump them whenever a mixer frame runs past the threshold
+    auto environment = QProcessEnvironment::systemEnvironment();
+    int frameTimeThresholdMsecs = environment.value(FLIGHT_RECORDER_THRESHOLD_ENV).toInt();
+    if (frameTimeThresholdMsecs > 0) {
+        QString directory = environment.value(FLIGHT_RECORDER_DIRECTORY_ENV, QDir::tempPath());
+        tracing::TraceRecorder::setFrameTimeThreshold(std::chrono::milliseconds(frameTimeThresholdMsecs), directory);
+        tracing::TraceRecorder::startRecording();
+        qCDebug(assignment_client) << "Dumping trace recordings of frames longer than" << frameTimeThresholdMsecs
+            << "ms to" << directory;
+    }
+
     DependencyManager::set<AccountManager>();
     DependencyManager::set<ResourceRequestObserver>();
 
@@ -64,6 +81,9 @@ AssignmentClient::AssignmentClient(Assignment::Type requestAssignmentType, QStri
     // make sure we output process IDs for a child AC otherwise it's insane to parse
     LogHandler::getInstance().setShouldOutputProcessID(true);
 
+    // keep mixer and network threads from stalling on stdout when they log under load
+    LogHandler::getInstance().setAsynchronous(true);
+
     // setup our _requestAssignment member variable from the passed arguments
     _requestAssignment = Assignment(Assignment::RequestCommand, requestAssignmentType, assignmentPool);
 
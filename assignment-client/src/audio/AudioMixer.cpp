@@ -25,6 +25,7 @@
 #include <OctreeConstants.h>
 #include <plugins/PluginManager.h>
 #include <plugins/CodecPlugin.h>
+#include <Profile.h>
 #include <udt/PacketHeaders.h>
 #include <SharedUtil.h>
 #include <StDev.h>
@@ -332,6 +333,20 @@ void AudioMixer::sendStatsPacket() {
 
     statsObject["mix_stats"] = mixStats;
 
+    // scheduling stats
+    QJsonObject schedulingStats;
+
+    // how much longer than the average slave the busiest slave mixed, 0% being perfectly balanced
+    float averageSlaveMixTime = (float)_stats.slaveMixTime / (float)_slavePool.numThreads();
+    schedulingStats["slave_imbalance_%"] = (averageSlaveMixTime > 0.0f) ?
+        QString::number(((float)_stats.slowestSlaveMixTime / averageSlaveMixTime - 1.0f) * 100.0f, 'f', 2) : QString("0.0");
+    schedulingStats["us_per_slowest_slave_mix"] = (qint64)(_stats.slowestSlaveMixTime / NSECS_PER_USEC / _numStatFrames);
+    schedulingStats["us_per_average_slave_mix"] = (qint64)(averageSlaveMixTime / NSECS_PER_USEC / _numStatFrames);
+    schedulingStats["stolen_listeners_per_frame"] = (float)_stats.stolenListeners / (float)_numStatFrames;
+    schedulingStats["pinned_threads"] = _pinSlaveThreads;
+
+    statsObject["scheduling_stats"] = schedulingStats;
+
     _numStatFrames = _numSilentPackets = 0;
     _stats.reset();
 
@@ -413,13 +428,16 @@ void AudioMixer::start() {
         } else {
             auto timer = _checkTimeTiming.timer();
             auto frameDuration = timeFrame();
+            tracing::TraceRecorder::checkFrameTime("audio-mixer", frameDuration);
             throttle(frameDuration, frame);
         }
 
         auto frameTimer = _frameTiming.timer();
+        PROFILE_RANGE(mixer, "AudioMixerFrame");
 
         // process (node-isolated) audio packets across slave threads
         {
+            PROFILE_RANGE(mixer, "ProcessPackets");
             auto packetsTimer = _packetsTiming.timer();
 
             // first clear the concurrent vector of added streams that the slaves will add to when they process packets
@@ -432,6 +450,7 @@ void AudioMixer::start() {
 
         // process queued events (networking, global audio packets, &c.)
         {
+            PROFILE_RANGE(mixer, "ProcessEvents");
             auto eventsTimer = _eventsTiming.timer();
 
             // clear removed nodes and removed streams before we process events that will setup the new set
@@ -449,15 +468,19 @@ void AudioMixer::start() {
         }
         nodeList->nestedEach([&](NodeList::const_iterator cbegin, NodeList::const_iterator cend) {
             // mix across slave threads
+            PROFILE_RANGE(mixer, "Mix");
             auto mixTimer = _mixTiming.timer();
             _slavePool.mix(cbegin, cend, frame, numToRetain);
         });
 
         // gather stats
+        uint64_t slowestSlaveMixTime = 0;
         _slavePool.each([&](AudioMixerSlave& slave) {
+            slowestSlaveMixTime = std::max(slowestSlaveMixTime, slave.stats.slaveMixTime);
             _stats.accumulate(slave.stats);
             slave.stats.reset();
         });
+        _stats.slowestSlaveMixTime += slowestSlaveMixTime;
 
         ++frame;
         ++_numStatFrames;
@@ -560,6 +583,10 @@ void AudioMixer::parseSettingsObject(const QJsonObject& settingsObject) {
             }
         }
 
+        const QString PIN_THREADS_KEY = "pin_threads";
+        _pinSlaveThreads = audioThreadingGroupObject[PIN_THREADS_KEY].toBool();
+        _slavePool.setPinThreads(_pinSlaveThreads);
+
         const QString THROTTLE_START_KEY = "throttle_start";
         const QString THROTTLE_BACKOFF_KEY = "throttle_backoff";
 
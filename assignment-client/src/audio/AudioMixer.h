@@ -148,6 +148,8 @@ private:
     static std::vector<ZoneSettings> _zoneSettings;
     static std::vector<ReverbSettings> _zoneReverbSettings;
 
+    bool _pinSlaveThreads { false };
+
     float _throttleStartTarget = 0.9f;
     float _throttleBackoffTarget = 0.44f;
 
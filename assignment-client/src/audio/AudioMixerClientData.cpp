@@ -564,6 +564,14 @@ bool AudioMixerClientData::shouldSendStats(int frameNumber) {
     return frameNumber == _frameToSendStats;
 }
 
+uint64_t AudioMixerClientData::getPredictedMixCost() const {
+    // rough cost of rendering one HRTF stream, so that listeners whose stream count jumped since their last mix
+    // (or that were never timed) are not scheduled as if they were cheap
+    static const uint64_t ESTIMATED_NSECS_PER_ACTIVE_STREAM = 2000;
+    uint64_t estimatedMixTime = (uint64_t)(_lastNumActiveStreams + 1) * ESTIMATED_NSECS_PER_ACTIVE_STREAM;
+    return std::max(_lastMixTime, estimatedMixTime);
+}
+
 void AudioMixerClientData::sendAudioStreamStatsPackets(const SharedNodePointer& destinationNode) {
 
     auto nodeList = DependencyManager::get<NodeList>();
@@ -157,6 +157,13 @@ public:
     bool getHasReceivedFirstMix() const { return _hasReceivedFirstMix; }
     void setHasReceivedFirstMix(bool hasReceivedFirstMix) { _hasReceivedFirstMix = hasReceivedFirstMix; }
 
+    // cost of the last mix for this listener, used by the AudioMixerSlavePool to schedule the next one
+    void setLastMixCost(uint64_t mixTime, int numActiveStreams) {
+        _lastMixTime = mixTime;
+        _lastNumActiveStreams = numActiveStreams;
+    }
+    uint64_t getPredictedMixCost() const;
+
     // end of methods called non-concurrently from single AudioMixerSlave
 
 signals:
@@ -216,6 +223,9 @@ private:
     std::vector<QUuid> _soloedNodes;
 
     bool _hasReceivedFirstMix { false };
+
+    uint64_t _lastMixTime { 0 }; // in ns
+    int _lastNumActiveStreams { 0 };
 };
 
 #endif // hifi_AudioMixerClientData_h
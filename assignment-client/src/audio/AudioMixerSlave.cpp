@@ -24,6 +24,7 @@
 #include <OctreeConstants.h>
 #include <plugins/PluginManager.h>
 #include <plugins/CodecPlugin.h>
+#include <PortableHighResolutionClock.h>
 #include <udt/PacketHeaders.h>
 #include <SharedUtil.h>
 #include <StDev.h>
@@ -94,6 +95,7 @@ void AudioMixerSlave::mix(const SharedNodePointer& node) {
 
     // send audio packets, if necessary
     if (node->getType() == NodeType::Agent && node->getActiveSocket()) {
+        auto mixStart = p_high_resolution_clock::now();
         ++stats.sumListeners;
 
         // mix the audio
@@ -125,6 +127,11 @@ void AudioMixerSlave::mix(const SharedNodePointer& node) {
         if (data->shouldSendStats(_frame % NUM_FRAMES_PER_SEC)) {
             data->sendAudioStreamStatsPackets(node);
         }
+
+        // record the cost of this listener to schedule its next mix
+        auto mixTime = std::chrono::duration_cast<std::chrono::nanoseconds>(p_high_resolution_clock::now() - mixStart);
+        data->setLastMixCost(mixTime.count(), (int)data->getStreams().active.size());
+        stats.slaveMixTime += mixTime.count();
     }
 }
 
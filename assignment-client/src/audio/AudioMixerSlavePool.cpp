@@ -13,14 +13,17 @@
 
 #include <assert.h>
 #include <algorithm>
+#include <iterator>
+
+#include <SharedUtil.h>
 
 void AudioMixerSlaveThread::run() {
     while (true) {
         wait();
 
-        // iterate over all available nodes
+        // iterate over all available nodes, then help the other slaves
         SharedNodePointer node;
-        while (try_pop(node)) {
+        while (try_pop(node) || (steal() && try_pop(node))) {
             (this->*_function)(node);
         }
 
@@ -42,6 +45,24 @@ void AudioMixerSlaveThread::wait() {
         ++_pool._numStarted;
     }
 
+    if (_pool._pinThreads && _pinnedCore == -1) {
+        int numCores = std::max(1, QThread::idealThreadCount());
+        int core = _index % numCores;
+        if (setCurrentThreadAffinity(core)) {
+            _pinnedCore = core;
+        } else {
+            qWarning("%s: could not pin slave %d to core %d", __FUNCTION__, _index, core);
+            // don't retry every frame
+            _pinnedCore = numCores;
+        }
+    } else if (!_pool._pinThreads && _pinnedCore != -1) {
+        // pin_threads was turned off
+        if (_pinnedCore < QThread::idealThreadCount() && !clearCurrentThreadAffinity()) {
+            qWarning("%s: could not unpin slave %d from core %d", __FUNCTION__, _index, _pinnedCore);
+        }
+        _pinnedCore = -1;
+    }
+
     if (_pool._configure) {
         _pool._configure(*this);
     }
@@ -61,17 +82,63 @@ void AudioMixerSlaveThread::notify(bool stopping) {
 }
 
 bool AudioMixerSlaveThread::try_pop(SharedNodePointer& node) {
-    return _pool._queue.try_pop(node);
+    Lock lock(_jobsMutex);
+    if (_jobsFront == _jobs.size()) {
+        return false;
+    }
+    node = std::move(_jobs[_jobsFront++]);
+    return true;
+}
+
+bool AudioMixerSlaveThread::steal() {
+    std::vector<SharedNodePointer> stolen;
+
+    int numSlaves = (int)_pool._slaves.size();
+    for (int i = 1; i < numSlaves && stolen.empty(); ++i) {
+        auto& victim = *_pool._slaves[(_index + i) % numSlaves];
+
+        Lock victimLock(victim._jobsMutex);
+        size_t remaining = victim._jobs.size() - victim._jobsFront;
+        if (remaining == 0) {
+            continue;
+        }
+
+        // take the lighter half, the victim keeps going through its heaviest work
+        size_t chunk = (remaining + 1) / 2;
+        auto chunkBegin = victim._jobs.end() - chunk;
+        stolen.assign(std::make_move_iterator(chunkBegin), std::make_move_iterator(victim._jobs.end()));
+        victim._jobs.erase(chunkBegin, victim._jobs.end());
+    }
+
+    if (stolen.empty()) {
+        return false;
+    }
+
+    stats.stolenListeners += (int)stolen.size();
+
+    Lock lock(_jobsMutex);
+    _jobs = std::move(stolen);
+    _jobsFront = 0;
+    return true;
 }
 
 #ifdef AUDIO_SINGLE_THREADED
 static AudioMixerSlave slave;
 #endif
 
+static uint64_t uniformCost(const SharedNodePointer& node) {
+    return 1;
+}
+
+static uint64_t predictedMixCost(const SharedNodePointer& node) {
+    AudioMixerClientData* data = (AudioMixerClientData*)node->getLinkedData();
+    return data ? data->getPredictedMixCost() : 0;
+}
+
 void AudioMixerSlavePool::processPackets(ConstIter begin, ConstIter end) {
     _function = &AudioMixerSlave::processPackets;
     _configure = [](AudioMixerSlave& slave) {};
-    run(begin, end);
+    run(begin, end, &uniformCost);
 }
 
 void AudioMixerSlavePool::mix(ConstIter begin, ConstIter end, unsigned int frame, int numToRetain) {
@@ -80,10 +147,38 @@ void AudioMixerSlavePool::mix(ConstIter begin, ConstIter end, unsigned int frame
         slave.configureMix(_begin, _end, frame, numToRetain);
     };
 
-    run(begin, end);
+    run(begin, end, &predictedMixCost);
+}
+
+void AudioMixerSlavePool::distribute(ConstIter begin, ConstIter end, CostFunction cost) {
+    _jobs.clear();
+    std::for_each(begin, end, [&](const SharedNodePointer& node) {
+        _jobs.push_back({ node, cost(node) });
+    });
+
+    // heaviest first, so that the longest mixes start early and the light tail evens out the slaves
+    std::stable_sort(_jobs.begin(), _jobs.end(), [](const Job& a, const Job& b) {
+        return a.cost > b.cost;
+    });
+
+    for (auto& slave : _slaves) {
+        slave->_jobs.clear();
+        slave->_jobsFront = 0;
+        slave->_predictedCost = 0;
+    }
+
+    // greedily hand each job to the least loaded slave
+    for (auto& job : _jobs) {
+        auto leastLoaded = std::min_element(_slaves.begin(), _slaves.end(), [](const auto& a, const auto& b) {
+            return a->_predictedCost < b->_predictedCost;
+        });
+        (*leastLoaded)->_predictedCost += job.cost;
+        (*leastLoaded)->_jobs.push_back(std::move(job.node));
+    }
+    _jobs.clear();
 }
 
-void AudioMixerSlavePool::run(ConstIter begin, ConstIter end) {
+void AudioMixerSlavePool::run(ConstIter begin, ConstIter end, CostFunction cost) {
     _begin = begin;
     _end = end;
 
@@ -93,14 +188,8 @@ void AudioMixerSlavePool::run(ConstIter begin, ConstIter end) {
         _function(slave, node);
     });
 #else
-    // fill the queue
-    std::for_each(_begin, _end, [&](const SharedNodePointer& node) {
-#if defined(__clang__) && defined(Q_OS_LINUX)
-        _queue.push(node);
-#else
-        _queue.emplace(node);
-#endif
-    });
+    // fill the per-slave deques
+    distribute(_begin, _end, cost);
 
     {
         Lock lock(_mutex);
@@ -118,7 +207,9 @@ void AudioMixerSlavePool::run(ConstIter begin, ConstIter end) {
         assert(_numStarted == _numThreads);
     }
 
-    assert(_queue.empty());
+    assert(std::all_of(_slaves.begin(), _slaves.end(), [](const auto& slave) {
+        return slave->_jobsFront == slave->_jobs.size();
+    }));
 #endif
 }
 
@@ -165,7 +256,7 @@ void AudioMixerSlavePool::resize(int numThreads) {
     if (numThreads > _numThreads) {
         // start new slaves
         for (int i = 0; i < numThreads - _numThreads; ++i) {
-            auto slave = new AudioMixerSlaveThread(*this, _workerSharedData);
+            auto slave = new AudioMixerSlaveThread(*this, _workerSharedData, (int)_slaves.size());
             slave->start();
             _slaves.emplace_back(slave);
         }
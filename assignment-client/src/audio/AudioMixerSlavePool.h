@@ -12,14 +12,13 @@
 #ifndef hifi_AudioMixerSlavePool_h
 #define hifi_AudioMixerSlavePool_h
 
+#include <atomic>
 #include <condition_variable>
 #include <mutex>
 #include <vector>
 
 #include <QThread>
 
-#include <TBBHelpers.h>
-
 #include "AudioMixerSlave.h"
 
 class AudioMixerSlavePool;
@@ -31,8 +30,8 @@ class AudioMixerSlaveThread : public QThread, public AudioMixerSlave {
     using Lock = std::unique_lock<Mutex>;
 
 public:
-    AudioMixerSlaveThread(AudioMixerSlavePool& pool, AudioMixerSlave::SharedData& sharedData)
-        : AudioMixerSlave(sharedData), _pool(pool) {}
+    AudioMixerSlaveThread(AudioMixerSlavePool& pool, AudioMixerSlave::SharedData& sharedData, int index)
+        : AudioMixerSlave(sharedData), _pool(pool), _index(index) {}
 
     void run() override final;
 
@@ -43,15 +42,30 @@ private:
     void notify(bool stopping);
     bool try_pop(SharedNodePointer& node);
 
+    // take a chunk of the remaining (lightest) work from the back of another slave's deque
+    bool steal();
+
     AudioMixerSlavePool& _pool;
     void (AudioMixerSlave::*_function)(const SharedNodePointer& node) { nullptr };
     bool _stop { false };
+
+    // work for this frame, heaviest first; popped from the front by this slave, stolen from the back by others
+    Mutex _jobsMutex;
+    std::vector<SharedNodePointer> _jobs; // guarded by _jobsMutex
+    size_t _jobsFront { 0 }; // guarded by _jobsMutex
+    uint64_t _predictedCost { 0 }; // only used while distributing work
+
+    const int _index;
+    int _pinnedCore { -1 };
 };
 
 // Slave pool for audio mixers
 //   AudioMixerSlavePool is not thread-safe! It should be instantiated and used from a single thread.
+//
+//   Work is scheduled by predicted cost: listeners are sorted heaviest-first using the cost of their previous mix,
+//   then greedily assigned to the least loaded slave. Each slave works through its own deque front to back, and
+//   steals chunks from the back of the other slaves' deques once it runs dry.
 class AudioMixerSlavePool {
-    using Queue = tbb::concurrent_queue<SharedNodePointer>;
     using Mutex = std::mutex;
     using Lock = std::unique_lock<Mutex>;
     using ConditionVariable = std::condition_variable;
@@ -75,8 +89,14 @@ public:
     void setNumThreads(int numThreads);
     int numThreads() { return _numThreads; }
 
+    // pin each slave thread to its own core, applied on the next frame
+    void setPinThreads(bool pinThreads) { _pinThreads = pinThreads; }
+
 private:
-    void run(ConstIter begin, ConstIter end);
+    using CostFunction = uint64_t(*)(const SharedNodePointer& node);
+
+    void run(ConstIter begin, ConstIter end, CostFunction cost);
+    void distribute(ConstIter begin, ConstIter end, CostFunction cost);
     void resize(int numThreads);
 
     std::vector<std::unique_ptr<AudioMixerSlaveThread>> _slaves;
@@ -84,6 +104,7 @@ private:
     friend void AudioMixerSlaveThread::wait();
     friend void AudioMixerSlaveThread::notify(bool stopping);
     friend bool AudioMixerSlaveThread::try_pop(SharedNodePointer& node);
+    friend bool AudioMixerSlaveThread::steal();
 
     // synchronization state
     Mutex _mutex;
@@ -96,8 +117,14 @@ private:
     int _numFinished { 0 }; // guarded by _mutex
     int _numStopped { 0 }; // guarded by _mutex
 
+    std::atomic<bool> _pinThreads { false };
+
     // frame state
-    Queue _queue;
+    struct Job {
+        SharedNodePointer node;
+        uint64_t cost;
+    };
+    std::vector<Job> _jobs;
     ConstIter _begin;
     ConstIter _end;
 
@@ -36,6 +36,10 @@ void AudioMixerStats::reset() {
     inactive = 0;
     active = 0;
 
+    slaveMixTime = 0;
+    slowestSlaveMixTime = 0;
+    stolenListeners = 0;
+
 #ifdef HIFI_AUDIO_MIXER_DEBUG
     mixTime = 0;
 #endif
@@ -66,6 +70,10 @@ void AudioMixerStats::accumulate(const AudioMixerStats& otherStats) {
     inactive += otherStats.inactive;
     active += otherStats.active;
 
+    slaveMixTime += otherStats.slaveMixTime;
+    slowestSlaveMixTime += otherStats.slowestSlaveMixTime;
+    stolenListeners += otherStats.stolenListeners;
+
 #ifdef HIFI_AUDIO_MIXER_DEBUG
     mixTime += otherStats.mixTime;
 #endif
@@ -12,9 +12,7 @@
 #ifndef hifi_AudioMixerStats_h
 #define hifi_AudioMixerStats_h
 
-#ifdef HIFI_AUDIO_MIXER_DEBUG
 #include <cstdint>
-#endif
 
 struct AudioMixerStats {
     int sumStreams { 0 };
@@ -41,6 +39,11 @@ struct AudioMixerStats {
     int inactive { 0 };
     int active { 0 };
 
+    // scheduling, see AudioMixerSlavePool
+    uint64_t slaveMixTime { 0 }; // time slaves spent mixing, in ns
+    uint64_t slowestSlaveMixTime { 0 }; // sum over frames of the busiest slave's mix time, in ns
+    int stolenListeners { 0 };
+
 #ifdef HIFI_AUDIO_MIXER_DEBUG
     uint64_t mixTime { 0 };
 #endif
@@ -28,6 +28,7 @@
 #include <AvatarLogging.h>
 #include <LogHandler.h>
 #include <NodeList.h>
+#include <Profile.h>
 #include <udt/PacketHeaders.h>
 #include <SharedUtil.h>
 #include <UUID.h>
@@ -35,9 +36,6 @@
 
 const QString AVATAR_MIXER_LOGGING_NAME = "avatar-mixer";
 
-// FIXME - what we'd actually like to do is send to users at ~50% of their present rate down to 30hz. Assume 90 for now.
-const int AVATAR_MIXER_BROADCAST_FRAMES_PER_SECOND = 45;
-
 const QRegularExpression AvatarMixer::suffixedNamePattern { R"(^\s*(.+)\s*_(\d)+\s*$)" };
 
 // Lexicographic comparison:
@@ -236,12 +234,16 @@ void AvatarMixer::start() {
     while (!_isFinished) {
 
         auto frameDuration = timeFrame(frameTimestamp); // calculates last frame duration and sleeps remainder of target amount
+        tracing::TraceRecorder::checkFrameTime("avatar-mixer", frameDuration);
         throttle(frameDuration, frame); // determines _throttlingRatio for upcoming mix frame
 
+        PROFILE_RANGE(mixer, "AvatarMixerFrame");
+
         int lockWait, nodeTransform, functor;
 
         // Allow nodes to process any pending/queued packets across our worker threads
         {
+            PROFILE_RANGE(mixer, "ProcessIncomingPackets");
             auto start = usecTimestampNow();
 
             nodeList->nestedEach([&](NodeList::const_iterator cbegin, NodeList::const_iterator cend) {
@@ -273,6 +275,7 @@ void AvatarMixer::start() {
 
         // this is where we need to put the real work...
         {
+            PROFILE_RANGE(mixer, "BroadcastAvatarData");
             auto start = usecTimestampNow();
             nodeList->nestedEach([&](NodeList::const_iterator cbegin, NodeList::const_iterator cend) {
                 auto start = usecTimestampNow();
@@ -295,6 +298,7 @@ void AvatarMixer::start() {
         // play nice with qt event-looping
         {
             // since we're a while loop we need to yield to qt's event processing
+            PROFILE_RANGE(mixer, "ProcessEvents");
             auto start = usecTimestampNow();
             QCoreApplication::processEvents();
             if (_isFinished) {
@@ -256,8 +256,6 @@ int AvatarMixerSlave::sendReplicatedIdentityPacket(const Node& agentNode, const
     }
 }
 
-static const int AVATAR_MIXER_BROADCAST_FRAMES_PER_SECOND = 45;
-
 void AvatarMixerSlave::broadcastAvatarData(const SharedNodePointer& node) {
     quint64 start = usecTimestampNow();
 
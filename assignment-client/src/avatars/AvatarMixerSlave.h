@@ -16,6 +16,9 @@
 
 class AvatarMixerClientData;
 
+// how many times a second the avatar mixer broadcasts avatar data to each agent
+const int AVATAR_MIXER_BROADCAST_FRAMES_PER_SECOND = 45;
+
 class AvatarMixerSlaveStats {
 public:
     int nodesProcessed { 0 };
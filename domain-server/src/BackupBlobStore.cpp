@@ -0,0 +1,380 @@
+//
+//  BackupBlobStore.cpp
+//  domain-server/src
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "BackupBlobStore.h"
+
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QtCore/QLoggingCategory>
+
+#if !defined(__clang__) && defined(__GNUC__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wsuggest-override"
+#endif
+
+#include <quazip5/quazip.h>
+#include <quazip5/quazipfile.h>
+
+#if !defined(__clang__) && defined(__GNUC__)
+#pragma GCC diagnostic pop
+#endif
+
+#include <AssetUtils.h>
+
+Q_DECLARE_LOGGING_CATEGORY(backup_blobs)
+Q_LOGGING_CATEGORY(backup_blobs, "hifi.backup-blobs");
+
+const QString BackupBlobStore::MANIFEST_FILENAME { "manifest.json" };
+
+static const QString BLOBS_DIR { "/blobs/" };
+static const QString TEMPORARY_BLOB_SUFFIX { ".part" };
+static const int MANIFEST_VERSION { 1 };
+static const qint64 BLOB_STREAM_CHUNK_SIZE { 1024 * 1024 };
+
+BackupBlobStore::BackupBlobStore(const QString& backupDirectory, bool enabled) :
+    _blobsDirectory(backupDirectory + BLOBS_DIR),
+    _enabled(enabled)
+{
+    // Make sure the blobs directory exists.
+    QDir(_blobsDirectory).mkpath(".");
+}
+
+QString BackupBlobStore::blobPath(const QString& hash) const {
+    return _blobsDirectory + hash;
+}
+
+bool BackupBlobStore::hasBlob(const QString& hash) const {
+    return QFile::exists(blobPath(hash));
+}
+
+bool BackupBlobStore::writeBlob(const QString& hash, const QByteArray& data) {
+    // Write to a temporary file first so that a crash never leaves a truncated blob behind a valid hash.
+    QFile file { blobPath(hash) + TEMPORARY_BLOB_SUFFIX };
+    if (!file.open(QFile::WriteOnly | QFile::Truncate)) {
+        qCCritical(backup_blobs) << "Could not open blob file for write:" << file.fileName();
+        return false;
+    }
+
+    auto bytesWritten = file.write(data);
+    file.close();
+    if (bytesWritten != data.size()) {
+        qCCritical(backup_blobs) << "Could not write data to blob file" << file.fileName();
+        file.remove();
+        return false;
+    }
+
+    if (!file.rename(blobPath(hash))) {
+        qCCritical(backup_blobs) << "Could not move blob file into place:" << file.fileName();
+        file.remove();
+        return false;
+    }
+
+    return true;
+}
+
+QByteArray BackupBlobStore::readBlob(const ManifestEntry& entry, bool& success) const {
+    success = false;
+
+    QFile file { blobPath(entry.hash) };
+    if (!file.open(QFile::ReadOnly)) {
+        qCCritical(backup_blobs) << "Could not open blob file" << file.fileName();
+        return QByteArray();
+    }
+
+    auto data = file.readAll();
+    if (data.size() != entry.size || AssetUtils::hashData(data).toHex() != entry.hash) {
+        qCCritical(backup_blobs) << "Blob file does not match its hash:" << file.fileName();
+        return QByteArray();
+    }
+
+    success = true;
+    return data;
+}
+
+bool BackupBlobStore::addEntry(const QString& entryName, const QByteArray& data) {
+    QString hash = AssetUtils::hashData(data).toHex();
+
+    if (!hasBlob(hash) && !writeBlob(hash, data)) {
+        return false;
+    }
+
+    _pendingManifest[entryName] = { hash, data.size() };
+    return true;
+}
+
+bool BackupBlobStore::addFileEntry(const QString& entryName, const QString& filePath) {
+    QFileInfo fileInfo { filePath };
+    if (!fileInfo.exists()) {
+        return false;
+    }
+
+    // Most of the time the file did not change since the last archive, reuse its hash without touching its content.
+    auto it = _fileHashes.find(filePath);
+    if (it != _fileHashes.end()) {
+        const auto& cached = it->second;
+        if (cached.size == fileInfo.size() && cached.lastModified == fileInfo.lastModified() && hasBlob(cached.hash)) {
+            _pendingManifest[entryName] = { cached.hash, cached.size };
+            return true;
+        }
+    }
+
+    QFile file { filePath };
+    if (!file.open(QIODevice::ReadOnly)) {
+        qCCritical(backup_blobs) << "Could not open file for backup:" << filePath;
+        return false;
+    }
+    auto data = file.readAll();
+    file.close();
+
+    if (!addEntry(entryName, data)) {
+        return false;
+    }
+
+    _fileHashes[filePath] = { data.size(), fileInfo.lastModified(), _pendingManifest[entryName].hash };
+    return true;
+}
+
+bool BackupBlobStore::finishBackup(const QString& backupName, QuaZip& zip) {
+    if (_pendingManifest.empty()) {
+        return true;
+    }
+
+    Manifest manifest;
+    std::swap(manifest, _pendingManifest);
+
+    QJsonObject entriesObject;
+    for (const auto& entry : manifest) {
+        entriesObject.insert(entry.first, QJsonObject {
+            { "hash", entry.second.hash },
+            { "size", entry.second.size }
+        });
+    }
+    QJsonDocument document { QJsonObject {
+        { "version", MANIFEST_VERSION },
+        { "entries", entriesObject }
+    } };
+
+    QuaZipFile zipFile { &zip };
+    if (!zipFile.open(QIODevice::WriteOnly, QuaZipNewInfo(MANIFEST_FILENAME))) {
+        qCCritical(backup_blobs) << "Could not open" << MANIFEST_FILENAME << "for writing in zip:" << zipFile.getZipError();
+        return false;
+    }
+    zipFile.write(document.toJson(QJsonDocument::Compact));
+    zipFile.close();
+    if (zipFile.getZipError() != UNZ_OK) {
+        qCCritical(backup_blobs) << "Could not zip" << MANIFEST_FILENAME << ":" << zipFile.getZipError();
+        return false;
+    }
+
+    addReferences(manifest);
+    _manifests[backupName] = std::move(manifest);
+    return true;
+}
+
+bool BackupBlobStore::readManifest(QuaZip& zip, Manifest& manifest, bool& isCorrupted) {
+    isCorrupted = false;
+
+    if (!zip.setCurrentFile(MANIFEST_FILENAME)) {
+        // Full archive, nothing to reference.
+        return false;
+    }
+
+    QuaZipFile zipFile { &zip };
+    if (!zipFile.open(QFile::ReadOnly)) {
+        qCCritical(backup_blobs) << "Could not unzip" << MANIFEST_FILENAME << ":" << zip.getZipError();
+        isCorrupted = true;
+        return false;
+    }
+
+    QJsonParseError error;
+    auto document = QJsonDocument::fromJson(zipFile.readAll(), &error);
+    zipFile.close();
+    if (document.isNull() || !document.isObject()) {
+        qCCritical(backup_blobs) << "Could not parse" << MANIFEST_FILENAME << ":" << error.errorString();
+        isCorrupted = true;
+        return false;
+    }
+
+    auto root = document.object();
+    if (root["version"].toInt() > MANIFEST_VERSION) {
+        qCCritical(backup_blobs) << "Unsupported manifest version" << root["version"].toInt();
+        isCorrupted = true;
+        return false;
+    }
+
+    auto entriesObject = root["entries"].toObject();
+    for (auto it = entriesObject.begin(); it != entriesObject.end(); ++it) {
+        auto entryObject = it.value().toObject();
+        ManifestEntry entry { entryObject["hash"].toString(), (qint64)entryObject["size"].toDouble() };
+        if (!AssetUtils::isValidHash(entry.hash)) {
+            qCCritical(backup_blobs) << "Corrupted manifest entry:" << it.key();
+            isCorrupted = true;
+            continue;
+        }
+        manifest[it.key()] = entry;
+    }
+
+    return true;
+}
+
+bool BackupBlobStore::readEntry(QuaZip& zip, const QString& entryName, QByteArray& data) const {
+    if (zip.setCurrentFile(entryName)) {
+        QuaZipFile zipFile { &zip };
+        if (!zipFile.open(QIODevice::ReadOnly)) {
+            qCCritical(backup_blobs) << "Failed to open" << entryName << "in backup";
+            return false;
+        }
+        data = zipFile.readAll();
+        zipFile.close();
+        return zipFile.getZipError() == UNZ_OK;
+    }
+
+    Manifest manifest;
+    bool isCorrupted { false };
+    if (!readManifest(zip, manifest, isCorrupted)) {
+        return false;
+    }
+
+    auto it = manifest.find(entryName);
+    if (it == manifest.end()) {
+        return false;
+    }
+
+    bool success { false };
+    data = readBlob(it->second, success);
+    return success;
+}
+
+void BackupBlobStore::addReferences(const Manifest& manifest) {
+    for (const auto& entry : manifest) {
+        ++_referenceCounts[entry.second.hash];
+    }
+}
+
+void BackupBlobStore::removeReferences(const Manifest& manifest) {
+    for (const auto& entry : manifest) {
+        auto it = _referenceCounts.find(entry.second.hash);
+        if (it != _referenceCounts.end() && --it->second <= 0) {
+            _referenceCounts.erase(it);
+        }
+    }
+}
+
+void BackupBlobStore::loadBackup(const QString& backupName, QuaZip& zip) {
+    Manifest manifest;
+    bool isCorrupted { false };
+    if (readManifest(zip, manifest, isCorrupted)) {
+        for (const auto& entry : manifest) {
+            if (!hasBlob(entry.second.hash)) {
+                qCWarning(backup_blobs) << "Backup" << backupName << "references missing blob" << entry.second.hash;
+            }
+        }
+        addReferences(manifest);
+        _manifests[backupName] = std::move(manifest);
+    }
+    _hasCorruptedManifests = _hasCorruptedManifests || isCorrupted;
+}
+
+void BackupBlobStore::loadingComplete() {
+    _loadingComplete = true;
+    collectGarbage();
+}
+
+void BackupBlobStore::deleteBackup(const QString& backupName) {
+    auto it = _manifests.find(backupName);
+    if (it == _manifests.end()) {
+        return;
+    }
+
+    removeReferences(it->second);
+    _manifests.erase(it);
+}
+
+bool BackupBlobStore::consolidateBackup(const QString& backupName, QuaZip& zip) const {
+    auto it = _manifests.find(backupName);
+    if (it == _manifests.end()) {
+        return true;
+    }
+
+    for (const auto& entry : it->second) {
+        QFile blobFile { blobPath(entry.second.hash) };
+        if (!blobFile.open(QFile::ReadOnly)) {
+            qCCritical(backup_blobs) << "Could not open blob file" << blobFile.fileName();
+            return false;
+        }
+
+        QuaZipFile zipFile { &zip };
+        if (!zipFile.open(QIODevice::WriteOnly, QuaZipNewInfo(entry.first))) {
+            qCCritical(backup_blobs) << "Could not open" << entry.first << "for writing in zip:" << zipFile.getZipError();
+            return false;
+        }
+
+        // Stream the blob rather than loading it, content files can be large.
+        QByteArray chunk;
+        while (!(chunk = blobFile.read(BLOB_STREAM_CHUNK_SIZE)).isEmpty()) {
+            if (zipFile.write(chunk) != chunk.size()) {
+                qCCritical(backup_blobs) << "Could not write" << entry.first << "to zip";
+                zipFile.close();
+                return false;
+            }
+        }
+        zipFile.close();
+        if (zipFile.getZipError() != UNZ_OK) {
+            qCCritical(backup_blobs) << "Could not zip" << entry.first << ":" << zipFile.getZipError();
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void BackupBlobStore::collectGarbage() {
+    if (!_loadingComplete) {
+        return;
+    }
+
+    if (_hasCorruptedManifests) {
+        qCWarning(backup_blobs) << "Some backup manifests did not load properly, skipping blob garbage collection for safety.";
+        return;
+    }
+
+    QDir blobsDir { _blobsDirectory };
+    auto blobNames = blobsDir.entryList(QDir::Files);
+
+    int removedBlobs = 0;
+    for (const auto& blobName : blobNames) {
+        bool isTemporary = blobName.endsWith(TEMPORARY_BLOB_SUFFIX);
+        if (!isTemporary && (!AssetUtils::isValidHash(blobName) || _referenceCounts.count(blobName) > 0)) {
+            continue;
+        }
+
+        if (blobsDir.remove(blobName)) {
+            ++removedBlobs;
+        } else {
+            qCWarning(backup_blobs) << "Could not delete blob:" << blobName;
+        }
+    }
+
+    // Forget cached file hashes whose blob is gone so that the next backup writes them again.
+    for (auto it = _fileHashes.begin(); it != _fileHashes.end();) {
+        if (_referenceCounts.count(it->second.hash) == 0 && !hasBlob(it->second.hash)) {
+            it = _fileHashes.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    if (removedBlobs > 0) {
+        qCDebug(backup_blobs) << "Removed" << removedBlobs << "unreferenced backup blob(s)";
+    }
+}
@@ -0,0 +1,108 @@
+//
+//  BackupBlobStore.h
+//  domain-server/src
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_BackupBlobStore_h
+#define hifi_BackupBlobStore_h
+
+#include <map>
+#include <memory>
+#include <unordered_map>
+
+#include <QByteArray>
+#include <QDateTime>
+#include <QString>
+
+#include <RegisteredMetaTypes.h>
+
+class QuaZip;
+
+// Content-addressed storage shared by all incremental content archives.
+//
+// An incremental archive is still a zip in the backup directory, but instead of carrying the full
+// entities and settings payloads it only carries a small manifest that maps each zip entry name to
+// the SHA-256 of its content. The content itself lives once in <backupDirectory>/blobs/<hash>, no
+// matter how many archives reference it. Blobs are reference counted from the manifests that are
+// loaded or written, and blobs that are no longer referenced are removed by collectGarbage().
+//
+// All methods are expected to be called from the DomainContentBackupManager thread.
+class BackupBlobStore {
+public:
+    struct ManifestEntry {
+        QString hash;
+        qint64 size { 0 };
+    };
+    // zip entry name -> blob
+    using Manifest = std::map<QString, ManifestEntry>;
+
+    static const QString MANIFEST_FILENAME;
+
+    BackupBlobStore(const QString& backupDirectory, bool enabled);
+
+    // Whether new archives should be written as manifests (older archives are always readable).
+    bool isEnabled() const { return _enabled; }
+
+    // Stage an entry for the archive currently being created. The content is only written to the blob
+    // directory if no blob with the same hash exists yet.
+    bool addEntry(const QString& entryName, const QByteArray& data);
+
+    // Same as addEntry, but skips reading and hashing the file if its size and modification time
+    // did not change since the last time it was stored.
+    bool addFileEntry(const QString& entryName, const QString& filePath);
+
+    // Write the manifest of the staged entries into the archive and take references on their blobs.
+    // Does nothing if no entries were staged, which leaves a regular full archive.
+    bool finishBackup(const QString& backupName, QuaZip& zip);
+
+    // Read the content of an entry either directly from the archive (full archives) or through its
+    // manifest (incremental archives).
+    bool readEntry(QuaZip& zip, const QString& entryName, QByteArray& data) const;
+
+    void loadBackup(const QString& backupName, QuaZip& zip);
+    void loadingComplete();
+    void deleteBackup(const QString& backupName);
+
+    // Stream every blob referenced by the manifest of backupName into zip under its original entry name,
+    // turning the archive into a full, self-contained one.
+    bool consolidateBackup(const QString& backupName, QuaZip& zip) const;
+
+    // Remove the blobs no archive references anymore.
+    void collectGarbage();
+
+private:
+    struct CachedFileHash {
+        qint64 size { -1 };
+        QDateTime lastModified;
+        QString hash;
+    };
+
+    static bool readManifest(QuaZip& zip, Manifest& manifest, bool& isCorrupted);
+
+    QString blobPath(const QString& hash) const;
+    bool hasBlob(const QString& hash) const;
+    bool writeBlob(const QString& hash, const QByteArray& data);
+    QByteArray readBlob(const ManifestEntry& entry, bool& success) const;
+
+    void addReferences(const Manifest& manifest);
+    void removeReferences(const Manifest& manifest);
+
+    const QString _blobsDirectory;
+    const bool _enabled;
+
+    Manifest _pendingManifest;
+    std::unordered_map<QString, Manifest> _manifests; // backup name -> manifest
+    std::unordered_map<QString, int> _referenceCounts; // blob hash -> number of manifests referencing it
+    std::unordered_map<QString, CachedFileHash> _fileHashes; // file path -> hash of its last stored content
+
+    bool _loadingComplete { false };
+    bool _hasCorruptedManifests { false };
+};
+using BackupBlobStorePointer = std::shared_ptr<BackupBlobStore>;
+
+#endif // hifi_BackupBlobStore_h
@@ -25,8 +25,10 @@
 #endif
 
 
-ContentSettingsBackupHandler::ContentSettingsBackupHandler(DomainServerSettingsManager& domainServerSettingsManager) :
-    _settingsManager(domainServerSettingsManager)
+ContentSettingsBackupHandler::ContentSettingsBackupHandler(DomainServerSettingsManager& domainServerSettingsManager,
+                                                           BackupBlobStorePointer blobStore) :
+    _settingsManager(domainServerSettingsManager),
+    _blobStore(blobStore)
 {
 }
 
@@ -45,6 +47,13 @@ void ContentSettingsBackupHandler::createBackup(const QString& backupName, QuaZi
     // make a QJsonDocument using the object
     QJsonDocument contentSettingsDocument { contentSettingsJSON };
 
+    if (_blobStore->isEnabled()) {
+        if (!_blobStore->addEntry(CONTENT_SETTINGS_BACKUP_FILENAME, contentSettingsDocument.toJson())) {
+            qCritical() << "Failed to store" << CONTENT_SETTINGS_BACKUP_FILENAME << "in backup";
+        }
+        return;
+    }
+
     QuaZipFile zipFile { &zip };
 
     if (zipFile.open(QIODevice::WriteOnly, QuaZipNewInfo(CONTENT_SETTINGS_BACKUP_FILENAME))) {
@@ -63,20 +72,12 @@ void ContentSettingsBackupHandler::createBackup(const QString& backupName, QuaZi
 }
 
 void ContentSettingsBackupHandler::recoverBackup(const QString& backupName, QuaZip& zip) {
-    if (!zip.setCurrentFile(CONTENT_SETTINGS_BACKUP_FILENAME)) {
+    QByteArray rawData;
+    if (!_blobStore->readEntry(zip, CONTENT_SETTINGS_BACKUP_FILENAME, rawData)) {
         qWarning() << "Failed to find" << CONTENT_SETTINGS_BACKUP_FILENAME << "while recovering backup";
         return;
     }
 
-    QuaZipFile zipFile { &zip };
-    if (!zipFile.open(QIODevice::ReadOnly)) {
-        qCritical() << "Failed to open" << CONTENT_SETTINGS_BACKUP_FILENAME << "in backup";
-        return;
-    }
-
-    auto rawData = zipFile.readAll();
-    zipFile.close();
-
     QJsonDocument jsonDocument = QJsonDocument::fromJson(rawData);
 
     if (!_settingsManager.restoreSettingsFromObject(jsonDocument.object(), ContentSettings)) {
@@ -12,12 +12,13 @@
 #ifndef hifi_ContentSettingsBackupHandler_h
 #define hifi_ContentSettingsBackupHandler_h
 
+#include "BackupBlobStore.h"
 #include "BackupHandler.h"
 #include "DomainServerSettingsManager.h"
 
 class ContentSettingsBackupHandler : public BackupHandlerInterface {
 public:
-    ContentSettingsBackupHandler(DomainServerSettingsManager& domainServerSettingsManager);
+    ContentSettingsBackupHandler(DomainServerSettingsManager& domainServerSettingsManager, BackupBlobStorePointer blobStore);
 
     std::pair<bool, float> isAvailable(const QString& backupName) override { return { true, 1.0f }; }
     std::pair<bool, float> getRecoveryStatus() override { return { false, 1.0f }; }
@@ -38,6 +39,7 @@ public:
 
 private:
     DomainServerSettingsManager& _settingsManager;
+    BackupBlobStorePointer _blobStore;
 };
 
 #endif // hifi_ContentSettingsBackupHandler_h
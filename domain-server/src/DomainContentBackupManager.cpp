@@ -53,6 +53,7 @@ void DomainContentBackupManager::addBackupHandler(BackupHandlerPointer handler)
 
 DomainContentBackupManager::DomainContentBackupManager(const QString& backupDirectory,
                                                        const QVariantList& backupRules,
+                                                       bool incrementalBackups,
                                                        std::chrono::milliseconds persistInterval,
                                                        bool debugTimestampNow) :
     _consolidatedBackupDirectory(PathUtils::generateTemporaryDir()),
@@ -63,6 +64,8 @@ DomainContentBackupManager::DomainContentBackupManager(const QString& backupDire
     // Make sure the backup directory exists.
     QDir(_backupDirectory).mkpath(".");
 
+    _blobStore = std::make_shared<BackupBlobStore>(_backupDirectory, incrementalBackups);
+
     parseBackupRules(backupRules);
 
     constexpr int CONSOLIDATED_BACKUP_CLEANER_INTERVAL_MSECS = 30 * 1000;
@@ -150,6 +153,7 @@ void DomainContentBackupManager::setup() {
         for (auto& handler : _backupHandlers) {
             handler->loadBackup(backup.id, zip);
         }
+        _blobStore->loadBackup(backup.id, zip);
 
         zip.close();
     }
@@ -157,6 +161,7 @@ void DomainContentBackupManager::setup() {
     for (auto& handler : _backupHandlers) {
         handler->loadingComplete();
     }
+    _blobStore->loadingComplete();
 }
 
 bool DomainContentBackupManager::process() {
@@ -272,6 +277,11 @@ void DomainContentBackupManager::deleteBackup(MiniPromise::Promise promise, cons
         handler->deleteBackup(backupName);
     }
 
+    if (success) {
+        _blobStore->deleteBackup(backupName);
+        _blobStore->collectGarbage();
+    }
+
     promise->resolve({
         { "success", success }
     });
@@ -481,10 +491,12 @@ void DomainContentBackupManager::removeOldBackupVersions(const BackupRule& rule)
                 QFile backupFile(fileInfo);
                 if (backupFile.remove()) {
                     qCDebug(domain_server) << "Removed old backup: " << backupFile.fileName();
+                    _blobStore->deleteBackup(matchingFiles[i].fileName());
                 } else {
                     qCDebug(domain_server) << "Failed to remove old backup: " << backupFile.fileName();
                 }
             }
+            _blobStore->collectGarbage();
             qCDebug(domain_server) << "Done removing old backup versions";
         }
     } else {
@@ -633,6 +645,13 @@ void DomainContentBackupManager::consolidateBackupInternal(QString fileName) {
         handler->consolidateBackup(fileName, zip);
     }
 
+    // Incremental archives only reference their content, pull it in to make the copy self-contained.
+    if (!_blobStore->consolidateBackup(fileName, zip)) {
+        zip.close();
+        markFailure("Failed to write backup content to archive");
+        return;
+    }
+
     zip.close();
 
     if (zip.getZipError() != UNZ_OK) {
@@ -689,6 +708,13 @@ std::pair<bool, QString> DomainContentBackupManager::createBackup(const QString&
         handler->createBackup(fileName, zip);
     }
 
+    if (!_blobStore->finishBackup(fileName, zip)) {
+        qCWarning(domain_server) << "Failed to write backup manifest at " << path;
+        zip.close();
+        QFile::remove(path);
+        return { false, path };
+    }
+
     zip.close();
 
     return { true, path };
@@ -27,6 +27,7 @@
 
 #include <GenericThread.h>
 
+#include "BackupBlobStore.h"
 #include "BackupHandler.h"
 
 #include <shared/MiniPromises.h>
@@ -72,11 +73,13 @@ public:
 
     DomainContentBackupManager(const QString& rootBackupDirectory,
                                const QVariantList& settings,
+                               bool incrementalBackups = true,
                                std::chrono::milliseconds persistInterval = DEFAULT_PERSIST_INTERVAL,
                                bool debugTimestampNow = false);
 
     std::vector<BackupItemInfo> getAllBackups();
     void addBackupHandler(BackupHandlerPointer handler);
+    BackupBlobStorePointer getBlobStore() const { return _blobStore; }
     void aboutToFinish();  /// call this to inform the persist thread that the owner is about to finish to support final persist
     void replaceData(QByteArray data);
     ConsolidatedBackupInfo consolidateBackup(QString fileName);
@@ -120,6 +123,7 @@ private:
     const QString _consolidatedBackupDirectory;
     const QString _backupDirectory;
     std::vector<BackupHandlerPointer> _backupHandlers;
+    BackupBlobStorePointer _blobStore;
     std::chrono::milliseconds _persistInterval { 0 };
 
     std::mutex _consolidatedBackupsMutex;
@@ -306,13 +306,16 @@ DomainServer::DomainServer(int argc, char* argv[]) :
 
     static const QString BACKUP_RULES_KEYPATH = AUTOMATIC_CONTENT_ARCHIVES_GROUP + ".backup_rules";
     auto backupRulesVariant = _settingsManager.valueOrDefaultValueForKeyPath(BACKUP_RULES_KEYPATH);
+    static const QString INCREMENTAL_BACKUPS_KEYPATH = AUTOMATIC_CONTENT_ARCHIVES_GROUP + ".incremental_backups";
+    bool incrementalBackups = _settingsManager.valueOrDefaultValueForKeyPath(INCREMENTAL_BACKUPS_KEYPATH).toBool();
 
-    _contentManager.reset(new DomainContentBackupManager(getContentBackupDir(), backupRulesVariant.toList()));
+    _contentManager.reset(new DomainContentBackupManager(getContentBackupDir(), backupRulesVariant.toList(), incrementalBackups));
 
     connect(_contentManager.get(), &DomainContentBackupManager::started, _contentManager.get(), [this](){
-        _contentManager->addBackupHandler(BackupHandlerPointer(new EntitiesBackupHandler(getEntitiesFilePath(), getEntitiesReplacementFilePath())));
+        auto blobStore = _contentManager->getBlobStore();
+        _contentManager->addBackupHandler(BackupHandlerPointer(new EntitiesBackupHandler(getEntitiesFilePath(), getEntitiesReplacementFilePath(), blobStore)));
         _contentManager->addBackupHandler(BackupHandlerPointer(new AssetsBackupHandler(getContentBackupDir(), isAssetServerEnabled())));
-        _contentManager->addBackupHandler(BackupHandlerPointer(new ContentSettingsBackupHandler(_settingsManager)));
+        _contentManager->addBackupHandler(BackupHandlerPointer(new ContentSettingsBackupHandler(_settingsManager, blobStore)));
     });
 
     _contentManager->initialize(true);
@@ -27,15 +27,25 @@
 
 #include <OctreeDataUtils.h>
 
-EntitiesBackupHandler::EntitiesBackupHandler(QString entitiesFilePath, QString entitiesReplacementFilePath) :
+EntitiesBackupHandler::EntitiesBackupHandler(QString entitiesFilePath, QString entitiesReplacementFilePath,
+                                             BackupBlobStorePointer blobStore) :
     _entitiesFilePath(entitiesFilePath),
-    _entitiesReplacementFilePath(entitiesReplacementFilePath)
+    _entitiesReplacementFilePath(entitiesReplacementFilePath),
+    _blobStore(blobStore)
 {
 }
 
 static const QString ENTITIES_BACKUP_FILENAME = "models.json.gz";
 
 void EntitiesBackupHandler::createBackup(const QString& backupName, QuaZip& zip) {
+    if (_blobStore->isEnabled()) {
+        // Only referenced from the backup manifest, stored once for all backups sharing the same content.
+        if (QFile::exists(_entitiesFilePath) && !_blobStore->addFileEntry(ENTITIES_BACKUP_FILENAME, _entitiesFilePath)) {
+            qCritical() << "Failed to store entities file in backup";
+        }
+        return;
+    }
+
     QFile entitiesFile { _entitiesFilePath };
 
     if (entitiesFile.open(QIODevice::ReadOnly)) {
@@ -58,18 +68,11 @@ void EntitiesBackupHandler::createBackup(const QString& backupName, QuaZip& zip)
 }
 
 void EntitiesBackupHandler::recoverBackup(const QString& backupName, QuaZip& zip) {
-    if (!zip.setCurrentFile(ENTITIES_BACKUP_FILENAME)) {
+    QByteArray rawData;
+    if (!_blobStore->readEntry(zip, ENTITIES_BACKUP_FILENAME, rawData)) {
         qWarning() << "Failed to find" << ENTITIES_BACKUP_FILENAME << "while recovering backup";
         return;
     }
-    QuaZipFile zipFile { &zip };
-    if (!zipFile.open(QIODevice::ReadOnly)) {
-        qCritical() << "Failed to open" << ENTITIES_BACKUP_FILENAME << "in backup";
-        return;
-    }
-    auto rawData = zipFile.readAll();
-
-    zipFile.close();
 
     OctreeUtils::RawEntityData data;
     if (!data.readOctreeDataInfoFromData(rawData)) {
@@ -79,11 +82,6 @@ void EntitiesBackupHandler::recoverBackup(const QString& backupName, QuaZip& zip
 
     data.resetIdAndVersion();
 
-    if (zipFile.getZipError() != UNZ_OK) {
-        qCritical().nospace() << "Failed to unzip " << ENTITIES_BACKUP_FILENAME << ": " << zipFile.getZipError();
-        return;
-    }
-
     QFile entitiesFile { _entitiesReplacementFilePath };
 
     if (entitiesFile.open(QIODevice::WriteOnly)) {
@@ -12,11 +12,12 @@
 #ifndef hifi_EntitiesBackupHandler_h
 #define hifi_EntitiesBackupHandler_h
 
+#include "BackupBlobStore.h"
 #include "BackupHandler.h"
 
 class EntitiesBackupHandler : public BackupHandlerInterface {
 public:
-    EntitiesBackupHandler(QString entitiesFilePath, QString entitiesReplacementFilePath);
+    EntitiesBackupHandler(QString entitiesFilePath, QString entitiesReplacementFilePath, BackupBlobStorePointer blobStore);
 
     std::pair<bool, float> isAvailable(const QString& backupName) override { return { true, 1.0f }; }
     std::pair<bool, float> getRecoveryStatus() override { return { false, 1.0f }; }
@@ -42,6 +43,7 @@ public:
 private:
     QString _entitiesFilePath;
     QString _entitiesReplacementFilePath;
+    BackupBlobStorePointer _blobStore;
 };
 
 #endif /* hifi_EntitiesBackupHandler_h */
@@ -765,6 +765,8 @@ Menu::Menu() {
     MenuWrapper* pickingOptionsMenu = developerMenu->addMenu("Picking");
     addCheckableActionToQMenuAndActionHash(pickingOptionsMenu, MenuOption::ForceCoarsePicking, 0, false,
         DependencyManager::get<PickManager>().data(), SLOT(setForceCoarsePicking(bool)));
+    addCheckableActionToQMenuAndActionHash(pickingOptionsMenu, MenuOption::ParallelPicking, 0, false,
+        DependencyManager::get<PickManager>().data(), SLOT(setParallelPicking(bool)));
 
     // Developer > Crash >>>
     MenuWrapper* crashMenu = developerMenu->addMenu("Crash");
@@ -144,6 +144,7 @@ namespace MenuOption {
     const QString Overlays = "Show Overlays";
     const QString PackageModel = "Package Avatar as .fst...";
     const QString Pair = "Pair";
+    const QString ParallelPicking = "Parallel Picking";
     const QString PhysicsShowOwned = "Highlight Simulation Ownership";
     const QString VerboseLogging = "Verbose Logging";
     const QString PhysicsShowBulletWireframe = "Show Bullet Collision";
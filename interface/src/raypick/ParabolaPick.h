@@ -82,6 +82,8 @@ public:
     PickResultPointer getAvatarIntersection(const PickParabola& pick) override;
     PickResultPointer getHUDIntersection(const PickParabola& pick) override;
     Transform getResultTransform() const override;
+    // entities are picked through the entity tree, under its read lock
+    bool isThreadSafe() const override { return true; }
 
 protected:
     bool _rotateAccelerationWithAvatar;
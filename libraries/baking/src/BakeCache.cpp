@@ -0,0 +1,234 @@
+//
+//  BakeCache.cpp
+//  libraries/baking/src
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "BakeCache.h"
+
+#include <QtCore/QCryptographicHash>
+#include <QtCore/QDir>
+#include <QtCore/QDirIterator>
+#include <QtCore/QFile>
+#include <QtCore/QFileInfo>
+#include <QtCore/QJsonDocument>
+#include <QtCore/QSaveFile>
+
+#include "ModelBakingLoggingCategory.h"
+
+const qint64 BakeCache::DEFAULT_SIZE_LIMIT = 10LL * 1024 * 1024 * 1024;
+
+// bump when the cache layout or the way keys are computed changes, which discards existing caches
+static const int BAKE_CACHE_VERSION = 2;
+
+static const QString INDEX_FILE_NAME = "index.json";
+static const QString ENTRIES_FOLDER_NAME = "entries";
+
+static const QString VERSION_KEY = "version";
+static const QString USE_COUNTER_KEY = "useCounter";
+static const QString ENTRIES_KEY = "entries";
+static const QString BAKED_MODEL_KEY = "bakedModel";
+static const QString SIZE_KEY = "size";
+static const QString LAST_USED_KEY = "lastUsed";
+static const QString DEPENDENCIES_KEY = "dependencies";
+
+// copies the files below one directory to another, keeping their relative paths
+static bool copyDirectory(const QString& sourceDirectory, const QString& destinationDirectory, qint64& size) {
+    QDir source { sourceDirectory };
+    QDir destination { destinationDirectory };
+    QDirIterator it { sourceDirectory, QDir::Files | QDir::Hidden | QDir::NoDotAndDotDot, QDirIterator::Subdirectories };
+    while (it.hasNext()) {
+        auto sourcePath = it.next();
+        auto destinationPath = destination.filePath(source.relativeFilePath(sourcePath));
+        if (!QDir().mkpath(QFileInfo(destinationPath).absolutePath())) {
+            return false;
+        }
+        QFile::remove(destinationPath);
+        if (!QFile::copy(sourcePath, destinationPath)) {
+            return false;
+        }
+        size += it.fileInfo().size();
+    }
+    return true;
+}
+
+BakeCache::BakeCache(const QString& directory, qint64 sizeLimit) :
+    _directory(directory),
+    _sizeLimit(sizeLimit)
+{
+    load();
+    if (_size > _sizeLimit) {
+        evict();
+        save();
+    }
+}
+
+QString BakeCache::computeKey(const QByteArray& sourceContent, const QString& bakerVersion, const QJsonObject& options) {
+    QCryptographicHash hash { QCryptographicHash::Sha256 };
+    hash.addData(QByteArray::number(BAKE_CACHE_VERSION));
+    hash.addData(bakerVersion.toUtf8());
+    // QJsonObject keeps its keys sorted, so the same options always give the same document
+    hash.addData(QJsonDocument(options).toJson(QJsonDocument::Compact));
+    hash.addData(sourceContent);
+    return hash.result().toHex();
+}
+
+QByteArray BakeCache::hashDependency(const QByteArray& content) {
+    return QCryptographicHash::hash(content, QCryptographicHash::Md5).toHex();
+}
+
+QHash<QUrl, QByteArray> BakeCache::getDependencies(const QString& key) const {
+    return _entries.value(key).dependencies;
+}
+
+QString BakeCache::restore(const QString& key, const QString& outputDirectory) {
+    auto it = _entries.find(key);
+    if (it == _entries.end()) {
+        return QString();
+    }
+
+    qint64 size = 0;
+    if (!copyDirectory(getEntryPath(key), outputDirectory, size) || size != it->size) {
+        qCWarning(model_baking) << "Discarding incomplete bake cache entry" << key;
+        removeEntry(key);
+        save();
+        return QString();
+    }
+
+    it->lastUsed = ++_useCounter;
+    save();
+    return QDir(outputDirectory).filePath(it->bakedModelFileName);
+}
+
+bool BakeCache::insert(const QString& key, const QString& bakedDirectory, const QString& bakedModelFilePath,
+                       const QHash<QUrl, QByteArray>& dependencies) {
+    if (_sizeLimit <= 0) {
+        return false;
+    }
+    removeEntry(key);
+
+    Entry entry;
+    auto entryPath = getEntryPath(key);
+    if (!copyDirectory(bakedDirectory, entryPath, entry.size)) {
+        qCWarning(model_baking) << "Could not copy" << bakedDirectory << "to the bake cache";
+        QDir(entryPath).removeRecursively();
+        return false;
+    }
+    entry.bakedModelFileName = QDir(bakedDirectory).relativeFilePath(bakedModelFilePath);
+    entry.dependencies = dependencies;
+    entry.lastUsed = ++_useCounter;
+
+    _entries.insert(key, entry);
+    _size += entry.size;
+    evict();
+    save();
+    return contains(key);
+}
+
+void BakeCache::remove(const QString& key) {
+    removeEntry(key);
+    save();
+}
+
+void BakeCache::setSizeLimit(qint64 sizeLimit) {
+    _sizeLimit = sizeLimit;
+    evict();
+    save();
+}
+
+QString BakeCache::getEntryPath(const QString& key) const {
+    return QDir(_directory).filePath(ENTRIES_FOLDER_NAME + "/" + key);
+}
+
+void BakeCache::removeEntry(const QString& key) {
+    auto it = _entries.find(key);
+    if (it != _entries.end()) {
+        _size -= it->size;
+        _entries.erase(it);
+    }
+    QDir(getEntryPath(key)).removeRecursively();
+}
+
+void BakeCache::evict() {
+    while (_size > _sizeLimit && !_entries.isEmpty()) {
+        auto leastRecentlyUsed = _entries.begin();
+        for (auto it = _entries.begin(); it != _entries.end(); ++it) {
+            if (it->lastUsed < leastRecentlyUsed->lastUsed) {
+                leastRecentlyUsed = it;
+            }
+        }
+        qCDebug(model_baking) << "Evicting" << leastRecentlyUsed.key() << "from the bake cache";
+        removeEntry(leastRecentlyUsed.key());
+    }
+}
+
+void BakeCache::load() {
+    _entries.clear();
+    _size = 0;
+    _useCounter = 0;
+
+    QFile indexFile { QDir(_directory).filePath(INDEX_FILE_NAME) };
+    if (!indexFile.open(QIODevice::ReadOnly)) {
+        return;
+    }
+    auto index = QJsonDocument::fromJson(indexFile.readAll()).object();
+    if (index[VERSION_KEY].toInt() != BAKE_CACHE_VERSION) {
+        // an older cache, its entries may not match what the bakers produce now
+        qCDebug(model_baking) << "Discarding the bake cache at" << _directory;
+        QDir(QDir(_directory).filePath(ENTRIES_FOLDER_NAME)).removeRecursively();
+        return;
+    }
+
+    _useCounter = (quint64)index[USE_COUNTER_KEY].toDouble();
+    auto entries = index[ENTRIES_KEY].toObject();
+    for (auto it = entries.begin(); it != entries.end(); ++it) {
+        auto entryObject = it.value().toObject();
+        if (!QDir(getEntryPath(it.key())).exists()) {
+            continue;
+        }
+
+        Entry entry;
+        entry.bakedModelFileName = entryObject[BAKED_MODEL_KEY].toString();
+        entry.size = (qint64)entryObject[SIZE_KEY].toDouble();
+        entry.lastUsed = (quint64)entryObject[LAST_USED_KEY].toDouble();
+        auto dependencies = entryObject[DEPENDENCIES_KEY].toObject();
+        for (auto dependency = dependencies.begin(); dependency != dependencies.end(); ++dependency) {
+            entry.dependencies.insert(QUrl(dependency.key()), dependency.value().toString().toUtf8());
+        }
+        _entries.insert(it.key(), entry);
+        _size += entry.size;
+    }
+}
+
+void BakeCache::save() const {
+    QJsonObject entries;
+    for (auto it = _entries.begin(); it != _entries.end(); ++it) {
+        QJsonObject dependencies;
+        for (auto dependency = it->dependencies.begin(); dependency != it->dependencies.end(); ++dependency) {
+            dependencies[dependency.key().toString()] = QString::fromUtf8(dependency.value());
+        }
+
+        QJsonObject entryObject;
+        entryObject[BAKED_MODEL_KEY] = it->bakedModelFileName;
+        entryObject[SIZE_KEY] = (double)it->size;
+        entryObject[LAST_USED_KEY] = (double)it->lastUsed;
+        entryObject[DEPENDENCIES_KEY] = dependencies;
+        entries[it.key()] = entryObject;
+    }
+
+    QJsonObject index;
+    index[VERSION_KEY] = BAKE_CACHE_VERSION;
+    index[USE_COUNTER_KEY] = (double)_useCounter;
+    index[ENTRIES_KEY] = entries;
+
+    // write the index in one go, so that an interrupted bake doesn't leave it truncated
+    QDir().mkpath(_directory);
+    QSaveFile indexFile { QDir(_directory).filePath(INDEX_FILE_NAME) };
+    if (!indexFile.open(QIODevice::WriteOnly) || indexFile.write(QJsonDocument(index).toJson()) == -1 || !indexFile.commit()) {
+        qCWarning(model_baking) << "Could not write the bake cache index to" << _directory;
+    }
+}
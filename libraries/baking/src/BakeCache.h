@@ -0,0 +1,77 @@
+//
+//  BakeCache.h
+//  libraries/baking/src
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_BakeCache_h
+#define hifi_BakeCache_h
+
+#include <QtCore/QHash>
+#include <QtCore/QJsonObject>
+#include <QtCore/QString>
+#include <QtCore/QUrl>
+
+// A persistent cache of baked outputs, so that re-baking unchanged assets only copies their previous results.
+//
+// Entries are keyed by the content hash of the asset's source, the baker version and the options that change the baked
+// output. Since a bake also reads inputs that are only known once the source has been parsed, like linked textures,
+// each entry records those dependencies with their content hashes, and is only valid while they all still match.
+//
+// The cache is a directory holding one folder of baked files per entry and an index. When the entries grow past the
+// size limit, the least recently used are removed.
+class BakeCache {
+public:
+    static const qint64 DEFAULT_SIZE_LIMIT;
+
+    BakeCache(const QString& directory, qint64 sizeLimit = DEFAULT_SIZE_LIMIT);
+
+    static QString computeKey(const QByteArray& sourceContent, const QString& bakerVersion, const QJsonObject& options);
+    // the hex encoded MD5 of a dependency's content, as TextureBaker reports them
+    static QByteArray hashDependency(const QByteArray& content);
+
+    bool contains(const QString& key) const { return _entries.contains(key); }
+    // the dependencies to check before restoring an entry, by URL
+    QHash<QUrl, QByteArray> getDependencies(const QString& key) const;
+
+    // copies the entry's baked files to the output directory, returns the path to the baked model or an empty string
+    QString restore(const QString& key, const QString& outputDirectory);
+
+    // copies the baked files found in bakedDirectory, bakedModelFilePath being one of them
+    bool insert(const QString& key, const QString& bakedDirectory, const QString& bakedModelFilePath,
+                const QHash<QUrl, QByteArray>& dependencies);
+
+    void remove(const QString& key);
+
+    int getEntryCount() const { return _entries.size(); }
+    qint64 getSize() const { return _size; }
+    qint64 getSizeLimit() const { return _sizeLimit; }
+    void setSizeLimit(qint64 sizeLimit);
+
+private:
+    class Entry {
+    public:
+        QString bakedModelFileName; // relative to the entry's folder
+        QHash<QUrl, QByteArray> dependencies;
+        qint64 size { 0 };
+        quint64 lastUsed { 0 };
+    };
+
+    QString getEntryPath(const QString& key) const;
+    void removeEntry(const QString& key);
+    void load();
+    void save() const;
+    void evict();
+
+    QString _directory;
+    qint64 _sizeLimit;
+    qint64 _size { 0 };
+    quint64 _useCounter { 0 }; // orders the entries by use, persisted so that it survives across runs
+    QHash<QString, Entry> _entries;
+};
+
+#endif // hifi_BakeCache_h
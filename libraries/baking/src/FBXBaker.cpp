@@ -20,6 +20,8 @@
 #include <QtCore/QFileInfo>
 #include <QtCore/QThread>
 
+#include <algorithm>
+#include <deque>
 #include <mutex>
 
 #include <NetworkAccessManager.h>
@@ -226,66 +228,102 @@ void FBXBaker::rewriteAndBakeSceneModels() {
             break;
         }
     }
+
+    // the meshes are encoded in parallel, but their results are handled in order, so that the baked file and the
+    // reported warnings are the same as if they were compressed one after the other
+    struct PendingGeometry {
+        FBXNode* geometryNode;
+        QFuture<CompressedMesh> compressedMesh;
+    };
+    std::deque<PendingGeometry> pendingGeometries;
+
+    // only extract as many meshes ahead as the pool can encode, to bound how many are held in memory at once
+    auto& pool = getMeshCompressionPool();
+    const size_t maxPendingGeometries = std::max(2 * pool.maxThreadCount(), 1);
+
+    auto handleNextGeometry = [&]() -> bool {
+        auto pendingGeometry = pendingGeometries.front();
+        pendingGeometries.pop_front();
+
+        // if bake fails - return, if there were errors and continue, if there were warnings.
+        FBXNode dracoMeshNode;
+        if (!handleCompressedMesh(pendingGeometry.compressedMesh.result(), dracoMeshNode)) {
+            return !hasErrors();
+        }
+
+        auto& objectChild = *pendingGeometry.geometryNode;
+        objectChild.children.push_back(dracoMeshNode);
+
+        static const std::vector<QString> nodeNamesToDelete {
+            // Node data that is packed into the draco mesh
+            "Vertices",
+            "PolygonVertexIndex",
+            "LayerElementNormal",
+            "LayerElementColor",
+            "LayerElementUV",
+            "LayerElementMaterial",
+            "LayerElementTexture",
+
+            // Node data that we don't support
+            "Edges",
+            "LayerElementTangent",
+            "LayerElementBinormal",
+            "LayerElementSmoothing"
+        };
+        auto& children = objectChild.children;
+        auto it = children.begin();
+        while (it != children.end()) {
+            auto begin = nodeNamesToDelete.begin();
+            auto end = nodeNamesToDelete.end();
+            if (find(begin, end, it->name) != end) {
+                it = children.erase(it);
+            } else {
+                ++it;
+            }
+        }
+        return true;
+    };
+
+    auto waitForPendingGeometries = [&] {
+        for (auto& pendingGeometry : pendingGeometries) {
+            pendingGeometry.compressedMesh.waitForFinished();
+        }
+    };
+
     for (FBXNode& rootChild : _rootNode.children) {
         if (rootChild.name == "Objects") {
             for (FBXNode& objectChild : rootChild.children) {
                 if (objectChild.name == "Geometry") {
 
                     // TODO Pull this out of _hfmModel instead so we don't have to reprocess it
-                    auto extractedMesh = FBXSerializer::extractMesh(objectChild, meshIndex, false);
-                    
-                    // Callback to get MaterialID
-                    GetMaterialIDCallback materialIDcallback = [&extractedMesh](int partIndex) {
-                        return extractedMesh.partMaterialTextures[partIndex].first;
-                    };
-                    
-                    // Compress mesh information and store in dracoMeshNode
-                    FBXNode dracoMeshNode;
-                    bool success = compressMesh(extractedMesh.mesh, hasDeformers, dracoMeshNode, materialIDcallback);
-                    
-                    // if bake fails - return, if there were errors and continue, if there were warnings.
-                    if (!success) {
-                        if (hasErrors()) {
-                            return;
-                        } else if (hasWarnings()) {
-                            continue;
-                        }
-                    } else {
-                        objectChild.children.push_back(dracoMeshNode);
-
-                        static const std::vector<QString> nodeNamesToDelete {
-                            // Node data that is packed into the draco mesh
-                            "Vertices",
-                            "PolygonVertexIndex",
-                            "LayerElementNormal",
-                            "LayerElementColor",
-                            "LayerElementUV",
-                            "LayerElementMaterial",
-                            "LayerElementTexture",
-
-                            // Node data that we don't support
-                            "Edges",
-                            "LayerElementTangent",
-                            "LayerElementBinormal",
-                            "LayerElementSmoothing"
+                    auto extractedMesh = std::make_shared<ExtractedMesh>(FBXSerializer::extractMesh(objectChild, meshIndex, false));
+
+                    // Compress mesh information on the mesh compression pool
+                    auto compressedMesh = QtConcurrent::run(&pool, [extractedMesh, hasDeformers] {
+                        // Callback to get MaterialID
+                        GetMaterialIDCallback materialIDcallback = [&extractedMesh](int partIndex) {
+                            return extractedMesh->partMaterialTextures[partIndex].first;
                         };
-                        auto& children = objectChild.children;
-                        auto it = children.begin();
-                        while (it != children.end()) {
-                            auto begin = nodeNamesToDelete.begin();
-                            auto end = nodeNamesToDelete.end();
-                            if (find(begin, end, it->name) != end) {
-                                it = children.erase(it);
-                            } else {
-                                ++it;
-                            }
-                        }
+                        return encodeMesh(extractedMesh->mesh, hasDeformers, materialIDcallback);
+                    });
+                    pendingGeometries.push_back({ &objectChild, compressedMesh });
+
+                    if (pendingGeometries.size() >= maxPendingGeometries && !handleNextGeometry()) {
+                        waitForPendingGeometries();
+                        return;
                     }
                 }  // Geometry Object
 
             } // foreach root child
         }
     }
+
+    while (!pendingGeometries.empty()) {
+        if (!handleNextGeometry()) {
+            waitForPendingGeometries();
+            return;
+        }
+    }
 }
 
 void FBXBaker::rewriteAndBakeSceneTextures() {
@@ -11,10 +11,16 @@
 
 #include "ModelBaker.h"
 
+#include <mutex>
+
+#include <QtCore/QThread>
+
 #include <PathUtils.h>
 
 #include <FBXWriter.h>
 
+#include "TextureBakeQueue.h"
+
 #ifdef _WIN32
 #pragma warning( push )
 #pragma warning( disable : 4267 )
@@ -54,6 +60,10 @@ ModelBaker::ModelBaker(const QUrl& inputModelURL, TextureBakerThreadGetter input
 }
 
 ModelBaker::~ModelBaker() {
+    for (auto it = _textureReferenceCounts.begin(); it != _textureReferenceCounts.end(); ++it) {
+        TextureBakeQueue::getInstance().removeReferences(it.key(), it.value());
+    }
+
     if (_modelTempDir.exists()) {
         if (!_modelTempDir.remove(_originalModelFilePath)) {
             qCWarning(model_baking) << "Failed to remove temporary copy of fbx file:" << _originalModelFilePath;
@@ -74,11 +84,41 @@ void ModelBaker::abort() {
     }
 }
 
+QThreadPool& ModelBaker::getMeshCompressionPool() {
+    // shared by every model baker, so that baking many models at once doesn't start more encodes than there are cores
+    static QThreadPool pool;
+    static std::once_flag once;
+    std::call_once(once, [] {
+        pool.setMaxThreadCount(QThread::idealThreadCount());
+    });
+    return pool;
+}
+
 bool ModelBaker::compressMesh(HFMMesh& mesh, bool hasDeformers, FBXNode& dracoMeshNode, GetMaterialIDCallback materialIDCallback) {
-    if (mesh.wasCompressed) {
-        handleError("Cannot re-bake a file that contains compressed mesh");
+    return handleCompressedMesh(encodeMesh(mesh, hasDeformers, materialIDCallback), dracoMeshNode);
+}
+
+bool ModelBaker::handleCompressedMesh(const CompressedMesh& compressedMesh, FBXNode& dracoMeshNode) {
+    for (auto& warning : compressedMesh.warnings) {
+        handleWarning(warning);
+    }
+    if (!compressedMesh.error.isEmpty()) {
+        handleError(compressedMesh.error);
         return false;
     }
+    if (compressedMesh.success) {
+        dracoMeshNode = compressedMesh.dracoMeshNode;
+    }
+    return compressedMesh.success;
+}
+
+ModelBaker::CompressedMesh ModelBaker::encodeMesh(const HFMMesh& mesh, bool hasDeformers, GetMaterialIDCallback materialIDCallback) {
+    CompressedMesh result;
+
+    if (mesh.wasCompressed) {
+        result.error = "Cannot re-bake a file that contains compressed mesh";
+        return result;
+    }
 
     Q_ASSERT(mesh.normals.size() == 0 || mesh.normals.size() == mesh.vertices.size());
     Q_ASSERT(mesh.colors.size() == 0 || mesh.colors.size() == mesh.vertices.size());
@@ -87,7 +127,7 @@ bool ModelBaker::compressMesh(HFMMesh& mesh, bool hasDeformers, FBXNode& dracoMe
     int64_t numTriangles{ 0 };
     for (auto& part : mesh.parts) {
         if ((part.quadTrianglesIndices.size() % 3) != 0 || (part.triangleIndices.size() % 3) != 0) {
-            handleWarning("Found a mesh part with invalid index data, skipping");
+            result.warnings << "Found a mesh part with invalid index data, skipping";
             continue;
         }
         numTriangles += part.quadTrianglesIndices.size() / 3;
@@ -95,7 +135,7 @@ bool ModelBaker::compressMesh(HFMMesh& mesh, bool hasDeformers, FBXNode& dracoMe
     }
 
     if (numTriangles == 0) {
-        return false;
+        return result;
     }
 
     draco::TriangleSoupMeshBuilder meshBuilder;
@@ -154,7 +194,7 @@ bool ModelBaker::compressMesh(HFMMesh& mesh, bool hasDeformers, FBXNode& dracoMe
     for (auto& part : mesh.parts) {
         materialID = (materialIDCallback) ? materialIDCallback(partIndex) : partIndex;
         
-        auto addFace = [&](QVector<int>& indices, int index, draco::FaceIndex face) {
+        auto addFace = [&](const QVector<int>& indices, int index, draco::FaceIndex face) {
             int32_t idx0 = indices[index];
             int32_t idx1 = indices[index + 1];
             int32_t idx2 = indices[index + 2];
@@ -209,8 +249,8 @@ bool ModelBaker::compressMesh(HFMMesh& mesh, bool hasDeformers, FBXNode& dracoMe
     auto dracoMesh = meshBuilder.Finalize();
 
     if (!dracoMesh) {
-        handleWarning("Failed to finalize the baking of a draco Geometry node");
-        return false;
+        result.warnings << "Failed to finalize the baking of a draco Geometry node";
+        return result;
     }
 
     // we need to modify unique attribute IDs for custom attributes
@@ -237,14 +277,13 @@ bool ModelBaker::compressMesh(HFMMesh& mesh, bool hasDeformers, FBXNode& dracoMe
     draco::EncoderBuffer buffer;
     encoder.EncodeMeshToBuffer(*dracoMesh, &buffer);
 
-    FBXNode dracoNode;
-    dracoNode.name = "DracoMesh";
+    result.dracoMeshNode.name = "DracoMesh";
     auto value = QVariant::fromValue(QByteArray(buffer.data(), (int)buffer.size()));
-    dracoNode.properties.append(value);
-    
-    dracoMeshNode = dracoNode;
-    // Mesh compression successful return true
-    return true;
+    result.dracoMeshNode.properties.append(value);
+
+    // Mesh compression successful
+    result.success = true;
+    return result;
 }
 
 QString ModelBaker::compressTexture(QString modelTextureFileName, image::TextureUsage::Type textureType) {
@@ -276,6 +315,10 @@ QString ModelBaker::compressTexture(QString modelTextureFileName, image::Texture
         }
         auto urlToTexture = getTextureURL(modelTextureFileInfo, modelTextureFileName, !textureContent.isNull());
 
+        // textures shared by many materials and models are baked first
+        TextureBakeQueue::getInstance().addReference(urlToTexture);
+        ++_textureReferenceCounts[urlToTexture];
+
         QString baseTextureFileName;
         if (_remappedTexturePaths.contains(urlToTexture)) {
             baseTextureFileName = _remappedTexturePaths[urlToTexture];
@@ -323,9 +366,9 @@ void ModelBaker::bakeTexture(const QUrl& textureURL, image::TextureUsage::Type t
     // keep a shared pointer to the baking texture
     _bakingTextures.insert(textureURL, bakingTexture);
 
-    // start baking the texture on one of our available worker threads
-    bakingTexture->moveToThread(_textureThreadGetter());
-    QMetaObject::invokeMethod(bakingTexture.data(), "bake");
+    // bake the texture on one of our available worker threads, once the texture bakes of every model leave room for it
+    auto estimatedMemory = TextureBakeQueue::estimateMemory(textureURL, textureContent);
+    TextureBakeQueue::getInstance().push(bakingTexture, _textureThreadGetter(), estimatedMemory);
 }
 
 void ModelBaker::handleBakedTexture() {
@@ -371,9 +414,13 @@ void ModelBaker::handleBakedTexture() {
                     }
                 }
 
+                if (!_modelURL.isParentOf(bakedTexture->getTextureURL())) {
+                    // linked textures are inputs of the bake, just like the model itself
+                    _textureDependencies[bakedTexture->getTextureURL()] = bakedTexture->getOriginalTextureHash();
+                }
 
                 // now that this texture has been baked and handled, we can remove that TextureBaker from our hash
-                _bakingTextures.remove(bakedTexture->getTextureURL());
+                removeBakingTexture(bakedTexture->getTextureURL());
 
                 checkIfTexturesFinished();
             } else {
@@ -384,7 +431,7 @@ void ModelBaker::handleBakedTexture() {
                 _pendingErrorEmission = true;
 
                 // now that this texture has been baked, even though it failed, we can remove that TextureBaker from our list
-                _bakingTextures.remove(bakedTexture->getTextureURL());
+                removeBakingTexture(bakedTexture->getTextureURL());
 
                 // abort any other ongoing texture bakes since we know we'll end up failing
                 for (auto& bakingTexture : _bakingTextures) {
@@ -397,7 +444,7 @@ void ModelBaker::handleBakedTexture() {
             // we have errors to attend to, so we don't do extra processing for this texture
             // but we do need to remove that TextureBaker from our list
             // and then check if we're done with all textures
-            _bakingTextures.remove(bakedTexture->getTextureURL());
+            removeBakingTexture(bakedTexture->getTextureURL());
 
             checkIfTexturesFinished();
         }
@@ -411,7 +458,7 @@ void ModelBaker::handleAbortedTexture() {
     qDebug() << "Texture aborted: " << bakedTexture->getTextureURL();
 
     if (bakedTexture) {
-        _bakingTextures.remove(bakedTexture->getTextureURL());
+        removeBakingTexture(bakedTexture->getTextureURL());
     }
 
     // since a texture we were baking aborted, our status is also aborted
@@ -425,6 +472,16 @@ void ModelBaker::handleAbortedTexture() {
     checkIfTexturesFinished();
 }
 
+void ModelBaker::removeBakingTexture(const QUrl& textureURL) {
+    _bakingTextures.remove(textureURL);
+
+    // this model no longer waits on the texture, so it doesn't push it ahead in the queue anymore
+    int referenceCount = _textureReferenceCounts.take(textureURL);
+    if (referenceCount > 0) {
+        TextureBakeQueue::getInstance().removeReferences(textureURL, referenceCount);
+    }
+}
+
 QUrl ModelBaker::getTextureURL(const QFileInfo& textureFileInfo, QString relativeFileName, bool isEmbedded) {
     QUrl urlToTexture;
 
@@ -14,6 +14,7 @@
 
 #include <QtCore/QFutureSynchronizer>
 #include <QtCore/QDir>
+#include <QtCore/QThreadPool>
 #include <QtCore/QUrl>
 #include <QtNetwork/QNetworkReply>
 
@@ -40,12 +41,32 @@ public:
                const QString& bakedOutputDirectory, const QString& originalOutputDirectory = "");
     virtual ~ModelBaker();
 
+    // the draco node for a mesh, along with what went wrong while compressing it
+    class CompressedMesh {
+    public:
+        FBXNode dracoMeshNode;
+        QString error;
+        QStringList warnings;
+        bool success { false };
+    };
+
     bool compressMesh(HFMMesh& mesh, bool hasDeformers, FBXNode& dracoMeshNode, GetMaterialIDCallback materialIDCallback = nullptr);
+    // thread safe, so that the meshes of a model can be encoded in parallel on the mesh compression pool
+    static CompressedMesh encodeMesh(const HFMMesh& mesh, bool hasDeformers, GetMaterialIDCallback materialIDCallback = nullptr);
+    // reports the warnings and errors of an encoded mesh, and returns whether it can replace the original geometry
+    bool handleCompressedMesh(const CompressedMesh& compressedMesh, FBXNode& dracoMeshNode);
+    static QThreadPool& getMeshCompressionPool();
+
     QString compressTexture(QString textureFileName, image::TextureUsage::Type = image::TextureUsage::Type::DEFAULT_TEXTURE);
     virtual void setWasAborted(bool wasAborted) override;
 
     QUrl getModelURL() const { return _modelURL; }
     QString getBakedModelFilePath() const { return _bakedModelFilePath; }
+    // the linked textures the bake read besides the model, with the hex encoded MD5 of their contents
+    QHash<QUrl, QByteArray> getTextureDependencies() const { return _textureDependencies; }
+
+    // where the original of a linked texture goes, relative to the original model
+    static QString texturePathRelativeToModel(QUrl modelURL, QUrl textureURL);
 
 public slots:
     virtual void abort() override;
@@ -74,12 +95,14 @@ private:
     QUrl getTextureURL(const QFileInfo& textureFileInfo, QString relativeFileName, bool isEmbedded = false);
     void bakeTexture(const QUrl & textureURL, image::TextureUsage::Type textureType, const QDir & outputDir, 
                      const QString & bakedFilename, const QByteArray & textureContent);
-    QString texturePathRelativeToModel(QUrl modelURL, QUrl textureURL);
+    void removeBakingTexture(const QUrl& textureURL);
     
     TextureBakerThreadGetter _textureThreadGetter;
     QMultiHash<QUrl, QSharedPointer<TextureBaker>> _bakingTextures;
     QHash<QString, int> _textureNameMatchCount;
     QHash<QUrl, QString> _remappedTexturePaths;
+    QHash<QUrl, QByteArray> _textureDependencies;
+    QHash<QUrl, int> _textureReferenceCounts; // added to the TextureBakeQueue and not removed yet
     bool _pendingErrorEmission{ false };
 };
 
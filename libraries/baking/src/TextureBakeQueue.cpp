@@ -0,0 +1,177 @@
+//
+//  TextureBakeQueue.cpp
+//  libraries/baking/src
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "TextureBakeQueue.h"
+
+#include <QtCore/QBuffer>
+#include <QtCore/QThread>
+#include <QtGui/QImageReader>
+
+#include <SharedUtil.h>
+
+#include "TextureBaker.h"
+
+// used when getMemoryInfo can't tell how much memory there is
+static const qint64 DEFAULT_MEMORY_BUDGET = 4LL * 1024 * 1024 * 1024;
+
+// assumed for textures whose size can't be read before they are downloaded
+static const qint64 DEFAULT_TEXTURE_NUM_PIXELS = 4096 * 4096;
+
+// the decoded source, its converted copy and the mips processed from it, in 32 bit pixels
+static const qint64 BYTES_PER_BAKED_PIXEL = 3 * 4;
+
+TextureBakeQueue& TextureBakeQueue::getInstance() {
+    static TextureBakeQueue instance;
+    return instance;
+}
+
+TextureBakeQueue::TextureBakeQueue() {
+    MemoryInfo memoryInfo;
+    if (getMemoryInfo(memoryInfo)) {
+        // leave the other half for the model bakers and everything else
+        _memoryBudget = (qint64)(memoryInfo.totalMemoryBytes / 2);
+    } else {
+        _memoryBudget = DEFAULT_MEMORY_BUDGET;
+    }
+}
+
+void TextureBakeQueue::addReference(const QUrl& textureURL) {
+    std::lock_guard<std::mutex> lock { _mutex };
+    ++_referenceCounts[textureURL];
+}
+
+void TextureBakeQueue::removeReferences(const QUrl& textureURL, int count) {
+    std::lock_guard<std::mutex> lock { _mutex };
+    auto it = _referenceCounts.find(textureURL);
+    if (it == _referenceCounts.end()) {
+        return;
+    }
+    it.value() -= count;
+    if (it.value() <= 0) {
+        _referenceCounts.erase(it);
+    }
+}
+
+int TextureBakeQueue::getReferenceCount(const QUrl& textureURL) const {
+    std::lock_guard<std::mutex> lock { _mutex };
+    return _referenceCounts.value(textureURL);
+}
+
+void TextureBakeQueue::push(const QSharedPointer<TextureBaker>& baker, QThread* thread, qint64 estimatedMemory) {
+    // move it now, while we're still on the thread that created it
+    baker->moveToThread(thread);
+
+    // direct connections, since the queue doesn't belong to any thread
+    auto rawBaker = baker.data();
+    QObject::connect(rawBaker, &Baker::finished, [this, rawBaker] { finishBake(rawBaker); });
+    QObject::connect(rawBaker, &Baker::aborted, [this, rawBaker] { finishBake(rawBaker); });
+    QObject::connect(rawBaker, &QObject::destroyed, [this, rawBaker] { finishBake(rawBaker); });
+
+    {
+        std::lock_guard<std::mutex> lock { _mutex };
+        _pendingBakes.push_back({ baker.toWeakRef(), baker->getTextureURL(), estimatedMemory, _nextOrder++ });
+    }
+
+    startPendingBakes();
+}
+
+qint64 TextureBakeQueue::estimateMemory(const QUrl& textureURL, const QByteArray& textureContent) {
+    // only the header is read to get the size
+    QSize size;
+    if (!textureContent.isEmpty()) {
+        QBuffer buffer;
+        buffer.setData(textureContent);
+        size = QImageReader(&buffer).size();
+    } else if (textureURL.isLocalFile()) {
+        size = QImageReader(textureURL.toLocalFile()).size();
+    }
+
+    qint64 numPixels = size.isValid() ? (qint64)size.width() * size.height() : DEFAULT_TEXTURE_NUM_PIXELS;
+    return numPixels * BYTES_PER_BAKED_PIXEL + textureContent.size();
+}
+
+void TextureBakeQueue::setMemoryBudget(qint64 memoryBudget) {
+    {
+        std::lock_guard<std::mutex> lock { _mutex };
+        _memoryBudget = memoryBudget;
+    }
+
+    startPendingBakes();
+}
+
+qint64 TextureBakeQueue::getMemoryBudget() const {
+    std::lock_guard<std::mutex> lock { _mutex };
+    return _memoryBudget;
+}
+
+qint64 TextureBakeQueue::getMemoryInUse() const {
+    std::lock_guard<std::mutex> lock { _mutex };
+    return _memoryInUse;
+}
+
+int TextureBakeQueue::getPendingCount() const {
+    std::lock_guard<std::mutex> lock { _mutex };
+    return (int)_pendingBakes.size();
+}
+
+void TextureBakeQueue::startPendingBakes() {
+    std::vector<QSharedPointer<TextureBaker>> bakesToStart;
+    {
+        std::lock_guard<std::mutex> lock { _mutex };
+
+        while (!_pendingBakes.empty()) {
+            // the texture referenced the most goes first, then the one that was queued first
+            auto next = _pendingBakes.begin();
+            for (auto it = _pendingBakes.begin(); it != _pendingBakes.end(); ++it) {
+                auto references = _referenceCounts.value(it->textureURL);
+                auto nextReferences = _referenceCounts.value(next->textureURL);
+                if (references > nextReferences || (references == nextReferences && it->order < next->order)) {
+                    next = it;
+                }
+            }
+
+            auto baker = next->baker.toStrongRef();
+            if (!baker) {
+                // its model baker let go of it before it could start
+                _pendingBakes.erase(next);
+                continue;
+            }
+
+            // always let one bake run, even if it is estimated to need more than the whole budget
+            if (!_runningBakes.isEmpty() && _memoryInUse + next->estimatedMemory > _memoryBudget) {
+                break;
+            }
+
+            _memoryInUse += next->estimatedMemory;
+            _runningBakes.insert(baker.data(), next->estimatedMemory);
+            _pendingBakes.erase(next);
+            bakesToStart.push_back(baker);
+        }
+    }
+
+    for (auto& baker : bakesToStart) {
+        QMetaObject::invokeMethod(baker.data(), "bake", Qt::QueuedConnection);
+    }
+}
+
+void TextureBakeQueue::finishBake(TextureBaker* baker) {
+    {
+        std::lock_guard<std::mutex> lock { _mutex };
+        auto it = _runningBakes.find(baker);
+        if (it == _runningBakes.end()) {
+            // already counted as done, or it never started
+            return;
+        }
+        _memoryInUse -= it.value();
+        _runningBakes.erase(it);
+    }
+
+    startPendingBakes();
+}
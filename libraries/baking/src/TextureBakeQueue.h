@@ -0,0 +1,71 @@
+//
+//  TextureBakeQueue.h
+//  libraries/baking/src
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_TextureBakeQueue_h
+#define hifi_TextureBakeQueue_h
+
+#include <mutex>
+#include <vector>
+
+#include <QtCore/QHash>
+#include <QtCore/QSharedPointer>
+#include <QtCore/QUrl>
+
+class QThread;
+class TextureBaker;
+
+// Starts the texture bakes of every model baker in the process, keeping the memory they are estimated to need under
+// a budget. Bakes that don't fit wait in the queue, and the textures referenced the most are started first, since
+// every model using them waits on them.
+class TextureBakeQueue {
+public:
+    static TextureBakeQueue& getInstance();
+
+    // counts one more reference to a texture by a model's materials, model bakers remove theirs once they no longer
+    // wait on the texture, so that the counts only cover the models still being baked
+    void addReference(const QUrl& textureURL);
+    void removeReferences(const QUrl& textureURL, int count);
+    int getReferenceCount(const QUrl& textureURL) const;
+
+    // moves the baker to the thread and starts it once it fits in the budget, it is dropped if deleted before then
+    void push(const QSharedPointer<TextureBaker>& baker, QThread* thread, qint64 estimatedMemory);
+
+    // a rough guess of what baking the texture at the URL, or with the given content, will need at the most
+    static qint64 estimateMemory(const QUrl& textureURL, const QByteArray& textureContent);
+
+    void setMemoryBudget(qint64 memoryBudget);
+    qint64 getMemoryBudget() const;
+    qint64 getMemoryInUse() const;
+    int getPendingCount() const;
+
+private:
+    TextureBakeQueue();
+
+    class PendingBake {
+    public:
+        QWeakPointer<TextureBaker> baker;
+        QUrl textureURL;
+        qint64 estimatedMemory;
+        quint64 order;
+    };
+
+    void startPendingBakes();
+    void finishBake(TextureBaker* baker);
+
+    mutable std::mutex _mutex;
+    std::vector<PendingBake> _pendingBakes;
+    QHash<TextureBaker*, qint64> _runningBakes;
+    QHash<QUrl, int> _referenceCounts;
+    qint64 _memoryBudget;
+    qint64 _memoryInUse { 0 };
+    quint64 _nextOrder { 0 };
+};
+
+#endif // hifi_TextureBakeQueue_h
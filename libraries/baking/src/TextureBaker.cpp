@@ -50,6 +50,11 @@ TextureBaker::TextureBaker(const QUrl& textureURL, image::TextureUsage::Type tex
 }
 
 void TextureBaker::bake() {
+    // we may have been aborted while waiting in the texture bake queue
+    if (shouldStop()) {
+        return;
+    }
+
     // once our texture is loaded, kick off a the processing
     connect(this, &TextureBaker::originalTextureLoaded, this, &TextureBaker::processTexture);
 
@@ -124,7 +129,8 @@ void TextureBaker::processTexture() {
     // the baked textures need to have the source hash added for cache checks in Interface
     // so we add that to the processed texture before handling it off to be serialized
     auto hashData = QCryptographicHash::hash(_originalTexture, QCryptographicHash::Md5);
-    std::string hash = hashData.toHex().toStdString();
+    _originalTextureHash = hashData.toHex();
+    std::string hash = _originalTextureHash.toStdString();
 
     TextureMeta meta;
 
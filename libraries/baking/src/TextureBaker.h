@@ -34,6 +34,8 @@ public:
                  const QString& baseFilename = QString(), const QByteArray& textureContent = QByteArray());
 
     const QByteArray& getOriginalTexture() const { return _originalTexture; }
+    // the hex encoded MD5 of the original texture, once it has been processed
+    const QByteArray& getOriginalTextureHash() const { return _originalTextureHash; }
 
     QUrl getTextureURL() const { return _textureURL; }
 
@@ -42,6 +44,7 @@ public:
     virtual void setWasAborted(bool wasAborted) override;
 
     static void setCompressionEnabled(bool enabled) { _compressionEnabled = enabled; }
+    static bool isCompressionEnabled() { return _compressionEnabled; }
 
 public slots:
     virtual void bake() override;
@@ -59,6 +62,7 @@ private:
 
     QUrl _textureURL;
     QByteArray _originalTexture;
+    QByteArray _originalTextureHash;
     image::TextureUsage::Type _textureType;
 
     QString _baseFilename;
@@ -238,11 +238,11 @@ EntityItemProperties RenderableModelEntityItem::getProperties(const EntityProper
         properties.setRenderInfoHasTransparent(model->getRenderInfoHasTransparent());
 
         if (model->isLoaded()) {
-            // TODO: improve naturalDimensions in the future,
-            //       for now we've added this hack for setting natural dimensions of models
-            Extents meshExtents = model->getHFMModel().getUnscaledMeshExtents();
-            properties.setNaturalDimensions(meshExtents.maximum - meshExtents.minimum);
-            properties.calculateNaturalPosition(meshExtents.minimum, meshExtents.maximum);
+            glm::vec3 naturalDimensions;
+            glm::vec3 naturalPosition;
+            getNaturalDimensionsAndPosition(naturalDimensions, naturalPosition);
+            properties.setNaturalDimensions(naturalDimensions);
+            properties.setNaturalPosition(naturalPosition);
         }
     }
 
@@ -251,6 +251,19 @@ EntityItemProperties RenderableModelEntityItem::getProperties(const EntityProper
     return properties;
 }
 
+void RenderableModelEntityItem::getNaturalDimensionsAndPosition(glm::vec3& naturalDimensions, glm::vec3& naturalPosition) const {
+    ModelPointer model = getModel();
+    if (model && model->isLoaded()) {
+        // TODO: improve naturalDimensions in the future,
+        //       for now we've added this hack for setting natural dimensions of models
+        Extents meshExtents = model->getHFMModel().getUnscaledMeshExtents();
+        naturalDimensions = meshExtents.maximum - meshExtents.minimum;
+        naturalPosition = meshExtents.maximum - (naturalDimensions / 2.0f);
+    } else {
+        ModelEntityItem::getNaturalDimensionsAndPosition(naturalDimensions, naturalPosition);
+    }
+}
+
 bool RenderableModelEntityItem::supportsDetailedIntersection() const {
     return true;
 }
@@ -61,6 +61,7 @@ public:
     virtual void setUnscaledDimensions(const glm::vec3& value) override;
 
     virtual EntityItemProperties getProperties(const EntityPropertyFlags& desiredProperties, bool allowEmptyDesiredProperties) const override;
+    virtual void getNaturalDimensionsAndPosition(glm::vec3& naturalDimensions, glm::vec3& naturalPosition) const override;
     void doInitialModelSimulation();
     void updateModelBounds();
 
@@ -0,0 +1,181 @@
+//
+//  BulkEntityInserter.cpp
+//  libraries/entities/src
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "BulkEntityInserter.h"
+
+#include <algorithm>
+#include <cstdint>
+
+#include <QtConcurrent/QtConcurrentMap>
+#include <QtCore/QThreadPool>
+
+#include "EntityItem.h"
+#include "EntityTree.h"
+#include "EntityTreeElement.h"
+
+// batches smaller than this are built on the calling thread
+const int MIN_SUBTREE_TASK_SIZE = 256;
+// how many subtrees each thread gets, so that uneven ones still keep them all busy
+const int SUBTREE_TASKS_PER_THREAD = 4;
+
+// the same child as OctreeElement::getMyChildContainingPoint, for a point within the element
+static int getChildContainingPoint(const glm::vec3& point, const glm::vec3& center) {
+    return (point.x > center.x ? 4 : 0) | (point.y > center.y ? 2 : 0) | (point.z > center.z ? 1 : 0);
+}
+
+static int getChildAtLevel(uint64_t code, int level) {
+    return (int)(code >> (3 * (BulkEntityInserter::MAX_MORTON_DEPTH - 1 - level))) & 7;
+}
+
+BulkEntityInserter::BulkEntityInserter(EntityTreePointer tree, const QVector<EntityItemPointer>& newEntities) :
+    _tree(tree)
+{
+    _newEntities.reserve(newEntities.size());
+    for (const auto& entity : newEntities) {
+        // caller must have verified existence of the new entities
+        assert(entity);
+
+        bool success;
+        auto queryCube = entity->getQueryAACube(success);
+        NewEntity newEntity;
+        newEntity.entity = entity;
+        newEntity.box = queryCube.clamp((float)(-HALF_TREE_SCALE), (float)HALF_TREE_SCALE);
+        computeMortonCode(newEntity.box, newEntity.code, newEntity.depth);
+        _newEntities.push_back(newEntity);
+    }
+}
+
+// Descends the way EntityTreeElement::bestFitBounds does, stopping at the level where the box's corners fall in different
+// children. The cubes down to MAX_MORTON_DEPTH are exact in floats, so they match the elements' own.
+void BulkEntityInserter::computeMortonCode(const AABox& box, uint64_t& code, int& depth) {
+    glm::vec3 minimum = glm::clamp(box.getMinimumPoint(), (float)-HALF_TREE_SCALE, (float)HALF_TREE_SCALE);
+    glm::vec3 maximum = glm::clamp(box.getMaximumPoint(), (float)-HALF_TREE_SCALE, (float)HALF_TREE_SCALE);
+
+    glm::vec3 corner((float)-HALF_TREE_SCALE);
+    float scale = (float)TREE_SCALE;
+    code = 0;
+    depth = 0;
+    while (depth < MAX_MORTON_DEPTH) {
+        float childScale = scale / 2.0f;
+        if (childScale <= SMALLEST_REASONABLE_OCTREE_ELEMENT_SCALE) {
+            break;
+        }
+
+        glm::vec3 center = corner + glm::vec3(childScale);
+        int child = getChildContainingPoint(minimum, center);
+        if (child != getChildContainingPoint(maximum, center)) {
+            break;
+        }
+
+        code |= (uint64_t)child << (3 * (MAX_MORTON_DEPTH - 1 - depth));
+        corner += glm::vec3((child & 4) ? childScale : 0.0f, (child & 2) ? childScale : 0.0f, (child & 1) ? childScale : 0.0f);
+        scale = childScale;
+        ++depth;
+    }
+}
+
+void BulkEntityInserter::insert() {
+    if (_newEntities.empty()) {
+        return;
+    }
+
+    for (const auto& newEntity : _newEntities) {
+        _tree->addEntityMapEntry(newEntity.entity);
+    }
+
+    // ancestors sort before their descendants, and entities sharing an element keep their order
+    std::stable_sort(_newEntities.begin(), _newEntities.end(), [](const NewEntity& a, const NewEntity& b) {
+        return a.code < b.code || (a.code == b.code && a.depth < b.depth);
+    });
+
+    int threadCount = std::max(QThreadPool::globalInstance()->maxThreadCount(), 1);
+    int taskSize = std::max((int)_newEntities.size() / (threadCount * SUBTREE_TASKS_PER_THREAD), MIN_SUBTREE_TASK_SIZE);
+
+    Subtree root { _tree->getRoot(), 0, (int)_newEntities.size(), 0 };
+    std::vector<Subtree> tasks;
+    std::vector<OctreeElementPointer> splitElements;
+    splitSubtree(root, taskSize, tasks, splitElements);
+
+    // the subtrees share no elements, and creating elements is safe across threads
+    if (tasks.size() > 1) {
+        QtConcurrent::blockingMap(tasks, [this](const Subtree& subtree) {
+            buildSubtree(subtree);
+        });
+    } else {
+        for (const auto& subtree : tasks) {
+            buildSubtree(subtree);
+        }
+    }
+
+    // mark the elements above the subtrees as changed, bottom up like the subtrees themselves
+    for (auto it = splitElements.rbegin(); it != splitElements.rend(); ++it) {
+        (*it)->markWithChangedTime();
+    }
+}
+
+// Adds the entities for the subtree's top element, the first of its range, and returns the index past them.
+int BulkEntityInserter::addEntitiesAt(const Subtree& subtree) {
+    int index = subtree.begin;
+    while (index < subtree.end && _newEntities[index].depth == subtree.level) {
+        const NewEntity& newEntity = _newEntities[index++];
+
+        // the code stops at MAX_MORTON_DEPTH, so small enough entities go further down from there
+        EntityTreeElementPointer element = std::static_pointer_cast<EntityTreeElement>(subtree.element);
+        while (subtree.level == MAX_MORTON_DEPTH && !element->bestFitBounds(newEntity.box)) {
+            int childIndex = element->getMyChildContaining(newEntity.box);
+            if (childIndex == OctreeElement::CHILD_UNKNOWN) {
+                break;
+            }
+            element = std::static_pointer_cast<EntityTreeElement>(element->addChildAtIndex(childIndex));
+            element->markWithChangedTime();
+        }
+        element->addEntityItem(newEntity.entity);
+    }
+    return index;
+}
+
+// Calls f with each child that the entities from begin on go in or below, and the range of them that do.
+template <typename F>
+void BulkEntityInserter::forEachChild(const Subtree& subtree, int begin, F f) {
+    while (begin < subtree.end) {
+        int childIndex = getChildAtLevel(_newEntities[begin].code, subtree.level);
+        int end = begin + 1;
+        while (end < subtree.end && getChildAtLevel(_newEntities[end].code, subtree.level) == childIndex) {
+            ++end;
+        }
+
+        // either merges into the child already there or starts a new one
+        OctreeElementPointer child = subtree.element->addChildAtIndex(childIndex);
+        f(Subtree { child, begin, end, subtree.level + 1 });
+        begin = end;
+    }
+}
+
+void BulkEntityInserter::splitSubtree(const Subtree& subtree, int taskSize, std::vector<Subtree>& tasks,
+                                      std::vector<OctreeElementPointer>& splitElements) {
+    if (subtree.end - subtree.begin <= taskSize) {
+        tasks.push_back(subtree);
+        return;
+    }
+
+    splitElements.push_back(subtree.element);
+    int begin = addEntitiesAt(subtree);
+    forEachChild(subtree, begin, [&](const Subtree& child) {
+        splitSubtree(child, taskSize, tasks, splitElements);
+    });
+}
+
+void BulkEntityInserter::buildSubtree(const Subtree& subtree) {
+    int begin = addEntitiesAt(subtree);
+    forEachChild(subtree, begin, [&](const Subtree& child) {
+        buildSubtree(child);
+    });
+    subtree.element->markWithChangedTime();
+}
@@ -0,0 +1,73 @@
+//
+//  BulkEntityInserter.h
+//  libraries/entities/src
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_BulkEntityInserter_h
+#define hifi_BulkEntityInserter_h
+
+#include <memory>
+#include <vector>
+
+#include <QVector>
+
+#include <AABox.h>
+#include <OctreeElement.h>
+
+#include "EntityTypes.h"
+
+class EntityTree;
+using EntityTreePointer = std::shared_ptr<EntityTree>;
+
+// Inserts many new entities into the tree together, rather than walking down from the root for each one.
+//
+// The entities are sorted by the Morton code of their query AACube, which is the path of child indices down to the
+// element that best fits it. Each subtree's entities are then contiguous, with the ones for its top element first, and
+// the subtrees are built, or merged into the elements already there, in a single pass. Large batches split the top
+// of the tree up and build the subtrees below it on the worker threads.
+class BulkEntityInserter {
+public:
+    // the deepest level a Morton code reaches, 3 bits per level, entities below it are placed from there
+    static const int MAX_MORTON_DEPTH = 21;
+
+    BulkEntityInserter(EntityTreePointer tree, const QVector<EntityItemPointer>& newEntities);
+
+    // the caller must hold the tree's write lock
+    void insert();
+
+    static void computeMortonCode(const AABox& box, uint64_t& code, int& depth);
+
+private:
+    class NewEntity {
+    public:
+        EntityItemPointer entity;
+        AABox box;
+        uint64_t code { 0 };
+        int depth { 0 };
+    };
+
+    // an element and the range of the sorted entities that go in it or below
+    class Subtree {
+    public:
+        OctreeElementPointer element;
+        int begin;
+        int end;
+        int level;
+    };
+
+    void splitSubtree(const Subtree& subtree, int taskSize, std::vector<Subtree>& tasks,
+                      std::vector<OctreeElementPointer>& splitElements);
+    void buildSubtree(const Subtree& subtree);
+    int addEntitiesAt(const Subtree& subtree);
+    template <typename F> void forEachChild(const Subtree& subtree, int begin, F f);
+
+    EntityTreePointer _tree;
+    std::vector<NewEntity> _newEntities;
+};
+
+#endif // hifi_BulkEntityInserter_h
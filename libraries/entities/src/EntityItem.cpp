@@ -1390,6 +1390,12 @@ EntityItemProperties EntityItem::getProperties(const EntityPropertyFlags& desire
     return properties;
 }
 
+void EntityItem::getNaturalDimensionsAndPosition(glm::vec3& naturalDimensions, glm::vec3& naturalPosition) const {
+    // same as the EntityItemProperties defaults
+    naturalDimensions = glm::vec3(1.0f);
+    naturalPosition = glm::vec3(0.0f);
+}
+
 void EntityItem::getTransformAndVelocityProperties(EntityItemProperties& properties) const {
     if (!properties._positionChanged) {
         properties._position = getLocalPosition();
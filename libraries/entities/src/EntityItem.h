@@ -100,6 +100,10 @@ public:
     // methods for getting/setting all properties of an entity
     virtual EntityItemProperties getProperties(const EntityPropertyFlags& desiredProperties = EntityPropertyFlags(), bool allowEmptyDesiredProperties = false) const;
 
+    /// the dimensions and center of the entity's unscaled mesh if it has one, reported as naturalDimensions and
+    /// naturalPosition by getProperties()
+    virtual void getNaturalDimensionsAndPosition(glm::vec3& naturalDimensions, glm::vec3& naturalPosition) const;
+
     /// returns true if something changed
     // This function calls setSubClass properties and detects if any property changes value.
     // If something changed then the "somethingChangedNotification" calls happens
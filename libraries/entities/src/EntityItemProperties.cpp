@@ -172,10 +172,14 @@ uint16_t getCollisionGroupAsBitMask(const QStringRef& name) {
 }
 
 QString EntityItemProperties::getCollisionMaskAsString() const {
+    return getNameForCollisionMask(_collisionMask);
+}
+
+QString EntityItemProperties::getNameForCollisionMask(uint16_t collisionMask) {
     QString maskString("");
     for (int i = 0; i < NUM_USER_COLLISION_GROUPS; ++i) {
         uint16_t group = 0x0001 << i;
-        if (group & _collisionMask) {
+        if (group & collisionMask) {
             maskString.append(getCollisionGroupAsString(group));
             maskString.append(',');
         }
@@ -304,7 +308,11 @@ void EntityItemProperties::setMaterialMappingModeFromString(const QString& mater
 }
 
 QString EntityItemProperties::getEntityHostTypeAsString() const {
-    switch (_entityHostType) {
+    return getNameForEntityHostType(_entityHostType);
+}
+
+QString EntityItemProperties::getNameForEntityHostType(entity::HostType entityHostType) {
+    switch (entityHostType) {
         case entity::HostType::DOMAIN:
             return "domain";
         case entity::HostType::AVATAR:
@@ -5000,12 +5008,9 @@ void EntityItemProperties::propertiesToBlob(QScriptEngine& scriptEngine, const Q
 QDebug& operator<<(QDebug& dbg, const EntityPropertyFlags& f) {
     QString result = "[ ";
 
-    for (int i = 0; i < PROP_AFTER_LAST_ITEM; i++) {
-        auto prop = EntityPropertyList(i);
-        if (f.getHasProperty(prop)) {
-            result = result + _enumsToPropertyStrings[prop] + " ";
-        }
-    }
+    f.forEachFlag([&](EntityPropertyList prop) {
+        result = result + _enumsToPropertyStrings[prop] + " ";
+    });
 
     result += "]";
     dbg.nospace() << result;
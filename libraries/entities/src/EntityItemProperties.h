@@ -412,6 +412,7 @@ public:
     void setNaturalDimensions(const glm::vec3& value) { _naturalDimensions = value; }
     
     const glm::vec3& getNaturalPosition() const { return _naturalPosition; }
+    void setNaturalPosition(const glm::vec3& value) { _naturalPosition = value; }
     void calculateNaturalPosition(const glm::vec3& min, const glm::vec3& max);
     
     const QVariantMap& getTextureNames() const { return _textureNames; }
@@ -482,6 +483,9 @@ public:
 
     void convertToCloneProperties(const EntityItemID& entityIDToClone);
 
+    static QString getNameForEntityHostType(entity::HostType entityHostType);
+    static QString getNameForCollisionMask(uint16_t collisionMask);
+
 protected:
     QString getCollisionMaskAsString() const;
     void setCollisionMaskFromString(const QString& maskString);
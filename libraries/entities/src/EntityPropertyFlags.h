@@ -357,6 +357,10 @@ enum EntityPropertyList {
     // WARNING!!! DO NOT ADD PROPS_xxx here unless you really really meant to.... Add them UP above
 };
 
+template<> struct PropertyFlagsTraits<EntityPropertyList> {
+    static const int FLAG_COUNT = PROP_AFTER_LAST_ITEM;
+};
+
 typedef PropertyFlags<EntityPropertyList> EntityPropertyFlags;
 
 // this is set at the top of EntityItemProperties.cpp to PROP_AFTER_LAST_ITEM - 1.  PROP_AFTER_LAST_ITEM is always
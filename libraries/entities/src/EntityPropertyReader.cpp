@@ -0,0 +1,342 @@
+//
+//  EntityPropertyReader.cpp
+//  libraries/entities/src
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "EntityPropertyReader.h"
+
+#include <QtScript/QScriptEngine>
+#include <QtScript/QScriptString>
+
+#include <PrimitiveMode.h>
+#include <RegisteredMetaTypes.h>
+#include <RenderLayer.h>
+#include <SharedUtil.h>
+
+#include "EntityItemProperties.h"
+
+using ValueType = EntityPropertyReader::ValueType;
+using Value = EntityPropertyReader::Value;
+using Context = EntityPropertyReader::Context;
+using Accessor = EntityPropertyReader::Accessor;
+
+namespace {
+
+void setVec3(Value& value, const glm::vec3& vec3) {
+    value.vector[0] = vec3.x;
+    value.vector[1] = vec3.y;
+    value.vector[2] = vec3.z;
+}
+
+void setQuat(Value& value, const glm::quat& quat) {
+    value.vector[0] = quat.x;
+    value.vector[1] = quat.y;
+    value.vector[2] = quat.z;
+    value.vector[3] = quat.w;
+}
+
+void setAACube(Value& value, const AACube& aaCube) {
+    setVec3(value, aaCube.getCorner());
+    value.vector[3] = aaCube.getScale();
+}
+
+glm::vec3 getNaturalDimensions(const Context& context) {
+    glm::vec3 naturalDimensions;
+    glm::vec3 naturalPosition;
+    context.entity.getNaturalDimensionsAndPosition(naturalDimensions, naturalPosition);
+    return naturalDimensions;
+}
+
+glm::vec3 getNaturalPosition(const Context& context) {
+    glm::vec3 naturalDimensions;
+    glm::vec3 naturalPosition;
+    context.entity.getNaturalDimensionsAndPosition(naturalDimensions, naturalPosition);
+    return naturalPosition;
+}
+
+// the world space values match convertPropertiesToScriptSemantics() in EntityScriptingInterface.cpp
+glm::vec3 getScriptPosition(const Context& context) {
+    bool success;
+    return SpatiallyNestable::localToWorld(context.entity.getLocalPosition(), context.parentID, context.parentJointIndex,
+        context.scalesWithParent, success);
+}
+
+glm::quat getScriptRotation(const Context& context) {
+    bool success;
+    return SpatiallyNestable::localToWorld(context.entity.getLocalOrientation(), context.parentID,
+        context.parentJointIndex, context.scalesWithParent, success);
+}
+
+glm::vec3 getScriptDimensions(const Context& context) {
+    if (!context.scriptSemantics) {
+        return context.entity.getUnscaledDimensions();
+    }
+    bool success;
+    return SpatiallyNestable::localToWorldDimensions(context.entity.getUnscaledDimensions(), context.parentID,
+        context.parentJointIndex, context.scalesWithParent, success);
+}
+
+glm::vec3 getScriptVelocity(const Context& context) {
+    if (!context.scriptSemantics) {
+        return context.entity.getLocalVelocity();
+    }
+    bool success;
+    return SpatiallyNestable::localToWorldVelocity(context.entity.getLocalVelocity(), context.parentID,
+        context.parentJointIndex, context.scalesWithParent, success);
+}
+
+glm::vec3 getScriptAngularVelocity(const Context& context) {
+    if (!context.scriptSemantics) {
+        return context.entity.getLocalAngularVelocity();
+    }
+    bool success;
+    return SpatiallyNestable::localToWorldAngularVelocity(context.entity.getLocalAngularVelocity(), context.parentID,
+        context.parentJointIndex, context.scalesWithParent, success);
+}
+
+const int NO_PROPERTY = -1;
+
+#define READ_PSUEDO(F, N, T, R) \
+    { #N, NO_PROPERTY, EntityPsuedoPropertyFlag::F, ValueType::T, [](const Context& context, Value& value) { R; } }
+#define READ_PROPERTY(P, N, T, R) \
+    { #N, P, EntityPsuedoPropertyFlag::None, ValueType::T, [](const Context& context, Value& value) { R; } }
+#define READ_BOOL(P, N, G) READ_PROPERTY(P, N, Bool, value.flag = context.entity.G())
+#define READ_NUMBER(P, N, G) READ_PROPERTY(P, N, Number, value.number = context.entity.G())
+#define READ_STRING(P, N, G) READ_PROPERTY(P, N, String, value.string = context.entity.G())
+#define READ_UUID(P, N, G) READ_PROPERTY(P, N, String, value.string = context.entity.G().toString())
+#define READ_VEC3(P, N, G) READ_PROPERTY(P, N, Vec3, setVec3(value, context.entity.G()))
+
+// In the order EntityItemProperties::copyToScriptValue() writes them, only properties every entity type has.
+const Accessor ACCESSORS[] = {
+    READ_PSUEDO(ID, id, String, value.string = context.entity.getID().toString()),
+    READ_PSUEDO(Type, type, String, value.string = EntityTypes::getEntityTypeName(context.entity.getType())),
+    READ_PSUEDO(Age, age, Number, value.number = context.entity.getAge()),
+    READ_PSUEDO(AgeAsText, ageAsText, String, value.string = formatSecondsElapsed(context.entity.getAge())),
+    READ_PSUEDO(LastEdited, lastEdited, Number, value.number = context.entity.getLastEdited()),
+
+    READ_PROPERTY(PROP_DIMENSIONS, naturalDimensions, Vec3, setVec3(value, getNaturalDimensions(context))),
+    READ_PROPERTY(PROP_POSITION, naturalPosition, Vec3, setVec3(value, getNaturalPosition(context))),
+
+    // Core
+    READ_BOOL(PROP_VISIBLE, visible, getVisible),
+    READ_STRING(PROP_NAME, name, getName),
+    READ_BOOL(PROP_LOCKED, locked, getLocked),
+    READ_STRING(PROP_USER_DATA, userData, getUserData),
+    READ_STRING(PROP_HREF, href, getHref),
+    READ_STRING(PROP_DESCRIPTION, description, getDescription),
+    READ_PROPERTY(PROP_POSITION, position, Vec3, setVec3(value, getScriptPosition(context))),
+    READ_PROPERTY(PROP_DIMENSIONS, dimensions, Vec3, setVec3(value, getScriptDimensions(context))),
+    READ_PROPERTY(PROP_ROTATION, rotation, Quat, setQuat(value, getScriptRotation(context))),
+    READ_VEC3(PROP_REGISTRATION_POINT, registrationPoint, getRegistrationPoint),
+    READ_NUMBER(PROP_CREATED, created, getCreated),
+    READ_UUID(PROP_LAST_EDITED_BY, lastEditedBy, getLastEditedBy),
+    READ_PROPERTY(PROP_ENTITY_HOST_TYPE, entityHostType, String,
+        value.string = EntityItemProperties::getNameForEntityHostType(context.entity.getEntityHostType())),
+    READ_UUID(PROP_OWNING_AVATAR_ID, owningAvatarID, getOwningAvatarID),
+    READ_UUID(PROP_PARENT_ID, parentID, getParentID),
+    READ_NUMBER(PROP_PARENT_JOINT_INDEX, parentJointIndex, getParentJointIndex),
+    READ_PROPERTY(PROP_QUERY_AA_CUBE, queryAACube, AACube, setAACube(value, context.entity.getQueryAACube())),
+    READ_BOOL(PROP_CAN_CAST_SHADOW, canCastShadow, getCanCastShadow),
+    READ_BOOL(PROP_VISIBLE_IN_SECONDARY_CAMERA, isVisibleInSecondaryCamera, isVisibleInSecondaryCamera),
+    READ_PROPERTY(PROP_RENDER_LAYER, renderLayer, String,
+        value.string = RenderLayerHelpers::getNameForRenderLayer(context.entity.getRenderLayer())),
+    READ_PROPERTY(PROP_PRIMITIVE_MODE, primitiveMode, String,
+        value.string = PrimitiveModeHelpers::getNameForPrimitiveMode(context.entity.getPrimitiveMode())),
+    READ_BOOL(PROP_IGNORE_PICK_INTERSECTION, ignorePickIntersection, getIgnorePickIntersection),
+
+    // Physics
+    READ_NUMBER(PROP_DENSITY, density, getDensity),
+    READ_PROPERTY(PROP_VELOCITY, velocity, Vec3, setVec3(value, getScriptVelocity(context))),
+    READ_PROPERTY(PROP_ANGULAR_VELOCITY, angularVelocity, Vec3, setVec3(value, getScriptAngularVelocity(context))),
+    READ_VEC3(PROP_GRAVITY, gravity, getGravity),
+    READ_VEC3(PROP_ACCELERATION, acceleration, getAcceleration),
+    READ_NUMBER(PROP_DAMPING, damping, getDamping),
+    READ_NUMBER(PROP_ANGULAR_DAMPING, angularDamping, getAngularDamping),
+    READ_NUMBER(PROP_RESTITUTION, restitution, getRestitution),
+    READ_NUMBER(PROP_FRICTION, friction, getFriction),
+    READ_NUMBER(PROP_LIFETIME, lifetime, getLifetime),
+    READ_BOOL(PROP_COLLISIONLESS, collisionless, getCollisionless),
+    READ_BOOL(PROP_COLLISIONLESS, ignoreForCollisions, getCollisionless), // legacy support
+    READ_NUMBER(PROP_COLLISION_MASK, collisionMask, getCollisionMask),
+    READ_PROPERTY(PROP_COLLISION_MASK, collidesWith, String,
+        value.string = EntityItemProperties::getNameForCollisionMask(context.entity.getCollisionMask())),
+    READ_BOOL(PROP_DYNAMIC, dynamic, getDynamic),
+    READ_BOOL(PROP_DYNAMIC, collisionsWillMove, getDynamic), // legacy support
+    READ_STRING(PROP_COLLISION_SOUND_URL, collisionSoundURL, getCollisionSoundURL),
+
+    // Cloning
+    READ_BOOL(PROP_CLONEABLE, cloneable, getCloneable),
+    READ_NUMBER(PROP_CLONE_LIFETIME, cloneLifetime, getCloneLifetime),
+    READ_NUMBER(PROP_CLONE_LIMIT, cloneLimit, getCloneLimit),
+    READ_BOOL(PROP_CLONE_DYNAMIC, cloneDynamic, getCloneDynamic),
+    READ_BOOL(PROP_CLONE_AVATAR_ENTITY, cloneAvatarEntity, getCloneAvatarEntity),
+    READ_UUID(PROP_CLONE_ORIGIN_ID, cloneOriginID, getCloneOriginID),
+
+    // Scripts
+    READ_STRING(PROP_SCRIPT, script, getScript),
+    READ_NUMBER(PROP_SCRIPT_TIMESTAMP, scriptTimestamp, getScriptTimestamp),
+    READ_STRING(PROP_SERVER_SCRIPTS, serverScripts, getServerScripts),
+
+    // Certifiable Properties
+    READ_STRING(PROP_ITEM_NAME, itemName, getItemName),
+    READ_STRING(PROP_ITEM_DESCRIPTION, itemDescription, getItemDescription),
+    READ_STRING(PROP_ITEM_CATEGORIES, itemCategories, getItemCategories),
+    READ_STRING(PROP_ITEM_ARTIST, itemArtist, getItemArtist),
+    READ_STRING(PROP_ITEM_LICENSE, itemLicense, getItemLicense),
+    READ_NUMBER(PROP_LIMITED_RUN, limitedRun, getLimitedRun),
+    READ_STRING(PROP_MARKETPLACE_ID, marketplaceID, getMarketplaceID),
+    READ_NUMBER(PROP_EDITION_NUMBER, editionNumber, getEditionNumber),
+    READ_NUMBER(PROP_ENTITY_INSTANCE_NUMBER, entityInstanceNumber, getEntityInstanceNumber),
+    READ_STRING(PROP_CERTIFICATE_ID, certificateID, getCertificateID),
+    READ_NUMBER(PROP_STATIC_CERTIFICATE_VERSION, staticCertificateVersion, getStaticCertificateVersion),
+
+    // Local props for scripts
+    READ_VEC3(PROP_LOCAL_POSITION, localPosition, getLocalPosition),
+    READ_PROPERTY(PROP_LOCAL_ROTATION, localRotation, Quat, setQuat(value, context.entity.getLocalOrientation())),
+    READ_VEC3(PROP_LOCAL_VELOCITY, localVelocity, getLocalVelocity),
+    READ_VEC3(PROP_LOCAL_ANGULAR_VELOCITY, localAngularVelocity, getLocalAngularVelocity),
+    READ_VEC3(PROP_LOCAL_DIMENSIONS, localDimensions, getUnscaledDimensions),
+
+    READ_PSUEDO(ClientOnly, clientOnly, Bool, value.flag = context.entity.getEntityHostType() == entity::HostType::AVATAR),
+    READ_PSUEDO(AvatarEntity, avatarEntity, Bool,
+        value.flag = context.entity.getEntityHostType() == entity::HostType::AVATAR),
+    READ_PSUEDO(LocalEntity, localEntity, Bool, value.flag = context.entity.getEntityHostType() == entity::HostType::LOCAL),
+};
+
+const EntityPropertyFlags& getSupportedProperties() {
+    static const EntityPropertyFlags supportedProperties = [] {
+        EntityPropertyFlags properties;
+        for (const auto& accessor : ACCESSORS) {
+            if (accessor.property != NO_PROPERTY) {
+                properties.setHasProperty((EntityPropertyList)accessor.property);
+            }
+        }
+        return properties;
+    }();
+    return supportedProperties;
+}
+
+const EntityPsuedoPropertyFlags& getSupportedPsuedoProperties() {
+    static const EntityPsuedoPropertyFlags supportedPsuedoProperties = [] {
+        EntityPsuedoPropertyFlags properties;
+        properties.set(EntityPsuedoPropertyFlag::FlagsActive);
+        for (const auto& accessor : ACCESSORS) {
+            if (accessor.property == NO_PROPERTY) {
+                properties.set(accessor.psuedoProperty);
+            }
+        }
+        return properties;
+    }();
+    return supportedPsuedoProperties;
+}
+
+}
+
+std::unique_ptr<EntityPropertyReader> EntityPropertyReader::compile(const EntityPropertyFlags& desiredProperties,
+        const EntityPsuedoPropertyFlags& psuedoPropertyFlags, bool needsScriptSemantics) {
+    // without a list of properties the script gets everything, including the type specific properties
+    if (!psuedoPropertyFlags.test(EntityPsuedoPropertyFlag::FlagsActive)) {
+        return nullptr;
+    }
+
+    if ((psuedoPropertyFlags & ~getSupportedPsuedoProperties()).any()) {
+        return nullptr;
+    }
+
+    bool isSupported = true;
+    const auto& supportedProperties = getSupportedProperties();
+    desiredProperties.forEachFlag([&](EntityPropertyList property) {
+        isSupported = isSupported && supportedProperties.getHasProperty(property);
+    });
+    if (!isSupported) {
+        return nullptr;
+    }
+
+    std::vector<const Accessor*> accessors;
+    for (const auto& accessor : ACCESSORS) {
+        bool isDesired = accessor.property == NO_PROPERTY ? psuedoPropertyFlags.test(accessor.psuedoProperty) :
+            desiredProperties.getHasProperty((EntityPropertyList)accessor.property);
+        if (isDesired) {
+            accessors.push_back(&accessor);
+        }
+    }
+
+    return std::unique_ptr<EntityPropertyReader>(new EntityPropertyReader(accessors, needsScriptSemantics));
+}
+
+EntityPropertyReader::EntityPropertyReader(std::vector<const Accessor*> accessors, bool needsScriptSemantics) :
+    _accessors(accessors),
+    _needsScriptSemantics(needsScriptSemantics)
+{
+}
+
+void EntityPropertyReader::read(const EntityItem& entity) {
+    // copyToScriptValue() writes nothing for an entity that was never given its properties
+    bool hasValues = entity.getCreated() != UNKNOWN_CREATED_TIME;
+    _hasValues.push_back(hasValues);
+    if (!hasValues) {
+        return;
+    }
+
+    Context context { entity, _needsScriptSemantics, QUuid(), 0, false };
+    if (_needsScriptSemantics) {
+        context.parentID = entity.getParentID();
+        context.parentJointIndex = entity.getParentJointIndex();
+        context.scalesWithParent = entity.getScalesWithParent();
+    }
+
+    size_t first = _values.size();
+    _values.resize(first + _accessors.size());
+    for (size_t i = 0; i < _accessors.size(); i++) {
+        _accessors[i]->read(context, _values[first + i]);
+    }
+}
+
+QScriptValue EntityPropertyReader::toScriptValue(QScriptEngine* engine) const {
+    std::vector<QScriptString> names;
+    names.reserve(_accessors.size());
+    for (const auto& accessor : _accessors) {
+        names.push_back(engine->toStringHandle(accessor->name));
+    }
+
+    QScriptValue result = engine->newArray((uint)_hasValues.size());
+    auto value = _values.begin();
+    for (size_t i = 0; i < _hasValues.size(); i++) {
+        QScriptValue properties = engine->newObject();
+        if (_hasValues[i]) {
+            for (size_t j = 0; j < _accessors.size(); j++, ++value) {
+                QScriptValue scriptValue;
+                switch (_accessors[j]->type) {
+                    case ValueType::Bool:
+                        scriptValue = QScriptValue(value->flag);
+                        break;
+                    case ValueType::Number:
+                        scriptValue = QScriptValue(value->number);
+                        break;
+                    case ValueType::String:
+                        scriptValue = QScriptValue(value->string);
+                        break;
+                    case ValueType::Vec3:
+                        scriptValue = vec3ToScriptValue(engine, glm::vec3(value->vector[0], value->vector[1], value->vector[2]));
+                        break;
+                    case ValueType::Quat:
+                        scriptValue = quatToScriptValue(engine,
+                            glm::quat(value->vector[3], value->vector[0], value->vector[1], value->vector[2]));
+                        break;
+                    case ValueType::AACube:
+                        scriptValue = aaCubeToScriptValue(engine,
+                            AACube(glm::vec3(value->vector[0], value->vector[1], value->vector[2]), value->vector[3]));
+                        break;
+                }
+                properties.setProperty(names[j], scriptValue);
+            }
+        }
+        result.setProperty((quint32)i, properties);
+    }
+    return result;
+}
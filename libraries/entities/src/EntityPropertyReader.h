@@ -0,0 +1,89 @@
+//
+//  EntityPropertyReader.h
+//  libraries/entities/src
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_EntityPropertyReader_h
+#define hifi_EntityPropertyReader_h
+
+#include <memory>
+#include <vector>
+
+#include <QtCore/QString>
+#include <QtScript/QScriptValue>
+
+#include "EntityItem.h"
+#include "EntityPropertyFlags.h"
+#include "EntityPsuedoPropertyFlags.h"
+
+class QScriptEngine;
+
+// Reads a fixed set of properties straight from entities for Entities.getMultipleEntityProperties().
+//
+// The desired properties are resolved once per query into a list of accessors, each of which reads one value from
+// the EntityItem without building an EntityItemProperties. The script objects come out with the same properties, in
+// the same order, as EntityItemProperties::copyToScriptValue() would give them.
+class EntityPropertyReader {
+public:
+    enum class ValueType : uint8_t {
+        Bool,
+        Number,
+        String,
+        Vec3,
+        Quat,
+        AACube
+    };
+
+    struct Value {
+        float vector[4]; // Vec3, Quat as x, y, z, w, AACube as corner and scale
+        double number;
+        bool flag;
+        QString string;
+    };
+
+    // per entity state the accessors share
+    struct Context {
+        const EntityItem& entity;
+        bool scriptSemantics;
+        QUuid parentID;
+        quint16 parentJointIndex;
+        bool scalesWithParent;
+    };
+
+    struct Accessor {
+        const char* name;
+        int property; // an EntityPropertyList value, or -1 when psuedoProperty is used
+        int psuedoProperty;
+        ValueType type;
+        void (*read)(const Context& context, Value& value);
+    };
+
+    /// returns null when a desired property can't be read directly, use EntityItem::getProperties() for those
+    /// \param needsScriptSemantics position, rotation, velocity and dimensions are converted to world space
+    static std::unique_ptr<EntityPropertyReader> compile(const EntityPropertyFlags& desiredProperties,
+        const EntityPsuedoPropertyFlags& psuedoPropertyFlags, bool needsScriptSemantics);
+
+    /// reads the entity's values, call with the tree read locked
+    void read(const EntityItem& entity);
+
+    int getEntityCount() const { return (int)_hasValues.size(); }
+
+    /// writes one object per entity read, in the order they were read
+    QScriptValue toScriptValue(QScriptEngine* engine) const;
+
+private:
+    EntityPropertyReader(std::vector<const Accessor*> accessors, bool needsScriptSemantics);
+
+    std::vector<const Accessor*> _accessors;
+    bool _needsScriptSemantics;
+
+    std::vector<Value> _values; // _accessors.size() values per entity
+    std::vector<bool> _hasValues; // false for entities copyToScriptValue() would write an empty object for
+};
+
+#endif // hifi_EntityPropertyReader_h
@@ -30,6 +30,7 @@
 #include "EntitiesLogging.h"
 #include "EntityDynamicFactoryInterface.h"
 #include "EntityDynamicInterface.h"
+#include "EntityPropertyReader.h"
 #include "EntitySimulation.h"
 #include "EntityTree.h"
 #include "LightEntityItem.h"
@@ -719,6 +720,30 @@ QScriptValue EntityScriptingInterface::getMultipleEntityPropertiesInternal(QScri
         desiredProperties.setHasProperty(PROP_PARENT_ID);
         desiredProperties.setHasProperty(PROP_PARENT_JOINT_INDEX);
     }
+
+    // when every desired property can be read straight from the entities, skip building EntityItemProperties
+    auto reader = _entityTree ? EntityPropertyReader::compile(desiredProperties, psuedoPropertyFlags, needsScriptSemantics) : nullptr;
+    if (reader) {
+        {
+            PROFILE_RANGE(script_entities, "EntityScriptingInterface::getMultipleEntityProperties>Reading Properties");
+            int i = 0;
+            const int lockAmount = 500;
+            int size = entityIDs.size();
+            while (i < size) {
+                _entityTree->withReadLock([&] {
+                    for (int j = 0; j < lockAmount && i < size; ++i, ++j) {
+                        const EntityItemPointer entity = _entityTree->findEntityByEntityItemID(EntityItemID(entityIDs.at(i)));
+                        if (entity) {
+                            reader->read(*entity);
+                        }
+                    }
+                });
+            }
+        }
+        PROFILE_RANGE(script_entities, "EntityScriptingInterface::getMultipleEntityProperties>Compiled Properties");
+        return reader->toScriptValue(engine);
+    }
+
     QVector<EntityPropertiesResult> resultProperties;
     if (_entityTree) {
         PROFILE_RANGE(script_entities, "EntityScriptingInterface::getMultipleEntityProperties>Obtaining Properties");
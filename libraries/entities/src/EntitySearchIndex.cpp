@@ -0,0 +1,107 @@
+//
+//  EntitySearchIndex.cpp
+//  libraries/entities/src
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "EntitySearchIndex.h"
+
+const EntitySearchIndex::Bucket EntitySearchIndex::EMPTY_BUCKET;
+
+void EntitySearchIndex::addEntity(const EntityItemPointer& entity) {
+    EntityItemID id = entity->getEntityItemID();
+    if (_entries.contains(id)) {
+        return;
+    }
+
+    Entry entry { normalizeName(entity->getName()), entity->getType() };
+    _namedEntities[entry.name].insert(id, entity);
+    if (entry.type >= 0 && entry.type < EntityTypes::NUM_TYPES) {
+        _types[entry.type].insert(id, entity);
+    }
+    _entries.insert(id, entry);
+
+    addToBounds(entity);
+}
+
+void EntitySearchIndex::removeEntity(const EntityItemID& id) {
+    auto entryItr = _entries.find(id);
+    if (entryItr == _entries.end()) {
+        return;
+    }
+
+    removeName(id, entryItr->name);
+    if (entryItr->type >= 0 && entryItr->type < EntityTypes::NUM_TYPES) {
+        _types[entryItr->type].remove(id);
+    }
+    _entries.erase(entryItr);
+
+    if (_entries.isEmpty()) {
+        _bounds.clear();
+    }
+}
+
+void EntitySearchIndex::updateName(const EntityItemPointer& entity) {
+    EntityItemID id = entity->getEntityItemID();
+    auto entryItr = _entries.find(id);
+    if (entryItr == _entries.end()) {
+        return;
+    }
+
+    QString name = normalizeName(entity->getName());
+    if (name == entryItr->name) {
+        return;
+    }
+
+    removeName(id, entryItr->name);
+    entryItr->name = name;
+    _namedEntities[name].insert(id, entity);
+
+    addToBounds(entity);
+}
+
+void EntitySearchIndex::clear() {
+    _entries.clear();
+    for (auto& bucket : _types) {
+        bucket.clear();
+    }
+    _namedEntities.clear();
+    _bounds.clear();
+}
+
+const EntitySearchIndex::Bucket& EntitySearchIndex::getEntitiesWithType(EntityTypes::EntityType type) const {
+    if (type >= 0 && type < EntityTypes::NUM_TYPES) {
+        return _types[type];
+    }
+    return EMPTY_BUCKET;
+}
+
+const EntitySearchIndex::Bucket& EntitySearchIndex::getEntitiesWithName(const QString& name) const {
+    auto bucketItr = _namedEntities.find(normalizeName(name));
+    if (bucketItr != _namedEntities.end()) {
+        return bucketItr.value();
+    }
+    return EMPTY_BUCKET;
+}
+
+void EntitySearchIndex::removeName(const EntityItemID& id, const QString& name) {
+    auto bucketItr = _namedEntities.find(name);
+    if (bucketItr != _namedEntities.end()) {
+        bucketItr->remove(id);
+        if (bucketItr->isEmpty()) {
+            _namedEntities.erase(bucketItr);
+        }
+    }
+}
+
+void EntitySearchIndex::addToBounds(const EntityItemPointer& entity) {
+    bool success;
+    AACube queryCube = entity->getQueryAACube(success);
+    if (success && queryCube.getScale() > 0.0f) {
+        _bounds += AABox(queryCube);
+    }
+}
@@ -0,0 +1,70 @@
+//
+//  EntitySearchIndex.h
+//  libraries/entities/src
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_EntitySearchIndex_h
+#define hifi_EntitySearchIndex_h
+
+#include <array>
+
+#include <QtCore/QHash>
+#include <QtCore/QString>
+
+#include <AABox.h>
+
+#include "EntityItem.h"
+#include "EntityItemID.h"
+#include "EntityTypes.h"
+
+// Finds the entities with a type or a name without searching the octree.
+//
+// The EntityTree keeps this up to date as entities are added, renamed and deleted. Lookups only narrow down the
+// candidates, callers still check the search filter and whether each entity is in the search area.
+class EntitySearchIndex {
+public:
+    using Bucket = QHash<EntityItemID, EntityItemPointer>;
+
+    void addEntity(const EntityItemPointer& entity);
+    void removeEntity(const EntityItemID& id);
+
+    // re-indexes the entity if its name isn't the one it was indexed with
+    void updateName(const EntityItemPointer& entity);
+
+    void clear();
+
+    int getEntityCount() const { return _entries.size(); }
+
+    // the bounds of the entities when they were indexed, entities that move afterwards aren't tracked
+    const AABox& getBounds() const { return _bounds; }
+
+    const Bucket& getEntitiesWithType(EntityTypes::EntityType type) const;
+
+    // names are indexed lowercase, so a case sensitive lookup returns candidates that still need comparing
+    const Bucket& getEntitiesWithName(const QString& name) const;
+
+    static QString normalizeName(const QString& name) { return name.toLower(); }
+
+private:
+    struct Entry {
+        QString name; // normalized
+        EntityTypes::EntityType type;
+    };
+
+    void removeName(const EntityItemID& id, const QString& name);
+    void addToBounds(const EntityItemPointer& entity);
+
+    QHash<EntityItemID, Entry> _entries;
+    std::array<Bucket, EntityTypes::NUM_TYPES> _types;
+    QHash<QString, Bucket> _namedEntities;
+    AABox _bounds;
+
+    static const Bucket EMPTY_BUCKET;
+};
+
+#endif // hifi_EntitySearchIndex_h
@@ -10,8 +10,10 @@
 //
 
 #include "EntityTree.h"
+#include <atomic>
 #include <QtCore/QDateTime>
 #include <QtCore/QQueue>
+#include <QtCore/QThreadPool>
 #include <openssl/err.h>
 #include <openssl/pem.h>
 #include <openssl/x509.h>
@@ -21,9 +23,11 @@
 #include <QJsonDocument>
 #include <QJsonArray>
 
+#include <QtConcurrent/QtConcurrentMap>
 #include <QtScript/QScriptEngine>
 
 #include <Extents.h>
+#include <OctreeElementPool.h>
 #include <PerfStat.h>
 #include <Profile.h>
 
@@ -31,6 +35,7 @@
 #include "VariantMapToScriptValue.h"
 
 #include "AddEntityOperator.h"
+#include "BulkEntityInserter.h"
 #include "UpdateEntityOperator.h"
 #include "QVariantGLM.h"
 #include "EntitiesLogging.h"
@@ -65,7 +70,8 @@ void EntityTree::createRootElement() {
 }
 
 OctreeElementPointer EntityTree::createNewElement(unsigned char* octalCode) {
-    auto newElement = EntityTreeElementPointer(new EntityTreeElement(octalCode));
+    auto newElement = adoptPooledOctreeElement(
+        new (allocatePooledOctreeElement<EntityTreeElement>()) EntityTreeElement(octalCode));
     newElement->setTree(std::static_pointer_cast<EntityTree>(shared_from_this()));
     return std::static_pointer_cast<OctreeElement>(newElement);
 }
@@ -96,6 +102,13 @@ void EntityTree::eraseNonLocalEntities() {
     });
     localMap.clear();
     _entityMap = savedEntities;
+    {
+        QWriteLocker locker(&_entityMapLock);
+        _searchIndex.clear();
+        foreach(EntityItemPointer entity, savedEntities) {
+            _searchIndex.addEntity(entity);
+        }
+    }
 
     resetClientEditStats();
     clearDeletedEntities();
@@ -131,6 +144,10 @@ void EntityTree::eraseAllOctreeElements(bool createNewRoot) {
         }
     });
     localMap.clear();
+    {
+        QWriteLocker locker(&_entityMapLock);
+        _searchIndex.clear();
+    }
     Octree::eraseAllOctreeElements(createNewRoot);
 
     resetClientEditStats();
@@ -188,6 +205,7 @@ int EntityTree::readEntityDataFromBuffer(const unsigned char* data, int bytesLef
 
                 if (entity) {
                     QString entityScriptBefore = entity->getScript();
+                    QString nameBefore = entity->getName();
                     QUuid parentIDBefore = entity->getParentID();
                     QString entityServerScriptsBefore = entity->getServerScripts();
                     quint64 entityScriptTimestampBefore = entity->getScriptTimestamp();
@@ -216,6 +234,10 @@ int EntityTree::readEntityDataFromBuffer(const unsigned char* data, int bytesLef
                     if (parentIDBefore != parentIDAfter) {
                         addToNeedsParentFixupList(entity);
                     }
+
+                    if (nameBefore != entity->getName()) {
+                        updateSearchIndexName(entity);
+                    }
                 } else {
                     entity = EntityTypes::constructEntityItem(dataAt, bytesLeftToRead);
                     if (entity) {
@@ -461,6 +483,9 @@ bool EntityTree::updateEntity(EntityItemPointer entity, const EntityItemProperti
         if (entity->setProperties(properties)) {
             emit editingEntityPointer(entity);
         }
+        if (properties.nameChanged()) {
+            updateSearchIndexName(entity);
+        }
 
         // if the entity has children, run UpdateEntityOperator on them.  If the children have children, recurse
         QQueue<SpatiallyNestablePointer> toProcess;
@@ -578,6 +603,62 @@ EntityItemPointer EntityTree::addEntity(const EntityItemID& entityID, const Enti
     return result;
 }
 
+QVector<EntityItemPointer> EntityTree::addEntities(const QVector<EntityItemID>& entityIDs,
+                                               const QVector<EntityItemProperties>& properties) {
+    assert(entityIDs.size() == properties.size());
+    QVector<EntityItemPointer> results(entityIDs.size());
+
+    auto nodeList = DependencyManager::get<NodeList>();
+    if (!nodeList) {
+        qCDebug(entities) << "EntityTree::addEntities -- can't get NodeList";
+        return results;
+    }
+
+    bool canRez = !getIsClient() || nodeList->getThisNodeCanRez() || nodeList->getThisNodeCanRezTmp() ||
+        nodeList->getThisNodeCanRezCertified() || nodeList->getThisNodeCanRezTmpCertified() || _serverlessDomain;
+
+    QVector<EntityItemPointer> newEntities;
+    newEntities.reserve(entityIDs.size());
+    QSet<EntityItemID> newEntityIDs;
+    for (int i = 0; i < entityIDs.size(); ++i) {
+        const EntityItemID& entityID = entityIDs[i];
+        const EntityItemProperties& props = properties[i];
+
+        if (props.getEntityHostType() == entity::HostType::DOMAIN && !canRez) {
+            continue;
+        }
+
+        // You should not call this on existing entities that are already part of the tree! Call updateEntity()
+        if (newEntityIDs.contains(entityID) || getContainingElement(entityID)) {
+            qCWarning(entities) << "EntityTree::addEntities() on existing entity item with entityID=" << entityID;
+            continue;
+        }
+
+        // construct the instance of the entity
+        EntityItemPointer result = EntityTypes::constructEntityItem(props.getType(), entityID, props);
+        if (result) {
+            if (props.getCreated() == UNKNOWN_CREATED_TIME) {
+                // the entity's creation time was not specified in properties, which means this is a NEW entity
+                // and we must record its creation time
+                result->recordCreationTime();
+            }
+            newEntityIDs.insert(entityID);
+            newEntities.push_back(result);
+            results[i] = result;
+        }
+    }
+
+    if (!newEntities.isEmpty()) {
+        // Build the subtrees holding all of the entities in one pass, rather than recursing the tree for each
+        BulkEntityInserter inserter(getThisPointer(), newEntities);
+        inserter.insert();
+        for (const auto& entity : newEntities) {
+            postAddEntity(entity);
+        }
+    }
+    return results;
+}
+
 void EntityTree::emitEntityScriptChanging(const EntityItemID& entityItemID, bool reload) {
     emit entityScriptChanging(entityItemID, reload);
 }
@@ -772,59 +853,196 @@ void EntityTree::processRemovedEntities(const DeleteEntityOperator& theOperator)
     }
 }
 
+namespace {
+
+// Each level pushes at most seven more elements than it pops. No tree gets this deep, an element 64 levels down would
+// be far smaller than a float can resolve.
+const int MAX_PICK_TRAVERSAL_DEPTH = 64;
+const int MAX_PICK_TRAVERSAL_STACK_SIZE = MAX_PICK_TRAVERSAL_DEPTH * (NUMBER_OF_CHILDREN - 1) + 1;
+
+struct PickTraversalEntry {
+    float distance; // the closest any of the picks enter the element
+    uint32_t pickMask;
+    EntityTreeElement* element;
+};
+
+// Visits the elements the picks might hit, nearest first, so that picks can stop at the first elements they hit. The
+// elements are kept on a fixed stack rather than recursing and sorting child lists. The tree must be read locked.
+//
+// Picks provides:
+//   uint32_t closerThan(uint32_t pickMask, float distance) - the picks that haven't hit anything as close as distance
+//   void evalElement(EntityTreeElement& element, uint32_t pickMask) - tests the element's entities
+//   uint32_t enterCube(const AACube& cube, uint32_t pickMask, float& distance) - the picks that enter the cube closer
+//     than their closest hit, and the closest any of them enter it
+template <typename Picks>
+void evalPicksInTree(EntityTreeElement* root, Picks& picks, uint32_t pickMask) {
+    PickTraversalEntry stack[MAX_PICK_TRAVERSAL_STACK_SIZE];
+    int stackSize = 0;
+    stack[stackSize++] = { 0.0f, pickMask, root };
+
+    while (stackSize > 0) {
+        PickTraversalEntry entry = stack[--stackSize];
+        uint32_t mask = picks.closerThan(entry.pickMask, entry.distance);
+        if (!mask) {
+            continue;
+        }
+
+        if (entry.element->canPickIntersect()) {
+            picks.evalElement(*entry.element, mask);
+        }
+
+        // sort the children farthest first, so the nearest is on top of the stack
+        PickTraversalEntry children[NUMBER_OF_CHILDREN];
+        int numChildren = 0;
+        for (int i = 0; i < NUMBER_OF_CHILDREN; i++) {
+            OctreeElementPointer child = entry.element->OctreeElement::getChildAtIndex(i);
+            if (!child) {
+                continue;
+            }
+            float distance;
+            uint32_t childMask = picks.enterCube(child->getAACube(), mask, distance);
+            if (childMask) {
+                int j = numChildren++;
+                while (j > 0 && children[j - 1].distance < distance) {
+                    children[j] = children[j - 1];
+                    j--;
+                }
+                children[j] = { distance, childMask, static_cast<EntityTreeElement*>(child.get()) };
+            }
+        }
+
+        int firstChild = 0;
+        if (stackSize + numChildren > MAX_PICK_TRAVERSAL_STACK_SIZE) {
+            HIFI_FCDEBUG(entities(), "evalPicksInTree() ran out of stack, skipping the farthest elements");
+            firstChild = stackSize + numChildren - MAX_PICK_TRAVERSAL_STACK_SIZE;
+        }
+        for (int i = firstChild; i < numChildren; i++) {
+            stack[stackSize++] = children[i];
+        }
+    }
+}
+
 class RayArgs {
+public:
+    RayArgs(const glm::vec3& origin, const glm::vec3* directions, int numRays,
+            const QVector<EntityItemID>& entityIdsToInclude, const QVector<EntityItemID>& entityIdsToDiscard,
+            PickFilter searchFilter, OctreeElementPointer& element, EntityRayIntersection* intersections) :
+        origin(origin),
+        directions(directions),
+        numRays(numRays),
+        entityIdsToInclude(entityIdsToInclude),
+        entityIdsToDiscard(entityIdsToDiscard),
+        searchFilter(searchFilter),
+        element(element),
+        intersections(intersections) {
+        for (int ray = 0; ray < numRays; ray++) {
+            invDirections[ray] = 1.0f / directions[ray];
+        }
+    }
+
+    uint32_t closerThan(uint32_t rayMask, float distance) const {
+        uint32_t result = 0;
+        for (int ray = 0; ray < numRays; ray++) {
+            if ((rayMask & (1u << ray)) && distance < intersections[ray].distance) {
+                result |= 1u << ray;
+            }
+        }
+        return result;
+    }
+
+    void evalElement(EntityTreeElement& treeElement, uint32_t rayMask) {
+        treeElement.evalRayIntersections(origin, directions, numRays, rayMask, element, intersections,
+            entityIdsToInclude, entityIdsToDiscard, searchFilter);
+    }
+
+    uint32_t enterCube(const AACube& cube, uint32_t rayMask, float& distance) const {
+        // If origin is inside the cube, always check this element first
+        if (cube.contains(origin)) {
+            distance = 0.0f;
+            return rayMask;
+        }
+
+        uint32_t result = 0;
+        distance = FLT_MAX;
+        for (int ray = 0; ray < numRays; ray++) {
+            if (!(rayMask & (1u << ray))) {
+                continue;
+            }
+            float boundDistance = FLT_MAX;
+            BoxFace face;
+            glm::vec3 surfaceNormal;
+            // Don't add this cell if it's already farther than our best distance so far
+            if (cube.findRayIntersection(origin, directions[ray], invDirections[ray], boundDistance, face, surfaceNormal) &&
+                    boundDistance < intersections[ray].distance) {
+                result |= 1u << ray;
+                distance = glm::min(distance, boundDistance);
+            }
+        }
+        return result;
+    }
+
+private:
+    glm::vec3 origin;
+    const glm::vec3* directions;
+    glm::vec3 invDirections[EntityTreeElement::MAX_RAYS_PER_BATCH];
+    int numRays;
+    const QVector<EntityItemID>& entityIdsToInclude;
+    const QVector<EntityItemID>& entityIdsToDiscard;
+    PickFilter searchFilter;
+    OctreeElementPointer& element;
+    EntityRayIntersection* intersections;
+};
+
+class ParabolaArgs {
 public:
     // Inputs
     glm::vec3 origin;
-    glm::vec3 direction;
-    glm::vec3 invDirection;
+    glm::vec3 velocity;
+    glm::vec3 acceleration;
     const QVector<EntityItemID>& entityIdsToInclude;
     const QVector<EntityItemID>& entityIdsToDiscard;
     PickFilter searchFilter;
 
     // Outputs
     OctreeElementPointer& element;
-    float& distance;
+    float& parabolicDistance;
     BoxFace& face;
     glm::vec3& surfaceNormal;
     QVariantMap& extraInfo;
     EntityItemID entityID;
-};
 
-bool evalRayIntersectionOp(const OctreeElementPointer& element, void* extraData) {
-    RayArgs* args = static_cast<RayArgs*>(extraData);
-    bool keepSearching = true;
-    EntityTreeElementPointer entityTreeElementPointer = std::static_pointer_cast<EntityTreeElement>(element);
-    EntityItemID entityID = entityTreeElementPointer->evalRayIntersection(args->origin, args->direction,
-        args->element, args->distance, args->face, args->surfaceNormal, args->entityIdsToInclude,
-        args->entityIdsToDiscard, args->searchFilter, args->extraInfo);
-    if (!entityID.isNull()) {
-        args->entityID = entityID;
-        // We recurse OctreeElements in order, so if we hit something, we can stop immediately
-        keepSearching = false;
-    }
-    return keepSearching;
-}
-
-float evalRayIntersectionSortingOp(const OctreeElementPointer& element, void* extraData) {
-    RayArgs* args = static_cast<RayArgs*>(extraData);
-    EntityTreeElementPointer entityTreeElementPointer = std::static_pointer_cast<EntityTreeElement>(element);
-    float distance = FLT_MAX;
-    // If origin is inside the cube, always check this element first
-    if (entityTreeElementPointer->getAACube().contains(args->origin)) {
-        distance = 0.0f;
-    } else {
+    uint32_t closerThan(uint32_t pickMask, float distance) const {
+        return distance < parabolicDistance ? pickMask : 0;
+    }
+
+    void evalElement(EntityTreeElement& treeElement, uint32_t pickMask) {
+        EntityItemID hitID = treeElement.evalParabolaIntersection(origin, velocity, acceleration, element,
+            parabolicDistance, face, surfaceNormal, entityIdsToInclude, entityIdsToDiscard, searchFilter, extraInfo);
+        if (!hitID.isNull()) {
+            entityID = hitID;
+        }
+    }
+
+    uint32_t enterCube(const AACube& cube, uint32_t pickMask, float& distance) const {
+        // If origin is inside the cube, always check this element first
+        if (cube.contains(origin)) {
+            distance = 0.0f;
+            return pickMask;
+        }
+
         float boundDistance = FLT_MAX;
-        BoxFace face;
-        glm::vec3 surfaceNormal;
-        if (entityTreeElementPointer->getAACube().findRayIntersection(args->origin, args->direction, args->invDirection, boundDistance, face, surfaceNormal)) {
-            // Don't add this cell if it's already farther than our best distance so far
-            if (boundDistance < args->distance) {
-                distance = boundDistance;
-            }
+        BoxFace boundFace;
+        glm::vec3 boundSurfaceNormal;
+        // Don't add this cell if it's already farther than our best distance so far
+        if (cube.findParabolaIntersection(origin, velocity, acceleration, boundDistance, boundFace, boundSurfaceNormal) &&
+                boundDistance < parabolicDistance) {
+            distance = boundDistance;
+            return pickMask;
         }
+        return 0;
     }
-    return distance;
+};
+
 }
 
 EntityItemID EntityTree::evalRayIntersection(const glm::vec3& origin, const glm::vec3& direction,
@@ -832,75 +1050,55 @@ EntityItemID EntityTree::evalRayIntersection(const glm::vec3& origin, const glm:
                                     PickFilter searchFilter, OctreeElementPointer& element, float& distance,
                                     BoxFace& face, glm::vec3& surfaceNormal, QVariantMap& extraInfo,
                                     Octree::lockType lockType, bool* accurateResult) {
-    RayArgs args = { origin, direction, 1.0f / direction, entityIdsToInclude, entityIdsToDiscard,
-            searchFilter, element, distance, face, surfaceNormal, extraInfo, EntityItemID() };
-    distance = FLT_MAX;
+    EntityRayIntersection intersection;
+    RayArgs picks(origin, &direction, 1, entityIdsToInclude, entityIdsToDiscard, searchFilter, element, &intersection);
 
     bool requireLock = lockType == Octree::Lock;
     bool lockResult = withReadLock([&]{
-        recurseTreeWithOperationSorted(evalRayIntersectionOp, evalRayIntersectionSortingOp, &args);
+        if (_rootElement) {
+            evalPicksInTree(static_cast<EntityTreeElement*>(_rootElement.get()), picks, 1);
+        }
     }, requireLock);
 
     if (accurateResult) {
         *accurateResult = lockResult; // if user asked to accuracy or result, let them know this is accurate
     }
 
-    return args.entityID;
+    distance = intersection.distance;
+    if (!intersection.entityID.isNull()) {
+        face = intersection.face;
+        surfaceNormal = intersection.surfaceNormal;
+        extraInfo = intersection.extraInfo;
+    }
+    return intersection.entityID;
 }
 
-class ParabolaArgs {
-public:
-    // Inputs
-    glm::vec3 origin;
-    glm::vec3 velocity;
-    glm::vec3 acceleration;
-    const QVector<EntityItemID>& entityIdsToInclude;
-    const QVector<EntityItemID>& entityIdsToDiscard;
-    PickFilter searchFilter;
-
-    // Outputs
-    OctreeElementPointer& element;
-    float& parabolicDistance;
-    BoxFace& face;
-    glm::vec3& surfaceNormal;
-    QVariantMap& extraInfo;
-    EntityItemID entityID;
-};
+void EntityTree::evalRayIntersections(const glm::vec3& origin, const QVector<glm::vec3>& directions,
+                                    const QVector<EntityItemID>& entityIdsToInclude, const QVector<EntityItemID>& entityIdsToDiscard,
+                                    PickFilter searchFilter, QVector<EntityRayIntersection>& intersections,
+                                    Octree::lockType lockType, bool* accurateResult) {
+    intersections.clear();
+    intersections.resize(directions.size());
+    OctreeElementPointer element;
 
-bool evalParabolaIntersectionOp(const OctreeElementPointer& element, void* extraData) {
-    ParabolaArgs* args = static_cast<ParabolaArgs*>(extraData);
-    bool keepSearching = true;
-    EntityTreeElementPointer entityTreeElementPointer = std::static_pointer_cast<EntityTreeElement>(element);
-    EntityItemID entityID = entityTreeElementPointer->evalParabolaIntersection(args->origin, args->velocity, args->acceleration,
-        args->element, args->parabolicDistance, args->face, args->surfaceNormal, args->entityIdsToInclude,
-        args->entityIdsToDiscard, args->searchFilter, args->extraInfo);
-    if (!entityID.isNull()) {
-        args->entityID = entityID;
-        // We recurse OctreeElements in order, so if we hit something, we can stop immediately
-        keepSearching = false;
-    }
-    return keepSearching;
-}
-
-float evalParabolaIntersectionSortingOp(const OctreeElementPointer& element, void* extraData) {
-    ParabolaArgs* args = static_cast<ParabolaArgs*>(extraData);
-    EntityTreeElementPointer entityTreeElementPointer = std::static_pointer_cast<EntityTreeElement>(element);
-    float distance = FLT_MAX;
-    // If origin is inside the cube, always check this element first
-    if (entityTreeElementPointer->getAACube().contains(args->origin)) {
-        distance = 0.0f;
-    } else {
-        float boundDistance = FLT_MAX;
-        BoxFace face;
-        glm::vec3 surfaceNormal;
-        if (entityTreeElementPointer->getAACube().findParabolaIntersection(args->origin, args->velocity, args->acceleration, boundDistance, face, surfaceNormal)) {
-            // Don't add this cell if it's already farther than our best distance so far
-            if (boundDistance < args->parabolicDistance) {
-                distance = boundDistance;
-            }
+    bool requireLock = lockType == Octree::Lock;
+    bool lockResult = withReadLock([&] {
+        if (!_rootElement) {
+            return;
         }
+        for (int first = 0; first < directions.size(); first += EntityTreeElement::MAX_RAYS_PER_BATCH) {
+            const int MAX_RAYS = EntityTreeElement::MAX_RAYS_PER_BATCH;
+            int numRays = std::min(directions.size() - first, MAX_RAYS);
+            uint32_t rayMask = numRays < MAX_RAYS ? (1u << numRays) - 1 : UINT32_MAX;
+            RayArgs picks(origin, directions.constData() + first, numRays, entityIdsToInclude, entityIdsToDiscard,
+                searchFilter, element, intersections.data() + first);
+            evalPicksInTree(static_cast<EntityTreeElement*>(_rootElement.get()), picks, rayMask);
+        }
+    }, requireLock);
+
+    if (accurateResult) {
+        *accurateResult = lockResult; // if user asked to accuracy or result, let them know this is accurate
     }
-    return distance;
 }
 
 EntityItemID EntityTree::evalParabolaIntersection(const PickParabola& parabola,
@@ -909,26 +1107,28 @@ EntityItemID EntityTree::evalParabolaIntersection(const PickParabola& parabola,
                                     OctreeElementPointer& element, glm::vec3& intersection, float& distance, float& parabolicDistance,
                                     BoxFace& face, glm::vec3& surfaceNormal, QVariantMap& extraInfo,
                                     Octree::lockType lockType, bool* accurateResult) {
-    ParabolaArgs args = { parabola.origin, parabola.velocity, parabola.acceleration, entityIdsToInclude, entityIdsToDiscard,
+    ParabolaArgs pick = { parabola.origin, parabola.velocity, parabola.acceleration, entityIdsToInclude, entityIdsToDiscard,
         searchFilter, element, parabolicDistance, face, surfaceNormal, extraInfo, EntityItemID() };
     parabolicDistance = FLT_MAX;
     distance = FLT_MAX;
 
     bool requireLock = lockType == Octree::Lock;
     bool lockResult = withReadLock([&] {
-        recurseTreeWithOperationSorted(evalParabolaIntersectionOp, evalParabolaIntersectionSortingOp, &args);
+        if (_rootElement) {
+            evalPicksInTree(static_cast<EntityTreeElement*>(_rootElement.get()), pick, 1);
+        }
     }, requireLock);
 
     if (accurateResult) {
         *accurateResult = lockResult; // if user asked to accuracy or result, let them know this is accurate
     }
 
-    if (!args.entityID.isNull()) {
+    if (!pick.entityID.isNull()) {
         intersection = parabola.origin + parabola.velocity * parabolicDistance + 0.5f * parabola.acceleration * parabolicDistance * parabolicDistance;
         distance = glm::distance(intersection, parabola.origin);
     }
 
-    return args.entityID;
+    return pick.entityID;
 }
 
 class FindClosestEntityArgs {
@@ -1047,8 +1247,61 @@ bool evalInSphereWithTypeOperation(const OctreeElementPointer& element, void* ex
     return false;
 }
 
+// The index costs about as much per candidate as the octree search costs per entity in the elements it visits, so use
+// the index unless it has more candidates than the search sphere is expected to hold.
+bool EntityTree::shouldUseSearchIndex(int candidateCount, const glm::vec3& center, float radius) const {
+    const AABox& bounds = _searchIndex.getBounds();
+    if (candidateCount == 0 || bounds.isInvalid()) {
+        return true;
+    }
+
+    // assume the entities are spread evenly through their bounds
+    glm::vec3 searchMinimum = center - glm::vec3(radius);
+    glm::vec3 searchMaximum = center + glm::vec3(radius);
+    glm::vec3 overlap = glm::min(searchMaximum, bounds.getMaximumPoint()) - glm::max(searchMinimum, bounds.getMinimumPoint());
+    glm::vec3 dimensions = bounds.getDimensions();
+    float coveredFraction = 1.0f;
+    for (int i = 0; i < 3; i++) {
+        if (dimensions[i] > 0.0f) {
+            coveredFraction *= glm::clamp(overlap[i] / dimensions[i], 0.0f, 1.0f);
+        } else if (overlap[i] < 0.0f) {
+            coveredFraction = 0.0f;
+        }
+    }
+    return candidateCount <= coveredFraction * _searchIndex.getEntityCount();
+}
+
+template <typename F>
+void EntityTree::evalIndexedEntitiesInSphere(const EntitySearchIndex::Bucket& candidates, const glm::vec3& center,
+        float radius, PickFilter searchFilter, QVector<QUuid>& foundEntities, F matches) const {
+    QVector<QUuid> entities;
+    for (const auto& entity : candidates) {
+        // entities in the index are in the octree, unless they are being deleted
+        if (entity->getElement() && matches(entity) && EntityTreeElement::checkFilterSettings(entity, searchFilter) &&
+                EntityTreeElement::checkEntityInSphere(entity, center, radius)) {
+            entities.push_back(entity->getID());
+        }
+    }
+    foundEntities.swap(entities);
+}
+
 // NOTE: assumes caller has handled locking
 void EntityTree::evalEntitiesInSphereWithType(const glm::vec3& center, float radius, EntityTypes::EntityType type, PickFilter searchFilter, QVector<QUuid>& foundEntities) {
+    // the buckets are implicitly shared, so copying them lets us test the entities without holding the map lock
+    EntitySearchIndex::Bucket candidates;
+    bool useSearchIndex;
+    {
+        QReadLocker locker(&_entityMapLock);
+        candidates = _searchIndex.getEntitiesWithType(type);
+        useSearchIndex = shouldUseSearchIndex(candidates.size(), center, radius);
+    }
+    if (useSearchIndex) {
+        evalIndexedEntitiesInSphere(candidates, center, radius, searchFilter, foundEntities, [&](const EntityItemPointer& entity) {
+            return entity->getType() == type;
+        });
+        return;
+    }
+
     FindEntitiesInSphereWithTypeArgs args = { center, radius, type, searchFilter, QVector<QUuid>() };
     recurseTreeWithOperation(evalInSphereWithTypeOperation, &args);
     foundEntities.swap(args.entities);
@@ -1085,6 +1338,22 @@ bool evalInSphereWithNameOperation(const OctreeElementPointer& element, void* ex
 
 // NOTE: assumes caller has handled locking
 void EntityTree::evalEntitiesInSphereWithName(const glm::vec3& center, float radius, const QString& name, bool caseSensitive, PickFilter searchFilter, QVector<QUuid>& foundEntities) {
+    EntitySearchIndex::Bucket candidates;
+    bool useSearchIndex;
+    {
+        QReadLocker locker(&_entityMapLock);
+        candidates = _searchIndex.getEntitiesWithName(name);
+        useSearchIndex = shouldUseSearchIndex(candidates.size(), center, radius);
+    }
+    if (useSearchIndex) {
+        QString normalizedName = EntitySearchIndex::normalizeName(name);
+        evalIndexedEntitiesInSphere(candidates, center, radius, searchFilter, foundEntities, [&](const EntityItemPointer& entity) {
+            QString entityName = entity->getName();
+            return caseSensitive ? entityName == name : EntitySearchIndex::normalizeName(entityName) == normalizedName;
+        });
+        return;
+    }
+
     FindEntitiesInSphereWithNameArgs args = { center, radius, name, caseSensitive, searchFilter, QVector<QUuid>() };
     recurseTreeWithOperation(evalInSphereWithNameOperation, &args);
     foundEntities.swap(args.entities);
@@ -2309,11 +2578,18 @@ void EntityTree::addEntityMapEntry(EntityItemPointer entity) {
         return;
     }
     _entityMap.insert(id, entity);
+    _searchIndex.addEntity(entity);
 }
 
 void EntityTree::clearEntityMapEntry(const EntityItemID& id) {
     QWriteLocker locker(&_entityMapLock);
     _entityMap.remove(id);
+    _searchIndex.removeEntity(id);
+}
+
+void EntityTree::updateSearchIndexName(const EntityItemPointer& entity) {
+    QWriteLocker locker(&_entityMapLock);
+    _searchIndex.updateName(entity);
 }
 
 void EntityTree::debugDumpMap() {
@@ -2449,6 +2725,19 @@ QVector<EntityItemID> EntityTree::sendEntities(EntityEditPacketSender* packetSen
         recurseTreeWithOperation(sendEntitiesOperation, &args);
     });
 
+    // also update the local tree instantly (note: this is not our tree, but an alternate tree), all at once
+    if (args.otherTree) {
+        args.otherTree->withWriteLock([&] {
+            auto entities = args.otherTree->addEntities(args.newEntityIDs, args.newEntityProperties);
+            for (const auto& entity : entities) {
+                if (entity) {
+                    entity->deserializeActions();
+                }
+                // else: there was an error adding this entity
+            }
+        });
+    }
+
     // The values from map are used as the list of successfully "sent" entities.  If some didn't actually make it,
     // pull them out.  Bogus entries could happen if part of the imported data makes some reference to an entity
     // that isn't in the data being imported.  For those that made it, fix up their queryAACubes and send an
@@ -2524,7 +2813,7 @@ bool EntityTree::sendEntitiesOperation(const OctreeElementPointer& element, void
         return iter.value();
     };
 
-    entityTreeElement->forEachEntity([&args, &getMapped, &element](EntityItemPointer item) {
+    entityTreeElement->forEachEntity([&args, &getMapped](EntityItemPointer item) {
         EntityItemID oldID = item->getEntityItemID();
         EntityItemID newID = getMapped(oldID);
         EntityItemProperties properties = item->getProperties();
@@ -2555,19 +2844,9 @@ bool EntityTree::sendEntitiesOperation(const OctreeElementPointer& element, void
         // set creation time to "now" for imported entities
         properties.setCreated(usecTimestampNow());
 
-        EntityTreeElementPointer entityTreeElement = std::static_pointer_cast<EntityTreeElement>(element);
-        EntityTreePointer tree = entityTreeElement->getTree();
-
-        // also update the local tree instantly (note: this is not our tree, but an alternate tree)
-        if (args->otherTree) {
-            args->otherTree->withWriteLock([&] {
-                EntityItemPointer entity = args->otherTree->addEntity(newID, properties);
-                if (entity) {
-                    entity->deserializeActions();
-                }
-                // else: there was an error adding this entity
-            });
-        }
+        // the local tree is updated once all of the entities have been mapped
+        args->newEntityIDs.push_back(newID);
+        args->newEntityProperties.push_back(properties);
         return newID;
     });
 
@@ -2704,10 +2983,7 @@ void convertGrabUserDataToProperties(EntityItemProperties& properties) {
 }
 
 
-bool EntityTree::readFromMap(QVariantMap& map) {
-    // These are needed to deal with older content (before adding inheritance modes)
-    int contentVersion = map["Version"].toInt();
-
+void EntityTree::readMapHeader(const QVariantMap& map) {
     if (map.contains("Id")) {
         _persistID = map["Id"].toUuid();
     }
@@ -2725,167 +3001,300 @@ bool EntityTree::readFromMap(QVariantMap& map) {
             _namedPaths[namedPathName] = namedPathViewPoint;
         }
     }
+}
 
-    // map will have a top-level list keyed as "Entities".  This will be extracted
-    // and iterated over.  Each member of this list is converted to a QVariantMap, then
-    // to a QScriptValue, and then to EntityItemProperties.  These properties are used
-    // to add the new entity to the EntityTree.
-    QVariantList entitiesQList = map["Entities"].toList();
-    QScriptEngine scriptEngine;
+// Doesn't touch the tree, so that the entities of a file can be converted on several threads, each with its own engine.
+void EntityTree::readEntityFromMap(QVariantMap& entityMap, int contentVersion, const QUuid& sessionID,
+                                   QScriptEngine& scriptEngine, EntityItemID& entityItemID,
+                                   EntityItemProperties& properties) const {
+    // handle parentJointName for wearables
+    if (_myAvatar && entityMap.contains("parentJointName") && entityMap.contains("parentID") &&
+        QUuid(entityMap["parentID"].toString()) == AVATAR_SELF_ID) {
 
-    if (entitiesQList.length() == 0) {
-        // Empty map or invalidly formed file.
-        return false;
-    }
+        entityMap["parentJointIndex"] = _myAvatar->getJointIndex(entityMap["parentJointName"].toString());
 
-    QMap<QUuid, QVector<QUuid>> cloneIDs;
-
-    bool success = true;
-    foreach (QVariant entityVariant, entitiesQList) {
-        // QVariantMap --> QScriptValue --> EntityItemProperties --> Entity
-        QVariantMap entityMap = entityVariant.toMap();
+        qCDebug(entities) << "Found parentJointName " << entityMap["parentJointName"].toString() <<
+            " mapped it to parentJointIndex " << entityMap["parentJointIndex"].toInt();
+    }
 
-        // handle parentJointName for wearables
-        if (_myAvatar && entityMap.contains("parentJointName") && entityMap.contains("parentID") &&
-            QUuid(entityMap["parentID"].toString()) == AVATAR_SELF_ID) {
+    QScriptValue entityScriptValue = variantMapToScriptValue(entityMap, scriptEngine);
+    EntityItemPropertiesFromScriptValueIgnoreReadOnly(entityScriptValue, properties);
 
-            entityMap["parentJointIndex"] = _myAvatar->getJointIndex(entityMap["parentJointName"].toString());
+    if (entityMap.contains("id")) {
+        entityItemID = EntityItemID(QUuid(entityMap["id"].toString()));
+    } else {
+        entityItemID = EntityItemID(QUuid::createUuid());
+    }
 
-            qCDebug(entities) << "Found parentJointName " << entityMap["parentJointName"].toString() <<
-                " mapped it to parentJointIndex " << entityMap["parentJointIndex"].toInt();
+    // Convert old clientOnly bool to new entityHostType enum
+    // (must happen before setOwningAvatarID below)
+    if (contentVersion < (int)EntityVersion::EntityHostTypes) {
+        if (entityMap.contains("clientOnly")) {
+            properties.setEntityHostType(entityMap["clientOnly"].toBool() ? entity::HostType::AVATAR : entity::HostType::DOMAIN);
         }
+    }
 
-        QScriptValue entityScriptValue = variantMapToScriptValue(entityMap, scriptEngine);
-        EntityItemProperties properties;
-        EntityItemPropertiesFromScriptValueIgnoreReadOnly(entityScriptValue, properties);
+    if (properties.getEntityHostType() == entity::HostType::AVATAR) {
+        properties.setOwningAvatarID(sessionID);
+    }
 
-        EntityItemID entityItemID;
-        if (entityMap.contains("id")) {
-            entityItemID = EntityItemID(QUuid(entityMap["id"].toString()));
-        } else {
-            entityItemID = EntityItemID(QUuid::createUuid());
+    // Fix for older content not containing mode fields in the zones
+    if (contentVersion < (int)EntityVersion::ZoneLightInheritModes && (properties.getType() == EntityTypes::EntityType::Zone)) {
+        // The legacy version had no keylight mode - this is set to on
+        properties.setKeyLightMode(COMPONENT_MODE_ENABLED);
+
+        // The ambient URL has been moved from "keyLight" to "ambientLight"
+        if (entityMap.contains("keyLight")) {
+            QVariantMap keyLightObject = entityMap["keyLight"].toMap();
+            properties.getAmbientLight().setAmbientURL(keyLightObject["ambientURL"].toString());
         }
 
-        // Convert old clientOnly bool to new entityHostType enum
-        // (must happen before setOwningAvatarID below)
-        if (contentVersion < (int)EntityVersion::EntityHostTypes) {
-            if (entityMap.contains("clientOnly")) {
-                properties.setEntityHostType(entityMap["clientOnly"].toBool() ? entity::HostType::AVATAR : entity::HostType::DOMAIN);
+        // Copy the skybox URL if the ambient URL is empty, as this is the legacy behaviour
+        // Use skybox value only if it is not empty, else set ambientMode to inherit (to use default URL)
+        properties.setAmbientLightMode(COMPONENT_MODE_ENABLED);
+        if (properties.getAmbientLight().getAmbientURL() == "") {
+            if (properties.getSkybox().getURL() != "") {
+                properties.getAmbientLight().setAmbientURL(properties.getSkybox().getURL());
+            } else {
+                properties.setAmbientLightMode(COMPONENT_MODE_INHERIT);
             }
         }
 
-        if (properties.getEntityHostType() == entity::HostType::AVATAR) {
-            auto nodeList = DependencyManager::get<NodeList>();
-            const QUuid myNodeID = nodeList->getSessionUUID();
-            properties.setOwningAvatarID(myNodeID);
+        // The background should be enabled if the mode is skybox
+        // Note that if the values are default then they are not stored in the JSON file
+        if (entityMap.contains("backgroundMode") && (entityMap["backgroundMode"].toString() == "skybox")) {
+            properties.setSkyboxMode(COMPONENT_MODE_ENABLED);
+        } else {
+            properties.setSkyboxMode(COMPONENT_MODE_INHERIT);
         }
+    }
 
-        // Fix for older content not containing mode fields in the zones
-        if (contentVersion < (int)EntityVersion::ZoneLightInheritModes && (properties.getType() == EntityTypes::EntityType::Zone)) {
-            // The legacy version had no keylight mode - this is set to on
-            properties.setKeyLightMode(COMPONENT_MODE_ENABLED);
+    // Convert old materials so that they use materialData instead of userData
+    if (contentVersion < (int)EntityVersion::MaterialData && properties.getType() == EntityTypes::EntityType::Material) {
+        if (properties.getMaterialURL().startsWith("userData")) {
+            QString materialURL = properties.getMaterialURL();
+            properties.setMaterialURL(materialURL.replace("userData", "materialData"));
 
-            // The ambient URL has been moved from "keyLight" to "ambientLight"
-            if (entityMap.contains("keyLight")) {
-                QVariantMap keyLightObject = entityMap["keyLight"].toMap();
-                properties.getAmbientLight().setAmbientURL(keyLightObject["ambientURL"].toString());
+            QJsonObject userData = QJsonDocument::fromJson(properties.getUserData().toUtf8()).object();
+            QJsonObject materialData;
+            QJsonValue materialVersion = userData["materialVersion"];
+            if (!materialVersion.isNull()) {
+                materialData.insert("materialVersion", materialVersion);
+                userData.remove("materialVersion");
             }
-
-            // Copy the skybox URL if the ambient URL is empty, as this is the legacy behaviour
-            // Use skybox value only if it is not empty, else set ambientMode to inherit (to use default URL)
-            properties.setAmbientLightMode(COMPONENT_MODE_ENABLED);
-            if (properties.getAmbientLight().getAmbientURL() == "") {
-                if (properties.getSkybox().getURL() != "") {
-                    properties.getAmbientLight().setAmbientURL(properties.getSkybox().getURL());
-                } else {
-                    properties.setAmbientLightMode(COMPONENT_MODE_INHERIT);
-                }
+            QJsonValue materials = userData["materials"];
+            if (!materials.isNull()) {
+                materialData.insert("materials", materials);
+                userData.remove("materials");
             }
 
-            // The background should be enabled if the mode is skybox
-            // Note that if the values are default then they are not stored in the JSON file
-            if (entityMap.contains("backgroundMode") && (entityMap["backgroundMode"].toString() == "skybox")) {
-                properties.setSkyboxMode(COMPONENT_MODE_ENABLED);
-            } else {
-                properties.setSkyboxMode(COMPONENT_MODE_INHERIT);
-            }
+            properties.setMaterialData(QJsonDocument(materialData).toJson());
+            properties.setUserData(QJsonDocument(userData).toJson());
         }
+    }
 
-        // Convert old materials so that they use materialData instead of userData
-        if (contentVersion < (int)EntityVersion::MaterialData && properties.getType() == EntityTypes::EntityType::Material) {
-            if (properties.getMaterialURL().startsWith("userData")) {
-                QString materialURL = properties.getMaterialURL();
-                properties.setMaterialURL(materialURL.replace("userData", "materialData"));
+    // Convert old cloneable entities so they use cloneableData instead of userData
+    if (contentVersion < (int)EntityVersion::CloneableData) {
+        QJsonObject userData = QJsonDocument::fromJson(properties.getUserData().toUtf8()).object();
+        QJsonObject grabbableKey = userData["grabbableKey"].toObject();
+        QJsonValue cloneable = grabbableKey["cloneable"];
+        if (cloneable.isBool() && cloneable.toBool()) {
+            QJsonValue cloneLifetime = grabbableKey["cloneLifetime"];
+            QJsonValue cloneLimit = grabbableKey["cloneLimit"];
+            QJsonValue cloneDynamic = grabbableKey["cloneDynamic"];
+            QJsonValue cloneAvatarEntity = grabbableKey["cloneAvatarEntity"];
 
-                QJsonObject userData = QJsonDocument::fromJson(properties.getUserData().toUtf8()).object();
-                QJsonObject materialData;
-                QJsonValue materialVersion = userData["materialVersion"];
-                if (!materialVersion.isNull()) {
-                    materialData.insert("materialVersion", materialVersion);
-                    userData.remove("materialVersion");
-                }
-                QJsonValue materials = userData["materials"];
-                if (!materials.isNull()) {
-                    materialData.insert("materials", materials);
-                    userData.remove("materials");
-                }
-
-                properties.setMaterialData(QJsonDocument(materialData).toJson());
-                properties.setUserData(QJsonDocument(userData).toJson());
-            }
+            // This is cloneable, we need to convert the properties
+            properties.setCloneable(true);
+            properties.setCloneLifetime(cloneLifetime.toInt());
+            properties.setCloneLimit(cloneLimit.toInt());
+            properties.setCloneDynamic(cloneDynamic.toBool());
+            properties.setCloneAvatarEntity(cloneAvatarEntity.toBool());
         }
+    }
 
-        // Convert old cloneable entities so they use cloneableData instead of userData
-        if (contentVersion < (int)EntityVersion::CloneableData) {
-            QJsonObject userData = QJsonDocument::fromJson(properties.getUserData().toUtf8()).object();
-            QJsonObject grabbableKey = userData["grabbableKey"].toObject();
-            QJsonValue cloneable = grabbableKey["cloneable"];
-            if (cloneable.isBool() && cloneable.toBool()) {
-                QJsonValue cloneLifetime = grabbableKey["cloneLifetime"];
-                QJsonValue cloneLimit = grabbableKey["cloneLimit"];
-                QJsonValue cloneDynamic = grabbableKey["cloneDynamic"];
-                QJsonValue cloneAvatarEntity = grabbableKey["cloneAvatarEntity"];
+    // convert old grab-related userData to new grab properties
+    if (contentVersion < (int)EntityVersion::GrabProperties) {
+        convertGrabUserDataToProperties(properties);
+    }
 
-                // This is cloneable, we need to convert the properties
-                properties.setCloneable(true);
-                properties.setCloneLifetime(cloneLifetime.toInt());
-                properties.setCloneLimit(cloneLimit.toInt());
-                properties.setCloneDynamic(cloneDynamic.toBool());
-                properties.setCloneAvatarEntity(cloneAvatarEntity.toBool());
-            }
+    // Zero out the spread values that were fixed in version ParticleEntityFix so they behave the same as before
+    if (contentVersion < (int)EntityVersion::ParticleEntityFix) {
+        properties.setRadiusSpread(0.0f);
+        properties.setAlphaSpread(0.0f);
+        properties.setColorSpread({0, 0, 0});
+    }
+
+    if (contentVersion < (int)EntityVersion::FixPropertiesFromCleanup) {
+        if (entityMap.contains("created")) {
+            quint64 created = QDateTime::fromString(entityMap["created"].toString().trimmed(), Qt::ISODate).toMSecsSinceEpoch() * 1000;
+            properties.setCreated(created);
         }
+    }
+}
 
-        // convert old grab-related userData to new grab properties
-        if (contentVersion < (int)EntityVersion::GrabProperties) {
-            convertGrabUserDataToProperties(properties);
+bool EntityTree::addEntitiesFromMap(const QVector<EntityItemID>& entityIDs, const QVector<EntityItemProperties>& properties,
+                                    QMap<QUuid, QVector<QUuid>>& cloneIDs, QSet<EntityItemID>* addedEntityIDs) {
+    bool success = true;
+    QVector<EntityItemPointer> addedEntities = addEntities(entityIDs, properties);
+    for (int i = 0; i < addedEntities.size(); ++i) {
+        const EntityItemPointer& entity = addedEntities[i];
+        if (!entity) {
+            qCDebug(entities) << "adding Entity failed:" << entityIDs[i] << properties[i].getType();
+            success = false;
+            continue;
+        }
+        if (addedEntityIDs) {
+            addedEntityIDs->insert(entity->getEntityItemID());
         }
 
-        // Zero out the spread values that were fixed in version ParticleEntityFix so they behave the same as before
-        if (contentVersion < (int)EntityVersion::ParticleEntityFix) {
-            properties.setRadiusSpread(0.0f);
-            properties.setAlphaSpread(0.0f);
-            properties.setColorSpread({0, 0, 0});
+        const QUuid& cloneOriginID = entity->getCloneOriginID();
+        if (!cloneOriginID.isNull()) {
+            cloneIDs[cloneOriginID].push_back(entity->getEntityItemID());
         }
+    }
+    return success;
+}
 
-        if (contentVersion < (int)EntityVersion::FixPropertiesFromCleanup) {
-            if (entityMap.contains("created")) {
-                quint64 created = QDateTime::fromString(entityMap["created"].toString().trimmed(), Qt::ISODate).toMSecsSinceEpoch() * 1000;
-                properties.setCreated(created);
-            }
+bool EntityTree::readFromMap(QVariantMap& map) {
+    // These are needed to deal with older content (before adding inheritance modes)
+    int contentVersion = map["Version"].toInt();
+
+    readMapHeader(map);
+
+    // map will have a top-level list keyed as "Entities".  This will be extracted
+    // and iterated over.  Each member of this list is converted to a QVariantMap, then
+    // to a QScriptValue, and then to EntityItemProperties.  These properties are used
+    // to add the new entities to the EntityTree.
+    QVariantList entitiesQList = map["Entities"].toList();
+    QScriptEngine scriptEngine;
+
+    if (entitiesQList.length() == 0) {
+        // Empty map or invalidly formed file.
+        return false;
+    }
+
+    auto nodeList = DependencyManager::get<NodeList>();
+    QUuid sessionID = nodeList ? nodeList->getSessionUUID() : QUuid();
+
+    QVector<EntityItemID> entityIDs(entitiesQList.length());
+    QVector<EntityItemProperties> properties(entitiesQList.length());
+    for (int i = 0; i < entitiesQList.length(); ++i) {
+        // QVariantMap --> QScriptValue --> EntityItemProperties --> Entity
+        QVariantMap entityMap = entitiesQList[i].toMap();
+        readEntityFromMap(entityMap, contentVersion, sessionID, scriptEngine, entityIDs[i], properties[i]);
+    }
+
+    QMap<QUuid, QVector<QUuid>> cloneIDs;
+    bool success = addEntitiesFromMap(entityIDs, properties, cloneIDs);
+
+    for (const auto& entityID : cloneIDs.keys()) {
+        auto entity = findEntityByID(entityID);
+        if (entity) {
+            entity->setCloneIDs(cloneIDs.value(entityID));
         }
+    }
 
-        EntityItemPointer entity = addEntity(entityItemID, properties);
-        if (!entity) {
-            qCDebug(entities) << "adding Entity failed:" << entityItemID << properties.getType();
+    return success;
+}
+
+// the fewest entities converted on a thread at a time, as each chunk pays for a script engine
+const int MIN_ENTITY_CONVERSION_CHUNK_SIZE = 64;
+
+bool EntityTree::readFromStreamedMap(QVariantMap& header, const EntityBatchParser& parseEntities,
+                                     const QString& marketplaceID) {
+    int contentVersion = header["Version"].toInt();
+
+    readMapHeader(header);
+
+    auto nodeList = DependencyManager::get<NodeList>();
+    QUuid sessionID = nodeList ? nodeList->getSessionUUID() : QUuid();
+
+    // Each batch of entities is parsed and converted to properties on the worker threads, in chunks that each get their
+    // own script engine, while the parser reads the next batch. It is then added to the tree in a single pass.
+    QVector<QByteArray> batch;
+    QVector<QPair<int, int>> chunks;
+    QVector<EntityItemID> entityIDs;
+    QVector<EntityItemProperties> properties;
+    std::atomic<bool> wellFormed { true };
+    QFuture<void> conversion;
+
+    QMap<QUuid, QVector<QUuid>> cloneIDs;
+    QSet<EntityItemID> addedEntityIDs;
+    bool success = true;
+    int entityCount = 0;
+
+    // the header pass only finds where each entity ends, so an ill-formed one can turn up after earlier batches were
+    // added, take those out again rather than leave part of the file in the tree
+    auto removeAddedEntities = [&] {
+        deleteEntities(addedEntityIDs, true);
+    };
+
+    auto addConvertedEntities = [&] {
+        conversion.waitForFinished();
+        if (!wellFormed) {
+            qCritical() << "Couldn't parse Entities JSON: Ill-formed entity";
+            return false;
+        }
+        if (!addEntitiesFromMap(entityIDs, properties, cloneIDs, &addedEntityIDs)) {
             success = false;
         }
+        entityIDs.clear();
+        properties.clear();
+        return true;
+    };
 
-        if (entity) {
-            const QUuid& cloneOriginID = entity->getCloneOriginID();
-            if (!cloneOriginID.isNull()) {
-                cloneIDs[cloneOriginID].push_back(entity->getEntityItemID());
-            }
+    bool parsed = parseEntities([&](const QVector<QByteArray>& entities) {
+        if (!addConvertedEntities()) {
+            return false;
         }
+
+        batch = entities;
+        entityIDs.resize(batch.size());
+        properties.resize(batch.size());
+        entityCount += batch.size();
+
+        int threadCount = std::max(QThreadPool::globalInstance()->maxThreadCount(), 1);
+        int chunkSize = std::max((batch.size() + threadCount - 1) / threadCount, MIN_ENTITY_CONVERSION_CHUNK_SIZE);
+        chunks.clear();
+        for (int begin = 0; begin < batch.size(); begin += chunkSize) {
+            chunks.push_back({ begin, std::min(begin + chunkSize, batch.size()) });
+        }
+
+        EntityItemID* convertedIDs = entityIDs.data();
+        EntityItemProperties* convertedProperties = properties.data();
+        conversion = QtConcurrent::map(chunks, [&, convertedIDs, convertedProperties](const QPair<int, int>& chunk) {
+            QScriptEngine scriptEngine;
+            for (int i = chunk.first; i < chunk.second; ++i) {
+                QJsonDocument entity = QJsonDocument::fromJson(batch[i]);
+                if (!entity.isObject()) {
+                    wellFormed = false;
+                    continue;
+                }
+
+                QVariantMap entityMap = entity.object().toVariantMap();
+                if (!marketplaceID.isEmpty()) {
+                    entityMap["marketplaceID"] = marketplaceID;
+                }
+                readEntityFromMap(entityMap, contentVersion, sessionID, scriptEngine, convertedIDs[i], convertedProperties[i]);
+            }
+        });
+        return true;
+    });
+
+    if (!parsed) {
+        conversion.waitForFinished();
+        removeAddedEntities();
+        return false;
+    }
+    if (!addConvertedEntities()) {
+        removeAddedEntities();
+        return false;
+    }
+
+    if (entityCount == 0) {
+        // Empty map or invalidly formed file.
+        return false;
     }
 
     for (const auto& entityID : cloneIDs.keys()) {
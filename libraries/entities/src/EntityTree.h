@@ -20,6 +20,7 @@
 
 #include "AddEntityOperator.h"
 #include "EntityTreeElement.h"
+#include "EntitySearchIndex.h"
 #include "DeleteEntityOperator.h"
 #include "MovingEntitiesOperator.h"
 
@@ -27,6 +28,7 @@ class EntityTree;
 using EntityTreePointer = std::shared_ptr<EntityTree>;
 
 class EntitySimulation;
+class QScriptEngine;
 
 namespace EntityQueryFilterSymbol {
     static const QString NonDefault = "+";
@@ -43,6 +45,8 @@ public:
     EntityTree* ourTree;
     EntityTreePointer otherTree;
     QHash<EntityItemID, EntityItemID>* map;
+    QVector<EntityItemID> newEntityIDs;
+    QVector<EntityItemProperties> newEntityProperties;
 };
 
 class EntityTree : public Octree, public SpatialParentTree {
@@ -99,6 +103,13 @@ public:
         BoxFace& face, glm::vec3& surfaceNormal, QVariantMap& extraInfo,
         Octree::lockType lockType = Octree::TryLock, bool* accurateResult = NULL);
 
+    /// Finds the closest entity hit by each of several rays that share an origin, in one pass through the tree per
+    /// EntityTreeElement::MAX_RAYS_PER_BATCH rays. intersections gets one result per direction, in the same order.
+    void evalRayIntersections(const glm::vec3& origin, const QVector<glm::vec3>& directions,
+        const QVector<EntityItemID>& entityIdsToInclude, const QVector<EntityItemID>& entityIdsToDiscard,
+        PickFilter searchFilter, QVector<EntityRayIntersection>& intersections,
+        Octree::lockType lockType = Octree::TryLock, bool* accurateResult = NULL);
+
     virtual EntityItemID evalParabolaIntersection(const PickParabola& parabola,
         QVector<EntityItemID> entityIdsToInclude, QVector<EntityItemID> entityIdsToDiscard,
         PickFilter searchFilter, OctreeElementPointer& element, glm::vec3& intersection,
@@ -117,6 +128,10 @@ public:
     void postAddEntity(EntityItemPointer entityItem);
 
     EntityItemPointer addEntity(const EntityItemID& entityID, const EntityItemProperties& properties, bool isClone = false);
+    // Adds the new entities together, see BulkEntityInserter, otherwise the same as calling addEntity with each.
+    // The entities that couldn't be added are null in the result.
+    QVector<EntityItemPointer> addEntities(const QVector<EntityItemID>& entityIDs,
+                                           const QVector<EntityItemProperties>& properties);
 
     // use this method if you only know the entityID
     bool updateEntity(const EntityItemID& entityID, const EntityItemProperties& properties, const SharedNodePointer& senderNode = SharedNodePointer(nullptr));
@@ -198,6 +213,8 @@ public:
     virtual bool writeToMap(QVariantMap& entityDescription, OctreeElementPointer element, bool skipDefaultValues,
                             bool skipThoseWithBadParents) override;
     virtual bool readFromMap(QVariantMap& entityDescription) override;
+    virtual bool readFromStreamedMap(QVariantMap& header, const EntityBatchParser& parseEntities,
+                                     const QString& marketplaceID) override;
     virtual bool writeToJSON(QString& jsonString, const OctreeElementPointer& element) override;
 
 
@@ -297,6 +314,12 @@ protected:
 
     bool isScriptInWhitelist(const QString& scriptURL);
 
+    void updateSearchIndexName(const EntityItemPointer& entity);
+    bool shouldUseSearchIndex(int candidateCount, const glm::vec3& center, float radius) const;
+    template <typename F>
+    void evalIndexedEntitiesInSphere(const EntitySearchIndex::Bucket& candidates, const glm::vec3& center, float radius,
+        PickFilter searchFilter, QVector<QUuid>& foundEntities, F matches) const;
+
     QReadWriteLock _newlyCreatedHooksLock;
     QVector<NewlyCreatedEntityHook*> _newlyCreatedHooks;
 
@@ -318,6 +341,7 @@ protected:
 
     mutable QReadWriteLock _entityMapLock;
     QHash<EntityItemID, EntityItemPointer> _entityMap;
+    EntitySearchIndex _searchIndex; // guarded by _entityMapLock
 
     mutable QReadWriteLock _entityCertificateIDMapLock;
     QHash<QString, EntityItemID> _entityCertificateIDMap;
@@ -385,6 +409,12 @@ private:
 
     std::map<QString, QString> _namedPaths;
 
+    void readMapHeader(const QVariantMap& map);
+    void readEntityFromMap(QVariantMap& entityMap, int contentVersion, const QUuid& sessionID, QScriptEngine& scriptEngine,
+                           EntityItemID& entityItemID, EntityItemProperties& properties) const;
+    bool addEntitiesFromMap(const QVector<EntityItemID>& entityIDs, const QVector<EntityItemProperties>& properties,
+                            QMap<QUuid, QVector<QUuid>>& cloneIDs, QSet<EntityItemID>* addedEntityIDs = nullptr);
+
     void updateEntityQueryAACubeWorker(SpatiallyNestablePointer object, EntityEditPacketSender* packetSender,
                                        MovingEntitiesOperator& moveOperator, bool force, bool tellServer);
 };
@@ -14,6 +14,7 @@
 #include <glm/gtx/transform.hpp>
 
 #include <GeometryUtil.h>
+#include <OctreeElementPool.h>
 #include <OctreeUtils.h>
 #include <Extents.h>
 
@@ -23,6 +24,14 @@
 #include "EntityTree.h"
 #include "EntityTypes.h"
 
+//
+// on x86 architecture, assume that SSE2 is present
+//
+#if defined(_M_IX86) || defined(_M_X64) || defined(__i386__) || defined(__x86_64__)
+#include <emmintrin.h>  // SSE2
+#define ENTITY_TREE_ELEMENT_SSE2 1
+#endif
+
 EntityTreeElement::EntityTreeElement(unsigned char* octalCode) : OctreeElement() {
     init(octalCode);
 };
@@ -32,7 +41,8 @@ EntityTreeElement::~EntityTreeElement() {
 }
 
 OctreeElementPointer EntityTreeElement::createNewElement(unsigned char* octalCode) {
-    auto newChild = EntityTreeElementPointer(new EntityTreeElement(octalCode));
+    auto newChild = adoptPooledOctreeElement(
+        new (allocatePooledOctreeElement<EntityTreeElement>()) EntityTreeElement(octalCode));
     newChild->setTree(_myTree);
     return newChild;
 }
@@ -185,86 +195,233 @@ EntityItemID EntityTreeElement::evalRayIntersection(const glm::vec3& origin, con
     return result;
 }
 
-EntityItemID EntityTreeElement::evalDetailedRayIntersection(const glm::vec3& origin, const glm::vec3& direction,
-                                    OctreeElementPointer& element, float& distance, BoxFace& face, glm::vec3& surfaceNormal,
-                                    const QVector<EntityItemID>& entityIdsToInclude, const QVector<EntityItemID>& entityIDsToDiscard,
-                                    PickFilter searchFilter, QVariantMap& extraInfo) {
+namespace {
 
-    // only called if we do intersect our bounding cube, but find if we actually intersect with entities...
-    EntityItemID entityID;
-    forEachEntity([&](EntityItemPointer entity) {
-        if (entity->getIgnorePickIntersection()) {
-            return;
-        }
+const int ENTITY_BLOCK_SIZE = 4;
 
-        // use simple line-sphere for broadphase check
-        // (this is faster and more likely to cull results than the filter check below so we do it first)
-        bool success;
-        AABox entityBox = entity->getAABox(success);
-        if (!success) {
-            return;
-        }
-        if (!entityBox.rayHitsBoundingSphere(origin, direction)) {
-            return;
+// The bounding spheres of up to four entities, relative to the pick origin, laid out so they can be tested together
+struct EntityBoundsBlock {
+    alignas(16) float x[ENTITY_BLOCK_SIZE];
+    alignas(16) float y[ENTITY_BLOCK_SIZE];
+    alignas(16) float z[ENTITY_BLOCK_SIZE];
+    alignas(16) float radiusSquared[ENTITY_BLOCK_SIZE];
+    alignas(16) float distanceSquared[ENTITY_BLOCK_SIZE]; // from the origin to the center
+    int indices[ENTITY_BLOCK_SIZE];
+    int count { 0 };
+};
+
+// returns false if the entity can't be picked
+bool addEntityBounds(EntityBoundsBlock& block, const EntityItemPointer& entity, int index, const glm::vec3& origin) {
+    if (entity->getIgnorePickIntersection()) {
+        return false;
+    }
+    bool success;
+    AABox entityBox = entity->getAABox(success);
+    if (!success) {
+        return false;
+    }
+
+    glm::vec3 localCenter = entityBox.calcCenter() - origin;
+    const float ONE_OVER_TWO_SQUARED = 0.25f;
+    int lane = block.count++;
+    block.x[lane] = localCenter.x;
+    block.y[lane] = localCenter.y;
+    block.z[lane] = localCenter.z;
+    block.radiusSquared[lane] = ONE_OVER_TWO_SQUARED * glm::length2(entityBox.getScale());
+    block.distanceSquared[lane] = glm::length2(localCenter);
+    block.indices[lane] = index;
+    return true;
+}
+
+void padEntityBounds(EntityBoundsBlock& block) {
+    // a negative radius never hits anything
+    for (int lane = block.count; lane < ENTITY_BLOCK_SIZE; lane++) {
+        block.x[lane] = 0.0f;
+        block.y[lane] = 0.0f;
+        block.z[lane] = 0.0f;
+        block.radiusSquared[lane] = -1.0f;
+        block.distanceSquared[lane] = 0.0f;
+    }
+}
+
+#if ENTITY_TREE_ELEMENT_SSE2
+
+// AABox::rayHitsBoundingSphere() for each sphere in the block, returns a bit per lane
+uint32_t rayHitsBoundingSpheres(const EntityBoundsBlock& block, const glm::vec3& direction) {
+    __m128 x = _mm_load_ps(block.x);
+    __m128 y = _mm_load_ps(block.y);
+    __m128 z = _mm_load_ps(block.z);
+    __m128 radiusSquared = _mm_load_ps(block.radiusSquared);
+    __m128 dx = _mm_set1_ps(direction.x);
+    __m128 dy = _mm_set1_ps(direction.y);
+    __m128 dz = _mm_set1_ps(direction.z);
+
+    __m128 distance = _mm_add_ps(_mm_add_ps(_mm_mul_ps(x, dx), _mm_mul_ps(y, dy)), _mm_mul_ps(z, dz));
+    __m128 offsetX = _mm_sub_ps(_mm_mul_ps(distance, dx), x);
+    __m128 offsetY = _mm_sub_ps(_mm_mul_ps(distance, dy), y);
+    __m128 offsetZ = _mm_sub_ps(_mm_mul_ps(distance, dz), z);
+    __m128 offsetSquared = _mm_add_ps(_mm_add_ps(_mm_mul_ps(offsetX, offsetX), _mm_mul_ps(offsetY, offsetY)),
+        _mm_mul_ps(offsetZ, offsetZ));
+
+    __m128 inside = _mm_cmplt_ps(_mm_load_ps(block.distanceSquared), radiusSquared);
+    __m128 absDistance = _mm_andnot_ps(_mm_set1_ps(-0.0f), distance);
+    __m128 crosses = _mm_and_ps(_mm_cmpgt_ps(absDistance, _mm_setzero_ps()), _mm_cmplt_ps(offsetSquared, radiusSquared));
+    return (uint32_t)_mm_movemask_ps(_mm_or_ps(inside, crosses));
+}
+
+// the plane part of AABox::parabolaPlaneIntersectsBoundingSphere() for each sphere in the block, returns a bit per lane
+uint32_t parabolaPlaneIntersectsBoundingSpheres(const EntityBoundsBlock& block, const glm::vec3& normal) {
+    __m128 distance = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_load_ps(block.x), _mm_set1_ps(normal.x)),
+        _mm_mul_ps(_mm_load_ps(block.y), _mm_set1_ps(normal.y))), _mm_mul_ps(_mm_load_ps(block.z), _mm_set1_ps(normal.z)));
+    __m128 radiusSquared = _mm_load_ps(block.radiusSquared);
+    __m128 inside = _mm_cmplt_ps(_mm_load_ps(block.distanceSquared), radiusSquared);
+    __m128 slices = _mm_cmplt_ps(_mm_mul_ps(distance, distance), radiusSquared);
+    return (uint32_t)_mm_movemask_ps(_mm_or_ps(inside, slices));
+}
+
+#else   // portable reference code
+
+uint32_t rayHitsBoundingSpheres(const EntityBoundsBlock& block, const glm::vec3& direction) {
+    uint32_t hits = 0;
+    for (int lane = 0; lane < ENTITY_BLOCK_SIZE; lane++) {
+        glm::vec3 localCenter(block.x[lane], block.y[lane], block.z[lane]);
+        float distance = glm::dot(localCenter, direction);
+        if (block.distanceSquared[lane] < block.radiusSquared[lane] ||
+                (glm::abs(distance) > 0.0f && glm::distance2(distance * direction, localCenter) < block.radiusSquared[lane])) {
+            hits |= 1 << lane;
         }
+    }
+    return hits;
+}
 
-        if (!checkFilterSettings(entity, searchFilter) ||
-            (entityIdsToInclude.size() > 0 && !entityIdsToInclude.contains(entity->getID())) ||
-            (entityIDsToDiscard.size() > 0 && entityIDsToDiscard.contains(entity->getID())) ) {
-            return;
+uint32_t parabolaPlaneIntersectsBoundingSpheres(const EntityBoundsBlock& block, const glm::vec3& normal) {
+    uint32_t hits = 0;
+    for (int lane = 0; lane < ENTITY_BLOCK_SIZE; lane++) {
+        float distance = glm::dot(glm::vec3(block.x[lane], block.y[lane], block.z[lane]), normal);
+        if (block.distanceSquared[lane] < block.radiusSquared[lane] || distance * distance < block.radiusSquared[lane]) {
+            hits |= 1 << lane;
         }
+    }
+    return hits;
+}
 
-        // extents is the entity relative, scaled, centered extents of the entity
-        glm::mat4 rotation = glm::mat4_cast(entity->getWorldOrientation());
-        glm::mat4 translation = glm::translate(entity->getWorldPosition());
-        glm::mat4 entityToWorldMatrix = translation * rotation;
-        glm::mat4 worldToEntityMatrix = glm::inverse(entityToWorldMatrix);
+#endif
 
-        glm::vec3 dimensions = entity->getRaycastDimensions();
-        glm::vec3 registrationPoint = entity->getRegistrationPoint();
-        glm::vec3 corner = -(dimensions * registrationPoint);
+// the narrow phase of a ray pick, for an entity that passed the bounding sphere check
+void evalEntityRayIntersection(const EntityItemPointer& entity, const glm::vec3& origin, const glm::vec3& direction,
+        OctreeElementPointer& element, EntityRayIntersection& intersection, const QVector<EntityItemID>& entityIdsToInclude,
+        const QVector<EntityItemID>& entityIDsToDiscard, PickFilter searchFilter) {
+    if (!EntityTreeElement::checkFilterSettings(entity, searchFilter) ||
+        (entityIdsToInclude.size() > 0 && !entityIdsToInclude.contains(entity->getID())) ||
+        (entityIDsToDiscard.size() > 0 && entityIDsToDiscard.contains(entity->getID())) ) {
+        return;
+    }
 
-        AABox entityFrameBox(corner, dimensions);
+    // extents is the entity relative, scaled, centered extents of the entity
+    glm::mat4 rotation = glm::mat4_cast(entity->getWorldOrientation());
+    glm::mat4 translation = glm::translate(entity->getWorldPosition());
+    glm::mat4 entityToWorldMatrix = translation * rotation;
+    glm::mat4 worldToEntityMatrix = glm::inverse(entityToWorldMatrix);
 
-        glm::vec3 entityFrameOrigin = glm::vec3(worldToEntityMatrix * glm::vec4(origin, 1.0f));
-        glm::vec3 entityFrameDirection = glm::vec3(worldToEntityMatrix * glm::vec4(direction, 0.0f));
+    glm::vec3 dimensions = entity->getRaycastDimensions();
+    glm::vec3 registrationPoint = entity->getRegistrationPoint();
+    glm::vec3 corner = -(dimensions * registrationPoint);
 
-        // we can use the AABox's ray intersection by mapping our origin and direction into the entity frame
-        // and testing intersection there.
-        float localDistance;
-        BoxFace localFace { UNKNOWN_FACE };
-        glm::vec3 localSurfaceNormal;
-        if (entityFrameBox.findRayIntersection(entityFrameOrigin, entityFrameDirection, 1.0f / entityFrameDirection, localDistance,
-                                                localFace, localSurfaceNormal)) {
-            if (entityFrameBox.contains(entityFrameOrigin) || localDistance < distance) {
-                // now ask the entity if we actually intersect
-                if (entity->supportsDetailedIntersection()) {
-                    QVariantMap localExtraInfo;
-                    if (entity->findDetailedRayIntersection(origin, direction, element, localDistance,
-                            localFace, localSurfaceNormal, localExtraInfo, searchFilter.isPrecise())) {
-                        if (localDistance < distance) {
-                            distance = localDistance;
-                            face = localFace;
-                            surfaceNormal = localSurfaceNormal;
-                            extraInfo = localExtraInfo;
-                            entityID = entity->getEntityItemID();
-                        }
+    AABox entityFrameBox(corner, dimensions);
+
+    glm::vec3 entityFrameOrigin = glm::vec3(worldToEntityMatrix * glm::vec4(origin, 1.0f));
+    glm::vec3 entityFrameDirection = glm::vec3(worldToEntityMatrix * glm::vec4(direction, 0.0f));
+
+    // we can use the AABox's ray intersection by mapping our origin and direction into the entity frame
+    // and testing intersection there.
+    float localDistance;
+    BoxFace localFace { UNKNOWN_FACE };
+    glm::vec3 localSurfaceNormal;
+    if (entityFrameBox.findRayIntersection(entityFrameOrigin, entityFrameDirection, 1.0f / entityFrameDirection, localDistance,
+                                            localFace, localSurfaceNormal)) {
+        if (entityFrameBox.contains(entityFrameOrigin) || localDistance < intersection.distance) {
+            // now ask the entity if we actually intersect
+            if (entity->supportsDetailedIntersection()) {
+                QVariantMap localExtraInfo;
+                if (entity->findDetailedRayIntersection(origin, direction, element, localDistance,
+                        localFace, localSurfaceNormal, localExtraInfo, searchFilter.isPrecise())) {
+                    if (localDistance < intersection.distance) {
+                        intersection.distance = localDistance;
+                        intersection.face = localFace;
+                        intersection.surfaceNormal = localSurfaceNormal;
+                        intersection.extraInfo = localExtraInfo;
+                        intersection.entityID = entity->getEntityItemID();
                     }
-                } else {
-                    // if the entity type doesn't support a detailed intersection, then just return the non-AABox results
-                    // Never intersect with particle entities
-                    if (localDistance < distance && entity->getType() != EntityTypes::ParticleEffect) {
-                        distance = localDistance;
-                        face = localFace;
-                        surfaceNormal = glm::vec3(rotation * glm::vec4(localSurfaceNormal, 0.0f));
-                        extraInfo = QVariantMap();
-                        entityID = entity->getEntityItemID();
+                }
+            } else {
+                // if the entity type doesn't support a detailed intersection, then just return the non-AABox results
+                // Never intersect with particle entities
+                if (localDistance < intersection.distance && entity->getType() != EntityTypes::ParticleEffect) {
+                    intersection.distance = localDistance;
+                    intersection.face = localFace;
+                    intersection.surfaceNormal = glm::vec3(rotation * glm::vec4(localSurfaceNormal, 0.0f));
+                    intersection.extraInfo = QVariantMap();
+                    intersection.entityID = entity->getEntityItemID();
+                }
+            }
+        }
+    }
+}
+
+}
+
+EntityItemID EntityTreeElement::evalDetailedRayIntersection(const glm::vec3& origin, const glm::vec3& direction,
+                                    OctreeElementPointer& element, float& distance, BoxFace& face, glm::vec3& surfaceNormal,
+                                    const QVector<EntityItemID>& entityIdsToInclude, const QVector<EntityItemID>& entityIDsToDiscard,
+                                    PickFilter searchFilter, QVariantMap& extraInfo) {
+
+    // only called if we do intersect our bounding cube, but find if we actually intersect with entities...
+    EntityRayIntersection intersection;
+    intersection.distance = distance;
+    evalRayIntersections(origin, &direction, 1, 1, element, &intersection, entityIdsToInclude, entityIDsToDiscard, searchFilter);
+    if (!intersection.entityID.isNull()) {
+        distance = intersection.distance;
+        face = intersection.face;
+        surfaceNormal = intersection.surfaceNormal;
+        extraInfo = intersection.extraInfo;
+    }
+    return intersection.entityID;
+}
+
+void EntityTreeElement::evalRayIntersections(const glm::vec3& origin, const glm::vec3* directions, int numRays,
+        uint32_t rayMask, OctreeElementPointer& element, EntityRayIntersection* intersections,
+        const QVector<EntityItemID>& entityIdsToInclude, const QVector<EntityItemID>& entityIDsToDiscard,
+        PickFilter searchFilter) {
+    withReadLock([&] {
+        // use simple line-sphere for broadphase check, four entities at a time
+        // (this is faster and more likely to cull results than the filter check so we do it first)
+        EntityBoundsBlock block;
+        auto evalBlock = [&] {
+            padEntityBounds(block);
+            for (int ray = 0; ray < numRays; ray++) {
+                if (!(rayMask & (1u << ray))) {
+                    continue;
+                }
+                uint32_t hits = rayHitsBoundingSpheres(block, directions[ray]);
+                for (int lane = 0; lane < block.count; lane++) {
+                    if (hits & (1 << lane)) {
+                        evalEntityRayIntersection(_entityItems[block.indices[lane]], origin, directions[ray], element,
+                            intersections[ray], entityIdsToInclude, entityIDsToDiscard, searchFilter);
                     }
                 }
             }
+            block.count = 0;
+        };
+
+        for (int i = 0; i < _entityItems.size(); i++) {
+            if (addEntityBounds(block, _entityItems[i], i, origin) && block.count == ENTITY_BLOCK_SIZE) {
+                evalBlock();
+            }
+        }
+        if (block.count > 0) {
+            evalBlock();
         }
     });
-    return entityID;
 }
 
 // TODO: change this to use better bounding shape for entity than sphere
@@ -336,27 +493,12 @@ EntityItemID EntityTreeElement::evalDetailedParabolaIntersection(const glm::vec3
 
     // only called if we do intersect our bounding cube, but find if we actually intersect with entities...
     EntityItemID entityID;
-    forEachEntity([&](EntityItemPointer entity) {
-        if (entity->getIgnorePickIntersection()) {
-            return;
-        }
 
-        // use simple line-sphere for broadphase check
-        // (this is faster and more likely to cull results than the filter check below so we do it first)
-        bool success;
-        AABox entityBox = entity->getAABox(success);
-        if (!success) {
-            return;
-        }
-
-        // Instead of checking parabolaInstersectsBoundingSphere here, we are just going to check if the plane
-        // defined by the parabola slices the sphere.  The solution to parabolaIntersectsBoundingSphere is cubic,
-        // the solution to which is more computationally expensive than the quadratic AABox::findParabolaIntersection
-        // below
-        if (!entityBox.parabolaPlaneIntersectsBoundingSphere(origin, velocity, acceleration, normal)) {
-            return;
-        }
+    // Handle the degenerate case where acceleration == (0, 0, 0) as a ray, see AABox::parabolaPlaneIntersectsBoundingSphere()
+    bool isRay = glm::length2(acceleration) < EPSILON;
+    glm::vec3 rayDirection = isRay ? glm::normalize(velocity) : glm::vec3();
 
+    auto evalEntity = [&](const EntityItemPointer& entity) {
         if (!checkFilterSettings(entity, searchFilter) ||
             (entityIdsToInclude.size() > 0 && !entityIdsToInclude.contains(entity->getID())) ||
             (entityIDsToDiscard.size() > 0 && entityIDsToDiscard.contains(entity->getID()))) {
@@ -413,6 +555,33 @@ EntityItemID EntityTreeElement::evalDetailedParabolaIntersection(const glm::vec3
                 }
             }
         }
+    };
+
+    withReadLock([&] {
+        // Instead of checking parabolaInstersectsBoundingSphere here, we are just going to check if the plane
+        // defined by the parabola slices the sphere.  The solution to parabolaIntersectsBoundingSphere is cubic,
+        // the solution to which is more computationally expensive than the quadratic AABox::findParabolaIntersection
+        // below.  The spheres are checked four at a time.
+        EntityBoundsBlock block;
+        auto evalBlock = [&] {
+            padEntityBounds(block);
+            uint32_t hits = isRay ? rayHitsBoundingSpheres(block, rayDirection) : parabolaPlaneIntersectsBoundingSpheres(block, normal);
+            for (int lane = 0; lane < block.count; lane++) {
+                if (hits & (1 << lane)) {
+                    evalEntity(_entityItems[block.indices[lane]]);
+                }
+            }
+            block.count = 0;
+        };
+
+        for (int i = 0; i < _entityItems.size(); i++) {
+            if (addEntityBounds(block, _entityItems[i], i, origin) && block.count == ENTITY_BLOCK_SIZE) {
+                evalBlock();
+            }
+        }
+        if (block.count > 0) {
+            evalBlock();
+        }
     });
     return entityID;
 }
@@ -433,110 +602,62 @@ QUuid EntityTreeElement::evalClosetEntity(const glm::vec3& position, PickFilter
     return closestEntity;
 }
 
-void EntityTreeElement::evalEntitiesInSphere(const glm::vec3& position, float radius, PickFilter searchFilter, QVector<QUuid>& foundEntities) const {
-    forEachEntity([&](EntityItemPointer entity) {
-        if (!checkFilterSettings(entity, searchFilter)) {
-            return;
-        }
+bool EntityTreeElement::checkEntityInSphere(const EntityItemPointer& entity, const glm::vec3& position, float radius) {
+    bool success;
+    AABox entityBox = entity->getAABox(success);
 
-        bool success;
-        AABox entityBox = entity->getAABox(success);
+    // if the sphere doesn't intersect with our world frame AABox, we don't need to consider the more complex case
+    glm::vec3 penetration;
+    if (success && entityBox.findSpherePenetration(position, radius, penetration)) {
 
-        // if the sphere doesn't intersect with our world frame AABox, we don't need to consider the more complex case
-        glm::vec3 penetration;
-        if (success && entityBox.findSpherePenetration(position, radius, penetration)) {
+        glm::vec3 dimensions = entity->getRaycastDimensions();
 
-            glm::vec3 dimensions = entity->getRaycastDimensions();
+        // FIXME - consider allowing the entity to determine penetration so that
+        //         entities could presumably do actual hull testing if they wanted to
+        // FIXME - handle entity->getShapeType() == SHAPE_TYPE_SPHERE case better in particular
+        //         can we handle the ellipsoid case better? We only currently handle perfect spheres
+        //         with centered registration points
+        if (entity->getShapeType() == SHAPE_TYPE_SPHERE && (dimensions.x == dimensions.y && dimensions.y == dimensions.z)) {
 
-            // FIXME - consider allowing the entity to determine penetration so that
-            //         entities could presumably do actual hull testing if they wanted to
-            // FIXME - handle entity->getShapeType() == SHAPE_TYPE_SPHERE case better in particular
-            //         can we handle the ellipsoid case better? We only currently handle perfect spheres
-            //         with centered registration points
-            if (entity->getShapeType() == SHAPE_TYPE_SPHERE && (dimensions.x == dimensions.y && dimensions.y == dimensions.z)) {
+            // NOTE: entity->getRadius() doesn't return the true radius, it returns the radius of the
+            //       maximum bounding sphere, which is actually larger than our actual radius
+            float entityTrueRadius = dimensions.x / 2.0f;
 
-                // NOTE: entity->getRadius() doesn't return the true radius, it returns the radius of the
-                //       maximum bounding sphere, which is actually larger than our actual radius
-                float entityTrueRadius = dimensions.x / 2.0f;
+            bool success;
+            glm::vec3 center = entity->getCenterPosition(success);
+            return success && findSphereSpherePenetration(position, radius, center, entityTrueRadius, penetration);
+        } else {
+            // determine the worldToEntityMatrix that doesn't include scale because
+            // we're going to use the registration aware aa box in the entity frame
+            glm::mat4 rotation = glm::mat4_cast(entity->getWorldOrientation());
+            glm::mat4 translation = glm::translate(entity->getWorldPosition());
+            glm::mat4 entityToWorldMatrix = translation * rotation;
+            glm::mat4 worldToEntityMatrix = glm::inverse(entityToWorldMatrix);
 
-                bool success;
-                if (findSphereSpherePenetration(position, radius, entity->getCenterPosition(success), entityTrueRadius, penetration)) {
-                    if (success) {
-                        foundEntities.push_back(entity->getID());
-                    }
-                }
-            } else {
-                // determine the worldToEntityMatrix that doesn't include scale because
-                // we're going to use the registration aware aa box in the entity frame
-                glm::mat4 rotation = glm::mat4_cast(entity->getWorldOrientation());
-                glm::mat4 translation = glm::translate(entity->getWorldPosition());
-                glm::mat4 entityToWorldMatrix = translation * rotation;
-                glm::mat4 worldToEntityMatrix = glm::inverse(entityToWorldMatrix);
+            glm::vec3 registrationPoint = entity->getRegistrationPoint();
+            glm::vec3 corner = -(dimensions * registrationPoint);
 
-                glm::vec3 registrationPoint = entity->getRegistrationPoint();
-                glm::vec3 corner = -(dimensions * registrationPoint);
+            AABox entityFrameBox(corner, dimensions);
 
-                AABox entityFrameBox(corner, dimensions);
+            glm::vec3 entityFrameSearchPosition = glm::vec3(worldToEntityMatrix * glm::vec4(position, 1.0f));
+            return entityFrameBox.findSpherePenetration(entityFrameSearchPosition, radius, penetration);
+        }
+    }
+    return false;
+}
 
-                glm::vec3 entityFrameSearchPosition = glm::vec3(worldToEntityMatrix * glm::vec4(position, 1.0f));
-                if (entityFrameBox.findSpherePenetration(entityFrameSearchPosition, radius, penetration)) {
-                    foundEntities.push_back(entity->getID());
-                }
-            }
+void EntityTreeElement::evalEntitiesInSphere(const glm::vec3& position, float radius, PickFilter searchFilter, QVector<QUuid>& foundEntities) const {
+    forEachEntity([&](EntityItemPointer entity) {
+        if (checkFilterSettings(entity, searchFilter) && checkEntityInSphere(entity, position, radius)) {
+            foundEntities.push_back(entity->getID());
         }
     });
 }
 
 void EntityTreeElement::evalEntitiesInSphereWithType(const glm::vec3& position, float radius, EntityTypes::EntityType type, PickFilter searchFilter, QVector<QUuid>& foundEntities) const {
     forEachEntity([&](EntityItemPointer entity) {
-        if (!checkFilterSettings(entity, searchFilter) || type != entity->getType()) {
-            return;
-        }
-
-        bool success;
-        AABox entityBox = entity->getAABox(success);
-
-        // if the sphere doesn't intersect with our world frame AABox, we don't need to consider the more complex case
-        glm::vec3 penetration;
-        if (success && entityBox.findSpherePenetration(position, radius, penetration)) {
-
-            glm::vec3 dimensions = entity->getRaycastDimensions();
-
-            // FIXME - consider allowing the entity to determine penetration so that
-            //         entities could presumably do actual hull testing if they wanted to
-            // FIXME - handle entity->getShapeType() == SHAPE_TYPE_SPHERE case better in particular
-            //         can we handle the ellipsoid case better? We only currently handle perfect spheres
-            //         with centered registration points
-            if (entity->getShapeType() == SHAPE_TYPE_SPHERE && (dimensions.x == dimensions.y && dimensions.y == dimensions.z)) {
-
-                // NOTE: entity->getRadius() doesn't return the true radius, it returns the radius of the
-                //       maximum bounding sphere, which is actually larger than our actual radius
-                float entityTrueRadius = dimensions.x / 2.0f;
-
-                bool success;
-                if (findSphereSpherePenetration(position, radius, entity->getCenterPosition(success), entityTrueRadius, penetration)) {
-                    if (success) {
-                        foundEntities.push_back(entity->getID());
-                    }
-                }
-            } else {
-                // determine the worldToEntityMatrix that doesn't include scale because
-                // we're going to use the registration aware aa box in the entity frame
-                glm::mat4 rotation = glm::mat4_cast(entity->getWorldOrientation());
-                glm::mat4 translation = glm::translate(entity->getWorldPosition());
-                glm::mat4 entityToWorldMatrix = translation * rotation;
-                glm::mat4 worldToEntityMatrix = glm::inverse(entityToWorldMatrix);
-
-                glm::vec3 registrationPoint = entity->getRegistrationPoint();
-                glm::vec3 corner = -(dimensions * registrationPoint);
-
-                AABox entityFrameBox(corner, dimensions);
-
-                glm::vec3 entityFrameSearchPosition = glm::vec3(worldToEntityMatrix * glm::vec4(position, 1.0f));
-                if (entityFrameBox.findSpherePenetration(entityFrameSearchPosition, radius, penetration)) {
-                    foundEntities.push_back(entity->getID());
-                }
-            }
+        if (type == entity->getType() && checkFilterSettings(entity, searchFilter) && checkEntityInSphere(entity, position, radius)) {
+            foundEntities.push_back(entity->getID());
         }
     });
 }
@@ -552,50 +673,8 @@ void EntityTreeElement::evalEntitiesInSphereWithName(const glm::vec3& position,
             return;
         }
 
-        bool success;
-        AABox entityBox = entity->getAABox(success);
-
-        // if the sphere doesn't intersect with our world frame AABox, we don't need to consider the more complex case
-        glm::vec3 penetration;
-        if (success && entityBox.findSpherePenetration(position, radius, penetration)) {
-
-            glm::vec3 dimensions = entity->getRaycastDimensions();
-
-            // FIXME - consider allowing the entity to determine penetration so that
-            //         entities could presumably do actual hull testing if they wanted to
-            // FIXME - handle entity->getShapeType() == SHAPE_TYPE_SPHERE case better in particular
-            //         can we handle the ellipsoid case better? We only currently handle perfect spheres
-            //         with centered registration points
-            if (entity->getShapeType() == SHAPE_TYPE_SPHERE && (dimensions.x == dimensions.y && dimensions.y == dimensions.z)) {
-
-                // NOTE: entity->getRadius() doesn't return the true radius, it returns the radius of the
-                //       maximum bounding sphere, which is actually larger than our actual radius
-                float entityTrueRadius = dimensions.x / 2.0f;
-
-                bool success;
-                if (findSphereSpherePenetration(position, radius, entity->getCenterPosition(success), entityTrueRadius, penetration)) {
-                    if (success) {
-                        foundEntities.push_back(entity->getID());
-                    }
-                }
-            } else {
-                // determine the worldToEntityMatrix that doesn't include scale because
-                // we're going to use the registration aware aa box in the entity frame
-                glm::mat4 rotation = glm::mat4_cast(entity->getWorldOrientation());
-                glm::mat4 translation = glm::translate(entity->getWorldPosition());
-                glm::mat4 entityToWorldMatrix = translation * rotation;
-                glm::mat4 worldToEntityMatrix = glm::inverse(entityToWorldMatrix);
-
-                glm::vec3 registrationPoint = entity->getRegistrationPoint();
-                glm::vec3 corner = -(dimensions * registrationPoint);
-
-                AABox entityFrameBox(corner, dimensions);
-
-                glm::vec3 entityFrameSearchPosition = glm::vec3(worldToEntityMatrix * glm::vec4(position, 1.0f));
-                if (entityFrameBox.findSpherePenetration(entityFrameSearchPosition, radius, penetration)) {
-                    foundEntities.push_back(entity->getID());
-                }
-            }
+        if (checkEntityInSphere(entity, position, radius)) {
+            foundEntities.push_back(entity->getID());
         }
     });
 }
@@ -78,6 +78,16 @@ public:
     EntityEditPacketSender* packetSender;
 };
 
+// The closest entity hit by one of the rays passed to EntityTree::evalRayIntersections()
+class EntityRayIntersection {
+public:
+    EntityItemID entityID;
+    float distance { FLT_MAX };
+    BoxFace face { UNKNOWN_FACE };
+    glm::vec3 surfaceNormal;
+    QVariantMap extraInfo;
+};
+
 class EntityTreeElement : public OctreeElement, ReadWriteLockable {
     friend class EntityTree; // to allow createElement to new us...
 
@@ -135,6 +145,7 @@ public:
     virtual bool deleteApproved() const override { return !hasEntities(); }
 
     static bool checkFilterSettings(const EntityItemPointer& entity, PickFilter searchFilter);
+    static bool checkEntityInSphere(const EntityItemPointer& entity, const glm::vec3& position, float radius);
     virtual bool canPickIntersect() const override { return hasEntities(); }
     virtual EntityItemID evalRayIntersection(const glm::vec3& origin, const glm::vec3& direction,
         OctreeElementPointer& element, float& distance, BoxFace& face, glm::vec3& surfaceNormal,
@@ -144,6 +155,16 @@ public:
                          OctreeElementPointer& element, float& distance,
                          BoxFace& face, glm::vec3& surfaceNormal, const QVector<EntityItemID>& entityIdsToInclude,
                          const QVector<EntityItemID>& entityIdsToDiscard, PickFilter searchFilter, QVariantMap& extraInfo);
+
+    static const int MAX_RAYS_PER_BATCH = 32;
+
+    /// Evaluates the rays in rayMask, which all start at origin, against this element's entities. Each ray's intersection
+    /// is only replaced by a closer one, so the rays can be passed through every element they might hit.
+    void evalRayIntersections(const glm::vec3& origin, const glm::vec3* directions, int numRays, uint32_t rayMask,
+        OctreeElementPointer& element, EntityRayIntersection* intersections,
+        const QVector<EntityItemID>& entityIdsToInclude, const QVector<EntityItemID>& entityIdsToDiscard,
+        PickFilter searchFilter);
+
     virtual bool findSpherePenetration(const glm::vec3& center, float radius,
                         glm::vec3& penetration, void** penetratedObject) const override;
 
@@ -12,6 +12,8 @@
 #ifndef hifi_FBX_h_
 #define hifi_FBX_h_
 
+#include <memory>
+
 #include <QMetaType>
 #include <QVarLengthArray>
 #include <QVariant>
@@ -37,6 +39,32 @@ static const int32_t FBX_PROPERTY_COMPRESSED_FLAG = 1;
 class FBXNode;
 using FBXNodeList = QList<FBXNode>;
 
+// The bytes of a binary FBX document, shared by the array properties that still point into them.
+using FBXDataPointer = std::shared_ptr<const char>;
+
+/// An array property of a binary FBX document, left in the document until its values are asked for.
+/// FBXSerializer::getIntVector() and the like decode it, and so does converting the QVariant to a QVector<T>.
+template<class T>
+class FBXArrayProperty {
+public:
+    FBXDataPointer document;
+    const char* data { nullptr };
+    quint32 arrayLength { 0 };
+    quint32 encoding { 0 };
+    quint32 byteLength { 0 }; // of the data, compressed or not
+
+    /// throws a QString if the data is corrupt
+    QVector<T> decode() const;
+
+    QVector<T> toVector(bool* ok) const;
+};
+
+Q_DECLARE_METATYPE(FBXArrayProperty<float>)
+Q_DECLARE_METATYPE(FBXArrayProperty<double>)
+Q_DECLARE_METATYPE(FBXArrayProperty<qint64>)
+Q_DECLARE_METATYPE(FBXArrayProperty<qint32>)
+Q_DECLARE_METATYPE(FBXArrayProperty<bool>)
+
 
 /// A node within an FBX document.
 class FBXNode {
@@ -264,10 +264,10 @@ ExtractedMesh FBXSerializer::extractMesh(const FBXNode& object, unsigned int& me
                 foreach (const FBXNode& subdata, child.children) {
                     if (subdata.name == "UV") {
                         data.texCoords = createVec2Vector(getDoubleVector(subdata));
-                        attrib.texCoords = createVec2Vector(getDoubleVector(subdata));
+                        attrib.texCoords = data.texCoords;
                     } else if (subdata.name == "UVIndex") {
                         data.texCoordIndices = getIntVector(subdata);
-                        attrib.texCoordIndices = getIntVector(subdata);
+                        attrib.texCoordIndices = data.texCoordIndices;
                     } else if (subdata.name == "Name") {
                         attrib.name = subdata.properties.at(0).toString();
                     } 
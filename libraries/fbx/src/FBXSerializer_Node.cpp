@@ -11,9 +11,15 @@
 
 #include "FBXSerializer.h"
 
+#include <algorithm>
 #include <iostream>
+#include <limits>
+#include <mutex>
+
+#include <zlib.h>
+
 #include <QtCore/QBuffer>
-#include <QtCore/QDataStream>
+#include <QtCore/QFile>
 #include <QtCore/QIODevice>
 #include <QtCore/QStringList>
 #include <QtCore/QTextStream>
@@ -25,179 +31,196 @@
 #include <hfm/ModelFormatLogging.h>
 
 template<class T>
-int streamSize() {
-    return sizeof(T);
+QVector<T> FBXArrayProperty<T>::decode() const {
+    QVector<T> values(arrayLength);
+    size_t valuesLength = (size_t)arrayLength * sizeof(T);
+    if (valuesLength == 0) {
+        return values;
+    }
+    if (encoding == FBX_PROPERTY_COMPRESSED_FLAG) {
+        // inflate straight into the values
+        uLongf inflatedLength = (uLongf)valuesLength;
+        if (uncompress((Bytef*)values.data(), &inflatedLength, (const Bytef*)data, byteLength) != Z_OK ||
+                inflatedLength != valuesLength) {
+            throw QString("corrupt fbx file");
+        }
+    } else {
+        memcpy(values.data(), data, valuesLength);
+    }
+#if Q_BYTE_ORDER == Q_BIG_ENDIAN
+    for (T& value : values) {
+        char* bytes = (char*)&value;
+        std::reverse(bytes, bytes + sizeof(T));
+    }
+#endif
+    return values;
 }
 
-template<bool>
-int streamSize() {
-    return 1;
+template<class T>
+QVector<T> FBXArrayProperty<T>::toVector(bool* ok) const {
+    try {
+        QVector<T> values = decode();
+        *ok = true;
+        return values;
+    } catch (const QString& error) {
+        qCWarning(modelformat) << "Failed to decode fbx array property:" << error;
+        *ok = false;
+        return QVector<T>();
+    }
+}
+
+template class FBXArrayProperty<float>;
+template class FBXArrayProperty<double>;
+template class FBXArrayProperty<qint64>;
+template class FBXArrayProperty<qint32>;
+template class FBXArrayProperty<bool>;
+
+// lets the FBXWriter and FBXToJSON treat array properties still in the document like any other QVector
+static void registerArrayPropertyConverters() {
+    static std::once_flag once;
+    std::call_once(once, [] {
+        QMetaType::registerConverter<FBXArrayProperty<float>, QVector<float>>(&FBXArrayProperty<float>::toVector);
+        QMetaType::registerConverter<FBXArrayProperty<double>, QVector<double>>(&FBXArrayProperty<double>::toVector);
+        QMetaType::registerConverter<FBXArrayProperty<qint64>, QVector<qint64>>(&FBXArrayProperty<qint64>::toVector);
+        QMetaType::registerConverter<FBXArrayProperty<qint32>, QVector<qint32>>(&FBXArrayProperty<qint32>::toVector);
+        QMetaType::registerConverter<FBXArrayProperty<bool>, QVector<bool>>(&FBXArrayProperty<bool>::toVector);
+    });
 }
 
 template<class T>
-QVariant readBinaryArray(QDataStream& in, int& position) {
-    quint32 arrayLength;
-    quint32 encoding;
-    quint32 compressedLength;
-
-    in >> arrayLength;
-    in >> encoding;
-    in >> compressedLength;
-    position += sizeof(quint32) * 3;
-
-    QVector<T> values;
-    if ((int)QSysInfo::ByteOrder == (int)in.byteOrder()) {
-        values.resize(arrayLength);
-        QByteArray arrayData;
-        if (encoding == FBX_PROPERTY_COMPRESSED_FLAG) {
-            // preface encoded data with uncompressed length
-            QByteArray compressed(sizeof(quint32) + compressedLength, 0);
-            *((quint32*)compressed.data()) = qToBigEndian<quint32>(arrayLength * sizeof(T));
-            in.readRawData(compressed.data() + sizeof(quint32), compressedLength);
-            position += compressedLength;
-            arrayData = qUncompress(compressed);
-            if (arrayData.isEmpty() ||
-                (unsigned int)arrayData.size() != (sizeof(T) * arrayLength)) { // answers empty byte array if corrupt
-                throw QString("corrupt fbx file");
-            }
-        } else {
-            arrayData.resize(sizeof(T) * arrayLength);
-            position += sizeof(T) * arrayLength;
-            in.readRawData(arrayData.data(), arrayData.size());
-        }
+QVector<T> getArrayPropertyValues(const QVariant& property) {
+    if (property.userType() == qMetaTypeId<FBXArrayProperty<T>>()) {
+        return property.value<FBXArrayProperty<T>>().decode();
+    }
+    return property.value<QVector<T>>();
+}
 
-        if (arrayData.size() > 0) {
-            memcpy(&values[0], arrayData.constData(), arrayData.size());
-        }
-    } else {
-        values.reserve(arrayLength);
-        if (encoding == FBX_PROPERTY_COMPRESSED_FLAG) {
-            // preface encoded data with uncompressed length
-            QByteArray compressed(sizeof(quint32) + compressedLength, 0);
-            *((quint32*)compressed.data()) = qToBigEndian<quint32>(arrayLength * sizeof(T));
-            in.readRawData(compressed.data() + sizeof(quint32), compressedLength);
-            position += compressedLength;
-            QByteArray uncompressed = qUncompress(compressed);
-            if (uncompressed.isEmpty()) { // answers empty byte array if corrupt
-                throw QString("corrupt fbx file");
-            }
-            QDataStream uncompressedIn(uncompressed);
-            uncompressedIn.setByteOrder(QDataStream::LittleEndian);
-            uncompressedIn.setVersion(QDataStream::Qt_4_5); // for single/double precision switch
-            for (quint32 i = 0; i < arrayLength; i++) {
-                T value;
-                uncompressedIn >> value;
-                values.append(value);
-            }
-        } else {
-            for (quint32 i = 0; i < arrayLength; i++) {
-                T value;
-                in >> value;
-                position += streamSize<T>();
-                values.append(value);
-            }
-        }
+// Parses a binary FBX document that's entirely in memory.
+//
+// Scalars are read straight from the bytes, and array properties are left where they are in the document, to be
+// decoded when the serializer gets to them.
+class BinaryFBXParser {
+public:
+
+    BinaryFBXParser(const FBXDataPointer& document, qint64 size) : _document(document), _size(size) { }
+
+    FBXNode parse();
+
+private:
+
+    const char* skip(qint64 length);
+
+    template<class T>
+    T read();
+
+    template<class T>
+    QVariant parseArray();
+
+    QVariant parseProperty();
+    FBXNode parseNode(bool has64BitPositions);
+
+    FBXDataPointer _document;
+    qint64 _size;
+    qint64 _position { 0 };
+};
+
+const char* BinaryFBXParser::skip(qint64 length) {
+    if (length < 0 || length > _size - _position) {
+        throw QString("corrupt fbx file");
     }
-    return QVariant::fromValue(values);
+    const char* data = _document.get() + _position;
+    _position += length;
+    return data;
 }
 
-QVariant parseBinaryFBXProperty(QDataStream& in, int& position) {
-    char ch;
-    in.device()->getChar(&ch);
-    position++;
+template<class T>
+T BinaryFBXParser::read() {
+    return qFromLittleEndian<T>((const uchar*)skip(sizeof(T)));
+}
+
+template<class T>
+QVariant BinaryFBXParser::parseArray() {
+    FBXArrayProperty<T> array;
+    array.document = _document;
+    array.arrayLength = read<quint32>();
+    array.encoding = read<quint32>();
+    quint32 compressedLength = read<quint32>();
+
+    if (array.arrayLength > (quint32)(std::numeric_limits<int>::max() / sizeof(T))) {
+        throw QString("corrupt fbx file");
+    }
+    array.byteLength = (array.encoding == FBX_PROPERTY_COMPRESSED_FLAG) ? compressedLength : array.arrayLength * sizeof(T);
+    array.data = skip(array.byteLength);
+    return QVariant::fromValue(array);
+}
+
+QVariant BinaryFBXParser::parseProperty() {
+    char ch = *skip(1);
     switch (ch) {
-        case 'Y': {
-            qint16 value;
-            in >> value;
-            position += sizeof(qint16);
-            return QVariant::fromValue(value);
-        }
-        case 'C': {
-            bool value;
-            in >> value;
-            position++;
-            return QVariant::fromValue(value);
-        }
-        case 'I': {
-            qint32 value;
-            in >> value;
-            position += sizeof(qint32);
-            return QVariant::fromValue(value);
-        }
+        case 'Y':
+            return QVariant::fromValue(read<qint16>());
+
+        case 'C':
+            return QVariant::fromValue(*skip(1) != 0);
+
+        case 'I':
+            return QVariant::fromValue(read<qint32>());
+
         case 'F': {
+            quint32 bits = read<quint32>();
             float value;
-            in >> value;
-            position += sizeof(float);
+            memcpy(&value, &bits, sizeof(value));
             return QVariant::fromValue(value);
         }
         case 'D': {
+            quint64 bits = read<quint64>();
             double value;
-            in >> value;
-            position += sizeof(double);
-            return QVariant::fromValue(value);
-        }
-        case 'L': {
-            qint64 value;
-            in >> value;
-            position += sizeof(qint64);
+            memcpy(&value, &bits, sizeof(value));
             return QVariant::fromValue(value);
         }
-        case 'f': {
-            return readBinaryArray<float>(in, position);
-        }
-        case 'd': {
-            return readBinaryArray<double>(in, position);
-        }
-        case 'l': {
-            return readBinaryArray<qint64>(in, position);
-        }
-        case 'i': {
-            return readBinaryArray<qint32>(in, position);
-        }
-        case 'b': {
-            return readBinaryArray<bool>(in, position);
-        }
+        case 'L':
+            return QVariant::fromValue(read<qint64>());
+
+        case 'f':
+            return parseArray<float>();
+
+        case 'd':
+            return parseArray<double>();
+
+        case 'l':
+            return parseArray<qint64>();
+
+        case 'i':
+            return parseArray<qint32>();
+
+        case 'b':
+            return parseArray<bool>();
+
         case 'S':
         case 'R': {
-            quint32 length;
-            in >> length;
-            position += sizeof(quint32) + length;
-            return QVariant::fromValue(in.device()->read(length));
+            quint32 length = read<quint32>();
+            return QVariant::fromValue(QByteArray(skip(length), length));
         }
         default:
             throw QString("Unknown property type: ") + ch;
     }
 }
 
-FBXNode parseBinaryFBXNode(QDataStream& in, int& position, bool has64BitPositions = false) {
+FBXNode BinaryFBXParser::parseNode(bool has64BitPositions) {
     qint64 endOffset;
     quint64 propertyCount;
-    quint64 propertyListLength;
-    quint8 nameLength;
 
     // FBX 2016 and beyond uses 64bit positions in the node headers, pre-2016 used 32bit values
-    // our code generally doesn't care about the size that much, so we will use 64bit values
-    // from here on out, but if the file is an older format we read the stream into temp 32bit 
-    // values and then assign to our actual 64bit values.
     if (has64BitPositions) {
-        in >> endOffset;
-        in >> propertyCount;
-        in >> propertyListLength;
-        position += sizeof(quint64) * 3;
+        endOffset = read<qint64>();
+        propertyCount = read<quint64>();
+        read<quint64>(); // property list length
     } else {
-        qint32 tempEndOffset;
-        quint32 tempPropertyCount;
-        quint32 tempPropertyListLength;
-        in >> tempEndOffset;
-        in >> tempPropertyCount;
-        in >> tempPropertyListLength;
-        position += sizeof(quint32) * 3;
-        endOffset = tempEndOffset;
-        propertyCount = tempPropertyCount;
-        propertyListLength = tempPropertyListLength;
-    }
-    in >> nameLength;
-    position += sizeof(quint8);
+        endOffset = read<qint32>();
+        propertyCount = read<quint32>();
+        read<quint32>(); // property list length
+    }
+    quint8 nameLength = read<quint8>();
 
     FBXNode node;
     const int MIN_VALID_OFFSET = 40;
@@ -205,15 +228,14 @@ FBXNode parseBinaryFBXNode(QDataStream& in, int& position, bool has64BitPosition
         // use a null name to indicate a null node
         return node;
     }
-    node.name = in.device()->read(nameLength);
-    position += nameLength;
+    node.name = QByteArray(skip(nameLength), nameLength);
 
-    for (quint32 i = 0; i < propertyCount; i++) {
-        node.properties.append(parseBinaryFBXProperty(in, position));
+    for (quint64 i = 0; i < propertyCount; i++) {
+        node.properties.append(parseProperty());
     }
 
-    while (endOffset > position) {
-        FBXNode child = parseBinaryFBXNode(in, position, has64BitPositions);
+    while (endOffset > _position) {
+        FBXNode child = parseNode(has64BitPositions);
         if (!child.name.isNull()) {
             node.children.append(child);
         }
@@ -222,6 +244,64 @@ FBXNode parseBinaryFBXNode(QDataStream& in, int& position, bool has64BitPosition
     return node;
 }
 
+FBXNode BinaryFBXParser::parse() {
+    // see http://code.blender.org/index.php/2013/08/fbx-binary-file-format-specification/ for an explanation
+    // of the FBX binary format
+
+    // The first 27 bytes contain the header.
+    //   Bytes 0 - 20: Kaydara FBX Binary  \x00(file - magic, with 2 spaces at the end, then a NULL terminator).
+    //   Bytes 21 - 22: [0x1A, 0x00](unknown but all observed files show these bytes).
+    //   Bytes 23 - 26 : unsigned int, the version number. 7300 for version 7.3 for example.
+    skip(FBX_HEADER_BYTES_BEFORE_VERSION);
+    quint32 fileVersion = read<quint32>();
+    qCDebug(modelformat) << "fileVersion:" << fileVersion;
+    bool has64BitPositions = (fileVersion >= FBX_VERSION_2016);
+
+    // parse the top-level node
+    FBXNode top;
+    while (_position < _size) {
+        FBXNode next = parseNode(has64BitPositions);
+        if (next.name.isNull()) {
+            return top;
+
+        } else {
+            top.children.append(next);
+        }
+    }
+
+    return top;
+}
+
+// Gets the rest of the device's bytes without copying them where possible: files are mapped, and buffers share
+// their data. The array properties parsed from the document keep it alive.
+FBXDataPointer getBinaryFBXDocument(QIODevice* device, qint64& size) {
+    QFile* file = qobject_cast<QFile*>(device);
+    if (file) {
+        auto mappedFile = std::make_shared<QFile>(file->fileName());
+        if (mappedFile->open(QIODevice::ReadOnly)) {
+            qint64 offset = device->pos();
+            size = mappedFile->size() - offset;
+            const char* mapped = (const char*)mappedFile->map(offset, size);
+            if (mapped) {
+                device->seek(device->size());
+                return FBXDataPointer(mapped, [mappedFile](const char*) { });
+            }
+        }
+    }
+
+    QByteArray data;
+    QBuffer* buffer = qobject_cast<QBuffer*>(device);
+    if (buffer) {
+        data = buffer->data();
+        data.remove(0, device->pos());
+        device->seek(device->size());
+    } else {
+        data = device->readAll();
+    }
+    size = data.size();
+    return FBXDataPointer(data.constData(), [data](const char*) { });
+}
+
 class Tokenizer {
 public:
 
@@ -363,38 +443,11 @@ FBXNode FBXSerializer::parseFBX(QIODevice* device) {
         }
         return top;
     }
-    QDataStream in(device);
-    in.setByteOrder(QDataStream::LittleEndian);
-    in.setVersion(QDataStream::Qt_4_5); // for single/double precision switch
-
-    // see http://code.blender.org/index.php/2013/08/fbx-binary-file-format-specification/ for an explanation
-    // of the FBX binary format
-
-    // The first 27 bytes contain the header.
-    //   Bytes 0 - 20: Kaydara FBX Binary  \x00(file - magic, with 2 spaces at the end, then a NULL terminator).
-    //   Bytes 21 - 22: [0x1A, 0x00](unknown but all observed files show these bytes).
-    //   Bytes 23 - 26 : unsigned int, the version number. 7300 for version 7.3 for example.
-    in.skipRawData(FBX_HEADER_BYTES_BEFORE_VERSION);
-    int position = FBX_HEADER_BYTES_BEFORE_VERSION;
-    quint32 fileVersion;
-    in >> fileVersion;
-    position += sizeof(fileVersion);
-    qCDebug(modelformat) << "fileVersion:" << fileVersion;
-    bool has64BitPositions = (fileVersion >= FBX_VERSION_2016);
-
-    // parse the top-level node
-    FBXNode top;
-    while (device->bytesAvailable()) {
-        FBXNode next = parseBinaryFBXNode(in, position, has64BitPositions);
-        if (next.name.isNull()) {
-            return top;
-
-        } else {
-            top.children.append(next);
-        }
-    }
+    registerArrayPropertyConverters();
 
-    return top;
+    qint64 size = 0;
+    FBXDataPointer document = getBinaryFBXDocument(device, size);
+    return BinaryFBXParser(document, size).parse();
 }
 
 
@@ -470,7 +523,7 @@ QVector<int> FBXSerializer::getIntVector(const FBXNode& node) {
     if (node.properties.isEmpty()) {
         return QVector<int>();
     }
-    QVector<int> vector = node.properties.at(0).value<QVector<int> >();
+    QVector<int> vector = getArrayPropertyValues<int>(node.properties.at(0));
     if (!vector.isEmpty()) {
         return vector;
     }
@@ -489,7 +542,7 @@ QVector<float> FBXSerializer::getFloatVector(const FBXNode& node) {
     if (node.properties.isEmpty()) {
         return QVector<float>();
     }
-    QVector<float> vector = node.properties.at(0).value<QVector<float> >();
+    QVector<float> vector = getArrayPropertyValues<float>(node.properties.at(0));
     if (!vector.isEmpty()) {
         return vector;
     }
@@ -508,7 +561,7 @@ QVector<double> FBXSerializer::getDoubleVector(const FBXNode& node) {
     if (node.properties.isEmpty()) {
         return QVector<double>();
     }
-    QVector<double> vector = node.properties.at(0).value<QVector<double> >();
+    QVector<double> vector = getArrayPropertyValues<double>(node.properties.at(0));
     if (!vector.isEmpty()) {
         return vector;
     }
@@ -11,9 +11,12 @@
 
 #include "GLTFSerializer.h"
 
+#include <limits>
+
 #include <QtCore/QBuffer>
 #include <QtCore/QIODevice>
 #include <QtCore/QEventLoop>
+#include <QtCore/QtEndian>
 #include <QtCore/qjsondocument.h>
 #include <QtCore/qjsonobject.h>
 #include <QtCore/qjsonarray.h>
@@ -21,7 +24,6 @@
 #include <QtCore/qpair.h>
 #include <QtCore/qlist.h>
 
-
 #include <QtNetwork/QNetworkAccessManager>
 #include <QtNetwork/QNetworkRequest>
 
@@ -36,6 +38,116 @@
 
 #include "FBXSerializer.h"
 
+namespace {
+
+const int GLB_HEADER_SIZE = 12;
+const int GLB_CHUNK_HEADER_SIZE = 8;
+const quint32 GLB_CHUNK_TYPE_JSON = 0x4E4F534A; // "JSON"
+const quint32 GLB_CHUNK_TYPE_BIN = 0x004E4942; // "BIN\0"
+
+int getComponentSize(int componentType) {
+    switch (componentType) {
+        case GLTFAccessorComponentType::BYTE:
+        case GLTFAccessorComponentType::UNSIGNED_BYTE:
+            return 1;
+        case GLTFAccessorComponentType::SHORT:
+        case GLTFAccessorComponentType::UNSIGNED_SHORT:
+            return 2;
+        case GLTFAccessorComponentType::UNSIGNED_INT:
+        case GLTFAccessorComponentType::FLOAT:
+            return 4;
+        default:
+            return 0;
+    }
+}
+
+int getNumComponents(int accessorType) {
+    switch (accessorType) {
+        case GLTFAccessorType::SCALAR:
+            return 1;
+        case GLTFAccessorType::VEC2:
+            return 2;
+        case GLTFAccessorType::VEC3:
+            return 3;
+        case GLTFAccessorType::VEC4:
+        case GLTFAccessorType::MAT2:
+            return 4;
+        case GLTFAccessorType::MAT3:
+            return 9;
+        case GLTFAccessorType::MAT4:
+            return 16;
+        default:
+            return 0;
+    }
+}
+
+template<typename T>
+T readComponent(const char* data) {
+    return qFromLittleEndian<T>(data);
+}
+
+template<>
+float readComponent<float>(const char* data) {
+    quint32 bits = qFromLittleEndian<quint32>(data);
+    float value;
+    memcpy(&value, &bits, sizeof(float));
+    return value;
+}
+
+// integer components of normalized accessors map to [0, 1] or [-1, 1]
+float normalizeComponent(qint8 value) { return std::max(value / 127.0f, -1.0f); }
+float normalizeComponent(quint8 value) { return value / 255.0f; }
+float normalizeComponent(qint16 value) { return std::max(value / 32767.0f, -1.0f); }
+float normalizeComponent(quint16 value) { return value / 65535.0f; }
+float normalizeComponent(quint32 value) { return (float)value; }
+float normalizeComponent(float value) { return value; }
+
+template<typename T>
+void readFloatComponents(const char* data, int count, int stride, int numComponents, bool normalized, float* outarray) {
+    for (int i = 0; i < count; i++, data += stride) {
+        for (int j = 0; j < numComponents; j++) {
+            T value = readComponent<T>(data + j * sizeof(T));
+            *outarray++ = normalized ? normalizeComponent(value) : (float)value;
+        }
+    }
+}
+
+#if Q_BYTE_ORDER == Q_LITTLE_ENDIAN
+template<>
+void readFloatComponents<float>(const char* data, int count, int stride, int numComponents, bool /*normalized*/, float* outarray) {
+    int size = numComponents * (int)sizeof(float);
+    if (stride == size) {
+        memcpy(outarray, data, (size_t)count * size);
+        return;
+    }
+    for (int i = 0; i < count; i++, data += stride, outarray += numComponents) {
+        memcpy(outarray, data, size);
+    }
+}
+#endif
+
+template<typename T>
+void readIndexComponents(const char* data, int count, int stride, int* outarray) {
+    for (int i = 0; i < count; i++, data += stride) {
+        *outarray++ = (int)readComponent<T>(data);
+    }
+}
+
+#if Q_BYTE_ORDER == Q_LITTLE_ENDIAN
+template<>
+void readIndexComponents<quint32>(const char* data, int count, int stride, int* outarray) {
+    if (stride == (int)sizeof(quint32)) {
+        memcpy(outarray, data, (size_t)count * sizeof(quint32));
+        return;
+    }
+    for (int i = 0; i < count; i++, data += stride) {
+        memcpy(outarray++, data, sizeof(quint32));
+    }
+}
+#endif
+
+}
+
 bool GLTFSerializer::getStringVal(const QJsonObject& object, const QString& fieldname,
                               QString& value, QMap<QString, bool>&  defined) {
     bool _defined = (object.contains(fieldname) && object[fieldname].isString());
@@ -126,26 +238,29 @@ bool GLTFSerializer::getObjectArrayVal(const QJsonObject& object, const QString&
 }
 
 QByteArray GLTFSerializer::setGLBChunks(const QByteArray& data) {
-    int byte = 4; 
-    int jsonStart = data.indexOf("JSON", Qt::CaseSensitive);
-    int binStart = data.indexOf("BIN", Qt::CaseSensitive);
-    int jsonLength, binLength;
-    QByteArray jsonLengthChunk, binLengthChunk;
-
-    jsonLengthChunk = data.mid(jsonStart - byte, byte);
-    QDataStream tempJsonLen(jsonLengthChunk);
-    tempJsonLen.setByteOrder(QDataStream::LittleEndian);
-    tempJsonLen >> jsonLength;
-    QByteArray jsonChunk = data.mid(jsonStart + byte, jsonLength);
-
-    if (binStart != -1) {
-        binLengthChunk = data.mid(binStart - byte, byte);
-
-        QDataStream tempBinLen(binLengthChunk);
-        tempBinLen.setByteOrder(QDataStream::LittleEndian);
-        tempBinLen >> binLength;
-
-        _glbBinary = data.mid(binStart + byte, binLength);
+    // the chunks are read in place, sharing the data keeps them alive
+    _glbData = data;
+    if (_glbData.size() < GLB_HEADER_SIZE) {
+        return QByteArray();
+    }
+
+    const char* glb = _glbData.constData();
+    int length = (int)std::min<quint32>(qFromLittleEndian<quint32>(glb + 8), (quint32)_glbData.size());
+    QByteArray jsonChunk;
+    for (int offset = GLB_HEADER_SIZE; offset + GLB_CHUNK_HEADER_SIZE <= length; ) {
+        quint32 chunkLength = qFromLittleEndian<quint32>(glb + offset);
+        quint32 chunkType = qFromLittleEndian<quint32>(glb + offset + 4);
+        offset += GLB_CHUNK_HEADER_SIZE;
+        if (chunkLength > (quint32)(length - offset)) {
+            qWarning(modelformat) << "Truncated GLB chunk in" << _url;
+            break;
+        }
+        if (chunkType == GLB_CHUNK_TYPE_JSON && jsonChunk.isNull()) {
+            jsonChunk = QByteArray::fromRawData(glb + offset, chunkLength);
+        } else if (chunkType == GLB_CHUNK_TYPE_BIN && _glbBinary.isNull()) {
+            _glbBinary = QByteArray::fromRawData(glb + offset, chunkLength);
+        }
+        offset += chunkLength;
     }
     return jsonChunk;
 }
@@ -324,6 +439,7 @@ bool GLTFSerializer::addBufferView(const QJsonObject& object) {
     getIntVal(object, "buffer", bufferview.buffer, bufferview.defined);
     getIntVal(object, "byteLength", bufferview.byteLength, bufferview.defined);
     getIntVal(object, "byteOffset", bufferview.byteOffset, bufferview.defined);
+    getIntVal(object, "byteStride", bufferview.byteStride, bufferview.defined);
     getIntVal(object, "target", bufferview.target, bufferview.defined);
     
     _file.bufferviews.push_back(bufferview);
@@ -572,10 +688,11 @@ bool GLTFSerializer::parseGLTF(const QByteArray& data) {
 
     QByteArray jsonChunk = data;
 
-    if (_url.toString().endsWith("glb") && data.indexOf("glTF") == 0 && data.contains("JSON")) {
+    if (_url.toString().endsWith("glb") && data.startsWith("glTF")) {
         jsonChunk = setGLBChunks(data);
     }    
    
+    // parsed in place, the chunk of a GLB isn't copied
     QJsonDocument d = QJsonDocument::fromJson(jsonChunk);
     QJsonObject jsFile = d.object();
 
@@ -815,22 +932,7 @@ bool GLTFSerializer::buildGeometry(HFMModel& hfmModel, const QUrl& url) {
 
                 int indicesAccessorIdx = primitive.indices;
 
-                GLTFAccessor& indicesAccessor = _file.accessors[indicesAccessorIdx];
-                GLTFBufferView& indicesBufferview = _file.bufferviews[indicesAccessor.bufferView];
-                GLTFBuffer& indicesBuffer = _file.buffers[indicesBufferview.buffer];
-
-                int indicesAccBoffset = indicesAccessor.defined["byteOffset"] ? indicesAccessor.byteOffset : 0;
-
-                QVector<int> raw_indices;
-                QVector<glm::vec3> raw_vertices;
-                QVector<glm::vec3> raw_normals;
-
-                bool success = addArrayOfType(indicesBuffer.blob, 
-                    indicesBufferview.byteOffset + indicesAccBoffset, 
-                    indicesAccessor.count, 
-                    part.triangleIndices, 
-                    indicesAccessor.type, 
-                    indicesAccessor.componentType);
+                bool success = readIndexAccessor(indicesAccessorIdx, part.triangleIndices);
 
                 if (!success) {
                     qWarning(modelformat) << "There was a problem reading glTF INDICES data for model " << _url;
@@ -842,103 +944,54 @@ bool GLTFSerializer::buildGeometry(HFMModel& hfmModel, const QUrl& url) {
                 foreach(auto &key, keys) {
                     int accessorIdx = primitive.attributes.values[key];
 
-                    GLTFAccessor& accessor = _file.accessors[accessorIdx];
-                    GLTFBufferView& bufferview = _file.bufferviews[accessor.bufferView];
-                    GLTFBuffer& buffer = _file.buffers[bufferview.buffer];
-
-                    int accBoffset = accessor.defined["byteOffset"] ? accessor.byteOffset : 0;
                     if (key == "POSITION") {
-                        QVector<float> vertices;
-                        success = addArrayOfType(buffer.blob, 
-                            bufferview.byteOffset + accBoffset, 
-                            accessor.count, vertices, 
-                            accessor.type, 
-                            accessor.componentType);
+                        success = readFloatAccessor(accessorIdx, mesh.vertices);
                         if (!success) {
                             qWarning(modelformat) << "There was a problem reading glTF POSITION data for model " << _url;
                             continue;
                         }
-                        for (int n = 0; n < vertices.size(); n = n + 3) {
-                            mesh.vertices.push_back(glm::vec3(vertices[n], vertices[n + 1], vertices[n + 2]));
-                        }
                     } else if (key == "NORMAL") {
-                        QVector<float> normals;
-                        success = addArrayOfType(buffer.blob, 
-                            bufferview.byteOffset + accBoffset, 
-                            accessor.count, 
-                            normals, 
-                            accessor.type, 
-                            accessor.componentType);
+                        success = readFloatAccessor(accessorIdx, mesh.normals);
                         if (!success) {
                             qWarning(modelformat) << "There was a problem reading glTF NORMAL data for model " << _url;
                             continue;
                         }
-                        for (int n = 0; n < normals.size(); n = n + 3) {
-                            mesh.normals.push_back(glm::vec3(normals[n], normals[n + 1], normals[n + 2]));
-                        }
                     } else if (key == "COLOR_0") {
-                        QVector<float> colors;
-                        success = addArrayOfType(buffer.blob, 
-                            bufferview.byteOffset + accBoffset, 
-                            accessor.count, 
-                            colors,
-                            accessor.type, 
-                            accessor.componentType);
+                        // the alpha of VEC4 colors is skipped
+                        success = readFloatAccessor(accessorIdx, mesh.colors);
                         if (!success) {
                             qWarning(modelformat) << "There was a problem reading glTF COLOR_0 data for model " << _url;
                             continue;
                         }
-                        int stride = (accessor.type == GLTFAccessorType::VEC4) ? 4 : 3;
-                        for (int n = 0; n < colors.size() - 3; n += stride) {
-                            mesh.colors.push_back(glm::vec3(colors[n], colors[n + 1], colors[n + 2]));
-                        }
                     } else if (key == "TANGENT") {
-                        QVector<float> tangents;
-                        success = addArrayOfType(buffer.blob, 
-                            bufferview.byteOffset + accBoffset, 
-                            accessor.count, 
-                            tangents,
-                            accessor.type, 
-                            accessor.componentType);
+                        QVector<glm::vec4> tangents;
+                        success = readFloatAccessor(accessorIdx, tangents);
+                        if (success) {
+                            mesh.tangents.resize(tangents.size());
+                            for (int n = 0; n < tangents.size(); n++) {
+                                const glm::vec4& tangent = tangents[n];
+                                mesh.tangents[n] = glm::vec3(tangent.w * tangent.x, tangent.y, tangent.z);
+                            }
+                        } else {
+                            // VEC3 tangents have no w
+                            success = readFloatAccessor(accessorIdx, mesh.tangents);
+                        }
                         if (!success) {
                             qWarning(modelformat) << "There was a problem reading glTF TANGENT data for model " << _url;
                             continue;
                         }
-                        int stride = (accessor.type == GLTFAccessorType::VEC4) ? 4 : 3;
-                        for (int n = 0; n < tangents.size() - 3; n += stride) {
-                            float tanW = stride == 4 ? tangents[n + 3] : 1; 
-                            mesh.tangents.push_back(glm::vec3(tanW * tangents[n], tangents[n + 1], tangents[n + 2]));
-                        }
                     } else if (key == "TEXCOORD_0") {
-                        QVector<float> texcoords;
-                        success = addArrayOfType(buffer.blob, 
-                            bufferview.byteOffset + accBoffset, 
-                            accessor.count, 
-                            texcoords, 
-                            accessor.type, 
-                            accessor.componentType);
+                        success = readFloatAccessor(accessorIdx, mesh.texCoords);
                         if (!success) {
                             qWarning(modelformat) << "There was a problem reading glTF TEXCOORD_0 data for model " << _url;
                             continue;
                         }
-                        for (int n = 0; n < texcoords.size(); n = n + 2) {
-                            mesh.texCoords.push_back(glm::vec2(texcoords[n], texcoords[n + 1]));
-                        }
                     } else if (key == "TEXCOORD_1") {
-                        QVector<float> texcoords;
-                        success = addArrayOfType(buffer.blob, 
-                            bufferview.byteOffset + accBoffset, 
-                            accessor.count, 
-                            texcoords, 
-                            accessor.type, 
-                            accessor.componentType);
+                        success = readFloatAccessor(accessorIdx, mesh.texCoords1);
                         if (!success) {
                             qWarning(modelformat) << "There was a problem reading glTF TEXCOORD_1 data for model " << _url;
                             continue;
                         }
-                        for (int n = 0; n < texcoords.size(); n = n + 2) {
-                            mesh.texCoords1.push_back(glm::vec2(texcoords[n], texcoords[n + 1]));
-                        }
                     }
 
                 }
@@ -1027,12 +1080,38 @@ bool GLTFSerializer::readBinary(const QString& url, QByteArray& outdata) {
         success = !outdata.isEmpty();
     } else {
         QUrl binaryUrl = _url.resolved(url);
-        std::tie<bool, QByteArray>(success, outdata) = requestData(binaryUrl);
+        success = mapBinary(binaryUrl, outdata);
+        if (!success) {
+            std::tie<bool, QByteArray>(success, outdata) = requestData(binaryUrl);
+        }
     }
     
     return success;
 }
 
+bool GLTFSerializer::mapBinary(const QUrl& url, QByteArray& outdata) {
+    // local files are normalized to absolute paths, which can parse as a drive letter scheme on Windows
+    if (!url.isLocalFile() && url.scheme().size() > 1) {
+        return false;
+    }
+    QString filename = url.isLocalFile() ? url.toLocalFile() : url.toString();
+    if (!QFileInfo(filename).isFile()) {
+        return false;
+    }
+
+    auto file = std::make_shared<QFile>(filename);
+    if (!file->open(QIODevice::ReadOnly) || file->size() == 0 || file->size() > std::numeric_limits<int>::max()) {
+        return false;
+    }
+    const char* mapped = (const char*)file->map(0, file->size());
+    if (!mapped) {
+        return false;
+    }
+    _mappedFiles.push_back(file);
+    outdata = QByteArray::fromRawData(mapped, (int)file->size());
+    return true;
+}
+
 bool GLTFSerializer::doesResourceExist(const QString& url) {
     if (_url.isEmpty()) {
         return false;
@@ -1111,7 +1190,8 @@ HFMTexture GLTFSerializer::getHFMTexture(const GLTFTexture& texture) {
             int offset = imagesBufferview.byteOffset;
             int length = imagesBufferview.byteLength;
 
-            fbxtex.content = _glbBinary.mid(offset, length);
+            // copied, the texture outlives the GLB data
+            fbxtex.content = QByteArray(_glbBinary.constData() + offset, length);
             fbxtex.filename = textureUrl.toEncoded().append(texture.source);
         }
 
@@ -1186,86 +1266,111 @@ void GLTFSerializer::setHFMMaterial(HFMMaterial& fbxmat, const GLTFMaterial& mat
 
 }
 
-template<typename T, typename L>
-bool GLTFSerializer::readArray(const QByteArray& bin, int byteOffset, int count,
-                           QVector<L>& outarray, int accessorType) {
-    
-    QDataStream blobstream(bin);
-    blobstream.setByteOrder(QDataStream::LittleEndian);
-    blobstream.setVersion(QDataStream::Qt_5_9);
-    blobstream.setFloatingPointPrecision(QDataStream::FloatingPointPrecision::SinglePrecision);
-
-    qCDebug(modelformat) << "size1: " << count;
-    int dataskipped = blobstream.skipRawData(byteOffset);
-    qCDebug(modelformat) << "dataskipped: " << dataskipped;
+bool GLTFSerializer::getAccessorData(int accessorIndex, GLTFAccessorData& accessorData) {
+    if (accessorIndex < 0 || accessorIndex >= _file.accessors.size()) {
+        return false;
+    }
+    const GLTFAccessor& accessor = _file.accessors[accessorIndex];
+    if (accessor.bufferView < 0 || accessor.bufferView >= _file.bufferviews.size()) {
+        return false;
+    }
+    const GLTFBufferView& bufferview = _file.bufferviews[accessor.bufferView];
+    if (bufferview.buffer < 0 || bufferview.buffer >= _file.buffers.size()) {
+        return false;
+    }
+    const GLTFBuffer& buffer = _file.buffers[bufferview.buffer];
 
-    int bufferCount = 0;
-    switch (accessorType) {
-    case GLTFAccessorType::SCALAR:
-        bufferCount = 1;
-        break;
-    case GLTFAccessorType::VEC2:
-        bufferCount = 2;
-        break;
-    case GLTFAccessorType::VEC3:
-        bufferCount = 3;
-        break;
-    case GLTFAccessorType::VEC4:
-        bufferCount = 4;
-        break;
-    case GLTFAccessorType::MAT2:
-        bufferCount = 4;
-        break;
-    case GLTFAccessorType::MAT3:
-        bufferCount = 9;
-        break;
-    case GLTFAccessorType::MAT4:
-        bufferCount = 16;
-        break;
-    default:
-        qWarning(modelformat) << "Unknown accessorType: " << accessorType;
-        blobstream.unsetDevice();
+    int componentSize = getComponentSize(accessor.componentType);
+    int numComponents = getNumComponents(accessor.type);
+    if (componentSize == 0 || numComponents == 0) {
+        qWarning(modelformat) << "Unknown accessor type: " << accessor.type << accessor.componentType;
         return false;
     }
-    for (int i = 0; i < count; i++) {
-        for (int j = 0; j < bufferCount; j++) {
-            if (!blobstream.atEnd()) {
-                T value;
-                blobstream >> value;
-                outarray.push_back(value);
-            } else {
-                blobstream.unsetDevice();
-                return false;
-            }
-        }
+    int elementSize = componentSize * numComponents;
+    int stride = (bufferview.byteStride > 0) ? bufferview.byteStride : elementSize;
+
+    qint64 offset = (qint64)bufferview.byteOffset + accessor.byteOffset;
+    qint64 end = (accessor.count > 0) ? offset + (qint64)stride * (accessor.count - 1) + elementSize : offset;
+    if (accessor.count < 0 || offset < 0 || end > buffer.blob.size()) {
+        return false;
     }
 
-    blobstream.unsetDevice();
+    accessorData.data = buffer.blob.constData() + offset;
+    accessorData.count = accessor.count;
+    accessorData.stride = stride;
+    accessorData.numComponents = numComponents;
+    accessorData.componentType = accessor.componentType;
+    accessorData.normalized = accessor.normalized;
     return true;
 }
+
 template<typename T>
-bool GLTFSerializer::addArrayOfType(const QByteArray& bin, int byteOffset, int count,
-                                QVector<T>& outarray, int accessorType, int componentType) {
-    
-    switch (componentType) {
-    case GLTFAccessorComponentType::BYTE: {}
-    case GLTFAccessorComponentType::UNSIGNED_BYTE: {
-        return readArray<uchar>(bin, byteOffset, count, outarray, accessorType);
-    }
-    case GLTFAccessorComponentType::SHORT: {
-        return readArray<short>(bin, byteOffset, count, outarray, accessorType);
-    }
-    case GLTFAccessorComponentType::UNSIGNED_INT: {
-        return readArray<uint>(bin, byteOffset, count, outarray, accessorType);
+bool GLTFSerializer::readFloatAccessor(int accessorIndex, QVector<T>& outarray) {
+    const int numComponents = (int)(sizeof(T) / sizeof(float));
+    GLTFAccessorData accessorData;
+    if (!getAccessorData(accessorIndex, accessorData) || accessorData.numComponents < numComponents) {
+        return false;
     }
-    case GLTFAccessorComponentType::UNSIGNED_SHORT: {
-        return readArray<ushort>(bin, byteOffset, count, outarray, accessorType);
+
+    outarray.resize(accessorData.count);
+    float* out = (float*)outarray.data();
+    const char* data = accessorData.data;
+    int count = accessorData.count;
+    int stride = accessorData.stride;
+    bool normalized = accessorData.normalized;
+    switch (accessorData.componentType) {
+        case GLTFAccessorComponentType::BYTE:
+            readFloatComponents<qint8>(data, count, stride, numComponents, normalized, out);
+            break;
+        case GLTFAccessorComponentType::UNSIGNED_BYTE:
+            readFloatComponents<quint8>(data, count, stride, numComponents, normalized, out);
+            break;
+        case GLTFAccessorComponentType::SHORT:
+            readFloatComponents<qint16>(data, count, stride, numComponents, normalized, out);
+            break;
+        case GLTFAccessorComponentType::UNSIGNED_SHORT:
+            readFloatComponents<quint16>(data, count, stride, numComponents, normalized, out);
+            break;
+        case GLTFAccessorComponentType::UNSIGNED_INT:
+            readFloatComponents<quint32>(data, count, stride, numComponents, normalized, out);
+            break;
+        case GLTFAccessorComponentType::FLOAT:
+            readFloatComponents<float>(data, count, stride, numComponents, false, out);
+            break;
     }
-    case GLTFAccessorComponentType::FLOAT: {
-        return readArray<float>(bin, byteOffset, count, outarray, accessorType);
+    return true;
+}
+
+bool GLTFSerializer::readIndexAccessor(int accessorIndex, QVector<int>& outarray) {
+    GLTFAccessorData accessorData;
+    if (!getAccessorData(accessorIndex, accessorData)) {
+        return false;
     }
+
+    outarray.resize(accessorData.count);
+    int* out = outarray.data();
+    const char* data = accessorData.data;
+    int count = accessorData.count;
+    int stride = accessorData.stride;
+    switch (accessorData.componentType) {
+        case GLTFAccessorComponentType::BYTE:
+        case GLTFAccessorComponentType::UNSIGNED_BYTE:
+            readIndexComponents<quint8>(data, count, stride, out);
+            break;
+        case GLTFAccessorComponentType::SHORT:
+            readIndexComponents<qint16>(data, count, stride, out);
+            break;
+        case GLTFAccessorComponentType::UNSIGNED_SHORT:
+            readIndexComponents<quint16>(data, count, stride, out);
+            break;
+        case GLTFAccessorComponentType::UNSIGNED_INT:
+            readIndexComponents<quint32>(data, count, stride, out);
+            break;
+        case GLTFAccessorComponentType::FLOAT:
+            readIndexComponents<float>(data, count, stride, out);
+            break;
     }
-    return false;
+    return true;
 }
 
 void GLTFSerializer::retriangulate(const QVector<int>& inIndices, const QVector<glm::vec3>& in_vertices,
@@ -13,6 +13,10 @@
 #define hifi_GLTFSerializer_h
 
 #include <memory.h>
+#include <memory>
+#include <vector>
+
+#include <QtCore/QFile>
 #include <QtNetwork/QNetworkReply>
 #include <hfm/ModelFormatLogging.h>
 #include <hfm/HFMSerializer.h>
@@ -191,6 +195,7 @@ struct GLTFBufferView {
     int buffer; //required
     int byteLength; //required
     int byteOffset { 0 };
+    int byteStride { 0 }; // 0 when the elements are tightly packed
     int target;
     QMap<QString, bool> defined;
     void dump() {
@@ -203,6 +208,9 @@ struct GLTFBufferView {
         if (defined["byteOffset"]) {
             qCDebug(modelformat) << "byteOffset: " << byteOffset;
         }
+        if (defined["byteStride"]) {
+            qCDebug(modelformat) << "byteStride: " << byteStride;
+        }
         if (defined["target"]) {
             qCDebug(modelformat) << "target: " << target;
         }
@@ -214,7 +222,7 @@ struct GLTFBufferView {
 struct GLTFBuffer {
     int byteLength; //required
     QString uri;
-    QByteArray blob;
+    QByteArray blob; // may refer to the GLB data or a mapped file, which the GLTFSerializer keeps alive
     QMap<QString, bool> defined;
     void dump() {
         if (defined["byteLength"]) {
@@ -707,6 +715,18 @@ public:
 
     HFMModel::Pointer read(const QByteArray& data, const QVariantHash& mapping, const QUrl& url = QUrl()) override;
 private:
+    // The elements of an accessor, where they are in their buffer.
+    struct GLTFAccessorData {
+        const char* data;
+        int count;
+        int stride;
+        int numComponents;
+        int componentType;
+        bool normalized;
+    };
+
+    QByteArray _glbData; // shares the data read() was given, which _glbBinary and the buffers refer to
+    std::vector<std::shared_ptr<QFile>> _mappedFiles;
     GLTFFile _file;
     QUrl _url;
     QByteArray _glbBinary;
@@ -761,14 +781,13 @@ private:
     bool addTexture(const QJsonObject& object);
 
     bool readBinary(const QString& url, QByteArray& outdata);
+    bool mapBinary(const QUrl& url, QByteArray& outdata);
 
-    template<typename T, typename L>
-    bool readArray(const QByteArray& bin, int byteOffset, int count, 
-                   QVector<L>& outarray, int accessorType);
-    
+    bool getAccessorData(int accessorIndex, GLTFAccessorData& accessorData);
+    // reads as many float components of each element as T has, normalized if the accessor says so
     template<typename T>
-    bool addArrayOfType(const QByteArray& bin, int byteOffset, int count, 
-                        QVector<T>& outarray, int accessorType, int componentType);
+    bool readFloatAccessor(int accessorIndex, QVector<T>& outarray);
+    bool readIndexAccessor(int accessorIndex, QVector<int>& outarray);
 
     void retriangulate(const QVector<int>& in_indices, const QVector<glm::vec3>& in_vertices, 
                        const QVector<glm::vec3>& in_normals, QVector<int>& out_indices, 
@@ -15,6 +15,8 @@
 #include "OBJSerializer.h"
 
 #include <ctype.h>  // .obj files are not locale-specific. The C/ASCII charset applies.
+#include <cmath>
+#include <limits>
 #include <sstream> 
 
 #include <QtCore/QBuffer>
@@ -26,6 +28,7 @@
 #include <shared/NsightHelpers.h>
 #include <NetworkAccessManager.h>
 #include <ResourceManager.h>
+#include <TBBHelpers.h>
 
 #include "FBXSerializer.h"
 #include <hfm/ModelFormatLogging.h>
@@ -45,10 +48,209 @@ namespace {
 template<class T>
 T& checked_at(QVector<T>& vector, int i) {
     if (i < 0 || i >= vector.size()) {
-        throw std::out_of_range("index " + std::to_string(i) + "is out of range");
+        throw std::out_of_range("index " + std::to_string(i) + " is out of range");
     }
     return vector[i];
 }
+
+int checkedCornerIndex(const std::vector<int>& indices, int first, int count, int corner) {
+    if (corner >= count) {
+        throw std::out_of_range("face corner " + std::to_string(corner) + " is out of range");
+    }
+    return indices[first + corner];
+}
+
+// QChar::isSpace() of the Latin-1 characters the OBJTokenizer reads
+inline bool isSpaceChar(char ch) {
+    unsigned char c = (unsigned char)ch;
+    return c == ' ' || (c >= '\t' && c <= '\r') || c == 0x85 || c == 0xa0;
+}
+
+inline bool isDigitChar(char ch) {
+    return ch >= '0' && ch <= '9';
+}
+
+inline bool isLetterChar(char ch) {
+    return (ch >= 'a' && ch <= 'z') || (ch >= 'A' && ch <= 'Z');
+}
+
+const char* findLineEnd(const char* position, const char* end) {
+    const char* newline = (const char*)memchr(position, '\n', end - position);
+    return newline ? newline + 1 : end;
+}
+
+const int MAX_EXACT_POWER_OF_TEN = 22;
+const double POWERS_OF_TEN[MAX_EXACT_POWER_OF_TEN + 1] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+// Parses a plain decimal float to the nearest float, as std::stof() does in the C locale. Only the forms that
+// QByteArray::toFloat() accepts too are parsed, and only when the result is sure to be exact, otherwise this answers
+// false and leaves the token to those.
+bool parseFloat(const char* begin, const char* end, float& value) {
+    const uint64_t MAX_EXACT_MANTISSA = (uint64_t)1 << 53;
+    const int MAX_EXPONENT_DIGITS_VALUE = 10000;
+
+    const char* p = begin;
+    bool negative = (p < end && *p == '-');
+    if (negative) {
+        p++;
+    }
+    if (p == end || !isDigitChar(*p) || (*p == '0' && p + 1 < end && isDigitChar(p[1]))) {
+        return false;
+    }
+
+    uint64_t mantissa = 0;
+    int exponent = 0;
+    for (; p < end && isDigitChar(*p); p++) {
+        if (mantissa >= MAX_EXACT_MANTISSA) {
+            return false;
+        }
+        mantissa = mantissa * 10 + (*p - '0');
+    }
+    if (p < end && *p == '.') {
+        p++;
+        if (p == end || !isDigitChar(*p)) {
+            return false;
+        }
+        for (; p < end && isDigitChar(*p); p++) {
+            if (mantissa >= MAX_EXACT_MANTISSA) {
+                return false;
+            }
+            mantissa = mantissa * 10 + (*p - '0');
+            exponent--;
+        }
+    }
+    if (p < end && (*p == 'e' || *p == 'E')) {
+        p++;
+        bool negativeExponent = false;
+        if (p < end && (*p == '+' || *p == '-')) {
+            negativeExponent = (*p == '-');
+            p++;
+        }
+        if (p == end || !isDigitChar(*p)) {
+            return false;
+        }
+        int exponentValue = 0;
+        for (; p < end && isDigitChar(*p); p++) {
+            if (exponentValue < MAX_EXPONENT_DIGITS_VALUE) {
+                exponentValue = exponentValue * 10 + (*p - '0');
+            }
+        }
+        exponent += negativeExponent ? -exponentValue : exponentValue;
+    }
+    if (p != end) {
+        return false;
+    }
+
+    if (mantissa == 0) {
+        value = negative ? -0.0f : 0.0f;
+        return true;
+    }
+    if (mantissa >= MAX_EXACT_MANTISSA || exponent < -MAX_EXACT_POWER_OF_TEN || exponent > MAX_EXACT_POWER_OF_TEN) {
+        return false;
+    }
+
+    // the mantissa and power of ten are exact doubles, so this rounds once, to the nearest double
+    double nearest = (exponent < 0) ? (double)mantissa / POWERS_OF_TEN[-exponent] : (double)mantissa * POWERS_OF_TEN[exponent];
+    float rounded = (float)nearest;
+    if ((double)rounded != nearest) {
+        // rounding that again to a float is only wrong when it landed exactly halfway between two floats
+        float other = std::nextafter(rounded, (nearest > rounded) ? std::numeric_limits<float>::infinity() :
+            -std::numeric_limits<float>::infinity());
+        if (nearest - (double)rounded == (double)other - nearest) {
+            return false;
+        }
+    }
+    value = negative ? -rounded : rounded;
+    return true;
+}
+
+bool parseIndex(const char* begin, const char* end, int& value) {
+    const char* p = begin;
+    bool negative = false;
+    if (p < end && (*p == '-' || *p == '+')) {
+        negative = (*p == '-');
+        p++;
+    }
+    if (p == end) {
+        return false;
+    }
+    int64_t result = 0;
+    for (; p < end; p++) {
+        if (!isDigitChar(*p)) {
+            return false;
+        }
+        result = result * 10 + (*p - '0');
+        if (result > (int64_t)std::numeric_limits<int>::max() + 1) {
+            return false;
+        }
+    }
+    if (negative) {
+        result = -result;
+    }
+    if (result > std::numeric_limits<int>::max()) {
+        return false;
+    }
+    value = (int)result;
+    return true;
+}
+
+template<class Tokenizer>
+glm::vec3 readVec3(Tokenizer& tokenizer) {
+    auto x = tokenizer.getFloat(); // N.B.: getFloat() has side-effect
+    auto y = tokenizer.getFloat(); // And order of arguments is different on Windows/Linux.
+    auto z = tokenizer.getFloat();
+    auto v = glm::vec3(x, y, z);
+    while (tokenizer.isNextTokenFloat()) {
+        // ignore any following floats
+        tokenizer.nextToken();
+    }
+    return v;
+}
+
+template<class Tokenizer>
+bool readVertex(Tokenizer& tokenizer, glm::vec3& vertex, glm::vec3& vertexColor) {
+    // Used for vertices which may also have a vertex color (RGB [0,1]) to follow.
+    //    NOTE: Returns true if there is a vertex color.
+    auto x = tokenizer.getFloat(); // N.B.: getFloat() has side-effect
+    auto y = tokenizer.getFloat(); // And order of arguments is different on Windows/Linux.
+    auto z = tokenizer.getFloat();
+    vertex = glm::vec3(x, y, z);
+
+    auto r = 1.0f, g = 1.0f, b = 1.0f;
+    bool hasVertexColor = false;
+    if (tokenizer.isNextTokenFloat()) {
+        // If there's another float it's one of two things: a W component or an R component. The standard OBJ spec
+        // doesn't output a W component, so we're making the assumption that if a float follows (unless it's
+        // only a single value) that it's a vertex color.
+        r = tokenizer.getFloat();
+        if (tokenizer.isNextTokenFloat()) {
+            // Safe to assume the following values are the green/blue components.
+            g = tokenizer.getFloat();
+            b = tokenizer.getFloat();
+
+            hasVertexColor = true;
+        }
+
+        vertexColor = glm::vec3(r, g, b);
+    }
+
+    return hasVertexColor;
+}
+
+template<class Tokenizer>
+glm::vec2 readVec2(Tokenizer& tokenizer) {
+    float uCoord = tokenizer.getFloat();
+    float vCoord = 1.0f - tokenizer.getFloat();
+    auto v = glm::vec2(uCoord, vCoord);
+    while (tokenizer.isNextTokenFloat()) {
+        // there can be a w, but we don't handle that
+        tokenizer.nextToken();
+    }
+    return v;
+}
 }
 
 OBJTokenizer::OBJTokenizer(QIODevice* device) : _device(device), _pushedBackToken(-1) {
@@ -125,53 +327,281 @@ bool OBJTokenizer::isNextTokenFloat() {
 }
 
 glm::vec3 OBJTokenizer::getVec3() {
-    auto x = getFloat(); // N.B.: getFloat() has side-effect
-    auto y = getFloat(); // And order of arguments is different on Windows/Linux.
-    auto z = getFloat();
-    auto v = glm::vec3(x, y, z);
-    while (isNextTokenFloat()) {
-        // ignore any following floats
-        nextToken();
-    }
-    return v;
+    return readVec3(*this);
 }
+
 bool OBJTokenizer::getVertex(glm::vec3& vertex, glm::vec3& vertexColor) {
-    // Used for vertices which may also have a vertex color (RGB [0,1]) to follow.
-    //    NOTE: Returns true if there is a vertex color.
-    auto x = getFloat(); // N.B.: getFloat() has side-effect
-    auto y = getFloat(); // And order of arguments is different on Windows/Linux.
-    auto z = getFloat();
-    vertex = glm::vec3(x, y, z);
+    return readVertex(*this, vertex, vertexColor);
+}
 
-    auto r = 1.0f, g = 1.0f, b = 1.0f;
-    bool hasVertexColor = false;
-    if (isNextTokenFloat()) {
-        // If there's another float it's one of two things: a W component or an R component. The standard OBJ spec
-        // doesn't output a W component, so we're making the assumption that if a float follows (unless it's
-        // only a single value) that it's a vertex color.
-        r = getFloat();
-        if (isNextTokenFloat()) {
-            // Safe to assume the following values are the green/blue components.
-            g = getFloat();
-            b = getFloat();
+glm::vec2 OBJTokenizer::getVec2() {
+    return readVec2(*this);
+}
 
-            hasVertexColor = true;
+OBJScanner::OBJScanner(const QByteArray& document, int chunkSize) :
+    _document(document),
+    _end(_document.constData() + _document.size()),
+    _chunkSize(std::max(chunkSize, 1)),
+    _hasQuotes(memchr(_document.constData(), '\"', _document.size()) != nullptr),
+    _scanned(_document.constData()),
+    _position(_document.constData()),
+    _pushedBackToken(OBJTokenizer::NO_PUSHBACKED_TOKEN) {
+}
+
+bool OBJScanner::scanToken(const char* begin, const char* end, Token& token, std::deque<QByteArray>* quotedData) {
+    const char* p = begin;
+    while (p < end) {
+        char ch = *p++;
+        if (isSpaceChar(ch)) {
+            continue; // skip whitespace
+        }
+        switch (ch) {
+            case '#': {
+                // the comment runs to the end of the line, as QIODevice::readLine() reads it
+                const char* lineEnd = findLineEnd(p, end);
+                token.data = p;
+                token.size = (int)(lineEnd - p);
+                token.end = lineEnd;
+                token.type = OBJTokenizer::COMMENT_TOKEN;
+                token.quoted = false;
+                token.floatState = Token::NOT_FLOAT;
+                return true;
+            }
+            case '\"': {
+                QByteArray datum;
+                while (p < end) {
+                    ch = *p++;
+                    if (ch == '\"') { // end on closing quote
+                        break;
+                    }
+                    if (ch == '\\' && p < end) { // handle escaped quotes
+                        ch = *p++;
+                        if (ch != '\"') {
+                            datum.append('\\');
+                        }
+                    }
+                    datum.append(ch);
+                }
+                assert(quotedData);
+                quotedData->push_back(datum);
+                token.data = quotedData->back().constData();
+                token.size = datum.size();
+                token.end = p;
+                token.quoted = true;
+                break;
+            }
+            default: {
+                // read until we encounter a special character
+                const char* datumBegin = p - 1;
+                while (p < end && !isSpaceChar(*p) && *p != '\"') {
+                    p++;
+                }
+                token.data = datumBegin;
+                token.size = (int)(p - datumBegin);
+                token.end = p;
+                token.quoted = false;
+                break;
+            }
         }
 
-        vertexColor = glm::vec3(r, g, b);
+        token.type = OBJTokenizer::DATUM_TOKEN;
+        if (parseFloat(token.data, token.data + token.size, token.value)) {
+            token.floatState = Token::FLOAT;
+        } else if (token.size == 0 || (isLetterChar(token.data[0]) && !strchr("iInN", token.data[0]))) {
+            // nothing else starting with a letter is a float to either QByteArray::toFloat() or std::stof()
+            token.floatState = Token::NOT_FLOAT;
+        } else {
+            token.floatState = Token::UNKNOWN_FLOAT;
+        }
+        return true;
     }
+    return false;
+}
 
-    return hasVertexColor;
+void OBJScanner::scanTokens(const char* begin, const char* end, std::vector<Token>& tokens) {
+    Token token;
+    while (scanToken(begin, end, token)) {
+        tokens.push_back(token);
+        begin = token.end;
+    }
 }
-glm::vec2 OBJTokenizer::getVec2() {
-    float uCoord = getFloat();
-    float vCoord = 1.0f - getFloat();
-    auto v = glm::vec2(uCoord, vCoord);
-    while (isNextTokenFloat()) {
-        // there can be a w, but we don't handle that
-        nextToken();
+
+bool OBJScanner::scanNextBatch() {
+    _tokens.clear();
+    _nextToken = 0;
+    if (_scanned == _end) {
+        return false;
     }
-    return v;
+
+    // split the batch into chunks that end on line boundaries
+    const char* batchEnd = findLineEnd(_scanned + std::min<ptrdiff_t>(_end - _scanned, (ptrdiff_t)_chunkSize * CHUNKS_PER_BATCH), _end);
+    std::vector<const char*> chunkBegins;
+    for (const char* chunkBegin = _scanned; chunkBegin < batchEnd;
+            chunkBegin = findLineEnd(chunkBegin + std::min<ptrdiff_t>(batchEnd - chunkBegin, _chunkSize), batchEnd)) {
+        chunkBegins.push_back(chunkBegin);
+    }
+    chunkBegins.push_back(batchEnd);
+    size_t numChunks = chunkBegins.size() - 1;
+
+    if (numChunks == 1) {
+        scanTokens(chunkBegins[0], chunkBegins[1], _tokens);
+    } else {
+        std::vector<std::vector<Token>> chunkTokens(numChunks);
+        tbb::parallel_for(tbb::blocked_range<size_t>(0, numChunks, 1), [&](const tbb::blocked_range<size_t>& range) {
+            for (auto i = range.begin(); i < range.end(); i++) {
+                scanTokens(chunkBegins[i], chunkBegins[i + 1], chunkTokens[i]);
+            }
+        });
+        size_t numTokens = 0;
+        for (const auto& tokens : chunkTokens) {
+            numTokens += tokens.size();
+        }
+        _tokens.reserve(numTokens);
+        for (const auto& tokens : chunkTokens) {
+            _tokens.insert(_tokens.end(), tokens.begin(), tokens.end());
+        }
+    }
+    _scanned = batchEnd;
+    return true;
+}
+
+bool OBJScanner::nextScannedToken(Token& token) {
+    if (_hasQuotes) {
+        // quotes can span lines, so scan as we go
+        return scanToken(_position, _end, token, &_quotedData);
+    }
+    if (_nextRescannedToken < _rescannedTokens.size()) {
+        token = _rescannedTokens[_nextRescannedToken++];
+        return true;
+    }
+    while (_nextToken == _tokens.size()) {
+        if (!scanNextBatch()) {
+            return false;
+        }
+    }
+    token = _tokens[_nextToken++];
+    return true;
+}
+
+void OBJScanner::resumeScanningAt(const char* position) {
+    if (_hasQuotes) {
+        return;
+    }
+
+    // drop the tokens scanned ahead that start before the position, and rescan any that run past it
+    const char* rescanEnd = position;
+    auto skipTokens = [&](const std::vector<Token>& tokens, size_t& nextToken) {
+        while (nextToken < tokens.size()) {
+            const Token& token = tokens[nextToken];
+            const char* tokenBegin = (token.type == OBJTokenizer::COMMENT_TOKEN) ? token.data - 1 : token.data;
+            if (tokenBegin >= position) {
+                break;
+            }
+            rescanEnd = std::max(rescanEnd, token.end);
+            nextToken++;
+        }
+    };
+    skipTokens(_rescannedTokens, _nextRescannedToken);
+    if (_nextRescannedToken == _rescannedTokens.size()) {
+        skipTokens(_tokens, _nextToken);
+        if (_nextToken == _tokens.size() && position > _scanned) {
+            // nothing was scanned that far ahead yet
+            _scanned = position;
+        }
+    }
+    if (rescanEnd > position) {
+        std::vector<Token> tokens;
+        scanTokens(position, rescanEnd, tokens);
+        tokens.insert(tokens.end(), _rescannedTokens.begin() + _nextRescannedToken, _rescannedTokens.end());
+        _rescannedTokens.swap(tokens);
+        _nextRescannedToken = 0;
+    }
+}
+
+int OBJScanner::nextToken(bool allowSpaceChar /*= false*/) {
+    if (_pushedBackToken != OBJTokenizer::NO_PUSHBACKED_TOKEN) {
+        int token = _pushedBackToken;
+        _pushedBackToken = OBJTokenizer::NO_PUSHBACKED_TOKEN;
+        return token;
+    }
+
+    Token token;
+    if (!nextScannedToken(token)) {
+        return OBJTokenizer::NO_TOKEN;
+    }
+    _position = token.end;
+    if (token.type == OBJTokenizer::COMMENT_TOKEN) {
+        _datum = OBJDatum();
+        _comment = OBJDatum(token.data, token.size);
+        return OBJTokenizer::COMMENT_TOKEN;
+    }
+
+    _datum = OBJDatum(token.data, token.size);
+    _datumFloatState = token.floatState;
+    _datumValue = token.value;
+    if (allowSpaceChar && !token.quoted) {
+        // read on through spaces, until any other whitespace
+        const char* datumEnd = token.end;
+        while (datumEnd < _end && (!isSpaceChar(*datumEnd) || *datumEnd == ' ') && *datumEnd != '\"') {
+            datumEnd++;
+        }
+        if (datumEnd != token.end) {
+            _datum = OBJDatum(token.data, (int)(datumEnd - token.data));
+            _datumFloatState = Token::UNKNOWN_FLOAT;
+            _position = datumEnd;
+            resumeScanningAt(datumEnd);
+        }
+    }
+    return OBJTokenizer::DATUM_TOKEN;
+}
+
+bool OBJScanner::isNextTokenFloat() {
+    if (nextToken() != OBJTokenizer::DATUM_TOKEN) {
+        return false;
+    }
+    pushBackToken(OBJTokenizer::DATUM_TOKEN);
+    switch (_datumFloatState) {
+        case Token::FLOAT:
+            return true;
+        case Token::NOT_FLOAT:
+            return false;
+        default: {
+            bool ok;
+            QByteArray::fromRawData(_datum.constData(), _datum.size()).toFloat(&ok);
+            return ok;
+        }
+    }
+}
+
+void OBJScanner::skipLine() {
+    _position = findLineEnd(_position, _end);
+    resumeScanningAt(_position);
+}
+
+const QString OBJScanner::getComment() const {
+    return QString(QByteArray::fromRawData(_comment.constData(), _comment.size()));
+}
+
+float OBJScanner::getFloat() {
+    if (nextToken() != OBJTokenizer::DATUM_TOKEN) {
+        throw std::invalid_argument("stof");
+    }
+    if (_datumFloatState == Token::FLOAT) {
+        return _datumValue;
+    }
+    return std::stof(std::string(_datum.constData(), _datum.size()));
+}
+
+glm::vec3 OBJScanner::getVec3() {
+    return readVec3(*this);
+}
+
+bool OBJScanner::getVertex(glm::vec3& vertex, glm::vec3& vertexColor) {
+    return readVertex(*this, vertex, vertexColor);
+}
+
+glm::vec2 OBJScanner::getVec2() {
+    return readVec2(*this);
 }
 
 
@@ -179,62 +609,77 @@ void setMeshPartDefaults(HFMMeshPart& meshPart, QString materialID) {
     meshPart.materialID = materialID;
 }
 
-// OBJFace
-//    NOTE (trent, 7/20/17): The vertexColors vector being passed-in isn't necessary here, but I'm just
-//                         pairing it with the vertices vector for consistency.
-bool OBJFace::add(const QByteArray& vertexIndex, const QByteArray& textureIndex, const QByteArray& normalIndex, const QVector<glm::vec3>& vertices, const QVector<glm::vec3>& vertexColors) {
-    bool ok;
-    int index = vertexIndex.toInt(&ok);
-    if (!ok) {
+void OBJFaceGroup::startFace(Face& face, int materialIndex) const {
+    face.firstVertexIndex = (int)vertexIndices.size();
+    face.firstTextureUVIndex = (int)textureUVIndices.size();
+    face.firstNormalIndex = (int)normalIndices.size();
+    face.materialIndex = materialIndex;
+}
+
+bool OBJFaceGroup::addToFace(Face& face, const char* vertexData, int size, int numVertices, int numTextureUVs, int numNormals) {
+    // faces can be:
+    //   vertex-index
+    //   vertex-index/texture-index
+    //   vertex-index/texture-index/surface-normal-index
+    const int MAX_PARTS = 3;
+    int values[MAX_PARTS];
+    bool ok[MAX_PARTS];
+    bool isEmpty[MAX_PARTS];
+    int numParts = 0;
+    const char* end = vertexData + size;
+    for (const char* partBegin = vertexData; numParts < MAX_PARTS; ) {
+        const char* partEnd = (const char*)memchr(partBegin, '/', end - partBegin);
+        if (!partEnd) {
+            partEnd = end;
+        }
+        isEmpty[numParts] = (partEnd == partBegin);
+        ok[numParts] = parseIndex(partBegin, partEnd, values[numParts]);
+        numParts++;
+        if (partEnd == end) {
+            break;
+        }
+        partBegin = partEnd + 1;
+    }
+
+    // If indices are negative relative indices then adjust them to absolute indices based on current vector sizes
+    const int sizes[MAX_PARTS] = { numVertices, numTextureUVs, numNormals };
+    for (int i = 0; i < numParts; i++) {
+        if (ok[i] && values[i] < 0) {
+            values[i] = sizes[i] + values[i] + 1;
+        }
+    }
+
+    if (!ok[0]) {
         return false;
     }
-    vertexIndices.append(index - 1);
-    if (!textureIndex.isEmpty()) {
-        index = textureIndex.toInt(&ok);
-        if (!ok) {
+    vertexIndices.push_back(values[0] - 1);
+    face.numVertexIndices++;
+    if (numParts > 1 && !isEmpty[1]) {
+        if (!ok[1]) {
             return false;
         }
+        int index = values[1];
         if (index < 0) { // Count backwards from the last one added.
-            index = vertices.count() + 1 + index;
+            index = numVertices + 1 + index;
         }
-        textureUVIndices.append(index - 1);
+        textureUVIndices.push_back(index - 1);
+        face.numTextureUVIndices++;
     }
-    if (!normalIndex.isEmpty()) {
-        index = normalIndex.toInt(&ok);
-        if (!ok) {
+    if (numParts > 2 && !isEmpty[2]) {
+        if (!ok[2]) {
             return false;
         }
-        normalIndices.append(index - 1);
+        normalIndices.push_back(values[2] - 1);
+        face.numNormalIndices++;
     }
     return true;
 }
 
-QVector<OBJFace> OBJFace::triangulate() {
-    QVector<OBJFace> newFaces;
+void OBJFaceGroup::addFace(const Face& face) {
     const int nVerticesInATriangle = 3;
-    if (vertexIndices.count() == nVerticesInATriangle) {
-        newFaces.append(*this);
-    } else {
-        for (int i = 1; i < vertexIndices.count() - 1; i++) {
-            OBJFace newFace;
-            newFace.addFrom(this, 0);
-            newFace.addFrom(this, i);
-            newFace.addFrom(this, i + 1);
-            newFace.groupName = groupName;
-            newFace.materialName = materialName;
-            newFaces.append(newFace);
-        }
-    }
-    return newFaces;
-}
-
-void OBJFace::addFrom(const OBJFace* face, int index) { // add using data from f at index i
-    vertexIndices.append(face->vertexIndices[index]);
-    if (face->textureUVIndices.count() > 0) { // Any at all. Runtime error if not consistent.
-        textureUVIndices.append(face->textureUVIndices[index]);
-    }
-    if (face->normalIndices.count() > 0) {
-        normalIndices.append(face->normalIndices[index]);
+    if (face.numVertexIndices >= nVerticesInATriangle) {
+        faces.push_back(face);
+        numTriangles += face.numVertexIndices - (nVerticesInATriangle - 1);
     }
 }
 
@@ -488,16 +933,24 @@ QNetworkReply* request(QUrl& url, bool isTest) {
 }
 
 
-bool OBJSerializer::parseOBJGroup(OBJTokenizer& tokenizer, const QVariantHash& mapping, HFMModel& hfmModel,
+int OBJSerializer::getFaceMaterialIndex() {
+    // faces come in runs of the same material
+    if (faceMaterialNames.isEmpty() || faceMaterialNames.last() != currentMaterialName) {
+        faceMaterialNames.append(currentMaterialName);
+    }
+    return faceMaterialNames.size() - 1;
+}
+
+template<class Tokenizer>
+bool OBJSerializer::parseOBJGroup(Tokenizer& tokenizer, const QVariantHash& mapping, HFMModel& hfmModel,
                               float& scaleGuess, bool combineParts) {
-    FaceGroup faces;
+    OBJFaceGroup faces;
     HFMMesh& mesh = hfmModel.meshes[0];
     mesh.parts.append(HFMMeshPart());
     HFMMeshPart& meshPart = mesh.parts.last();
     bool sawG = false;
     bool result = true;
     int originalFaceCountForDebugging = 0;
-    QString currentGroup;
     bool anyVertexColor { false };
     int vertexCount { 0 };
 
@@ -522,7 +975,7 @@ bool OBJSerializer::parseOBJGroup(OBJTokenizer& tokenizer, const QVariantHash& m
             result = false;
             break;
         }
-        QByteArray token = tokenizer.getDatum();
+        auto token = tokenizer.getDatum();
         //qCDebug(modelformat) << token;
         // we don't support separate objects in the same file, so treat "o" the same as "g".
         if (token == "g" || token == "o") {
@@ -535,8 +988,6 @@ bool OBJSerializer::parseOBJGroup(OBJTokenizer& tokenizer, const QVariantHash& m
             if (tokenizer.nextToken() != OBJTokenizer::DATUM_TOKEN) {
                 break;
             }
-            QByteArray groupName = tokenizer.getDatum();
-            currentGroup = groupName;
             if (!combineParts) {
                 currentMaterialName = QString("part-") + QString::number(_partCounter++);
             }
@@ -544,14 +995,15 @@ bool OBJSerializer::parseOBJGroup(OBJTokenizer& tokenizer, const QVariantHash& m
             if (tokenizer.nextToken(true) != OBJTokenizer::DATUM_TOKEN) {
                 break;
             }
-            QByteArray libraryName = tokenizer.getDatum();
-            librariesSeen[libraryName] = true;
+            auto libraryName = tokenizer.getDatum();
+            librariesSeen[QByteArray(libraryName.constData(), libraryName.size())] = true;
             // We'll read it later only if we actually need it.
         } else if (token == "usemtl") {
             if (tokenizer.nextToken() != OBJTokenizer::DATUM_TOKEN) {
                 break;
             }
-            QString nextName = tokenizer.getDatum();
+            auto datum = tokenizer.getDatum();
+            QString nextName = QByteArray(datum.constData(), datum.size());
             if (nextName != currentMaterialName) {
                 if (combineParts) {
                     currentMaterialName = nextName;
@@ -585,57 +1037,27 @@ bool OBJSerializer::parseOBJGroup(OBJTokenizer& tokenizer, const QVariantHash& m
         } else if (token == "vt") {
             textureUVs.append(tokenizer.getVec2());
         } else if (token == "f") {
-            OBJFace face;
+            OBJFaceGroup::Face face;
+            faces.startFace(face, getFaceMaterialIndex());
             while (true) {
                 if (tokenizer.nextToken() != OBJTokenizer::DATUM_TOKEN) {
-                    if (face.vertexIndices.count() == 0) {
+                    if (face.numVertexIndices == 0) {
                         // nonsense, bail out.
                         goto done;
                     }
                     break;
                 }
-                // faces can be:
-                //   vertex-index
-                //   vertex-index/texture-index
-                //   vertex-index/texture-index/surface-normal-index
-                QByteArray token = tokenizer.getDatum();
+                auto token = tokenizer.getDatum();
                 auto firstChar = token[0];
                 // Tokenizer treats line endings as whitespace. Non-digit and non-negative sign indicates done;
-                if (!isdigit(firstChar) && firstChar != '-') {
+                if (!isDigitChar(firstChar) && firstChar != '-') {
                     tokenizer.pushBackToken(OBJTokenizer::DATUM_TOKEN);
                     break;
                 }
-                QList<QByteArray> parts = token.split('/');
-                assert(parts.count() >= 1);
-                assert(parts.count() <= 3);
-                // If indices are negative relative indices then adjust them to absolute indices based on current vector sizes
-                // Also add 1 to each index as 1 will be subtracted later on from each index in OBJFace::add
-                for (int i = 0; i < parts.count(); ++i) {
-                    int part = parts[i].toInt();
-                    if (part < 0) {
-                        switch (i) {
-                            case 0:
-                                parts[i].setNum(vertices.size() + part + 1);
-                                break;
-                            case 1:
-                                parts[i].setNum(textureUVs.size() + part + 1);
-                                break;
-                            case 2:
-                                parts[i].setNum(normals.size() + part + 1);
-                                break;
-                        }
-                    }
-                }
-                const QByteArray noData {};
-                face.add(parts[0], (parts.count() > 1) ? parts[1] : noData, (parts.count() > 2) ? parts[2] : noData,
-                         vertices, vertexColors);
-                face.groupName = currentGroup;
-                face.materialName = currentMaterialName;
+                faces.addToFace(face, token.constData(), token.size(), vertices.size(), textureUVs.size(), normals.size());
             }
             originalFaceCountForDebugging++;
-            foreach(OBJFace face, face.triangulate()) {
-                faces.append(face);
-            }
+            faces.addFace(face);
         } else {
             // something we don't (yet) care about
             // qCDebug(modelformat) << "OBJ parser is skipping a line with" << token;
@@ -643,10 +1065,10 @@ bool OBJSerializer::parseOBJGroup(OBJTokenizer& tokenizer, const QVariantHash& m
         }
     }
 done:
-    if (faces.count() == 0) { // empty mesh
+    if (faces.numTriangles == 0) { // empty mesh
         mesh.parts.pop_back();
     } else {
-        faceGroups.append(faces); // We're done with this group. Add the faces.
+        faceGroups.push_back(std::move(faces)); // We're done with this group. Add the faces.
     }
     return result;
 }
@@ -663,12 +1085,8 @@ std::unique_ptr<hfm::Serializer::Factory> OBJSerializer::getFactory() const {
 
 HFMModel::Pointer OBJSerializer::read(const QByteArray& data, const QVariantHash& mapping, const QUrl& url) {
     PROFILE_RANGE_EX(resource_parse, __FUNCTION__, 0xffff0000, nullptr);
-    QBuffer buffer { const_cast<QByteArray*>(&data) };
-    buffer.open(QIODevice::ReadOnly);
-
     auto hfmModelPtr = std::make_shared<HFMModel>();
     HFMModel& hfmModel { *hfmModelPtr };
-    OBJTokenizer tokenizer { &buffer };
     float scaleGuess = 1.0f;
 
     bool needsMaterialLibrary = false;
@@ -681,7 +1099,15 @@ HFMModel::Pointer OBJSerializer::read(const QByteArray& data, const QVariantHash
     try {
         // call parseOBJGroup as long as it's returning true.  Each successful call will
         // add a new meshPart to the model's single mesh.
-        while (parseOBJGroup(tokenizer, mapping, hfmModel, scaleGuess, combineParts)) {}
+        if (useOBJTokenizer) {
+            QBuffer buffer { const_cast<QByteArray*>(&data) };
+            buffer.open(QIODevice::ReadOnly);
+            OBJTokenizer tokenizer { &buffer };
+            while (parseOBJGroup(tokenizer, mapping, hfmModel, scaleGuess, combineParts)) {}
+        } else {
+            OBJScanner scanner { data };
+            while (parseOBJGroup(scanner, mapping, hfmModel, scaleGuess, combineParts)) {}
+        }
 
         HFMMesh& mesh = hfmModel.meshes[0];
         mesh.meshIndex = 0;
@@ -709,14 +1135,15 @@ HFMModel::Pointer OBJSerializer::read(const QByteArray& data, const QVariantHash
         QVector<HFMMeshPart> hfmMeshParts;
         for (int i = 0, meshPartCount = 0; i < mesh.parts.count(); i++, meshPartCount++) {
             HFMMeshPart& meshPart = mesh.parts[i];
-            FaceGroup faceGroup = faceGroups[meshPartCount];
+            const OBJFaceGroup& faceGroup = faceGroups[meshPartCount];
             bool specifiesUV = false;
-            foreach(OBJFace face, faceGroup) {
+            for (const auto& face : faceGroup.faces) {
+                const QString& faceMaterialName = faceMaterialNames[face.materialIndex];
                 // Go through all of the OBJ faces and determine the number of different materials necessary (each different material will be a unique mesh).
                 // NOTE (trent/mittens 3/30/17): this seems hardcore wasteful and is slowed down a bit by iterating through the face group twice, but it's the best way I've thought of to hack multi-material support in an OBJ into this pipeline.
-                if (!materialMeshIdMap.contains(face.materialName)) {
+                if (!materialMeshIdMap.contains(faceMaterialName)) {
                     // Create a new HFMMesh for this material mapping.
-                    materialMeshIdMap.insert(face.materialName, materialMeshIdMap.count());
+                    materialMeshIdMap.insert(faceMaterialName, materialMeshIdMap.count());
 
                     hfmMeshParts.append(HFMMeshPart());
                     HFMMeshPart& meshPartNew = hfmMeshParts.last();
@@ -726,7 +1153,7 @@ HFMModel::Pointer OBJSerializer::read(const QByteArray& data, const QVariantHash
 
                     // Do some of the material logic (which previously lived below) now.
                     // All the faces in the same group will have the same name and material.
-                    QString groupMaterialName = face.materialName;
+                    QString groupMaterialName = faceMaterialName;
                     if (groupMaterialName.isEmpty() && specifiesUV) {
 #ifdef WANT_DEBUG
                         qCDebug(modelformat) << "OBJSerializer WARNING: " << url
@@ -756,70 +1183,97 @@ HFMModel::Pointer OBJSerializer::read(const QByteArray& data, const QVariantHash
         mesh.parts.clear();
         mesh.parts = QVector<HFMMeshPart>(hfmMeshParts);
 
+        int numTriangles = 0;
+        for (const auto& faceGroup : faceGroups) {
+            numTriangles += faceGroup.numTriangles;
+        }
+        const int VERTICES_PER_TRIANGLE = 3;
+        mesh.vertices.reserve(numTriangles * VERTICES_PER_TRIANGLE);
+        mesh.normals.reserve(numTriangles * VERTICES_PER_TRIANGLE);
+        mesh.texCoords.reserve(numTriangles * VERTICES_PER_TRIANGLE);
+        if (vertexColors.size() > 0) {
+            mesh.colors.reserve(numTriangles * VERTICES_PER_TRIANGLE);
+        }
+
         for (int i = 0, meshPartCount = 0; i < unmodifiedMeshPartCount; i++, meshPartCount++) {
-            FaceGroup faceGroup = faceGroups[meshPartCount];
+            const OBJFaceGroup& faceGroup = faceGroups[meshPartCount];
 
             // Now that each mesh has been created with its own unique material mappings, fill them with data (vertex data is duplicated, face data is not).
-            foreach(OBJFace face, faceGroup) {
-                HFMMeshPart& meshPart = mesh.parts[materialMeshIdMap[face.materialName]];
-
-                glm::vec3 v0 = checked_at(vertices, face.vertexIndices[0]);
-                glm::vec3 v1 = checked_at(vertices, face.vertexIndices[1]);
-                glm::vec3 v2 = checked_at(vertices, face.vertexIndices[2]);
-
-                glm::vec3 vc0, vc1, vc2;
-                bool hasVertexColors = (vertexColors.size() > 0);
-                if (hasVertexColors) {
-                    // If there are any vertex colors, it's safe to assume all meshes had them exported.
-                    vc0 = checked_at(vertexColors, face.vertexIndices[0]);
-                    vc1 = checked_at(vertexColors, face.vertexIndices[1]);
-                    vc2 = checked_at(vertexColors, face.vertexIndices[2]);
-                }
+            for (const auto& face : faceGroup.faces) {
+                HFMMeshPart& meshPart = mesh.parts[materialMeshIdMap[faceMaterialNames[face.materialIndex]]];
+
+                // fan the face out into triangles
+                for (int fanCorner = 1; fanCorner < face.numVertexIndices - 1; fanCorner++) {
+                    const int corners[VERTICES_PER_TRIANGLE] = { 0, fanCorner, fanCorner + 1 };
+                    int vertexIndices[VERTICES_PER_TRIANGLE];
+                    for (int j = 0; j < VERTICES_PER_TRIANGLE; j++) {
+                        vertexIndices[j] = faceGroup.vertexIndices[face.firstVertexIndex + corners[j]];
+                    }
 
-                // Scale the vertices if the OBJ file scale is specified as non-one.
-                if (scaleGuess != 1.0f) {
-                    v0 *= scaleGuess;
-                    v1 *= scaleGuess;
-                    v2 *= scaleGuess;
-                }
+                    glm::vec3 v0 = checked_at(vertices, vertexIndices[0]);
+                    glm::vec3 v1 = checked_at(vertices, vertexIndices[1]);
+                    glm::vec3 v2 = checked_at(vertices, vertexIndices[2]);
+
+                    glm::vec3 vc0, vc1, vc2;
+                    bool hasVertexColors = (vertexColors.size() > 0);
+                    if (hasVertexColors) {
+                        // If there are any vertex colors, it's safe to assume all meshes had them exported.
+                        vc0 = checked_at(vertexColors, vertexIndices[0]);
+                        vc1 = checked_at(vertexColors, vertexIndices[1]);
+                        vc2 = checked_at(vertexColors, vertexIndices[2]);
+                    }
 
-                // Add the vertices.
-                meshPart.triangleIndices.append(mesh.vertices.count()); // not face.vertexIndices into vertices
-                mesh.vertices << v0;
-                meshPart.triangleIndices.append(mesh.vertices.count());
-                mesh.vertices << v1;
-                meshPart.triangleIndices.append(mesh.vertices.count());
-                mesh.vertices << v2;
-
-                if (hasVertexColors) {
-                    // Add vertex colors.
-                    mesh.colors << vc0;
-                    mesh.colors << vc1;
-                    mesh.colors << vc2;
-                }
+                    // Scale the vertices if the OBJ file scale is specified as non-one.
+                    if (scaleGuess != 1.0f) {
+                        v0 *= scaleGuess;
+                        v1 *= scaleGuess;
+                        v2 *= scaleGuess;
+                    }
 
-                glm::vec3 n0, n1, n2;
-                if (face.normalIndices.count()) {
-                    n0 = checked_at(normals, face.normalIndices[0]);
-                    n1 = checked_at(normals, face.normalIndices[1]);
-                    n2 = checked_at(normals, face.normalIndices[2]);
-                } else { 
-                    // generate normals from triangle plane if not provided
-                    n0 = n1 = n2 = glm::cross(v1 - v0, v2 - v0);
-                }
+                    // Add the vertices.
+                    meshPart.triangleIndices.append(mesh.vertices.count()); // not face.vertexIndices into vertices
+                    mesh.vertices << v0;
+                    meshPart.triangleIndices.append(mesh.vertices.count());
+                    mesh.vertices << v1;
+                    meshPart.triangleIndices.append(mesh.vertices.count());
+                    mesh.vertices << v2;
+
+                    if (hasVertexColors) {
+                        // Add vertex colors.
+                        mesh.colors << vc0;
+                        mesh.colors << vc1;
+                        mesh.colors << vc2;
+                    }
 
-                mesh.normals.append(n0);
-                mesh.normals.append(n1);
-                mesh.normals.append(n2);
-
-                if (face.textureUVIndices.count()) {
-                    mesh.texCoords <<
-                        checked_at(textureUVs, face.textureUVIndices[0]) <<
-                        checked_at(textureUVs, face.textureUVIndices[1]) <<
-                        checked_at(textureUVs, face.textureUVIndices[2]);
-                } else {
-                    glm::vec2 corner(0.0f, 1.0f);
-                    mesh.texCoords << corner << corner << corner;
+                    glm::vec3 n0, n1, n2;
+                    if (face.numNormalIndices > 0) {
+                        n0 = checked_at(normals, checkedCornerIndex(faceGroup.normalIndices, face.firstNormalIndex,
+                            face.numNormalIndices, corners[0]));
+                        n1 = checked_at(normals, checkedCornerIndex(faceGroup.normalIndices, face.firstNormalIndex,
+                            face.numNormalIndices, corners[1]));
+                        n2 = checked_at(normals, checkedCornerIndex(faceGroup.normalIndices, face.firstNormalIndex,
+                            face.numNormalIndices, corners[2]));
+                    } else {
+                        // generate normals from triangle plane if not provided
+                        n0 = n1 = n2 = glm::cross(v1 - v0, v2 - v0);
+                    }
+
+                    mesh.normals.append(n0);
+                    mesh.normals.append(n1);
+                    mesh.normals.append(n2);
+
+                    if (face.numTextureUVIndices > 0) {
+                        mesh.texCoords <<
+                            checked_at(textureUVs, checkedCornerIndex(faceGroup.textureUVIndices, face.firstTextureUVIndex,
+                                face.numTextureUVIndices, corners[0])) <<
+                            checked_at(textureUVs, checkedCornerIndex(faceGroup.textureUVIndices, face.firstTextureUVIndex,
+                                face.numTextureUVIndices, corners[1])) <<
+                            checked_at(textureUVs, checkedCornerIndex(faceGroup.textureUVIndices, face.firstTextureUVIndex,
+                                face.numTextureUVIndices, corners[2]));
+                    } else {
+                        glm::vec2 corner(0.0f, 1.0f);
+                        mesh.texCoords << corner << corner << corner;
+                    }
                 }
             }
         }
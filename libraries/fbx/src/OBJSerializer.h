@@ -12,6 +12,10 @@
 #ifndef hifi_OBJSerializer_h
 #define hifi_OBJSerializer_h
 
+#include <cstring>
+#include <deque>
+#include <vector>
+
 #include <QtNetwork/QNetworkReply>
 #include <hfm/HFMSerializer.h>
 
@@ -44,21 +48,118 @@ private:
     QString _comment;
 };
 
-class OBJFace { // A single face, with three or more planar vertices. But see triangulate().
+// A view of a token in a document being read by an OBJScanner.
+class OBJDatum {
 public:
-    QVector<int> vertexIndices;
-    QVector<int> textureUVIndices;
-    QVector<int> normalIndices;
-    QString groupName; // We don't make use of hierarchical structure, but it can be preserved for debugging and future use.
-    QString materialName;
-    // Add one more set of vertex data. Answers true if successful
-    bool add(const QByteArray& vertexIndex, const QByteArray& textureIndex, const QByteArray& normalIndex,
-             const QVector<glm::vec3>& vertices, const QVector<glm::vec3>& vertexColors);
-    // Return a set of one or more OBJFaces from this one, in which each is just a triangle.
-    // Even though HFMMeshPart can handle quads, it would be messy to try to keep track of mixed-size faces, so we treat everything as triangles.
-    QVector<OBJFace> triangulate();
+    OBJDatum() { }
+    OBJDatum(const char* data, int size) : _data(data), _size(size) { }
+
+    const char* constData() const { return _data; }
+    int size() const { return _size; }
+    char operator[](int i) const { return _data[i]; }
+    bool operator==(const char* string) const { return (int)strlen(string) == _size && memcmp(_data, string, _size) == 0; }
+    bool operator!=(const char* string) const { return !(*this == string); }
+
 private:
-    void addFrom(const OBJFace* face, int index);
+    const char* _data { "" };
+    int _size { 0 };
+};
+
+// Reads the same tokens as the OBJTokenizer, from a whole document in memory.
+//
+// The document is scanned ahead a batch at a time. Each batch is split into chunks on line boundaries, which are
+// tokenized in parallel, parsing the floats as they go. Documents with quotes, which can span lines, are scanned a
+// token at a time instead.
+class OBJScanner {
+public:
+    static const int DEFAULT_CHUNK_SIZE = 128 * 1024;
+    static const int CHUNKS_PER_BATCH = 32;
+
+    OBJScanner(const QByteArray& document, int chunkSize = DEFAULT_CHUNK_SIZE);
+
+    int nextToken(bool allowSpaceChar = false);
+    OBJDatum getDatum() const { return _datum; }
+    bool isNextTokenFloat();
+    void skipLine();
+    void pushBackToken(int token) { _pushedBackToken = token; }
+    const QString getComment() const;
+    glm::vec3 getVec3();
+    bool getVertex(glm::vec3& vertex, glm::vec3& vertexColor);
+    glm::vec2 getVec2();
+    float getFloat();
+
+private:
+    class Token {
+    public:
+        enum FloatState : uint8_t {
+            UNKNOWN_FLOAT, // left to QByteArray::toFloat() and std::stof()
+            NOT_FLOAT,
+            FLOAT
+        };
+
+        const char* data; // of the datum or comment
+        const char* end; // in the document, past the token
+        int size;
+        int type; // an OBJTokenizer::SpecialToken
+        bool quoted; // the datum is in _quotedData
+        FloatState floatState;
+        float value;
+    };
+
+    // scans one token at or after begin, returns false if there are none before end
+    static bool scanToken(const char* begin, const char* end, Token& token, std::deque<QByteArray>* quotedData = nullptr);
+    static void scanTokens(const char* begin, const char* end, std::vector<Token>& tokens);
+
+    bool nextScannedToken(Token& token);
+    bool scanNextBatch();
+    void resumeScanningAt(const char* position);
+
+    QByteArray _document;
+    const char* _end;
+    int _chunkSize;
+    bool _hasQuotes;
+
+    std::vector<Token> _tokens; // the current batch
+    size_t _nextToken { 0 };
+    std::vector<Token> _rescannedTokens; // the rest of a line after a datum with spaces, these come before _tokens
+    size_t _nextRescannedToken { 0 };
+    const char* _scanned; // the end of the batches scanned so far
+    std::deque<QByteArray> _quotedData;
+
+    const char* _position; // past the last token read
+    int _pushedBackToken;
+    OBJDatum _datum;
+    Token::FloatState _datumFloatState { Token::NOT_FLOAT };
+    float _datumValue { 0.0f };
+    OBJDatum _comment;
+};
+
+// The faces of a group, with their indices kept in flat arrays until the OBJSerializer triangulates them.
+class OBJFaceGroup {
+public:
+    class Face { // a single face, with three or more planar vertices
+    public:
+        int firstVertexIndex { 0 };
+        int numVertexIndices { 0 };
+        int firstTextureUVIndex { 0 };
+        int numTextureUVIndices { 0 };
+        int firstNormalIndex { 0 };
+        int numNormalIndices { 0 };
+        int materialIndex { 0 }; // into OBJSerializer::faceMaterialNames
+    };
+
+    std::vector<Face> faces;
+    std::vector<int> vertexIndices;
+    std::vector<int> textureUVIndices;
+    std::vector<int> normalIndices;
+    int numTriangles { 0 };
+
+    void startFace(Face& face, int materialIndex) const;
+    // Add one more set of vertex data. Answers true if successful
+    bool addToFace(Face& face, const char* vertexData, int size, int numVertices, int numTextureUVs, int numNormals);
+    // Keeps the face if it has any triangles. Even though HFMMeshPart can handle quads, it would be messy to try to keep
+    // track of mixed-size faces, so we treat everything as triangles.
+    void addFace(const Face& face);
 };
 
 class OBJMaterialTextureOptions {
@@ -94,14 +195,17 @@ public:
     MediaType getMediaType() const override;
     std::unique_ptr<hfm::Serializer::Factory> getFactory() const override;
     
-    typedef QVector<OBJFace> FaceGroup;
     QVector<glm::vec3> vertices;
     QVector<glm::vec3> vertexColors;
     QVector<glm::vec2> textureUVs;
     QVector<glm::vec3> normals;
-    QVector<FaceGroup> faceGroups;
+    std::vector<OBJFaceGroup> faceGroups;
+    QVector<QString> faceMaterialNames;
     QString currentMaterialName;
     QHash<QString, OBJMaterial> materials;
+
+    // read with the OBJTokenizer rather than the OBJScanner, for comparison
+    bool useOBJTokenizer { false };
     
     HFMModel::Pointer read(const QByteArray& data, const QVariantHash& mapping, const QUrl& url = QUrl()) override;
 
@@ -109,8 +213,10 @@ private:
     QUrl _url;
 
     QHash<QByteArray, bool> librariesSeen;
-    bool parseOBJGroup(OBJTokenizer& tokenizer, const QVariantHash& mapping, HFMModel& hfmModel,
+    template<class Tokenizer>
+    bool parseOBJGroup(Tokenizer& tokenizer, const QVariantHash& mapping, HFMModel& hfmModel,
                        float& scaleGuess, bool combineParts);
+    int getFaceMaterialIndex();
     void parseMaterialLibrary(QIODevice* device);
     void parseTextureLine(const QByteArray& textureLine, QByteArray& filename, OBJMaterialTextureOptions& textureOptions);
     bool isValidTexture(const QByteArray &filename); // true if the file exists. TODO?: check content-type header and that it is a supported format.
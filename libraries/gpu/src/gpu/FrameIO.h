@@ -18,10 +18,25 @@ namespace gpu {
 
 using TextureCapturer = std::function<void(const std::string&, const TexturePointer&, uint16 layer)>;
 using TextureLoader = std::function<void(const std::string&, const TexturePointer&, uint16 layer)>;
-void writeFrame(const std::string& filename, const FramePointer& frame, const TextureCapturer& capturer = nullptr);
+
+enum class FrameFormat {
+    BINARY,  // filename.frame, a single container holding the frame's arrays and deduplicated buffer and texture contents
+    JSON,    // filename.json and filename.bin, human readable for debugging, but larger and slower to load
+};
+
+enum class FrameCompression {
+    NONE,
+    ZLIB,
+};
+
+// filename is the capture's base name, the extension is added according to the format
+void writeFrame(const std::string& filename, const FramePointer& frame, const TextureCapturer& capturer = nullptr,
+                FrameFormat format = FrameFormat::BINARY, FrameCompression compression = FrameCompression::NONE);
+// reads either format, a base name without extension reads the binary capture if there is one
 FramePointer readFrame(const std::string& filename, uint32_t externalTexture, const TextureLoader& loader = nullptr);
 
 using IndexOptimizer = std::function<void(Primitive, uint32_t faceCount, uint32_t indexCount, uint32_t* indices )>;
+// JSON captures only
 void optimizeFrame(const std::string& filename, const IndexOptimizer& optimizer);
 
 }  // namespace gpu
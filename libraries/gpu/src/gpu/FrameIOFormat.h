@@ -0,0 +1,61 @@
+//
+//  FrameIOFormat.h
+//  libraries/gpu/src/gpu
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+#pragma once
+#ifndef hifi_gpu_FrameIOFormat_h
+#define hifi_gpu_FrameIOFormat_h
+
+#include <cstdint>
+#include <string>
+
+namespace gpu { namespace frameio {
+
+// The binary frame container is a header, a section table and the section contents, in that order.
+//
+// The description section is the same node tree the JSON export writes, encoded as MessagePack, except that the bulk
+// arrays of each batch (commands, params, data, transforms...) are [offset, count] references into the arrays section,
+// and buffers and stored texture mips are [offset, size] references into the blobs section, which holds each distinct
+// content once.
+static const std::string EXTENSION{ ".frame" };
+static const std::string JSON_EXTENSION{ ".json" };
+
+static const uint32_t MAGIC = 0x46474648;  // "HFGF" in little endian
+static const uint32_t VERSION = 1;
+
+enum Section : uint32_t {
+    DESCRIPTION = 0,
+    ARRAYS,
+    BLOBS,
+
+    NUM_SECTIONS,
+};
+
+enum Flag : uint32_t {
+    ZLIB_COMPRESSED = 1 << 0,  // sections whose stored size differs from their size are qCompress'ed
+};
+
+struct Header {
+    uint32_t magic { MAGIC };
+    uint32_t version { VERSION };
+    uint32_t flags { 0 };
+    uint32_t numSections { NUM_SECTIONS };
+};
+
+struct SectionEntry {
+    uint64_t offset { 0 };  // from the start of the file
+    uint64_t storedSize { 0 };
+    uint64_t size { 0 };
+};
+
+static_assert(sizeof(Header) == 16, "Frame header must be packed");
+static_assert(sizeof(SectionEntry) == 24, "Frame section entries must be packed");
+
+} }  // namespace gpu::frameio
+
+#endif
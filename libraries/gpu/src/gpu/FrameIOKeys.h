@@ -36,6 +36,8 @@ static const char* capturedTextures = "capturedTextures";
 static const char* channel = "channel";
 static const char* colorAttachments = "colorAttachments";
 static const char* colorWriteMask = "colorWriteMask";
+static const char* commandNames = "commandNames";
+static const char* commandOffsets = "commandOffsets";
 static const char* commands = "commands";
 static const char* comparisonFunction = "comparisonFunction";
 static const char* cullMode = "cullMode";
@@ -73,6 +75,7 @@ static const char* namedData = "namedData";
 static const char* names = "names";
 static const char* objects = "objects";
 static const char* offset = "offset";
+static const char* params = "params";
 static const char* pipelines = "pipelines";
 static const char* pose = "pose";
 static const char* profileRanges = "profileRanges";
@@ -95,6 +98,8 @@ static const char* stencilActivation = "stencilActivation";
 static const char* stencilTestBack = "stencilTestBack";
 static const char* stencilTestFront = "stencilTestFront";
 static const char* stereo = "stereo";
+static const char* storedMipFormat = "storedMipFormat";
+static const char* storedMips = "storedMips";
 static const char* subresource = "subresource";
 static const char* swapchains = "swapchains";
 static const char* texelFormat = "texelFormat";
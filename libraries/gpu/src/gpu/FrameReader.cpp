@@ -8,10 +8,12 @@
 #include "FrameIO.h"
 
 #include <nlohmann/json.hpp>
+#include <climits>
 #include <unordered_map>
 
 #include <QtCore/QFileInfo>
 #include <QtCore/QDir>
+#include <QtCore/QByteArray>
 
 #include <ktx/KTX.h>
 #include "Frame.h"
@@ -20,20 +22,37 @@
 
 
 #include "FrameIOKeys.h"
+#include "FrameIOFormat.h"
 
 namespace gpu {
 using json = nlohmann::json;
 
 class Deserializer {
 public:
+    static bool hasExtension(const std::string& filename, const std::string& ext) {
+        return filename.size() >= ext.size() && 0 == filename.compare(filename.size() - ext.size(), ext.size(), ext);
+    }
+
     static std::string getBaseName(const std::string& filename) {
-        static const std::string ext{ ".json" };
-        if (std::string::npos != filename.rfind(ext)) {
-            return filename.substr(0, filename.size() - ext.size());
+        for (const auto& ext : { frameio::JSON_EXTENSION, frameio::EXTENSION }) {
+            if (hasExtension(filename, ext)) {
+                return filename.substr(0, filename.size() - ext.size());
+            }
         }
         return filename;
     }
 
+    static bool isBinaryFrame(const std::string& filename) {
+        if (hasExtension(filename, frameio::JSON_EXTENSION)) {
+            return false;
+        }
+        if (hasExtension(filename, frameio::EXTENSION)) {
+            return true;
+        }
+        // A capture's base name, prefer the binary container when both formats were written
+        return QFileInfo((filename + frameio::EXTENSION).c_str()).exists();
+    }
+
     static std::string getBaseDir(const std::string& filename) {
         std::string result;
         if (0 == filename.find("assets:")) {
@@ -49,11 +68,13 @@ public:
     }
 
     Deserializer(const std::string& filename, uint32_t externalTexture, const TextureLoader& loader) :
-        basename(getBaseName(filename)), basedir(getBaseDir(filename)), externalTexture(externalTexture), textureLoader(loader) {
+        basename(getBaseName(filename)), basedir(getBaseDir(filename)), binaryFormat(isBinaryFrame(filename)),
+        externalTexture(externalTexture), textureLoader(loader) {
     }
 
     const std::string basename;
     const std::string basedir;
+    const bool binaryFormat;
     std::string binaryFile;
     const uint32_t externalTexture;
     TextureLoader textureLoader;
@@ -74,6 +95,31 @@ public:
 
     FramePointer deserializeFrame();
 
+    // The mapped binary container, and the sections that had to be uncompressed
+    storage::StoragePointer container;
+    QByteArray uncompressedSections[frameio::NUM_SECTIONS];
+    const uint8_t* sectionData[frameio::NUM_SECTIONS] {};
+    size_t sectionSizes[frameio::NUM_SECTIONS] {};
+    // The binary capture's command indices, as Batch::Commands
+    std::vector<Batch::Command> commandsByIndex;
+
+    void readContainer();
+    const uint8_t* readSection(frameio::Section section, size_t offset, size_t size) const;
+
+    // reads the [offset, count] reference to the arrays section
+    template <typename T>
+    void readArrayBlock(const json& node, std::vector<T>& dest, const T& fill = T()) const {
+        size_t offset = node[0];
+        size_t count = node[1];
+        if (count > sectionSizes[frameio::ARRAYS] / sizeof(T)) {
+            throw std::runtime_error("read array error");
+        }
+        const auto* data = readSection(frameio::ARRAYS, offset, count * sizeof(T));
+        dest.resize(count, fill);
+        if (count > 0) {
+            memcpy(dest.data(), data, count * sizeof(T));
+        }
+    }
 
     void readBuffers(const json& node);
 
@@ -166,11 +212,32 @@ public:
     }
 
     template <typename T>
-    static bool readPointerCache(typename Batch::Cache<T>::Vector& dest,
-                                 const json& node,
-                                 const std::string& name,
-                                 std::vector<T>& global) {
-        auto transform = [&](const json& node) -> const T& { return global[node.get<uint32_t>()]; };
+    bool readPointerCache(typename Batch::Cache<T>::Vector& dest,
+                          const json& node,
+                          const std::string& name,
+                          std::vector<T>& global) const {
+        if (binaryFormat) {
+            if (!node.count(name)) {
+                return false;
+            }
+            std::vector<uint32_t> indices;
+            readArrayBlock(node[name], indices);
+            for (const auto& index : indices) {
+                // a corrupt capture can index past the frame's objects
+                if (index >= global.size()) {
+                    throw std::runtime_error("read section error");
+                }
+                dest.cache(global[index]);
+            }
+            return true;
+        }
+        auto transform = [&](const json& node) -> const T& {
+            auto index = node.get<uint32_t>();
+            if (index >= global.size()) {
+                throw std::runtime_error("read section error");
+            }
+            return global[index];
+        };
         return readBatchCacheTransformed<T, const T&>(dest, node, name, transform);
     }
 
@@ -229,6 +296,7 @@ public:
     static Transform readTransform(const json& node) { return Transform{ readMat4(node) }; }
     static std::vector<uint8_t> fromBase64(const json& node);
     static void readCommand(const json& node, Batch& batch);
+    void readCommands(const json& node, Batch& batch) const;
 };
 
 FramePointer readFrame(const std::string& filename, uint32_t externalTexture, const TextureLoader& loader) {
@@ -243,7 +311,93 @@ void optimizeFrame(const std::string& filename, const IndexOptimizer& optimizer)
 
 using namespace gpu;
 
+static std::unordered_map<std::string, Batch::Command> getCommandNameMap() {
+    static std::unordered_map<std::string, Batch::Command> result;
+    if (result.empty()) {
+        for (Batch::Command i = Batch::COMMAND_draw; i < Batch::NUM_COMMANDS; i = (Batch::Command)(i + 1)) {
+            result[keys::COMMAND_NAMES[i]] = i;
+        }
+    }
+    return result;
+}
+
+void Deserializer::readContainer() {
+    std::string filename{ basename + frameio::EXTENSION };
+    container = std::make_shared<storage::FileStorage>(filename.c_str());
+    const auto containerSize = container->size();
+    const auto* mapped = container->data();
+
+    frameio::Header header;
+    frameio::SectionEntry sections[frameio::NUM_SECTIONS];
+    if (!mapped || containerSize < sizeof(header)) {
+        throw std::runtime_error("read frame error");
+    }
+    memcpy(&header, mapped, sizeof(header));
+    if (header.magic != frameio::MAGIC) {
+        throw std::runtime_error("not a frame capture");
+    }
+    if (header.version > frameio::VERSION || header.numSections < frameio::NUM_SECTIONS ||
+        containerSize < sizeof(header) + header.numSections * sizeof(frameio::SectionEntry)) {
+        throw std::runtime_error("unsupported frame version");
+    }
+    memcpy(sections, mapped + sizeof(header), sizeof(sections));
+
+    for (uint32_t i = 0; i < frameio::NUM_SECTIONS; ++i) {
+        const auto& section = sections[i];
+        if (section.offset > containerSize || section.storedSize > containerSize - section.offset) {
+            throw std::runtime_error("read frame section error");
+        }
+        const auto* stored = mapped + section.offset;
+        if (section.storedSize == section.size) {
+            // Uncompressed sections are used straight from the mapped file
+            sectionData[i] = stored;
+        } else {
+            if (0 == (header.flags & frameio::ZLIB_COMPRESSED) || section.storedSize > (uint64_t)INT_MAX) {
+                throw std::runtime_error("read frame section error");
+            }
+            uncompressedSections[i] = qUncompress(stored, (int)section.storedSize);
+            if ((uint64_t)uncompressedSections[i].size() != section.size) {
+                throw std::runtime_error("frame section decompression error");
+            }
+            sectionData[i] = (const uint8_t*)uncompressedSections[i].constData();
+        }
+        sectionSizes[i] = section.size;
+    }
+
+    const auto* description = sectionData[frameio::DESCRIPTION];
+    frameNode = json::from_msgpack(description, description + sectionSizes[frameio::DESCRIPTION]);
+
+    const auto& commandNameMap = getCommandNameMap();
+    for (const auto& commandNameNode : frameNode[keys::commandNames]) {
+        auto itr = commandNameMap.find(commandNameNode.get<std::string>());
+        // Commands that were removed since the capture fail if they're used
+        commandsByIndex.push_back(itr != commandNameMap.end() ? itr->second : Batch::NUM_COMMANDS);
+    }
+}
+
+const uint8_t* Deserializer::readSection(frameio::Section section, size_t offset, size_t size) const {
+    const auto sectionSize = sectionSizes[section];
+    if (offset > sectionSize || size > sectionSize - offset) {
+        throw std::runtime_error("read section error");
+    }
+    return sectionData[section] + offset;
+}
+
 void Deserializer::readBuffers(const json& buffersNode) {
+    if (binaryFormat) {
+        buffers.reserve(buffersNode.size());
+        for (const auto& bufferNode : buffersNode) {
+            if (bufferNode.is_null()) {
+                buffers.push_back(nullptr);
+                continue;
+            }
+            size_t offset = bufferNode[0];
+            size_t size = bufferNode[1];
+            buffers.push_back(std::make_shared<Buffer>(size, readSection(frameio::BLOBS, offset, size)));
+        }
+        return;
+    }
+
     storage::FileStorage mappedFile(binaryFile.c_str());
     const auto mappedSize = mappedFile.size();
     const auto* mapped = mappedFile.data();
@@ -363,6 +517,15 @@ TexturePointer Deserializer::readTexture(const json& node, uint32_t external) {
             ktxFile = basedir + "/" + ktxFile;
         }
         texture.setKtxBacking(ktxFile);
+    } else if (node.count(keys::storedMips)) {
+        texture.setStoredMipFormat(readElement(node[keys::storedMipFormat]));
+        for (const auto& mipNode : node[keys::storedMips]) {
+            uint16 level = mipNode[0];
+            uint8 face = mipNode[1];
+            size_t offset = mipNode[2];
+            size_t size = mipNode[3];
+            texture.assignStoredMipFace(level, face, size, readSection(frameio::BLOBS, offset, size));
+        }
     }
     return result;
 }
@@ -676,14 +839,38 @@ std::vector<uint8_t> Deserializer::fromBase64(const json& node) {
     return result;
 }
 
-static std::unordered_map<std::string, Batch::Command> getCommandNameMap() {
-    static std::unordered_map<std::string, Batch::Command> result;
-    if (result.empty()) {
-        for (Batch::Command i = Batch::COMMAND_draw; i < Batch::NUM_COMMANDS; i = (Batch::Command)(i + 1)) {
-            result[keys::COMMAND_NAMES[i]] = i;
+void Deserializer::readCommands(const json& node, Batch& batch) const {
+    if (!binaryFormat) {
+        for (const auto& commandNode : node[keys::commands]) {
+            readCommand(commandNode, batch);
         }
+        return;
+    }
+
+    std::vector<uint32_t> commands;
+    std::vector<uint32_t> commandOffsets;
+    std::vector<uint64_t> params;
+    readArrayBlock(node[keys::commands], commands);
+    readArrayBlock(node[keys::commandOffsets], commandOffsets);
+    readArrayBlock(node[keys::params], params);
+    if (commandOffsets.size() != commands.size()) {
+        throw std::runtime_error("read commands error");
+    }
+
+    batch._commands.reserve(commands.size());
+    batch._commandOffsets.reserve(commands.size());
+    for (size_t i = 0; i < commands.size(); ++i) {
+        if (commands[i] >= commandsByIndex.size() || commandsByIndex[commands[i]] == Batch::NUM_COMMANDS ||
+            commandOffsets[i] > params.size()) {
+            throw std::runtime_error("read commands error");
+        }
+        batch._commands.push_back(commandsByIndex[commands[i]]);
+        batch._commandOffsets.push_back(commandOffsets[i]);
+    }
+    batch._params.reserve(params.size());
+    for (const auto& param : params) {
+        batch._params.emplace_back((size_t)param);
     }
-    return result;
 }
 
 void Deserializer::readCommand(const json& commandNode, Batch& batch) {
@@ -703,6 +890,10 @@ Batch::NamedBatchData Deserializer::readNamedBatchData(const json& node) {
         uint32_t index = node;
         return buffers[index];
     });
+    if (binaryFormat) {
+        readArrayBlock(node[keys::drawCallInfos], result.drawCallInfos, Batch::DrawCallInfo{ 0 });
+        return result;
+    }
     readOptionalVectorTransformed<Batch::DrawCallInfo>(result.drawCallInfos, node, keys::drawCallInfos,
                                                        [](const json& node) -> Batch::DrawCallInfo {
                                                            Batch::DrawCallInfo result{ 0 };
@@ -737,31 +928,58 @@ BatchPointer Deserializer::readBatch(const json& node) {
     readPointerCache(batch._swapChains, node, keys::swapchains, swapchains);
     readPointerCache(batch._queries, node, keys::queries, queries);
 
-    readOptionalVectorTransformed<Batch::DrawCallInfo>(batch._drawCallInfos, node, keys::drawCallInfos,
-                                                       [](const json& node) -> Batch::DrawCallInfo {
-                                                           Batch::DrawCallInfo result{ 0 };
-                                                           *((uint32_t*)&result) = node;
-                                                           return result;
-                                                       });
-
-    readOptionalTransformed<std::vector<uint8_t>>(batch._data, node, keys::data,
-                                                  [](const json& node) { return fromBase64(node); });
+    if (binaryFormat) {
+        if (node.count(keys::drawCallInfos)) {
+            readArrayBlock(node[keys::drawCallInfos], batch._drawCallInfos, Batch::DrawCallInfo{ 0 });
+        }
+        if (node.count(keys::data)) {
+            readArrayBlock(node[keys::data], batch._data);
+        }
+    } else {
+        readOptionalVectorTransformed<Batch::DrawCallInfo>(batch._drawCallInfos, node, keys::drawCallInfos,
+                                                           [](const json& node) -> Batch::DrawCallInfo {
+                                                               Batch::DrawCallInfo result{ 0 };
+                                                               *((uint32_t*)&result) = node;
+                                                               return result;
+                                                           });
+
+        readOptionalTransformed<std::vector<uint8_t>>(batch._data, node, keys::data,
+                                                      [](const json& node) { return fromBase64(node); });
+    }
+
+    readCommands(node, batch);
+    if (binaryFormat) {
+        std::vector<glm::mat4> matrices;
+        if (node.count(keys::transforms)) {
+            readArrayBlock(node[keys::transforms], matrices);
+            for (const auto& matrix : matrices) {
+                batch._transforms.cache(Transform{ matrix });
+            }
+        }
+        if (node.count(keys::objects)) {
+            readArrayBlock(node[keys::objects], matrices);
+            batch._objects.reserve(matrices.size());
+            for (const auto& matrix : matrices) {
+                Batch::TransformObject object;
+                object._model = matrix;
+                object._modelInverse = glm::inverse(matrix);
+                batch._objects.push_back(object);
+            }
+        }
+    } else {
+        readBatchCacheTransformed<Transform, Transform>(batch._transforms, node, keys::transforms, &readTransform);
 
-    for (const auto& commandNode : node[keys::commands]) {
-        readCommand(commandNode, batch);
+        auto objectTransformReader = [](const json& node) -> Batch::TransformObject {
+            Batch::TransformObject result;
+            result._model = readMat4(node);
+            result._modelInverse = glm::inverse(result._model);
+            return result;
+        };
+        readOptionalVectorTransformed<Batch::TransformObject>(batch._objects, node, keys::objects, objectTransformReader);
     }
-    readBatchCacheTransformed<Transform, Transform>(batch._transforms, node, keys::transforms, &readTransform);
     readBatchCacheTransformed<std::string>(batch._profileRanges, node, keys::profileRanges);
     readBatchCacheTransformed<std::string>(batch._names, node, keys::names);
 
-    auto objectTransformReader = [](const json& node) -> Batch::TransformObject {
-        Batch::TransformObject result;
-        result._model = readMat4(node);
-        result._modelInverse = glm::inverse(result._model);
-        return result;
-    };
-    readOptionalVectorTransformed<Batch::TransformObject>(batch._objects, node, keys::objects, objectTransformReader);
-
     if (node.count(keys::namedData)) {
         const auto& namedDataNode = node[keys::namedData];
         for (auto itr = namedDataNode.begin(); itr != namedDataNode.end(); ++itr) {
@@ -793,8 +1011,10 @@ StereoState readStereoState(const json& node) {
 
 
 FramePointer Deserializer::deserializeFrame() {
-    {
-        std::string filename{ basename + ".json" };
+    if (binaryFormat) {
+        readContainer();
+    } else {
+        std::string filename{ basename + frameio::JSON_EXTENSION };
         storage::FileStorage mappedFile(filename.c_str());
         frameNode = json::parse(std::string((const char*)mappedFile.data(), mappedFile.size()));
     }
@@ -874,6 +1094,9 @@ FramePointer Deserializer::readFrame() {
 }
 
 void Deserializer::optimizeFrame(const IndexOptimizer& optimizer) {
+    if (binaryFormat) {
+        throw std::runtime_error("Frame optimization requires a JSON capture");
+    }
     auto result = deserializeFrame();
     auto& frame = *result;
 
@@ -10,9 +10,14 @@
 #include "Batch.h"
 #include "TextureTable.h"
 #include <nlohmann/json.hpp>
+#include <climits>
 #include <unordered_map>
 
+#include <QtCore/QFile>
+#include <QtCore/QHash>
+
 #include "FrameIOKeys.h"
+#include "FrameIOFormat.h"
 
 namespace gpu {
 
@@ -22,6 +27,8 @@ class Serializer {
 public:
     const std::string basename;
     const TextureCapturer textureCapturer;
+    const FrameFormat format;
+    const FrameCompression compression;
     std::unordered_map<ShaderPointer, uint32_t> shaderMap;
     std::unordered_map<ShaderPointer, uint32_t> programMap;
     std::unordered_map<TexturePointer, uint32_t> textureMap;
@@ -33,7 +40,13 @@ public:
     std::unordered_map<SwapChainPointer, uint32_t> swapchainMap;
     std::unordered_map<QueryPointer, uint32_t> queryMap;
 
-    Serializer(const std::string& basename, const TextureCapturer& capturer) : basename(basename), textureCapturer(capturer) {}
+    // The sections of a binary capture, see FrameIOFormat.h
+    std::vector<uint8_t> arrays;
+    std::vector<uint8_t> blobs;
+    std::unordered_multimap<uint, std::pair<size_t, size_t>> blobsByHash;  // the offset and size of each blob
+
+    Serializer(const std::string& basename, const TextureCapturer& capturer, FrameFormat format, FrameCompression compression) :
+        basename(basename), textureCapturer(capturer), format(format), compression(compression) {}
 
     template <typename T>
     static uint32_t getGlobalIndex(const T& value, std::unordered_map<T, uint32_t>& map) {
@@ -57,6 +70,31 @@ public:
         return result;
     }
 
+    // the cache's indices into the frame's table of T, written to the arrays section for binary captures
+    template <typename T>
+    json writePointerCache(const typename Batch::Cache<T>::Vector& cache, std::unordered_map<T, uint32_t>& map) {
+        if (format == FrameFormat::JSON) {
+            return serializePointerCache(cache, map);
+        }
+        std::vector<uint32_t> indices;
+        indices.reserve(cache._items.size());
+        for (const auto& cacheEntry : cache._items) {
+            indices.push_back(getGlobalIndex(cacheEntry._data, map));
+        }
+        return writeArray(indices.data(), indices.size());
+    }
+
+    // appends count elements to the arrays section, returning the [offset, count] reference to them
+    template <typename T>
+    json writeArray(const T* data, size_t count) {
+        size_t offset = arrays.size();
+        arrays.resize(offset + count * sizeof(T));
+        if (count > 0) {
+            memcpy(arrays.data() + offset, data, count * sizeof(T));
+        }
+        return json::array({ offset, count });
+    }
+
     template <typename T, typename TT = const T&>
     static json serializeDataCache(const typename Batch::Cache<T>::Vector& cache,
                                    std::function<TT(const T&)> f = [](const T& t) -> TT { return t; }) {
@@ -131,6 +169,12 @@ public:
 
     json writeCapturableTextures(const Frame& frame);
     void writeBinaryBlob();
+    void writeContainer(const json& frameNode);
+    json writeBlob(const uint8_t* data, size_t size);
+    json writeBuffer(const BufferPointer& bufferPointer);
+    json writeTexture(const TexturePointer& texture);
+    json writeStoredMips(const Texture& texture);
+    bool hasStoredMips(const Texture& texture) const;
     static std::string toBase64(const std::vector<uint8_t>& v);
     static json writeIrradiance(const SHPointer& irradiance);
     static json writeMat4(const glm::mat4& m) {
@@ -146,11 +190,9 @@ public:
     static json writeTransform(const Transform& t) { return writeMat4(t.getMatrix()); }
     static json writeCommand(size_t index, const Batch& batch);
     static json writeSampler(const Sampler& sampler);
-    static json writeTexture(const TexturePointer& texture);
     static json writeFormat(const Stream::FormatPointer& format);
     static json writeQuery(const QueryPointer& query);
     static json writeShader(const ShaderPointer& shader);
-    static json writeBuffer(const BufferPointer& bufferPointer);
 
     static const TextureView DEFAULT_TEXTURE_VIEW;
     static const Sampler DEFAULT_SAMPLER;
@@ -164,8 +206,9 @@ public:
     }
 };
 
-void writeFrame(const std::string& filename, const FramePointer& frame, const TextureCapturer& capturer) {
-    Serializer(filename, capturer).writeFrame(*frame);
+void writeFrame(const std::string& filename, const FramePointer& frame, const TextureCapturer& capturer,
+                FrameFormat format, FrameCompression compression) {
+    Serializer(filename, capturer, format, compression).writeFrame(*frame);
 }
 
 }  // namespace gpu
@@ -202,7 +245,11 @@ json Serializer::writeNamedBatchData(const Batch::NamedBatchData& namedData) {
     for (const auto& buffer : namedData.buffers) {
         buffersNode.push_back(getGlobalIndex(buffer, bufferMap));
     }
-    result[keys::drawCallInfos] = writeUintVector(namedData.drawCallInfos);
+    if (format == FrameFormat::BINARY) {
+        result[keys::drawCallInfos] = writeArray(namedData.drawCallInfos.data(), namedData.drawCallInfos.size());
+    } else {
+        result[keys::drawCallInfos] = writeUintVector(namedData.drawCallInfos);
+    }
     return result;
 }
 
@@ -227,37 +274,57 @@ json Serializer::writeBatch(const Batch& batch) {
         batchNode[keys::drawcallUniformReset] = batch._drawcallUniformReset;
     }
     if (0 != batch._textures.size()) {
-        batchNode[keys::textures] = serializePointerCache(batch._textures, textureMap);
+        batchNode[keys::textures] = writePointerCache(batch._textures, textureMap);
     }
     if (0 != batch._textureTables.size()) {
-        batchNode[keys::textureTables] = serializePointerCache(batch._textureTables, textureTableMap);
+        batchNode[keys::textureTables] = writePointerCache(batch._textureTables, textureTableMap);
     }
     if (0 != batch._buffers.size()) {
-        batchNode[keys::buffers] = serializePointerCache(batch._buffers, bufferMap);
+        batchNode[keys::buffers] = writePointerCache(batch._buffers, bufferMap);
     }
     if (0 != batch._pipelines.size()) {
-        batchNode[keys::pipelines] = serializePointerCache(batch._pipelines, pipelineMap);
+        batchNode[keys::pipelines] = writePointerCache(batch._pipelines, pipelineMap);
     }
     if (0 != batch._streamFormats.size()) {
-        batchNode[keys::formats] = serializePointerCache(batch._streamFormats, formatMap);
+        batchNode[keys::formats] = writePointerCache(batch._streamFormats, formatMap);
     }
     if (0 != batch._framebuffers.size()) {
-        batchNode[keys::framebuffers] = serializePointerCache(batch._framebuffers, framebufferMap);
+        batchNode[keys::framebuffers] = writePointerCache(batch._framebuffers, framebufferMap);
     }
     if (0 != batch._swapChains.size()) {
-        batchNode[keys::swapchains] = serializePointerCache(batch._swapChains, swapchainMap);
+        batchNode[keys::swapchains] = writePointerCache(batch._swapChains, swapchainMap);
     }
     if (0 != batch._queries.size()) {
-        batchNode[keys::queries] = serializePointerCache(batch._queries, queryMap);
+        batchNode[keys::queries] = writePointerCache(batch._queries, queryMap);
     }
     if (!batch._drawCallInfos.empty()) {
-        batchNode[keys::drawCallInfos] = writeUintVector(batch._drawCallInfos);
+        if (format == FrameFormat::BINARY) {
+            batchNode[keys::drawCallInfos] = writeArray(batch._drawCallInfos.data(), batch._drawCallInfos.size());
+        } else {
+            batchNode[keys::drawCallInfos] = writeUintVector(batch._drawCallInfos);
+        }
     }
     if (!batch._data.empty()) {
-        batchNode[keys::data] = toBase64(batch._data);
+        if (format == FrameFormat::BINARY) {
+            batchNode[keys::data] = writeArray(batch._data.data(), batch._data.size());
+        } else {
+            batchNode[keys::data] = toBase64(batch._data);
+        }
     }
 
-    {
+    if (format == FrameFormat::BINARY) {
+        // The commands are indices into the frame's command names, so captures survive changes to Batch::Command
+        std::vector<uint32_t> commands { batch._commands.begin(), batch._commands.end() };
+        std::vector<uint32_t> commandOffsets { batch._commandOffsets.begin(), batch._commandOffsets.end() };
+        std::vector<uint64_t> params;
+        params.reserve(batch._params.size());
+        for (const auto& param : batch._params) {
+            params.push_back(param._size);
+        }
+        batchNode[keys::commands] = writeArray(commands.data(), commands.size());
+        batchNode[keys::commandOffsets] = writeArray(commandOffsets.data(), commandOffsets.size());
+        batchNode[keys::params] = writeArray(params.data(), params.size());
+    } else {
         auto& node = batchNode[keys::commands] = json::array();
         size_t commandCount = batch._commands.size();
         for (size_t i = 0; i < commandCount; ++i) {
@@ -266,8 +333,17 @@ json Serializer::writeBatch(const Batch& batch) {
     }
 
     if (0 != batch._transforms.size()) {
-        batchNode[keys::transforms] =
-            serializeDataCache<Transform, json>(batch._transforms, [](const Transform& t) { return writeTransform(t); });
+        if (format == FrameFormat::BINARY) {
+            std::vector<glm::mat4> matrices;
+            matrices.reserve(batch._transforms.size());
+            for (const auto& cacheEntry : batch._transforms._items) {
+                matrices.push_back(cacheEntry._data.getMatrix());
+            }
+            batchNode[keys::transforms] = writeArray(matrices.data(), matrices.size());
+        } else {
+            batchNode[keys::transforms] =
+                serializeDataCache<Transform, json>(batch._transforms, [](const Transform& t) { return writeTransform(t); });
+        }
     }
     if (0 != batch._profileRanges.size()) {
         batchNode[keys::profileRanges] = serializeDataCache<std::string>(batch._profileRanges);
@@ -276,8 +352,17 @@ json Serializer::writeBatch(const Batch& batch) {
         batchNode[keys::names] = serializeDataCache<std::string>(batch._names);
     }
     if (0 != batch._objects.size()) {
-        auto transform = [](const Batch::TransformObject& object) -> json { return writeMat4(object._model); };
-        batchNode[keys::objects] = writeVector<Batch::TransformObject, json>(batch._objects, transform);
+        if (format == FrameFormat::BINARY) {
+            std::vector<glm::mat4> models;
+            models.reserve(batch._objects.size());
+            for (const auto& object : batch._objects) {
+                models.push_back(object._model);
+            }
+            batchNode[keys::objects] = writeArray(models.data(), models.size());
+        } else {
+            auto transform = [](const Batch::TransformObject& object) -> json { return writeMat4(object._model); };
+            batchNode[keys::objects] = writeVector<Batch::TransformObject, json>(batch._objects, transform);
+        }
     }
 
     if (!batch._namedData.empty()) {
@@ -332,9 +417,33 @@ json Serializer::writeBuffer(const BufferPointer& bufferPointer) {
         return json();
     }
 
+    if (format == FrameFormat::BINARY) {
+        const auto& buffer = *bufferPointer;
+        return writeBlob(buffer._renderSysmem.readData(), buffer.getSize());
+    }
     return json(bufferPointer->getSize());
 }
 
+json Serializer::writeBlob(const uint8_t* data, size_t size) {
+    // Identical buffers and textures are common (default textures, shared geometry), so only store each content once
+    uint hash = qHash(QByteArray::fromRawData((const char*)data, (int)size));
+    auto range = blobsByHash.equal_range(hash);
+    for (auto itr = range.first; itr != range.second; ++itr) {
+        const auto& blob = itr->second;
+        if (blob.second == size && (size == 0 || 0 == memcmp(blobs.data() + blob.first, data, size))) {
+            return json::array({ blob.first, size });
+        }
+    }
+
+    size_t offset = blobs.size();
+    blobs.resize(offset + size);
+    if (size > 0) {
+        memcpy(blobs.data() + offset, data, size);
+    }
+    blobsByHash.emplace(hash, std::make_pair(offset, size));
+    return json::array({ offset, size });
+}
+
 json Serializer::writeIrradiance(const SHPointer& irradiancePointer) {
     if (!irradiancePointer) {
         return json();
@@ -390,6 +499,9 @@ json Serializer::writeTexture(const TexturePointer& texturePointer) {
         const auto* ktxStorage = dynamic_cast<const Texture::KtxStorage*>(storage);
         if (ktxStorage) {
             result[keys::ktxFile] = ktxStorage->_filename;
+        } else if (hasStoredMips(texture)) {
+            result[keys::storedMipFormat] = texture.getStoredMipFormat().getRaw();
+            result[keys::storedMips] = writeStoredMips(texture);
         } else {
             // TODO serialize the backing storage
         }
@@ -397,6 +509,32 @@ json Serializer::writeTexture(const TexturePointer& texturePointer) {
     return result;
 }
 
+bool Serializer::hasStoredMips(const Texture& texture) const {
+    // Binary captures hold the mips of textures created from memory, the others need the texture capturer
+    if (format != FrameFormat::BINARY) {
+        return false;
+    }
+    const auto* memoryStorage = dynamic_cast<const Texture::MemoryStorage*>(texture._storage.get());
+    return memoryStorage && texture.isStoredMipFaceAvailable(0);
+}
+
+json Serializer::writeStoredMips(const Texture& texture) {
+    json result = json::array();
+    const uint16 mips = texture._maxMipLevel + 1;
+    const uint8 faces = texture.getNumFaces();
+    for (uint16 level = 0; level < mips; ++level) {
+        for (uint8 face = 0; face < faces; ++face) {
+            if (!texture.isStoredMipFaceAvailable(level, face)) {
+                continue;
+            }
+            const auto pixels = texture.accessStoredMipFace(level, face);
+            auto blob = writeBlob(pixels->readData(), pixels->getSize());
+            result.push_back(json::array({ level, face, blob[0], blob[1] }));
+        }
+    }
+    return result;
+}
+
 json Serializer::writeTextureView(const TextureView& textureView) {
     static const auto DEFAULT_TEXTURE_VIEW = TextureView();
     json result = json::object();
@@ -750,7 +888,7 @@ json Serializer::writeCapturableTextures(const Frame& frame) {
         if (usageType == TextureUsageType::RESOURCE || usageType == TextureUsageType::STRICT_RESOURCE) {
             const auto* storage = texture._storage.get();
             const auto* ktxStorage = dynamic_cast<const Texture::KtxStorage*>(storage);
-            if (!ktxStorage) {
+            if (!ktxStorage && !hasStoredMips(texture)) {
                 captureTextures.insert(texturePointer);
             }
         }
@@ -797,13 +935,22 @@ void Serializer::writeFrame(const Frame& frame) {
 
     // Serialize textures and buffers last, since the maps they use can be populated by some of the above code
     // Serialize textures
-    serializeMap(frameNode, keys::textures, textureMap, writeTexture);
+    serializeMap(frameNode, keys::textures, textureMap, [this](const auto& t) { return writeTexture(t); });
     // Serialize buffers
-    serializeMap(frameNode, keys::buffers, bufferMap, writeBuffer);
+    serializeMap(frameNode, keys::buffers, bufferMap, [this](const auto& t) { return writeBuffer(t); });
+
+    if (format == FrameFormat::BINARY) {
+        auto& commandNamesNode = frameNode[keys::commandNames] = json::array();
+        for (const auto& commandName : keys::COMMAND_NAMES) {
+            commandNamesNode.push_back(commandName);
+        }
+        writeContainer(frameNode);
+        return;
+    }
 
     {
         std::string frameJson = frameNode.dump();
-        std::string filename = basename + ".json";
+        std::string filename = basename + frameio::JSON_EXTENSION;
         storage::FileStorage::create(filename.c_str(), frameJson.size(), (const uint8_t*)frameJson.data());
     }
 
@@ -811,6 +958,55 @@ void Serializer::writeFrame(const Frame& frame) {
     frameNode[keys::binary] = basename + ".bin";
 }
 
+void Serializer::writeContainer(const json& frameNode) {
+    const std::vector<uint8_t> description = json::to_msgpack(frameNode);
+    const std::vector<uint8_t>* contents[frameio::NUM_SECTIONS];
+    contents[frameio::DESCRIPTION] = &description;
+    contents[frameio::ARRAYS] = &arrays;
+    contents[frameio::BLOBS] = &blobs;
+
+    frameio::Header header;
+    if (compression == FrameCompression::ZLIB) {
+        header.flags |= frameio::ZLIB_COMPRESSED;
+    }
+
+    frameio::SectionEntry sections[frameio::NUM_SECTIONS];
+    QByteArray compressed[frameio::NUM_SECTIONS];
+    uint64_t offset = sizeof(header) + sizeof(sections);
+    for (uint32_t i = 0; i < frameio::NUM_SECTIONS; ++i) {
+        const auto& content = *contents[i];
+        auto& section = sections[i];
+        section.offset = offset;
+        section.size = content.size();
+        section.storedSize = content.size();
+        // qCompress is limited to int sizes, larger sections and those that don't shrink are stored as they are
+        if (compression == FrameCompression::ZLIB && !content.empty() && content.size() < (size_t)INT_MAX) {
+            compressed[i] = qCompress(content.data(), (int)content.size());
+            if ((size_t)compressed[i].size() < content.size()) {
+                section.storedSize = compressed[i].size();
+            } else {
+                compressed[i].clear();
+            }
+        }
+        offset += section.storedSize;
+    }
+
+    const auto filename = basename + frameio::EXTENSION;
+    QFile file(filename.c_str());
+    if (!file.open(QFile::WriteOnly | QIODevice::Truncate)) {
+        throw std::runtime_error("Unable to open file for writing");
+    }
+    bool written = file.write((const char*)&header, sizeof(header)) == sizeof(header);
+    written = written && file.write((const char*)sections, sizeof(sections)) == sizeof(sections);
+    for (uint32_t i = 0; written && i < frameio::NUM_SECTIONS; ++i) {
+        const char* data = compressed[i].isEmpty() ? (const char*)contents[i]->data() : compressed[i].constData();
+        written = file.write(data, sections[i].storedSize) == (qint64)sections[i].storedSize;
+    }
+    if (!written) {
+        throw std::runtime_error("Unable to write frame");
+    }
+}
+
 void Serializer::writeBinaryBlob() {
     const auto buffers = mapToVector(bufferMap);
     auto accumulator = [](size_t total, const BufferPointer& buffer) { return total + (buffer ? buffer->getSize() : 0); };
@@ -19,6 +19,7 @@
 #include "CalculateMeshTangentsTask.h"
 #include "CalculateBlendshapeNormalsTask.h"
 #include "CalculateBlendshapeTangentsTask.h"
+#include "OptimizeMeshTask.h"
 #include "PrepareJointsTask.h"
 
 namespace baker {
@@ -126,13 +127,19 @@ namespace baker {
 
             // Split up the inputs from hfm::Model
             const auto modelPartsIn = model.addJob<GetModelPartsTask>("GetModelParts", hfmModelIn);
-            const auto meshesIn = modelPartsIn.getN<GetModelPartsTask::Output>(0);
+            const auto unoptimizedMeshes = modelPartsIn.getN<GetModelPartsTask::Output>(0);
             const auto url = modelPartsIn.getN<GetModelPartsTask::Output>(1);
             const auto meshIndicesToModelNames = modelPartsIn.getN<GetModelPartsTask::Output>(2);
-            const auto blendshapesPerMeshIn = modelPartsIn.getN<GetModelPartsTask::Output>(3);
+            const auto unoptimizedBlendshapesPerMesh = modelPartsIn.getN<GetModelPartsTask::Output>(3);
             const auto materials = modelPartsIn.getN<GetModelPartsTask::Output>(4);
             const auto jointsIn = modelPartsIn.getN<GetModelPartsTask::Output>(5);
 
+            // Reorder the mesh triangles and vertices for the GPU's vertex cache and vertex fetch, before anything is calculated from them
+            const auto optimizeMeshInputs = OptimizeMeshTask::Input(unoptimizedMeshes, unoptimizedBlendshapesPerMesh).asVarying();
+            const auto optimizedMeshParts = model.addJob<OptimizeMeshTask>("OptimizeMesh", optimizeMeshInputs);
+            const auto meshesIn = optimizedMeshParts.getN<OptimizeMeshTask::Output>(0);
+            const auto blendshapesPerMeshIn = optimizedMeshParts.getN<OptimizeMeshTask::Output>(1);
+
             // Calculate normals and tangents for meshes and blendshapes if they do not exist
             // Note: Normals are never calculated here for OBJ models. OBJ files optionally define normals on a per-face basis, so for consistency normals are calculated beforehand in OBJSerializer.
             const auto normalsPerMesh = model.addJob<CalculateMeshNormalsTask>("CalculateMeshNormals", meshesIn);
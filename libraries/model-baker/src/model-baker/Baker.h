@@ -25,6 +25,9 @@ namespace baker {
     public:
         Baker(const hfm::Model::Pointer& hfmModel, const QVariantHash& mapping);
 
+        // The configuration of the bake jobs, edit before run() is called
+        std::shared_ptr<TaskConfig> getConfiguration() { return _engine->getConfiguration(); }
+
         void run();
 
         // Outputs, available after run() is called
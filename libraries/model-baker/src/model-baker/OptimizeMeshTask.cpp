@@ -0,0 +1,492 @@
+//
+//  OptimizeMeshTask.cpp
+//  model-baker/src/model-baker
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "OptimizeMeshTask.h"
+
+#include <algorithm>
+#include <cmath>
+
+const int INDICES_PER_TRIANGLE = 3;
+const int INDICES_PER_QUAD = 4;
+const int TRIANGLE_INDICES_PER_QUAD = 6;
+
+// Tom Forsyth's "Linear-Speed Vertex Cache Optimisation", scored with an LRU cache
+const int SCORING_CACHE_SIZE = 32;
+const float CACHE_DECAY_POWER = 1.5f;
+const float LAST_PRIMITIVE_SCORE = 0.75f;
+const float VALENCE_BOOST_SCALE = 2.0f;
+
+void baker::VertexCacheStats::add(const VertexCacheStats& other) {
+    numTriangles += other.numTriangles;
+    numVertices += other.numVertices;
+    numTransforms += other.numTransforms;
+}
+
+void OptimizeMeshConfig::setStats(const baker::VertexCacheStats& before, const baker::VertexCacheStats& after, int numMeshlets) {
+    _statsBefore = before;
+    _statsAfter = after;
+    _numMeshlets = numMeshlets;
+}
+
+namespace {
+
+// The primitives using each vertex of a list of primitives
+class PrimitiveAdjacency {
+public:
+    PrimitiveAdjacency(const std::vector<int>& indices, int primitiveSize, int numVertices) :
+        offsets(numVertices + 1, 0),
+        counts(numVertices, 0),
+        primitives(indices.size()) {
+        for (int index : indices) {
+            counts[index]++;
+        }
+        for (int i = 0; i < numVertices; i++) {
+            offsets[i + 1] = offsets[i] + counts[i];
+        }
+        std::vector<int> ends(offsets.begin(), offsets.end() - 1);
+        for (int i = 0; i < (int)indices.size(); i++) {
+            primitives[ends[indices[i]]++] = i / primitiveSize;
+        }
+    }
+
+    std::vector<int> offsets;
+    std::vector<int> counts;
+    std::vector<int> primitives;
+};
+
+// renumbers the vertices of a primitive list from 0, in the order they're used
+int makeLocalIndices(const QVector<int>& indices, int numVertices, std::vector<int>& localIndices, std::vector<int>& vertexToLocal) {
+    localIndices.resize(indices.size());
+    int numLocalVertices = 0;
+    for (int i = 0; i < indices.size(); i++) {
+        int index = indices[i];
+        if (index < 0 || index >= numVertices) {
+            for (int j = 0; j < i; j++) {
+                vertexToLocal[indices[j]] = -1;
+            }
+            return -1;
+        }
+        if (vertexToLocal[index] < 0) {
+            vertexToLocal[index] = numLocalVertices++;
+        }
+        localIndices[i] = vertexToLocal[index];
+    }
+    for (int index : indices) {
+        vertexToLocal[index] = -1;
+    }
+    return numLocalVertices;
+}
+
+float getVertexScore(int cachePosition, int valence, int primitiveSize) {
+    if (valence == 0) {
+        return -1.0f;
+    }
+    float score = 0.0f;
+    if (cachePosition >= 0) {
+        if (cachePosition < primitiveSize) {
+            // the vertices of the last primitive are scored the same so that strips aren't preferred
+            score = LAST_PRIMITIVE_SCORE;
+        } else {
+            float scale = 1.0f / (float)(SCORING_CACHE_SIZE - primitiveSize);
+            score = powf(1.0f - (float)(cachePosition - primitiveSize) * scale, CACHE_DECAY_POWER);
+        }
+    }
+    // boost the vertices with few primitives left so that lone primitives aren't left behind
+    score += VALENCE_BOOST_SCALE / sqrtf((float)valence);
+    return score;
+}
+
+// returns the order to draw the primitives in
+std::vector<int> optimizeVertexCache(const std::vector<int>& indices, int primitiveSize, int numVertices) {
+    int numPrimitives = (int)indices.size() / primitiveSize;
+    PrimitiveAdjacency adjacency(indices, primitiveSize, numVertices);
+    auto& valences = adjacency.counts; // the primitives not yet drawn, at the start of each vertex's adjacency
+
+    std::vector<float> vertexScores(numVertices);
+    for (int i = 0; i < numVertices; i++) {
+        vertexScores[i] = getVertexScore(-1, valences[i], primitiveSize);
+    }
+
+    int bestPrimitive = -1;
+    float bestScore = -1.0f;
+    for (int i = 0; i < numPrimitives; i++) {
+        float score = 0.0f;
+        for (int j = 0; j < primitiveSize; j++) {
+            score += vertexScores[indices[i * primitiveSize + j]];
+        }
+        if (score > bestScore) {
+            bestScore = score;
+            bestPrimitive = i;
+        }
+    }
+
+    std::vector<bool> drawn(numPrimitives, false);
+    std::vector<int> order;
+    order.reserve(numPrimitives);
+    int cache[SCORING_CACHE_SIZE + INDICES_PER_QUAD];
+    int newCache[SCORING_CACHE_SIZE + INDICES_PER_QUAD];
+    int cacheSize = 0;
+    int nextPrimitive = 0;
+
+    while ((int)order.size() < numPrimitives) {
+        if (bestPrimitive < 0) {
+            // nothing in the cache is left to draw, carry on from the next primitive in the original order
+            while (drawn[nextPrimitive]) {
+                nextPrimitive++;
+            }
+            bestPrimitive = nextPrimitive;
+        }
+        drawn[bestPrimitive] = true;
+        order.push_back(bestPrimitive);
+
+        const int* primitive = &indices[bestPrimitive * primitiveSize];
+        int newCacheSize = 0;
+        for (int i = 0; i < primitiveSize; i++) {
+            int vertex = primitive[i];
+            int begin = adjacency.offsets[vertex];
+            int end = begin + valences[vertex];
+            for (int j = begin; j < end; j++) {
+                if (adjacency.primitives[j] == bestPrimitive) {
+                    adjacency.primitives[j] = adjacency.primitives[end - 1];
+                    adjacency.primitives[end - 1] = bestPrimitive;
+                    break;
+                }
+            }
+            valences[vertex]--;
+            if (std::find(newCache, newCache + newCacheSize, vertex) == newCache + newCacheSize) {
+                newCache[newCacheSize++] = vertex;
+            }
+        }
+        int primitiveVertices = newCacheSize;
+        for (int i = 0; i < cacheSize; i++) {
+            if (std::find(newCache, newCache + primitiveVertices, cache[i]) == newCache + primitiveVertices) {
+                newCache[newCacheSize++] = cache[i];
+            }
+        }
+
+        // rescore the vertices that moved in the cache, including those pushed out of it
+        for (int i = 0; i < newCacheSize; i++) {
+            int vertex = newCache[i];
+            int position = i < SCORING_CACHE_SIZE ? i : -1;
+            vertexScores[vertex] = getVertexScore(position, valences[vertex], primitiveSize);
+        }
+
+        // then the primitives left to draw that use them
+        bestPrimitive = -1;
+        bestScore = -1.0f;
+        for (int i = 0; i < newCacheSize; i++) {
+            int vertex = newCache[i];
+            int begin = adjacency.offsets[vertex];
+            int end = begin + valences[vertex];
+            for (int j = begin; j < end; j++) {
+                int adjacent = adjacency.primitives[j];
+                float score = 0.0f;
+                for (int k = 0; k < primitiveSize; k++) {
+                    score += vertexScores[indices[adjacent * primitiveSize + k]];
+                }
+                if (score > bestScore) {
+                    bestScore = score;
+                    bestPrimitive = adjacent;
+                }
+            }
+        }
+
+        cacheSize = std::min(newCacheSize, SCORING_CACHE_SIZE);
+        std::copy(newCache, newCache + cacheSize, cache);
+    }
+    return order;
+}
+
+// Groups the primitives into meshlets of at most maxVertices vertices and maxPrimitives primitives. Each meshlet starts
+// from the next primitive in order and grows through the primitives adding the fewest vertices to it.
+// returns the order to draw the primitives in
+std::vector<int> buildMeshlets(const std::vector<int>& indices, int primitiveSize, int numVertices, const std::vector<int>& order,
+        int maxVertices, int maxPrimitives, int& numMeshlets) {
+    int numPrimitives = (int)indices.size() / primitiveSize;
+    PrimitiveAdjacency adjacency(indices, primitiveSize, numVertices);
+
+    std::vector<int> vertexMeshlets(numVertices, -1);
+    std::vector<int> meshletVertices;
+    meshletVertices.reserve(maxVertices);
+    std::vector<bool> drawn(numPrimitives, false);
+    std::vector<int> meshletOrder;
+    meshletOrder.reserve(numPrimitives);
+    int nextPrimitive = 0;
+    int meshlet = 0;
+
+    while ((int)meshletOrder.size() < numPrimitives) {
+        while (drawn[order[nextPrimitive]]) {
+            nextPrimitive++;
+        }
+        meshletVertices.clear();
+        int meshletPrimitives = 0;
+        int primitive = order[nextPrimitive];
+        while (primitive >= 0) {
+            drawn[primitive] = true;
+            meshletOrder.push_back(primitive);
+            meshletPrimitives++;
+            for (int i = 0; i < primitiveSize; i++) {
+                int vertex = indices[primitive * primitiveSize + i];
+                if (vertexMeshlets[vertex] != meshlet) {
+                    vertexMeshlets[vertex] = meshlet;
+                    meshletVertices.push_back(vertex);
+                }
+            }
+            if (meshletPrimitives >= maxPrimitives) {
+                break;
+            }
+
+            // a primitive repeating a new vertex counts it twice, which only ever closes the meshlet early
+            primitive = -1;
+            int fewestNewVertices = primitiveSize + 1;
+            for (int i = 0; i < (int)meshletVertices.size() && fewestNewVertices > 0; i++) {
+                int vertex = meshletVertices[i];
+                int begin = adjacency.offsets[vertex];
+                int end = adjacency.offsets[vertex + 1];
+                for (int j = begin; j < end; j++) {
+                    int adjacent = adjacency.primitives[j];
+                    if (drawn[adjacent]) {
+                        continue;
+                    }
+                    int newVertices = 0;
+                    for (int k = 0; k < primitiveSize; k++) {
+                        if (vertexMeshlets[indices[adjacent * primitiveSize + k]] != meshlet) {
+                            newVertices++;
+                        }
+                    }
+                    if (newVertices < fewestNewVertices) {
+                        fewestNewVertices = newVertices;
+                        primitive = adjacent;
+                        if (newVertices == 0) {
+                            break;
+                        }
+                    }
+                }
+            }
+            if ((int)meshletVertices.size() + fewestNewVertices > maxVertices) {
+                primitive = -1;
+            }
+        }
+        meshlet++;
+    }
+    numMeshlets += meshlet;
+    return meshletOrder;
+}
+
+// reorders the primitives of indices, and of the matching triangulated quads if there are any
+int optimizePrimitiveOrder(QVector<int>& indices, QVector<int>* quadTriangleIndices, int primitiveSize, int numVertices,
+        std::vector<int>& vertexToLocal, const OptimizeMeshTask::Options& options) {
+    int numPrimitives = indices.size() / primitiveSize;
+    if (numPrimitives < 2 || indices.size() != numPrimitives * primitiveSize) {
+        return 0;
+    }
+    std::vector<int> localIndices;
+    int numLocalVertices = makeLocalIndices(indices, numVertices, localIndices, vertexToLocal);
+    if (numLocalVertices < 0) {
+        return 0;
+    }
+
+    std::vector<int> order;
+    if (options.reorderTriangles) {
+        order = optimizeVertexCache(localIndices, primitiveSize, numLocalVertices);
+    } else {
+        order.resize(numPrimitives);
+        for (int i = 0; i < numPrimitives; i++) {
+            order[i] = i;
+        }
+    }
+    int numMeshlets = 0;
+    int trianglesPerPrimitive = primitiveSize - 2;
+    if (options.maxMeshletVertices >= primitiveSize && options.maxMeshletTriangles >= trianglesPerPrimitive) {
+        order = buildMeshlets(localIndices, primitiveSize, numLocalVertices, order,
+            options.maxMeshletVertices, options.maxMeshletTriangles / trianglesPerPrimitive, numMeshlets);
+    }
+
+    QVector<int> reordered(indices.size());
+    for (int i = 0; i < numPrimitives; i++) {
+        std::copy(indices.constData() + order[i] * primitiveSize, indices.constData() + (order[i] + 1) * primitiveSize,
+            reordered.data() + i * primitiveSize);
+    }
+    indices.swap(reordered);
+
+    if (quadTriangleIndices) {
+        QVector<int> reorderedTriangles(quadTriangleIndices->size());
+        for (int i = 0; i < numPrimitives; i++) {
+            const int* quadTriangles = quadTriangleIndices->constData() + order[i] * TRIANGLE_INDICES_PER_QUAD;
+            std::copy(quadTriangles, quadTriangles + TRIANGLE_INDICES_PER_QUAD, reorderedTriangles.data() + i * TRIANGLE_INDICES_PER_QUAD);
+        }
+        quadTriangleIndices->swap(reorderedTriangles);
+    }
+    return numMeshlets;
+}
+
+void assignVertexIndices(const QVector<int>& indices, std::vector<int>& newIndices, int& numAssigned) {
+    int numVertices = (int)newIndices.size();
+    for (int index : indices) {
+        if (index >= 0 && index < numVertices && newIndices[index] < 0) {
+            newIndices[index] = numAssigned++;
+        }
+    }
+}
+
+void remapIndices(QVector<int>& indices, const std::vector<int>& newIndices) {
+    int numVertices = (int)newIndices.size();
+    for (int& index : indices) {
+        if (index >= 0 && index < numVertices) {
+            index = newIndices[index];
+        }
+    }
+}
+
+template <typename T>
+void remapVertexAttribute(QVector<T>& attribute, const std::vector<int>& newIndices, int stride = 1) {
+    int numVertices = (int)newIndices.size();
+    if (stride < 1 || attribute.size() != numVertices * stride) {
+        return;
+    }
+    QVector<T> remapped(attribute.size());
+    const T* source = attribute.constData();
+    T* destination = remapped.data();
+    for (int i = 0; i < numVertices; i++) {
+        std::copy(source + i * stride, source + (i + 1) * stride, destination + newIndices[i] * stride);
+    }
+    attribute.swap(remapped);
+}
+
+// renumbers the vertices in the order they're drawn, those only used by blendshapes or not at all go last
+void reorderVertices(hfm::Mesh& mesh, baker::Blendshapes& blendshapes) {
+    int numVertices = mesh.vertices.size();
+    std::vector<int> newIndices(numVertices, -1);
+    int numAssigned = 0;
+    for (const auto& part : mesh.parts) {
+        assignVertexIndices(part.quadTrianglesIndices, newIndices, numAssigned);
+        assignVertexIndices(part.triangleIndices, newIndices, numAssigned);
+    }
+    for (const auto& part : mesh.parts) {
+        assignVertexIndices(part.quadIndices, newIndices, numAssigned);
+    }
+    bool reordered = false;
+    for (int i = 0; i < numVertices; i++) {
+        if (newIndices[i] < 0) {
+            newIndices[i] = numAssigned++;
+        }
+        reordered |= (newIndices[i] != i);
+    }
+    if (!reordered) {
+        return;
+    }
+
+    for (auto& part : mesh.parts) {
+        remapIndices(part.quadIndices, newIndices);
+        remapIndices(part.quadTrianglesIndices, newIndices);
+        remapIndices(part.triangleIndices, newIndices);
+    }
+    for (auto& blendshape : blendshapes) {
+        remapIndices(blendshape.indices, newIndices);
+    }
+
+    remapVertexAttribute(mesh.vertices, newIndices);
+    remapVertexAttribute(mesh.normals, newIndices);
+    remapVertexAttribute(mesh.tangents, newIndices);
+    remapVertexAttribute(mesh.colors, newIndices);
+    remapVertexAttribute(mesh.texCoords, newIndices);
+    remapVertexAttribute(mesh.texCoords1, newIndices);
+    remapVertexAttribute(mesh.originalIndices, newIndices);
+    if (numVertices > 0) {
+        remapVertexAttribute(mesh.clusterIndices, newIndices, mesh.clusterIndices.size() / numVertices);
+        remapVertexAttribute(mesh.clusterWeights, newIndices, mesh.clusterWeights.size() / numVertices);
+    }
+}
+
+void measureIndices(const QVector<int>& indices, int cacheSize, std::vector<int>& insertionTimes, int& time, baker::VertexCacheStats& stats) {
+    int numVertices = (int)insertionTimes.size();
+    for (int index : indices) {
+        if (index < 0 || index >= numVertices) {
+            continue;
+        }
+        int& insertionTime = insertionTimes[index];
+        if (insertionTime < 0) {
+            stats.numVertices++;
+        }
+        if (insertionTime < 0 || time - insertionTime >= cacheSize) {
+            insertionTime = time++;
+            stats.numTransforms++;
+        }
+    }
+    stats.numTriangles += indices.size() / INDICES_PER_TRIANGLE;
+}
+
+}
+
+baker::VertexCacheStats OptimizeMeshTask::measureVertexCache(const hfm::Mesh& mesh, int cacheSize) {
+    baker::VertexCacheStats stats;
+    cacheSize = std::max(cacheSize, INDICES_PER_TRIANGLE);
+    std::vector<int> insertionTimes(mesh.vertices.size(), -1);
+    int time = 0;
+    for (const auto& part : mesh.parts) {
+        measureIndices(part.quadTrianglesIndices, cacheSize, insertionTimes, time, stats);
+        measureIndices(part.triangleIndices, cacheSize, insertionTimes, time, stats);
+        // each part is a separate draw, which starts with an empty cache
+        time += cacheSize;
+    }
+    return stats;
+}
+
+int OptimizeMeshTask::optimizeMesh(hfm::Mesh& mesh, baker::Blendshapes& blendshapes, const Options& options) {
+    int numVertices = mesh.vertices.size();
+    int numMeshlets = 0;
+    std::vector<int> vertexToLocal(numVertices, -1);
+    for (auto& part : mesh.parts) {
+        // the quads are kept whole, with their triangles following them
+        int numQuads = part.quadIndices.size() / INDICES_PER_QUAD;
+        if (part.quadTrianglesIndices.size() == numQuads * TRIANGLE_INDICES_PER_QUAD) {
+            numMeshlets += optimizePrimitiveOrder(part.quadIndices, &part.quadTrianglesIndices, INDICES_PER_QUAD, numVertices,
+                vertexToLocal, options);
+        }
+        numMeshlets += optimizePrimitiveOrder(part.triangleIndices, nullptr, INDICES_PER_TRIANGLE, numVertices,
+            vertexToLocal, options);
+    }
+    if (options.reorderVertices) {
+        reorderVertices(mesh, blendshapes);
+    }
+    return numMeshlets;
+}
+
+void OptimizeMeshTask::configure(const Config& config) {
+    _options.reorderTriangles = config.reorderTriangles;
+    _options.reorderVertices = config.reorderVertices;
+    _options.maxMeshletVertices = config.maxMeshletVertices;
+    _options.maxMeshletTriangles = config.maxMeshletTriangles;
+    _cacheSize = config.cacheSize;
+}
+
+void OptimizeMeshTask::run(const baker::BakeContextPointer& context, const Input& input, Output& output) {
+    const auto& meshesIn = input.get0();
+    const auto& blendshapesPerMeshIn = input.get1();
+    auto& meshesOut = output.edit0();
+    auto& blendshapesPerMeshOut = output.edit1();
+
+    meshesOut = meshesIn;
+    blendshapesPerMeshOut = blendshapesPerMeshIn;
+    blendshapesPerMeshOut.resize(meshesOut.size());
+
+    baker::VertexCacheStats statsBefore;
+    baker::VertexCacheStats statsAfter;
+    int numMeshlets = 0;
+    for (int i = 0; i < (int)meshesOut.size(); i++) {
+        auto& mesh = meshesOut[i];
+        statsBefore.add(measureVertexCache(mesh, _cacheSize));
+        numMeshlets += optimizeMesh(mesh, blendshapesPerMeshOut[i], _options);
+        statsAfter.add(measureVertexCache(mesh, _cacheSize));
+    }
+
+    auto config = std::static_pointer_cast<Config>(context->jobConfig);
+    config->setStats(statsBefore, statsAfter, numMeshlets);
+}
@@ -0,0 +1,106 @@
+//
+//  OptimizeMeshTask.h
+//  model-baker/src/model-baker
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_OptimizeMeshTask_h
+#define hifi_OptimizeMeshTask_h
+
+#include <hfm/HFM.h>
+
+#include "Engine.h"
+#include "BakerTypes.h"
+
+namespace baker {
+    // How well a mesh's triangles use a FIFO post-transform vertex cache
+    class VertexCacheStats {
+    public:
+        int numTriangles { 0 };
+        int numVertices { 0 }; // the vertices referenced by the triangles
+        int numTransforms { 0 }; // the cache misses
+
+        // average cache miss ratio, transforms per triangle, 0.5 at best
+        float getACMR() const { return numTriangles > 0 ? (float)numTransforms / (float)numTriangles : 0.0f; }
+        // average transform to vertex ratio, 1.0 at best
+        float getATVR() const { return numVertices > 0 ? (float)numTransforms / (float)numVertices : 0.0f; }
+
+        void add(const VertexCacheStats& other);
+    };
+};
+
+class OptimizeMeshConfig : public baker::JobConfig {
+    Q_OBJECT
+    Q_PROPERTY(bool reorderTriangles MEMBER reorderTriangles NOTIFY dirty)
+    Q_PROPERTY(bool reorderVertices MEMBER reorderVertices NOTIFY dirty)
+    Q_PROPERTY(int maxMeshletVertices MEMBER maxMeshletVertices NOTIFY dirty)
+    Q_PROPERTY(int maxMeshletTriangles MEMBER maxMeshletTriangles NOTIFY dirty)
+    Q_PROPERTY(int cacheSize MEMBER cacheSize NOTIFY dirty)
+    Q_PROPERTY(float acmrBefore READ getACMRBefore)
+    Q_PROPERTY(float acmrAfter READ getACMRAfter)
+    Q_PROPERTY(float atvrBefore READ getATVRBefore)
+    Q_PROPERTY(float atvrAfter READ getATVRAfter)
+    Q_PROPERTY(int numMeshlets READ getNumMeshlets)
+public:
+    bool reorderTriangles { true };
+    bool reorderVertices { true };
+    int maxMeshletVertices { 0 }; // 0 doesn't partition the triangles into meshlets
+    int maxMeshletTriangles { 126 };
+    int cacheSize { 16 }; // of the FIFO cache the stats are measured with
+
+    float getACMRBefore() const { return _statsBefore.getACMR(); }
+    float getACMRAfter() const { return _statsAfter.getACMR(); }
+    float getATVRBefore() const { return _statsBefore.getATVR(); }
+    float getATVRAfter() const { return _statsAfter.getATVR(); }
+    int getNumMeshlets() const { return _numMeshlets; }
+
+    const baker::VertexCacheStats& getStatsBefore() const { return _statsBefore; }
+    const baker::VertexCacheStats& getStatsAfter() const { return _statsAfter; }
+    void setStats(const baker::VertexCacheStats& before, const baker::VertexCacheStats& after, int numMeshlets);
+
+signals:
+    void dirty();
+
+protected:
+    baker::VertexCacheStats _statsBefore;
+    baker::VertexCacheStats _statsAfter;
+    int _numMeshlets { 0 };
+};
+
+// Reorder the triangles of each mesh part for the post-transform vertex cache, optionally grouped into meshlets, then
+// renumber the vertices in the order the triangles first use them so that they are fetched sequentially
+class OptimizeMeshTask {
+public:
+    class Options {
+    public:
+        bool reorderTriangles { true };
+        bool reorderVertices { true };
+        int maxMeshletVertices { 0 };
+        int maxMeshletTriangles { 126 };
+    };
+
+    using Config = OptimizeMeshConfig;
+    using Input = baker::VaryingSet2<std::vector<hfm::Mesh>, baker::BlendshapesPerMesh>;
+    using Output = baker::VaryingSet2<std::vector<hfm::Mesh>, baker::BlendshapesPerMesh>;
+    using JobModel = baker::Job::ModelIO<OptimizeMeshTask, Input, Output, Config>;
+
+    // simulates drawing the mesh parts, quads then triangles, through a FIFO cache of cacheSize vertices
+    static baker::VertexCacheStats measureVertexCache(const hfm::Mesh& mesh, int cacheSize);
+
+    // optimizes the mesh in place, remapping the blendshape indices to the new vertices
+    // returns the number of meshlets, 0 if they aren't enabled by the options
+    static int optimizeMesh(hfm::Mesh& mesh, baker::Blendshapes& blendshapes, const Options& options);
+
+    void configure(const Config& config);
+    void run(const baker::BakeContextPointer& context, const Input& input, Output& output);
+
+protected:
+    Options _options;
+    int _cacheSize { 16 };
+};
+
+#endif // hifi_OptimizeMeshTask_h
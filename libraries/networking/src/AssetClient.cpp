@@ -508,6 +508,9 @@ void AssetClient::handleAssetGetReply(QSharedPointer<ReceivedMessage> message, S
     AssetUtils::DataOffset length = 0;
     if (!error) {
         message->readHeadPrimitive(&length);
+        if (length <= AssetUtils::MAX_UPLOAD_SIZE) {
+            message->reserve(message->getPosition() + length);
+        }
     } else {
         qCWarning(asset_client) << "Failure getting asset: " << error;
     }
@@ -549,7 +552,7 @@ void AssetClient::handleAssetGetReply(QSharedPointer<ReceivedMessage> message, S
         if (length != message->getBytesLeftToRead()) {
             callbacks.completeCallback(false, error, QByteArray());
         } else {
-            callbacks.completeCallback(true, error, message->readAll());
+            callbacks.completeCallback(true, error, message->takeAll());
         }
 
 
@@ -620,7 +623,7 @@ void AssetClient::handleCompleteCallback(const QWeakPointer<Node>& node, Message
     if (message->failed() || length != message->getBytesLeftToRead()) {
         callbacks.completeCallback(false, AssetUtils::AssetServerError::NoError, QByteArray());
     } else {
-        callbacks.completeCallback(true, AssetUtils::AssetServerError::NoError, message->readAll());
+        callbacks.completeCallback(true, AssetUtils::AssetServerError::NoError, message->takeAll());
     }
 
     // We should never get to this point without the associated senderNode and messageID
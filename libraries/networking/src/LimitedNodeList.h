@@ -300,6 +300,7 @@ public:
     void setConnectionMaxBandwidth(int maxBandwidth) { _nodeSocket.setConnectionMaxBandwidth(maxBandwidth); }
 
     void setPacketFilterOperator(udt::PacketFilterOperator filterOperator) { _nodeSocket.setPacketFilterOperator(filterOperator); }
+    void setDatagramSinkOperator(udt::DatagramSinkOperator sinkOperator) { _nodeSocket.setDatagramSinkOperator(sinkOperator); }
     bool packetVersionMatch(const udt::Packet& packet);
 
     bool isPacketVerifiedWithSource(const udt::Packet& packet, Node* sourceNode = nullptr);
@@ -70,6 +70,12 @@ void ReceivedMessage::appendPacket(NLPacket& packet) {
 
     ++_numPackets;
 
+    // reserve on this thread, the handler may not touch _data while the message is incomplete
+    qint64 reservedSize = _reservedSize;
+    if (reservedSize > _data.capacity()) {
+        _data.reserve((int)reservedSize);
+    }
+
     _data.append(packet.getPayload(), packet.getPayloadSize());
 
     if (_numPackets % EMIT_PROGRESS_EVERY_X_PACKETS == 0) {
@@ -134,6 +140,22 @@ QByteArray ReceivedMessage::readWithoutCopy(qint64 size) {
     return data;
 }
 
+QByteArray ReceivedMessage::takeAll() {
+    Q_ASSERT_X(_isComplete, "ReceivedMessage::takeAll", "Taking the data of an incomplete message");
+
+    // Drop what was already read in place. This memmoves the unread data to the front of the buffer, but does not
+    // allocate a second copy of it. A fromRawData() view at _position would avoid the move, but the data outlives the
+    // message (AssetRequest keeps it), and a QByteArray can't keep the buffer it views alive.
+    if (_position > 0) {
+        _data.remove(0, _position);
+        _position = 0;
+    }
+
+    QByteArray data;
+    data.swap(_data);
+    return data;
+}
+
 void ReceivedMessage::onComplete() {
     _isComplete = true;
     emit completed();
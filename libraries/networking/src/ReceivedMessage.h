@@ -37,6 +37,10 @@ public:
 
     void appendPacket(NLPacket& packet);
 
+    // Reserve room for the whole message when its size is known ahead of time (typically from its head),
+    // so that appending the remaining packets does not reallocate. Safe to call from the handling thread.
+    void reserve(qint64 size) { _reservedSize = size; }
+
     bool failed() const { return _failed; }
     bool isComplete() const { return _isComplete; }
 
@@ -74,6 +78,11 @@ public:
     // exceed that of the ReceivedMessage.
     QByteArray readWithoutCopy(qint64 size);
 
+    // Read the rest of the message by handing over the underlying data rather than copying it. Anything already read
+    // is removed from the front first, which moves the rest of the data within the buffer.
+    // The message is left empty, only use it once the message is complete.
+    QByteArray takeAll();
+
     template<typename T> qint64 peekPrimitive(T* data);
     template<typename T> qint64 readPrimitive(T* data);
 
@@ -92,6 +101,7 @@ private:
 
     std::atomic<qint64> _position { 0 };
     std::atomic<qint64> _numPackets { 0 };
+    std::atomic<qint64> _reservedSize { 0 };
 
     NLPacket::LocalID _sourceID { NLPacket::NULL_LOCAL_ID };
     PacketType _packetType;
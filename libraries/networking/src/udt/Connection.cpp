@@ -158,12 +158,28 @@ void Connection::queueReceivedMessagePacket(std::unique_ptr<Packet> packet) {
     Q_ASSERT(packet->isPartOfMessage());
 
     auto messageNumber = packet->getMessageNumber();
-    auto& pendingMessage = _pendingReceivedMessages[messageNumber];
 
-    pendingMessage.enqueuePacket(std::move(packet));
+    // the bulk of messages fit in a single packet, those don't need a pending message at all
+    if (packet->getPacketPosition() == Packet::PacketPosition::ONLY) {
+        _parentSocket->messageReceived(std::move(packet));
+        return;
+    }
+
+    auto& pendingMessage = _pendingReceivedMessages[messageNumber];
 
     bool processedLastOrOnly = false;
 
+    if (pendingMessage.isNextPacket(*packet)) {
+        // this packet arrived in order, skip the queue
+        pendingMessage.skipNextPacket();
+
+        processedLastOrOnly = packet->getPacketPosition() == Packet::PacketPosition::LAST;
+
+        _parentSocket->messageReceived(std::move(packet));
+    } else {
+        pendingMessage.enqueuePacket(std::move(packet));
+    }
+
     while (pendingMessage.hasAvailablePackets()) {
         auto packet = pendingMessage.removeNextPacket();
 
@@ -477,6 +493,14 @@ bool PendingReceivedMessage::hasAvailablePackets() const {
         && _nextPartNumber == _packets.front()->getMessagePartNumber();
 }
 
+bool PendingReceivedMessage::isNextPacket(const Packet& packet) const {
+    return _packets.empty() && _nextPartNumber == packet.getMessagePartNumber();
+}
+
+void PendingReceivedMessage::skipNextPacket() {
+    _nextPartNumber++;
+}
+
 std::unique_ptr<Packet> PendingReceivedMessage::removeNextPacket() {
     if (hasAvailablePackets()) {
         _nextPartNumber++;
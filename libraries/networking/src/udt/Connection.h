@@ -38,6 +38,10 @@ public:
     void enqueuePacket(std::unique_ptr<Packet> packet);
     bool hasAvailablePackets() const;
     std::unique_ptr<Packet> removeNextPacket();
+
+    // in order packets can be handed over straight away, without being queued
+    bool isNextPacket(const Packet& packet) const;
+    void skipNextPacket();
     
     std::list<std::unique_ptr<Packet>> _packets;
 
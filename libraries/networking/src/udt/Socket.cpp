@@ -223,6 +223,9 @@ qint64 Socket::writeDatagram(const char* data, qint64 size, const HifiSockAddr&
 }
 
 qint64 Socket::writeDatagram(const QByteArray& datagram, const HifiSockAddr& sockAddr) {
+    if (_datagramSinkOperator) {
+        return _datagramSinkOperator(datagram, sockAddr);
+    }
 
     qint64 bytesWritten = _udpSocket.writeDatagram(datagram, sockAddr.getAddress(), sockAddr.getPort());
 
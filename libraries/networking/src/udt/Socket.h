@@ -40,6 +40,7 @@ class SequenceNumber;
 
 using PacketFilterOperator = std::function<bool(const Packet&)>;
 using ConnectionCreationFilterOperator = std::function<bool(const HifiSockAddr&)>;
+using DatagramSinkOperator = std::function<qint64(const QByteArray&, const HifiSockAddr&)>;
 
 using BasePacketHandler = std::function<void(std::unique_ptr<BasePacket>)>;
 using PacketHandler = std::function<void(std::unique_ptr<Packet>)>;
@@ -77,6 +78,10 @@ public:
     void setMessageFailureHandler(MessageFailureHandler handler) { _messageFailureHandler = handler; }
     void setConnectionCreationFilterOperator(ConnectionCreationFilterOperator filterOperator)
         { _connectionCreationFilterOperator = filterOperator; }
+
+    // when set, outgoing datagrams are handed to the sink instead of the UDP socket (used by the headless mixer benchmarks)
+    // the datagram may wrap packet memory with QByteArray::fromRawData, so the sink must not hold on to it
+    void setDatagramSinkOperator(DatagramSinkOperator sinkOperator) { _datagramSinkOperator = sinkOperator; }
     
     void addUnfilteredHandler(const HifiSockAddr& senderSockAddr, BasePacketHandler handler)
         { _unfilteredHandlers[senderSockAddr] = handler; }
@@ -127,6 +132,7 @@ private:
     MessageHandler _messageHandler;
     MessageFailureHandler _messageFailureHandler;
     ConnectionCreationFilterOperator _connectionCreationFilterOperator;
+    DatagramSinkOperator _datagramSinkOperator;
 
     Mutex _unreliableSequenceNumbersMutex;
 
@@ -16,6 +16,7 @@
 #include <cmath>
 #include <fstream> // to load voxels from file
 
+#include <QBuffer>
 #include <QDataStream>
 #include <QDebug>
 #include <QEventLoop>
@@ -672,16 +673,18 @@ OctreeElementPointer Octree::getElementEnclosingPoint(const glm::vec3& point, Oc
 bool Octree::readFromFile(const char* fileName) {
     QString qFileName = findMostRecentFileExtension(fileName, PERSIST_EXTENSIONS);
 
-    if (qFileName.endsWith(".json.gz")) {
-        return readJSONFromGzippedFile(qFileName);
-    }
-
     QFile file(qFileName);
 
     if (!file.open(QIODevice::ReadOnly)) {
         return false;
     }
 
+    // go by the content rather than the extension, as replacement data from the domain server is written as is
+    if (hasGzipHeader(file.peek(2))) {
+        file.close();
+        return readJSONFromGzippedFile(qFileName);
+    }
+
     QDataStream fileInputStream(&file);
     QFileInfo fileInfo(qFileName);
     uint64_t fileLength = fileInfo.size();
@@ -699,16 +702,17 @@ bool Octree::readJSONFromGzippedFile(QString qFileName) {
         qCritical() << "Cannot open gzipped json file for reading: " << qFileName;
         return false;
     }
-    QByteArray compressedJsonData = file.readAll();
-    QByteArray jsonData;
-
-    if (!gunzip(compressedJsonData, jsonData)) {
-        qCritical() << "json File not in gzip format: " << qFileName;
-        return false;
-    }
 
-    QDataStream jsonStream(jsonData);
-    return readJSONFromStream(-1, jsonStream);
+    // inflate the file as it is parsed, rather than holding all of it
+    GunzipStream jsonStream(file);
+    auto rewind = [&] {
+        jsonStream.reset();
+        return file.seek(0);
+    };
+    auto read = [&](char* data, qint64 maxSize) {
+        return jsonStream.read(data, maxSize);
+    };
+    return readJSONFromSource(rewind, read, QString());
 }
 
 // hack to get the marketplace id into the entities.  We will create a way to get this from a hash of
@@ -791,28 +795,8 @@ bool Octree::readFromStream(
     }
 }
 
-
-namespace {
-// hack to get the marketplace id into the entities.  We will create a way to get this from a hash of
-// the entity later, but this helps us move things along for now
-QVariantMap addMarketplaceIDToDocumentEntities(QVariantMap& doc, const QString& marketplaceID) {
-    if (!marketplaceID.isEmpty()) {
-        QVariantList newEntitiesArray;
-
-        // build a new entities array
-        auto entitiesArray = doc["Entities"].toList();
-        for (auto it = entitiesArray.begin(); it != entitiesArray.end(); it++) {
-            auto entity = (*it).toMap();
-            entity["marketplaceID"] = marketplaceID;
-            newEntitiesArray.append(entity);
-        }
-        doc["Entities"] = newEntitiesArray;
-    }
-    return doc;
-}
-
-}  // Unnamed namepsace
-const int READ_JSON_BUFFER_SIZE = 2048;
+// how many entities the parser hands over at a time
+const int ENTITY_BATCH_SIZE = 1024;
 
 bool Octree::readJSONFromStream(
     uint64_t streamLength,
@@ -822,36 +806,71 @@ bool Octree::readJSONFromStream(
     // if the data is gzipped we may not have a useful bytesAvailable() result, so just keep reading until
     // we get an eof.  Leave streamLength parameter for consistency.
 
-    QByteArray jsonBuffer;
-    char* rawData = new char[READ_JSON_BUFFER_SIZE];
-    while (!inputStream.atEnd()) {
-        int got = inputStream.readRawData(rawData, READ_JSON_BUFFER_SIZE - 1);
-        if (got < 0) {
-            qCritical() << "error while reading from json stream";
-            delete[] rawData;
-            return false;
-        }
-        if (got == 0) {
-            break;
-        }
-        jsonBuffer += QByteArray(rawData, got);
+    QIODevice* device = inputStream.device();
+    QBuffer buffer;
+    if (device->isSequential()) {
+        // the input is read twice, so a device that can't seek back is read into memory first
+        buffer.setData(device->readAll());
+        buffer.open(QIODevice::ReadOnly);
+        device = &buffer;
+    }
+
+    qint64 start = device->pos();
+    auto rewind = [&] {
+        return device->seek(start);
+    };
+    auto read = [&](char* data, qint64 maxSize) {
+        return device->read(data, maxSize);
+    };
+    return readJSONFromSource(rewind, read, marketplaceID);
+}
+
+// The entities are written before the file's Version, which reading them depends on, so the input is parsed twice:
+// first for the top-level values, skipping over the entities, then again for the entities, which are handed to
+// readFromStreamedMap in batches as they are parsed.
+bool Octree::readJSONFromSource(const std::function<bool()>& rewind, const std::function<qint64(char*, qint64)>& read,
+                                const QString& marketplaceID) {
+    OctreeEntitiesFileParser headerParser;
+    headerParser.setEntitiesSource(read);
+    headerParser.setEntityFunction([](const char*, int) {
+        return true;
+    });
+    QVariantMap header;
+    if (!headerParser.parseEntities(header)) {
+        qCritical() << "Couldn't parse Entities JSON:" << headerParser.getErrorString().c_str();
+        return false;
     }
 
-    OctreeEntitiesFileParser octreeParser;
-    octreeParser.setEntitiesString(jsonBuffer);
-    QVariantMap asMap;
-    if (!octreeParser.parseEntities(asMap)) {
-        qCritical() << "Couldn't parse Entities JSON:" << octreeParser.getErrorString().c_str();
+    if (!rewind()) {
+        qCritical() << "Couldn't go back to the start of the Entities JSON";
         return false;
     }
 
-    if (!marketplaceID.isEmpty()) {
-        addMarketplaceIDToDocumentEntities(asMap, marketplaceID);
-    }
+    auto parseEntities = [&](const EntityBatchHandler& handler) {
+        QVector<QByteArray> batch;
+        batch.reserve(ENTITY_BATCH_SIZE);
 
-    bool success = readFromMap(asMap);
-    delete[] rawData;
-    return success;
+        OctreeEntitiesFileParser octreeParser;
+        octreeParser.setEntitiesSource(read);
+        octreeParser.setEntityFunction([&](const char* json, int length) {
+            batch.push_back(QByteArray(json, length));
+            if (batch.size() < ENTITY_BATCH_SIZE) {
+                return true;
+            }
+            bool handled = handler(batch);
+            batch.clear();
+            return handled;
+        });
+
+        QVariantMap ignored;
+        if (!octreeParser.parseEntities(ignored)) {
+            qCritical() << "Couldn't parse Entities JSON:" << octreeParser.getErrorString().c_str();
+            return false;
+        }
+        return batch.isEmpty() || handler(batch);
+    };
+
+    return readFromStreamedMap(header, parseEntities, marketplaceID);
 }
 
 bool Octree::writeToFile(const char* fileName, const OctreeElementPointer& element, QString persistAsFileType) {
@@ -18,6 +18,7 @@
 
 #include <QHash>
 #include <QObject>
+#include <QVector>
 #include <QtCore/QJsonObject>
 
 #include <shared/ReadWriteLockable.h>
@@ -212,6 +213,11 @@ public:
     virtual bool writeToJSON(QString& jsonString, const OctreeElementPointer& element) = 0;
 
     // Octree importers
+    // Given a batch of the entity objects of a JSON file, as text, while the file is parsed
+    using EntityBatchHandler = std::function<bool(const QVector<QByteArray>& entities)>;
+    // Parses the entities of a JSON file, handing them to the handler in batches, and returns whether both succeeded
+    using EntityBatchParser = std::function<bool(const EntityBatchHandler& handler)>;
+
     bool readFromFile(const char* filename);
     bool readFromURL(const QString& url, const bool isObservable = true, const qint64 callerId = -1); // will support file urls as well...
     bool readFromStream(uint64_t streamLength, QDataStream& inputStream, const QString& marketplaceID="");
@@ -219,6 +225,10 @@ public:
     bool readJSONFromStream(uint64_t streamLength, QDataStream& inputStream, const QString& marketplaceID="");
     bool readJSONFromGzippedFile(QString qFileName);
     virtual bool readFromMap(QVariantMap& entityDescription) = 0;
+    // Used by readJSONFromStream and readJSONFromGzippedFile, header holding the file's top-level values other than
+    // Entities, which parseEntities hands over as they are read.
+    virtual bool readFromStreamedMap(QVariantMap& header, const EntityBatchParser& parseEntities,
+                                     const QString& marketplaceID) = 0;
 
     uint64_t getOctreeElementsCount();
 
@@ -260,6 +270,9 @@ public:
 
 
 protected:
+    bool readJSONFromSource(const std::function<bool()>& rewind, const std::function<qint64(char*, qint64)>& read,
+                            const QString& marketplaceID);
+
     void deleteOctalCodeFromTreeRecursion(const OctreeElementPointer& element, void* extraData);
 
     static bool countOctreeElementsOperation(const OctreeElementPointer& element, void* extraData);
@@ -60,6 +60,31 @@ bool OctreeUtils::RawOctreeData::readOctreeDataInfoFromFile(QString path) {
     return readOctreeDataInfoFromData(data);
 }
 
+bool OctreeUtils::RawOctreeData::readOctreeDataHeaderFromFile(QString path) {
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        qCritical() << "Cannot open json file for reading: " << path;
+        return false;
+    }
+
+    bool isGzipped = hasGzipHeader(file.peek(2));
+    GunzipStream gunzipStream(file);
+    OctreeEntitiesFileParser jsonParser;
+    jsonParser.setEntitiesSource([&](char* data, qint64 maxSize) {
+        return isGzipped ? gunzipStream.read(data, maxSize) : file.read(data, maxSize);
+    });
+    jsonParser.setEntityFunction([](const char*, int) {
+        return true;
+    });
+    QVariantMap headerMap;
+    if (!jsonParser.parseEntities(headerMap)) {
+        qCritical() << "Can't parse Entities JSON: " << jsonParser.getErrorString().c_str();
+        return false;
+    }
+
+    return readOctreeDataInfoFromMap(headerMap);
+}
+
 QByteArray OctreeUtils::RawOctreeData::toByteArray() {
     QByteArray jsonString;
 
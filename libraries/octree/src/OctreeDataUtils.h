@@ -42,6 +42,8 @@ public:
 
     bool readOctreeDataInfoFromData(QByteArray data);
     bool readOctreeDataInfoFromFile(QString path);
+    // Reads only the top-level values of the file, gzipped or not, skipping over its entities rather than holding them
+    bool readOctreeDataHeaderFromFile(QString path);
     bool readOctreeDataInfoFromMap(const QVariantMap& map);
 };
 
@@ -0,0 +1,175 @@
+//
+//  OctreeElementPool.h
+//  libraries/octree/src
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_OctreeElementPool_h
+#define hifi_OctreeElementPool_h
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <type_traits>
+
+// Octree elements are created one at a time as the tree grows, then traversed over and over by every send thread.
+// Carving them out of large slabs keeps the elements, and their shared_ptr control blocks, packed together in memory
+// instead of scattered across the heap. Freed blocks go back to their slab for the next element, and a slab is handed
+// back once all its blocks are free, except for one empty slab kept around so that a tree hovering around a slab
+// boundary doesn't allocate and free a slab for every element.
+//
+// There is one pool per block size and alignment, elements and control blocks of the same size share a pool.
+template <size_t BlockSize, size_t BlockAlignment>
+class OctreeBlockPool {
+public:
+    static const size_t BLOCKS_PER_SLAB = 512;
+
+    static OctreeBlockPool& getInstance() {
+        // never destroyed, elements of static trees can outlive any static pool
+        static OctreeBlockPool* instance = new OctreeBlockPool();
+        return *instance;
+    }
+
+    void* allocate() {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (_slabsWithFreeBlocks.empty()) {
+            std::unique_ptr<Block[]> blocks { new Block[BLOCKS_PER_SLAB] };
+            Block* firstBlock = blocks.get();
+            _slabs[firstBlock].blocks = std::move(blocks);
+            _slabsWithFreeBlocks.insert(firstBlock);
+        }
+
+        // the lowest slab first, so that the elements stay packed into as few slabs as possible
+        Block* firstBlock = *_slabsWithFreeBlocks.begin();
+        Slab& slab = _slabs[firstBlock];
+        Block* block;
+        if (slab.freeBlocks) {
+            block = slab.freeBlocks;
+            slab.freeBlocks = block->next;
+        } else {
+            block = &slab.blocks[slab.nextBlock++];
+        }
+        ++slab.liveBlocks;
+
+        if (!slab.hasFreeBlock()) {
+            _slabsWithFreeBlocks.erase(firstBlock);
+        }
+        if (firstBlock == _emptySlab) {
+            _emptySlab = nullptr;
+        }
+        return block;
+    }
+
+    void deallocate(void* pointer) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        Block* block = static_cast<Block*>(pointer);
+
+        // the slab holding the block is the last one starting at or before it
+        auto slabIt = _slabs.upper_bound(block);
+        --slabIt;
+        Block* firstBlock = slabIt->first;
+        Slab& slab = slabIt->second;
+
+        if (!slab.hasFreeBlock()) {
+            _slabsWithFreeBlocks.insert(firstBlock);
+        }
+        block->next = slab.freeBlocks;
+        slab.freeBlocks = block;
+        if (--slab.liveBlocks > 0) {
+            return;
+        }
+
+        if (!_emptySlab) {
+            _emptySlab = firstBlock;
+            return;
+        }
+        _slabsWithFreeBlocks.erase(firstBlock);
+        _slabs.erase(slabIt);
+    }
+
+    size_t getReservedMemory() {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _slabs.size() * BLOCKS_PER_SLAB * sizeof(Block);
+    }
+
+private:
+    OctreeBlockPool() {}
+
+    union Block {
+        Block* next;
+        typename std::aligned_storage<BlockSize, BlockAlignment>::type storage;
+    };
+
+    struct Slab {
+        bool hasFreeBlock() const { return freeBlocks || nextBlock < BLOCKS_PER_SLAB; }
+
+        std::unique_ptr<Block[]> blocks;
+        Block* freeBlocks { nullptr };
+        size_t nextBlock { 0 }; // the blocks from here on have never been handed out
+        size_t liveBlocks { 0 };
+    };
+
+    std::mutex _mutex;
+    std::map<Block*, Slab> _slabs; // by their first block
+    std::set<Block*> _slabsWithFreeBlocks;
+    Block* _emptySlab { nullptr };
+};
+
+template <typename T>
+using OctreeElementPool = OctreeBlockPool<sizeof(T), alignof(T)>;
+
+// allocates the shared_ptr control blocks of pooled elements from their own pool
+template <typename T>
+class OctreeElementAllocator {
+public:
+    using value_type = T;
+
+    OctreeElementAllocator() {}
+    template <typename U> OctreeElementAllocator(const OctreeElementAllocator<U>& other) {}
+
+    T* allocate(size_t count) {
+        if (count != 1) {
+            return std::allocator<T>().allocate(count);
+        }
+        return static_cast<T*>(OctreeElementPool<T>::getInstance().allocate());
+    }
+
+    void deallocate(T* pointer, size_t count) {
+        if (count != 1) {
+            std::allocator<T>().deallocate(pointer, count);
+            return;
+        }
+        OctreeElementPool<T>::getInstance().deallocate(pointer);
+    }
+
+    template <typename U> bool operator==(const OctreeElementAllocator<U>& other) const { return true; }
+    template <typename U> bool operator!=(const OctreeElementAllocator<U>& other) const { return false; }
+};
+
+template <typename T>
+class OctreeElementDeleter {
+public:
+    void operator()(T* element) const {
+        element->~T();
+        OctreeElementPool<T>::getInstance().deallocate(element);
+    }
+};
+
+// Usage, from a scope that can reach the element's constructor:
+//     auto element = adoptPooledOctreeElement(new (allocatePooledOctreeElement<Element>()) Element(octalCode));
+template <typename T>
+void* allocatePooledOctreeElement() {
+    return OctreeElementPool<T>::getInstance().allocate();
+}
+
+template <typename T>
+std::shared_ptr<T> adoptPooledOctreeElement(T* element) {
+    return std::shared_ptr<T>(element, OctreeElementDeleter<T>(), OctreeElementAllocator<T>());
+}
+
+#endif // hifi_OctreeElementPool_h
@@ -11,6 +11,7 @@
 
 #include "OctreeEntitiesFileParser.h"
 
+#include <algorithm>
 #include <sstream>
 #include <cctype>
 
@@ -21,10 +22,17 @@
 
 using std::string;
 
+// how much of the input is read at a time from a source
+const int READ_CHUNK_SIZE = 64 * 1024;
+// room for an integer value and the whitespace before it
+const int MAX_INTEGER_LENGTH = 64;
+
 std::string OctreeEntitiesFileParser::getErrorString() const {
     std::ostringstream err;
-    if (_errorString.size() != 0) {
-        err << "Error: Line " << _line << ", byte position " << _position << ": " << _errorString;
+    if (_readFailed) {
+        err << "Error: Line " << _line << ", byte position " << _discardedLength + _position << ": Error reading input";
+    } else if (_errorString.size() != 0) {
+        err << "Error: Line " << _line << ", byte position " << _discardedLength + _position << ": " << _errorString;
     };
 
     return err.str();
@@ -35,6 +43,54 @@ void OctreeEntitiesFileParser::setEntitiesString(const QByteArray& entitiesConte
     _entitiesLength = _entitiesContents.length();
     _position = 0;
     _line = 1;
+    _readFunction = nullptr;
+    _discardedLength = 0;
+    _readFailed = false;
+}
+
+void OctreeEntitiesFileParser::setEntitiesSource(ReadFunction readFunction) {
+    _entitiesContents.clear();
+    _entitiesLength = 0;
+    _position = 0;
+    _line = 1;
+    _readFunction = readFunction;
+    _discardedLength = 0;
+    _readFailed = false;
+}
+
+// Whether the input has a byte at index, reading more from the source when there is one. Reading drops the parsed
+// input from the front of the buffer, up to the byte before _position, and moves index along with it.
+bool OctreeEntitiesFileParser::hasByteAt(int& index) {
+    while (index >= _entitiesLength) {
+        if (!_readFunction || _readFailed) {
+            return false;
+        }
+
+        int distance = index - _position;
+        int discarded = std::max(_position - 1, 0);
+        if (discarded > 0) {
+            _entitiesContents.remove(0, discarded);
+            _discardedLength += discarded;
+            _position -= discarded;
+        }
+        index = _position + distance;
+
+        int length = _entitiesContents.length();
+        _entitiesContents.resize(length + READ_CHUNK_SIZE);
+        qint64 got = _readFunction(_entitiesContents.data() + length, READ_CHUNK_SIZE);
+        _entitiesContents.resize(length + (int)std::max(got, (qint64)0));
+        _entitiesLength = _entitiesContents.length();
+
+        if (got < 0) {
+            _readFailed = true;
+            return false;
+        } else if (got == 0) {
+            _readFunction = nullptr;
+            return false;
+        }
+    }
+
+    return true;
 }
 
 bool OctreeEntitiesFileParser::parseEntities(QVariantMap& parsedEntities) {
@@ -166,7 +222,7 @@ bool OctreeEntitiesFileParser::parseEntities(QVariantMap& parsedEntities) {
 }
 
 int OctreeEntitiesFileParser::nextToken() {
-    while (_position < _entitiesLength) {
+    while (hasByteAt(_position)) {
         char c = _entitiesContents[_position++];
         if (c != ' ' && c != '\t' && c != '\n' && c != '\r') {
             return c;
@@ -181,7 +237,7 @@ int OctreeEntitiesFileParser::nextToken() {
 
 string OctreeEntitiesFileParser::readString() {
     string returnString;
-    while (_position < _entitiesLength) {
+    while (hasByteAt(_position)) {
         char c = _entitiesContents[_position++];
         if (c == '"') {
             break;
@@ -194,6 +250,8 @@ string OctreeEntitiesFileParser::readString() {
 }
 
 int OctreeEntitiesFileParser::readInteger() {
+    int lastDigit = _position + MAX_INTEGER_LENGTH;
+    hasByteAt(lastDigit);
     const char* currentPosition = _entitiesContents.constData() + _position;
     int i = std::atoi(currentPosition);
 
@@ -223,14 +281,21 @@ bool OctreeEntitiesFileParser::readEntitiesArray(QVariantList& entitiesArray) {
             return false;
         }
 
-        QByteArray jsonEntity = _entitiesContents.mid(_position - 1, matchingBrace - _position + 1);
-        QJsonDocument entity = QJsonDocument::fromJson(jsonEntity);
-        if (entity.isNull()) {
-            _errorString = "Ill-formed entity";
-            return false;
-        }
+        if (_entityFunction) {
+            if (!_entityFunction(_entitiesContents.constData() + _position - 1, matchingBrace - _position + 1)) {
+                _errorString = "Entity not accepted";
+                return false;
+            }
+        } else {
+            QByteArray jsonEntity = _entitiesContents.mid(_position - 1, matchingBrace - _position + 1);
+            QJsonDocument entity = QJsonDocument::fromJson(jsonEntity);
+            if (entity.isNull()) {
+                _errorString = "Ill-formed entity";
+                return false;
+            }
 
-        entitiesArray.append(entity.object());
+            entitiesArray.append(entity.object());
+        }
         _position = matchingBrace;
         char c = nextToken();
         if (c == ']') {
@@ -243,10 +308,10 @@ bool OctreeEntitiesFileParser::readEntitiesArray(QVariantList& entitiesArray) {
     return true;
 }
 
-int OctreeEntitiesFileParser::findMatchingBrace() const {
+int OctreeEntitiesFileParser::findMatchingBrace() {
     int index = _position;
     int nestCount = 1;
-    while (index < _entitiesLength && nestCount != 0) {
+    while (nestCount != 0 && hasByteAt(index)) {
         switch (_entitiesContents[index++]) {
         case '{':
             ++nestCount;
@@ -258,11 +323,11 @@ int OctreeEntitiesFileParser::findMatchingBrace() const {
 
         case '"':
             // Skip string
-            while (index < _entitiesLength) {
+            while (hasByteAt(index)) {
                 if (_entitiesContents[index] == '"') {
                     ++index;
                     break;
-                } else if (_entitiesContents[index] == '\\' && _entitiesContents[++index] == 'u') {
+                } else if (_entitiesContents[index] == '\\' && hasByteAt(++index) && _entitiesContents[index] == 'u') {
                     index += 4;
                 }
                 ++index;
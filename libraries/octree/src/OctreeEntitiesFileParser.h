@@ -14,12 +14,24 @@
 #ifndef hifi_OctreeEntitiesFileParser_h
 #define hifi_OctreeEntitiesFileParser_h
 
+#include <functional>
+
 #include <QByteArray>
 #include <QVariant>
 
 class OctreeEntitiesFileParser {
 public:
+    // Reads up to maxSize bytes of the input into data. Returns 0 at the end of the input, -1 on error.
+    using ReadFunction = std::function<qint64(char* data, qint64 maxSize)>;
+    // Given each object of the Entities array as JSON text, in file order. Returning false stops the parse.
+    using EntityFunction = std::function<bool(const char* json, int length)>;
+
     void setEntitiesString(const QByteArray& entitiesContents);
+    // Reads the input in chunks as it is parsed, rather than holding all of it.
+    void setEntitiesSource(ReadFunction readFunction);
+    // Hands the entities to the function instead of parsing them into the Entities list.
+    void setEntityFunction(EntityFunction entityFunction) { _entityFunction = entityFunction; }
+
     bool parseEntities(QVariantMap& parsedEntities);
     std::string getErrorString() const;
 
@@ -28,13 +40,19 @@ private:
     std::string readString();
     int readInteger();
     bool readEntitiesArray(QVariantList& entitiesArray);
-    int findMatchingBrace() const;
+    int findMatchingBrace();
+    bool hasByteAt(int& index);
 
     QByteArray _entitiesContents;
     int _position { 0 };
     int _line { 1 };
     int _entitiesLength { 0 };
     std::string _errorString;
+
+    ReadFunction _readFunction;
+    EntityFunction _entityFunction;
+    qint64 _discardedLength { 0 }; // the input already dropped from the front of _entitiesContents
+    bool _readFailed { false };
 };
 
 #endif  // hifi_OctreeEntitiesFileParser_h
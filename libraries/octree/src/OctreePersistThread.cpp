@@ -71,24 +71,21 @@ void OctreePersistThread::start() {
 
     auto packet = NLPacket::create(PacketType::OctreeDataFileRequest, -1, true, false);
 
-    OctreeUtils::RawOctreeData data;
+    OctreeUtils::RawOctreeData& data = _currentOctreeData;
     qCDebug(octree) << "Reading octree data from" << _filename;
     QFile file(_filename);
     if (file.open(QIODevice::ReadOnly)) {
-        QByteArray jsonData(file.readAll());
         file.close();
-        if (!gunzip(jsonData, _cachedJSONData)) {
-            _cachedJSONData = jsonData;
-        }
 
-        if (data.readOctreeDataInfoFromData(_cachedJSONData)) {
+        // only the header is read for now, the entities are streamed from the file once the domain server has replied
+        _hasCurrentOctreeData = data.readOctreeDataHeaderFromFile(_filename);
+        if (_hasCurrentOctreeData) {
             qCDebug(octree) << "Current octree data: ID(" << data.id << ") DataVersion(" << data.version << ")";
             packet->writePrimitive(true);
             auto id = data.id.toRfc4122();
             packet->write(id);
             packet->writePrimitive(data.version);
         } else {
-            _cachedJSONData.clear();
             qCWarning(octree) << "No octree data found";
             packet->writePrimitive(false);
         }
@@ -112,31 +109,23 @@ void OctreePersistThread::handleOctreeDataFileReply(QSharedPointer<ReceivedMessa
     QByteArray replacementData;
     OctreeUtils::RawOctreeData data;
     bool hasValidOctreeData { false };
+    bool resetOctreeID { false };
     if (includesNewData) {
-        _cachedJSONData.clear();
         replacementData = message->readAll();
         replaceData(replacementData);
-        hasValidOctreeData = data.readOctreeDataInfoFromFile(_filename);
+        hasValidOctreeData = data.readOctreeDataHeaderFromFile(_filename);
         qDebug() << "Got OctreeDataFileReply, new data sent";
     } else {
         qDebug() << "Got OctreeDataFileReply, current entity data is sufficient";
-        
-        OctreeUtils::RawEntityData data;
-        qCDebug(octree) << "Reading octree data from" << _filename;
-        if (data.readOctreeDataInfoFromData(_cachedJSONData)) {
+
+        data = _currentOctreeData;
+        if (_hasCurrentOctreeData) {
             hasValidOctreeData = true;
             if (data.id.isNull()) {
+                // the file is written again with the new id once its entities have been loaded
                 qCDebug(octree) << "Current octree data has a null id, updating";
                 data.resetIdAndVersion();
-
-                QFile file(_filename);
-                if (file.open(QIODevice::WriteOnly)) {
-                    auto entityData = data.toGzippedByteArray();
-                    file.write(entityData);
-                    file.close();
-                } else {
-                    qCDebug(octree) << "Failed to update octree data";
-                }
+                resetOctreeID = true;
             }
         }
     }
@@ -153,16 +142,17 @@ void OctreePersistThread::handleOctreeDataFileReply(QSharedPointer<ReceivedMessa
     _tree->withWriteLock([&] {
         PerformanceWarning warn(true, "Loading Octree File", true);
 
-        if (_cachedJSONData.isEmpty()) {
-            persistentFileRead = _tree->readFromFile(_filename.toLocal8Bit().constData());
-        } else {
-            QDataStream jsonStream(_cachedJSONData);
-            persistentFileRead = _tree->readFromStream(-1, jsonStream);
-        }
+        persistentFileRead = _tree->readFromFile(_filename.toLocal8Bit().constData());
         _tree->pruneTree();
     });
 
-    _cachedJSONData.clear();
+    if (persistentFileRead && resetOctreeID) {
+        _tree->setOctreeVersionInfo(data.id, data.dataVersion);
+        if (!_tree->writeToFile(_filename.toLocal8Bit().constData(), nullptr, _persistAsFileType)) {
+            qCDebug(octree) << "Failed to update octree data";
+        }
+    }
+
     quint64 loadDone = usecTimestampNow();
     _loadTimeUSecs = loadDone - loadStarted;
 
@@ -17,6 +17,7 @@
 #include <QString>
 #include <GenericThread.h>
 #include "Octree.h"
+#include "OctreeDataUtils.h"
 
 class OctreePersistThread : public QObject {
     Q_OBJECT
@@ -78,7 +79,8 @@ private:
     quint64 _lastTimeDebug;
 
     QString _persistAsFileType;
-    QByteArray _cachedJSONData;
+    OctreeUtils::RawOctreeData _currentOctreeData;
+    bool _hasCurrentOctreeData { false };
 };
 
 #endif // hifi_OctreePersistThread_h
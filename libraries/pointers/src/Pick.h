@@ -180,6 +180,10 @@ public:
     virtual PickResultPointer getAvatarIntersection(const T& pick) = 0;
     virtual PickResultPointer getHUDIntersection(const T& pick) = 0;
 
+    // Whether getEntityIntersection() is safe to call off the main thread, which lets PickCacheOptimizer::updateParallel
+    // run it on the global thread pool
+    virtual bool isThreadSafe() const { return false; }
+
 protected:
     T _mathPick;
 };
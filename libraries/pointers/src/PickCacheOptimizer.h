@@ -9,6 +9,10 @@
 #define hifi_PickCacheOptimizer_h
 
 #include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include <QtConcurrent/QtConcurrentMap>
 
 #include "Pick.h"
 
@@ -39,9 +43,18 @@ class PickCacheOptimizer {
 public:
     QVector3D update(std::unordered_map<uint32_t, std::shared_ptr<PickQuery>>& picks, uint32_t& nextToUpdate, uint64_t expiry, bool shouldPickHUD);
 
+    // Updates every pick, with no time budget.  The picks are snapshotted up front, then the entity intersections of the
+    // picks that are thread safe run on the global thread pool while the rest, and the avatar and HUD intersections, run
+    // on this thread.  The results are all set once every intersection is done.  Picks that share a mathematical pick
+    // and filter share one intersection, and the cache ends up the same as after update().
+    QVector3D updateParallel(std::unordered_map<uint32_t, std::shared_ptr<PickQuery>>& picks, bool shouldPickHUD);
+
 protected:
     typedef std::unordered_map<T, std::unordered_map<PickCacheKey, PickResultPointer>> PickCache;
 
+    // the intersections of the last update, by mathematical pick and filter
+    PickCache _results;
+
     // Returns true if this pick exists in the cache, and if it does, update res if the cached result is closer
     bool checkAndCompareCachedResults(T& pick, PickCache& cache, PickResultPointer& res, const PickCacheKey& key);
     void cacheResult(const bool intersects, const PickResultPointer& resTemp, const PickCacheKey& key, PickResultPointer& res, T& mathPick, PickCache& cache, const std::shared_ptr<Pick<T>> pick);
@@ -70,7 +83,8 @@ template<typename T>
 QVector3D PickCacheOptimizer<T>::update(std::unordered_map<uint32_t, std::shared_ptr<PickQuery>>& picks,
         uint32_t& nextToUpdate, uint64_t expiry, bool shouldPickHUD) {
     QVector3D numIntersectionsComputed;
-    PickCache results;
+    PickCache& results = _results;
+    results.clear();
     const uint32_t INVALID_PICK_ID = 0;
     auto itr = picks.begin();
     if (nextToUpdate != INVALID_PICK_ID) {
@@ -142,4 +156,125 @@ QVector3D PickCacheOptimizer<T>::update(std::unordered_map<uint32_t, std::shared
     return numIntersectionsComputed;
 }
 
+template<typename T>
+QVector3D PickCacheOptimizer<T>::updateParallel(std::unordered_map<uint32_t, std::shared_ptr<PickQuery>>& picks, bool shouldPickHUD) {
+    struct EntityIntersection {
+        std::shared_ptr<Pick<T>> pick;
+        T mathPick;
+        PickCacheKey key;
+        PickResultPointer result;
+    };
+
+    struct PickState {
+        std::shared_ptr<Pick<T>> pick;
+        T mathPick;
+        bool evaluate;
+        PickCacheKey entityKey;
+        PickCacheKey avatarKey;
+        PickCacheKey hudKey;
+    };
+
+    QVector3D numIntersectionsComputed;
+    std::vector<PickState> states;
+    states.reserve(picks.size());
+    std::vector<EntityIntersection> entityIntersections;
+    std::vector<EntityIntersection> serialEntityIntersections;
+    std::unordered_map<T, std::unordered_set<PickCacheKey>> entityKeys;
+
+    // Snapshot the picks so that they all see the same frame
+    for (auto& entry : picks) {
+        std::shared_ptr<Pick<T>> pick = std::static_pointer_cast<Pick<T>>(entry.second);
+        T mathematicalPick = pick->getMathematicalPick();
+        PickFilter filter = pick->getFilter();
+        bool evaluate = pick->isEnabled() && pick->getMaxDistance() >= 0.0f && mathematicalPick;
+        PickState state { pick, mathematicalPick, evaluate,
+            { filter.getEntityFlags(), pick->getIncludeItems(), pick->getIgnoreItems() },
+            { filter.getAvatarFlags(), pick->getIncludeItems(), pick->getIgnoreItems() },
+            { filter.getHUDFlags(), QVector<QUuid>(), QVector<QUuid>() } };
+
+        if (evaluate && (filter.doesPickDomainEntities() || filter.doesPickAvatarEntities() || filter.doesPickLocalEntities())) {
+            if (entityKeys[mathematicalPick].insert(state.entityKey).second) {
+                auto& intersections = pick->isThreadSafe() ? entityIntersections : serialEntityIntersections;
+                intersections.push_back({ pick, mathematicalPick, state.entityKey, PickResultPointer() });
+            }
+        }
+        states.push_back(state);
+    }
+    numIntersectionsComputed[0] = (float)(entityIntersections.size() + serialEntityIntersections.size());
+
+    QFuture<void> entityFuture = QtConcurrent::map(entityIntersections, [](EntityIntersection& intersection) {
+        intersection.result = intersection.pick->getEntityIntersection(intersection.mathPick);
+    });
+
+    // Avatar intersections have to happen on the main thread, so do those, the HUD and the entity intersections of the
+    // picks that aren't thread safe while the others are picked
+    PickCache& results = _results;
+    results.clear();
+    for (auto& intersection : serialEntityIntersections) {
+        intersection.result = intersection.pick->getEntityIntersection(intersection.mathPick);
+    }
+    auto isCached = [&](const T& mathPick, const PickCacheKey& key) {
+        auto cached = results.find(mathPick);
+        return cached != results.end() && cached->second.find(key) != cached->second.end();
+    };
+    for (auto& state : states) {
+        if (!state.evaluate) {
+            continue;
+        }
+
+        if (state.pick->getFilter().doesPickAvatars() && !isCached(state.mathPick, state.avatarKey)) {
+            PickResultPointer avatarRes = state.pick->getAvatarIntersection(state.mathPick);
+            numIntersectionsComputed[1]++;
+            if (avatarRes) {
+                results[state.mathPick][state.avatarKey] = avatarRes->doesIntersect() ? avatarRes :
+                    state.pick->getDefaultResult(state.mathPick.toVariantMap());
+            }
+        }
+
+        // Can't intersect with HUD in desktop mode
+        if (state.pick->getFilter().doesPickHUD() && shouldPickHUD && !isCached(state.mathPick, state.hudKey)) {
+            PickResultPointer hudRes = state.pick->getHUDIntersection(state.mathPick);
+            numIntersectionsComputed[2]++;
+            if (hudRes) {
+                results[state.mathPick][state.hudKey] = hudRes;
+            }
+        }
+    }
+
+    entityFuture.waitForFinished();
+
+    for (auto intersections : { &entityIntersections, &serialEntityIntersections }) {
+        for (auto& intersection : *intersections) {
+            if (intersection.result) {
+                results[intersection.mathPick][intersection.key] = intersection.result->doesIntersect() ? intersection.result :
+                    intersection.pick->getDefaultResult(intersection.mathPick.toVariantMap());
+            }
+        }
+    }
+
+    // Combine each pick's results the way update() does
+    for (auto& state : states) {
+        PickResultPointer res = state.pick->getDefaultResult(state.mathPick.toVariantMap());
+        if (state.evaluate) {
+            PickFilter filter = state.pick->getFilter();
+            if (filter.doesPickDomainEntities() || filter.doesPickAvatarEntities() || filter.doesPickLocalEntities()) {
+                checkAndCompareCachedResults(state.mathPick, results, res, state.entityKey);
+            }
+            if (filter.doesPickAvatars()) {
+                checkAndCompareCachedResults(state.mathPick, results, res, state.avatarKey);
+            }
+            if (filter.doesPickHUD() && shouldPickHUD) {
+                checkAndCompareCachedResults(state.mathPick, results, res, state.hudKey);
+            }
+
+            float maxDistance = state.pick->getMaxDistance();
+            if (maxDistance > 0.0f && !res->checkOrFilterAgainstMaxDistance(maxDistance)) {
+                res = state.pick->getDefaultResult(state.mathPick.toVariantMap());
+            }
+        }
+        state.pick->setPickResult(res);
+    }
+    return numIntersectionsComputed;
+}
+
 #endif // hifi_PickCacheOptimizer_h
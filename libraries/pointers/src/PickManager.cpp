@@ -121,6 +121,7 @@ void PickManager::update() {
     bool shouldPickHUD = _shouldPickHUDOperator();
     // FIXME: give each type its own expiry
     // Each type will update at least one pick, regardless of the expiry
+    // Stylus and collision picks always update on this thread, collision picks use the physics engine
     {
         PROFILE_RANGE(picks, "StylusPicks");
         PerformanceTimer perfTimer("StylusPicks");
@@ -129,12 +130,20 @@ void PickManager::update() {
     {
         PROFILE_RANGE(picks, "RayPicks");
         PerformanceTimer perfTimer("RayPicks");
-        _updatedPickCounts[PickQuery::Ray] = _rayPickCacheOptimizer.update(cachedPicks[PickQuery::Ray], _nextPickToUpdate[PickQuery::Ray], expiry, shouldPickHUD);
+        if (_parallelPicking) {
+            _updatedPickCounts[PickQuery::Ray] = _rayPickCacheOptimizer.updateParallel(cachedPicks[PickQuery::Ray], shouldPickHUD);
+        } else {
+            _updatedPickCounts[PickQuery::Ray] = _rayPickCacheOptimizer.update(cachedPicks[PickQuery::Ray], _nextPickToUpdate[PickQuery::Ray], expiry, shouldPickHUD);
+        }
     }
     {
         PROFILE_RANGE(picks, "ParabolaPick");
         PerformanceTimer perfTimer("ParabolaPick");
-        _updatedPickCounts[PickQuery::Parabola] = _parabolaPickCacheOptimizer.update(cachedPicks[PickQuery::Parabola], _nextPickToUpdate[PickQuery::Parabola], expiry, shouldPickHUD);
+        if (_parallelPicking) {
+            _updatedPickCounts[PickQuery::Parabola] = _parabolaPickCacheOptimizer.updateParallel(cachedPicks[PickQuery::Parabola], shouldPickHUD);
+        } else {
+            _updatedPickCounts[PickQuery::Parabola] = _parabolaPickCacheOptimizer.update(cachedPicks[PickQuery::Parabola], _nextPickToUpdate[PickQuery::Parabola], expiry, shouldPickHUD);
+        }
     }
     {
         PROFILE_RANGE(picks, "CollisoinPicks");
@@ -61,17 +61,23 @@ public:
 
     bool getForceCoarsePicking() { return _forceCoarsePicking; }
 
+    // When parallel picking is on every ray and parabola pick is updated each frame, with the entity intersections of the
+    // thread safe picks running on the global thread pool, instead of as many as fit in the per frame time budget
+    bool getParallelPicking() const { return _parallelPicking; }
+
     const std::vector<QVector3D>& getUpdatedPickCounts() { return _updatedPickCounts; }
     const std::vector<int>& getTotalPickCounts() { return _totalPickCounts; }
 
 public slots:
     void setForceCoarsePicking(bool forceCoarsePicking) { _forceCoarsePicking = forceCoarsePicking; }
+    void setParallelPicking(bool parallelPicking) { _parallelPicking = parallelPicking; }
 
 protected:
     std::vector<QVector3D> _updatedPickCounts { PickQuery::NUM_PICK_TYPES };
     std::vector<int> _totalPickCounts { 0, 0, 0, 0 };
 
     bool _forceCoarsePicking { false };
+    bool _parallelPicking { false };
     std::function<bool()> _shouldPickHUDOperator;
     std::function<glm::vec2(const glm::vec3&)> _calculatePos2DFromHUDOperator;
 
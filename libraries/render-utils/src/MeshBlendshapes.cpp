@@ -0,0 +1,184 @@
+//
+//  MeshBlendshapes.cpp
+//  libraries/render-utils/src
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "MeshBlendshapes.h"
+
+#include <glm/gtc/packing.hpp>
+
+#include <GLMHelpers.h>
+
+#include "Model.h"
+
+//
+// on x86 architecture, assume that SSE2 is present
+//
+#if defined(_M_IX86) || defined(_M_X64) || defined(__i386__) || defined(__x86_64__)
+#include <emmintrin.h>  // SSE2
+#define MESH_BLENDSHAPES_SSE2 1
+#endif
+
+const float MeshBlendshapes::MIN_COEFFICIENT = 0.0001f;
+
+namespace {
+
+const float NORMAL_COEFFICIENT_SCALE = 0.01f;
+
+#if MESH_BLENDSHAPES_SSE2
+
+// glm::round(), which rounds halves away from zero, unlike _mm_cvtps_epi32()
+inline __m128i roundToInt(__m128 value) {
+    __m128i truncated = _mm_cvttps_epi32(value);
+    __m128 fraction = _mm_sub_ps(value, _mm_cvtepi32_ps(truncated));
+    __m128 absFraction = _mm_andnot_ps(_mm_set1_ps(-0.0f), fraction);
+    __m128i roundsAway = _mm_castps_si128(_mm_cmpge_ps(absFraction, _mm_set1_ps(0.5f)));
+    // -1 for negative values, 1 otherwise
+    __m128i sign = _mm_or_si128(_mm_srai_epi32(_mm_castps_si128(value), 31), _mm_set1_epi32(1));
+    return _mm_add_epi32(truncated, _mm_and_si128(roundsAway, sign));
+}
+
+#endif
+
+}
+
+#if MESH_BLENDSHAPES_SSE2
+
+// The vectors are transposed so that each lane packs one of them, with the same results as glm::packSnorm3x10_1x2()
+void MeshBlendshapes::packOffset(const glm::vec3& position, const glm::vec3& normal, const glm::vec3& tangent,
+        glm::uvec4& packed) {
+    float len = glm::compMax(glm::abs(position));
+    __m128 x = _mm_setr_ps(position.x, normal.x, tangent.x, 0.0f);
+    __m128 y = _mm_setr_ps(position.y, normal.y, tangent.y, 0.0f);
+    __m128 z = _mm_setr_ps(position.z, normal.z, tangent.z, 0.0f);
+    if (len > 1.0f) {
+        __m128 positionScale = _mm_setr_ps(len, 1.0f, 1.0f, 1.0f);
+        x = _mm_div_ps(x, positionScale);
+        y = _mm_div_ps(y, positionScale);
+        z = _mm_div_ps(z, positionScale);
+    } else {
+        len = 1.0f;
+    }
+
+    // the clamped value is the second operand so that NaNs carry through, and end up packed as 0 like glm's
+    const __m128 MIN = _mm_set1_ps(-1.0f);
+    const __m128 MAX = _mm_set1_ps(1.0f);
+    const __m128 SCALE = _mm_set1_ps(511.0f);
+    const __m128i MASK = _mm_set1_epi32(0x3FF);
+    __m128i packedX = _mm_and_si128(roundToInt(_mm_mul_ps(_mm_min_ps(MAX, _mm_max_ps(MIN, x)), SCALE)), MASK);
+    __m128i packedY = _mm_and_si128(roundToInt(_mm_mul_ps(_mm_min_ps(MAX, _mm_max_ps(MIN, y)), SCALE)), MASK);
+    __m128i packedZ = _mm_and_si128(roundToInt(_mm_mul_ps(_mm_min_ps(MAX, _mm_max_ps(MIN, z)), SCALE)), MASK);
+    __m128i packedXYZ = _mm_or_si128(packedX, _mm_or_si128(_mm_slli_epi32(packedY, 10), _mm_slli_epi32(packedZ, 20)));
+
+    alignas(16) uint32_t lanes[4];
+    _mm_store_si128((__m128i*)lanes, packedXYZ);
+    packed = glm::uvec4(glm::floatBitsToUint(len), lanes[0], lanes[1], lanes[2]);
+}
+
+#else   // portable reference code
+
+void MeshBlendshapes::packOffset(const glm::vec3& position, const glm::vec3& normal, const glm::vec3& tangent,
+        glm::uvec4& packed) {
+    float len = glm::compMax(glm::abs(position));
+    glm::vec3 normalizedPos(position);
+    if (len > 1.0f) {
+        normalizedPos /= len;
+    } else {
+        len = 1.0f;
+    }
+
+    packed = glm::uvec4(
+        glm::floatBitsToUint(len),
+        glm::packSnorm3x10_1x2(glm::vec4(normalizedPos, 0.0f)),
+        glm::packSnorm3x10_1x2(glm::vec4(normal, 0.0f)),
+        glm::packSnorm3x10_1x2(glm::vec4(tangent, 0.0f))
+    );
+}
+
+#endif
+
+MeshBlendshapes::MeshBlendshapes(const HFMMesh& mesh) {
+    int numVertices = mesh.vertices.size();
+    _vertexStarts.assign(numVertices + 1, 0);
+
+    // count each vertex's offsets, then lay them out by vertex, keeping them in blendshape order
+    for (const HFMBlendshape& blendshape : mesh.blendshapes) {
+        for (int index : blendshape.indices) {
+            if (index >= 0 && index < numVertices) {
+                _vertexStarts[index + 1]++;
+            }
+        }
+    }
+    for (int i = 0; i < numVertices; i++) {
+        _vertexStarts[i + 1] += _vertexStarts[i];
+    }
+
+    int numOffsets = _vertexStarts[numVertices];
+    _blendshapeIndices.resize(numOffsets);
+    _positionOffsets.resize(numOffsets);
+    _normalOffsets.resize(numOffsets);
+    _tangentOffsets.resize(numOffsets);
+
+    std::vector<int> nextOffsets(_vertexStarts.begin(), _vertexStarts.end() - 1);
+    for (int i = 0; i < mesh.blendshapes.size(); i++) {
+        const HFMBlendshape& blendshape = mesh.blendshapes.at(i);
+        for (int j = 0; j < blendshape.indices.size(); j++) {
+            int index = blendshape.indices.at(j);
+            if (index < 0 || index >= numVertices) {
+                continue;
+            }
+            int offset = nextOffsets[index]++;
+            _blendshapeIndices[offset] = i;
+            _positionOffsets[offset] = blendshape.vertices.at(j);
+            _normalOffsets[offset] = blendshape.normals.at(j);
+            _tangentOffsets[offset] = j < blendshape.tangents.size() ? blendshape.tangents.at(j) : glm::vec3(0.0f);
+        }
+    }
+}
+
+void MeshBlendshapes::computeWeights(const QVector<float>& coefficients, std::vector<float>& weights) {
+    weights.resize(coefficients.size());
+    for (int i = 0; i < coefficients.size(); i++) {
+        float coefficient = coefficients.at(i);
+        weights[i] = coefficient < MIN_COEFFICIENT ? 0.0f : coefficient;
+    }
+}
+
+void MeshBlendshapes::blend(const std::vector<float>& weights, int beginVertex, int endVertex,
+        BlendshapeOffsetPacked* offsets) const {
+    // what no offset packs to
+    const glm::uvec4 ZERO_OFFSET(glm::floatBitsToUint(1.0f), 0, 0, 0);
+
+    int numWeights = (int)weights.size();
+    for (int vertex = beginVertex; vertex < endVertex; vertex++) {
+        if (_vertexStarts[vertex] == _vertexStarts[vertex + 1]) {
+            offsets[vertex].packedPosNorTan = ZERO_OFFSET;
+            continue;
+        }
+
+        glm::vec3 positionOffset(0.0f);
+        glm::vec3 normalOffset(0.0f);
+        glm::vec3 tangentOffset(0.0f);
+        for (int offset = _vertexStarts[vertex], end = _vertexStarts[vertex + 1]; offset < end; offset++) {
+            int blendshapeIndex = _blendshapeIndices[offset];
+            if (blendshapeIndex >= numWeights) {
+                // the rest are for blendshapes past the coefficients
+                break;
+            }
+            float vertexCoefficient = weights[blendshapeIndex];
+            if (vertexCoefficient == 0.0f) {
+                continue;
+            }
+            float normalCoefficient = vertexCoefficient * NORMAL_COEFFICIENT_SCALE;
+            positionOffset += _positionOffsets[offset] * vertexCoefficient;
+            normalOffset += _normalOffsets[offset] * normalCoefficient;
+            tangentOffset += _tangentOffsets[offset] * normalCoefficient;
+        }
+        packOffset(positionOffset, normalOffset, tangentOffset, offsets[vertex].packedPosNorTan);
+    }
+}
@@ -0,0 +1,54 @@
+//
+//  MeshBlendshapes.h
+//  libraries/render-utils/src
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_MeshBlendshapes_h
+#define hifi_MeshBlendshapes_h
+
+#include <memory>
+#include <vector>
+
+#include <hfm/HFM.h>
+
+struct BlendshapeOffsetPacked;
+
+// A mesh's blendshapes, regrouped by vertex so that all of a vertex's offsets can be summed and packed in one pass.
+//
+// The offsets are stored in compressed sparse rows: the offsets of vertex v are entries _vertexStarts[v] up to
+// _vertexStarts[v + 1], in blendshape order, so vertices that no blendshape moves cost nothing but their packing.
+class MeshBlendshapes {
+public:
+    MeshBlendshapes(const HFMMesh& mesh);
+
+    int getNumVertices() const { return (int)_vertexStarts.size() - 1; }
+
+    // Blendshapes are only applied for coefficients at least this large
+    static const float MIN_COEFFICIENT;
+
+    /// Returns the weight of each blendshape for the coefficients, with those too small to apply set to zero
+    static void computeWeights(const QVector<float>& coefficients, std::vector<float>& weights);
+
+    /// Sums the weighted offsets of vertices [beginVertex, endVertex) and packs them into offsets[beginVertex...]
+    void blend(const std::vector<float>& weights, int beginVertex, int endVertex, BlendshapeOffsetPacked* offsets) const;
+
+    /// Packs a vertex's summed offsets: the position scaled to fit in [-1, 1] with the scale as a float, then the three
+    /// vectors with glm::packSnorm3x10_1x2()
+    static void packOffset(const glm::vec3& position, const glm::vec3& normal, const glm::vec3& tangent, glm::uvec4& packed);
+
+private:
+    std::vector<int> _vertexStarts;
+    std::vector<int> _blendshapeIndices;
+    std::vector<glm::vec3> _positionOffsets;
+    std::vector<glm::vec3> _normalOffsets;
+    std::vector<glm::vec3> _tangentOffsets;
+};
+
+using MeshBlendshapesPointer = std::shared_ptr<const MeshBlendshapes>;
+
+#endif // hifi_MeshBlendshapes_h
@@ -31,8 +31,6 @@
 #include <graphics/BufferViewHelpers.h>
 #include <DualQuaternion.h>
 
-#include <glm/gtc/packing.hpp>
-
 #include "AbstractViewStateInterface.h"
 #include "MeshPartPayload.h"
 
@@ -985,7 +983,7 @@ void Model::removeFromScene(const render::ScenePointer& scene, render::Transacti
     _modelMeshRenderItemShapes.clear();
     _priorityMap.clear();
 
-    _blendshapeOffsets.clear();
+    _meshBlendshapes.clear();
     _blendshapeOffsetsInitialized = false;
 
     _addedToScene = false;
@@ -1397,7 +1395,7 @@ void Model::updateClusterMatrices() {
 
 void Model::deleteGeometry() {
     _deleteGeometryCounter++;
-    _blendshapeOffsets.clear();
+    _meshBlendshapes.clear();
     _blendshapeOffsetsInitialized = false;
     _meshStates.clear();
     _rig.destroyAnimGraph();
@@ -1637,146 +1635,133 @@ public:
 };
 
 
-using packBlendshapeOffsetTo = void(glm::uvec4& packed, const BlendshapeOffsetUnpacked& unpacked);
+// What the Blender needs from a model, snapshotted on the main thread
+struct ModelBlend {
+    ModelPointer model;
+    int blendNumber;
+    QVector<float> blendshapeCoefficients;
+    std::vector<MeshBlendshapesPointer> meshBlendshapes; // null for meshes that aren't blended
 
-void packBlendshapeOffsetTo_Pos_F32_3xSN10_Nor_3xSN10_Tan_3xSN10(glm::uvec4& packed, const BlendshapeOffsetUnpacked& unpacked) {
-    float len = glm::compMax(glm::abs(unpacked.positionOffset));
-    glm::vec3 normalizedPos(unpacked.positionOffset);
-    if (len > 1.0f) {
-        normalizedPos /= len;
-    } else {
-        len = 1.0f;
-    }
-
-    packed = glm::uvec4(
-        glm::floatBitsToUint(len),
-        glm::packSnorm3x10_1x2(glm::vec4(normalizedPos, 0.0f)),
-        glm::packSnorm3x10_1x2(glm::vec4(unpacked.normalOffset, 0.0f)),
-        glm::packSnorm3x10_1x2(glm::vec4(unpacked.tangentOffset, 0.0f))
-    );
-}
+    std::vector<float> weights;
+    QVector<BlendshapeOffset> blendshapeOffsets;
+    QVector<int> blendedMeshSizes;
+};
 
 class Blender : public QRunnable {
 public:
 
-    Blender(ModelPointer model, int blendNumber, const Geometry::WeakPointer& geometry, const QVector<float>& blendshapeCoefficients);
+    Blender(std::vector<ModelBlend>&& blends);
 
     virtual void run() override;
 
 private:
 
-    ModelPointer _model;
-    int _blendNumber;
-    Geometry::WeakPointer _geometry;
-    QVector<float> _blendshapeCoefficients;
+    std::vector<ModelBlend> _blends;
 };
 
-Blender::Blender(ModelPointer model, int blendNumber, const Geometry::WeakPointer& geometry, const QVector<float>& blendshapeCoefficients) :
-    _model(model),
-    _blendNumber(blendNumber),
-    _geometry(geometry),
-    _blendshapeCoefficients(blendshapeCoefficients) {
+Blender::Blender(std::vector<ModelBlend>&& blends) :
+    _blends(std::move(blends)) {
 }
 
 void Blender::run() {
-    QVector<BlendshapeOffset> blendshapeOffsets;
-    QVector<int> blendedMeshSizes;
-    if (_model && _model->isLoaded()) {
-        DETAILED_PROFILE_RANGE_EX(simulation_animation, __FUNCTION__, 0xFFFF0000, 0, { { "url", _model->getURL().toString() } });
-        int offset = 0;
-        auto meshes = _model->getHFMModel().meshes;
-        int meshIndex = 0;
-        foreach(const HFMMesh& mesh, meshes) {
-            auto modelMeshBlendshapeOffsets = _model->_blendshapeOffsets.find(meshIndex++);
-            if (mesh.blendshapes.isEmpty() || modelMeshBlendshapeOffsets == _model->_blendshapeOffsets.end()) {
-                // Not blendshaped or not initialized
-                blendedMeshSizes.push_back(0);
-                continue;
-            }
+    {
+        DETAILED_PROFILE_RANGE_EX(simulation_animation, __FUNCTION__, 0xFFFF0000, 0, { { "models", (int)_blends.size() } });
+
+        // split every blended mesh of every model into ranges of vertices, and blend them all in one parallel pass
+        struct VertexRange {
+            const std::vector<float>* weights;
+            const MeshBlendshapes* meshBlendshapes;
+            BlendshapeOffset* offsets;
+            int begin;
+            int end;
+        };
+        const int VERTICES_PER_RANGE = 1024;
+        std::vector<VertexRange> ranges;
 
-            if (mesh.vertices.size() != modelMeshBlendshapeOffsets->second.size()) {
-                // Mesh sizes don't match.  Something has gone wrong
-                blendedMeshSizes.push_back(0);
-                continue;
+        for (auto& blend : _blends) {
+            MeshBlendshapes::computeWeights(blend.blendshapeCoefficients, blend.weights);
+
+            int numVertices = 0;
+            for (const auto& meshBlendshapes : blend.meshBlendshapes) {
+                int meshSize = meshBlendshapes ? meshBlendshapes->getNumVertices() : 0;
+                blend.blendedMeshSizes.push_back(meshSize);
+                numVertices += meshSize;
             }
+            blend.blendshapeOffsets.resize(numVertices);
 
-            blendshapeOffsets += modelMeshBlendshapeOffsets->second;
-            BlendshapeOffset* meshBlendshapeOffsets = blendshapeOffsets.data() + offset;
-            int numVertices = modelMeshBlendshapeOffsets->second.size();
-            blendedMeshSizes.push_back(numVertices);
-            offset += numVertices;
-            std::vector<BlendshapeOffsetUnpacked> unpackedBlendshapeOffsets(modelMeshBlendshapeOffsets->second.size());
-
-            const float NORMAL_COEFFICIENT_SCALE = 0.01f;
-            for (int i = 0, n = qMin(_blendshapeCoefficients.size(), mesh.blendshapes.size()); i < n; i++) {
-                float vertexCoefficient = _blendshapeCoefficients.at(i);
-                const float EPSILON = 0.0001f;
-                if (vertexCoefficient < EPSILON) {
+            BlendshapeOffset* meshOffsets = blend.blendshapeOffsets.data();
+            for (const auto& meshBlendshapes : blend.meshBlendshapes) {
+                if (!meshBlendshapes) {
                     continue;
                 }
-
-                float normalCoefficient = vertexCoefficient * NORMAL_COEFFICIENT_SCALE;
-                const HFMBlendshape& blendshape = mesh.blendshapes.at(i);
-
-                tbb::parallel_for(tbb::blocked_range<int>(0, blendshape.indices.size()), [&](const tbb::blocked_range<int>& range) {
-                    for (auto j = range.begin(); j < range.end(); j++) {
-                        int index = blendshape.indices.at(j);
-
-                        auto& currentBlendshapeOffset = unpackedBlendshapeOffsets[index];
-                        currentBlendshapeOffset.positionOffset += blendshape.vertices.at(j) * vertexCoefficient;
-
-                        currentBlendshapeOffset.normalOffset += blendshape.normals.at(j) * normalCoefficient;
-                        if (j < blendshape.tangents.size()) {
-                            currentBlendshapeOffset.tangentOffset += blendshape.tangents.at(j) * normalCoefficient;
-                        }
-                    }
-                });
+                int meshSize = meshBlendshapes->getNumVertices();
+                for (int begin = 0; begin < meshSize; begin += VERTICES_PER_RANGE) {
+                    ranges.push_back({ &blend.weights, meshBlendshapes.get(), meshOffsets, begin,
+                        std::min(begin + VERTICES_PER_RANGE, meshSize) });
+                }
+                meshOffsets += meshSize;
             }
+        }
 
-            // Blendshape offsets are generrated, now let's pack it on its way to gpu
-            tbb::parallel_for(tbb::blocked_range<int>(0, (int) unpackedBlendshapeOffsets.size()), [&](const tbb::blocked_range<int>& range) {
-                auto unpacked = unpackedBlendshapeOffsets.data() + range.begin();
-                auto packed = meshBlendshapeOffsets + range.begin();
-                for (auto j = range.begin(); j < range.end(); j++) {
-                    packBlendshapeOffsetTo_Pos_F32_3xSN10_Nor_3xSN10_Tan_3xSN10((*packed).packedPosNorTan, (*unpacked));
+        tbb::parallel_for(tbb::blocked_range<size_t>(0, ranges.size()), [&](const tbb::blocked_range<size_t>& range) {
+            for (auto i = range.begin(); i < range.end(); i++) {
+                const VertexRange& vertexRange = ranges[i];
+                vertexRange.meshBlendshapes->blend(*vertexRange.weights, vertexRange.begin, vertexRange.end, vertexRange.offsets);
+            }
+        });
+    }
 
-                    unpacked++;
-                    packed++;
-                }
-            });
-        }
+    // post the results to the ModelBlender, which will dispatch to the models if still alive
+    auto modelBlender = DependencyManager::get<ModelBlender>();
+    for (auto& blend : _blends) {
+        QMetaObject::invokeMethod(modelBlender.data(), "setBlendedVertices", Q_ARG(ModelPointer, blend.model),
+            Q_ARG(int, blend.blendNumber), Q_ARG(QVector<BlendshapeOffset>, blend.blendshapeOffsets),
+            Q_ARG(QVector<int>, blend.blendedMeshSizes));
     }
-    // post the result to the ModelBlender, which will dispatch to the model if still alive
-    QMetaObject::invokeMethod(DependencyManager::get<ModelBlender>().data(), "setBlendedVertices",
-        Q_ARG(ModelPointer, _model), Q_ARG(int, _blendNumber), Q_ARG(QVector<BlendshapeOffset>, blendshapeOffsets), Q_ARG(QVector<int>, blendedMeshSizes));
+    QMetaObject::invokeMethod(modelBlender.data(), "blendsFinished");
 }
 
-bool Model::maybeStartBlender() {
-    if (isLoaded()) {
-        QThreadPool::globalInstance()->start(new Blender(getThisPointer(), ++_blendNumber, _renderGeometry, _blendshapeCoefficients));
-        return true;
+bool Model::prepareBlend(ModelBlend& blend) {
+    if (!isLoaded()) {
+        return false;
     }
-    return false;
+
+    blend.model = getThisPointer();
+    blend.blendNumber = ++_blendNumber;
+    blend.blendshapeCoefficients = _blendshapeCoefficients;
+
+    const auto& meshes = getHFMModel().meshes;
+    blend.meshBlendshapes.resize(meshes.size());
+    for (int i = 0; i < meshes.size(); i++) {
+        auto meshBlendshapes = _meshBlendshapes.find(i);
+        if (meshes.at(i).blendshapes.isEmpty() || meshBlendshapes == _meshBlendshapes.end()) {
+            // Not blendshaped or not initialized
+            continue;
+        }
+        if (meshes.at(i).vertices.size() != meshBlendshapes->second->getNumVertices()) {
+            // Mesh sizes don't match.  Something has gone wrong
+            continue;
+        }
+        blend.meshBlendshapes[i] = meshBlendshapes->second;
+    }
+    return true;
 }
 
 void Model::initializeBlendshapes(const HFMMesh& mesh, int index) {
     if (mesh.blendshapes.empty()) {
         // mesh doesn't have blendshape, did we allocate one though ?
-        if (_blendshapeOffsets.find(index) != _blendshapeOffsets.end()) {
+        if (_meshBlendshapes.find(index) != _meshBlendshapes.end()) {
             qWarning() << "Mesh does not have Blendshape yet the blendshapeOffsets are allocated ?";
         }
         return;
     }
-    // Mesh has blendshape, let s allocate the local buffer if not done yet
-    if (_blendshapeOffsets.find(index) == _blendshapeOffsets.end()) {
-        QVector<BlendshapeOffset> blendshapeOffset;
-        blendshapeOffset.fill(BlendshapeOffset(), mesh.vertices.size());
-        _blendshapeOffsets[index] = blendshapeOffset;
+    // Mesh has blendshape, let s lay them out for the blender if not done yet
+    if (_meshBlendshapes.find(index) == _meshBlendshapes.end()) {
+        _meshBlendshapes[index] = std::make_shared<MeshBlendshapes>(mesh);
     }
 }
 
-ModelBlender::ModelBlender() :
-    _pendingBlenders(0) {
+ModelBlender::ModelBlender() {
 }
 
 ModelBlender::~ModelBlender() {
@@ -1788,19 +1773,44 @@ void ModelBlender::noteRequiresBlend(ModelPointer model) {
         _modelsRequiringBlendsQueue.push(model);
         _modelsRequiringBlendsSet.insert(model);
     }
+    if (!_blendsPending) {
+        scheduleBlends();
+    }
+}
+
+void ModelBlender::scheduleBlends() {
+    if (!_blendsScheduled) {
+        _blendsScheduled = true;
+        QMetaObject::invokeMethod(this, "startBlends", Qt::QueuedConnection);
+    }
+}
+
+void ModelBlender::startBlends() {
+    std::vector<ModelBlend> blends;
+    {
+        Lock lock(_mutex);
+        _blendsScheduled = false;
+        if (_blendsPending) {
+            // blendsFinished() will start the next ones
+            return;
+        }
 
-    if (_pendingBlenders < QThread::idealThreadCount()) {
         while (!_modelsRequiringBlendsQueue.empty()) {
             auto weakPtr = _modelsRequiringBlendsQueue.front();
             _modelsRequiringBlendsQueue.pop();
             _modelsRequiringBlendsSet.erase(weakPtr);
             ModelPointer nextModel = weakPtr.lock();
-            if (nextModel && nextModel->maybeStartBlender()) {
-                _pendingBlenders++;
-                return;
+            ModelBlend blend;
+            if (nextModel && nextModel->prepareBlend(blend)) {
+                blends.push_back(std::move(blend));
             }
         }
+        if (blends.empty()) {
+            return;
+        }
+        _blendsPending = true;
     }
+    QThreadPool::globalInstance()->start(new Blender(std::move(blends)));
 }
 
 void ModelBlender::setBlendedVertices(ModelPointer model, int blendNumber, QVector<BlendshapeOffset> blendshapeOffsets, QVector<int> blendedMeshSizes) {
@@ -1810,19 +1820,12 @@ void ModelBlender::setBlendedVertices(ModelPointer model, int blendNumber, QVect
             blendshapeOperator(blendNumber, blendshapeOffsets, blendedMeshSizes, model->fetchRenderItemIDs());
         }
     }
+}
 
-    {
-        Lock lock(_mutex);
-        _pendingBlenders--;
-        while (!_modelsRequiringBlendsQueue.empty()) {
-            auto weakPtr = _modelsRequiringBlendsQueue.front();
-            _modelsRequiringBlendsQueue.pop();
-            _modelsRequiringBlendsSet.erase(weakPtr);
-            ModelPointer nextModel = weakPtr.lock();
-            if (nextModel && nextModel->maybeStartBlender()) {
-                _pendingBlenders++;
-                break;
-            }
-        }
+void ModelBlender::blendsFinished() {
+    Lock lock(_mutex);
+    _blendsPending = false;
+    if (!_modelsRequiringBlendsQueue.empty()) {
+        scheduleBlends();
     }
 }
@@ -35,6 +35,7 @@
 
 #include "RenderHifi.h"
 #include "GeometryCache.h"
+#include "MeshBlendshapes.h"
 #include "TextureCache.h"
 #include "Rig.h"
 #include "PrimitiveMode.h"
@@ -65,6 +66,8 @@ class Model;
 using ModelPointer = std::shared_ptr<Model>;
 using ModelWeakPointer = std::weak_ptr<Model>;
 
+struct ModelBlend;
+
 struct SortedTriangleSet {
     SortedTriangleSet(float distance, TriangleSet* triangleSet, int partIndex, int shapeID, int subMeshIndex) :
         distance(distance), triangleSet(triangleSet), partIndex(partIndex), shapeID(shapeID), subMeshIndex(subMeshIndex) {}
@@ -158,7 +161,8 @@ public:
     AABox getRenderableMeshBound() const;
     const render::ItemIDs& fetchRenderItemIDs() const;
 
-    bool maybeStartBlender();
+    /// Snapshots what the blender needs from this model, returns false if the model can't be blended yet
+    bool prepareBlend(ModelBlend& blend);
 
     bool isLoaded() const { return (bool)_renderGeometry && _renderGeometry->isHFMModelLoaded(); }
     bool isAddedToScene() const { return _addedToScene; }
@@ -360,7 +364,7 @@ public:
     void addMaterial(graphics::MaterialLayer material, const std::string& parentMaterialName);
     void removeMaterial(graphics::MaterialPointer material, const std::string& parentMaterialName);
 
-    std::unordered_map<int, QVector<BlendshapeOffset>> _blendshapeOffsets;
+    std::unordered_map<int, MeshBlendshapesPointer> _meshBlendshapes;
 
 public slots:
     void loadURLFinished(bool success);
@@ -535,6 +539,12 @@ public slots:
     void setBlendedVertices(ModelPointer model, int blendNumber, QVector<BlendshapeOffset> blendshapeOffsets, QVector<int> blendedMeshSizes);
     void setComputeBlendshapes(bool computeBlendshapes) { _computeBlendshapes = computeBlendshapes; }
 
+private slots:
+    // Blends every model that has noted it requires a blend in one job. This is queued when the first model notes that
+    // it requires a blend, so it runs once the models have all been simulated for the frame.
+    void startBlends();
+    void blendsFinished();
+
 private:
     using Mutex = std::mutex;
     using Lock = std::unique_lock<Mutex>;
@@ -542,9 +552,12 @@ private:
     ModelBlender();
     virtual ~ModelBlender();
 
+    void scheduleBlends();
+
     std::queue<ModelWeakPointer> _modelsRequiringBlendsQueue;
     std::set<ModelWeakPointer, std::owner_less<ModelWeakPointer>> _modelsRequiringBlendsSet;
-    int _pendingBlenders;
+    bool _blendsScheduled { false };
+    bool _blendsPending { false };
     Mutex _mutex;
 
     bool _computeBlendshapes { true };
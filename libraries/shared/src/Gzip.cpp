@@ -11,6 +11,10 @@
 
 #include "Gzip.h"
 
+#include <limits>
+
+#include <QIODevice>
+
 #include <zlib.h>
 
 const int GZIP_WINDOWS_BIT = 31;
@@ -153,3 +157,73 @@ bool gzip(QByteArray source, QByteArray &destination, int compressionLevel) {
     deflateEnd(&strm);
     return status == Z_STREAM_END;
 }
+
+bool hasGzipHeader(const QByteArray& data) {
+    return data.size() >= 2 && (unsigned char)data[0] == 0x1f && (unsigned char)data[1] == 0x8b;
+}
+
+GunzipStream::GunzipStream(QIODevice& source) :
+    _source(source),
+    _stream(new z_stream),
+    _input(GZIP_CHUNK_SIZE, Qt::Uninitialized)
+{
+    _stream->zalloc = Z_NULL;
+    _stream->zfree = Z_NULL;
+    _stream->opaque = Z_NULL;
+    _stream->avail_in = 0;
+    _stream->next_in = Z_NULL;
+    _status = inflateInit2(_stream.get(), GZIP_WINDOWS_BIT);
+    _initialized = _status == Z_OK;
+}
+
+GunzipStream::~GunzipStream() {
+    if (_initialized) {
+        inflateEnd(_stream.get());
+    }
+}
+
+void GunzipStream::reset() {
+    if (_initialized) {
+        _stream->avail_in = 0;
+        _stream->next_in = Z_NULL;
+        _status = inflateReset(_stream.get());
+    }
+}
+
+qint64 GunzipStream::read(char* data, qint64 maxSize) {
+    if (_status == Z_STREAM_END) {
+        return 0;
+    }
+    if (_status != Z_OK) {
+        return -1;
+    }
+
+    _stream->next_out = (unsigned char*)data;
+    _stream->avail_out = (uInt)qMin(maxSize, (qint64)std::numeric_limits<uInt>::max());
+    uInt requested = _stream->avail_out;
+
+    while (_stream->avail_out > 0 && _status == Z_OK) {
+        if (_stream->avail_in == 0) {
+            qint64 got = _source.read(_input.data(), _input.size());
+            if (got <= 0) {
+                // the device failed or ended before the gzip stream did
+                _status = Z_DATA_ERROR;
+                break;
+            }
+            _stream->next_in = (unsigned char*)_input.data();
+            _stream->avail_in = (uInt)got;
+        }
+
+        _status = inflate(_stream.get(), Z_NO_FLUSH);
+        if (_status == Z_NEED_DICT) {
+            _status = Z_DATA_ERROR;
+        }
+    }
+
+    qint64 inflated = requested - _stream->avail_out;
+    if (inflated > 0) {
+        // errors are reported by the next read
+        return inflated;
+    }
+    return _status == Z_STREAM_END ? 0 : -1;
+}
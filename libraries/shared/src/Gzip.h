@@ -12,8 +12,13 @@
 #ifndef GZIP_H
 #define GZIP_H
 
+#include <memory>
+
 #include <QByteArray>
 
+class QIODevice;
+struct z_stream_s;
+
 // The compression level must be Z_DEFAULT_COMPRESSION (-1), or between 0 and
 // 9: 1 gives best speed, 9 gives best compression, 0 gives no
 // compression at all (the input data is simply copied a block at a
@@ -24,4 +29,27 @@ bool gzip(QByteArray source, QByteArray &destination, int compressionLevel = -1)
 
 bool gunzip(QByteArray source, QByteArray &destination);
 
+// whether the data starts with the gzip magic number
+bool hasGzipHeader(const QByteArray& data);
+
+// Inflates gzipped data as it is read from a device, so that large files don't have to be held in memory whole.
+class GunzipStream {
+public:
+    GunzipStream(QIODevice& source);
+    ~GunzipStream();
+
+    // reads up to maxSize inflated bytes, returns 0 at the end of the data and -1 if it is not gzipped or is truncated
+    qint64 read(char* data, qint64 maxSize);
+
+    // starts over from the source's current position, for when the caller has seeked it back
+    void reset();
+
+private:
+    QIODevice& _source;
+    std::unique_ptr<z_stream_s> _stream;
+    QByteArray _input;
+    int _status;
+    bool _initialized;
+};
+
 #endif
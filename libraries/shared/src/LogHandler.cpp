@@ -12,32 +12,106 @@
 
 #include "LogHandler.h"
 
+#include <algorithm>
 #include <mutex>
 
 #ifdef Q_OS_WIN
 #include <windows.h>
+#else
+#include <errno.h>
+#include <unistd.h>
 #endif
 
 #include <QtCore/QCoreApplication>
+#include <QtCore/QDataStream>
 #include <QtCore/QDateTime>
 #include <QtCore/QDebug>
+#include <QtCore/QFile>
 #include <QtCore/QMutexLocker>
 #include <QtCore/QThread>
 #include <QtCore/QTimer>
 
 QMutex LogHandler::_mutex(QMutex::Recursive);
 
+// once the writer is this far behind new messages are dropped, so a log storm can't grow the queue without bound
+static const uint32_t MAX_PENDING_RECORDS = 1 << 16;
+
+// producers only wake the writer when the queue was empty, so it also polls at this interval
+static const std::chrono::milliseconds WRITER_POLL_INTERVAL { 10 };
+
+// Intrusive multiple producer, single consumer queue (Dmitry Vyukov's design). A push is a single atomic exchange
+// so logging threads never wait on each other or on the writer. pop() is only called from the writer thread and may
+// report the queue empty while a push is halfway done, the writer picks that record up on its next pass.
+class LogQueue {
+public:
+    struct Node {
+        std::atomic<Node*> next { nullptr };
+        LogRecord record;
+    };
+
+    LogQueue() : _head(&_stub), _tail(&_stub) {}
+    ~LogQueue() {
+        while (Node* node = pop()) {
+            delete node;
+        }
+    }
+
+    void push(Node* node) {
+        node->next.store(nullptr, std::memory_order_relaxed);
+        Node* previous = _head.exchange(node, std::memory_order_acq_rel);
+        previous->next.store(node, std::memory_order_release);
+    }
+
+    Node* pop() {
+        Node* tail = _tail;
+        Node* next = tail->next.load(std::memory_order_acquire);
+        if (tail == &_stub) {
+            if (!next) {
+                return nullptr;
+            }
+            _tail = next;
+            tail = next;
+            next = next->next.load(std::memory_order_acquire);
+        }
+
+        if (next) {
+            _tail = next;
+            return tail;
+        }
+
+        if (tail != _head.load(std::memory_order_acquire)) {
+            // a producer has swapped the head but hasn't linked its node yet
+            return nullptr;
+        }
+
+        // tail is the last node, put the stub behind it so it can be handed out
+        push(&_stub);
+        next = tail->next.load(std::memory_order_acquire);
+        if (next) {
+            _tail = next;
+            return tail;
+        }
+        return nullptr;
+    }
+
+private:
+    std::atomic<Node*> _head;
+    Node* _tail;
+    Node _stub;
+};
+
 LogHandler& LogHandler::getInstance() {
     static LogHandler staticInstance;
     return staticInstance;
 }
 
-LogHandler::LogHandler() {
+LogHandler::LogHandler() : _queue(new LogQueue()) {
     // make sure we setup the repeated message flusher, but do it on the LogHandler thread	
     QMetaObject::invokeMethod(this, "setupRepeatedMessageFlusher");
 }
 
 LogHandler::~LogHandler() {
+    setAsynchronous(false);
 }
 
 const char* stringForLogType(LogMsgType msgType) {
@@ -85,6 +159,52 @@ void LogHandler::setShouldDisplayMilliseconds(bool shouldDisplayMilliseconds) {
     _shouldDisplayMilliseconds = shouldDisplayMilliseconds;
 }
 
+void LogHandler::setShouldOutputToStdout(bool shouldOutputToStdout) {
+    QMutexLocker lock(&_mutex);
+    _shouldOutputToStdout = shouldOutputToStdout;
+}
+
+void LogHandler::setAsynchronous(bool asynchronous) {
+    // not _mutex, the writer takes that to read the format while we wait for it to finish
+    std::lock_guard<std::mutex> lock(_modeMutex);
+
+    if (asynchronous == isAsynchronous()) {
+        return;
+    }
+
+    if (asynchronous) {
+        startWriter();
+        _asynchronous.store(true, std::memory_order_release);
+    } else {
+        // new messages go straight to stdout from here on, the writer drains what was already queued
+        _asynchronous.store(false, std::memory_order_release);
+        stopWriter();
+    }
+}
+
+void LogHandler::flush() {
+    if (!isAsynchronous() || std::this_thread::get_id() == _writerThread.get_id()) {
+        return;
+    }
+
+    uint64_t queuedSequence = _queuedSequence.load(std::memory_order_acquire);
+    std::unique_lock<std::mutex> lock(_writerMutex);
+    _writerCondition.notify_one();
+    _flushedCondition.wait(lock, [&] {
+        return _writtenSequence >= queuedSequence || !isAsynchronous();
+    });
+}
+
+void LogHandler::addSink(LogSinkPointer sink) {
+    std::lock_guard<std::mutex> lock(_sinksMutex);
+    _sinks.push_back(sink);
+}
+
+void LogHandler::removeSink(LogSinkPointer sink) {
+    std::lock_guard<std::mutex> lock(_sinksMutex);
+    _sinks.erase(std::remove(_sinks.begin(), _sinks.end(), sink), _sinks.end());
+}
+
 
 void LogHandler::flushRepeatedMessages() {
     QMutexLocker lock(&_mutex);
@@ -95,53 +215,86 @@ void LogHandler::flushRepeatedMessages() {
         if (repeatCount > 1) {
             QString repeatLogMessage = QString().setNum(repeatCount) + " repeated log entries - Last entry: \"" 
                     + _repeatedMessageRecords[m].repeatString + "\"";
-            printMessage(LogSuppressed, QMessageLogContext(), repeatLogMessage);
+            queueMessage(LogSuppressed, QMessageLogContext(), repeatLogMessage);
             _repeatedMessageRecords[m].repeatCount = 0;
             _repeatedMessageRecords[m].repeatString = QString();
         }
     }
 }
 
-QString LogHandler::printMessage(LogMsgType type, const QMessageLogContext& context, const QString& message) {
-    if (message.isEmpty()) {
-        return QString();
-    }
-    QMutexLocker lock(&_mutex);
+struct LogFormat {
+    QString targetName;
+    bool shouldOutputProcessID;
+    bool shouldOutputThreadID;
+    bool shouldDisplayMilliseconds;
+};
 
+static QString formatRecord(const LogRecord& record, const LogFormat& format) {
     // log prefix is in the following format
     // [TIMESTAMP] [DEBUG] [PID] [TID] [TARGET] logged string
 
     const QString* dateFormatPtr = &DATE_STRING_FORMAT;
-    if (_shouldDisplayMilliseconds) {
+    if (format.shouldDisplayMilliseconds) {
         dateFormatPtr = &DATE_STRING_FORMAT_WITH_MILLISECONDS;
     }
 
-    QString prefixString = QString("[%1] [%2] [%3]").arg(QDateTime::currentDateTime().toString(*dateFormatPtr),
-        stringForLogType(type), context.category);
+    LogMsgType type = record.repeatCount > 1 ? LogSuppressed : record.type;
+    QString prefixString = QString("[%1] [%2] [%3]").arg(
+        QDateTime::fromMSecsSinceEpoch(record.timestamp).toString(*dateFormatPtr), stringForLogType(type),
+        QString::fromUtf8(record.category));
 
-    if (_shouldOutputProcessID) {
+    if (format.shouldOutputProcessID) {
         prefixString.append(QString(" [%1]").arg(QCoreApplication::applicationPid()));
     }
 
-    if (_shouldOutputThreadID) {
-        size_t threadID = (size_t)QThread::currentThreadId();
-        prefixString.append(QString(" [%1]").arg(threadID));
+    if (format.shouldOutputThreadID) {
+        prefixString.append(QString(" [%1]").arg(record.threadID));
     }
 
-    if (!_targetName.isEmpty()) {
-        prefixString.append(QString(" [%1]").arg(_targetName));
+    if (!format.targetName.isEmpty()) {
+        prefixString.append(QString(" [%1]").arg(format.targetName));
     }
 
     // for [qml] console.* messages include an abbreviated source filename
+    if (!record.file.isEmpty()) {
+        prefixString.append(QString(" [%1]").arg(QString::fromUtf8(record.file)));
+    }
+
+    QString message = record.message;
+    if (record.repeatCount > 1) {
+        message = QString("%1 repeated log entries - Last entry: \"%2\"").arg(QString::number(record.repeatCount), message);
+    }
+
+    return QString("%1 %2\n").arg(prefixString, message.split('\n').join('\n' + prefixString + " "));
+}
+
+LogRecord LogHandler::makeRecord(LogMsgType type, const QMessageLogContext& context, const QString& message) {
+    LogRecord record;
+    record.type = type;
+    record.timestamp = QDateTime::currentMSecsSinceEpoch();
+    record.threadID = (size_t)QThread::currentThreadId();
+    record.category = QByteArray(context.category);
     if (context.category && context.file && !strcmp("qml", context.category)) {
         if (const char* basename = strrchr(context.file, '/')) {
-            prefixString.append(QString(" [%1]").arg(basename+1));
+            record.file = QByteArray(basename + 1);
         }
     }
+    record.message = message;
+    return record;
+}
+
+QString LogHandler::printMessage(LogMsgType type, const QMessageLogContext& context, const QString& message) {
+    if (message.isEmpty()) {
+        return QString();
+    }
+    QMutexLocker lock(&_mutex);
 
-    QString logMessage = QString("%1 %2\n").arg(prefixString, message.split('\n').join('\n' + prefixString + " "));
+    LogFormat format { _targetName, _shouldOutputProcessID, _shouldOutputThreadID, _shouldDisplayMilliseconds };
+    QString logMessage = formatRecord(makeRecord(type, context, message), format);
 
-    fprintf(stdout, "%s", qPrintable(logMessage));
+    if (_shouldOutputToStdout) {
+        fprintf(stdout, "%s", qPrintable(logMessage));
+    }
 #ifdef Q_OS_WIN
     // On windows, this will output log lines into the Visual Studio "output" tab
     OutputDebugStringA(qPrintable(logMessage));
@@ -149,8 +302,294 @@ QString LogHandler::printMessage(LogMsgType type, const QMessageLogContext& cont
     return logMessage;
 }
 
+void LogHandler::queueMessage(LogMsgType type, const QMessageLogContext& context, const QString& message) {
+    if (!isAsynchronous() || type == LogFatal) {
+        if (type == LogFatal) {
+            // a fatal message aborts right after, so make sure everything before it makes it out first
+            flush();
+        }
+        printMessage(type, context, message);
+        return;
+    }
+
+    if (message.isEmpty()) {
+        return;
+    }
+
+    if (_pendingRecords.load(std::memory_order_relaxed) >= MAX_PENDING_RECORDS) {
+        _droppedRecords.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    auto node = new LogQueue::Node();
+    node->record = makeRecord(type, context, message);
+
+    // count the record before it's visible so the writer can't take it off the queue first
+    bool wasEmpty = _pendingRecords.fetch_add(1, std::memory_order_acq_rel) == 0;
+    _queuedSequence.fetch_add(1, std::memory_order_release);
+    _queue->push(node);
+
+    // logging went synchronous while we queued, the writer may have finished without seeing the record. Not on the
+    // writer itself, whose stopWriter() waits on it while holding _modeMutex and writes the leftovers after.
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (!isAsynchronous() && std::this_thread::get_id() != _writerThread.get_id()) {
+        std::lock_guard<std::mutex> lock(_modeMutex);
+        writeLeftoverRecords();
+        return;
+    }
+
+    if (wasEmpty) {
+        _writerCondition.notify_one();
+    }
+}
+
 void LogHandler::verboseMessageHandler(QtMsgType type, const QMessageLogContext& context, const QString& message) {
-    getInstance().printMessage((LogMsgType) type, context, message);
+    getInstance().queueMessage((LogMsgType) type, context, message);
+}
+
+void LogHandler::startWriter() {
+    _stopWriter.store(false, std::memory_order_release);
+    _writerThread = std::thread([this] {
+        writerLoop();
+    });
+}
+
+void LogHandler::stopWriter() {
+    _stopWriter.store(true, std::memory_order_release);
+    _writerCondition.notify_one();
+    if (_writerThread.joinable()) {
+        _writerThread.join();
+    }
+    _flushedCondition.notify_all();
+
+    writeLeftoverRecords();
+}
+
+// Writes what producers queued after the writer's final batch. Takes the writer's place, so _modeMutex must be held
+// and the writer stopped.
+void LogHandler::writeLeftoverRecords() {
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (isAsynchronous()) {
+        // a new writer was started, it takes them
+        return;
+    }
+
+    std::vector<LogRecord> batch;
+    while (_pendingRecords.load(std::memory_order_acquire) > 0) {
+        LogQueue::Node* node = _queue->pop();
+        if (!node) {
+            // counted but not linked in yet
+            std::this_thread::yield();
+            continue;
+        }
+        batch.push_back(std::move(node->record));
+        delete node;
+        _pendingRecords.fetch_sub(1, std::memory_order_acq_rel);
+    }
+
+    if (!batch.empty()) {
+        writeBatch(batch, true);
+        std::lock_guard<std::mutex> lock(_writerMutex);
+        _writtenSequence += batch.size();
+    }
+}
+
+void LogHandler::writerLoop() {
+    std::vector<LogRecord> batch;
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(_writerMutex);
+            _writerCondition.wait_for(lock, WRITER_POLL_INTERVAL, [&] {
+                return _pendingRecords.load(std::memory_order_acquire) > 0 || _stopWriter.load(std::memory_order_acquire);
+            });
+        }
+
+        bool isStopping = _stopWriter.load(std::memory_order_acquire);
+
+        uint32_t poppedRecords = 0;
+        while (LogQueue::Node* node = _queue->pop()) {
+            batch.push_back(std::move(node->record));
+            delete node;
+            ++poppedRecords;
+        }
+        uint32_t remainingRecords = _pendingRecords.fetch_sub(poppedRecords, std::memory_order_acq_rel) - poppedRecords;
+
+        bool isFinalBatch = isStopping && remainingRecords == 0;
+        writeBatch(batch, isFinalBatch);
+        batch.clear();
+
+        {
+            std::lock_guard<std::mutex> lock(_writerMutex);
+            _writtenSequence += poppedRecords;
+        }
+        _flushedCondition.notify_all();
+
+        if (isFinalBatch) {
+            break;
+        }
+    }
+}
+
+void LogHandler::writeBatch(std::vector<LogRecord>& batch, bool isFinalBatch) {
+    qint64 now = QDateTime::currentMSecsSinceEpoch();
+
+    std::vector<LogRecord> records;
+    records.reserve(batch.size() + 2);
+
+    auto flushRepeats = [&] {
+        if (_lastRecordRepeats > 0) {
+            // a single repeat is simply written again, longer runs are written once with their count
+            LogRecord repeated = _lastRecord;
+            repeated.repeatCount = _lastRecordRepeats;
+            records.push_back(repeated);
+            _lastRecordRepeats = 0;
+        }
+    };
+
+    // collapse runs of the same message, a log storm then costs one line per interval rather than one per message
+    for (auto& record : batch) {
+        if (!_lastRecord.message.isNull() && record.type == _lastRecord.type &&
+                record.category == _lastRecord.category && record.message == _lastRecord.message) {
+            ++_lastRecordRepeats;
+            _lastRecord.timestamp = record.timestamp;
+            _lastRecord.threadID = record.threadID;
+            continue;
+        }
+
+        flushRepeats();
+        _lastRecord = record;
+        _lastRecordTime = now;
+        records.push_back(std::move(record));
+    }
+
+    // don't sit on a run forever, report it on the same interval as the repeated message flusher
+    if (isFinalBatch || now - _lastRecordTime >= VERBOSE_LOG_INTERVAL_SECONDS * 1000) {
+        flushRepeats();
+        _lastRecord = LogRecord();
+    }
+
+    uint32_t droppedRecords = _droppedRecords.exchange(0, std::memory_order_acq_rel);
+    if (droppedRecords > 0) {
+        LogRecord dropped;
+        dropped.type = LogSuppressed;
+        dropped.timestamp = now;
+        dropped.message = QString("%1 log entries dropped - the log writer fell behind").arg(droppedRecords);
+        records.push_back(dropped);
+    }
+
+    if (records.empty()) {
+        return;
+    }
+
+    bool shouldOutputToStdout;
+    LogFormat format;
+    {
+        QMutexLocker lock(&_mutex);
+        format = { _targetName, _shouldOutputProcessID, _shouldOutputThreadID, _shouldDisplayMilliseconds };
+        shouldOutputToStdout = _shouldOutputToStdout;
+    }
+
+    QString text;
+    for (const auto& record : records) {
+        text.append(formatRecord(record, format));
+    }
+
+    QByteArray bytes = text.toLocal8Bit();
+    if (shouldOutputToStdout) {
+#ifdef Q_OS_WIN
+        fwrite(bytes.constData(), 1, bytes.size(), stdout);
+        fflush(stdout);
+#else
+        // anything printed to stdout directly goes out first, then the whole batch in one write
+        fflush(stdout);
+        const char* data = bytes.constData();
+        size_t remaining = bytes.size();
+        while (remaining > 0) {
+            ssize_t written = ::write(STDOUT_FILENO, data, remaining);
+            if (written < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                break;
+            }
+            data += written;
+            remaining -= written;
+        }
+#endif
+    }
+#ifdef Q_OS_WIN
+    OutputDebugStringA(bytes.constData());
+#endif
+
+    std::vector<LogSinkPointer> sinks;
+    {
+        std::lock_guard<std::mutex> lock(_sinksMutex);
+        sinks = _sinks;
+    }
+    for (const auto& sink : sinks) {
+        sink->writeBatch(records, text);
+    }
+}
+
+static const quint32 BINARY_LOG_MAGIC = 0x484c4f47; // "HLOG"
+static const quint32 BINARY_LOG_VERSION = 1;
+
+BinaryLogSink::BinaryLogSink(const QString& filename) : _file(new QFile(filename)) {
+    if (_file->open(QIODevice::WriteOnly | QIODevice::Append) && _file->size() == 0) {
+        QDataStream out(_file.get());
+        out << BINARY_LOG_MAGIC << BINARY_LOG_VERSION;
+    }
+}
+
+BinaryLogSink::~BinaryLogSink() {
+}
+
+bool BinaryLogSink::isOpen() const {
+    return _file->isOpen();
+}
+
+void BinaryLogSink::writeBatch(const std::vector<LogRecord>& records, const QString& text) {
+    if (!_file->isOpen()) {
+        return;
+    }
+
+    QDataStream out(_file.get());
+    for (const auto& record : records) {
+        out << (qint32)record.type << record.timestamp << (quint64)record.threadID << record.category << record.file
+            << record.message << (qint32)record.repeatCount;
+    }
+    _file->flush();
+}
+
+std::vector<LogRecord> BinaryLogSink::readRecords(const QString& filename) {
+    std::vector<LogRecord> records;
+
+    QFile file(filename);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return records;
+    }
+
+    QDataStream in(&file);
+    quint32 magic, version;
+    in >> magic >> version;
+    if (magic != BINARY_LOG_MAGIC || version != BINARY_LOG_VERSION) {
+        return records;
+    }
+
+    while (!in.atEnd() && in.status() == QDataStream::Ok) {
+        LogRecord record;
+        qint32 type, repeatCount;
+        quint64 threadID;
+        in >> type >> record.timestamp >> threadID >> record.category >> record.file >> record.message >> repeatCount;
+        if (in.status() != QDataStream::Ok) {
+            break;
+        }
+        record.type = (LogMsgType)type;
+        record.threadID = (size_t)threadID;
+        record.repeatCount = repeatCount;
+        records.push_back(record);
+    }
+    return records;
 }
 
 void LogHandler::setupRepeatedMessageFlusher() {
@@ -180,7 +619,7 @@ void LogHandler::printRepeatedMessage(int messageID, LogMsgType type, const QMes
     }
 
     if (_repeatedMessageRecords[messageID].repeatCount == 0) {
-        printMessage(type, context, message);
+        queueMessage(type, context, message);
     } else {
         _repeatedMessageRecords[messageID].repeatString = message;
     }
@@ -17,9 +17,16 @@
 #include <QString>
 #include <QRegExp>
 #include <QMutex>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
 #include <vector>
 #include <memory>
 
+class QFile;
+
 const int VERBOSE_LOG_INTERVAL_SECONDS = 5;
 
 enum LogMsgType {
@@ -31,6 +38,55 @@ enum LogMsgType {
     LogSuppressed = 100
 };
 
+/// A log message as captured on the thread that logged it, formatting is left to the log writer thread
+struct LogRecord {
+    LogMsgType type { LogDebug };
+    qint64 timestamp { 0 }; // msecs since epoch
+    size_t threadID { 0 };
+    QByteArray category;
+    QByteArray file; // abbreviated source filename, only kept for [qml] messages
+    QString message;
+    int repeatCount { 1 }; // > 1 when the record stands for a run of identical messages
+};
+
+/// Receives the records written by the asynchronous LogHandler, always called on the log writer thread
+class LogSink {
+public:
+    virtual ~LogSink() {}
+
+    /// \param records the records in the batch, with repeated messages already collapsed
+    /// \param text the formatted lines for the batch, as they were written to stdout
+    virtual void writeBatch(const std::vector<LogRecord>& records, const QString& text) = 0;
+};
+using LogSinkPointer = std::shared_ptr<LogSink>;
+
+/// Forwards the formatted text of each batch, e.g. to FileLogger::addMessage
+class TextLogSink : public LogSink {
+public:
+    TextLogSink(std::function<void(const QString&)> writer) : _writer(writer) {}
+    void writeBatch(const std::vector<LogRecord>& records, const QString& text) override { _writer(text); }
+
+private:
+    std::function<void(const QString&)> _writer;
+};
+
+/// Appends each record to a file in a compact binary form, see BinaryLogSink::readRecords
+class BinaryLogSink : public LogSink {
+public:
+    BinaryLogSink(const QString& filename);
+    ~BinaryLogSink();
+
+    bool isOpen() const;
+    void writeBatch(const std::vector<LogRecord>& records, const QString& text) override;
+
+    static std::vector<LogRecord> readRecords(const QString& filename);
+
+private:
+    std::unique_ptr<QFile> _file;
+};
+
+class LogQueue;
+
 /// Handles custom message handling and sending of stats/logs to Logstash instance
 class LogHandler : public QObject {
     Q_OBJECT
@@ -45,8 +101,26 @@ public:
     void setShouldOutputThreadID(bool shouldOutputThreadID);
     void setShouldDisplayMilliseconds(bool shouldDisplayMilliseconds);
 
+    /// writes to stdout when true, turn it off when the sinks are the only place the log should go
+    void setShouldOutputToStdout(bool shouldOutputToStdout);
+
+    /// in asynchronous mode messages are queued without taking a lock and written in batches from a writer thread,
+    /// consecutive identical messages are collapsed into a single repeat count
+    void setAsynchronous(bool asynchronous);
+    bool isAsynchronous() const { return _asynchronous.load(std::memory_order_acquire); }
+
+    /// blocks until every message queued so far has been written
+    void flush();
+
+    /// sinks only receive messages written in asynchronous mode
+    void addSink(LogSinkPointer sink);
+    void removeSink(LogSinkPointer sink);
+
     QString printMessage(LogMsgType type, const QMessageLogContext& context, const QString &message);
 
+    /// queues the message for the writer thread, falls back to printMessage when not in asynchronous mode
+    void queueMessage(LogMsgType type, const QMessageLogContext& context, const QString &message);
+
     /// a qtMessageHandler that can be hooked up to a target that links to Qt
     /// prints various process, message type, and time information
     static void verboseMessageHandler(QtMsgType type, const QMessageLogContext& context, const QString &message);
@@ -63,10 +137,40 @@ private:
 
     void flushRepeatedMessages();
 
+    static LogRecord makeRecord(LogMsgType type, const QMessageLogContext& context, const QString& message);
+
+    void startWriter();
+    void stopWriter();
+    void writeLeftoverRecords();
+    void writerLoop();
+    void writeBatch(std::vector<LogRecord>& batch, bool isFinalBatch);
+
     QString _targetName;
     bool _shouldOutputProcessID { false };
     bool _shouldOutputThreadID { false };
     bool _shouldDisplayMilliseconds { false };
+    bool _shouldOutputToStdout { true };
+
+    std::mutex _modeMutex;
+    std::atomic<bool> _asynchronous { false };
+    std::unique_ptr<LogQueue> _queue;
+    std::thread _writerThread;
+    std::atomic<bool> _stopWriter { false };
+    std::atomic<uint32_t> _pendingRecords { 0 };
+    std::atomic<uint32_t> _droppedRecords { 0 };
+    std::atomic<uint64_t> _queuedSequence { 0 };
+    uint64_t _writtenSequence { 0 };
+    std::mutex _writerMutex;
+    std::condition_variable _writerCondition;
+    std::condition_variable _flushedCondition;
+
+    // only touched by the writer thread
+    LogRecord _lastRecord;
+    int _lastRecordRepeats { 0 };
+    qint64 _lastRecordTime { 0 };
+
+    std::mutex _sinksMutex;
+    std::vector<LogSinkPointer> _sinks;
 
     int _currentMessageID { 0 };
     struct RepeatedMessageRecord {
@@ -11,6 +11,7 @@
 Q_LOGGING_CATEGORY(trace_app, "trace.app")
 Q_LOGGING_CATEGORY(trace_app_detail, "trace.app.detail")
 Q_LOGGING_CATEGORY(trace_metadata, "trace.metadata")
+Q_LOGGING_CATEGORY(trace_mixer, "trace.mixer")
 Q_LOGGING_CATEGORY(trace_network, "trace.network")
 Q_LOGGING_CATEGORY(trace_picks, "trace.picks")
 Q_LOGGING_CATEGORY(trace_parse, "trace.parse")
@@ -42,28 +43,52 @@ static bool tracingEnabled() {
 }
 
 Duration::Duration(const QLoggingCategory& category, const QString& name, uint32_t argbColor, uint64_t payload, const QVariantMap& baseArgs) : _name(name), _category(category) {
+    if (tracing::TraceRecorder::isRecording() && category.isDebugEnabled()) {
+        _recordedNameID = tracing::TraceRecorder::internName(name);
+        _isRecorded = true;
+        tracing::TraceRecorder::record(category, _recordedNameID, tracing::DurationBegin, payload);
+    }
+    if (tracingEnabled() && category.isDebugEnabled()) {
+        beginTrace(argbColor, payload, baseArgs);
+    }
+}
+
+Duration::Duration(const QLoggingCategory& category, const char* name, uint32_t argbColor, uint64_t payload, const QVariantMap& baseArgs) : _category(category) {
+    if (tracing::TraceRecorder::isRecording() && category.isDebugEnabled()) {
+        _recordedNameID = tracing::TraceRecorder::internName(name);
+        _isRecorded = true;
+        tracing::TraceRecorder::record(category, _recordedNameID, tracing::DurationBegin, payload);
+    }
     if (tracingEnabled() && category.isDebugEnabled()) {
-        QVariantMap args = baseArgs;
-        args["nv_payload"] = QVariant::fromValue(payload);
-        tracing::traceEvent(_category, _name, tracing::DurationBegin, "", args);
+        _name = name;
+        beginTrace(argbColor, payload, baseArgs);
+    }
+}
+
+void Duration::beginTrace(uint32_t argbColor, uint64_t payload, const QVariantMap& baseArgs) {
+    QVariantMap args = baseArgs;
+    args["nv_payload"] = QVariant::fromValue(payload);
+    tracing::traceEvent(_category, _name, tracing::DurationBegin, "", args);
 
 #if defined(NSIGHT_TRACING)
-        nvtxEventAttributes_t eventAttrib { 0 };
-        eventAttrib.version = NVTX_VERSION;
-        eventAttrib.size = NVTX_EVENT_ATTRIB_STRUCT_SIZE;
-        eventAttrib.colorType = NVTX_COLOR_ARGB;
-        eventAttrib.color = argbColor;
-        eventAttrib.messageType = NVTX_MESSAGE_TYPE_ASCII;
-        eventAttrib.message.ascii = name.toUtf8().data();
-        eventAttrib.payload.llValue = payload;
-        eventAttrib.payloadType = NVTX_PAYLOAD_TYPE_UNSIGNED_INT64;
+    nvtxEventAttributes_t eventAttrib { 0 };
+    eventAttrib.version = NVTX_VERSION;
+    eventAttrib.size = NVTX_EVENT_ATTRIB_STRUCT_SIZE;
+    eventAttrib.colorType = NVTX_COLOR_ARGB;
+    eventAttrib.color = argbColor;
+    eventAttrib.messageType = NVTX_MESSAGE_TYPE_ASCII;
+    eventAttrib.message.ascii = _name.toUtf8().data();
+    eventAttrib.payload.llValue = payload;
+    eventAttrib.payloadType = NVTX_PAYLOAD_TYPE_UNSIGNED_INT64;
 
-        nvtxRangePushEx(&eventAttrib);
+    nvtxRangePushEx(&eventAttrib);
 #endif
-    }
 }
 
 Duration::~Duration() {
+    if (_isRecorded) {
+        tracing::TraceRecorder::record(_category, _recordedNameID, tracing::DurationEnd);
+    }
     if (tracingEnabled() && _category.isDebugEnabled()) {
         tracing::traceEvent(_category, _name, tracing::DurationEnd);
 #ifdef NSIGHT_TRACING
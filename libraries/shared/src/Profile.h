@@ -11,12 +11,14 @@
 #define HIFI_PROFILE_
 
 #include "Trace.h"
+#include "TraceRecorder.h"
 #include "SharedUtil.h"
 
 // When profiling something that may happen many times per frame, use a xxx_detail category so that they may easily be filtered out of trace results
 Q_DECLARE_LOGGING_CATEGORY(trace_app)
 Q_DECLARE_LOGGING_CATEGORY(trace_app_detail)
 Q_DECLARE_LOGGING_CATEGORY(trace_metadata)
+Q_DECLARE_LOGGING_CATEGORY(trace_mixer)
 Q_DECLARE_LOGGING_CATEGORY(trace_network)
 Q_DECLARE_LOGGING_CATEGORY(trace_picks)
 Q_DECLARE_LOGGING_CATEGORY(trace_render)
@@ -40,14 +42,20 @@ Q_DECLARE_LOGGING_CATEGORY(trace_baker)
 class Duration {
 public:
     Duration(const QLoggingCategory& category, const QString& name, uint32_t argbColor = 0xff0000ff, uint64_t payload = 0, const QVariantMap& args = QVariantMap());
+    // only builds a QString for the name if the Tracer is enabled, the TraceRecorder doesn't need one
+    Duration(const QLoggingCategory& category, const char* name, uint32_t argbColor = 0xff0000ff, uint64_t payload = 0, const QVariantMap& args = QVariantMap());
     ~Duration();
 
     static uint64_t beginRange(const QLoggingCategory& category, const char* name, uint32_t argbColor);
     static void endRange(const QLoggingCategory& category, uint64_t rangeId);
 
 private:
+    void beginTrace(uint32_t argbColor, uint64_t payload, const QVariantMap& baseArgs);
+
     QString _name;
     const QLoggingCategory& _category;
+    uint32_t _recordedNameID { 0 };
+    bool _isRecorded { false };
 };
 
 
@@ -105,7 +113,7 @@ inline void metadata(const QString& metadataType, const QVariantMap& args) {
 #define PROFILE_COUNTER_IF_CHANGED(category, name, type, value) { static type lastValue = 0; type newValue = value;  if (newValue != lastValue) { counter(trace_##category(), name, { { name, newValue }}); lastValue = newValue; } }
 #define PROFILE_COUNTER(category, name, ...) counter(trace_##category(), name, ##__VA_ARGS__);
 #define PROFILE_INSTANT(category, name, ...) instant(trace_##category(), name, ##__VA_ARGS__);
-#define PROFILE_SET_THREAD_NAME(threadName) metadata("thread_name", { { "name", threadName } });
+#define PROFILE_SET_THREAD_NAME(threadName) do { QString profileThreadName = threadName; metadata("thread_name", { { "name", profileThreadName } }); tracing::TraceRecorder::setThreadName(profileThreadName); } while (0)
 
 #define SAMPLE_PROFILE_RANGE(chance, category, name, ...) if (randFloat() <= chance) { PROFILE_RANGE(category, name); }
 #define SAMPLE_PROFILE_RANGE_EX(chance, category, name, ...) if (randFloat() <= chance) { PROFILE_RANGE_EX(category, name, argbColor, payload, ##__VA_ARGS__); }
@@ -10,7 +10,6 @@
 //
 //
 // TODO:
-//   * consider adding iterator to enumerate the properties that have been set?
 //   * operator QSet<Enum> - this would be easiest way to handle enumeration
 //   * make encode(), QByteArray<< operator, and QByteArray operator const by moving calculation of encoded length to
 //     setFlag() and other calls
@@ -21,6 +20,11 @@
 
 #include <algorithm>
 #include <climits>
+#include <cstdint>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
 
 #include <QBitArray>
 #include <QByteArray>
@@ -28,7 +32,16 @@
 #include "ByteCountCoding.h"
 #include "SharedLogging.h"
 
-template<typename Enum>class PropertyFlags {
+/// Enums with a known upper bound can specialize this so that their PropertyFlags are stored inline in a fixed number
+/// of words instead of in a heap allocated QBitArray. FLAG_COUNT must be greater than every flag that will be set.
+template<typename Enum> struct PropertyFlagsTraits {
+    static const int FLAG_COUNT = 0; // unbounded
+};
+
+template<typename Enum, int FlagCount = PropertyFlagsTraits<Enum>::FLAG_COUNT> class PropertyFlags;
+
+/// PropertyFlags for enums with an unknown upper bound
+template<typename Enum> class PropertyFlags<Enum, 0> {
 public:
     typedef Enum enum_type;
     inline PropertyFlags() : 
@@ -103,6 +116,8 @@ public:
     PropertyFlags operator^(Enum flag) const;
     PropertyFlags operator~() const;
 
+    template<typename F> void forEachFlag(F function) const;
+
     void debugDumpBits();
 
     int getEncodedLength() const { return _encodedLength; }
@@ -118,16 +133,18 @@ private:
     int _encodedLength;
 };
 
-template<typename Enum> PropertyFlags<Enum>& operator<<(PropertyFlags<Enum>& out, const PropertyFlags<Enum>& other) {
+template<typename Enum, int FlagCount>
+PropertyFlags<Enum, FlagCount>& operator<<(PropertyFlags<Enum, FlagCount>& out, const PropertyFlags<Enum, FlagCount>& other) {
     return out <<= other;
 }
 
-template<typename Enum> PropertyFlags<Enum>& operator<<(PropertyFlags<Enum>& out, Enum flag) {
+template<typename Enum, int FlagCount>
+PropertyFlags<Enum, FlagCount>& operator<<(PropertyFlags<Enum, FlagCount>& out, Enum flag) {
     return out <<= flag;
 }
 
 
-template<typename Enum> inline void PropertyFlags<Enum>::setHasProperty(Enum flag, bool value) {
+template<typename Enum> inline void PropertyFlags<Enum, 0>::setHasProperty(Enum flag, bool value) {
     // keep track of our min flag
     if (flag < _minFlag) {
         if (value) {
@@ -149,7 +166,7 @@ template<typename Enum> inline void PropertyFlags<Enum>::setHasProperty(Enum fla
     }
 }
 
-template<typename Enum> inline bool PropertyFlags<Enum>::getHasProperty(Enum flag) const {
+template<typename Enum> inline bool PropertyFlags<Enum, 0>::getHasProperty(Enum flag) const {
     if (flag > _maxFlag) {
         return _trailingFlipped; // usually false
     }
@@ -158,7 +175,7 @@ template<typename Enum> inline bool PropertyFlags<Enum>::getHasProperty(Enum fla
 
 const int BITS_PER_BYTE = 8;
 
-template<typename Enum> inline QByteArray PropertyFlags<Enum>::encode() {
+template<typename Enum> inline QByteArray PropertyFlags<Enum, 0>::encode() {
     QByteArray output;
     
     if (_maxFlag < _minFlag) {
@@ -197,7 +214,7 @@ template<typename Enum> inline QByteArray PropertyFlags<Enum>::encode() {
 }
 
 template<typename Enum> 
-inline size_t PropertyFlags<Enum>::decode(const uint8_t* data, size_t size) {
+inline size_t PropertyFlags<Enum, 0>::decode(const uint8_t* data, size_t size) {
     clear(); // we are cleared out!
 
     size_t bytesConsumed = 0;
@@ -250,11 +267,19 @@ inline size_t PropertyFlags<Enum>::decode(const uint8_t* data, size_t size) {
     return bytesConsumed;
 }
 
-template<typename Enum> inline size_t PropertyFlags<Enum>::decode(const QByteArray& fromEncodedBytes) {
+template<typename Enum> inline size_t PropertyFlags<Enum, 0>::decode(const QByteArray& fromEncodedBytes) {
     return decode(reinterpret_cast<const uint8_t*>(fromEncodedBytes.data()), fromEncodedBytes.size());
 }
 
-template<typename Enum> inline void PropertyFlags<Enum>::debugDumpBits() {
+template<typename Enum> template<typename F> inline void PropertyFlags<Enum, 0>::forEachFlag(F function) const {
+    for (int flag = 0; flag < _flags.size(); flag++) {
+        if (_flags.testBit(flag)) {
+            function((Enum)flag);
+        }
+    }
+}
+
+template<typename Enum> inline void PropertyFlags<Enum, 0>::debugDumpBits() {
     qCDebug(shared) << "_minFlag=" << _minFlag;
     qCDebug(shared) << "_maxFlag=" << _maxFlag;
     qCDebug(shared) << "_trailingFlipped=" << _trailingFlipped;
@@ -266,21 +291,21 @@ template<typename Enum> inline void PropertyFlags<Enum>::debugDumpBits() {
 }
 
 
-template<typename Enum> inline PropertyFlags<Enum>& PropertyFlags<Enum>::operator=(const PropertyFlags& other) {
+template<typename Enum> inline PropertyFlags<Enum, 0>& PropertyFlags<Enum, 0>::operator=(const PropertyFlags& other) {
     _flags = other._flags; 
     _maxFlag = other._maxFlag; 
     _minFlag = other._minFlag; 
     return *this; 
 }
 
-template<typename Enum> inline PropertyFlags<Enum>& PropertyFlags<Enum>::operator|=(const PropertyFlags& other) {
+template<typename Enum> inline PropertyFlags<Enum, 0>& PropertyFlags<Enum, 0>::operator|=(const PropertyFlags& other) {
     _flags |= other._flags; 
     _maxFlag = std::max(_maxFlag, other._maxFlag); 
     _minFlag = std::min(_minFlag, other._minFlag); 
     return *this; 
 }
 
-template<typename Enum> inline PropertyFlags<Enum>& PropertyFlags<Enum>::operator|=(Enum flag) {
+template<typename Enum> inline PropertyFlags<Enum, 0>& PropertyFlags<Enum, 0>::operator|=(Enum flag) {
     PropertyFlags other(flag); 
     _flags |= other._flags; 
     _maxFlag = std::max(_maxFlag, other._maxFlag); 
@@ -288,33 +313,33 @@ template<typename Enum> inline PropertyFlags<Enum>& PropertyFlags<Enum>::operato
     return *this; 
 }
 
-template<typename Enum> inline PropertyFlags<Enum>& PropertyFlags<Enum>::operator&=(const PropertyFlags& other) {
+template<typename Enum> inline PropertyFlags<Enum, 0>& PropertyFlags<Enum, 0>::operator&=(const PropertyFlags& other) {
     _flags &= other._flags; 
     shrinkIfNeeded(); 
     return *this; 
 }
 
-template<typename Enum> inline PropertyFlags<Enum>& PropertyFlags<Enum>::operator&=(Enum flag) {
+template<typename Enum> inline PropertyFlags<Enum, 0>& PropertyFlags<Enum, 0>::operator&=(Enum flag) {
     PropertyFlags other(flag); 
     _flags &= other._flags; 
     shrinkIfNeeded(); 
     return *this; 
 }
 
-template<typename Enum> inline PropertyFlags<Enum>& PropertyFlags<Enum>::operator^=(const PropertyFlags& other) {
+template<typename Enum> inline PropertyFlags<Enum, 0>& PropertyFlags<Enum, 0>::operator^=(const PropertyFlags& other) {
     _flags ^= other._flags; 
     shrinkIfNeeded(); 
     return *this; 
 }
 
-template<typename Enum> inline PropertyFlags<Enum>& PropertyFlags<Enum>::operator^=(Enum flag) {
+template<typename Enum> inline PropertyFlags<Enum, 0>& PropertyFlags<Enum, 0>::operator^=(Enum flag) {
     PropertyFlags other(flag); 
     _flags ^= other._flags; 
     shrinkIfNeeded(); 
     return *this; 
 }
 
-template<typename Enum> inline PropertyFlags<Enum>& PropertyFlags<Enum>::operator+=(const PropertyFlags& other) {
+template<typename Enum> inline PropertyFlags<Enum, 0>& PropertyFlags<Enum, 0>::operator+=(const PropertyFlags& other) {
     for(int flag = (int)other.firstFlag(); flag <= (int)other.lastFlag(); flag++) {
         if (other.getHasProperty((Enum)flag)) {
             setHasProperty((Enum)flag, true);
@@ -323,12 +348,12 @@ template<typename Enum> inline PropertyFlags<Enum>& PropertyFlags<Enum>::operato
     return *this; 
 }
 
-template<typename Enum> inline PropertyFlags<Enum>& PropertyFlags<Enum>::operator+=(Enum flag) {
+template<typename Enum> inline PropertyFlags<Enum, 0>& PropertyFlags<Enum, 0>::operator+=(Enum flag) {
     setHasProperty(flag, true);
     return *this; 
 }
 
-template<typename Enum> inline PropertyFlags<Enum>& PropertyFlags<Enum>::operator-=(const PropertyFlags& other) {
+template<typename Enum> inline PropertyFlags<Enum, 0>& PropertyFlags<Enum, 0>::operator-=(const PropertyFlags& other) {
     for(int flag = (int)other.firstFlag(); flag <= (int)other.lastFlag(); flag++) {
         if (other.getHasProperty((Enum)flag)) {
             setHasProperty((Enum)flag, false);
@@ -337,12 +362,12 @@ template<typename Enum> inline PropertyFlags<Enum>& PropertyFlags<Enum>::operato
     return *this;
 }
 
-template<typename Enum> inline PropertyFlags<Enum>& PropertyFlags<Enum>::operator-=(Enum flag) {
+template<typename Enum> inline PropertyFlags<Enum, 0>& PropertyFlags<Enum, 0>::operator-=(Enum flag) {
     setHasProperty(flag, false);
     return *this; 
 }
 
-template<typename Enum> inline PropertyFlags<Enum>& PropertyFlags<Enum>::operator<<=(const PropertyFlags& other) {
+template<typename Enum> inline PropertyFlags<Enum, 0>& PropertyFlags<Enum, 0>::operator<<=(const PropertyFlags& other) {
     for(int flag = (int)other.firstFlag(); flag <= (int)other.lastFlag(); flag++) {
         if (other.getHasProperty((Enum)flag)) {
             setHasProperty((Enum)flag, true);
@@ -351,94 +376,94 @@ template<typename Enum> inline PropertyFlags<Enum>& PropertyFlags<Enum>::operato
     return *this; 
 }
 
-template<typename Enum> inline PropertyFlags<Enum>& PropertyFlags<Enum>::operator<<=(Enum flag) {
+template<typename Enum> inline PropertyFlags<Enum, 0>& PropertyFlags<Enum, 0>::operator<<=(Enum flag) {
     setHasProperty(flag, true);
     return *this; 
 }
 
-template<typename Enum> inline PropertyFlags<Enum> PropertyFlags<Enum>::operator|(const PropertyFlags& other) const {
+template<typename Enum> inline PropertyFlags<Enum, 0> PropertyFlags<Enum, 0>::operator|(const PropertyFlags& other) const {
     PropertyFlags result(*this); 
     result |= other; 
     return result; 
 }
 
-template<typename Enum> inline PropertyFlags<Enum> PropertyFlags<Enum>::operator|(Enum flag) const {
+template<typename Enum> inline PropertyFlags<Enum, 0> PropertyFlags<Enum, 0>::operator|(Enum flag) const {
     PropertyFlags result(*this); 
     PropertyFlags other(flag); 
     result |= other; 
     return result; 
 }
 
-template<typename Enum> inline PropertyFlags<Enum> PropertyFlags<Enum>::operator&(const PropertyFlags& other) const {
+template<typename Enum> inline PropertyFlags<Enum, 0> PropertyFlags<Enum, 0>::operator&(const PropertyFlags& other) const {
     PropertyFlags result(*this); 
     result &= other; 
     return result; 
 }
 
-template<typename Enum> inline PropertyFlags<Enum> PropertyFlags<Enum>::operator&(Enum flag) const { 
+template<typename Enum> inline PropertyFlags<Enum, 0> PropertyFlags<Enum, 0>::operator&(Enum flag) const { 
     PropertyFlags result(*this); 
     PropertyFlags other(flag); 
     result &= other; 
     return result; 
 }
 
-template<typename Enum> inline PropertyFlags<Enum> PropertyFlags<Enum>::operator^(const PropertyFlags& other) const {
+template<typename Enum> inline PropertyFlags<Enum, 0> PropertyFlags<Enum, 0>::operator^(const PropertyFlags& other) const {
     PropertyFlags result(*this); 
     result ^= other; 
     return result; 
 }
 
-template<typename Enum> inline PropertyFlags<Enum> PropertyFlags<Enum>::operator^(Enum flag) const {
+template<typename Enum> inline PropertyFlags<Enum, 0> PropertyFlags<Enum, 0>::operator^(Enum flag) const {
     PropertyFlags result(*this); 
     PropertyFlags other(flag); 
     result ^= other; 
     return result; 
 }
 
-template<typename Enum> inline PropertyFlags<Enum> PropertyFlags<Enum>::operator+(const PropertyFlags& other) const {
+template<typename Enum> inline PropertyFlags<Enum, 0> PropertyFlags<Enum, 0>::operator+(const PropertyFlags& other) const {
     PropertyFlags result(*this); 
     result += other; 
     return result; 
 }
 
-template<typename Enum> inline PropertyFlags<Enum> PropertyFlags<Enum>::operator+(Enum flag) const { 
+template<typename Enum> inline PropertyFlags<Enum, 0> PropertyFlags<Enum, 0>::operator+(Enum flag) const { 
     PropertyFlags result(*this); 
     result.setHasProperty(flag, true);
     return result; 
 }
 
-template<typename Enum> inline PropertyFlags<Enum> PropertyFlags<Enum>::operator-(const PropertyFlags& other) const {
+template<typename Enum> inline PropertyFlags<Enum, 0> PropertyFlags<Enum, 0>::operator-(const PropertyFlags& other) const {
     PropertyFlags result(*this); 
     result -= other; 
     return result; 
 }
 
-template<typename Enum> inline PropertyFlags<Enum> PropertyFlags<Enum>::operator-(Enum flag) const { 
+template<typename Enum> inline PropertyFlags<Enum, 0> PropertyFlags<Enum, 0>::operator-(Enum flag) const { 
     PropertyFlags result(*this); 
     result.setHasProperty(flag, false);
     return result; 
 }
 
-template<typename Enum> inline PropertyFlags<Enum> PropertyFlags<Enum>::operator<<(const PropertyFlags& other) const {
+template<typename Enum> inline PropertyFlags<Enum, 0> PropertyFlags<Enum, 0>::operator<<(const PropertyFlags& other) const {
     PropertyFlags result(*this); 
     result <<= other; 
     return result; 
 }
 
-template<typename Enum> inline PropertyFlags<Enum> PropertyFlags<Enum>::operator<<(Enum flag) const { 
+template<typename Enum> inline PropertyFlags<Enum, 0> PropertyFlags<Enum, 0>::operator<<(Enum flag) const { 
     PropertyFlags result(*this); 
     result.setHasProperty(flag, true);
     return result; 
 }
 
-template<typename Enum> inline PropertyFlags<Enum> PropertyFlags<Enum>::operator~() const { 
+template<typename Enum> inline PropertyFlags<Enum, 0> PropertyFlags<Enum, 0>::operator~() const { 
     PropertyFlags result(*this); 
     result._flags = ~_flags;
     result._trailingFlipped = !_trailingFlipped;
     return result; 
 }
 
-template<typename Enum> inline void PropertyFlags<Enum>::shrinkIfNeeded() {
+template<typename Enum> inline void PropertyFlags<Enum, 0>::shrinkIfNeeded() {
     int maxFlagWas = _maxFlag;
     while (_maxFlag >= 0) {
         if (_flags.testBit(_maxFlag)) {
@@ -451,11 +476,531 @@ template<typename Enum> inline void PropertyFlags<Enum>::shrinkIfNeeded() {
     }
 }
 
-template<typename Enum> inline QByteArray& operator<<(QByteArray& out, PropertyFlags<Enum>& value) {
+namespace PropertyFlagsUtil {
+
+    inline uint8_t reverseBits(uint8_t byte) {
+        static const uint8_t REVERSED_BITS[256] = {
+            0x00, 0x80, 0x40, 0xC0, 0x20, 0xA0, 0x60, 0xE0, 0x10, 0x90, 0x50, 0xD0, 0x30, 0xB0, 0x70, 0xF0,
+            0x08, 0x88, 0x48, 0xC8, 0x28, 0xA8, 0x68, 0xE8, 0x18, 0x98, 0x58, 0xD8, 0x38, 0xB8, 0x78, 0xF8,
+            0x04, 0x84, 0x44, 0xC4, 0x24, 0xA4, 0x64, 0xE4, 0x14, 0x94, 0x54, 0xD4, 0x34, 0xB4, 0x74, 0xF4,
+            0x0C, 0x8C, 0x4C, 0xCC, 0x2C, 0xAC, 0x6C, 0xEC, 0x1C, 0x9C, 0x5C, 0xDC, 0x3C, 0xBC, 0x7C, 0xFC,
+            0x02, 0x82, 0x42, 0xC2, 0x22, 0xA2, 0x62, 0xE2, 0x12, 0x92, 0x52, 0xD2, 0x32, 0xB2, 0x72, 0xF2,
+            0x0A, 0x8A, 0x4A, 0xCA, 0x2A, 0xAA, 0x6A, 0xEA, 0x1A, 0x9A, 0x5A, 0xDA, 0x3A, 0xBA, 0x7A, 0xFA,
+            0x06, 0x86, 0x46, 0xC6, 0x26, 0xA6, 0x66, 0xE6, 0x16, 0x96, 0x56, 0xD6, 0x36, 0xB6, 0x76, 0xF6,
+            0x0E, 0x8E, 0x4E, 0xCE, 0x2E, 0xAE, 0x6E, 0xEE, 0x1E, 0x9E, 0x5E, 0xDE, 0x3E, 0xBE, 0x7E, 0xFE,
+            0x01, 0x81, 0x41, 0xC1, 0x21, 0xA1, 0x61, 0xE1, 0x11, 0x91, 0x51, 0xD1, 0x31, 0xB1, 0x71, 0xF1,
+            0x09, 0x89, 0x49, 0xC9, 0x29, 0xA9, 0x69, 0xE9, 0x19, 0x99, 0x59, 0xD9, 0x39, 0xB9, 0x79, 0xF9,
+            0x05, 0x85, 0x45, 0xC5, 0x25, 0xA5, 0x65, 0xE5, 0x15, 0x95, 0x55, 0xD5, 0x35, 0xB5, 0x75, 0xF5,
+            0x0D, 0x8D, 0x4D, 0xCD, 0x2D, 0xAD, 0x6D, 0xED, 0x1D, 0x9D, 0x5D, 0xDD, 0x3D, 0xBD, 0x7D, 0xFD,
+            0x03, 0x83, 0x43, 0xC3, 0x23, 0xA3, 0x63, 0xE3, 0x13, 0x93, 0x53, 0xD3, 0x33, 0xB3, 0x73, 0xF3,
+            0x0B, 0x8B, 0x4B, 0xCB, 0x2B, 0xAB, 0x6B, 0xEB, 0x1B, 0x9B, 0x5B, 0xDB, 0x3B, 0xBB, 0x7B, 0xFB,
+            0x07, 0x87, 0x47, 0xC7, 0x27, 0xA7, 0x67, 0xE7, 0x17, 0x97, 0x57, 0xD7, 0x37, 0xB7, 0x77, 0xF7,
+            0x0F, 0x8F, 0x4F, 0xCF, 0x2F, 0xAF, 0x6F, 0xEF, 0x1F, 0x9F, 0x5F, 0xDF, 0x3F, 0xBF, 0x7F, 0xFF
+        };
+        return REVERSED_BITS[byte];
+    }
+
+    // index of the lowest set bit, word must not be 0
+    inline int lowestBit(uint64_t word) {
+#if defined(_MSC_VER)
+        unsigned long index;
+        _BitScanForward64(&index, word);
+        return (int)index;
+#elif defined(__GNUC__)
+        return __builtin_ctzll(word);
+#else
+        int index = 0;
+        while (!(word & 1)) {
+            word >>= 1;
+            index++;
+        }
+        return index;
+#endif
+    }
+
+    // index of the highest set bit, word must not be 0
+    inline int highestBit(uint64_t word) {
+#if defined(_MSC_VER)
+        unsigned long index;
+        _BitScanReverse64(&index, word);
+        return (int)index;
+#elif defined(__GNUC__)
+        return 63 - __builtin_clzll(word);
+#else
+        int index = 0;
+        while (word >>= 1) {
+            index++;
+        }
+        return index;
+#endif
+    }
+
+    // number of set bits before the first clear bit, counting from the most significant bit
+    inline int leadingOnes(uint8_t byte) {
+        return byte == 0xFF ? BITS_PER_BYTE : 7 - highestBit((uint8_t)~byte);
+    }
+}
+
+/// PropertyFlags for enums with a known upper bound, see PropertyFlagsTraits. The flags live in an inline array of
+/// words so copies don't allocate, and set operations, encode() and decode() work a word or a byte at a time. The
+/// behavior and encoded form match the QBitArray backed version above.
+template<typename Enum, int FlagCount> class PropertyFlags {
+public:
+    typedef Enum enum_type;
+    inline PropertyFlags() :
+            _bitCount(0), _maxFlag(INT_MIN), _minFlag(INT_MAX), _trailingFlipped(false), _encodedLength(0) { clearWords(); };
+
+    inline PropertyFlags(const PropertyFlags& other) :
+            _bitCount(other._bitCount), _maxFlag(other._maxFlag), _minFlag(other._minFlag),
+            _trailingFlipped(other._trailingFlipped), _encodedLength(0) { copyWords(other); }
+
+    inline PropertyFlags(Enum flag) :
+            _bitCount(0), _maxFlag(INT_MIN), _minFlag(INT_MAX), _trailingFlipped(false), _encodedLength(0) {
+        clearWords();
+        setHasProperty(flag);
+    }
+
+    inline PropertyFlags(const QByteArray& fromEncoded) :
+            _bitCount(0), _maxFlag(INT_MIN), _minFlag(INT_MAX), _trailingFlipped(false), _encodedLength(0) {
+        decode(fromEncoded);
+    }
+
+    void clear() {
+        clearWords();
+        _bitCount = 0;
+        _maxFlag = INT_MIN;
+        _minFlag = INT_MAX;
+        _trailingFlipped = false;
+        _encodedLength = 0;
+    }
+    bool isEmpty() const { return _maxFlag == INT_MIN && _minFlag == INT_MAX && _trailingFlipped == false && _encodedLength == 0; }
+
+    Enum firstFlag() const { return (Enum)_minFlag; }
+    Enum lastFlag() const { return (Enum)_maxFlag; }
+
+    void setHasProperty(Enum flag, bool value = true);
+    bool getHasProperty(Enum flag) const;
+    QByteArray encode();
+    size_t decode(const uint8_t* data, size_t length);
+    size_t decode(const QByteArray& fromEncoded);
+
+    operator QByteArray() { return encode(); };
+
+    bool operator==(const PropertyFlags& other) const;
+    bool operator!=(const PropertyFlags& other) const { return !(*this == other); }
+    bool operator!() const { return _bitCount == 0; }
+
+    PropertyFlags& operator=(const PropertyFlags& other);
+
+    PropertyFlags& operator|=(const PropertyFlags& other);
+    PropertyFlags& operator|=(Enum flag) { return *this |= PropertyFlags(flag); }
+
+    PropertyFlags& operator&=(const PropertyFlags& other);
+    PropertyFlags& operator&=(Enum flag) { return *this &= PropertyFlags(flag); }
+
+    PropertyFlags& operator+=(const PropertyFlags& other);
+    PropertyFlags& operator+=(Enum flag) { setHasProperty(flag, true); return *this; }
+
+    PropertyFlags& operator-=(const PropertyFlags& other);
+    PropertyFlags& operator-=(Enum flag) { setHasProperty(flag, false); return *this; }
+
+    PropertyFlags& operator<<=(const PropertyFlags& other) { return *this += other; }
+    PropertyFlags& operator<<=(Enum flag) { setHasProperty(flag, true); return *this; }
+
+    PropertyFlags operator|(const PropertyFlags& other) const { PropertyFlags result(*this); return result |= other; }
+    PropertyFlags operator|(Enum flag) const { PropertyFlags result(*this); return result |= flag; }
+
+    PropertyFlags operator&(const PropertyFlags& other) const { PropertyFlags result(*this); return result &= other; }
+    PropertyFlags operator&(Enum flag) const { PropertyFlags result(*this); return result &= flag; }
+
+    PropertyFlags operator+(const PropertyFlags& other) const { PropertyFlags result(*this); return result += other; }
+    PropertyFlags operator+(Enum flag) const { PropertyFlags result(*this); return result += flag; }
+
+    PropertyFlags operator-(const PropertyFlags& other) const { PropertyFlags result(*this); return result -= other; }
+    PropertyFlags operator-(Enum flag) const { PropertyFlags result(*this); return result -= flag; }
+
+    PropertyFlags operator<<(const PropertyFlags& other) const { PropertyFlags result(*this); return result <<= other; }
+    PropertyFlags operator<<(Enum flag) const { PropertyFlags result(*this); return result <<= flag; }
+
+    // NOTE: as with the QBitArray backed version, these operators only perform their bitwise operations on the set of
+    // properties that have been previously set
+    PropertyFlags& operator^=(const PropertyFlags& other);
+    PropertyFlags& operator^=(Enum flag) { return *this ^= PropertyFlags(flag); }
+    PropertyFlags operator^(const PropertyFlags& other) const { PropertyFlags result(*this); return result ^= other; }
+    PropertyFlags operator^(Enum flag) const { PropertyFlags result(*this); return result ^= flag; }
+    PropertyFlags operator~() const;
+
+    /// calls function with each flag that is set, in increasing order
+    template<typename F> void forEachFlag(F function) const;
+
+    void debugDumpBits();
+
+    int getEncodedLength() const { return _encodedLength; }
+
+private:
+    static const int BITS_PER_WORD = 64;
+    static const int WORD_COUNT = (FlagCount + BITS_PER_WORD - 1) / BITS_PER_WORD;
+
+    // mask of the bits in word that hold flags first through last
+    static uint64_t rangeMask(int word, int first, int last);
+
+    void clearWords() { std::fill(_words, _words + WORD_COUNT, 0); }
+    void copyWords(const PropertyFlags& other) { std::copy(other._words, other._words + WORD_COUNT, _words); }
+    void resize(int bitCount);
+    uint8_t flagsByteAt(int firstFlag) const;
+    void orFlagsByteAt(int firstFlag, uint8_t bits);
+    void shrinkIfNeeded();
+
+    uint64_t _words[WORD_COUNT];
+    int _bitCount; /// the bits in use, as with the QBitArray this can run past _maxFlag after &= and ^=
+    int _maxFlag;
+    int _minFlag;
+    bool _trailingFlipped; /// are the trailing properties flipping in their state (e.g. assumed true, instead of false)
+    int _encodedLength;
+};
+
+template<typename Enum, int FlagCount>
+inline uint64_t PropertyFlags<Enum, FlagCount>::rangeMask(int word, int first, int last) {
+    int wordFirst = word * BITS_PER_WORD;
+    int wordLast = wordFirst + BITS_PER_WORD - 1;
+    if (last < wordFirst || first > wordLast) {
+        return 0;
+    }
+    uint64_t mask = ~(uint64_t)0;
+    if (first > wordFirst) {
+        mask &= mask << (first - wordFirst);
+    }
+    if (last < wordLast) {
+        mask &= ~(uint64_t)0 >> (wordLast - last);
+    }
+    return mask;
+}
+
+template<typename Enum, int FlagCount>
+inline void PropertyFlags<Enum, FlagCount>::resize(int bitCount) {
+    for (int i = bitCount / BITS_PER_WORD; i < WORD_COUNT; i++) {
+        _words[i] &= ~rangeMask(i, bitCount, FlagCount - 1);
+    }
+    _bitCount = bitCount;
+}
+
+template<typename Enum, int FlagCount>
+inline void PropertyFlags<Enum, FlagCount>::setHasProperty(Enum flag, bool value) {
+    if ((int)flag < 0 || (int)flag >= FlagCount) {
+        return; // outside of the range these flags can hold
+    }
+    // keep track of our min flag
+    if (flag < _minFlag) {
+        if (value) {
+            _minFlag = flag;
+        }
+    }
+    if (flag > _maxFlag) {
+        if (value) {
+            _maxFlag = flag;
+            resize(_maxFlag + 1);
+        } else {
+            return; // bail early, we're setting a flag outside of our current _maxFlag to false, which is already the default
+        }
+    }
+    uint64_t bit = (uint64_t)1 << (flag % BITS_PER_WORD);
+    if (value) {
+        _words[flag / BITS_PER_WORD] |= bit;
+    } else {
+        _words[flag / BITS_PER_WORD] &= ~bit;
+    }
+
+    if (flag == _maxFlag && !value) {
+        shrinkIfNeeded();
+    }
+}
+
+template<typename Enum, int FlagCount>
+inline bool PropertyFlags<Enum, FlagCount>::getHasProperty(Enum flag) const {
+    if (flag > _maxFlag) {
+        return _trailingFlipped; // usually false
+    }
+    if ((int)flag < 0) {
+        return false;
+    }
+    return (_words[flag / BITS_PER_WORD] >> (flag % BITS_PER_WORD)) & 1;
+}
+
+template<typename Enum, int FlagCount>
+inline uint8_t PropertyFlags<Enum, FlagCount>::flagsByteAt(int firstFlag) const {
+    if (firstFlag < 0) {
+        return firstFlag <= -BITS_PER_BYTE ? 0 : (uint8_t)(flagsByteAt(0) << -firstFlag);
+    }
+    int word = firstFlag / BITS_PER_WORD;
+    if (word >= WORD_COUNT) {
+        return 0;
+    }
+    int offset = firstFlag % BITS_PER_WORD;
+    uint64_t bits = _words[word] >> offset;
+    if (offset > BITS_PER_WORD - BITS_PER_BYTE && word + 1 < WORD_COUNT) {
+        bits |= _words[word + 1] << (BITS_PER_WORD - offset);
+    }
+    return (uint8_t)bits;
+}
+
+template<typename Enum, int FlagCount>
+inline void PropertyFlags<Enum, FlagCount>::orFlagsByteAt(int firstFlag, uint8_t bits) {
+    int word = firstFlag / BITS_PER_WORD;
+    if (bits == 0 || word >= WORD_COUNT) {
+        return;
+    }
+    int offset = firstFlag % BITS_PER_WORD;
+    _words[word] |= (uint64_t)bits << offset;
+    if (offset > BITS_PER_WORD - BITS_PER_BYTE && word + 1 < WORD_COUNT) {
+        _words[word + 1] |= (uint64_t)bits >> (BITS_PER_WORD - offset);
+    }
+}
+
+template<typename Enum, int FlagCount>
+inline QByteArray PropertyFlags<Enum, FlagCount>::encode() {
+    QByteArray output;
+
+    if (_maxFlag < _minFlag) {
+        output.fill(0, 1);
+        return output; // no flags... nothing to encode
+    }
+
+    int lengthInBytes = (_maxFlag / (BITS_PER_BYTE - 1)) + 1;
+    output.resize(lengthInBytes);
+    uint8_t* outputBytes = reinterpret_cast<uint8_t*>(output.data());
+
+    // the first lengthInBytes - 1 bits are set and the next is clear, then the flags follow most significant bit
+    // first, so each output byte is its header bits over the reversed run of flags starting lengthInBytes bits earlier
+    for (int i = 0; i < lengthInBytes; i++) {
+        int headerBits = std::min(std::max(lengthInBytes - 1 - i * BITS_PER_BYTE, 0), BITS_PER_BYTE);
+        uint8_t header = (uint8_t)(0xFF00 >> headerBits);
+        int firstFlag = i * BITS_PER_BYTE - lengthInBytes;
+        uint8_t flags = flagsByteAt(firstFlag);
+        if (_maxFlag - firstFlag < BITS_PER_BYTE - 1) {
+            flags &= (uint8_t)~(0xFF << (_maxFlag - firstFlag + 1)); // only the flags up to _maxFlag are encoded
+        }
+        outputBytes[i] = header | PropertyFlagsUtil::reverseBits(flags);
+    }
+
+    _encodedLength = lengthInBytes;
+    return output;
+}
+
+template<typename Enum, int FlagCount>
+inline size_t PropertyFlags<Enum, FlagCount>::decode(const uint8_t* data, size_t size) {
+    clear(); // we are cleared out!
+
+    // the lead bits are a run of set bits, one per encoded byte after the first, ended by a clear bit
+    size_t leadBytes = 0;
+    while (leadBytes < size && data[leadBytes] == 0xFF) {
+        leadBytes++;
+    }
+    if (leadBytes == size) {
+        _encodedLength = (int)size;
+        return size; // never found the end of the lead bits
+    }
+    int leadBits = (int)leadBytes * BITS_PER_BYTE + PropertyFlagsUtil::leadingOnes(data[leadBytes]) + 1;
+    size_t encodedByteCount = leadBits;
+    size_t bytesConsumed = std::min(encodedByteCount, size);
+
+    // the value bits are most significant bit first, so each reversed byte lines up with the flags it holds
+    for (size_t i = leadBytes; i < bytesConsumed; i++) {
+        int firstFlag = (int)i * BITS_PER_BYTE - leadBits;
+        uint8_t bits = PropertyFlagsUtil::reverseBits(data[i]);
+        if (firstFlag < 0) {
+            bits = (uint8_t)(bits >> -firstFlag); // drop the lead bits
+            firstFlag = 0;
+        }
+        orFlagsByteAt(firstFlag, bits);
+    }
+    if (FlagCount % BITS_PER_WORD) {
+        _words[WORD_COUNT - 1] &= rangeMask(WORD_COUNT - 1, 0, FlagCount - 1);
+    }
+
+    for (int i = 0; i < WORD_COUNT; i++) {
+        if (_words[i]) {
+            _minFlag = i * BITS_PER_WORD + PropertyFlagsUtil::lowestBit(_words[i]);
+            break;
+        }
+    }
+    for (int i = WORD_COUNT - 1; i >= 0; i--) {
+        if (_words[i]) {
+            _maxFlag = i * BITS_PER_WORD + PropertyFlagsUtil::highestBit(_words[i]);
+            _bitCount = _maxFlag + 1;
+            break;
+        }
+    }
+
+    _encodedLength = (int)bytesConsumed;
+    return bytesConsumed;
+}
+
+template<typename Enum, int FlagCount>
+inline size_t PropertyFlags<Enum, FlagCount>::decode(const QByteArray& fromEncodedBytes) {
+    return decode(reinterpret_cast<const uint8_t*>(fromEncodedBytes.data()), fromEncodedBytes.size());
+}
+
+template<typename Enum, int FlagCount>
+template<typename F> inline void PropertyFlags<Enum, FlagCount>::forEachFlag(F function) const {
+    for (int i = 0; i < WORD_COUNT; i++) {
+        uint64_t word = _words[i];
+        while (word) {
+            function((Enum)(i * BITS_PER_WORD + PropertyFlagsUtil::lowestBit(word)));
+            word &= word - 1;
+        }
+    }
+}
+
+template<typename Enum, int FlagCount>
+inline void PropertyFlags<Enum, FlagCount>::debugDumpBits() {
+    qCDebug(shared) << "_minFlag=" << _minFlag;
+    qCDebug(shared) << "_maxFlag=" << _maxFlag;
+    qCDebug(shared) << "_trailingFlipped=" << _trailingFlipped;
+    QString bits;
+    for (int i = 0; i < _bitCount; i++) {
+        bits += ((_words[i / BITS_PER_WORD] >> (i % BITS_PER_WORD)) & 1 ? "1" : "0");
+    }
+    qCDebug(shared) << "bits:" << bits;
+}
+
+template<typename Enum, int FlagCount>
+inline bool PropertyFlags<Enum, FlagCount>::operator==(const PropertyFlags& other) const {
+    if (_bitCount != other._bitCount) {
+        return false;
+    }
+    return std::equal(_words, _words + WORD_COUNT, other._words);
+}
+
+template<typename Enum, int FlagCount>
+inline PropertyFlags<Enum, FlagCount>& PropertyFlags<Enum, FlagCount>::operator=(const PropertyFlags& other) {
+    copyWords(other);
+    _bitCount = other._bitCount;
+    _maxFlag = other._maxFlag;
+    _minFlag = other._minFlag;
+    return *this;
+}
+
+template<typename Enum, int FlagCount>
+inline PropertyFlags<Enum, FlagCount>& PropertyFlags<Enum, FlagCount>::operator|=(const PropertyFlags& other) {
+    for (int i = 0; i < WORD_COUNT; i++) {
+        _words[i] |= other._words[i];
+    }
+    _bitCount = std::max(_bitCount, other._bitCount);
+    _maxFlag = std::max(_maxFlag, other._maxFlag);
+    _minFlag = std::min(_minFlag, other._minFlag);
+    return *this;
+}
+
+template<typename Enum, int FlagCount>
+inline PropertyFlags<Enum, FlagCount>& PropertyFlags<Enum, FlagCount>::operator&=(const PropertyFlags& other) {
+    for (int i = 0; i < WORD_COUNT; i++) {
+        _words[i] &= other._words[i];
+    }
+    _bitCount = std::max(_bitCount, other._bitCount);
+    shrinkIfNeeded();
+    return *this;
+}
+
+template<typename Enum, int FlagCount>
+inline PropertyFlags<Enum, FlagCount>& PropertyFlags<Enum, FlagCount>::operator^=(const PropertyFlags& other) {
+    for (int i = 0; i < WORD_COUNT; i++) {
+        _words[i] ^= other._words[i];
+    }
+    _bitCount = std::max(_bitCount, other._bitCount);
+    shrinkIfNeeded();
+    return *this;
+}
+
+template<typename Enum, int FlagCount>
+inline PropertyFlags<Enum, FlagCount>& PropertyFlags<Enum, FlagCount>::operator+=(const PropertyFlags& other) {
+    // this has the same result as calling setHasProperty() for each of other's flags between its first and last flag
+    int firstAdded = INT_MAX;
+    int lastAdded = INT_MIN;
+    int firstAddedPastMax = INT_MAX;
+    for (int i = 0; i < WORD_COUNT; i++) {
+        uint64_t added = other._words[i] & rangeMask(i, other._minFlag, other._maxFlag);
+        if (added) {
+            int wordFirst = i * BITS_PER_WORD;
+            firstAdded = std::min(firstAdded, wordFirst + PropertyFlagsUtil::lowestBit(added));
+            lastAdded = wordFirst + PropertyFlagsUtil::highestBit(added);
+            uint64_t pastMax = added & rangeMask(i, _maxFlag + 1, FlagCount - 1);
+            if (pastMax && firstAddedPastMax == INT_MAX) {
+                firstAddedPastMax = wordFirst + PropertyFlagsUtil::lowestBit(pastMax);
+            }
+        }
+    }
+    if (lastAdded == INT_MIN) {
+        return *this;
+    }
+    if (firstAddedPastMax != INT_MAX) {
+        resize(firstAddedPastMax + 1);
+        _maxFlag = lastAdded;
+        _bitCount = lastAdded + 1;
+    }
+    for (int i = firstAdded / BITS_PER_WORD; i <= lastAdded / BITS_PER_WORD; i++) {
+        _words[i] |= other._words[i] & rangeMask(i, other._minFlag, other._maxFlag);
+    }
+    _minFlag = std::min(_minFlag, firstAdded);
+    return *this;
+}
+
+template<typename Enum, int FlagCount>
+inline PropertyFlags<Enum, FlagCount>& PropertyFlags<Enum, FlagCount>::operator-=(const PropertyFlags& other) {
+    // as with setHasProperty(), flags past _maxFlag are left alone
+    int first = std::max(other._minFlag, 0);
+    int last = std::min(other._maxFlag, _maxFlag);
+    bool removesMaxFlag = false;
+    for (int i = 0; i < WORD_COUNT; i++) {
+        uint64_t removed = other._words[i] & rangeMask(i, first, last);
+        if (removed) {
+            _words[i] &= ~removed;
+            if (i == _maxFlag / BITS_PER_WORD && ((removed >> (_maxFlag % BITS_PER_WORD)) & 1)) {
+                removesMaxFlag = true;
+            }
+        }
+    }
+    if (removesMaxFlag) {
+        shrinkIfNeeded();
+    }
+    return *this;
+}
+
+template<typename Enum, int FlagCount>
+inline PropertyFlags<Enum, FlagCount> PropertyFlags<Enum, FlagCount>::operator~() const {
+    PropertyFlags result(*this);
+    for (int i = 0; i < WORD_COUNT; i++) {
+        result._words[i] = ~_words[i] & rangeMask(i, 0, _bitCount - 1);
+    }
+    result._trailingFlipped = !_trailingFlipped;
+    return result;
+}
+
+template<typename Enum, int FlagCount>
+inline void PropertyFlags<Enum, FlagCount>::shrinkIfNeeded() {
+    if (_maxFlag < 0) {
+        return;
+    }
+    int maxFlagWas = _maxFlag;
+    _maxFlag = -1;
+    for (int i = maxFlagWas / BITS_PER_WORD; i >= 0; i--) {
+        uint64_t word = _words[i] & rangeMask(i, 0, maxFlagWas);
+        if (word) {
+            _maxFlag = i * BITS_PER_WORD + PropertyFlagsUtil::highestBit(word);
+            break;
+        }
+    }
+    if (maxFlagWas != _maxFlag) {
+        resize(_maxFlag + 1);
+    }
+}
+
+template<typename Enum, int FlagCount>
+inline QByteArray& operator<<(QByteArray& out, PropertyFlags<Enum, FlagCount>& value) {
     return out = value;
 }
 
-template<typename Enum> inline QByteArray& operator>>(QByteArray& in, PropertyFlags<Enum>& value) {
+template<typename Enum, int FlagCount>
+inline QByteArray& operator>>(QByteArray& in, PropertyFlags<Enum, FlagCount>& value) {
     value.decode(in);
     return in;
 }
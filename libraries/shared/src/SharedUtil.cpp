@@ -50,6 +50,11 @@ extern "C" FILE * __cdecl __iob_func(void) {
 #include <cerrno>
 #endif
 
+#ifdef Q_OS_LINUX
+#include <pthread.h>
+#include <sched.h>
+#endif
+
 #include <QtCore/QDebug>
 #include <QDateTime>
 #include <QElapsedTimer>
@@ -1084,6 +1089,42 @@ void setMaxCores(uint8_t maxCores) {
 #endif
 }
 
+bool setCurrentThreadAffinity(int core) {
+#if defined(Q_OS_WIN)
+    DWORD_PTR coreMask = 1;
+    coreMask <<= core;
+    return SetThreadAffinityMask(GetCurrentThread(), coreMask) != 0;
+#elif defined(Q_OS_LINUX)
+    cpu_set_t cpuSet;
+    CPU_ZERO(&cpuSet);
+    CPU_SET(core, &cpuSet);
+    return pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &cpuSet) == 0;
+#else
+    Q_UNUSED(core);
+    return false;
+#endif
+}
+
+bool clearCurrentThreadAffinity() {
+#if defined(Q_OS_WIN)
+    DWORD_PTR processAffinity = 0, systemAffinity = 0;
+    if (!GetProcessAffinityMask(GetCurrentProcess(), &processAffinity, &systemAffinity)) {
+        return false;
+    }
+    return SetThreadAffinityMask(GetCurrentThread(), processAffinity) != 0;
+#elif defined(Q_OS_LINUX)
+    // the kernel leaves out the cores the process isn't allowed on
+    cpu_set_t cpuSet;
+    CPU_ZERO(&cpuSet);
+    for (int core = 0; core < CPU_SETSIZE; ++core) {
+        CPU_SET(core, &cpuSet);
+    }
+    return pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &cpuSet) == 0;
+#else
+    return false;
+#endif
+}
+
 bool processIsRunning(int64_t pid) {
 #ifdef Q_OS_WIN
     HANDLE process = OpenProcess(PROCESS_QUERY_LIMITED_INFORMATION, FALSE, pid);
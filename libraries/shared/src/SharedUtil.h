@@ -225,6 +225,11 @@ const QString& getInterfaceSharedMemoryName();
 
 void setMaxCores(uint8_t maxCores);
 
+// pin the calling thread to a single logical core, returns false if the platform does not support it
+bool setCurrentThreadAffinity(int core);
+// let the calling thread run on any of the process's cores again
+bool clearCurrentThreadAffinity();
+
 const QString PARENT_PID_OPTION = "parent-pid";
 void watchParentProcess(int parentPID);
 
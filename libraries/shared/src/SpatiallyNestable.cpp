@@ -36,6 +36,7 @@ SpatiallyNestable::SpatiallyNestable(NestableType nestableType, QUuid id) :
 
 SpatiallyNestable::~SpatiallyNestable() {
     forEachChild([&](SpatiallyNestablePointer object) {
+        object->bumpTransformVersion();
         object->parentDeleted();
     });
 }
@@ -68,12 +69,17 @@ const QUuid SpatiallyNestable::getParentID() const {
 
 void SpatiallyNestable::setParentID(const QUuid& parentID) {
     bumpAncestorChainRenderableVersion();
+    bool parentChanged = false;
     _idLock.withWriteLock([&] {
         if (_parentID != parentID) {
             _parentID = parentID;
             _parentKnowsMe = false;
+            parentChanged = true;
         }
     });
+    if (parentChanged) {
+        bumpTransformVersion();
+    }
 
     if (!_parentKnowsMe) {
         bool success = false;
@@ -174,7 +180,10 @@ void SpatiallyNestable::forgetChild(SpatiallyNestablePointer newChild) const {
 }
 
 void SpatiallyNestable::setParentJointIndex(quint16 parentJointIndex) {
-    _parentJointIndex = parentJointIndex;
+    if (_parentJointIndex != parentJointIndex) {
+        _parentJointIndex = parentJointIndex;
+        bumpTransformVersion();
+    }
     auto parent = _parent.lock();
     if (parent) {
         parent->recalculateChildCauterization();
@@ -505,6 +514,7 @@ void SpatiallyNestable::setWorldTransform(const glm::vec3& position, const glm::
             }
         });
         if (changed) {
+            bumpTransformVersion();
             locationChanged(false);
         }
     }
@@ -548,6 +558,9 @@ void SpatiallyNestable::setWorldPosition(const glm::vec3& position, bool& succes
             _translationChanged = usecTimestampNow();
         }
     });
+    if (changed) {
+        bumpTransformVersion();
+    }
     if (success && changed) {
         locationChanged(tellPhysics);
     }
@@ -601,6 +614,9 @@ void SpatiallyNestable::setWorldOrientation(const glm::quat& orientation, bool&
             _rotationChanged = usecTimestampNow();
         }
     });
+    if (changed) {
+        bumpTransformVersion();
+    }
     if (success && changed) {
         locationChanged(tellPhysics);
     }
@@ -736,14 +752,97 @@ glm::vec3 SpatiallyNestable::getParentAngularVelocity(bool& success) const {
 
 const Transform SpatiallyNestable::getTransform(bool& success, int depth) const {
     Transform result;
+    if (readCachedTransform(result)) {
+        success = true;
+        return result;
+    }
+
+    // grab the version before walking up the parent chain, so a change that happens meanwhile invalidates what we cache
+    uint32_t version = _transformVersion;
+
     // return a world-space transform for this object's location
     Transform parentTransform = getParentTransform(success, depth);
     _transformLock.withReadLock([&] {
         Transform::mult(result, parentTransform, _transform);
     });
+
+    if (success && canCacheTransform()) {
+        writeCachedTransform(result, version);
+    }
     return result;
 }
 
+void SpatiallyNestable::bumpTransformVersion() const {
+    _transformVersion++;
+    if (hasChildren()) {
+        forEachDescendant([&](const SpatiallyNestablePointer& descendant) {
+            descendant->_transformVersion++;
+        });
+    }
+}
+
+bool SpatiallyNestable::readCachedTransform(Transform& transform) const {
+    uint32_t sequence = _cachedTransformSequence.load(std::memory_order_acquire);
+    if (sequence & 1) {
+        return false;
+    }
+
+    std::array<float, 10> values;
+    for (size_t i = 0; i < values.size(); i++) {
+        values[i] = _cachedTransform[i].load(std::memory_order_relaxed);
+    }
+    uint32_t version = _cachedTransformVersion.load(std::memory_order_relaxed);
+
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (_cachedTransformSequence.load(std::memory_order_relaxed) != sequence || version != _transformVersion) {
+        return false;
+    }
+
+    transform.setRotation(glm::quat(values[0], values[1], values[2], values[3]));
+    transform.setScale(glm::vec3(values[4], values[5], values[6]));
+    transform.setTranslation(glm::vec3(values[7], values[8], values[9]));
+    return true;
+}
+
+void SpatiallyNestable::writeCachedTransform(const Transform& transform, uint32_t version) const {
+    // if another thread is already writing the cache, let it
+    uint32_t sequence = _cachedTransformSequence.load(std::memory_order_relaxed);
+    if ((sequence & 1) || !_cachedTransformSequence.compare_exchange_strong(sequence, sequence + 1)) {
+        return;
+    }
+    std::atomic_thread_fence(std::memory_order_release);
+
+    const glm::quat& rotation = transform.getRotation();
+    const glm::vec3& scale = transform.getScale();
+    const glm::vec3& translation = transform.getTranslation();
+    const std::array<float, 10> values {{
+        rotation.w, rotation.x, rotation.y, rotation.z,
+        scale.x, scale.y, scale.z,
+        translation.x, translation.y, translation.z
+    }};
+    for (size_t i = 0; i < values.size(); i++) {
+        _cachedTransform[i].store(values[i], std::memory_order_relaxed);
+    }
+    _cachedTransformVersion.store(version, std::memory_order_relaxed);
+
+    _cachedTransformSequence.store(sequence + 2, std::memory_order_release);
+}
+
+bool SpatiallyNestable::hasCachedTransform() const {
+    return !(_cachedTransformSequence & 1) && _cachedTransformVersion == _transformVersion;
+}
+
+bool SpatiallyNestable::canCacheTransform() const {
+    // only cache what we are told about when it changes: our version is bumped through our parent's children, and
+    // transforms relative to a joint or scaled with the parent move without the parent's location changing.
+    auto parent = _parent.lock();
+    if (!parent) {
+        return getParentID().isNull();
+    }
+    return _parentKnowsMe && _parentJointIndex == INVALID_JOINT_INDEX && !getScalesWithParent() &&
+        parent->hasCachedTransform();
+}
+
 const Transform SpatiallyNestable::getTransform() const {
     bool success;
     Transform result = getTransform(success);
@@ -806,6 +905,7 @@ void SpatiallyNestable::setTransform(const Transform& transform, bool& success)
             }
         });
         if (changed) {
+            bumpTransformVersion();
             locationChanged();
         }
     }
@@ -860,6 +960,9 @@ void SpatiallyNestable::setSNScale(const glm::vec3& scale, bool& success) {
             _scaleChanged = usecTimestampNow();
         }
     });
+    if (changed) {
+        bumpTransformVersion();
+    }
     if (success && changed) {
         locationChanged();
     }
@@ -892,6 +995,7 @@ void SpatiallyNestable::setLocalTransform(const Transform& transform) {
     });
 
     if (changed) {
+        bumpTransformVersion();
         locationChanged();
     }
 }
@@ -919,6 +1023,7 @@ void SpatiallyNestable::setLocalPosition(const glm::vec3& position, bool tellPhy
         }
     });
     if (changed) {
+        bumpTransformVersion();
         locationChanged(tellPhysics);
     }
 }
@@ -946,6 +1051,7 @@ void SpatiallyNestable::setLocalOrientation(const glm::quat& orientation) {
         }
     });
     if (changed) {
+        bumpTransformVersion();
         locationChanged();
     }
 }
@@ -1002,6 +1108,7 @@ void SpatiallyNestable::setLocalSNScale(const glm::vec3& scale) {
         }
     });
     if (changed) {
+        bumpTransformVersion();
         dimensionsChanged();
     }
 }
@@ -1316,6 +1423,7 @@ void SpatiallyNestable::setLocalTransformAndVelocities(
     });
 
     if (changed) {
+        bumpTransformVersion();
         locationChanged(false);
     }
 }
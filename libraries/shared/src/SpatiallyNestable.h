@@ -12,6 +12,9 @@
 #ifndef hifi_SpatiallyNestable_h
 #define hifi_SpatiallyNestable_h
 
+#include <array>
+#include <atomic>
+
 #include <QUuid>
 
 #include "Transform.h"
@@ -264,6 +267,20 @@ private:
     bool _isDead { false };
     bool _queryAACubeIsPuffed { false };
 
+    // World-frame transform cache. It is valid while _cachedTransformVersion matches _transformVersion, which is bumped
+    // on this object and all its descendants whenever something their world-frame transform depends on changes.
+    // The cache is written under a sequence lock, so reading a clean transform takes no locks at all.
+    mutable std::atomic<uint32_t> _transformVersion { 1 };
+    mutable std::atomic<uint32_t> _cachedTransformSequence { 0 }; // odd while the cache is being written
+    mutable std::atomic<uint32_t> _cachedTransformVersion { 0 };
+    mutable std::array<std::atomic<float>, 10> _cachedTransform; // rotation, scale, translation
+
+    void bumpTransformVersion() const;
+    bool readCachedTransform(Transform& transform) const;
+    void writeCachedTransform(const Transform& transform, uint32_t version) const;
+    bool hasCachedTransform() const;
+    bool canCacheTransform() const;
+
     void breakParentingLoop() const;
 };
 
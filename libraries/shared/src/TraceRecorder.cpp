@@ -0,0 +1,532 @@
+//
+//  TraceRecorder.cpp
+//  libraries/shared/src
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "TraceRecorder.h"
+
+#include <algorithm>
+#include <cstring>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include <QtCore/QCoreApplication>
+#include <QtCore/QDataStream>
+#include <QtCore/QDateTime>
+#include <QtCore/QDir>
+#include <QtCore/QFile>
+#include <QtCore/QHash>
+#include <QtCore/QJsonDocument>
+#include <QtCore/QJsonObject>
+#include <QtCore/QTextStream>
+#include <QtCore/QThread>
+
+#include "Gzip.h"
+#include "SharedLogging.h"
+
+using namespace tracing;
+
+const std::chrono::seconds TraceRecorder::DEFAULT_WINDOW { 10 };
+
+std::atomic<bool> TraceRecorder::_recording { false };
+
+namespace {
+
+const quint32 RECORDING_MAGIC = 0x48465452; // "HFTR"
+const quint32 RECORDING_VERSION = 1;
+
+uint64_t steadyNow() {
+    using namespace std::chrono;
+    return duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+// A ring buffer written only by its own thread. Readers copy it out without stopping the writer, each slot is
+// published with a sequence number so they can throw away the records that the writer changed while they were copying.
+class ThreadBuffer {
+public:
+    ThreadBuffer(uint32_t capacity, qint64 threadID, const QString& threadName) :
+        _slots(new Slot[capacity]), _capacity(capacity), _mask(capacity - 1), _threadID(threadID), _threadName(threadName) {}
+
+    void push(const TraceRecord& record) {
+        uint64_t head = _head.load(std::memory_order_relaxed);
+        Slot& slot = _slots[head & _mask];
+        // an odd sequence marks the slot as being written
+        slot.sequence.store(2 * head + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        slot.timestamp.store(record.timestamp, std::memory_order_relaxed);
+        slot.value.store(record.value, std::memory_order_relaxed);
+        slot.info.store(packInfo(record), std::memory_order_relaxed);
+        slot.sequence.store(2 * head + 2, std::memory_order_release);
+        _head.store(head + 1, std::memory_order_release);
+    }
+
+    std::vector<TraceRecord> snapshot() const {
+        uint64_t head = _head.load(std::memory_order_acquire);
+        uint64_t first = head > _capacity ? head - _capacity : 0;
+
+        std::vector<TraceRecord> records;
+        records.reserve(head - first);
+        for (uint64_t i = first; i < head; i++) {
+            TraceRecord record;
+            if (read(i, record)) {
+                records.push_back(record);
+            }
+        }
+        return records;
+    }
+
+    uint64_t newestTimestamp() const {
+        uint64_t head = _head.load(std::memory_order_acquire);
+        return head > 0 ? _slots[(head - 1) & _mask].timestamp.load(std::memory_order_relaxed) : 0;
+    }
+
+    qint64 getThreadID() const { return _threadID; }
+
+    QString getThreadName() const {
+        std::lock_guard<std::mutex> lock(_threadNameMutex);
+        return _threadName;
+    }
+    void setThreadName(const QString& threadName) {
+        std::lock_guard<std::mutex> lock(_threadNameMutex);
+        _threadName = threadName;
+    }
+
+    bool isRetired() const { return _retired.load(); }
+    void retire() { _retired.store(true); }
+
+private:
+    struct Slot {
+        std::atomic<uint64_t> sequence { 0 };
+        std::atomic<uint64_t> timestamp { 0 };
+        std::atomic<uint64_t> value { 0 };
+        std::atomic<uint64_t> info { 0 }; // nameID, categoryID and type
+    };
+
+    static uint64_t packInfo(const TraceRecord& record) {
+        return (uint64_t)record.nameID | ((uint64_t)record.categoryID << 32) | ((uint64_t)(uint8_t)record.type << 48);
+    }
+
+    // copies record number index, returns false if it has been overwritten or was being written while it was copied
+    bool read(uint64_t index, TraceRecord& record) const {
+        const Slot& slot = _slots[index & _mask];
+        uint64_t sequence = slot.sequence.load(std::memory_order_acquire);
+        if (sequence != 2 * index + 2) {
+            return false;
+        }
+        record.timestamp = slot.timestamp.load(std::memory_order_relaxed);
+        record.value = slot.value.load(std::memory_order_relaxed);
+        uint64_t info = slot.info.load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot.sequence.load(std::memory_order_relaxed) != sequence) {
+            return false;
+        }
+        record.nameID = (uint32_t)info;
+        record.categoryID = (uint16_t)(info >> 32);
+        record.type = (char)(uint8_t)(info >> 48);
+        record.padding = 0;
+        return true;
+    }
+
+    std::unique_ptr<Slot[]> _slots;
+    const uint64_t _capacity;
+    const uint64_t _mask;
+    std::atomic<uint64_t> _head { 0 };
+    const qint64 _threadID;
+    mutable std::mutex _threadNameMutex;
+    QString _threadName;
+    std::atomic<bool> _retired { false };
+};
+
+using ThreadBufferPointer = std::shared_ptr<ThreadBuffer>;
+
+struct RecorderState {
+    std::mutex mutex;
+    std::vector<ThreadBufferPointer> buffers;
+
+    // names are only ever appended, so pointers to them stay valid
+    QHash<QString, uint32_t> nameIDs;
+    std::deque<QByteArray> names;
+    QHash<const QLoggingCategory*, uint16_t> categoryIDs;
+    std::vector<QByteArray> categories;
+
+    QString dumpDirectory;
+
+    std::atomic<uint32_t> recordsPerThread { TraceRecorder::DEFAULT_RECORDS_PER_THREAD };
+    std::atomic<uint64_t> window {
+        (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(TraceRecorder::DEFAULT_WINDOW).count()
+    };
+    std::atomic<int64_t> frameTimeThreshold { 0 };
+    std::atomic<uint64_t> lastFrameDump { 0 };
+    std::atomic<bool> isDumping { false };
+
+    // the thread writing the last frame time dump, joined before the next one starts and by stopRecording()
+    std::mutex dumpThreadMutex;
+    std::thread dumpThread;
+};
+
+// never destroyed, since threads exiting can outlive static destruction
+RecorderState& recorderState() {
+    static RecorderState* state = new RecorderState();
+    return *state;
+}
+
+struct ThreadState {
+    ~ThreadState() {
+        if (buffer) {
+            buffer->retire();
+        }
+    }
+
+    ThreadBufferPointer buffer;
+    QString threadName;
+    std::unordered_map<const char*, std::pair<uint32_t, const QByteArray*>> literalNameIDs;
+    QHash<QString, uint32_t> nameIDs;
+    std::unordered_map<const QLoggingCategory*, uint16_t> categoryIDs;
+};
+
+thread_local ThreadState threadState;
+
+std::pair<uint32_t, const QByteArray*> internUtf8Name(const QString& name) {
+    auto& state = recorderState();
+    std::lock_guard<std::mutex> lock(state.mutex);
+    auto it = state.nameIDs.find(name);
+    if (it == state.nameIDs.end()) {
+        it = state.nameIDs.insert(name, (uint32_t)state.names.size());
+        state.names.push_back(name.toUtf8());
+    }
+    return { it.value(), &state.names[it.value()] };
+}
+
+uint16_t internCategory(const QLoggingCategory& category) {
+    auto& cache = threadState.categoryIDs;
+    auto cached = cache.find(&category);
+    if (cached != cache.end()) {
+        return cached->second;
+    }
+
+    auto& state = recorderState();
+    std::lock_guard<std::mutex> lock(state.mutex);
+    auto it = state.categoryIDs.find(&category);
+    if (it == state.categoryIDs.end()) {
+        it = state.categoryIDs.insert(&category, (uint16_t)state.categories.size());
+        state.categories.push_back(QByteArray(category.categoryName()));
+    }
+    cache[&category] = it.value();
+    return it.value();
+}
+
+ThreadBuffer& threadBuffer() {
+    if (threadState.buffer) {
+        return *threadState.buffer;
+    }
+
+    auto& state = recorderState();
+    uint32_t capacity = 1;
+    while (capacity < state.recordsPerThread.load()) {
+        capacity <<= 1;
+    }
+    QString threadName = threadState.threadName;
+    if (threadName.isEmpty() && QThread::currentThread()) {
+        threadName = QThread::currentThread()->objectName();
+    }
+    threadState.buffer = std::make_shared<ThreadBuffer>(capacity, (qint64)QThread::currentThreadId(), threadName);
+
+    std::lock_guard<std::mutex> lock(state.mutex);
+    // drop the buffers of threads that have exited once nothing they recorded can still be dumped
+    uint64_t now = steadyNow();
+    uint64_t window = state.window.load();
+    state.buffers.erase(std::remove_if(state.buffers.begin(), state.buffers.end(), [&](const ThreadBufferPointer& buffer) {
+        return buffer->isRetired() && now - buffer->newestTimestamp() > window;
+    }), state.buffers.end());
+    state.buffers.push_back(threadState.buffer);
+    return *threadState.buffer;
+}
+
+}
+
+void TraceRecorder::startRecording(uint32_t recordsPerThread) {
+    recorderState().recordsPerThread.store(std::max<uint32_t>(recordsPerThread, 1));
+    _recording.store(true);
+}
+
+void TraceRecorder::stopRecording() {
+    _recording.store(false);
+
+    auto& state = recorderState();
+    std::lock_guard<std::mutex> lock(state.dumpThreadMutex);
+    if (state.dumpThread.joinable()) {
+        state.dumpThread.join();
+    }
+}
+
+void TraceRecorder::setWindow(std::chrono::milliseconds window) {
+    recorderState().window.store((uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(window).count());
+}
+
+void TraceRecorder::setFrameTimeThreshold(std::chrono::microseconds threshold, const QString& directory) {
+    auto& state = recorderState();
+    {
+        std::lock_guard<std::mutex> lock(state.mutex);
+        state.dumpDirectory = directory;
+    }
+    state.frameTimeThreshold.store(threshold.count());
+}
+
+void TraceRecorder::checkFrameTime(const char* frameName, std::chrono::microseconds frameTime) {
+    auto& state = recorderState();
+    auto threshold = state.frameTimeThreshold.load(std::memory_order_relaxed);
+    if (threshold <= 0 || frameTime.count() <= threshold || !isRecording()) {
+        return;
+    }
+
+    // a run of slow frames shares one dump, the next dump waits until the window has moved past this one
+    uint64_t now = steadyNow();
+    uint64_t lastFrameDump = state.lastFrameDump.load();
+    if (lastFrameDump != 0 && now - lastFrameDump < state.window.load()) {
+        return;
+    }
+    bool wasDumping = false;
+    if (!state.isDumping.compare_exchange_strong(wasDumping, true)) {
+        return;
+    }
+    state.lastFrameDump.store(now);
+
+    // writing the recording is left to another thread so the slow frame doesn't get any slower, the previous dump
+    // thread has already cleared isDumping so joining it only waits for it to exit
+    std::lock_guard<std::mutex> lock(state.dumpThreadMutex);
+    if (state.dumpThread.joinable()) {
+        state.dumpThread.join();
+    }
+    QString name = frameName;
+    state.dumpThread = std::thread([name, frameTime] {
+        auto& state = recorderState();
+        QString directory;
+        {
+            std::lock_guard<std::mutex> lock(state.mutex);
+            directory = state.dumpDirectory;
+        }
+        QString timestamp = QDateTime::currentDateTime().toString("yyyy-MM-dd_hh-mm-ss-zzz");
+        QString filename = QDir(directory).filePath(name + "-" + timestamp + ".hftrace");
+        if (dump(filename)) {
+            qCInfo(shared) << name << "frame took" << frameTime.count() << "usecs, dumped trace to" << filename;
+        }
+        state.isDumping.store(false);
+    });
+}
+
+bool TraceRecorder::dump(const QString& filename) {
+    auto& state = recorderState();
+    std::vector<ThreadBufferPointer> buffers;
+    {
+        std::lock_guard<std::mutex> lock(state.mutex);
+        buffers = state.buffers;
+    }
+
+    uint64_t now = steadyNow();
+    uint64_t window = state.window.load();
+    uint64_t cutoff = now > window ? now - window : 0;
+    std::vector<std::vector<TraceRecord>> threadRecords;
+    for (const auto& buffer : buffers) {
+        auto records = buffer->snapshot();
+        auto firstInWindow = std::lower_bound(records.begin(), records.end(), cutoff,
+            [](const TraceRecord& record, uint64_t timestamp) { return record.timestamp < timestamp; });
+        records.erase(records.begin(), firstInWindow);
+        threadRecords.push_back(std::move(records));
+    }
+
+    // every name and category in the records was interned before it was recorded
+    std::vector<QByteArray> names;
+    std::vector<QByteArray> categories;
+    {
+        std::lock_guard<std::mutex> lock(state.mutex);
+        names.assign(state.names.begin(), state.names.end());
+        categories = state.categories;
+    }
+
+    QFile file(filename);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qCWarning(shared) << "Failed to open trace recording" << filename;
+        return false;
+    }
+
+    QDataStream out(&file);
+    out << RECORDING_MAGIC << RECORDING_VERSION << (qint64)QCoreApplication::applicationPid();
+    out << (quint32)names.size();
+    for (const auto& name : names) {
+        out << name;
+    }
+    out << (quint32)categories.size();
+    for (const auto& category : categories) {
+        out << category;
+    }
+    out << (quint32)buffers.size();
+    for (size_t i = 0; i < buffers.size(); i++) {
+        out << buffers[i]->getThreadID() << buffers[i]->getThreadName() << (quint32)threadRecords[i].size();
+        for (const auto& record : threadRecords[i]) {
+            out << (quint64)record.timestamp << (quint64)record.value << (quint32)record.nameID
+                << (quint16)record.categoryID << (qint8)record.type;
+        }
+    }
+
+    if (out.status() != QDataStream::Ok) {
+        qCWarning(shared) << "Failed to write trace recording" << filename;
+        return false;
+    }
+    return true;
+}
+
+bool TraceRecorder::convertToJson(const QString& recordingFilename, const QString& jsonFilename) {
+    QFile recording(recordingFilename);
+    if (!recording.open(QIODevice::ReadOnly)) {
+        qCWarning(shared) << "Failed to open trace recording" << recordingFilename;
+        return false;
+    }
+
+    QDataStream in(&recording);
+    quint32 magic, version;
+    qint64 processID;
+    in >> magic >> version >> processID;
+    if (magic != RECORDING_MAGIC || version != RECORDING_VERSION) {
+        qCWarning(shared) << recordingFilename << "is not a trace recording";
+        return false;
+    }
+
+    quint32 count;
+    in >> count;
+    std::vector<QString> names;
+    for (quint32 i = 0; i < count && in.status() == QDataStream::Ok; i++) {
+        QByteArray name;
+        in >> name;
+        names.push_back(QString::fromUtf8(name));
+    }
+    in >> count;
+    std::vector<QString> categories;
+    for (quint32 i = 0; i < count && in.status() == QDataStream::Ok; i++) {
+        QByteArray category;
+        in >> category;
+        categories.push_back(QString::fromUtf8(category));
+    }
+
+    QByteArray data;
+    {
+        QTextStream out(&data);
+        bool first = true;
+        auto writeEvent = [&](const QJsonObject& event) {
+            out << (first ? "[\n" : ",\n") << QJsonDocument(event).toJson(QJsonDocument::Compact);
+            first = false;
+        };
+
+        quint32 threadCount;
+        in >> threadCount;
+        for (quint32 thread = 0; thread < threadCount && in.status() == QDataStream::Ok; thread++) {
+            qint64 threadID;
+            QString threadName;
+            in >> threadID >> threadName >> count;
+
+            if (!threadName.isEmpty()) {
+                writeEvent({
+                    { "name", "thread_name" },
+                    { "ph", QString(Metadata) },
+                    { "pid", processID },
+                    { "tid", threadID },
+                    { "args", QJsonObject { { "name", threadName } } }
+                });
+            }
+
+            for (quint32 i = 0; i < count && in.status() == QDataStream::Ok; i++) {
+                quint64 timestamp, value;
+                quint32 nameID;
+                quint16 categoryID;
+                qint8 type;
+                in >> timestamp >> value >> nameID >> categoryID >> type;
+                if (nameID >= names.size() || categoryID >= categories.size()) {
+                    continue;
+                }
+
+                QJsonObject event {
+                    { "name", names[nameID] },
+                    { "cat", categories[categoryID] },
+                    { "ph", QString(QChar(type)) },
+                    { "ts", (double)timestamp / 1000.0 },
+                    { "pid", processID },
+                    { "tid", threadID }
+                };
+                if (type == DurationBegin) {
+                    event["args"] = QJsonObject { { "nv_payload", (qint64)value } };
+                } else if (type == Counter) {
+                    event["args"] = QJsonObject { { names[nameID], (qint64)value } };
+                } else if (type == Instant) {
+                    event["s"] = "t";
+                }
+                writeEvent(event);
+            }
+        }
+        out << (first ? "[\n]" : "\n]");
+    }
+
+    if (in.status() != QDataStream::Ok) {
+        qCWarning(shared) << "Trace recording" << recordingFilename << "is truncated";
+        return false;
+    }
+
+    if (jsonFilename.endsWith(".gz")) {
+        QByteArray compressed;
+        gzip(data, compressed);
+        data = compressed;
+    }
+
+    QFile file(jsonFilename);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qCWarning(shared) << "Failed to open" << jsonFilename;
+        return false;
+    }
+    file.write(data);
+    return true;
+}
+
+uint32_t TraceRecorder::internName(const char* name) {
+    auto& cache = threadState.literalNameIDs;
+    auto cached = cache.find(name);
+    // the same address may be reused for a different name when it isn't a literal
+    if (cached != cache.end() && strcmp(cached->second.second->constData(), name) == 0) {
+        return cached->second.first;
+    }
+    auto interned = internUtf8Name(QString::fromUtf8(name));
+    cache[name] = interned;
+    return interned.first;
+}
+
+uint32_t TraceRecorder::internName(const QString& name) {
+    auto& cache = threadState.nameIDs;
+    auto cached = cache.find(name);
+    if (cached != cache.end()) {
+        return cached.value();
+    }
+    uint32_t nameID = internUtf8Name(name).first;
+    cache.insert(name, nameID);
+    return nameID;
+}
+
+void TraceRecorder::record(const QLoggingCategory& category, uint32_t nameID, EventType type, uint64_t value) {
+    if (!isRecording()) {
+        return;
+    }
+    TraceRecord record { steadyNow(), value, nameID, internCategory(category), type, 0 };
+    threadBuffer().push(record);
+}
+
+void TraceRecorder::setThreadName(const QString& name) {
+    threadState.threadName = name;
+    if (threadState.buffer) {
+        threadState.buffer->setThreadName(name);
+    }
+}
@@ -0,0 +1,84 @@
+//
+//  TraceRecorder.h
+//  libraries/shared/src
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#pragma once
+#ifndef hifi_TraceRecorder_h
+#define hifi_TraceRecorder_h
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+#include <QtCore/QString>
+#include <QtCore/QLoggingCategory>
+
+#include "Trace.h"
+
+namespace tracing {
+
+// A compact, fixed size trace event. Names and categories are interned and stored by ID.
+struct TraceRecord {
+    uint64_t timestamp; // steady clock nanoseconds
+    uint64_t value; // the payload of a duration or the value of a counter
+    uint32_t nameID;
+    uint16_t categoryID;
+    char type; // EventType
+    uint8_t padding;
+};
+
+// A flight recorder for trace events, cheap enough to leave running on servers.
+//
+// Each thread writes its events into its own ring buffer without taking any locks, so only the most recent events
+// are kept. dump() writes the events from the last few seconds to a binary recording, which convertToJson() turns
+// into the Chrome trace JSON that Tracer::serialize() writes.
+//
+// Unlike the Tracer this is not a Dependency, the recorder is process wide so that recording an event doesn't need a
+// DependencyManager lookup.
+class TraceRecorder {
+public:
+    static const uint32_t DEFAULT_RECORDS_PER_THREAD = 1 << 15;
+    static const std::chrono::seconds DEFAULT_WINDOW;
+
+    static bool isRecording() { return _recording.load(std::memory_order_relaxed); }
+
+    // recordsPerThread is rounded up to a power of two, it only applies to threads that haven't recorded yet
+    static void startRecording(uint32_t recordsPerThread = DEFAULT_RECORDS_PER_THREAD);
+    static void stopRecording();
+
+    // how far back dump() goes
+    static void setWindow(std::chrono::milliseconds window);
+
+    // frames longer than threshold passed to checkFrameTime() dump to a file in directory, 0 disables the check
+    static void setFrameTimeThreshold(std::chrono::microseconds threshold, const QString& directory);
+
+    // call once per frame, if the frame was too long the recording is dumped on a background thread
+    static void checkFrameTime(const char* frameName, std::chrono::microseconds frameTime);
+
+    // writes the recorded events in the window to filename, returns false if the file couldn't be written
+    static bool dump(const QString& filename);
+
+    // converts a recording written by dump() to Chrome trace JSON, gzipped if jsonFilename ends in .gz
+    static bool convertToJson(const QString& recordingFilename, const QString& jsonFilename);
+
+    // names passed by pointer are looked up by address first, so prefer string literals
+    static uint32_t internName(const char* name);
+    static uint32_t internName(const QString& name);
+
+    static void record(const QLoggingCategory& category, uint32_t nameID, EventType type, uint64_t value = 0);
+
+    static void setThreadName(const QString& name);
+
+private:
+    static std::atomic<bool> _recording;
+};
+
+}
+
+#endif // hifi_TraceRecorder_h
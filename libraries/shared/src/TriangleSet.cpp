@@ -13,7 +13,452 @@
 
 #include "GLMHelpers.h"
 
-#include <list>
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <future>
+
+//
+// on x86 architecture, assume that SSE2 is present
+//
+#if defined(_M_IX86) || defined(_M_X64) || defined(__i386__) || defined(__x86_64__)
+#include <emmintrin.h>  // SSE2
+#define TRIANGLE_SET_SSE2 1
+#endif
+
+namespace {
+
+const int NUM_SAH_BINS = 16;
+
+// subtrees with more triangles than this are built on their own threads, near the top of the tree
+const uint32_t PARALLEL_BUILD_THRESHOLD = 1 << 15;
+const int MAX_PARALLEL_BUILD_DEPTH = 3;
+
+// past this depth the remaining triangles go in one leaf, which bounds the traversal stack
+const int MAX_BUILD_DEPTH = 64;
+const int MAX_STACK_SIZE = (TriangleSet::NODE_WIDTH - 1) * MAX_BUILD_DEPTH + 1;
+
+struct Bounds {
+    glm::vec3 minimum { FLT_MAX };
+    glm::vec3 maximum { -FLT_MAX };
+
+    void add(const glm::vec3& point) {
+        minimum = glm::min(minimum, point);
+        maximum = glm::max(maximum, point);
+    }
+
+    void add(const Bounds& other) {
+        minimum = glm::min(minimum, other.minimum);
+        maximum = glm::max(maximum, other.maximum);
+    }
+
+    float getSurfaceArea() const {
+        if (minimum.x > maximum.x) {
+            return 0.0f;
+        }
+        glm::vec3 dimensions = maximum - minimum;
+        return 2.0f * (dimensions.x * dimensions.y + dimensions.y * dimensions.z + dimensions.z * dimensions.x);
+    }
+};
+
+struct StackEntry {
+    int32_t child;
+    uint32_t packetCount;
+    float distance;
+    float exitDistance; // where the ray leaves the child's bounds, for picks that aren't precise
+};
+
+}
+
+class TriangleSet::Builder {
+public:
+    Builder(const std::vector<Triangle>& triangles);
+
+    // sorts the triangles into leaf order
+    void build(std::vector<Triangle>& triangles, std::vector<Node>& nodes, std::vector<TrianglePacket>& packets);
+
+private:
+    struct BuildNode {
+        Bounds bounds;
+        std::unique_ptr<BuildNode> children[2];
+        uint32_t begin { 0 };
+        uint32_t end { 0 };
+
+        bool isLeaf() const { return !children[0]; }
+    };
+
+    std::unique_ptr<BuildNode> buildNode(uint32_t begin, uint32_t end, int depth);
+    uint32_t split(uint32_t begin, uint32_t end, const Bounds& centroidBounds);
+
+    int32_t flattenNode(const BuildNode& buildNode);
+    int32_t flattenLeaf(const BuildNode& buildNode, uint32_t& packetCount);
+    void setChild(int32_t nodeIndex, int lane, const BuildNode& child, int32_t childIndex, uint32_t packetCount);
+
+    const std::vector<Triangle>& _triangles;
+    std::vector<Bounds> _triangleBounds;
+    std::vector<glm::vec3> _centroids;
+    std::vector<uint32_t> _indices;
+
+    std::vector<Triangle> _sortedTriangles;
+    std::vector<Node> _nodes;
+    std::vector<TrianglePacket> _packets;
+};
+
+TriangleSet::Builder::Builder(const std::vector<Triangle>& triangles) :
+    _triangles(triangles),
+    _triangleBounds(triangles.size()),
+    _centroids(triangles.size()),
+    _indices(triangles.size())
+{
+    for (uint32_t i = 0; i < (uint32_t)triangles.size(); i++) {
+        const Triangle& triangle = triangles[i];
+        Bounds& bounds = _triangleBounds[i];
+        bounds.add(triangle.v0);
+        bounds.add(triangle.v1);
+        bounds.add(triangle.v2);
+        _centroids[i] = 0.5f * (bounds.minimum + bounds.maximum);
+        _indices[i] = i;
+    }
+}
+
+void TriangleSet::Builder::build(std::vector<Triangle>& triangles, std::vector<Node>& nodes,
+        std::vector<TrianglePacket>& packets) {
+    if (_triangles.empty()) {
+        nodes.clear();
+        packets.clear();
+        return;
+    }
+
+    auto root = buildNode(0, (uint32_t)_indices.size(), 0);
+
+    _sortedTriangles.reserve(_triangles.size());
+    _packets.reserve((_triangles.size() + PACKET_SIZE - 1) / PACKET_SIZE);
+    if (root->isLeaf()) {
+        // the traversal always starts at a node
+        _nodes.push_back(Node());
+        _nodes[0].childCount = 1;
+        uint32_t packetCount;
+        int32_t leaf = flattenLeaf(*root, packetCount);
+        setChild(0, 0, *root, leaf, packetCount);
+    } else {
+        flattenNode(*root);
+    }
+
+    triangles.swap(_sortedTriangles);
+    nodes.swap(_nodes);
+    packets.swap(_packets);
+}
+
+std::unique_ptr<TriangleSet::Builder::BuildNode> TriangleSet::Builder::buildNode(uint32_t begin, uint32_t end, int depth) {
+    auto node = std::make_unique<BuildNode>();
+    node->begin = begin;
+    node->end = end;
+
+    Bounds centroidBounds;
+    for (uint32_t i = begin; i < end; i++) {
+        uint32_t index = _indices[i];
+        node->bounds.add(_triangleBounds[index]);
+        centroidBounds.add(_centroids[index]);
+    }
+
+    uint32_t count = end - begin;
+    if (count <= (uint32_t)PACKET_SIZE || depth >= MAX_BUILD_DEPTH) {
+        return node;
+    }
+
+    uint32_t middle = split(begin, end, centroidBounds);
+    if (count > PARALLEL_BUILD_THRESHOLD && depth < MAX_PARALLEL_BUILD_DEPTH) {
+        // the halves partition separate ranges of _indices, so they can be built at the same time
+        auto left = std::async(std::launch::async, [&] {
+            return buildNode(begin, middle, depth + 1);
+        });
+        node->children[1] = buildNode(middle, end, depth + 1);
+        node->children[0] = left.get();
+    } else {
+        node->children[0] = buildNode(begin, middle, depth + 1);
+        node->children[1] = buildNode(middle, end, depth + 1);
+    }
+    return node;
+}
+
+// Splits the triangles where the surface area heuristic says rays will test the fewest triangles, estimating the
+// cost of a split from the centroids sorted into bins along the longest axis. Returns the start of the second half.
+uint32_t TriangleSet::Builder::split(uint32_t begin, uint32_t end, const Bounds& centroidBounds) {
+    glm::vec3 extents = centroidBounds.maximum - centroidBounds.minimum;
+    int axis = (extents.x >= extents.y && extents.x >= extents.z) ? 0 : (extents.y >= extents.z ? 1 : 2);
+    auto first = _indices.begin() + begin;
+    auto last = _indices.begin() + end;
+    uint32_t middle = begin + (end - begin) / 2;
+    if (extents[axis] <= 0.0f) {
+        // all the centroids are in the same place, any split will do
+        return middle;
+    }
+
+    float binScale = (float)NUM_SAH_BINS / extents[axis];
+    float binMinimum = centroidBounds.minimum[axis];
+    auto getBin = [&](uint32_t index) {
+        int bin = (int)((_centroids[index][axis] - binMinimum) * binScale);
+        return std::min(std::max(bin, 0), NUM_SAH_BINS - 1);
+    };
+
+    std::array<Bounds, NUM_SAH_BINS> binBounds;
+    std::array<uint32_t, NUM_SAH_BINS> binCounts;
+    binCounts.fill(0);
+    for (auto i = first; i != last; ++i) {
+        int bin = getBin(*i);
+        binBounds[bin].add(_triangleBounds[*i]);
+        binCounts[bin]++;
+    }
+
+    // the cost of the triangles above each split
+    std::array<float, NUM_SAH_BINS> aboveCosts;
+    Bounds aboveBounds;
+    uint32_t aboveCount = 0;
+    for (int bin = NUM_SAH_BINS - 1; bin > 0; bin--) {
+        aboveBounds.add(binBounds[bin]);
+        aboveCount += binCounts[bin];
+        aboveCosts[bin] = aboveCount > 0 ? aboveBounds.getSurfaceArea() * aboveCount : FLT_MAX;
+    }
+
+    int bestSplit = -1;
+    float bestCost = FLT_MAX;
+    Bounds belowBounds;
+    uint32_t belowCount = 0;
+    for (int bin = 1; bin < NUM_SAH_BINS; bin++) {
+        belowBounds.add(binBounds[bin - 1]);
+        belowCount += binCounts[bin - 1];
+        if (belowCount == 0 || aboveCosts[bin] == FLT_MAX) {
+            continue;
+        }
+        float cost = belowBounds.getSurfaceArea() * belowCount + aboveCosts[bin];
+        if (cost < bestCost) {
+            bestCost = cost;
+            bestSplit = bin;
+        }
+    }
+
+    if (bestSplit >= 0) {
+        auto partition = std::partition(first, last, [&](uint32_t index) {
+            return getBin(index) < bestSplit;
+        });
+        uint32_t partitionIndex = (uint32_t)(partition - _indices.begin());
+        if (partitionIndex > begin && partitionIndex < end) {
+            return partitionIndex;
+        }
+    }
+
+    std::nth_element(first, _indices.begin() + middle, last, [&](uint32_t left, uint32_t right) {
+        return _centroids[left][axis] < _centroids[right][axis];
+    });
+    return middle;
+}
+
+// Collapses binary nodes into a node with up to four children, opening the largest child each time.
+int32_t TriangleSet::Builder::flattenNode(const BuildNode& buildNode) {
+    std::array<const BuildNode*, NODE_WIDTH> children;
+    int childCount = 0;
+    children[childCount++] = buildNode.children[0].get();
+    children[childCount++] = buildNode.children[1].get();
+    while (childCount < NODE_WIDTH) {
+        int largestChild = -1;
+        float largestArea = -1.0f;
+        for (int i = 0; i < childCount; i++) {
+            float area = children[i]->bounds.getSurfaceArea();
+            if (!children[i]->isLeaf() && area > largestArea) {
+                largestChild = i;
+                largestArea = area;
+            }
+        }
+        if (largestChild < 0) {
+            break;
+        }
+        const BuildNode* opened = children[largestChild];
+        children[largestChild] = opened->children[0].get();
+        children[childCount++] = opened->children[1].get();
+    }
+
+    int32_t nodeIndex = (int32_t)_nodes.size();
+    _nodes.push_back(Node());
+    _nodes[nodeIndex].childCount = childCount;
+    for (int i = 0; i < childCount; i++) {
+        uint32_t packetCount = 0;
+        int32_t childIndex = children[i]->isLeaf() ? flattenLeaf(*children[i], packetCount) : flattenNode(*children[i]);
+        setChild(nodeIndex, i, *children[i], childIndex, packetCount);
+    }
+    return nodeIndex;
+}
+
+int32_t TriangleSet::Builder::flattenLeaf(const BuildNode& buildNode, uint32_t& packetCount) {
+    uint32_t firstPacket = (uint32_t)_packets.size();
+    for (uint32_t first = buildNode.begin; first < buildNode.end; first += PACKET_SIZE) {
+        TrianglePacket packet;
+        memset(&packet, 0, sizeof(TrianglePacket)); // the unused lanes are degenerate, so they never intersect
+        packet.firstTriangle = (uint32_t)_sortedTriangles.size();
+        packet.triangleCount = std::min((uint32_t)PACKET_SIZE, buildNode.end - first);
+        for (uint32_t lane = 0; lane < packet.triangleCount; lane++) {
+            const Triangle& triangle = _triangles[_indices[first + lane]];
+            _sortedTriangles.push_back(triangle);
+            glm::vec3 firstSide = triangle.v1 - triangle.v0;
+            glm::vec3 secondSide = triangle.v2 - triangle.v0;
+            for (int axis = 0; axis < 3; axis++) {
+                packet.v0[axis][lane] = triangle.v0[axis];
+                packet.firstSide[axis][lane] = firstSide[axis];
+                packet.secondSide[axis][lane] = secondSide[axis];
+            }
+        }
+        _packets.push_back(packet);
+    }
+    packetCount = (uint32_t)_packets.size() - firstPacket;
+    return ~(int32_t)firstPacket;
+}
+
+void TriangleSet::Builder::setChild(int32_t nodeIndex, int lane, const BuildNode& child, int32_t childIndex,
+        uint32_t packetCount) {
+    Node& node = _nodes[nodeIndex];
+    for (int axis = 0; axis < 3; axis++) {
+        node.minimum[axis][lane] = child.bounds.minimum[axis];
+        node.maximum[axis][lane] = child.bounds.maximum[axis];
+    }
+    node.children[lane] = childIndex;
+    node.packetCounts[lane] = packetCount;
+}
+
+namespace {
+
+// Intersects a ray with the bounds of a node's children. Returns a mask of the children it hits closer than
+// maxDistance, with the distance to each, clamped to zero when the origin is inside.
+//
+// An axis the ray doesn't move along has an infinite invDirection, and when the origin lies in the plane of a bound on
+// that axis the distance to the plane is 0 * inf = NaN. The ray is inside the bounds on that axis, so it is skipped.
+template <typename Node>
+int findRayNodeIntersections(const Node& node, const glm::vec3& origin, const glm::vec3& invDirection, float maxDistance,
+        float distances[], float exitDistances[]) {
+    int childMask = (1 << node.childCount) - 1;
+#if TRIANGLE_SET_SSE2
+    __m128 enter = _mm_set1_ps(0.0f);
+    __m128 exit = _mm_set1_ps(maxDistance);
+    for (int axis = 0; axis < 3; axis++) {
+        __m128 axisOrigin = _mm_set1_ps(origin[axis]);
+        __m128 axisInvDirection = _mm_set1_ps(invDirection[axis]);
+        __m128 toMinimum = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(node.minimum[axis]), axisOrigin), axisInvDirection);
+        __m128 toMaximum = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(node.maximum[axis]), axisOrigin), axisInvDirection);
+        __m128 inPlane = _mm_cmpunord_ps(toMinimum, toMaximum);
+        __m128 axisEnter = _mm_max_ps(enter, _mm_min_ps(toMinimum, toMaximum));
+        __m128 axisExit = _mm_min_ps(exit, _mm_max_ps(toMinimum, toMaximum));
+        enter = _mm_or_ps(_mm_and_ps(inPlane, enter), _mm_andnot_ps(inPlane, axisEnter));
+        exit = _mm_or_ps(_mm_and_ps(inPlane, exit), _mm_andnot_ps(inPlane, axisExit));
+    }
+    _mm_storeu_ps(distances, enter);
+    _mm_storeu_ps(exitDistances, exit);
+    return _mm_movemask_ps(_mm_cmple_ps(enter, exit)) & childMask;
+#else   // portable reference code
+    int hits = 0;
+    for (int lane = 0; lane < TriangleSet::NODE_WIDTH; lane++) {
+        float enter = 0.0f;
+        float exit = maxDistance;
+        for (int axis = 0; axis < 3; axis++) {
+            float toMinimum = (node.minimum[axis][lane] - origin[axis]) * invDirection[axis];
+            float toMaximum = (node.maximum[axis][lane] - origin[axis]) * invDirection[axis];
+            if (glm::isnan(toMinimum) || glm::isnan(toMaximum)) {
+                continue;
+            }
+            enter = std::max(enter, std::min(toMinimum, toMaximum));
+            exit = std::min(exit, std::max(toMinimum, toMaximum));
+        }
+        distances[lane] = enter;
+        exitDistances[lane] = exit;
+        if (enter <= exit) {
+            hits |= 1 << lane;
+        }
+    }
+    return hits & childMask;
+#endif
+}
+
+// The same test as findRayTriangleIntersection(), on a packet of triangles. Returns a mask of the triangles hit.
+template <typename TrianglePacket>
+int findRayPacketIntersections(const TrianglePacket& packet, const glm::vec3& origin, const glm::vec3& direction,
+        bool allowBackface, float distances[]) {
+    int triangleMask = (1 << packet.triangleCount) - 1;
+#if TRIANGLE_SET_SSE2
+    __m128 directionX = _mm_set1_ps(direction.x);
+    __m128 directionY = _mm_set1_ps(direction.y);
+    __m128 directionZ = _mm_set1_ps(direction.z);
+    __m128 firstSideX = _mm_loadu_ps(packet.firstSide[0]);
+    __m128 firstSideY = _mm_loadu_ps(packet.firstSide[1]);
+    __m128 firstSideZ = _mm_loadu_ps(packet.firstSide[2]);
+    __m128 secondSideX = _mm_loadu_ps(packet.secondSide[0]);
+    __m128 secondSideY = _mm_loadu_ps(packet.secondSide[1]);
+    __m128 secondSideZ = _mm_loadu_ps(packet.secondSide[2]);
+    __m128 epsilon = _mm_set1_ps(EPSILON);
+    __m128 zero = _mm_setzero_ps();
+    __m128 one = _mm_set1_ps(1.0f);
+
+    // P = cross(direction, secondSide)
+    __m128 pX = _mm_sub_ps(_mm_mul_ps(directionY, secondSideZ), _mm_mul_ps(secondSideY, directionZ));
+    __m128 pY = _mm_sub_ps(_mm_mul_ps(directionZ, secondSideX), _mm_mul_ps(secondSideZ, directionX));
+    __m128 pZ = _mm_sub_ps(_mm_mul_ps(directionX, secondSideY), _mm_mul_ps(secondSideX, directionY));
+    __m128 det = _mm_add_ps(_mm_add_ps(_mm_mul_ps(firstSideX, pX), _mm_mul_ps(firstSideY, pY)), _mm_mul_ps(firstSideZ, pZ));
+    __m128 valid;
+    if (allowBackface) {
+        __m128 absDet = _mm_max_ps(det, _mm_sub_ps(zero, det));
+        valid = _mm_cmpge_ps(absDet, epsilon);
+    } else {
+        valid = _mm_cmpge_ps(det, epsilon);
+    }
+    __m128 invDet = _mm_div_ps(one, det);
+
+    __m128 tX = _mm_sub_ps(_mm_set1_ps(origin.x), _mm_loadu_ps(packet.v0[0]));
+    __m128 tY = _mm_sub_ps(_mm_set1_ps(origin.y), _mm_loadu_ps(packet.v0[1]));
+    __m128 tZ = _mm_sub_ps(_mm_set1_ps(origin.z), _mm_loadu_ps(packet.v0[2]));
+    __m128 u = _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(tX, pX), _mm_mul_ps(tY, pY)), _mm_mul_ps(tZ, pZ)), invDet);
+    valid = _mm_and_ps(valid, _mm_and_ps(_mm_cmpge_ps(u, zero), _mm_cmple_ps(u, one)));
+
+    // Q = cross(T, firstSide)
+    __m128 qX = _mm_sub_ps(_mm_mul_ps(tY, firstSideZ), _mm_mul_ps(firstSideY, tZ));
+    __m128 qY = _mm_sub_ps(_mm_mul_ps(tZ, firstSideX), _mm_mul_ps(firstSideZ, tX));
+    __m128 qZ = _mm_sub_ps(_mm_mul_ps(tX, firstSideY), _mm_mul_ps(firstSideX, tY));
+    __m128 v = _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(directionX, qX), _mm_mul_ps(directionY, qY)),
+        _mm_mul_ps(directionZ, qZ)), invDet);
+    valid = _mm_and_ps(valid, _mm_and_ps(_mm_cmpge_ps(v, zero), _mm_cmple_ps(_mm_add_ps(u, v), one)));
+
+    __m128 t = _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(secondSideX, qX), _mm_mul_ps(secondSideY, qY)),
+        _mm_mul_ps(secondSideZ, qZ)), invDet);
+    valid = _mm_and_ps(valid, _mm_cmpgt_ps(t, epsilon));
+
+    _mm_storeu_ps(distances, t);
+    return _mm_movemask_ps(valid) & triangleMask;
+#else   // portable reference code
+    int hits = 0;
+    for (int lane = 0; lane < (int)packet.triangleCount; lane++) {
+        glm::vec3 v0(packet.v0[0][lane], packet.v0[1][lane], packet.v0[2][lane]);
+        glm::vec3 firstSide(packet.firstSide[0][lane], packet.firstSide[1][lane], packet.firstSide[2][lane]);
+        glm::vec3 secondSide(packet.secondSide[0][lane], packet.secondSide[1][lane], packet.secondSide[2][lane]);
+        if (findRayTriangleIntersection(origin, direction, v0, v0 + firstSide, v0 + secondSide, distances[lane], allowBackface)) {
+            hits |= 1 << lane;
+        }
+    }
+    return hits & triangleMask;
+#endif
+}
+
+// pushes the children hit, farthest first so that the closest is searched first
+void pushChildren(std::array<StackEntry, MAX_STACK_SIZE>& stack, int& stackSize, int hits, const int32_t children[],
+        const uint32_t packetCounts[], const float distances[], const float exitDistances[]) {
+    int firstEntry = stackSize;
+    for (int lane = 0; lane < TriangleSet::NODE_WIDTH; lane++) {
+        if (hits & (1 << lane)) {
+            StackEntry entry { children[lane], packetCounts[lane], distances[lane], exitDistances[lane] };
+            int i = stackSize++;
+            for (; i > firstEntry && stack[i - 1].distance < entry.distance; i--) {
+                stack[i] = stack[i - 1];
+            }
+            stack[i] = entry;
+        }
+    }
+}
+
+}
 
 void TriangleSet::insert(const Triangle& t) {
     _isBalanced = false;
@@ -29,7 +474,8 @@ void TriangleSet::clear() {
     _bounds.clear();
     _isBalanced = false;
 
-    _triangleTree.clear();
+    _nodes.clear();
+    _packets.clear();
 }
 
 bool TriangleSet::convexHullContains(const glm::vec3& point) const {
@@ -53,17 +499,12 @@ void TriangleSet::debugDump() {
     qDebug() << __FUNCTION__;
     qDebug() << "bounds:" << getBounds();
     qDebug() << "triangles:" << size() << "at top level....";
-    qDebug() << "----- _triangleTree -----";
-    _triangleTree.debugDump();
+    qDebug() << "nodes:" << _nodes.size() << "packets:" << _packets.size() << "balanced:" << _isBalanced;
 }
 
 void TriangleSet::balanceTree() {
-    _triangleTree.reset(_bounds);
-
-    // insert all the triangles
-    for (size_t i = 0; i < _triangles.size(); i++) {
-        _triangleTree.insert(i);
-    }
+    Builder builder(_triangles);
+    builder.build(_triangles, _nodes, _packets);
 
     _isBalanced = true;
 
@@ -72,255 +513,68 @@ void TriangleSet::balanceTree() {
 #endif
 }
 
-// With an octree: 8 ^ MAX_DEPTH = 4096 leaves
-//static const int MAX_DEPTH = 4;
-// With a k-d tree: 2 ^ MAX_DEPTH = 4096 leaves
-static const int MAX_DEPTH = 12;
-
-TriangleSet::TriangleTreeCell::TriangleTreeCell(std::vector<Triangle>& allTriangles, const AABox& bounds, int depth) :
-    _allTriangles(allTriangles)
-{
-    reset(bounds, depth);
-}
-
-void TriangleSet::TriangleTreeCell::clear() {
-    _population = 0;
-    _triangleIndices.clear();
-    _bounds.clear();
-    _children.first.reset();
-    _children.second.reset();
-}
-
-void TriangleSet::TriangleTreeCell::reset(const AABox& bounds, int depth) {
-    clear();
-    _bounds = bounds;
-    _depth = depth;
-}
-
-void TriangleSet::TriangleTreeCell::debugDump() {
-    qDebug() << __FUNCTION__;
-    qDebug() << "               bounds:" << getBounds();
-    qDebug() << "                depth:" << _depth;
-    qDebug() << "           population:" << _population << "this level or below"
-             << " ---- triangleIndices:" << _triangleIndices.size() << "in this cell";
-
-    int numChildren = 0;
-    if (_children.first) {
-        numChildren++;
-    } else if (_children.second) {
-        numChildren++;
-    }
-    qDebug() << "child cells:" << numChildren;
-    if (_depth < MAX_DEPTH) {
-        if (_children.first) {
-            qDebug() << "child: 0";
-            _children.first->debugDump();
-        }
-        if (_children.second) {
-            qDebug() << "child: 1";
-            _children.second->debugDump();
-        }
-    }
-}
-
-std::pair<AABox, AABox> TriangleSet::TriangleTreeCell::getTriangleTreeCellChildBounds() {
-    std::pair<AABox, AABox> toReturn;
-    int axis = 0;
-    // find biggest axis
-    glm::vec3 dimensions = _bounds.getDimensions();
-    for (int i = 0; i < 3; i++) {
-        if (dimensions[i] >= dimensions[(i + 1) % 3] && dimensions[i] >= dimensions[(i + 2) % 3]) {
-            axis = i;
-            break;
-        }
-    }
-
-    // The new boxes are half the size in the largest dimension
-    glm::vec3 newDimensions = dimensions;
-    newDimensions[axis] *= 0.5f;
-    toReturn.first.setBox(_bounds.getCorner(), newDimensions);
-    glm::vec3 offset = glm::vec3(0.0f);
-    offset[axis] = newDimensions[axis];
-    toReturn.second.setBox(_bounds.getCorner() + offset, newDimensions);
-    return toReturn;
-}
-
-void TriangleSet::TriangleTreeCell::insert(size_t triangleIndex) {
-    _population++;
-
-    // if we're not yet at the max depth, then check which child the triangle fits in
-    if (_depth < MAX_DEPTH) {
-        const Triangle& triangle = _allTriangles[triangleIndex];
-        auto childBounds = getTriangleTreeCellChildBounds();
-
-        auto insertOperator = [&](const AABox& childBound, std::shared_ptr<TriangleTreeCell>& child) {
-            // if the child AABox would contain the triangle...
-            if (childBound.contains(triangle)) {
-                // if the child cell doesn't yet exist, create it...
-                if (!child) {
-                    child = std::make_shared<TriangleTreeCell>(_allTriangles, childBound, _depth + 1);
-                }
-
-                // insert the triangleIndex in the child cell
-                child->insert(triangleIndex);
-                return true;
-            }
-            return false;
-        };
-        if (insertOperator(childBounds.first, _children.first) || insertOperator(childBounds.second, _children.second)) {
-            return;
-        }
-    }
-    // either we're at max depth, or the triangle doesn't fit in one of our
-    // children and so we want to just record it here
-    _triangleIndices.push_back(triangleIndex);
-}
-
+// Determine of the given ray (origin/direction) in model space intersects with any triangles
+// in the set. If an intersection occurs, the distance and surface normal will be provided.
+// If !precision, the distance is to the closest bounds around a few triangles.
 bool TriangleSet::findRayIntersection(const glm::vec3& origin, const glm::vec3& direction, const glm::vec3& invDirection, float& distance,
                                       BoxFace& face, Triangle& triangle, bool precision, bool allowBackface) {
     if (!_isBalanced) {
         balanceTree();
     }
-
-    float localDistance = distance;
-    int trianglesTouched = 0;
-    bool hit = _triangleTree.findRayIntersection(origin, direction, invDirection, localDistance, face, triangle, precision, trianglesTouched, allowBackface);
-    if (hit) {
-        distance = localDistance;
+    if (_nodes.empty()) {
+        return false;
     }
 
-#if WANT_DEBUGGING
-    if (precision) {
-        qDebug() << "trianglesTouched :" << trianglesTouched << "out of:" << _triangleTree._population << "_triangles.size:" << _triangles.size();
-    }
-#endif
-    return hit;
-}
-
-// Determine of the given ray (origin/direction) in model space intersects with any triangles
-// in the set. If an intersection occurs, the distance and surface normal will be provided.
-bool TriangleSet::TriangleTreeCell::findRayIntersectionInternal(const glm::vec3& origin, const glm::vec3& direction,
-                                                                  float& distance, BoxFace& face, Triangle& triangle, bool precision,
-                                                                  int& trianglesTouched, bool allowBackface) {
-    bool intersectedSomething = false;
     float bestDistance = FLT_MAX;
-    Triangle bestTriangle;
-
-    if (precision) {
-        for (const auto& triangleIndex : _triangleIndices) {
-            const auto& thisTriangle = _allTriangles[triangleIndex];
-            float thisTriangleDistance;
-            trianglesTouched++;
-            if (findRayTriangleIntersection(origin, direction, thisTriangle, thisTriangleDistance, allowBackface)) {
-                if (thisTriangleDistance < bestDistance) {
-                    bestDistance = thisTriangleDistance;
-                    bestTriangle = thisTriangle;
-                    intersectedSomething = true;
-                }
-            }
-        }
-    } else {
-        intersectedSomething = true;
-        bestDistance = distance;
-    }
-
-    if (intersectedSomething) {
-        distance = bestDistance;
-        triangle = bestTriangle;
-    }
-
-    return intersectedSomething;
-}
+    uint32_t bestTriangle = 0;
+    bool intersects = false;
 
-bool TriangleSet::TriangleTreeCell::findRayIntersection(const glm::vec3& origin, const glm::vec3& direction, const glm::vec3& invDirection,
-                                                        float& distance, BoxFace& face, Triangle& triangle, bool precision, int& trianglesTouched,
-                                                        bool allowBackface) {
-    if (_population < 1) {
-        return false; // no triangles below here, so we can't intersect
-    }
+    std::array<StackEntry, MAX_STACK_SIZE> stack;
+    int stackSize = 0;
+    stack[stackSize++] = { 0, 0, 0.0f, 0.0f };
+    while (stackSize > 0) {
+        const StackEntry entry = stack[--stackSize];
+        if (entry.distance > bestDistance) {
+            continue;
+        }
 
-    float bestLocalDistance = FLT_MAX;
-    BoxFace bestLocalFace;
-    Triangle bestLocalTriangle;
-    bool intersects = false;
+        if (entry.packetCount == 0) {
+            const Node& node = _nodes[entry.child];
+            float distances[NODE_WIDTH];
+            float exitDistances[NODE_WIDTH];
+            int hits = findRayNodeIntersections(node, origin, invDirection, bestDistance, distances, exitDistances);
+            pushChildren(stack, stackSize, hits, node.children, node.packetCounts, distances, exitDistances);
+            continue;
+        }
 
-    // Check our local triangle set first
-    // The distance passed in here is the distance to our bounding box.  If !precision, that distance is used
-    {
-        float internalDistance = distance;
-        BoxFace internalFace { UNKNOWN_FACE };
-        Triangle internalTriangle;
-        if (findRayIntersectionInternal(origin, direction, internalDistance, internalFace, internalTriangle, precision, trianglesTouched, allowBackface)) {
-            bestLocalDistance = internalDistance;
-            bestLocalFace = internalFace;
-            bestLocalTriangle = internalTriangle;
+        if (!precision) {
+            // when the origin is inside the bounds, use where the ray leaves them
+            bestDistance = entry.distance > 0.0f ? entry.distance : entry.exitDistance;
             intersects = true;
+            continue;
         }
-    }
 
-    // if we're not yet at the max depth, then check our children
-    if (_depth < MAX_DEPTH) {
-        std::list<SortedTriangleCell> sortedTriangleCells;
-        auto sortingOperator = [&](std::shared_ptr<TriangleTreeCell>& child) {
-            if (child) {
-                float priority = FLT_MAX;
-                if (child->getBounds().contains(origin)) {
-                    priority = 0.0f;
-                } else {
-                    float childBoundDistance = FLT_MAX;
-                    BoxFace childBoundFace;
-                    glm::vec3 childBoundNormal;
-                    if (child->getBounds().findRayIntersection(origin, direction, invDirection, childBoundDistance, childBoundFace, childBoundNormal)) {
-                        // We only need to add this cell if it's closer than the local triangle set intersection (if there was one)
-                        if (childBoundDistance < bestLocalDistance) {
-                            priority = childBoundDistance;
-                        }
-                    }
-                }
-
-                if (priority < FLT_MAX) {
-                    if (sortedTriangleCells.size() > 0 && priority < sortedTriangleCells.front().first) {
-                        sortedTriangleCells.emplace_front(priority, child);
-                    } else {
-                        sortedTriangleCells.emplace_back(priority, child);
-                    }
-                }
-            }
-        };
-        sortingOperator(_children.first);
-        sortingOperator(_children.second);
-
-        for (auto it = sortedTriangleCells.begin(); it != sortedTriangleCells.end(); ++it) {
-            const SortedTriangleCell& sortedTriangleCell = *it;
-            float childDistance = sortedTriangleCell.first;
-            // We can exit once childDistance > bestLocalDistance
-            if (childDistance > bestLocalDistance) {
-                break;
-            }
-            // If we're inside the child cell and !precision, we need the actual distance to the cell bounds
-            if (!precision && childDistance < EPSILON) {
-                BoxFace childBoundFace;
-                glm::vec3 childBoundNormal;
-                sortedTriangleCell.second->getBounds().findRayIntersection(origin, direction, invDirection, childDistance, childBoundFace, childBoundNormal);
-            }
-            BoxFace childFace;
-            Triangle childTriangle;
-            if (sortedTriangleCell.second->findRayIntersection(origin, direction, invDirection, childDistance, childFace, childTriangle, precision, trianglesTouched)) {
-                if (childDistance < bestLocalDistance) {
-                    bestLocalDistance = childDistance;
-                    bestLocalFace = childFace;
-                    bestLocalTriangle = childTriangle;
+        uint32_t firstPacket = ~entry.child;
+        for (uint32_t i = firstPacket; i < firstPacket + entry.packetCount; i++) {
+            const TrianglePacket& packet = _packets[i];
+            float distances[PACKET_SIZE];
+            int hits = findRayPacketIntersections(packet, origin, direction, allowBackface, distances);
+            for (int lane = 0; hits != 0; lane++, hits >>= 1) {
+                if ((hits & 1) && distances[lane] < bestDistance) {
+                    bestDistance = distances[lane];
+                    bestTriangle = packet.firstTriangle + lane;
                     intersects = true;
-                    break;
                 }
             }
         }
     }
 
     if (intersects) {
-        distance = bestLocalDistance;
-        face = bestLocalFace;
-        triangle = bestLocalTriangle;
+        distance = bestDistance;
+        face = UNKNOWN_FACE;
+        if (precision) {
+            triangle = _triangles[bestTriangle];
+        }
     }
     return intersects;
 }
@@ -330,146 +584,81 @@ bool TriangleSet::findParabolaIntersection(const glm::vec3& origin, const glm::v
     if (!_isBalanced) {
         balanceTree();
     }
-
-    float localDistance = parabolicDistance;
-    int trianglesTouched = 0;
-    bool hit = _triangleTree.findParabolaIntersection(origin, velocity, acceleration, localDistance, face, triangle, precision, trianglesTouched, allowBackface);
-    if (hit) {
-        parabolicDistance = localDistance;
-    }
-
-#if WANT_DEBUGGING
-    if (precision) {
-        qDebug() << "trianglesTouched :" << trianglesTouched << "out of:" << _triangleTree._population << "_triangles.size:" << _triangles.size();
+    if (_nodes.empty()) {
+        return false;
     }
-#endif
-    return hit;
-}
 
-bool TriangleSet::TriangleTreeCell::findParabolaIntersectionInternal(const glm::vec3& origin, const glm::vec3& velocity,
-                                                                       const glm::vec3& acceleration, float& parabolicDistance,
-                                                                       BoxFace& face, Triangle& triangle, bool precision,
-                                                                       int& trianglesTouched, bool allowBackface) {
-    bool intersectedSomething = false;
     float bestDistance = FLT_MAX;
-    Triangle bestTriangle;
-
-    if (precision) {
-        for (const auto& triangleIndex : _triangleIndices) {
-            const auto& thisTriangle = _allTriangles[triangleIndex];
-            float thisTriangleDistance;
-            trianglesTouched++;
-            if (findParabolaTriangleIntersection(origin, velocity, acceleration, thisTriangle, thisTriangleDistance, allowBackface)) {
-                if (thisTriangleDistance < bestDistance) {
-                    bestDistance = thisTriangleDistance;
-                    bestTriangle = thisTriangle;
-                    intersectedSomething = true;
-                }
-            }
-        }
-    } else {
-        intersectedSomething = true;
-        bestDistance = parabolicDistance;
-    }
-
-    if (intersectedSomething) {
-        parabolicDistance = bestDistance;
-        triangle = bestTriangle;
-    }
-
-    return intersectedSomething;
-}
-
-bool TriangleSet::TriangleTreeCell::findParabolaIntersection(const glm::vec3& origin, const glm::vec3& velocity,
-                                                               const glm::vec3& acceleration, float& parabolicDistance,
-                                                               BoxFace& face, Triangle& triangle, bool precision,
-                                                               int& trianglesTouched, bool allowBackface) {
-    if (_population < 1) {
-        return false; // no triangles below here, so we can't intersect
-    }
-
-    float bestLocalDistance = FLT_MAX;
-    BoxFace bestLocalFace;
-    Triangle bestLocalTriangle;
+    uint32_t bestTriangle = 0;
     bool intersects = false;
 
-    // Check our local triangle set first
-    // The distance passed in here is the distance to our bounding box.  If !precision, that distance is used
-    {
-        float internalDistance = parabolicDistance;
-        BoxFace internalFace;
-        Triangle internalTriangle;
-        if (findParabolaIntersectionInternal(origin, velocity, acceleration, internalDistance, internalFace, internalTriangle, precision, trianglesTouched, allowBackface)) {
-            bestLocalDistance = internalDistance;
-            bestLocalFace = internalFace;
-            bestLocalTriangle = internalTriangle;
-            intersects = true;
+    std::array<StackEntry, MAX_STACK_SIZE> stack;
+    int stackSize = 0;
+    stack[stackSize++] = { 0, 0, 0.0f, 0.0f };
+    while (stackSize > 0) {
+        const StackEntry entry = stack[--stackSize];
+        if (entry.distance > bestDistance) {
+            continue;
         }
-    }
-
-    // if we're not yet at the max depth, then check our children
-    if (_depth < MAX_DEPTH) {
-        std::list<SortedTriangleCell> sortedTriangleCells;
-        auto sortingOperator = [&](std::shared_ptr<TriangleTreeCell>& child) {
-            if (child) {
-                float priority = FLT_MAX;
-                if (child->getBounds().contains(origin)) {
-                    priority = 0.0f;
-                } else {
-                    float childBoundDistance = FLT_MAX;
-                    BoxFace childBoundFace;
-                    glm::vec3 childBoundNormal;
-                    if (child->getBounds().findParabolaIntersection(origin, velocity, acceleration, childBoundDistance, childBoundFace, childBoundNormal)) {
-                        // We only need to add this cell if it's closer than the local triangle set intersection (if there was one)
-                        if (childBoundDistance < bestLocalDistance) {
-                            priority = childBoundDistance;
-                        }
-                    }
-                }
 
-                if (priority < FLT_MAX) {
-                    if (sortedTriangleCells.size() > 0 && priority < sortedTriangleCells.front().first) {
-                        sortedTriangleCells.emplace_front(priority, child);
-                    } else {
-                        sortedTriangleCells.emplace_back(priority, child);
-                    }
-                }
-            }
-        };
-        sortingOperator(_children.first);
-        sortingOperator(_children.second);
-
-        for (auto it = sortedTriangleCells.begin(); it != sortedTriangleCells.end(); ++it) {
-            const SortedTriangleCell& sortedTriangleCell = *it;
-            float childDistance = sortedTriangleCell.first;
-            // We can exit once childDistance > bestLocalDistance
-            if (childDistance > bestLocalDistance) {
-                break;
-            }
-            // If we're inside the child cell and !precision, we need the actual distance to the cell bounds
-            if (!precision && childDistance < EPSILON) {
+        if (entry.packetCount == 0) {
+            // parabolas aren't worth testing four at a time, the bounds are tested one by one
+            const Node& node = _nodes[entry.child];
+            float distances[NODE_WIDTH];
+            float exitDistances[NODE_WIDTH];
+            int hits = 0;
+            for (int lane = 0; lane < (int)node.childCount; lane++) {
+                glm::vec3 minimum(node.minimum[0][lane], node.minimum[1][lane], node.minimum[2][lane]);
+                glm::vec3 maximum(node.maximum[0][lane], node.maximum[1][lane], node.maximum[2][lane]);
+                AABox childBounds(minimum, maximum - minimum);
                 BoxFace childBoundFace;
                 glm::vec3 childBoundNormal;
-                sortedTriangleCell.second->getBounds().findParabolaIntersection(origin, velocity, acceleration, childDistance, childBoundFace, childBoundNormal);
+                float childBoundDistance = FLT_MAX;
+                bool hitsBounds = childBounds.findParabolaIntersection(origin, velocity, acceleration, childBoundDistance,
+                    childBoundFace, childBoundNormal);
+                if (childBounds.contains(origin)) {
+                    distances[lane] = 0.0f;
+                    exitDistances[lane] = hitsBounds ? childBoundDistance : 0.0f;
+                    hits |= 1 << lane;
+                } else if (hitsBounds && childBoundDistance < bestDistance) {
+                    distances[lane] = childBoundDistance;
+                    exitDistances[lane] = childBoundDistance;
+                    hits |= 1 << lane;
+                }
             }
-            BoxFace childFace;
-            Triangle childTriangle;
-            if (sortedTriangleCell.second->findParabolaIntersection(origin, velocity, acceleration, childDistance, childFace, childTriangle, precision, trianglesTouched)) {
-                if (childDistance < bestLocalDistance) {
-                    bestLocalDistance = childDistance;
-                    bestLocalFace = childFace;
-                    bestLocalTriangle = childTriangle;
+            pushChildren(stack, stackSize, hits, node.children, node.packetCounts, distances, exitDistances);
+            continue;
+        }
+
+        if (!precision) {
+            // when the origin is inside the bounds, use where the parabola leaves them
+            bestDistance = entry.distance > 0.0f ? entry.distance : entry.exitDistance;
+            intersects = true;
+            continue;
+        }
+
+        uint32_t firstPacket = ~entry.child;
+        for (uint32_t i = firstPacket; i < firstPacket + entry.packetCount; i++) {
+            const TrianglePacket& packet = _packets[i];
+            for (uint32_t lane = 0; lane < packet.triangleCount; lane++) {
+                const Triangle& thisTriangle = _triangles[packet.firstTriangle + lane];
+                float thisTriangleDistance;
+                if (findParabolaTriangleIntersection(origin, velocity, acceleration, thisTriangle, thisTriangleDistance,
+                        allowBackface) && thisTriangleDistance < bestDistance) {
+                    bestDistance = thisTriangleDistance;
+                    bestTriangle = packet.firstTriangle + lane;
                     intersects = true;
-                    break;
                 }
             }
         }
     }
 
     if (intersects) {
-        parabolicDistance = bestLocalDistance;
-        face = bestLocalFace;
-        triangle = bestLocalTriangle;
+        parabolicDistance = bestDistance;
+        face = UNKNOWN_FACE;
+        if (precision) {
+            triangle = _triangles[bestTriangle];
+        }
     }
     return intersects;
 }
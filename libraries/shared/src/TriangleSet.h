@@ -17,53 +17,15 @@
 #include "AABox.h"
 #include "GeometryUtil.h"
 
+// A set of triangles that rays and parabolas can be picked against.
+//
+// The triangles are sorted into a bounding volume hierarchy the first time the set is picked against, rather than when
+// it's filled, since most models are never picked precisely. The hierarchy is built with the surface area heuristic and
+// flattened into an array of nodes with four children each, so that a ray can be tested against all four children's
+// bounds at once. The leaves are packets of four triangles that are also tested at once.
 class TriangleSet {
-
-    class TriangleTreeCell {
-    public:
-        TriangleTreeCell(std::vector<Triangle>& allTriangles) : _allTriangles(allTriangles) {}
-        TriangleTreeCell(std::vector<Triangle>& allTriangles, const AABox& bounds, int depth);
-
-        void insert(size_t triangleIndex);
-        void reset(const AABox& bounds, int depth = 0);
-        void clear();
-
-        bool findRayIntersection(const glm::vec3& origin, const glm::vec3& direction, const glm::vec3& invDirection,
-            float& distance, BoxFace& face, Triangle& triangle, bool precision, int& trianglesTouched,
-            bool allowBackface = false);
-        bool findParabolaIntersection(const glm::vec3& origin, const glm::vec3& velocity, const glm::vec3& acceleration,
-            float& parabolicDistance, BoxFace& face, Triangle& triangle, bool precision, int& trianglesTouched,
-            bool allowBackface = false);
-
-        const AABox& getBounds() const { return _bounds; }
-
-        void debugDump();
-
-    protected:
-        // checks our internal list of triangles
-        bool findRayIntersectionInternal(const glm::vec3& origin, const glm::vec3& direction,
-            float& distance, BoxFace& face, Triangle& triangle, bool precision, int& trianglesTouched,
-            bool allowBackface = false);
-        bool findParabolaIntersectionInternal(const glm::vec3& origin, const glm::vec3& velocity, const glm::vec3& acceleration,
-            float& parabolicDistance, BoxFace& face, Triangle& triangle, bool precision, int& trianglesTouched,
-            bool allowBackface = false);
-
-        std::pair<AABox, AABox> getTriangleTreeCellChildBounds();
-
-        std::vector<Triangle>& _allTriangles;
-        std::pair<std::shared_ptr<TriangleTreeCell>, std::shared_ptr<TriangleTreeCell>> _children;
-        int _depth { 0 };
-        int _population { 0 };
-        AABox _bounds;
-        std::vector<size_t> _triangleIndices;
-
-        friend class TriangleSet;
-    };
-
-    using SortedTriangleCell = std::pair<float, std::shared_ptr<TriangleTreeCell>>;
-
 public:
-    TriangleSet() : _triangleTree(_triangles) {}
+    TriangleSet() {}
 
     void debugDump();
 
@@ -74,6 +36,7 @@ public:
     bool findParabolaIntersection(const glm::vec3& origin, const glm::vec3& velocity, const glm::vec3& acceleration,
         float& parabolicDistance, BoxFace& face, Triangle& triangle, bool precision, bool allowBackface = false);
 
+    // builds the hierarchy now instead of on the first pick, this reorders the triangles
     void balanceTree();
 
     void reserve(size_t size) { _triangles.reserve(size); } // reserve space in the datastructure for size number of triangles
@@ -86,9 +49,33 @@ public:
     bool convexHullContains(const glm::vec3& point) const;
     const AABox& getBounds() const { return _bounds; }
 
+    static const int NODE_WIDTH = 4;
+    static const int PACKET_SIZE = 4;
+
 protected:
+    // four child bounds as structures of arrays, a child is either another node or a run of packets
+    struct Node {
+        float minimum[3][NODE_WIDTH];
+        float maximum[3][NODE_WIDTH];
+        int32_t children[NODE_WIDTH]; // a node index, or the bitwise not of the first packet index for a leaf
+        uint32_t packetCounts[NODE_WIDTH]; // 0 for a node
+        uint32_t childCount;
+    };
+
+    // four triangles as structures of arrays, with the edges from v0 precomputed
+    struct TrianglePacket {
+        float v0[3][PACKET_SIZE];
+        float firstSide[3][PACKET_SIZE];
+        float secondSide[3][PACKET_SIZE];
+        uint32_t firstTriangle; // into _triangles
+        uint32_t triangleCount;
+    };
+
+    class Builder;
+
     bool _isBalanced { false };
     std::vector<Triangle> _triangles;
-    TriangleTreeCell _triangleTree;
+    std::vector<Node> _nodes;
+    std::vector<TrianglePacket> _packets;
     AABox _bounds;
 };
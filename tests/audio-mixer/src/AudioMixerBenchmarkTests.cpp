@@ -0,0 +1,430 @@
+//
+//  AudioMixerBenchmarkTests.cpp
+//  tests/audio-mixer/src
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "AudioMixerBenchmarkTests.h"
+
+#include <algorithm>
+#include <thread>
+
+#include <glm/gtc/constants.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+#include <QtCore/QFile>
+
+#include <AccountManager.h>
+#include <AddressManager.h>
+#include <AudioConstants.h>
+#include <GLMHelpers.h>
+#include <MixerBenchmarkUtils.h>
+#include <NodeList.h>
+#include <NumericalConstants.h>
+#include <plugins/CodecPlugin.h>
+#include <plugins/PluginManager.h>
+#include <PortableHighResolutionClock.h>
+#include <ReceivedMessage.h>
+#include <SharedUtil.h>
+#include <udt/PacketHeaders.h>
+
+#include "AudioMixerClientData.h"
+#include "AudioMixerSlavePool.h"
+
+QTEST_MAIN(AudioMixerBenchmarkTests)
+
+using namespace std::chrono;
+using namespace MixerBenchmarkUtils;
+
+namespace {
+
+const QString DEFAULT_CODEC_NAME = "hifiAC";
+
+// frames mixed before measuring, so that the jitter buffers of the sources have settled
+const int WARMUP_FRAMES = 50;
+
+// a client as seen by the mixer: either a listener (sends silent frames with its position)
+// or a source (talks in bursts while orbiting around a point, and does not listen)
+struct SimulatedClient {
+    SharedNodePointer node;
+    AudioMixerClientData* data { nullptr };
+    Encoder* encoder { nullptr };
+    bool isSource { false };
+    quint16 sequence { 0 };
+
+    glm::vec3 center;
+    float radius { 0.0f };
+    float angularSpeed { 0.0f };
+    float phase { 0.0f };
+
+    // generated tone
+    float frequency { 0.0f };
+    size_t pcmOffset { 0 };
+};
+
+class AudioMixerBenchmark {
+public:
+    AudioMixerBenchmark() : _pool(_sharedData) {}
+    ~AudioMixerBenchmark();
+
+    bool setup();
+    void run();
+
+private:
+    void loadPCM();
+    void addClient(int index, bool isSource);
+    void sendFrame(SimulatedClient& client, unsigned int frame);
+    bool isTalking(const SimulatedClient& client, unsigned int frame) const;
+    void report(int numFrames, double elapsedSeconds);
+
+    AudioMixerSlave::SharedData _sharedData;
+    AudioMixerSlavePool _pool;
+
+    int _numListeners { 0 };
+    int _numSources { 0 };
+    int _numFrames { 0 };
+    float _throttlingRatio { 0.0f };
+    bool _freeRun { false };
+
+    CodecPluginPointer _codec;
+    QString _codecName;
+    std::vector<int16_t> _recordedPCM;
+
+    std::vector<SimulatedClient> _clients;
+
+    // measured frames only
+    std::vector<uint64_t> _processTimes; // us
+    std::vector<uint64_t> _mixTimes; // us
+    AudioMixerStats _stats;
+    uint64_t _clientEncodes { 0 };
+    uint64_t _clientEncodeTime { 0 }; // ns spent encoding the source packets, client side
+
+    SentDatagramCounter _sent;
+};
+
+AudioMixerBenchmark::~AudioMixerBenchmark() {
+    for (auto& client : _clients) {
+        if (client.encoder) {
+            _codec->releaseEncoder(client.encoder);
+        }
+    }
+    DependencyManager::get<NodeList>()->setDatagramSinkOperator(nullptr);
+    DependencyManager::get<NodeList>()->eraseAllNodes();
+}
+
+bool AudioMixerBenchmark::setup() {
+    _numListeners = intFromEnvironment("HIFI_AUDIO_MIXER_BENCH_LISTENERS", 20);
+    _numSources = intFromEnvironment("HIFI_AUDIO_MIXER_BENCH_SOURCES", 20);
+    _numFrames = WARMUP_FRAMES + (int)(intFromEnvironment("HIFI_AUDIO_MIXER_BENCH_SECONDS", 5) *
+        AudioConstants::NETWORK_FRAMES_PER_SEC);
+    _throttlingRatio = glm::clamp(floatFromEnvironment("HIFI_AUDIO_MIXER_BENCH_THROTTLE", 0.0f), 0.0f, 1.0f);
+    _freeRun = intFromEnvironment("HIFI_AUDIO_MIXER_BENCH_FREE_RUN", 0) != 0;
+    _pool.setNumThreads(intFromEnvironment("HIFI_AUDIO_MIXER_BENCH_THREADS", QThread::idealThreadCount()));
+
+    if (_numListeners <= 0 || _numSources < 0) {
+        qWarning() << "Invalid audio-mixer benchmark workload:" << _numListeners << "listeners," << _numSources << "sources";
+        return false;
+    }
+
+    // pick the codec the same way the mixer would, but without a negotiation round trip
+    QString requestedCodec = qEnvironmentVariable("HIFI_AUDIO_MIXER_BENCH_CODEC", DEFAULT_CODEC_NAME);
+    for (auto& codec : PluginManager::getInstance()->getCodecPlugins()) {
+        if (codec->getName() == requestedCodec) {
+            _codec = codec;
+            _codecName = codec->getName();
+        }
+    }
+    if (!_codec) {
+        qWarning() << "Codec" << requestedCodec << "is not available, mixing uncompressed PCM";
+    }
+
+    loadPCM();
+
+    // every datagram the mixer sends ends up here instead of on the wire
+    auto nodeList = DependencyManager::get<NodeList>();
+    _sent.countDatagramsFrom(*nodeList);
+
+    for (int i = 0; i < _numListeners + _numSources; ++i) {
+        addClient(i, i >= _numListeners);
+    }
+
+    return true;
+}
+
+void AudioMixerBenchmark::loadPCM() {
+    QString path = qEnvironmentVariable("HIFI_AUDIO_MIXER_BENCH_PCM");
+    if (path.isEmpty()) {
+        return;
+    }
+
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        qWarning() << "Could not open" << path << "- using generated tones";
+        return;
+    }
+
+    QByteArray bytes = file.readAll();
+    _recordedPCM.resize(bytes.size() / sizeof(int16_t));
+    memcpy(_recordedPCM.data(), bytes.constData(), _recordedPCM.size() * sizeof(int16_t));
+
+    if (_recordedPCM.size() < (size_t)AudioConstants::NETWORK_FRAME_SAMPLES_PER_CHANNEL) {
+        qWarning() << path << "holds less than a frame of audio - using generated tones";
+        _recordedPCM.clear();
+    }
+}
+
+void AudioMixerBenchmark::addClient(int index, bool isSource) {
+    auto nodeList = DependencyManager::get<NodeList>();
+
+    Node::LocalID localID = (Node::LocalID)(index + 1);
+    HifiSockAddr sockAddr(QHostAddress::LocalHost, FIRST_CLIENT_PORT + index);
+    auto node = nodeList->addOrUpdateNode(QUuid::createUuid(), NodeType::Agent, sockAddr, sockAddr, localID);
+
+    // only listeners have an active socket, sources are considered for mixing but never mixed for
+    if (!isSource) {
+        node->activatePublicSocket();
+    }
+
+    auto data = new AudioMixerClientData(node->getUUID(), localID);
+    node->setLinkedData(std::unique_ptr<NodeData> { data });
+    if (_codec) {
+        data->setupCodec(_codec, _codecName);
+    }
+
+    SimulatedClient client;
+    client.node = node;
+    client.data = data;
+    client.isSource = isSource;
+    if (isSource && _codec) {
+        client.encoder = _codec->createEncoder(AudioConstants::SAMPLE_RATE, AudioConstants::MONO);
+    }
+
+    // spread everyone over a 40m x 40m area, sources walk in circles
+    const float AREA_SIZE = 40.0f;
+    const float MAX_RADIUS = 5.0f;
+    const float MAX_ANGULAR_SPEED = glm::pi<float>() / 4.0f; // rad/s
+    client.center = glm::vec3(randFloatInRange(-AREA_SIZE, AREA_SIZE) / 2.0f, 0.0f, randFloatInRange(-AREA_SIZE, AREA_SIZE) / 2.0f);
+    client.radius = isSource ? randFloatInRange(1.0f, MAX_RADIUS) : 0.0f;
+    client.angularSpeed = randFloatInRange(-MAX_ANGULAR_SPEED, MAX_ANGULAR_SPEED);
+    client.phase = randFloatInRange(0.0f, glm::two_pi<float>());
+    client.frequency = 110.0f * (1 + index % 8);
+    client.pcmOffset = _recordedPCM.empty() ? 0 : randIntInRange(0, (int)_recordedPCM.size() - 1);
+
+    _clients.push_back(client);
+}
+
+bool AudioMixerBenchmark::isTalking(const SimulatedClient& client, unsigned int frame) const {
+    if (!client.isSource) {
+        return false;
+    }
+
+    // talk for three seconds, pause for one, staggered per source
+    const unsigned int PERIOD = (unsigned int)(4 * AudioConstants::NETWORK_FRAMES_PER_SEC);
+    const unsigned int TALKING = (unsigned int)(3 * AudioConstants::NETWORK_FRAMES_PER_SEC);
+    unsigned int offset = (unsigned int)(client.phase / glm::two_pi<float>() * PERIOD);
+    return (frame + offset) % PERIOD < TALKING;
+}
+
+void AudioMixerBenchmark::sendFrame(SimulatedClient& client, unsigned int frame) {
+    bool talking = isTalking(client, frame);
+    PacketType type = talking ? PacketType::MicrophoneAudioNoEcho : PacketType::SilentAudioFrame;
+
+    float time = frame * AudioConstants::NETWORK_FRAME_SECS;
+    float angle = client.phase + client.angularSpeed * time;
+    glm::vec3 position = client.center + client.radius * glm::vec3(cosf(angle), 0.0f, sinf(angle));
+    glm::quat orientation = glm::angleAxis(angle, Vectors::UP);
+    const glm::vec3 AVATAR_BOUNDING_BOX_SCALE { 0.5f, 1.8f, 0.5f };
+
+    // same layout as AbstractAudioInterface::emitAudioPacket
+    auto packet = NLPacket::create(type);
+    packet->writePrimitive(client.sequence++);
+    packet->writeString(_codecName);
+    if (talking) {
+        quint8 channelFlag = 0;
+        packet->writePrimitive(channelFlag);
+    } else {
+        quint16 numSilentSamples = AudioConstants::NETWORK_FRAME_SAMPLES_PER_CHANNEL;
+        packet->writePrimitive(numSilentSamples);
+    }
+    packet->writePrimitive(position);
+    packet->writePrimitive(orientation);
+    packet->writePrimitive(position - AVATAR_BOUNDING_BOX_SCALE / 2.0f);
+    packet->writePrimitive(AVATAR_BOUNDING_BOX_SCALE);
+
+    if (talking) {
+        QByteArray decodedBuffer(AudioConstants::NETWORK_FRAME_BYTES_PER_CHANNEL, 0);
+        auto samples = reinterpret_cast<int16_t*>(decodedBuffer.data());
+        for (int i = 0; i < AudioConstants::NETWORK_FRAME_SAMPLES_PER_CHANNEL; ++i) {
+            if (_recordedPCM.empty()) {
+                const float AMPLITUDE = 8000.0f;
+                float t = (float)client.pcmOffset++ / AudioConstants::SAMPLE_RATE;
+                samples[i] = (int16_t)(AMPLITUDE * sinf(glm::two_pi<float>() * client.frequency * t));
+            } else {
+                samples[i] = _recordedPCM[client.pcmOffset++ % _recordedPCM.size()];
+            }
+        }
+
+        QByteArray encodedBuffer;
+        auto encodeStart = p_high_resolution_clock::now();
+        if (client.encoder) {
+            client.encoder->encode(decodedBuffer, encodedBuffer);
+        } else {
+            encodedBuffer = decodedBuffer;
+        }
+        _clientEncodeTime += duration_cast<nanoseconds>(p_high_resolution_clock::now() - encodeStart).count();
+        ++_clientEncodes;
+
+        packet->write(encodedBuffer);
+    }
+
+    auto message = QSharedPointer<ReceivedMessage>::create(QByteArray(packet->getPayload(), packet->getPayloadSize()),
+        type, versionForPacketType(type), client.node->getPublicSocket(), client.node->getLocalID());
+    client.data->queuePacket(message, client.node);
+}
+
+void AudioMixerBenchmark::run() {
+    auto nodeList = DependencyManager::get<NodeList>();
+
+    auto nextFrame = p_high_resolution_clock::now();
+    auto measureStart = nextFrame;
+
+    for (unsigned int frame = 1; frame <= (unsigned int)_numFrames; ++frame) {
+        bool measuring = frame > (unsigned int)WARMUP_FRAMES;
+        if (frame == (unsigned int)WARMUP_FRAMES + 1) {
+            measureStart = p_high_resolution_clock::now();
+            _clientEncodes = 0;
+            _clientEncodeTime = 0;
+            _sent.reset();
+            _pool.each([](AudioMixerSlave& slave) { slave.stats.reset(); });
+        }
+
+        for (auto& client : _clients) {
+            sendFrame(client, frame);
+        }
+
+        // mirror AudioMixer::start
+        auto processStart = p_high_resolution_clock::now();
+        _sharedData.addedStreams.clear();
+        nodeList->nestedEach([&](NodeList::const_iterator cbegin, NodeList::const_iterator cend) {
+            _pool.processPackets(cbegin, cend);
+        });
+        auto processEnd = p_high_resolution_clock::now();
+
+        _sharedData.removedNodes.clear();
+        _sharedData.removedStreams.clear();
+        QCoreApplication::processEvents();
+
+        int numToRetain = -1;
+        if (_throttlingRatio > EPSILON) {
+            numToRetain = nodeList->size() * (1.0f - _throttlingRatio);
+        }
+
+        auto mixStart = p_high_resolution_clock::now();
+        nodeList->nestedEach([&](NodeList::const_iterator cbegin, NodeList::const_iterator cend) {
+            _pool.mix(cbegin, cend, frame, numToRetain);
+        });
+        auto mixEnd = p_high_resolution_clock::now();
+
+        uint64_t slowestSlaveMixTime = 0;
+        _pool.each([&](AudioMixerSlave& slave) {
+            slowestSlaveMixTime = std::max(slowestSlaveMixTime, slave.stats.slaveMixTime);
+            if (measuring) {
+                _stats.accumulate(slave.stats);
+            }
+            slave.stats.reset();
+        });
+
+        if (measuring) {
+            _stats.slowestSlaveMixTime += slowestSlaveMixTime;
+            _processTimes.push_back(duration_cast<microseconds>(processEnd - processStart).count());
+            _mixTimes.push_back(duration_cast<microseconds>(mixEnd - mixStart).count());
+        }
+
+        if (!_freeRun) {
+            nextFrame += microseconds(AudioConstants::NETWORK_FRAME_USECS);
+            std::this_thread::sleep_until(nextFrame);
+        }
+    }
+
+    auto elapsed = duration_cast<duration<double>>(p_high_resolution_clock::now() - measureStart);
+    report(_numFrames - WARMUP_FRAMES, elapsed.count());
+}
+
+void AudioMixerBenchmark::report(int numFrames, double elapsedSeconds) {
+    std::sort(_processTimes.begin(), _processTimes.end());
+    std::sort(_mixTimes.begin(), _mixTimes.end());
+
+    float perFrame = 1.0f / numFrames;
+    int numEncodes = _stats.sumListeners - _stats.sumListenersSilent;
+
+    qDebug().noquote() << QString("audio-mixer benchmark: %1 listeners, %2 sources, %3 threads, codec %4, %5 frames in %6s%7")
+        .arg(_numListeners).arg(_numSources).arg(_pool.numThreads())
+        .arg(_codec ? _codecName : "none").arg(numFrames).arg(elapsedSeconds, 0, 'f', 2)
+        .arg(_freeRun ? " (free running)" : "");
+    qDebug().noquote() << QString("  mix us/frame:     p50 %1  p95 %2  p99 %3  max %4")
+        .arg(percentile(_mixTimes, 0.50f)).arg(percentile(_mixTimes, 0.95f))
+        .arg(percentile(_mixTimes, 0.99f)).arg(percentile(_mixTimes, 1.0f));
+    qDebug().noquote() << QString("  packets us/frame: p50 %1  p95 %2  p99 %3  max %4")
+        .arg(percentile(_processTimes, 0.50f)).arg(percentile(_processTimes, 0.95f))
+        .arg(percentile(_processTimes, 0.99f)).arg(percentile(_processTimes, 1.0f));
+    qDebug().noquote() << QString("  slaves:           slowest %1 us/frame, stolen listeners %2/frame")
+        .arg(_stats.slowestSlaveMixTime * perFrame / NSECS_PER_USEC, 0, 'f', 1)
+        .arg(_stats.stolenListeners * perFrame, 0, 'f', 2);
+    qDebug().noquote() << QString("  hrtf/frame:       renders %1  resets %2  updates %3  manual stereo %4")
+        .arg(_stats.hrtfRenders * perFrame, 0, 'f', 1).arg(_stats.hrtfResets * perFrame, 0, 'f', 1)
+        .arg(_stats.hrtfUpdates * perFrame, 0, 'f', 1).arg(_stats.manualStereoMixes * perFrame, 0, 'f', 1);
+    qDebug().noquote() << QString("  streams/frame:    active %1  inactive %2  skipped %3 (throttling ratio %4)")
+        .arg(_stats.active * perFrame, 0, 'f', 1).arg(_stats.inactive * perFrame, 0, 'f', 1)
+        .arg(_stats.skipped * perFrame, 0, 'f', 1).arg(_throttlingRatio, 0, 'f', 2);
+    qDebug().noquote() << QString("  throttling:       active->skipped %1  inactive->skipped %2  skipped->active %3  skipped->inactive %4")
+        .arg(_stats.activeToSkipped).arg(_stats.inactiveToSkipped)
+        .arg(_stats.skippedToActive).arg(_stats.skippedToInactive);
+    qDebug().noquote() << QString("  encodes/s:        mixer %1  clients %2 (%3 us each)")
+        .arg(numEncodes / elapsedSeconds, 0, 'f', 0)
+        .arg(_clientEncodes / elapsedSeconds, 0, 'f', 0)
+        .arg(_clientEncodes > 0 ? (double)_clientEncodeTime / _clientEncodes / NSECS_PER_USEC : 0.0, 0, 'f', 2);
+    qDebug().noquote() << QString("  sent:             %1 datagrams/s, %2 kbps, %3 mixed and %4 silent frames per listener per second")
+        .arg(_sent.getDatagrams() / elapsedSeconds, 0, 'f', 0)
+        .arg(_sent.getBytes() * BITS_IN_BYTE / elapsedSeconds / BYTES_PER_KILOBYTE, 0, 'f', 0)
+        .arg(_sent.getDatagrams(PacketType::MixedAudio) / elapsedSeconds / _numListeners, 0, 'f', 1)
+        .arg(_sent.getDatagrams(PacketType::SilentAudioFrame) / elapsedSeconds / _numListeners, 0, 'f', 1);
+
+    // sanity checks, so that a broken simulation does not report great numbers
+    QVERIFY(_stats.sumListeners == _numListeners * numFrames);
+    if (_numSources > 0) {
+        QVERIFY(_sent.getDatagrams(PacketType::MixedAudio) > 0);
+    }
+}
+
+}
+
+void AudioMixerBenchmarkTests::initTestCase() {
+    DependencyManager::registerInheritance<LimitedNodeList, NodeList>();
+    DependencyManager::set<AccountManager>();
+    DependencyManager::set<AddressManager>();
+    DependencyManager::set<NodeList>(NodeType::AudioMixer);
+    DependencyManager::set<PluginManager>();
+
+    // only load the codec plugins, like the mixer does
+    PluginManager::getInstance()->setPluginFilter([](const QJsonObject& metaData) {
+        QJsonValue nameValue = metaData["MetaData"]["name"];
+        return nameValue.toString().contains("codec", Qt::CaseInsensitive);
+    });
+}
+
+void AudioMixerBenchmarkTests::cleanupTestCase() {
+    DependencyManager::destroy<PluginManager>();
+    DependencyManager::destroy<NodeList>();
+    DependencyManager::destroy<AddressManager>();
+    DependencyManager::destroy<AccountManager>();
+}
+
+void AudioMixerBenchmarkTests::benchmarkMix() {
+    AudioMixerBenchmark benchmark;
+    QVERIFY(benchmark.setup());
+    benchmark.run();
+}
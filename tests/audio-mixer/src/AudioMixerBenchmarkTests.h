@@ -0,0 +1,40 @@
+//
+//  AudioMixerBenchmarkTests.h
+//  tests/audio-mixer/src
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_AudioMixerBenchmarkTests_h
+#define hifi_AudioMixerBenchmarkTests_h
+
+#include <QtTest/QtTest>
+
+// Headless load simulator for the audio-mixer.
+//
+// Builds AudioMixerClientData for synthetic listeners and moving sources, feeds them encoded microphone
+// packets every frame and drives AudioMixerSlavePool at the network frame rate (100 Hz). Nothing goes on
+// the wire: the NodeList socket hands every datagram to a counting sink instead.
+//
+// The workload is configured from the environment so that the same binary can size mixer hosts:
+//   HIFI_AUDIO_MIXER_BENCH_LISTENERS  number of listening agents (default 20)
+//   HIFI_AUDIO_MIXER_BENCH_SOURCES    number of talking, non-listening agents (default 20)
+//   HIFI_AUDIO_MIXER_BENCH_SECONDS    simulated seconds (default 5)
+//   HIFI_AUDIO_MIXER_BENCH_THREADS    slave threads (default QThread::idealThreadCount())
+//   HIFI_AUDIO_MIXER_BENCH_THROTTLE   throttling ratio, as computed by AudioMixer::throttle (default 0)
+//   HIFI_AUDIO_MIXER_BENCH_CODEC      codec plugin name (default hifiAC, falls back to uncompressed PCM)
+//   HIFI_AUDIO_MIXER_BENCH_PCM        raw 24kHz mono s16le file to loop instead of generated tones
+//   HIFI_AUDIO_MIXER_BENCH_FREE_RUN   set to 1 to mix back to back instead of pacing at 100 Hz
+class AudioMixerBenchmarkTests : public QObject {
+    Q_OBJECT
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+
+    void benchmarkMix();
+};
+
+#endif // hifi_AudioMixerBenchmarkTests_h
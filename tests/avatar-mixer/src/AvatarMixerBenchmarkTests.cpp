@@ -0,0 +1,455 @@
+//
+//  AvatarMixerBenchmarkTests.cpp
+//  tests/avatar-mixer/src
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "AvatarMixerBenchmarkTests.h"
+
+#include <algorithm>
+#include <memory>
+#include <thread>
+
+#include <glm/gtc/constants.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+#include <AccountManager.h>
+#include <AddressManager.h>
+#include <AvatarData.h>
+#include <GLMHelpers.h>
+#include <MixerBenchmarkUtils.h>
+#include <NodeList.h>
+#include <NumericalConstants.h>
+#include <PortableHighResolutionClock.h>
+#include <ReceivedMessage.h>
+#include <SharedUtil.h>
+#include <ViewFrustum.h>
+#include <shared/ConicalViewFrustum.h>
+#include <udt/PacketHeaders.h>
+
+#include "AvatarMixerClientData.h"
+#include "AvatarMixerSlavePool.h"
+
+QTEST_MAIN(AvatarMixerBenchmarkTests)
+
+using namespace std::chrono;
+using namespace MixerBenchmarkUtils;
+
+namespace {
+
+// frames broadcast before measuring, so that every agent has sent its identity and traits once
+const int WARMUP_FRAMES = AVATAR_MIXER_BROADCAST_FRAMES_PER_SECOND;
+
+// how often each agent changes its display name, its skeleton and its view (staggered per agent)
+const int IDENTITY_CHANGE_PERIOD = 10 * AVATAR_MIXER_BROADCAST_FRAMES_PER_SECOND;
+const int TRAITS_CHANGE_PERIOD = 20 * AVATAR_MIXER_BROADCAST_FRAMES_PER_SECOND;
+const int VIEW_QUERY_PERIOD = AVATAR_MIXER_BROADCAST_FRAMES_PER_SECOND;
+
+// the client side of an agent, produces the same avatar data a MyAvatar would
+class SimulatedAvatar : public AvatarData {
+public:
+    void simulate(const glm::vec3& position, const glm::quat& orientation, float time) {
+        auto now = usecTimestampNow();
+
+        setWorldPosition(position);
+        setWorldOrientation(orientation);
+
+        // normally updated by MyAvatar from its skeleton
+        const glm::vec3 AVATAR_DIMENSIONS { 0.6f, 1.8f, 0.6f };
+        _globalPosition = position;
+        _globalPositionChanged = now;
+        _globalBoundingBoxDimensions = AVATAR_DIMENSIONS;
+        _globalBoundingBoxOffset = glm::vec3(0.0f, AVATAR_DIMENSIONS.y / 2.0f, 0.0f);
+        _avatarBoundingBoxChanged = now;
+
+        // idle animation: every joint sways at its own rate
+        const float SWAY_ANGLE = 0.2f;
+        QWriteLocker writeLock(&_jointDataLock);
+        for (int i = 0; i < _jointData.size(); ++i) {
+            auto& joint = _jointData[i];
+            float angle = SWAY_ANGLE * sinf(time * (1.0f + 0.1f * i));
+            joint.rotation = glm::angleAxis(angle, i % 2 ? Vectors::UNIT_X : Vectors::UNIT_Z);
+            joint.rotationIsDefaultPose = false;
+            joint.translationIsDefaultPose = (i % 8 != 0);
+            if (!joint.translationIsDefaultPose) {
+                joint.translation = glm::vec3(0.0f, 0.1f + 0.01f * sinf(time), 0.0f);
+            }
+        }
+    }
+
+    void setNumJoints(int numJoints) {
+        QWriteLocker writeLock(&_jointDataLock);
+        _jointData.resize(numJoints);
+    }
+};
+
+struct SimulatedAgent {
+    SharedNodePointer node;
+    AvatarMixerClientData* data { nullptr };
+    std::unique_ptr<SimulatedAvatar> avatar;
+
+    AvatarDataSequenceNumber sequence { 0 };
+    AvatarTraits::TraitVersion traitVersion { 0 };
+    AvatarTraits::TraitMessageSequence lastAckedTraitsSequence { 0 };
+    int skeletonIndex { 0 };
+    int displayNameIndex { 0 };
+
+    glm::vec3 center;
+    float radius { 0.0f };
+    float angularSpeed { 0.0f };
+    int frameOffset { 0 };
+};
+
+class AvatarMixerBenchmark {
+public:
+    AvatarMixerBenchmark() : _pool(&_slaveSharedData) {}
+    ~AvatarMixerBenchmark();
+
+    bool setup();
+    void run();
+
+private:
+    void addAgent(int index);
+    void sendFrame(SimulatedAgent& agent, int frame);
+    void sendAvatarData(SimulatedAgent& agent);
+    void sendIdentity(SimulatedAgent& agent);
+    void sendTraits(SimulatedAgent& agent);
+    void sendViewFrustum(SimulatedAgent& agent);
+    void sendTraitsAck(SimulatedAgent& agent);
+    void queuePacket(SimulatedAgent& agent, QSharedPointer<ReceivedMessage> message);
+    void report(int numFrames, double elapsedSeconds);
+
+    SlaveSharedData _slaveSharedData;
+    AvatarMixerSlavePool _pool;
+
+    int _numAgents { 0 };
+    int _numFrames { 0 };
+    int _numJoints { 0 };
+    float _maxKbpsPerNode { 0.0f };
+    float _throttlingRatio { 0.0f };
+    bool _freeRun { false };
+
+    std::vector<SimulatedAgent> _agents;
+
+    // measured frames only
+    std::vector<uint64_t> _frameTimes; // us
+    std::vector<uint64_t> _broadcastTimes; // us
+    AvatarMixerSlaveStats _stats;
+    uint64_t _inboundBytes { 0 };
+
+    SentDatagramCounter _sent;
+};
+
+AvatarMixerBenchmark::~AvatarMixerBenchmark() {
+    auto nodeList = DependencyManager::get<NodeList>();
+    nodeList->setDatagramSinkOperator(nullptr);
+    nodeList->eraseAllNodes();
+}
+
+bool AvatarMixerBenchmark::setup() {
+    _numAgents = intFromEnvironment("HIFI_AVATAR_MIXER_BENCH_AGENTS", 50);
+    _numFrames = WARMUP_FRAMES + intFromEnvironment("HIFI_AVATAR_MIXER_BENCH_SECONDS", 5) *
+        AVATAR_MIXER_BROADCAST_FRAMES_PER_SECOND;
+    _numJoints = glm::clamp(intFromEnvironment("HIFI_AVATAR_MIXER_BENCH_JOINTS", 60), 0, UINT8_MAX);
+    _maxKbpsPerNode = floatFromEnvironment("HIFI_AVATAR_MIXER_BENCH_MAX_KBPS", 5.0f * KILO_PER_MEGA);
+    _throttlingRatio = glm::clamp(floatFromEnvironment("HIFI_AVATAR_MIXER_BENCH_THROTTLE", 0.0f), 0.0f, 1.0f);
+    _freeRun = intFromEnvironment("HIFI_AVATAR_MIXER_BENCH_FREE_RUN", 0) != 0;
+    _pool.setNumThreads(intFromEnvironment("HIFI_AVATAR_MIXER_BENCH_THREADS", QThread::idealThreadCount()));
+
+    if (_numAgents <= 1) {
+        qWarning() << "Invalid avatar-mixer benchmark workload:" << _numAgents << "agents";
+        return false;
+    }
+
+    // every datagram the mixer sends ends up here instead of on the wire
+    // (reliable traits and identity lists never get past the connection handshake, they are counted by the slaves)
+    auto nodeList = DependencyManager::get<NodeList>();
+    _sent.countDatagramsFrom(*nodeList);
+
+    for (int i = 0; i < _numAgents; ++i) {
+        addAgent(i);
+    }
+
+    return true;
+}
+
+void AvatarMixerBenchmark::addAgent(int index) {
+    auto nodeList = DependencyManager::get<NodeList>();
+
+    Node::LocalID localID = (Node::LocalID)(index + 1);
+    HifiSockAddr sockAddr(QHostAddress::LocalHost, FIRST_CLIENT_PORT + index);
+    auto node = nodeList->addOrUpdateNode(QUuid::createUuid(), NodeType::Agent, sockAddr, sockAddr, localID);
+    node->activatePublicSocket();
+
+    auto data = new AvatarMixerClientData(node->getUUID(), localID);
+    node->setLinkedData(std::unique_ptr<NodeData> { data });
+
+    SimulatedAgent agent;
+    agent.node = node;
+    agent.data = data;
+    agent.avatar.reset(new SimulatedAvatar());
+    agent.avatar->setSessionUUID(node->getUUID());
+    agent.avatar->setNumJoints(_numJoints);
+
+    // spread everyone over a 100m x 100m area, walking in circles
+    const float AREA_SIZE = 100.0f;
+    const float MAX_RADIUS = 10.0f;
+    const float MAX_ANGULAR_SPEED = glm::pi<float>() / 8.0f; // rad/s
+    agent.center = glm::vec3(randFloatInRange(-AREA_SIZE, AREA_SIZE) / 2.0f, 0.0f, randFloatInRange(-AREA_SIZE, AREA_SIZE) / 2.0f);
+    agent.radius = randFloatInRange(1.0f, MAX_RADIUS);
+    agent.angularSpeed = randFloatInRange(-MAX_ANGULAR_SPEED, MAX_ANGULAR_SPEED);
+    agent.frameOffset = randIntInRange(0, TRAITS_CHANGE_PERIOD - 1);
+
+    _agents.push_back(std::move(agent));
+}
+
+void AvatarMixerBenchmark::queuePacket(SimulatedAgent& agent, QSharedPointer<ReceivedMessage> message) {
+    _inboundBytes += message->getSize();
+    agent.data->queuePacket(message, agent.node);
+}
+
+void AvatarMixerBenchmark::sendFrame(SimulatedAgent& agent, int frame) {
+    float time = (float)frame / AVATAR_MIXER_BROADCAST_FRAMES_PER_SECOND;
+    float angle = agent.angularSpeed * time + agent.frameOffset;
+    glm::vec3 position = agent.center + agent.radius * glm::vec3(cosf(angle), 0.0f, sinf(angle));
+    glm::quat orientation = glm::angleAxis(angle + glm::half_pi<float>(), Vectors::UP);
+    agent.avatar->simulate(position, orientation, time);
+
+    int agentFrame = frame + agent.frameOffset;
+    if (frame == 1 || agentFrame % IDENTITY_CHANGE_PERIOD == 0) {
+        sendIdentity(agent);
+    }
+    if (frame == 1 || agentFrame % TRAITS_CHANGE_PERIOD == 0) {
+        sendTraits(agent);
+    }
+    if (frame == 1 || agentFrame % VIEW_QUERY_PERIOD == 0) {
+        sendViewFrustum(agent);
+    }
+    sendTraitsAck(agent);
+    sendAvatarData(agent);
+}
+
+void AvatarMixerBenchmark::sendAvatarData(SimulatedAgent& agent) {
+    // same as AvatarData::sendAvatarDataPacket
+    bool cullSmallData = randFloat() < AVATAR_SEND_FULL_UPDATE_RATIO;
+    auto dataDetail = cullSmallData ? AvatarData::SendAllData : AvatarData::CullSmallData;
+    QByteArray avatarByteArray = agent.avatar->toByteArrayStateful(dataDetail);
+
+    int maximumByteArraySize = NLPacket::maxPayloadSize(PacketType::AvatarData) - sizeof(AvatarDataSequenceNumber);
+    if (avatarByteArray.size() > maximumByteArraySize) {
+        avatarByteArray = agent.avatar->toByteArrayStateful(AvatarData::MinimumData, true);
+    }
+    agent.avatar->doneEncoding(cullSmallData);
+
+    auto packet = NLPacket::create(PacketType::AvatarData, avatarByteArray.size() + sizeof(AvatarDataSequenceNumber));
+    packet->writePrimitive(++agent.sequence);
+    packet->write(avatarByteArray);
+
+    queuePacket(agent, QSharedPointer<ReceivedMessage>::create(QByteArray(packet->getPayload(), packet->getPayloadSize()),
+        PacketType::AvatarData, versionForPacketType(PacketType::AvatarData),
+        agent.node->getPublicSocket(), agent.node->getLocalID()));
+}
+
+void AvatarMixerBenchmark::sendIdentity(SimulatedAgent& agent) {
+    agent.avatar->setDisplayName(QString("Benchmark Agent %1.%2").arg(agent.node->getLocalID()).arg(agent.displayNameIndex++));
+    agent.avatar->pushIdentitySequenceNumber();
+    QByteArray identity = agent.avatar->identityByteArray();
+    _inboundBytes += identity.size();
+
+    // same as AvatarMixer::handleAvatarIdentityPacket, which runs on the mixer thread
+    bool identityChanged = false;
+    bool displayNameChanged = false;
+    QDataStream identityStream(identity);
+    agent.data->getAvatar().processAvatarIdentity(identityStream, identityChanged, displayNameChanged);
+    if (identityChanged) {
+        QMutexLocker nodeDataLocker(&agent.data->getMutex());
+        agent.data->flagIdentityChange();
+    }
+}
+
+void AvatarMixerBenchmark::sendTraits(SimulatedAgent& agent) {
+    // alternate between a handful of skeletons so that every change is a real change
+    const int NUM_SKELETONS = 4;
+    agent.avatar->setSkeletonModelURL(QUrl(QString("https://example.com/avatars/benchmark-%1.fst")
+        .arg(agent.skeletonIndex++ % NUM_SKELETONS)));
+
+    // same as ClientTraitsHandler::sendChangedTraitsToMixer
+    auto traitsPacketList = NLPacketList::create(PacketType::SetAvatarTraits, QByteArray(), true, true);
+    traitsPacketList->writePrimitive(++agent.traitVersion);
+    agent.avatar->packTrait(AvatarTraits::SkeletonModelURL, *traitsPacketList);
+    traitsPacketList->closeCurrentPacket();
+
+    queuePacket(agent, QSharedPointer<ReceivedMessage>::create(*traitsPacketList));
+}
+
+void AvatarMixerBenchmark::sendViewFrustum(SimulatedAgent& agent) {
+    const float FIELD_OF_VIEW = 45.0f;
+    const float ASPECT_RATIO = 16.0f / 9.0f;
+    const float NEAR_CLIP = 0.1f;
+    const float FAR_CLIP = 16384.0f;
+
+    ViewFrustum viewFrustum;
+    viewFrustum.setPosition(agent.avatar->getWorldPosition() + Vectors::UP);
+    viewFrustum.setOrientation(agent.avatar->getWorldOrientation());
+    viewFrustum.setProjection(FIELD_OF_VIEW, ASPECT_RATIO, NEAR_CLIP, FAR_CLIP);
+    viewFrustum.calculate();
+    ConicalViewFrustum conicalView { viewFrustum };
+
+    // same layout as Application::queryAvatars, handled by AvatarMixer::handleAvatarQueryPacket
+    QByteArray query(sizeof(uint8_t) + sizeof(ConicalViewFrustum), 0);
+    auto destinationBuffer = reinterpret_cast<unsigned char*>(query.data());
+    *destinationBuffer = 1;
+    int size = sizeof(uint8_t) + conicalView.serialize(destinationBuffer + sizeof(uint8_t));
+    query.resize(size);
+    _inboundBytes += size;
+
+    agent.data->readViewFrustumPacket(query);
+}
+
+void AvatarMixerBenchmark::sendTraitsAck(SimulatedAgent& agent) {
+    // same as AvatarHashMap::processBulkAvatarTraits, which acks every bulk traits message it receives
+    auto sequence = agent.data->getTraitsMessageSequence();
+    if (sequence == agent.lastAckedTraitsSequence) {
+        return;
+    }
+
+    for (auto ackedSequence = agent.lastAckedTraitsSequence + 1; ackedSequence <= sequence; ++ackedSequence) {
+        auto packet = NLPacket::create(PacketType::BulkAvatarTraitsAck, sizeof(AvatarTraits::TraitMessageSequence), true);
+        packet->writePrimitive(ackedSequence);
+        queuePacket(agent, QSharedPointer<ReceivedMessage>::create(QByteArray(packet->getPayload(), packet->getPayloadSize()),
+            PacketType::BulkAvatarTraitsAck, versionForPacketType(PacketType::BulkAvatarTraitsAck),
+            agent.node->getPublicSocket(), agent.node->getLocalID()));
+    }
+    agent.lastAckedTraitsSequence = sequence;
+}
+
+void AvatarMixerBenchmark::run() {
+    auto nodeList = DependencyManager::get<NodeList>();
+
+    const microseconds FRAME_DURATION { USECS_PER_SECOND / AVATAR_MIXER_BROADCAST_FRAMES_PER_SECOND };
+    auto lastFrameTimestamp = p_high_resolution_clock::now();
+    auto nextFrame = lastFrameTimestamp;
+    auto measureStart = lastFrameTimestamp;
+
+    for (int frame = 1; frame <= _numFrames; ++frame) {
+        bool measuring = frame > WARMUP_FRAMES;
+        if (frame == WARMUP_FRAMES + 1) {
+            measureStart = p_high_resolution_clock::now();
+            _inboundBytes = 0;
+            _sent.reset();
+            _pool.each([](AvatarMixerSlave& slave) {
+                AvatarMixerSlaveStats discarded;
+                slave.harvestStats(discarded);
+            });
+        }
+
+        for (auto& agent : _agents) {
+            sendFrame(agent, frame);
+        }
+
+        // mirror AvatarMixer::start
+        auto frameStart = p_high_resolution_clock::now();
+        nodeList->nestedEach([&](NodeList::const_iterator cbegin, NodeList::const_iterator cend) {
+            _pool.processIncomingPackets(cbegin, cend);
+        });
+
+        auto broadcastStart = p_high_resolution_clock::now();
+        nodeList->nestedEach([&](NodeList::const_iterator cbegin, NodeList::const_iterator cend) {
+            _pool.broadcastAvatarData(cbegin, cend, lastFrameTimestamp, _maxKbpsPerNode, _throttlingRatio);
+        });
+        auto frameEnd = p_high_resolution_clock::now();
+
+        QCoreApplication::processEvents();
+
+        _pool.each([&](AvatarMixerSlave& slave) {
+            AvatarMixerSlaveStats slaveStats;
+            slave.harvestStats(slaveStats);
+            if (measuring) {
+                _stats += slaveStats;
+            }
+        });
+
+        if (measuring) {
+            _frameTimes.push_back(duration_cast<microseconds>(frameEnd - frameStart).count());
+            _broadcastTimes.push_back(duration_cast<microseconds>(frameEnd - broadcastStart).count());
+        }
+
+        lastFrameTimestamp = frameStart;
+        if (!_freeRun) {
+            nextFrame += FRAME_DURATION;
+            std::this_thread::sleep_until(nextFrame);
+        }
+    }
+
+    auto elapsed = duration_cast<duration<double>>(p_high_resolution_clock::now() - measureStart);
+    report(_numFrames - WARMUP_FRAMES, elapsed.count());
+}
+
+void AvatarMixerBenchmark::report(int numFrames, double elapsedSeconds) {
+    std::sort(_frameTimes.begin(), _frameTimes.end());
+    std::sort(_broadcastTimes.begin(), _broadcastTimes.end());
+
+    float perFrame = 1.0f / numFrames;
+    float perReceiverFrame = _stats.nodesBroadcastedTo > 0 ? 1.0f / _stats.nodesBroadcastedTo : 0.0f;
+
+    qDebug().noquote() << QString("avatar-mixer benchmark: %1 agents, %2 joints, %3 threads, %4 kbps per node, %5 frames in %6s%7")
+        .arg(_numAgents).arg(_numJoints).arg(_pool.numThreads()).arg(_maxKbpsPerNode)
+        .arg(numFrames).arg(elapsedSeconds, 0, 'f', 2).arg(_freeRun ? " (free running)" : "");
+    qDebug().noquote() << QString("  frame us:          p50 %1  p95 %2  p99 %3  max %4 (budget %5)")
+        .arg(percentile(_frameTimes, 0.50f)).arg(percentile(_frameTimes, 0.95f))
+        .arg(percentile(_frameTimes, 0.99f)).arg(percentile(_frameTimes, 1.0f))
+        .arg(USECS_PER_SECOND / AVATAR_MIXER_BROADCAST_FRAMES_PER_SECOND);
+    qDebug().noquote() << QString("  broadcast us:      p50 %1  p95 %2  p99 %3  max %4")
+        .arg(percentile(_broadcastTimes, 0.50f)).arg(percentile(_broadcastTimes, 0.95f))
+        .arg(percentile(_broadcastTimes, 0.99f)).arg(percentile(_broadcastTimes, 1.0f));
+    qDebug().noquote() << QString("  slave us/frame:    toByteArray %1  ignore calculation %2  packing %3  sending %4  incoming %5")
+        .arg(_stats.toByteArrayElapsedTime * perFrame, 0, 'f', 1)
+        .arg(_stats.ignoreCalculationElapsedTime * perFrame, 0, 'f', 1)
+        .arg(_stats.avatarDataPackingElapsedTime * perFrame, 0, 'f', 1)
+        .arg(_stats.packetSendingElapsedTime * perFrame, 0, 'f', 1)
+        .arg(_stats.processIncomingPacketsElapsedTime * perFrame, 0, 'f', 1);
+    qDebug().noquote() << QString("  bytes/receiver:    data %1  traits %2  identity %3 per frame, %4 kbps")
+        .arg(_stats.numDataBytesSent * perReceiverFrame, 0, 'f', 0)
+        .arg(_stats.numTraitsBytesSent * perReceiverFrame, 0, 'f', 0)
+        .arg(_stats.numIdentityBytesSent * perReceiverFrame, 0, 'f', 0)
+        .arg((_stats.numDataBytesSent + _stats.numTraitsBytesSent + _stats.numIdentityBytesSent) * perReceiverFrame *
+             AVATAR_MIXER_BROADCAST_FRAMES_PER_SECOND / BYTES_PER_KILOBIT, 0, 'f', 1);
+    qDebug().noquote() << QString("  others/receiver:   included %1  over budget %2 per frame")
+        .arg(_stats.numOthersIncluded * perReceiverFrame, 0, 'f', 1)
+        .arg(_stats.overBudgetAvatars * perReceiverFrame, 0, 'f', 1);
+    qDebug().noquote() << QString("  sent:              %1 datagrams/s (%2 bulk avatar data), %3 kbps, inbound %4 kbps")
+        .arg(_sent.getDatagrams() / elapsedSeconds, 0, 'f', 0)
+        .arg(_sent.getDatagrams(PacketType::BulkAvatarData) / elapsedSeconds, 0, 'f', 0)
+        .arg(_sent.getBytes() / elapsedSeconds / BYTES_PER_KILOBIT, 0, 'f', 0)
+        .arg(_inboundBytes / elapsedSeconds / BYTES_PER_KILOBIT, 0, 'f', 0);
+
+    // sanity checks, so that a broken simulation does not report great numbers
+    QVERIFY(_stats.nodesBroadcastedTo == _numAgents * numFrames);
+    QVERIFY(_stats.numOthersIncluded > 0);
+    QVERIFY(_sent.getDatagrams(PacketType::BulkAvatarData) > 0);
+}
+
+}
+
+void AvatarMixerBenchmarkTests::initTestCase() {
+    DependencyManager::registerInheritance<LimitedNodeList, NodeList>();
+    DependencyManager::set<AccountManager>();
+    DependencyManager::set<AddressManager>();
+    DependencyManager::set<NodeList>(NodeType::AvatarMixer);
+}
+
+void AvatarMixerBenchmarkTests::cleanupTestCase() {
+    DependencyManager::destroy<NodeList>();
+    DependencyManager::destroy<AddressManager>();
+    DependencyManager::destroy<AccountManager>();
+}
+
+void AvatarMixerBenchmarkTests::benchmarkBroadcast() {
+    AvatarMixerBenchmark benchmark;
+    QVERIFY(benchmark.setup());
+    benchmark.run();
+}
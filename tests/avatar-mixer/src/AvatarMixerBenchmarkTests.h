@@ -0,0 +1,40 @@
+//
+//  AvatarMixerBenchmarkTests.h
+//  tests/avatar-mixer/src
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_AvatarMixerBenchmarkTests_h
+#define hifi_AvatarMixerBenchmarkTests_h
+
+#include <QtTest/QtTest>
+
+// Headless load simulator for the avatar-mixer.
+//
+// Populates the NodeList with agents backed by AvatarMixerClientData, and every frame feeds them avatar data
+// packets with moving joints, plus periodic identity, trait and view frustum changes. AvatarMixerSlavePool then
+// broadcasts at AVATAR_MIXER_BROADCAST_FRAMES_PER_SECOND, exactly like AvatarMixer::start, while the NodeList
+// socket hands every datagram to a counting sink instead of the network.
+//
+// The workload is configured from the environment:
+//   HIFI_AVATAR_MIXER_BENCH_AGENTS    number of agents (default 50)
+//   HIFI_AVATAR_MIXER_BENCH_SECONDS   simulated seconds (default 5)
+//   HIFI_AVATAR_MIXER_BENCH_THREADS   slave threads (default QThread::idealThreadCount())
+//   HIFI_AVATAR_MIXER_BENCH_JOINTS    joints per avatar (default 60)
+//   HIFI_AVATAR_MIXER_BENCH_MAX_KBPS  per node send budget (default 5000, the domain default)
+//   HIFI_AVATAR_MIXER_BENCH_THROTTLE  throttling ratio, as computed by AvatarMixer::throttle (default 0)
+//   HIFI_AVATAR_MIXER_BENCH_FREE_RUN  set to 1 to broadcast back to back instead of pacing the frames
+class AvatarMixerBenchmarkTests : public QObject {
+    Q_OBJECT
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+
+    void benchmarkBroadcast();
+};
+
+#endif // hifi_AvatarMixerBenchmarkTests_h
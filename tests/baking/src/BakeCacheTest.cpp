@@ -0,0 +1,134 @@
+//
+//  BakeCacheTest.cpp
+//  tests/baking/src
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "BakeCacheTest.h"
+
+#include <BakeCache.h>
+
+QTEST_MAIN(BakeCacheTest)
+
+const QString BAKER_VERSION = "0.1";
+
+// lays out a bake the way DomainBaker does, returning its baked folder holding the model and a texture
+QString BakeCacheTest::writeBakedModel(const QString& name, const QByteArray& content) {
+    QDir bakeDir { _dir->filePath("bakes/" + name) };
+    bakeDir.mkpath("baked");
+
+    QFile model { bakeDir.filePath("baked/" + name + ".baked.fbx") };
+    model.open(QIODevice::WriteOnly);
+    model.write(content);
+
+    QFile texture { bakeDir.filePath("baked/" + name + ".texmeta.json") };
+    texture.open(QIODevice::WriteOnly);
+    texture.write(name.toUtf8());
+
+    return bakeDir.absoluteFilePath("baked");
+}
+
+void BakeCacheTest::init() {
+    _dir.reset(new QTemporaryDir());
+    QVERIFY(_dir->isValid());
+}
+
+void BakeCacheTest::keyChangesWithInputs() {
+    QJsonObject options;
+    options["type"] = "fbx";
+
+    auto key = BakeCache::computeKey("model", BAKER_VERSION, options);
+    QCOMPARE(BakeCache::computeKey("model", BAKER_VERSION, options), key);
+
+    QVERIFY(BakeCache::computeKey("model2", BAKER_VERSION, options) != key);
+    QVERIFY(BakeCache::computeKey("model", "0.2", options) != key);
+
+    QJsonObject otherOptions;
+    otherOptions["type"] = "obj";
+    QVERIFY(BakeCache::computeKey("model", BAKER_VERSION, otherOptions) != key);
+}
+
+void BakeCacheTest::insertAndRestore() {
+    BakeCache cache { _dir->filePath("cache") };
+
+    auto bakeDir = writeBakedModel("chair", "baked chair");
+    QHash<QUrl, QByteArray> dependencies;
+    dependencies[QUrl("http://example.com/chair.png")] = BakeCache::hashDependency("texture");
+
+    auto key = BakeCache::computeKey("chair", BAKER_VERSION, QJsonObject());
+    QVERIFY(cache.insert(key, bakeDir, bakeDir + "/chair.baked.fbx", dependencies));
+    QVERIFY(cache.contains(key));
+    QCOMPARE(cache.getDependencies(key), dependencies);
+
+    QDir outputDir { _dir->filePath("output") };
+    auto bakedModelFilePath = cache.restore(key, outputDir.absolutePath());
+    QCOMPARE(bakedModelFilePath, outputDir.filePath("chair.baked.fbx"));
+
+    QFile restored { bakedModelFilePath };
+    QVERIFY(restored.open(QIODevice::ReadOnly));
+    QCOMPARE(restored.readAll(), QByteArray("baked chair"));
+    QVERIFY(QFile::exists(outputDir.filePath("chair.texmeta.json")));
+
+    QVERIFY(cache.restore("missing", outputDir.absolutePath()).isEmpty());
+}
+
+void BakeCacheTest::persistsAcrossRuns() {
+    auto key = BakeCache::computeKey("table", BAKER_VERSION, QJsonObject());
+    QHash<QUrl, QByteArray> dependencies;
+    dependencies[QUrl("file:///textures/table.jpg")] = BakeCache::hashDependency("wood");
+    {
+        BakeCache cache { _dir->filePath("cache") };
+        auto bakeDir = writeBakedModel("table", "baked table");
+        QVERIFY(cache.insert(key, bakeDir, bakeDir + "/table.baked.fbx", dependencies));
+    }
+
+    BakeCache cache { _dir->filePath("cache") };
+    QVERIFY(cache.contains(key));
+    QCOMPARE(cache.getEntryCount(), 1);
+    QCOMPARE(cache.getDependencies(key), dependencies);
+    QVERIFY(!cache.restore(key, _dir->filePath("output")).isEmpty());
+
+    // entries whose files went missing are dropped
+    QVERIFY(QDir(_dir->filePath("cache/entries/" + key)).removeRecursively());
+    QVERIFY(!BakeCache(_dir->filePath("cache")).contains(key));
+}
+
+void BakeCacheTest::evictsLeastRecentlyUsed() {
+    BakeCache cache { _dir->filePath("cache") };
+
+    QStringList keys;
+    for (auto name : { "a", "b", "c" }) {
+        auto bakeDir = writeBakedModel(name, QByteArray(100, 'x'));
+        auto key = BakeCache::computeKey(name, BAKER_VERSION, QJsonObject());
+        QVERIFY(cache.insert(key, bakeDir, bakeDir + "/" + name + ".baked.fbx", {}));
+        keys << key;
+    }
+    auto entrySize = cache.getSize() / 3;
+
+    // use the first entry, so that the second is now the least recently used
+    QVERIFY(!cache.restore(keys[0], _dir->filePath("output")).isEmpty());
+
+    cache.setSizeLimit(entrySize * 2);
+    QVERIFY(cache.contains(keys[0]));
+    QVERIFY(!cache.contains(keys[1]));
+    QVERIFY(cache.contains(keys[2]));
+    QVERIFY(cache.getSize() <= cache.getSizeLimit());
+
+    // the order of use is kept across runs
+    BakeCache smallerCache { _dir->filePath("cache"), entrySize };
+    QCOMPARE(smallerCache.getEntryCount(), 1);
+    QVERIFY(smallerCache.contains(keys[0]));
+}
+
+void BakeCacheTest::disabledWithoutSizeLimit() {
+    BakeCache cache { _dir->filePath("cache"), 0 };
+
+    auto bakeDir = writeBakedModel("lamp", "baked lamp");
+    auto key = BakeCache::computeKey("lamp", BAKER_VERSION, QJsonObject());
+    QVERIFY(!cache.insert(key, bakeDir, bakeDir + "/lamp.baked.fbx", {}));
+    QVERIFY(!cache.contains(key));
+}
@@ -0,0 +1,37 @@
+//
+//  BakeCacheTest.h
+//  tests/baking/src
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_BakeCacheTest_h
+#define hifi_BakeCacheTest_h
+
+#include <memory>
+
+#include <QtTest/QtTest>
+#include <QtCore/QTemporaryDir>
+
+class BakeCacheTest : public QObject {
+    Q_OBJECT
+
+private:
+    QString writeBakedModel(const QString& name, const QByteArray& content);
+
+private slots:
+    void init();
+    void keyChangesWithInputs();
+    void insertAndRestore();
+    void persistsAcrossRuns();
+    void evictsLeastRecentlyUsed();
+    void disabledWithoutSizeLimit();
+
+private:
+    std::unique_ptr<QTemporaryDir> _dir;
+};
+
+#endif // hifi_BakeCacheTest_h
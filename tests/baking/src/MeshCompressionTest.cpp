@@ -0,0 +1,114 @@
+//
+//  MeshCompressionTest.cpp
+//  tests/baking/src
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "MeshCompressionTest.h"
+
+#include <QtConcurrent>
+
+#include <ModelBaker.h>
+
+QTEST_MAIN(MeshCompressionTest)
+
+const int NUM_MESHES = 16;
+const int GRID_SIZE = 60;
+
+// a grid of two triangles per cell with a different height field per seed, split in two parts
+hfm::Mesh makeMesh(int seed) {
+    hfm::Mesh mesh;
+    for (int y = 0; y < GRID_SIZE; y++) {
+        for (int x = 0; x < GRID_SIZE; x++) {
+            float height = sinf((float)(x * seed) * 0.1f) * cosf((float)y * 0.1f);
+            mesh.vertices << glm::vec3(x, y, height);
+            mesh.normals << glm::normalize(glm::vec3(height, 0.5f, 1.0f));
+            mesh.texCoords << glm::vec2((float)x / GRID_SIZE, (float)y / GRID_SIZE);
+        }
+    }
+
+    hfm::MeshPart parts[2];
+    for (int y = 0; y < GRID_SIZE - 1; y++) {
+        for (int x = 0; x < GRID_SIZE - 1; x++) {
+            int index = y * GRID_SIZE + x;
+            parts[x % 2].triangleIndices << index << index + 1 << index + GRID_SIZE + 1
+                                         << index + GRID_SIZE + 1 << index + GRID_SIZE << index;
+        }
+    }
+    mesh.parts << parts[0] << parts[1];
+    return mesh;
+}
+
+QByteArray getDracoData(const ModelBaker::CompressedMesh& compressedMesh) {
+    return compressedMesh.dracoMeshNode.properties.value(0).toByteArray();
+}
+
+std::vector<ModelBaker::CompressedMesh> compressInParallel(const std::vector<hfm::Mesh>& meshes) {
+    std::vector<QFuture<ModelBaker::CompressedMesh>> futures;
+    for (const auto& mesh : meshes) {
+        futures.push_back(QtConcurrent::run(&ModelBaker::getMeshCompressionPool(), [&mesh] {
+            return ModelBaker::encodeMesh(mesh, false);
+        }));
+    }
+
+    std::vector<ModelBaker::CompressedMesh> compressedMeshes;
+    for (auto& future : futures) {
+        compressedMeshes.push_back(future.result());
+    }
+    return compressedMeshes;
+}
+
+void MeshCompressionTest::parallelMatchesSequential() {
+    std::vector<hfm::Mesh> meshes;
+    for (int i = 0; i < NUM_MESHES; i++) {
+        meshes.push_back(makeMesh(i + 1));
+    }
+
+    auto compressedMeshes = compressInParallel(meshes);
+    QCOMPARE((int)compressedMeshes.size(), NUM_MESHES);
+
+    for (int i = 0; i < NUM_MESHES; i++) {
+        auto sequential = ModelBaker::encodeMesh(meshes[i], false);
+        QVERIFY(sequential.success);
+        QVERIFY(compressedMeshes[i].success);
+        QCOMPARE(compressedMeshes[i].dracoMeshNode.name, QByteArray("DracoMesh"));
+        QCOMPARE(getDracoData(compressedMeshes[i]), getDracoData(sequential));
+    }
+}
+
+void MeshCompressionTest::reportsInvalidMeshes() {
+    auto compressed = makeMesh(1);
+    compressed.wasCompressed = true;
+    auto result = ModelBaker::encodeMesh(compressed, false);
+    QVERIFY(!result.success);
+    QVERIFY(!result.error.isEmpty());
+
+    auto invalid = makeMesh(1);
+    invalid.parts.removeLast();
+    invalid.parts[0].triangleIndices.removeLast();
+    result = ModelBaker::encodeMesh(invalid, false);
+    QVERIFY(!result.success);
+    QVERIFY(result.error.isEmpty());
+    QCOMPARE(result.warnings.size(), 1);
+
+    hfm::Mesh empty;
+    result = ModelBaker::encodeMesh(empty, false);
+    QVERIFY(!result.success);
+    QVERIFY(result.error.isEmpty());
+    QVERIFY(result.warnings.isEmpty());
+}
+
+void MeshCompressionTest::benchmarkParallelCompression() {
+    std::vector<hfm::Mesh> meshes;
+    for (int i = 0; i < NUM_MESHES; i++) {
+        meshes.push_back(makeMesh(i + 1));
+    }
+
+    QBENCHMARK {
+        compressInParallel(meshes);
+    }
+}
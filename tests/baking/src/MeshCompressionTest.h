@@ -0,0 +1,25 @@
+//
+//  MeshCompressionTest.h
+//  tests/baking/src
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_MeshCompressionTest_h
+#define hifi_MeshCompressionTest_h
+
+#include <QtTest/QtTest>
+
+class MeshCompressionTest : public QObject {
+    Q_OBJECT
+
+private slots:
+    void parallelMatchesSequential();
+    void reportsInvalidMeshes();
+    void benchmarkParallelCompression();
+};
+
+#endif // hifi_MeshCompressionTest_h
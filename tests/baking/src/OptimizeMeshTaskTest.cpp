@@ -0,0 +1,256 @@
+//
+//  OptimizeMeshTaskTest.cpp
+//  tests/baking/src
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "OptimizeMeshTaskTest.h"
+
+#include <algorithm>
+#include <array>
+#include <numeric>
+#include <random>
+
+#include <model-baker/Baker.h>
+#include <model-baker/OptimizeMeshTask.h>
+
+QTEST_MAIN(OptimizeMeshTaskTest)
+
+const int GRID_SIZE = 100;
+const int BENCHMARK_GRID_SIZE = 300;
+const int CACHE_SIZE = 16;
+const int CLUSTERS_PER_VERTEX = 4;
+
+// A grid of vertices whose cells are drawn in a random order, as quads or as pairs of triangles. Each vertex's
+// attributes are derived from its grid position so that they can be checked after the vertices are reordered.
+hfm::Mesh makeGrid(int size, bool quads) {
+    std::mt19937 random(size);
+    int numVertices = size * size;
+    std::vector<int> vertexOrder(numVertices);
+    std::iota(vertexOrder.begin(), vertexOrder.end(), 0);
+    std::shuffle(vertexOrder.begin(), vertexOrder.end(), random);
+
+    hfm::Mesh mesh;
+    mesh.vertices.resize(numVertices);
+    mesh.normals.resize(numVertices);
+    mesh.texCoords.resize(numVertices);
+    mesh.originalIndices.resize(numVertices);
+    mesh.clusterIndices.resize(numVertices * CLUSTERS_PER_VERTEX);
+    mesh.clusterWeights.resize(numVertices * CLUSTERS_PER_VERTEX);
+    for (int y = 0; y < size; y++) {
+        for (int x = 0; x < size; x++) {
+            int vertex = vertexOrder[y * size + x];
+            mesh.vertices[vertex] = glm::vec3(x, y, 0.0f);
+            mesh.normals[vertex] = glm::vec3(0.0f, 0.0f, 1.0f);
+            mesh.texCoords[vertex] = glm::vec2((float)x / size, (float)y / size);
+            mesh.originalIndices[vertex] = y * size + x;
+            for (int i = 0; i < CLUSTERS_PER_VERTEX; i++) {
+                mesh.clusterIndices[vertex * CLUSTERS_PER_VERTEX + i] = (uint16_t)(x + i);
+                mesh.clusterWeights[vertex * CLUSTERS_PER_VERTEX + i] = (uint16_t)(y + i);
+            }
+        }
+    }
+
+    std::vector<std::array<int, 4>> cells;
+    for (int y = 0; y < size - 1; y++) {
+        for (int x = 0; x < size - 1; x++) {
+            cells.push_back({ { vertexOrder[y * size + x], vertexOrder[y * size + x + 1],
+                vertexOrder[(y + 1) * size + x + 1], vertexOrder[(y + 1) * size + x] } });
+        }
+    }
+    std::shuffle(cells.begin(), cells.end(), random);
+
+    hfm::MeshPart part;
+    for (const auto& cell : cells) {
+        if (quads) {
+            part.quadIndices << cell[0] << cell[1] << cell[2] << cell[3];
+            part.quadTrianglesIndices << cell[0] << cell[1] << cell[3] << cell[1] << cell[2] << cell[3];
+        } else {
+            part.triangleIndices << cell[0] << cell[1] << cell[2] << cell[2] << cell[3] << cell[0];
+        }
+    }
+    mesh.parts.append(part);
+    return mesh;
+}
+
+// the drawn triangles by vertex position, each starting from its smallest vertex so that the winding is kept
+std::vector<std::array<float, 6>> getTriangles(const hfm::Mesh& mesh) {
+    std::vector<std::array<float, 6>> triangles;
+    for (const auto& part : mesh.parts) {
+        QVector<int> indices = part.quadTrianglesIndices + part.triangleIndices;
+        for (int i = 0; i < indices.size(); i += 3) {
+            std::array<float, 6> triangle;
+            for (int j = 0; j < 3; j++) {
+                const auto& vertex = mesh.vertices[indices[i + j]];
+                triangle[j * 2] = vertex.x;
+                triangle[j * 2 + 1] = vertex.y;
+            }
+            while (std::make_pair(triangle[0], triangle[1]) > std::min(std::make_pair(triangle[2], triangle[3]), std::make_pair(triangle[4], triangle[5]))) {
+                std::rotate(triangle.begin(), triangle.begin() + 2, triangle.end());
+            }
+            triangles.push_back(triangle);
+        }
+    }
+    std::sort(triangles.begin(), triangles.end());
+    return triangles;
+}
+
+void verifyVertexAttributes(const hfm::Mesh& mesh, int size) {
+    for (int i = 0; i < mesh.vertices.size(); i++) {
+        int x = (int)mesh.vertices[i].x;
+        int y = (int)mesh.vertices[i].y;
+        QCOMPARE(mesh.texCoords[i], glm::vec2((float)x / size, (float)y / size));
+        QCOMPARE(mesh.originalIndices[i], y * size + x);
+        for (int j = 0; j < CLUSTERS_PER_VERTEX; j++) {
+            QCOMPARE(mesh.clusterIndices[i * CLUSTERS_PER_VERTEX + j], (uint16_t)(x + j));
+            QCOMPARE(mesh.clusterWeights[i * CLUSTERS_PER_VERTEX + j], (uint16_t)(y + j));
+        }
+    }
+}
+
+void OptimizeMeshTaskTest::reorderImprovesVertexCache() {
+    hfm::Mesh mesh = makeGrid(GRID_SIZE, false);
+    baker::Blendshapes blendshapes;
+    auto before = OptimizeMeshTask::measureVertexCache(mesh, CACHE_SIZE);
+    QCOMPARE(OptimizeMeshTask::optimizeMesh(mesh, blendshapes, OptimizeMeshTask::Options()), 0);
+    auto after = OptimizeMeshTask::measureVertexCache(mesh, CACHE_SIZE);
+
+    QCOMPARE(after.numTriangles, before.numTriangles);
+    QCOMPARE(after.numVertices, before.numVertices);
+    // the random order misses almost every time, the optimized one gets close to the 0.5 a grid could reach
+    QVERIFY(before.getACMR() > 1.9f);
+    QVERIFY(after.getACMR() < 0.75f);
+    QVERIFY(after.getATVR() < 1.5f);
+
+    // the vertices are numbered in the order they're first drawn
+    int nextVertex = 0;
+    for (int index : mesh.parts[0].triangleIndices) {
+        QVERIFY(index <= nextVertex);
+        if (index == nextVertex) {
+            nextVertex++;
+        }
+    }
+    QCOMPARE(nextVertex, mesh.vertices.size());
+}
+
+void OptimizeMeshTaskTest::reorderKeepsTriangles() {
+    hfm::Mesh mesh = makeGrid(GRID_SIZE, false);
+    auto triangles = getTriangles(mesh);
+
+    baker::Blendshapes blendshapes(1);
+    auto& blendshape = blendshapes[0];
+    for (int i = 0; i < mesh.vertices.size(); i += 7) {
+        blendshape.indices << i;
+        blendshape.vertices << mesh.vertices[i];
+    }
+
+    OptimizeMeshTask::optimizeMesh(mesh, blendshapes, OptimizeMeshTask::Options());
+    QVERIFY(getTriangles(mesh) == triangles);
+    verifyVertexAttributes(mesh, GRID_SIZE);
+    for (int i = 0; i < blendshape.indices.size(); i++) {
+        QCOMPARE(mesh.vertices[blendshape.indices[i]], blendshape.vertices[i]);
+    }
+}
+
+void OptimizeMeshTaskTest::reorderKeepsQuads() {
+    hfm::Mesh mesh = makeGrid(GRID_SIZE, true);
+    auto triangles = getTriangles(mesh);
+    baker::Blendshapes blendshapes;
+    auto before = OptimizeMeshTask::measureVertexCache(mesh, CACHE_SIZE);
+    OptimizeMeshTask::optimizeMesh(mesh, blendshapes, OptimizeMeshTask::Options());
+    auto after = OptimizeMeshTask::measureVertexCache(mesh, CACHE_SIZE);
+
+    QVERIFY(after.getACMR() < 0.75f);
+    QVERIFY(after.getACMR() < before.getACMR());
+    QVERIFY(getTriangles(mesh) == triangles);
+    verifyVertexAttributes(mesh, GRID_SIZE);
+
+    // each quad is still followed by its own triangles
+    const auto& part = mesh.parts[0];
+    for (int i = 0; i < part.quadIndices.size() / 4; i++) {
+        const int* quad = part.quadIndices.constData() + i * 4;
+        const int* quadTriangles = part.quadTrianglesIndices.constData() + i * 6;
+        QCOMPARE(QVector<int>({ quadTriangles[0], quadTriangles[1], quadTriangles[2], quadTriangles[3], quadTriangles[4], quadTriangles[5] }),
+            QVector<int>({ quad[0], quad[1], quad[3], quad[1], quad[2], quad[3] }));
+    }
+}
+
+void OptimizeMeshTaskTest::meshletsStayWithinLimits() {
+    const int MAX_MESHLET_VERTICES = 64;
+    const int MAX_MESHLET_TRIANGLES = 126;
+    hfm::Mesh mesh = makeGrid(GRID_SIZE, false);
+    auto triangles = getTriangles(mesh);
+    baker::Blendshapes blendshapes;
+    OptimizeMeshTask::Options options;
+    options.maxMeshletVertices = MAX_MESHLET_VERTICES;
+    options.maxMeshletTriangles = MAX_MESHLET_TRIANGLES;
+    int numMeshlets = OptimizeMeshTask::optimizeMesh(mesh, blendshapes, options);
+    auto after = OptimizeMeshTask::measureVertexCache(mesh, CACHE_SIZE);
+
+    QVERIFY(getTriangles(mesh) == triangles);
+    QVERIFY(after.getACMR() < 0.8f);
+    QVERIFY(numMeshlets >= after.numTriangles / MAX_MESHLET_TRIANGLES);
+
+    // splitting the drawn triangles wherever the next one wouldn't fit can't give more meshlets than were built
+    const auto& indices = mesh.parts[0].triangleIndices;
+    int numSplitMeshlets = 0;
+    int meshletTriangles = MAX_MESHLET_TRIANGLES;
+    QSet<int> meshletVertices;
+    for (int i = 0; i < indices.size(); i += 3) {
+        QSet<int> vertices = meshletVertices;
+        vertices << indices[i] << indices[i + 1] << indices[i + 2];
+        if (meshletTriangles == MAX_MESHLET_TRIANGLES || vertices.size() > MAX_MESHLET_VERTICES) {
+            numSplitMeshlets++;
+            meshletTriangles = 0;
+            vertices = QSet<int>() << indices[i] << indices[i + 1] << indices[i + 2];
+        }
+        meshletVertices = vertices;
+        meshletTriangles++;
+    }
+    QVERIFY(numSplitMeshlets <= numMeshlets);
+}
+
+void OptimizeMeshTaskTest::bakerReportsStats() {
+    auto hfmModel = std::make_shared<hfm::Model>();
+    hfmModel->meshes.append(makeGrid(GRID_SIZE, false));
+    hfmModel->meshes.append(makeGrid(GRID_SIZE / 2, true));
+    auto triangles = getTriangles(hfmModel->meshes[0]);
+
+    baker::Baker baker(hfmModel, QVariantHash());
+    auto config = baker.getConfiguration()->getConfig<OptimizeMeshTask>("OptimizeMesh");
+    QVERIFY(config);
+    baker.run();
+
+    QVERIFY(config->getACMRBefore() > 1.9f);
+    QVERIFY(config->getACMRAfter() < 0.75f);
+    QVERIFY(config->getATVRAfter() < config->getATVRBefore());
+    QCOMPARE(config->getNumMeshlets(), 0);
+    QCOMPARE(config->getStatsAfter().numTriangles, config->getStatsBefore().numTriangles);
+    QVERIFY(getTriangles(baker.hfmModel->meshes[0]) == triangles);
+    verifyVertexAttributes(baker.hfmModel->meshes[0], GRID_SIZE);
+
+    // turning the reordering off leaves the stats as they were
+    auto unoptimizedModel = std::make_shared<hfm::Model>();
+    unoptimizedModel->meshes.append(makeGrid(GRID_SIZE, false));
+    QVector<int> triangleIndices = unoptimizedModel->meshes[0].parts[0].triangleIndices;
+    baker::Baker unoptimizedBaker(unoptimizedModel, QVariantHash());
+    auto unoptimizedConfig = unoptimizedBaker.getConfiguration()->getConfig<OptimizeMeshTask>("OptimizeMesh");
+    unoptimizedConfig->setProperty("reorderTriangles", false);
+    unoptimizedConfig->setProperty("reorderVertices", false);
+    unoptimizedBaker.run();
+    QCOMPARE(unoptimizedConfig->getACMRAfter(), unoptimizedConfig->getACMRBefore());
+    QCOMPARE(unoptimizedBaker.hfmModel->meshes[0].parts[0].triangleIndices, triangleIndices);
+}
+
+void OptimizeMeshTaskTest::benchmarkOptimizeMesh() {
+    hfm::Mesh grid = makeGrid(BENCHMARK_GRID_SIZE, false);
+    QBENCHMARK {
+        hfm::Mesh mesh = grid;
+        baker::Blendshapes blendshapes;
+        OptimizeMeshTask::optimizeMesh(mesh, blendshapes, OptimizeMeshTask::Options());
+    }
+}
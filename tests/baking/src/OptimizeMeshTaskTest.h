@@ -0,0 +1,28 @@
+//
+//  OptimizeMeshTaskTest.h
+//  tests/baking/src
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_OptimizeMeshTaskTest_h
+#define hifi_OptimizeMeshTaskTest_h
+
+#include <QtTest/QtTest>
+
+class OptimizeMeshTaskTest : public QObject {
+    Q_OBJECT
+
+private slots:
+    void reorderImprovesVertexCache();
+    void reorderKeepsTriangles();
+    void reorderKeepsQuads();
+    void meshletsStayWithinLimits();
+    void bakerReportsStats();
+    void benchmarkOptimizeMesh();
+};
+
+#endif // hifi_OptimizeMeshTaskTest_h
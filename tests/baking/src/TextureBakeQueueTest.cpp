@@ -0,0 +1,189 @@
+//
+//  TextureBakeQueueTest.cpp
+//  tests/baking/src
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "TextureBakeQueueTest.h"
+
+#include <TextureBakeQueue.h>
+#include <TextureBaker.h>
+
+QTEST_MAIN(TextureBakeQueueTest)
+
+namespace {
+
+QUrl textureURL(const QString& name) {
+    return QUrl("http://example.com/" + name + ".png");
+}
+
+// only records that the queue started it, the test finishes or aborts it
+class StubTextureBaker : public TextureBaker {
+public:
+    StubTextureBaker(const QString& name, QStringList& started) :
+        TextureBaker(textureURL(name), image::TextureUsage::DEFAULT_TEXTURE, QDir()),
+        _name(name),
+        _started(started) {}
+
+    void bake() override { _started.push_back(_name); }
+
+private:
+    QString _name;
+    QStringList& _started;
+};
+
+}
+
+// the bakes stay on this thread, so that they start when the test processes events
+QSharedPointer<TextureBaker> TextureBakeQueueTest::push(const QString& name, qint64 estimatedMemory) {
+    QSharedPointer<TextureBaker> baker { new StubTextureBaker(name, _started) };
+    TextureBakeQueue::getInstance().push(baker, QThread::currentThread(), estimatedMemory);
+    return baker;
+}
+
+QStringList TextureBakeQueueTest::takeStarted() {
+    QCoreApplication::processEvents();
+    QStringList started = _started;
+    _started.clear();
+    return started;
+}
+
+void TextureBakeQueueTest::initTestCase() {
+    _memoryBudget = TextureBakeQueue::getInstance().getMemoryBudget();
+}
+
+void TextureBakeQueueTest::cleanup() {
+    auto& queue = TextureBakeQueue::getInstance();
+    queue.setMemoryBudget(_memoryBudget);
+    QCOMPARE(queue.getMemoryInUse(), 0LL);
+    QCOMPARE(queue.getPendingCount(), 0);
+    _started.clear();
+}
+
+void TextureBakeQueueTest::startsMostReferencedFirst() {
+    auto& queue = TextureBakeQueue::getInstance();
+    queue.setMemoryBudget(100);
+
+    // keeps the others waiting until they are all queued
+    auto blocker = push("blocker", 100);
+    QCOMPARE(takeStarted(), QStringList({ "blocker" }));
+
+    queue.addReference(textureURL("once"));
+    for (int i = 0; i < 3; i++) {
+        queue.addReference(textureURL("thrice"));
+    }
+    for (int i = 0; i < 2; i++) {
+        queue.addReference(textureURL("twice"));
+    }
+    auto once = push("once", 100);
+    auto thrice = push("thrice", 100);
+    auto twice = push("twice", 100);
+    auto unreferenced = push("unreferenced", 100);
+    QCOMPARE(queue.getPendingCount(), 4);
+
+    blocker->setIsFinished(true);
+    QCOMPARE(takeStarted(), QStringList({ "thrice" }));
+    thrice->setIsFinished(true);
+    QCOMPARE(takeStarted(), QStringList({ "twice" }));
+    twice->setIsFinished(true);
+    QCOMPARE(takeStarted(), QStringList({ "once" }));
+    once->setIsFinished(true);
+    QCOMPARE(takeStarted(), QStringList({ "unreferenced" }));
+    unreferenced->setIsFinished(true);
+
+    queue.removeReferences(textureURL("once"), 1);
+    queue.removeReferences(textureURL("thrice"), 3);
+    queue.removeReferences(textureURL("twice"), 2);
+    QCOMPARE(queue.getReferenceCount(textureURL("once")), 0);
+    QCOMPARE(queue.getReferenceCount(textureURL("thrice")), 0);
+    QCOMPARE(queue.getReferenceCount(textureURL("twice")), 0);
+}
+
+void TextureBakeQueueTest::waitsForMemory() {
+    auto& queue = TextureBakeQueue::getInstance();
+    queue.setMemoryBudget(100);
+
+    auto first = push("first", 40);
+    auto second = push("second", 40);
+    auto third = push("third", 40);
+    QCOMPARE(takeStarted(), QStringList({ "first", "second" }));
+    QCOMPARE(queue.getMemoryInUse(), 80LL);
+    QCOMPARE(queue.getPendingCount(), 1);
+
+    // an aborted bake frees its memory the same as a finished one
+    first->setWasAborted(true);
+    QCOMPARE(takeStarted(), QStringList({ "third" }));
+    QCOMPARE(queue.getMemoryInUse(), 80LL);
+    QCOMPARE(queue.getPendingCount(), 0);
+
+    // counted once, even if it finishes after aborting
+    first->setIsFinished(true);
+    QCOMPARE(queue.getMemoryInUse(), 80LL);
+
+    second->setIsFinished(true);
+    third->setIsFinished(true);
+    QCOMPARE(queue.getMemoryInUse(), 0LL);
+}
+
+void TextureBakeQueueTest::letsOneBakeRun() {
+    auto& queue = TextureBakeQueue::getInstance();
+    queue.setMemoryBudget(100);
+
+    auto huge = push("huge", 500);
+    auto small = push("small", 10);
+    QCOMPARE(takeStarted(), QStringList({ "huge" }));
+    QCOMPARE(queue.getMemoryInUse(), 500LL);
+    QCOMPARE(queue.getPendingCount(), 1);
+
+    huge->setIsFinished(true);
+    QCOMPARE(takeStarted(), QStringList({ "small" }));
+    QCOMPARE(queue.getMemoryInUse(), 10LL);
+
+    small->setIsFinished(true);
+}
+
+void TextureBakeQueueTest::dropsDeletedBaker() {
+    auto& queue = TextureBakeQueue::getInstance();
+    queue.setMemoryBudget(100);
+
+    auto running = push("running", 100);
+    auto deleted = push("deleted", 10);
+    auto kept = push("kept", 10);
+    QCOMPARE(takeStarted(), QStringList({ "running" }));
+    QCOMPARE(queue.getPendingCount(), 2);
+
+    // like a model baker letting go of its textures when it is aborted
+    deleted.reset();
+    QCOMPARE(queue.getMemoryInUse(), 100LL);
+
+    running->setIsFinished(true);
+    QCOMPARE(takeStarted(), QStringList({ "kept" }));
+    QCOMPARE(queue.getMemoryInUse(), 10LL);
+    QCOMPARE(queue.getPendingCount(), 0);
+
+    kept->setIsFinished(true);
+}
+
+void TextureBakeQueueTest::removesReferences() {
+    auto& queue = TextureBakeQueue::getInstance();
+    auto url = textureURL("shared");
+
+    queue.addReference(url);
+    queue.addReference(url);
+    queue.addReference(url);
+    QCOMPARE(queue.getReferenceCount(url), 3);
+
+    queue.removeReferences(url, 2);
+    QCOMPARE(queue.getReferenceCount(url), 1);
+
+    // a model baker that gives up may remove more than are left
+    queue.removeReferences(url, 2);
+    QCOMPARE(queue.getReferenceCount(url), 0);
+
+    queue.removeReferences(textureURL("unknown"), 1);
+    QCOMPARE(queue.getReferenceCount(textureURL("unknown")), 0);
+}
@@ -0,0 +1,40 @@
+//
+//  TextureBakeQueueTest.h
+//  tests/baking/src
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_TextureBakeQueueTest_h
+#define hifi_TextureBakeQueueTest_h
+
+#include <QtTest/QtTest>
+#include <QtCore/QSharedPointer>
+
+class TextureBaker;
+
+class TextureBakeQueueTest : public QObject {
+    Q_OBJECT
+
+private:
+    QSharedPointer<TextureBaker> push(const QString& name, qint64 estimatedMemory);
+    QStringList takeStarted();
+
+private slots:
+    void initTestCase();
+    void cleanup();
+    void startsMostReferencedFirst();
+    void waitsForMemory();
+    void letsOneBakeRun();
+    void dropsDeletedBaker();
+    void removesReferences();
+
+private:
+    qint64 _memoryBudget { 0 };
+    QStringList _started;
+};
+
+#endif // hifi_TextureBakeQueueTest_h
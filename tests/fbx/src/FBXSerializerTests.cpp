@@ -0,0 +1,214 @@
+//
+//  FBXSerializerTests.cpp
+//  tests/fbx/src
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "FBXSerializerTests.h"
+
+#include <QtCore/QBuffer>
+#include <QtCore/QTemporaryFile>
+
+#include <FBXSerializer.h>
+#include <FBXWriter.h>
+
+QTEST_MAIN(FBXSerializerTests)
+
+// big enough for the FBXWriter to compress
+const int LARGE_MESH_VERTICES = 3000;
+const int SMALL_MESH_VERTICES = 12;
+
+const int AVATAR_MESHES = 8;
+const int AVATAR_MESH_VERTICES = 8192;
+const int SCENE_MESHES = 48;
+const int SCENE_MESH_VERTICES = 8192;
+
+FBXNode makeNode(const QByteArray& name, const QVariantList& properties, const FBXNodeList& children = FBXNodeList()) {
+    FBXNode node;
+    node.name = name;
+    node.properties = properties;
+    node.children = children;
+    return node;
+}
+
+// a mesh of separate triangles, with normals by polygon vertex and indexed texture coordinates
+FBXNode makeGeometry(qint64 id, int numVertices) {
+    int numTriangles = numVertices / 3;
+    QVector<double> vertices;
+    QVector<double> normals;
+    QVector<double> texCoords;
+    QVector<qint32> polygonIndices;
+    for (int i = 0; i < numVertices; i++) {
+        vertices << sin(i * 0.37) * 10.0 << cos(i * 0.11) * 10.0 << (i % 97) * 0.25;
+        texCoords << (i % 64) / 64.0 << (i % 32) / 32.0;
+    }
+    for (int i = 0; i < numTriangles * 3; i++) {
+        normals << 0.0 << sin(i * 0.5) << cos(i * 0.5);
+        // the last index of each polygon is stored as its complement
+        polygonIndices << ((i % 3 == 2) ? ~i : i);
+    }
+
+    return makeNode("Geometry", { id, QByteArray("Geometry::mesh") + QByteArray::number(id), QByteArray("Mesh") }, {
+        makeNode("Vertices", { QVariant::fromValue(vertices) }),
+        makeNode("PolygonVertexIndex", { QVariant::fromValue(polygonIndices) }),
+        makeNode("LayerElementNormal", { 0 }, {
+            makeNode("MappingInformationType", { QByteArray("ByPolygonVertex") }),
+            makeNode("ReferenceInformationType", { QByteArray("Direct") }),
+            makeNode("Normals", { QVariant::fromValue(normals) })
+        }),
+        makeNode("LayerElementUV", { 0 }, {
+            makeNode("Name", { QByteArray("map1") }),
+            makeNode("MappingInformationType", { QByteArray("ByPolygonVertex") }),
+            makeNode("ReferenceInformationType", { QByteArray("IndexToDirect") }),
+            makeNode("UV", { QVariant::fromValue(texCoords) }),
+            makeNode("UVIndex", { QVariant::fromValue(polygonIndices) })
+        })
+    });
+}
+
+FBXNode makeDocument(int numMeshes, int verticesPerMesh) {
+    FBXNode objects = makeNode("Objects", {});
+    for (int i = 0; i < numMeshes; i++) {
+        objects.children.append(makeGeometry(i + 1, verticesPerMesh));
+    }
+
+    FBXNode root;
+    root.children.append(objects);
+    return root;
+}
+
+FBXNode parse(const QByteArray& encoded) {
+    QBuffer buffer;
+    buffer.setData(encoded);
+    buffer.open(QIODevice::ReadOnly);
+    return FBXSerializer::parseFBX(&buffer);
+}
+
+const FBXNode& findChild(const FBXNode& node, const QByteArray& name) {
+    for (const FBXNode& child : node.children) {
+        if (child.name == name) {
+            return child;
+        }
+    }
+    static const FBXNode NULL_NODE;
+    return NULL_NODE;
+}
+
+void FBXSerializerTests::arrayPropertiesDecodeOnDemand() {
+    FBXNode document = makeDocument(1, SMALL_MESH_VERTICES);
+    FBXNode& geometry = document.children[0].children[0];
+    QVector<qint64> longs { 1, -2, (qint64)1 << 40 };
+    QVector<bool> flags { true, false, true, true };
+    QVector<float> floats { 0.5f, -1.25f };
+    geometry.children.append(makeNode("Longs", { QVariant::fromValue(longs) }));
+    geometry.children.append(makeNode("Flags", { QVariant::fromValue(flags) }));
+    geometry.children.append(makeNode("Floats", { QVariant::fromValue(floats) }));
+    geometry.children.append(makeGeometry(2, LARGE_MESH_VERTICES).children.at(0));
+
+    FBXNode parsed = parse(FBXWriter::encodeFBX(document));
+    const FBXNode& parsedGeometry = parsed.children.at(0).children.at(0);
+    QCOMPARE(parsedGeometry.properties.at(0).toLongLong(), (qint64)1);
+    QCOMPARE(parsedGeometry.properties.at(2).toByteArray(), QByteArray("Mesh"));
+
+    const FBXNode& vertices = findChild(parsedGeometry, "Vertices");
+    QCOMPARE(vertices.properties.at(0).userType(), qMetaTypeId<FBXArrayProperty<double>>());
+    QCOMPARE(FBXSerializer::getDoubleVector(vertices), FBXSerializer::getDoubleVector(findChild(geometry, "Vertices")));
+    QCOMPARE(FBXSerializer::getIntVector(findChild(parsedGeometry, "PolygonVertexIndex")),
+        FBXSerializer::getIntVector(findChild(geometry, "PolygonVertexIndex")));
+    QCOMPARE(FBXSerializer::getFloatVector(findChild(parsedGeometry, "Floats")), floats);
+
+    // the other array types decode when converted
+    QCOMPARE(findChild(parsedGeometry, "Longs").properties.at(0).value<QVector<qint64>>(), longs);
+    QCOMPARE(findChild(parsedGeometry, "Flags").properties.at(0).value<QVector<bool>>(), flags);
+    QVERIFY(!findChild(parsedGeometry, "Flags").properties.at(0).canConvert<QVector<double>>());
+
+    // the large vertices were compressed by the writer
+    const FBXNode& largeVertices = parsedGeometry.children.last();
+    auto largeArray = largeVertices.properties.at(0).value<FBXArrayProperty<double>>();
+    QCOMPARE(largeArray.encoding, (quint32)FBX_PROPERTY_COMPRESSED_FLAG);
+    QCOMPARE(FBXSerializer::getDoubleVector(largeVertices), FBXSerializer::getDoubleVector(geometry.children.last()));
+}
+
+void FBXSerializerTests::writerRoundTrip() {
+    FBXNode document = makeDocument(3, LARGE_MESH_VERTICES);
+    document.children[0].children.append(makeGeometry(4, SMALL_MESH_VERTICES));
+    QByteArray encoded = FBXWriter::encodeFBX(document);
+    QCOMPARE(FBXWriter::encodeFBX(parse(encoded)), encoded);
+}
+
+void FBXSerializerTests::mappedFileOutlivesDevice() {
+    FBXNode document = makeDocument(2, LARGE_MESH_VERTICES);
+    QTemporaryFile temporaryFile;
+    QVERIFY(temporaryFile.open());
+    temporaryFile.write(FBXWriter::encodeFBX(document));
+    temporaryFile.close();
+
+    FBXNode parsed;
+    {
+        QFile file(temporaryFile.fileName());
+        QVERIFY(file.open(QIODevice::ReadOnly));
+        parsed = FBXSerializer::parseFBX(&file);
+    }
+
+    const FBXNode& geometry = parsed.children.at(0).children.at(1);
+    QCOMPARE(FBXSerializer::getDoubleVector(findChild(geometry, "Vertices")),
+        FBXSerializer::getDoubleVector(findChild(document.children.at(0).children.at(1), "Vertices")));
+}
+
+void FBXSerializerTests::corruptDataThrows() {
+    QByteArray encoded = FBXWriter::encodeFBX(makeDocument(1, LARGE_MESH_VERTICES));
+    QVERIFY_EXCEPTION_THROWN(parse(encoded.left(encoded.size() / 2)), QString);
+
+    FBXNode parsed = parse(encoded);
+    auto vertices = findChild(parsed.children.at(0).children.at(0), "Vertices").properties.at(0).value<FBXArrayProperty<double>>();
+    QCOMPARE(vertices.encoding, (quint32)FBX_PROPERTY_COMPRESSED_FLAG);
+    QByteArray garbage(vertices.byteLength, 'x');
+    vertices.data = garbage.constData();
+    QVERIFY_EXCEPTION_THROWN(vertices.decode(), QString);
+
+    FBXNode corruptVertices = makeNode("Vertices", { QVariant::fromValue(vertices) });
+    QVERIFY_EXCEPTION_THROWN(FBXSerializer::getDoubleVector(corruptVertices), QString);
+}
+
+void FBXSerializerTests::extractMeshMatchesDecodedArrays() {
+    FBXNode document = makeDocument(1, LARGE_MESH_VERTICES);
+    FBXNode parsed = parse(FBXWriter::encodeFBX(document));
+
+    unsigned int meshIndex = 0;
+    ExtractedMesh expected = FBXSerializer::extractMesh(document.children.at(0).children.at(0), meshIndex);
+    meshIndex = 0;
+    ExtractedMesh actual = FBXSerializer::extractMesh(parsed.children.at(0).children.at(0), meshIndex);
+
+    QCOMPARE(actual.mesh.vertices.size(), expected.mesh.vertices.size());
+    QVERIFY(actual.mesh.vertices == expected.mesh.vertices);
+    QVERIFY(actual.mesh.normals == expected.mesh.normals);
+    QVERIFY(actual.mesh.texCoords == expected.mesh.texCoords);
+    QCOMPARE(actual.mesh.parts.size(), expected.mesh.parts.size());
+    QCOMPARE(actual.mesh.parts.at(0).triangleIndices, expected.mesh.parts.at(0).triangleIndices);
+}
+
+void FBXSerializerTests::benchmarkAvatar() {
+    QByteArray encoded = FBXWriter::encodeFBX(makeDocument(AVATAR_MESHES, AVATAR_MESH_VERTICES));
+    QBENCHMARK {
+        FBXNode parsed = parse(encoded);
+        unsigned int meshIndex = 0;
+        for (const FBXNode& geometry : parsed.children.at(0).children) {
+            FBXSerializer::extractMesh(geometry, meshIndex);
+        }
+    }
+}
+
+void FBXSerializerTests::benchmarkScene() {
+    QByteArray encoded = FBXWriter::encodeFBX(makeDocument(SCENE_MESHES, SCENE_MESH_VERTICES));
+    QBENCHMARK {
+        FBXNode parsed = parse(encoded);
+        unsigned int meshIndex = 0;
+        for (const FBXNode& geometry : parsed.children.at(0).children) {
+            FBXSerializer::extractMesh(geometry, meshIndex);
+        }
+    }
+}
@@ -0,0 +1,308 @@
+//
+//  GLTFSerializerTests.cpp
+//  tests/fbx/src
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "GLTFSerializerTests.h"
+
+#include <QtCore/QJsonArray>
+#include <QtCore/QJsonDocument>
+#include <QtCore/QJsonObject>
+#include <QtCore/QTemporaryDir>
+#include <QtCore/QtEndian>
+
+#include <DependencyManager.h>
+#include <GLTFSerializer.h>
+#include <ResourceManager.h>
+
+QTEST_MAIN(GLTFSerializerTests)
+
+const int SMALL_MESHES = 2;
+const int SMALL_MESH_VERTICES = 300;
+const int LARGE_MESH_VERTICES = 70000; // needs 32 bit indices
+
+const int BENCHMARK_MESHES = 8;
+const int BENCHMARK_MESH_VERTICES = 65536;
+
+const int COMPONENT_TYPE_UNSIGNED_BYTE = 5121;
+const int COMPONENT_TYPE_UNSIGNED_SHORT = 5123;
+const int COMPONENT_TYPE_UNSIGNED_INT = 5125;
+const int COMPONENT_TYPE_FLOAT = 5126;
+
+// The meshes of an asset, as they're written to it and should be read from it.
+struct TestAsset {
+    QJsonObject json;
+    QByteArray binary;
+    QVector<QVector<glm::vec3>> vertices;
+    QVector<QVector<glm::vec3>> normals;
+    QVector<QVector<glm::vec2>> texCoords;
+    QVector<QVector<glm::vec3>> colors;
+    QVector<QVector<glm::vec3>> tangents;
+    QVector<QVector<int>> indices;
+};
+
+template<typename T>
+void append(QByteArray& binary, T value) {
+    char bytes[sizeof(T)];
+    qToLittleEndian(value, bytes);
+    binary.append(bytes, sizeof(T));
+}
+
+void appendFloat(QByteArray& binary, float value) {
+    quint32 bits;
+    memcpy(&bits, &value, sizeof(float));
+    append(binary, bits);
+}
+
+QJsonObject makeObject(std::initializer_list<QPair<QString, QJsonValue>> values) {
+    QJsonObject object;
+    for (const auto& value : values) {
+        object.insert(value.first, value.second);
+    }
+    return object;
+}
+
+// Each mesh has interleaved positions and normals, normalized unsigned short texture coordinates, normalized unsigned
+// byte colors, float tangents and indices, in that order in the binary.
+TestAsset makeAsset(int numMeshes, int verticesPerMesh) {
+    TestAsset asset;
+    QJsonArray bufferViews;
+    QJsonArray accessors;
+    QJsonArray meshes;
+    QJsonArray nodes;
+
+    auto addBufferView = [&](int byteOffset, int byteStride) {
+        QJsonObject bufferView = makeObject({ { "buffer", 0 }, { "byteOffset", byteOffset },
+            { "byteLength", asset.binary.size() - byteOffset } });
+        if (byteStride > 0) {
+            bufferView.insert("byteStride", byteStride);
+        }
+        bufferViews.append(bufferView);
+        return bufferViews.size() - 1;
+    };
+    auto addAccessor = [&](int bufferView, int byteOffset, int componentType, int count, const QString& type,
+            bool normalized) {
+        accessors.append(makeObject({ { "bufferView", bufferView }, { "byteOffset", byteOffset },
+            { "componentType", componentType }, { "count", count }, { "type", type }, { "normalized", normalized } }));
+        return accessors.size() - 1;
+    };
+
+    for (int i = 0; i < numMeshes; i++) {
+        QVector<glm::vec3> vertices, normals, colors, tangents;
+        QVector<glm::vec2> texCoords;
+        QVector<int> indices;
+
+        int interleavedOffset = asset.binary.size();
+        for (int j = 0; j < verticesPerMesh; j++) {
+            glm::vec3 vertex(sinf(j * 0.37f) * 10.0f, cosf(j * 0.11f) * 10.0f, (j % 97) * 0.25f + i);
+            glm::vec3 normal(0.0f, sinf(j * 0.5f), cosf(j * 0.5f));
+            appendFloat(asset.binary, vertex.x);
+            appendFloat(asset.binary, vertex.y);
+            appendFloat(asset.binary, vertex.z);
+            appendFloat(asset.binary, normal.x);
+            appendFloat(asset.binary, normal.y);
+            appendFloat(asset.binary, normal.z);
+            vertices << vertex;
+            normals << normal;
+        }
+        int interleaved = addBufferView(interleavedOffset, 6 * sizeof(float));
+
+        int texCoordOffset = asset.binary.size();
+        for (int j = 0; j < verticesPerMesh; j++) {
+            quint16 u = (quint16)(j * 7), v = (quint16)(65535 - j);
+            append(asset.binary, u);
+            append(asset.binary, v);
+            texCoords << glm::vec2(u / 65535.0f, v / 65535.0f);
+        }
+        int texCoordView = addBufferView(texCoordOffset, 0);
+
+        int colorOffset = asset.binary.size();
+        for (int j = 0; j < verticesPerMesh; j++) {
+            quint8 rgba[4] = { (quint8)j, (quint8)(j * 3), 255, 128 };
+            for (quint8 component : rgba) {
+                append(asset.binary, component);
+            }
+            colors << glm::vec3(rgba[0] / 255.0f, rgba[1] / 255.0f, rgba[2] / 255.0f);
+        }
+        int colorView = addBufferView(colorOffset, 0);
+
+        int tangentOffset = asset.binary.size();
+        for (int j = 0; j < verticesPerMesh; j++) {
+            float w = (j % 2) ? 1.0f : -1.0f;
+            appendFloat(asset.binary, 1.0f);
+            appendFloat(asset.binary, 0.5f);
+            appendFloat(asset.binary, 0.25f);
+            appendFloat(asset.binary, w);
+            tangents << glm::vec3(w, 0.5f, 0.25f);
+        }
+        int tangentView = addBufferView(tangentOffset, 0);
+
+        int indexOffset = asset.binary.size();
+        bool wideIndices = verticesPerMesh > 65536;
+        for (int j = 0; j + 2 < verticesPerMesh; j += 3) {
+            for (int k : { j, j + 2, j + 1 }) {
+                if (wideIndices) {
+                    append(asset.binary, (quint32)k);
+                } else {
+                    append(asset.binary, (quint16)k);
+                }
+                indices << k;
+            }
+        }
+        int indexView = addBufferView(indexOffset, 0);
+        while (asset.binary.size() % 4 != 0) {
+            asset.binary.append('\0');
+        }
+
+        QJsonObject attributes = makeObject({
+            { "POSITION", addAccessor(interleaved, 0, COMPONENT_TYPE_FLOAT, verticesPerMesh, "VEC3", false) },
+            { "NORMAL", addAccessor(interleaved, 3 * sizeof(float), COMPONENT_TYPE_FLOAT, verticesPerMesh, "VEC3", false) },
+            { "TEXCOORD_0", addAccessor(texCoordView, 0, COMPONENT_TYPE_UNSIGNED_SHORT, verticesPerMesh, "VEC2", true) },
+            { "COLOR_0", addAccessor(colorView, 0, COMPONENT_TYPE_UNSIGNED_BYTE, verticesPerMesh, "VEC4", true) },
+            { "TANGENT", addAccessor(tangentView, 0, COMPONENT_TYPE_FLOAT, verticesPerMesh, "VEC4", false) }
+        });
+        int indexAccessor = addAccessor(indexView, 0, wideIndices ? COMPONENT_TYPE_UNSIGNED_INT : COMPONENT_TYPE_UNSIGNED_SHORT,
+            indices.size(), "SCALAR", false);
+        QJsonObject primitive = makeObject({ { "attributes", attributes }, { "indices", indexAccessor } });
+        meshes.append(makeObject({ { "primitives", QJsonArray { primitive } } }));
+        nodes.append(makeObject({ { "mesh", i } }));
+
+        asset.vertices << vertices;
+        asset.normals << normals;
+        asset.texCoords << texCoords;
+        asset.colors << colors;
+        asset.tangents << tangents;
+        asset.indices << indices;
+    }
+
+    asset.json = makeObject({
+        { "asset", makeObject({ { "version", "2.0" } }) },
+        { "buffers", QJsonArray { makeObject({ { "byteLength", asset.binary.size() } }) } },
+        { "bufferViews", bufferViews },
+        { "accessors", accessors },
+        { "meshes", meshes },
+        { "nodes", nodes }
+    });
+    return asset;
+}
+
+QByteArray encodeGLB(const TestAsset& asset) {
+    const quint32 GLB_VERSION = 2;
+    const quint32 CHUNK_TYPE_JSON = 0x4E4F534A;
+    const quint32 CHUNK_TYPE_BIN = 0x004E4942;
+
+    QByteArray json = QJsonDocument(asset.json).toJson(QJsonDocument::Compact);
+    while (json.size() % 4 != 0) {
+        json.append(' ');
+    }
+
+    QByteArray glb = "glTF";
+    append(glb, GLB_VERSION);
+    append(glb, (quint32)(12 + 8 + json.size() + 8 + asset.binary.size()));
+    append(glb, (quint32)json.size());
+    append(glb, CHUNK_TYPE_JSON);
+    glb.append(json);
+    append(glb, (quint32)asset.binary.size());
+    append(glb, CHUNK_TYPE_BIN);
+    glb.append(asset.binary);
+    return glb;
+}
+
+// writes the asset as a .gltf with a separate .bin, returns the .gltf
+QByteArray writeGLTF(const TestAsset& asset, const QString& directory) {
+    QFile binary(directory + "/test.bin");
+    binary.open(QIODevice::WriteOnly);
+    binary.write(asset.binary);
+    binary.close();
+
+    QJsonObject json = asset.json;
+    QJsonObject buffer = json["buffers"].toArray().at(0).toObject();
+    buffer.insert("uri", "test.bin");
+    json.insert("buffers", QJsonArray { buffer });
+    return QJsonDocument(json).toJson(QJsonDocument::Compact);
+}
+
+HFMModel::Pointer read(const QByteArray& data, const QString& filename) {
+    GLTFSerializer serializer;
+    return serializer.read(data, QVariantHash(), QUrl::fromLocalFile(filename));
+}
+
+void compareMeshes(const HFMModel& model, const TestAsset& asset) {
+    QCOMPARE(model.meshes.size(), asset.vertices.size());
+    for (int i = 0; i < model.meshes.size(); i++) {
+        const HFMMesh& mesh = model.meshes.at(i);
+        QVERIFY(mesh.vertices == asset.vertices.at(i));
+        QVERIFY(mesh.normals == asset.normals.at(i));
+        QVERIFY(mesh.texCoords == asset.texCoords.at(i));
+        QVERIFY(mesh.colors == asset.colors.at(i));
+        QVERIFY(mesh.tangents == asset.tangents.at(i));
+        QCOMPARE(mesh.parts.size(), 1);
+        QCOMPARE(mesh.parts.at(0).triangleIndices, asset.indices.at(i));
+    }
+}
+
+void GLTFSerializerTests::initTestCase() {
+    DependencyManager::set<ResourceManager>();
+}
+
+void GLTFSerializerTests::cleanupTestCase() {
+    DependencyManager::get<ResourceManager>()->cleanup();
+}
+
+void GLTFSerializerTests::readGLB() {
+    QTemporaryDir directory;
+    TestAsset asset = makeAsset(SMALL_MESHES, SMALL_MESH_VERTICES);
+    HFMModel::Pointer model = read(encodeGLB(asset), directory.path() + "/test.glb");
+    QVERIFY(model);
+    compareMeshes(*model, asset);
+
+    TestAsset largeAsset = makeAsset(1, LARGE_MESH_VERTICES);
+    HFMModel::Pointer largeModel = read(encodeGLB(largeAsset), directory.path() + "/large.glb");
+    QVERIFY(largeModel);
+    compareMeshes(*largeModel, largeAsset);
+}
+
+void GLTFSerializerTests::readMappedBuffer() {
+    QTemporaryDir directory;
+    TestAsset asset = makeAsset(SMALL_MESHES, SMALL_MESH_VERTICES);
+    HFMModel::Pointer model = read(writeGLTF(asset, directory.path()), directory.path() + "/test.gltf");
+    QVERIFY(model);
+    compareMeshes(*model, asset);
+}
+
+void GLTFSerializerTests::outOfRangeAccessorFails() {
+    QTemporaryDir directory;
+    TestAsset asset = makeAsset(1, SMALL_MESH_VERTICES);
+    QJsonArray accessors = asset.json["accessors"].toArray();
+    QJsonObject positions = accessors.at(0).toObject();
+    positions.insert("count", SMALL_MESH_VERTICES * 100);
+    accessors.replace(0, positions);
+    asset.json.insert("accessors", accessors);
+
+    HFMModel::Pointer model = read(encodeGLB(asset), directory.path() + "/test.glb");
+    QVERIFY(model);
+    QCOMPARE(model->meshes.size(), 1);
+    QVERIFY(model->meshes.at(0).vertices.isEmpty());
+    QVERIFY(model->meshes.at(0).normals == asset.normals.at(0));
+}
+
+void GLTFSerializerTests::benchmarkGLB() {
+    QTemporaryDir directory;
+    QByteArray glb = encodeGLB(makeAsset(BENCHMARK_MESHES, BENCHMARK_MESH_VERTICES));
+    QBENCHMARK {
+        read(glb, directory.path() + "/test.glb");
+    }
+}
+
+void GLTFSerializerTests::benchmarkMappedBuffer() {
+    QTemporaryDir directory;
+    QByteArray gltf = writeGLTF(makeAsset(BENCHMARK_MESHES, BENCHMARK_MESH_VERTICES), directory.path());
+    QBENCHMARK {
+        read(gltf, directory.path() + "/test.gltf");
+    }
+}
@@ -0,0 +1,29 @@
+//
+//  GLTFSerializerTests.h
+//  tests/fbx/src
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_GLTFSerializerTests_h
+#define hifi_GLTFSerializerTests_h
+
+#include <QtTest/QtTest>
+
+class GLTFSerializerTests : public QObject {
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+    void readGLB();
+    void readMappedBuffer();
+    void outOfRangeAccessorFails();
+    void benchmarkGLB();
+    void benchmarkMappedBuffer();
+};
+
+#endif // hifi_GLTFSerializerTests_h
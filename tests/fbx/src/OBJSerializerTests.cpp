@@ -0,0 +1,249 @@
+//
+//  OBJSerializerTests.cpp
+//  tests/fbx/src
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "OBJSerializerTests.h"
+
+#include <QtCore/QBuffer>
+
+#include <OBJSerializer.h>
+
+QTEST_MAIN(OBJSerializerTests)
+
+const int BENCHMARK_GROUPS = 64;
+const int BENCHMARK_GROUP_QUADS = 4096;
+
+// small enough for the scanner to split even short documents into several chunks and batches
+const int SMALL_CHUNK_SIZE = 7;
+
+QString getRootPath() {
+    return QDir::cleanPath(QFileInfo(__FILE__).absolutePath() + "/../../..");
+}
+
+const QStringList SAMPLE_FILES {
+    "/unpublishedScripts/marketplace/bow/bow_collision_hull.obj",
+    "/unpublishedScripts/marketplace/bow/newarrow_collision_hull.obj",
+    "/unpublishedScripts/marketplace/xylophone/Mallet3-2bpc_phys.obj",
+    "/unpublishedScripts/parent-ator/resources/Parent-Tool-CollisionHull.obj"
+};
+
+// documents that exercise the corners of the format
+const QList<QByteArray> EDGE_CASE_DOCUMENTS {
+    // negative indices, quads and n-gons
+    "v 0 0 0\nv 1 0 0\nv 1 1 0\nv 0 1 0\nv 0 2 0\nvt 0 0\nvt 1 0\nvt 1 1\nvt 0 1\nvn 0 0 1\n"
+    "f -4/-4/-1 -3/-3/-1 -2/-2/-1 -1/-1/-1\nf 1 2 3 4 5\nf 1//1 2//1 3//1\n",
+    // vertex colors after a gap, extra components and a w
+    "v 0 0 0\nv 1 0 0 0.5 0.25 0.125\nv 1 1 0 1.0\nv 0 1 0 1 1 1 1\nvt 0.5 0.5 0\nvn 0 0 1 1\nf 1/1 2/1 3/1\nf 1 3 4\n",
+    // scale hints and comments everywhere
+    "# This file uses centimeters as units for non-parametric coordinates.\n"
+    "v 0 0 0 # trailing comment\nv 100 0 0\n#\nv 0 100 0\nf 1 2 3#no space\n",
+    "# This file uses millimeters as units for non-parametric coordinates.\r\nv 0 0 0\r\nv 1e3 0 0\r\nv 0 1E+3 0\r\nf 1 2 3\r\n",
+    // materials, groups and libraries
+    "mtllib my library.mtl\nmtllib\tlib2.mtl # comment\nv 0 0 0\nv 1 0 0\nv 1 1 0\nv 0 1 0\n"
+    "usemtl red\nf 1 2 3\nusemtl blue\nf 1 3 4\nusemtl red\nf 2 3 4\ng first\nf 1 2 4\no second\nusemtl none\nf 1 2 3\ng\nf 1 2 3\n",
+    // malformed numbers and faces
+    "v 1.5e 0x10 .5\nv -0 +1 1.\nv 007 -.5 +.5\nf 1 2 3 x\nf 1 2\nf\nf 1 1a 2 3\nvt 1,5 2\nv nan 0 0\nv 1e-50 3.4e39 inf\n",
+    "v 0.1000000000000000055511151231257827 16777217 1.00000005960464477539062500\n"
+    "v 123456789012345678901234567890 0.000000000000000000000000000001 3.14159265358979\nv 1 1 1\nf 1 2 3\n",
+    // quotes, which can span lines, and escapes
+    "mtllib \"quoted lib.mtl\"\nv 0 0 0\nv \"1\" 0 0\nv 0 1 0\nusemtl \"a \\\"quoted\\\" \\name\n\"\nf 1 2 3\n",
+    // no trailing newline
+    "v 0 0 0\nv 1 0 0\nv 0 1 0\nf 1 2 3"
+};
+
+QByteArray readSampleFile(const QString& path) {
+    QFile file(getRootPath() + path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return QByteArray();
+    }
+    return file.readAll();
+}
+
+QByteArray makeDocument(int numGroups, int quadsPerGroup) {
+    QByteArray document = "# generated\nmtllib generated.mtl\n";
+    int numVertices = 0;
+    for (int i = 0; i < numGroups; i++) {
+        document += "g group" + QByteArray::number(i) + "\nusemtl material" + QByteArray::number(i % 4) + "\n";
+        for (int j = 0; j < quadsPerGroup; j++) {
+            float x = (float)(j % 100), y = (float)(j / 100), z = i * 0.125f;
+            document += "v " + QByteArray::number(x, 'f', 6) + " " + QByteArray::number(y, 'f', 6) + " " +
+                QByteArray::number(z, 'f', 6) + "\n";
+            document += "v " + QByteArray::number(x + 1.0f, 'f', 6) + " " + QByteArray::number(y, 'f', 6) + " " +
+                QByteArray::number(z, 'f', 6) + "\n";
+            document += "vt " + QByteArray::number(x / 100.0f, 'f', 6) + " " + QByteArray::number(y / 100.0f, 'f', 6) + "\n";
+            document += "vn 0.000000 0.000000 1.000000\n";
+            numVertices += 2;
+            if (numVertices >= 4) {
+                document += "f -4/-2/-1 -3/-1/-1 -1/-1/-1 -2/-2/-1\n";
+            }
+        }
+    }
+    return document;
+}
+
+void compareTokens(const QByteArray& document, int chunkSize) {
+    QBuffer buffer;
+    buffer.setData(document);
+    buffer.open(QIODevice::ReadOnly);
+    OBJTokenizer tokenizer(&buffer);
+    OBJScanner scanner(document, chunkSize);
+
+    // vary the calls the way the OBJSerializer does
+    for (int i = 0; ; i++) {
+        switch (i % 7) {
+            case 0:
+            case 1: {
+                bool allowSpaceChar = (i % 14 == 0);
+                int token = tokenizer.nextToken(allowSpaceChar);
+                QCOMPARE(scanner.nextToken(allowSpaceChar), token);
+                if (token == OBJTokenizer::NO_TOKEN) {
+                    return;
+                }
+                if (token == OBJTokenizer::COMMENT_TOKEN) {
+                    QCOMPARE(scanner.getComment(), tokenizer.getComment());
+                } else {
+                    OBJDatum datum = scanner.getDatum();
+                    QCOMPARE(QByteArray(datum.constData(), datum.size()), tokenizer.getDatum());
+                }
+                break;
+            }
+            case 2:
+            case 3:
+                QCOMPARE(scanner.isNextTokenFloat(), tokenizer.isNextTokenFloat());
+                break;
+            case 4: {
+                float expected = 0.0f;
+                bool expectedThrows = false;
+                try {
+                    expected = tokenizer.getFloat();
+                } catch (const std::exception&) {
+                    expectedThrows = true;
+                }
+                bool actualThrows = false;
+                try {
+                    float actual = scanner.getFloat();
+                    QVERIFY(!expectedThrows);
+                    QVERIFY(memcmp(&actual, &expected, sizeof(float)) == 0 || (std::isnan(actual) && std::isnan(expected)));
+                } catch (const std::exception&) {
+                    actualThrows = true;
+                }
+                QCOMPARE(actualThrows, expectedThrows);
+                break;
+            }
+            case 5:
+                tokenizer.skipLine();
+                scanner.skipLine();
+                break;
+            default: {
+                int token = tokenizer.nextToken();
+                QCOMPARE(scanner.nextToken(), token);
+                if (token == OBJTokenizer::NO_TOKEN) {
+                    return;
+                }
+                tokenizer.pushBackToken(token);
+                scanner.pushBackToken(token);
+                break;
+            }
+        }
+    }
+}
+
+HFMModel::Pointer read(const QByteArray& document, bool useOBJTokenizer) {
+    OBJSerializer serializer;
+    serializer.useOBJTokenizer = useOBJTokenizer;
+    return serializer.read(document, QVariantHash());
+}
+
+void compareModels(const HFMModel& actual, const HFMModel& expected) {
+    QCOMPARE(actual.meshes.size(), expected.meshes.size());
+    for (int i = 0; i < expected.meshes.size(); i++) {
+        const HFMMesh& actualMesh = actual.meshes.at(i);
+        const HFMMesh& expectedMesh = expected.meshes.at(i);
+        QCOMPARE(actualMesh.vertices.size(), expectedMesh.vertices.size());
+        QVERIFY(actualMesh.vertices == expectedMesh.vertices);
+        QVERIFY(actualMesh.normals == expectedMesh.normals);
+        QVERIFY(actualMesh.texCoords == expectedMesh.texCoords);
+        QVERIFY(actualMesh.colors == expectedMesh.colors);
+        QCOMPARE(actualMesh.parts.size(), expectedMesh.parts.size());
+        for (int j = 0; j < expectedMesh.parts.size(); j++) {
+            QCOMPARE(actualMesh.parts.at(j).triangleIndices, expectedMesh.parts.at(j).triangleIndices);
+            QCOMPARE(actualMesh.parts.at(j).materialID, expectedMesh.parts.at(j).materialID);
+        }
+    }
+    QStringList actualMaterials = actual.materials.keys();
+    QStringList expectedMaterials = expected.materials.keys();
+    actualMaterials.sort();
+    expectedMaterials.sort();
+    QCOMPARE(actualMaterials, expectedMaterials);
+}
+
+void OBJSerializerTests::scannerMatchesTokenizer() {
+    QList<QByteArray> documents = EDGE_CASE_DOCUMENTS;
+    for (const QString& path : SAMPLE_FILES) {
+        documents.append(readSampleFile(path));
+    }
+    documents.append(makeDocument(2, 16));
+    for (const QByteArray& document : documents) {
+        compareTokens(document, SMALL_CHUNK_SIZE);
+        compareTokens(document, OBJScanner::DEFAULT_CHUNK_SIZE);
+    }
+}
+
+void OBJSerializerTests::scannerParsesFloats() {
+    // parsed to the nearest float, including the halfway cases the fast path leaves to std::stof()
+    const QList<QByteArray> floats {
+        "0", "-0", "0.0", "1", "-1", "0.1", "3.14159265358979", "1e10", "1E-10", "2.5e+3", "16777216", "16777217",
+        "16777219", "0.333333343267440795898437", "1.00000005960464477539062500", "9007199254740993", "1e22", "1e23",
+        "4.4e-38", "340282346638528859811704183484516925440", "007", "1.", ".5", "+1", "inf", "nan"
+    };
+    QByteArray document = floats.join(' ');
+    OBJScanner scanner(document);
+    for (const QByteArray& string : floats) {
+        bool ok;
+        string.toFloat(&ok);
+        QCOMPARE(scanner.isNextTokenFloat(), ok);
+        float expected = std::stof(string.toStdString());
+        float actual = scanner.getFloat();
+        QVERIFY(memcmp(&actual, &expected, sizeof(float)) == 0 || (std::isnan(actual) && std::isnan(expected)));
+    }
+    QCOMPARE(scanner.nextToken(), (int)OBJTokenizer::NO_TOKEN);
+}
+
+void OBJSerializerTests::readMatchesTokenizer() {
+    for (const QByteArray& document : EDGE_CASE_DOCUMENTS) {
+        compareModels(*read(document, false), *read(document, true));
+    }
+    QByteArray document = makeDocument(4, 300);
+    compareModels(*read(document, false), *read(document, true));
+}
+
+void OBJSerializerTests::readSampleFiles() {
+    for (const QString& path : SAMPLE_FILES) {
+        QByteArray document = readSampleFile(path);
+        QVERIFY(!document.isEmpty());
+        HFMModel::Pointer model = read(document, false);
+        QVERIFY(!model->meshes.isEmpty());
+        QVERIFY(!model->meshes.at(0).vertices.isEmpty());
+        compareModels(*model, *read(document, true));
+    }
+}
+
+void OBJSerializerTests::benchmarkTokenizer() {
+    QByteArray document = makeDocument(BENCHMARK_GROUPS, BENCHMARK_GROUP_QUADS);
+    QBENCHMARK {
+        read(document, true);
+    }
+}
+
+void OBJSerializerTests::benchmarkScanner() {
+    QByteArray document = makeDocument(BENCHMARK_GROUPS, BENCHMARK_GROUP_QUADS);
+    QBENCHMARK {
+        read(document, false);
+    }
+}
@@ -0,0 +1,28 @@
+//
+//  OBJSerializerTests.h
+//  tests/fbx/src
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_OBJSerializerTests_h
+#define hifi_OBJSerializerTests_h
+
+#include <QtTest/QtTest>
+
+class OBJSerializerTests : public QObject {
+    Q_OBJECT
+
+private slots:
+    void scannerMatchesTokenizer();
+    void scannerParsesFloats();
+    void readMatchesTokenizer();
+    void readSampleFiles();
+    void benchmarkTokenizer();
+    void benchmarkScanner();
+};
+
+#endif // hifi_OBJSerializerTests_h
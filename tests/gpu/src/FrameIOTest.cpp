@@ -0,0 +1,253 @@
+//
+//  FrameIOTest.cpp
+//  tests/gpu/src
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "FrameIOTest.h"
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <gpu/Context.h>
+#include <gpu/Frame.h>
+#include <gpu/FrameIO.h>
+#include <gpu/null/NullBackend.h>
+#include <shaders/Shaders.h>
+
+QTEST_MAIN(FrameIOTest)
+
+const int GRID_SIZE = 32;
+const int TEXTURE_SIZE = 64;
+const int SMALL_FRAME_DRAWS = 4;
+const int LARGE_FRAME_DRAWS = 256;
+
+static bool matricesEqual(const glm::mat4& a, const glm::mat4& b) {
+    const float EPSILON = 1.0e-5f;
+    for (int i = 0; i < 4; i++) {
+        for (int j = 0; j < 4; j++) {
+            if (fabsf(a[i][j] - b[i][j]) > EPSILON) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+static bool buffersEqual(const gpu::BufferPointer& a, const gpu::BufferPointer& b) {
+    if (!a || !b) {
+        return a == b;
+    }
+    return a->getSize() == b->getSize() && 0 == memcmp(a->getData(), b->getData(), a->getSize());
+}
+
+static void compareFrames(const gpu::Frame& expected, const gpu::Frame& actual) {
+    QCOMPARE(actual.batches.size(), expected.batches.size());
+    for (size_t i = 0; i < expected.batches.size(); i++) {
+        const auto& expectedBatch = *expected.batches[i];
+        const auto& actualBatch = *actual.batches[i];
+        QCOMPARE(actualBatch.getName(), expectedBatch.getName());
+        QVERIFY(actualBatch._commands == expectedBatch._commands);
+        QVERIFY(actualBatch._commandOffsets == expectedBatch._commandOffsets);
+        QCOMPARE(actualBatch._params.size(), expectedBatch._params.size());
+        for (size_t j = 0; j < expectedBatch._params.size(); j++) {
+            QCOMPARE(actualBatch._params[j]._size, expectedBatch._params[j]._size);
+        }
+        QVERIFY(actualBatch._data == expectedBatch._data);
+        QCOMPARE(actualBatch._drawCallInfos.size(), expectedBatch._drawCallInfos.size());
+        QVERIFY(0 == memcmp(actualBatch._drawCallInfos.data(), expectedBatch._drawCallInfos.data(),
+                            expectedBatch._drawCallInfos.size() * sizeof(gpu::Batch::DrawCallInfo)));
+
+        QCOMPARE(actualBatch._transforms.size(), expectedBatch._transforms.size());
+        for (size_t j = 0; j < expectedBatch._transforms.size(); j++) {
+            QVERIFY(matricesEqual(actualBatch._transforms.get(j).getMatrix(), expectedBatch._transforms.get(j).getMatrix()));
+        }
+        QCOMPARE(actualBatch._objects.size(), expectedBatch._objects.size());
+        for (size_t j = 0; j < expectedBatch._objects.size(); j++) {
+            QVERIFY(matricesEqual(actualBatch._objects[j]._model, expectedBatch._objects[j]._model));
+        }
+
+        QCOMPARE(actualBatch._buffers.size(), expectedBatch._buffers.size());
+        for (size_t j = 0; j < expectedBatch._buffers.size(); j++) {
+            QVERIFY(buffersEqual(actualBatch._buffers.get(j), expectedBatch._buffers.get(j)));
+        }
+        QCOMPARE(actualBatch._pipelines.size(), expectedBatch._pipelines.size());
+        QCOMPARE(actualBatch._streamFormats.size(), expectedBatch._streamFormats.size());
+        QCOMPARE(actualBatch._textures.size(), expectedBatch._textures.size());
+    }
+}
+
+static void compareTextureContents(const gpu::Frame& expected, const gpu::Frame& actual) {
+    const auto& expectedTexture = expected.batches[0]->_textures.get(0);
+    const auto& actualTexture = actual.batches[0]->_textures.get(0);
+    QVERIFY(actualTexture);
+    QCOMPARE(actualTexture->getWidth(), expectedTexture->getWidth());
+    QCOMPARE(actualTexture->getStoredMipFormat().getRaw(), expectedTexture->getStoredMipFormat().getRaw());
+    QVERIFY(actualTexture->isStoredMipFaceAvailable(0));
+    auto expectedMip = expectedTexture->accessStoredMipFace(0);
+    auto actualMip = actualTexture->accessStoredMipFace(0);
+    QCOMPARE(actualMip->getSize(), expectedMip->getSize());
+    QVERIFY(0 == memcmp(actualMip->readData(), expectedMip->readData(), expectedMip->getSize()));
+}
+
+void FrameIOTest::initTestCase() {
+    QVERIFY(_dir.isValid());
+    gpu::Context::init<gpu::null::Backend>();
+    _context = std::make_shared<gpu::Context>();
+    auto program = gpu::Shader::createProgram(shader::gpu::program::drawColor);
+    _pipeline = gpu::Pipeline::create(program, std::make_shared<gpu::State>());
+}
+
+std::string FrameIOTest::getBasename(const QString& name) const {
+    return _dir.filePath(name).toStdString();
+}
+
+gpu::FramePointer FrameIOTest::captureFrame(int numDraws, bool duplicateBuffers) {
+    _context->beginFrame();
+    auto batch = std::make_shared<gpu::Batch>("FrameIOTest");
+    batch->setPipeline(_pipeline);
+    batch->setProjectionTransform(glm::perspective(1.0f, 1.5f, 0.1f, 100.0f));
+    batch->setViewTransform(Transform(glm::lookAt(glm::vec3(0.0f, 5.0f, 10.0f), glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f))));
+
+    auto format = std::make_shared<gpu::Stream::Format>();
+    format->setAttribute(gpu::Stream::POSITION, 0, gpu::Element(gpu::VEC3, gpu::FLOAT, gpu::XYZ));
+    batch->setInputFormat(format);
+
+    auto texture = gpu::Texture::create2D(gpu::Element::COLOR_RGBA_32, TEXTURE_SIZE, TEXTURE_SIZE);
+    texture->setStoredMipFormat(gpu::Element::COLOR_RGBA_32);
+    std::vector<uint32_t> texels(TEXTURE_SIZE * TEXTURE_SIZE);
+    for (size_t i = 0; i < texels.size(); i++) {
+        texels[i] = (uint32_t)(i * 2654435761u);
+    }
+    texture->assignStoredMip(0, texels.size() * sizeof(uint32_t), (const gpu::Byte*)texels.data());
+    batch->setResourceTexture(0, texture);
+
+    std::vector<uint32_t> indices;
+    for (int y = 0; y < GRID_SIZE - 1; y++) {
+        for (int x = 0; x < GRID_SIZE - 1; x++) {
+            uint32_t corner = y * GRID_SIZE + x;
+            indices.insert(indices.end(), { corner, corner + 1, corner + GRID_SIZE, corner + 1, corner + GRID_SIZE + 1,
+                                            corner + GRID_SIZE });
+        }
+    }
+    auto indexBuffer = std::make_shared<gpu::Buffer>(indices.size() * sizeof(uint32_t), (const gpu::Byte*)indices.data());
+    batch->setIndexBuffer(gpu::UINT32, indexBuffer, 0);
+
+    for (int i = 0; i < numDraws; i++) {
+        float height = duplicateBuffers ? 0.0f : (float)i;
+        std::vector<glm::vec3> vertices;
+        for (int y = 0; y < GRID_SIZE; y++) {
+            for (int x = 0; x < GRID_SIZE; x++) {
+                vertices.emplace_back((float)x, height + sinf(x * 0.3f + y * 0.7f), (float)y);
+            }
+        }
+        auto vertexBuffer = std::make_shared<gpu::Buffer>(vertices.size() * sizeof(glm::vec3), (const gpu::Byte*)vertices.data());
+        batch->setInputBuffer(0, vertexBuffer, 0, sizeof(glm::vec3));
+        batch->setModelTransform(Transform().setTranslation(glm::vec3((float)i, 0.0f, 0.0f)));
+        batch->drawIndexed(gpu::TRIANGLES, (uint32_t)indices.size());
+    }
+
+    _context->appendFrameBatch(batch);
+    auto frame = _context->endFrame();
+    // The writer reads the buffers as the render thread sees them
+    _context->consumeFrameUpdates(frame);
+    return frame;
+}
+
+void FrameIOTest::binaryRoundTrip() {
+    auto frame = captureFrame(SMALL_FRAME_DRAWS);
+    auto basename = getBasename("binary");
+    gpu::writeFrame(basename, frame);
+    QVERIFY(QFileInfo((basename + ".frame").c_str()).exists());
+    QVERIFY(!QFileInfo((basename + ".json").c_str()).exists());
+
+    auto readFrame = gpu::readFrame(basename + ".frame", 0);
+    compareFrames(*frame, *readFrame);
+    compareTextureContents(*frame, *readFrame);
+
+    // a base name without extension finds the binary capture
+    compareFrames(*frame, *gpu::readFrame(basename, 0));
+}
+
+void FrameIOTest::compressedRoundTrip() {
+    auto frame = captureFrame(SMALL_FRAME_DRAWS);
+    auto basename = getBasename("uncompressed");
+    auto compressedBasename = getBasename("compressed");
+    gpu::writeFrame(basename, frame);
+    gpu::writeFrame(compressedBasename, frame, nullptr, gpu::FrameFormat::BINARY, gpu::FrameCompression::ZLIB);
+    QVERIFY(QFileInfo((compressedBasename + ".frame").c_str()).size() < QFileInfo((basename + ".frame").c_str()).size());
+
+    auto readFrame = gpu::readFrame(compressedBasename + ".frame", 0);
+    compareFrames(*frame, *readFrame);
+    compareTextureContents(*frame, *readFrame);
+}
+
+void FrameIOTest::jsonExportRoundTrip() {
+    auto frame = captureFrame(SMALL_FRAME_DRAWS);
+    auto basename = getBasename("export");
+    gpu::writeFrame(basename, frame, nullptr, gpu::FrameFormat::JSON);
+    QVERIFY(QFileInfo((basename + ".json").c_str()).exists());
+    QVERIFY(QFileInfo((basename + ".bin").c_str()).exists());
+    QVERIFY(!QFileInfo((basename + ".frame").c_str()).exists());
+
+    compareFrames(*frame, *gpu::readFrame(basename + ".json", 0));
+}
+
+void FrameIOTest::duplicateBlobsStoredOnce() {
+    auto distinctBasename = getBasename("distinct");
+    auto duplicateBasename = getBasename("duplicate");
+    gpu::writeFrame(distinctBasename, captureFrame(SMALL_FRAME_DRAWS));
+    auto frame = captureFrame(SMALL_FRAME_DRAWS, true);
+    gpu::writeFrame(duplicateBasename, frame);
+
+    // the duplicated vertex buffers are stored once
+    const qint64 vertexBufferSize = GRID_SIZE * GRID_SIZE * sizeof(glm::vec3);
+    auto distinctSize = QFileInfo((distinctBasename + ".frame").c_str()).size();
+    auto duplicateSize = QFileInfo((duplicateBasename + ".frame").c_str()).size();
+    QVERIFY(distinctSize - duplicateSize >= (SMALL_FRAME_DRAWS - 1) * vertexBufferSize);
+
+    // but still read as separate buffers
+    auto readFrame = gpu::readFrame(duplicateBasename + ".frame", 0);
+    compareFrames(*frame, *readFrame);
+    const auto& buffers = readFrame->batches[0]->_buffers;
+    QVERIFY(buffers.get(buffers.size() - 1) != buffers.get(buffers.size() - 2));
+}
+
+void FrameIOTest::corruptFrameThrows() {
+    auto basename = getBasename("corrupt");
+    gpu::writeFrame(basename, captureFrame(SMALL_FRAME_DRAWS));
+    QFile file((basename + ".frame").c_str());
+    QVERIFY(file.open(QIODevice::ReadWrite));
+    QByteArray contents = file.readAll();
+
+    // truncated
+    file.resize(contents.size() / 2);
+    file.close();
+    QVERIFY_EXCEPTION_THROWN(gpu::readFrame(basename + ".frame", 0), std::runtime_error);
+
+    // not a frame
+    QVERIFY(file.open(QIODevice::WriteOnly | QIODevice::Truncate));
+    contents[0] = 'X';
+    file.write(contents);
+    file.close();
+    QVERIFY_EXCEPTION_THROWN(gpu::readFrame(basename + ".frame", 0), std::runtime_error);
+}
+
+void FrameIOTest::benchmarkReadBinary() {
+    auto basename = getBasename("benchmark");
+    gpu::writeFrame(basename, captureFrame(LARGE_FRAME_DRAWS));
+    QBENCHMARK {
+        gpu::readFrame(basename + ".frame", 0);
+    }
+}
+
+void FrameIOTest::benchmarkReadJson() {
+    auto basename = getBasename("benchmark");
+    gpu::writeFrame(basename, captureFrame(LARGE_FRAME_DRAWS), nullptr, gpu::FrameFormat::JSON);
+    QBENCHMARK {
+        gpu::readFrame(basename + ".json", 0);
+    }
+}
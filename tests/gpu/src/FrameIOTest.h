@@ -0,0 +1,40 @@
+//
+//  FrameIOTest.h
+//  tests/gpu/src
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#pragma once
+
+#include <QtTest/QtTest>
+#include <QtCore/QTemporaryDir>
+
+#include <gpu/Forward.h>
+
+// Round trips captured frames through gpu::writeFrame and gpu::readFrame, on the null backend
+class FrameIOTest : public QObject {
+    Q_OBJECT
+
+private:
+    gpu::FramePointer captureFrame(int numDraws, bool duplicateBuffers = false);
+    std::string getBasename(const QString& name) const;
+
+private slots:
+    void initTestCase();
+    void binaryRoundTrip();
+    void compressedRoundTrip();
+    void jsonExportRoundTrip();
+    void duplicateBlobsStoredOnce();
+    void corruptFrameThrows();
+    void benchmarkReadBinary();
+    void benchmarkReadJson();
+
+private:
+    QTemporaryDir _dir;
+    gpu::ContextPointer _context;
+    gpu::PipelinePointer _pipeline;
+};
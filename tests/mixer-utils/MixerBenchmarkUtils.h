@@ -0,0 +1,91 @@
+//
+//  MixerBenchmarkUtils.h
+//  tests/mixer-utils
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_MixerBenchmarkUtils_h
+#define hifi_MixerBenchmarkUtils_h
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+#include <QtCore/QByteArray>
+#include <QtCore/QString>
+
+#include <LimitedNodeList.h>
+#include <udt/Packet.h>
+#include <udt/PacketHeaders.h>
+
+// Helpers shared by the mixer benchmarks, which run a mixer against simulated clients in process.
+namespace MixerBenchmarkUtils {
+
+// the simulated clients get consecutive ports from here, nothing ever listens on them
+const quint16 FIRST_CLIENT_PORT = 40000;
+
+inline int intFromEnvironment(const char* name, int defaultValue) {
+    bool ok = false;
+    int value = qEnvironmentVariableIntValue(name, &ok);
+    return ok ? value : defaultValue;
+}
+
+inline float floatFromEnvironment(const char* name, float defaultValue) {
+    bool ok = false;
+    float value = qEnvironmentVariable(name).toFloat(&ok);
+    return ok ? value : defaultValue;
+}
+
+inline uint64_t percentile(const std::vector<uint64_t>& sortedValues, float fraction) {
+    if (sortedValues.empty()) {
+        return 0;
+    }
+    size_t index = std::min(sortedValues.size() - 1, (size_t)(fraction * sortedValues.size()));
+    return sortedValues[index];
+}
+
+// Counts the datagrams a node list sends instead of putting them on the wire.
+class SentDatagramCounter {
+public:
+    // the counter must outlive the node list's sink, clear it with setDatagramSinkOperator(nullptr)
+    void countDatagramsFrom(LimitedNodeList& nodeList) {
+        nodeList.setDatagramSinkOperator([this](const QByteArray& datagram, const HifiSockAddr&) -> qint64 {
+            ++_datagrams;
+            _bytes += datagram.size();
+
+            // the mixers only send unreliable packets to the simulated clients, the type follows the udt header
+            int typeOffset = udt::Packet::totalHeaderSize();
+            if (datagram.size() > typeOffset) {
+                ++_datagramsByType[(uint8_t)datagram[typeOffset]];
+            }
+            return datagram.size();
+        });
+    }
+
+    void reset() {
+        _datagrams = 0;
+        _bytes = 0;
+        for (auto& count : _datagramsByType) {
+            count = 0;
+        }
+    }
+
+    uint64_t getDatagrams() const { return _datagrams; }
+    uint64_t getDatagrams(PacketType type) const { return _datagramsByType[(uint8_t)type]; }
+    uint64_t getBytes() const { return _bytes; }
+
+private:
+    std::atomic<uint64_t> _datagrams { 0 };
+    std::atomic<uint64_t> _bytes { 0 };
+    std::array<std::atomic<uint64_t>, 256> _datagramsByType {};
+};
+
+}
+
+#endif // hifi_MixerBenchmarkUtils_h
@@ -0,0 +1,115 @@
+//
+//  ReceivedMessageTests.cpp
+//  tests/networking/src
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "ReceivedMessageTests.h"
+
+#include <NLPacket.h>
+#include <ReceivedMessage.h>
+
+QTEST_MAIN(ReceivedMessageTests)
+
+namespace {
+
+const udt::Packet::MessageNumber MESSAGE_NUMBER = 42;
+
+std::unique_ptr<NLPacket> createReceivedMessagePacket(const QByteArray& payload, udt::Packet::PacketPosition position,
+                                                      udt::Packet::MessagePartNumber partNumber) {
+    auto packet = NLPacket::create(PacketType::AssetGetReply, -1, true, true);
+    packet->write(payload);
+    packet->writeMessageNumber(MESSAGE_NUMBER, position, partNumber);
+
+    // go through the receive path so that the headers are read back
+    auto size = packet->getDataSize();
+    auto data = std::unique_ptr<char[]>(new char[size]);
+    memcpy(data.get(), packet->getData(), size);
+    return NLPacket::fromReceivedPacket(std::move(data), size, HifiSockAddr());
+}
+
+// splits data into message packets and assembles them into a ReceivedMessage
+QSharedPointer<ReceivedMessage> assembleMessage(const QByteArray& data, int numPackets, qint64 reservedSize = 0) {
+    int packetSize = data.size() / numPackets;
+
+    auto first = createReceivedMessagePacket(data.left(packetSize), udt::Packet::FIRST, 0);
+    auto message = QSharedPointer<ReceivedMessage>::create(*first);
+    if (reservedSize > 0) {
+        message->reserve(reservedSize);
+    }
+
+    for (int i = 1; i < numPackets; ++i) {
+        bool isLast = (i == numPackets - 1);
+        auto payload = isLast ? data.mid(i * packetSize) : data.mid(i * packetSize, packetSize);
+        auto packet = createReceivedMessagePacket(payload, isLast ? udt::Packet::LAST : udt::Packet::MIDDLE, i);
+        message->appendPacket(*packet);
+    }
+
+    return message;
+}
+
+QByteArray createData(int size) {
+    QByteArray data(size, 0);
+    for (int i = 0; i < size; ++i) {
+        data[i] = (char)(i * 31);
+    }
+    return data;
+}
+
+}
+
+void ReceivedMessageTests::appendTest() {
+    const int NUM_PACKETS = 8;
+    auto data = createData(NUM_PACKETS * 1000 + 17);
+
+    auto message = assembleMessage(data, NUM_PACKETS);
+
+    QVERIFY(message->isComplete());
+    QCOMPARE(message->getNumPackets(), (qint64)NUM_PACKETS);
+    QCOMPARE(message->getSize(), (qint64)data.size());
+    QCOMPARE(message->getMessage(), data);
+}
+
+void ReceivedMessageTests::reserveTest() {
+    const int NUM_PACKETS = 16;
+    auto data = createData(NUM_PACKETS * 1000);
+
+    auto message = assembleMessage(data, NUM_PACKETS, data.size());
+
+    QVERIFY(message->isComplete());
+    QCOMPARE(message->getMessage(), data);
+
+    // a single reservation up front, so the message kept the reserved buffer
+    QCOMPARE(message->getMessage().capacity(), data.size());
+}
+
+void ReceivedMessageTests::takeAllTest() {
+    const int NUM_PACKETS = 4;
+    const int HEAD_SIZE = 45;
+    auto data = createData(NUM_PACKETS * 1000);
+
+    auto message = assembleMessage(data, NUM_PACKETS, data.size());
+
+    QCOMPARE(message->readHead(HEAD_SIZE), data.left(HEAD_SIZE));
+
+    const char* messageData = message->getRawMessage();
+    auto taken = message->takeAll();
+
+    QCOMPARE(taken, data.mid(HEAD_SIZE));
+    QCOMPARE(message->getSize(), (qint64)0);
+    QCOMPARE(message->getBytesLeftToRead(), (qint64)0);
+
+    // the data was moved within the same buffer and handed over, not copied
+    QCOMPARE(taken.constData(), messageData);
+
+    // with nothing read the buffer is handed over as it is
+    auto unreadMessage = assembleMessage(data, NUM_PACKETS, data.size());
+    const char* unreadData = unreadMessage->getRawMessage();
+    auto unreadTaken = unreadMessage->takeAll();
+    QCOMPARE(unreadTaken, data);
+    QCOMPARE(unreadTaken.constData(), unreadData);
+}
@@ -0,0 +1,31 @@
+//
+//  ReceivedMessageTests.h
+//  tests/networking/src
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_ReceivedMessageTests_h
+#define hifi_ReceivedMessageTests_h
+
+#pragma once
+
+#include <QtTest/QtTest>
+
+class ReceivedMessageTests : public QObject {
+    Q_OBJECT
+private slots:
+    // Test assembling a message from several packets
+    void appendTest();
+
+    // Test that reserving up front keeps the message in a single allocation
+    void reserveTest();
+
+    // Test handing over the data of a complete message
+    void takeAllTest();
+};
+
+#endif // hifi_ReceivedMessageTests_h
@@ -0,0 +1,168 @@
+//
+//  BulkEntityInserterTests.cpp
+//  tests/octree/src
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "BulkEntityInserterTests.h"
+
+#include <BulkEntityInserter.h>
+
+#include "EntityTreeTestUtils.h"
+
+QTEST_MAIN(BulkEntityInserterTests)
+
+using namespace EntityTreeTestUtils;
+
+namespace {
+
+// from tiny entities that go below the Morton codes' depth to ones spanning the world, some of them sharing their
+// bounds so that their order within an element shows
+void makeMixedEntities(int numEntities, QVector<EntityItemID>& entityIDs, QVector<EntityItemProperties>& properties) {
+    const std::vector<float> sizes = { 0.0001f, 0.01f, 1.0f, 1.0f, 1.0f, 10.0f, 100.0f, 5000.0f };
+    glm::vec3 position(0.0f);
+    makeEntities(numEntities, [&](int index, EntityItemProperties& entityProperties) {
+        if (index % 5 != 0) {
+            position = glm::vec3(randFloatInRange(-WORLD_SIZE, WORLD_SIZE), randFloatInRange(0.0f, 10.0f),
+                randFloatInRange(-WORLD_SIZE, WORLD_SIZE));
+        }
+        entityProperties.setPosition(position);
+        entityProperties.setDimensions(glm::vec3(sizes[index % sizes.size()]));
+    }, entityIDs, properties);
+}
+
+void addSequentially(EntityTreePointer tree, const QVector<EntityItemID>& entityIDs,
+                     const QVector<EntityItemProperties>& properties, int begin, int end) {
+    tree->withWriteLock([&] {
+        for (int i = begin; i < end; ++i) {
+            QVERIFY(tree->addEntity(entityIDs[i], properties[i]));
+        }
+    });
+}
+
+void addInBulk(EntityTreePointer tree, const QVector<EntityItemID>& entityIDs,
+               const QVector<EntityItemProperties>& properties, int begin, int end) {
+    tree->withWriteLock([&] {
+        auto entities = tree->addEntities(entityIDs.mid(begin, end - begin), properties.mid(begin, end - begin));
+        for (const auto& entity : entities) {
+            QVERIFY(entity);
+        }
+    });
+}
+
+QVector<QUuid> getElementEntityIDs(const EntityItemPointer& entity) {
+    QVector<QUuid> entityIDs;
+    entity->getElement()->forEachEntity([&](EntityItemPointer elementEntity) {
+        entityIDs.push_back(elementEntity->getEntityItemID());
+    });
+    return entityIDs;
+}
+
+// each entity is in an element with the same bounds and the same entities, in the same order, in both trees
+void compareTrees(EntityTreePointer expected, EntityTreePointer actual, const QVector<EntityItemID>& entityIDs) {
+    expected->withReadLock([&] {
+        actual->withReadLock([&] {
+            for (const auto& entityID : entityIDs) {
+                auto expectedEntity = expected->findEntityByEntityItemID(entityID);
+                auto entity = actual->findEntityByEntityItemID(entityID);
+                QVERIFY(expectedEntity && entity);
+                QVERIFY(entity->getElement());
+                QCOMPARE(entity->getElement()->getAACube(), expectedEntity->getElement()->getAACube());
+                QCOMPARE(getElementEntityIDs(entity), getElementEntityIDs(expectedEntity));
+            }
+        });
+    });
+}
+
+}
+
+void BulkEntityInserterTests::initTestCase() {
+    setUpNodeList();
+}
+
+void BulkEntityInserterTests::mortonCodes() {
+    uint64_t code;
+    int depth;
+
+    // straddles the center of the world, so it stays in the root
+    BulkEntityInserter::computeMortonCode(AABox(glm::vec3(-1.0f), 2.0f), code, depth);
+    QCOMPARE(depth, 0);
+    QCOMPARE(code, (uint64_t)0);
+
+    // the first level's bits come first, so that a subtree's codes are contiguous
+    uint64_t nearCode;
+    BulkEntityInserter::computeMortonCode(AABox(glm::vec3(100.0f, 100.0f, -200.0f), 1.0f), nearCode, depth);
+    QVERIFY(depth > 0 && depth < BulkEntityInserter::MAX_MORTON_DEPTH);
+    QCOMPARE((int)(nearCode >> (3 * (BulkEntityInserter::MAX_MORTON_DEPTH - 1))), (int)OctreeElement::CHILD_TOP_LEFT_NEAR);
+    uint64_t farCode;
+    BulkEntityInserter::computeMortonCode(AABox(glm::vec3(100.0f, 100.0f, 200.0f), 1.0f), farCode, depth);
+    QCOMPARE((int)(farCode >> (3 * (BulkEntityInserter::MAX_MORTON_DEPTH - 1))), (int)OctreeElement::CHILD_TOP_LEFT_FAR);
+    QVERIFY(nearCode < farCode);
+
+    // boxes smaller than the deepest level stop there
+    BulkEntityInserter::computeMortonCode(AABox(glm::vec3(100.0f), 0.0001f), code, depth);
+    QCOMPARE(depth, BulkEntityInserter::MAX_MORTON_DEPTH);
+}
+
+void BulkEntityInserterTests::matchesSequentialInsert() {
+    QVector<EntityItemID> entityIDs;
+    QVector<EntityItemProperties> properties;
+    makeMixedEntities(200, entityIDs, properties);
+
+    auto expected = makeEmptyTree();
+    addSequentially(expected, entityIDs, properties, 0, entityIDs.size());
+    auto tree = makeEmptyTree();
+    addInBulk(tree, entityIDs, properties, 0, entityIDs.size());
+    compareTrees(expected, tree, entityIDs);
+}
+
+void BulkEntityInserterTests::mergesIntoExistingTree() {
+    QVector<EntityItemID> entityIDs;
+    QVector<EntityItemProperties> properties;
+    makeMixedEntities(3000, entityIDs, properties);
+
+    auto expected = makeEmptyTree();
+    addSequentially(expected, entityIDs, properties, 0, entityIDs.size());
+
+    // half of them already there, the rest merged into the same elements or new ones
+    auto tree = makeEmptyTree();
+    addSequentially(tree, entityIDs, properties, 0, entityIDs.size() / 2);
+    addInBulk(tree, entityIDs, properties, entityIDs.size() / 2, entityIDs.size());
+    compareTrees(expected, tree, entityIDs);
+}
+
+void BulkEntityInserterTests::buildsSubtreesInParallel() {
+    QVector<EntityItemID> entityIDs;
+    QVector<EntityItemProperties> properties;
+    makeMixedEntities(50000, entityIDs, properties);
+
+    auto expected = makeEmptyTree();
+    addSequentially(expected, entityIDs, properties, 0, entityIDs.size());
+    auto tree = makeEmptyTree();
+    addInBulk(tree, entityIDs, properties, 0, entityIDs.size());
+    compareTrees(expected, tree, entityIDs);
+}
+
+void BulkEntityInserterTests::benchmarkSequentialInsert() {
+    QVector<EntityItemID> entityIDs;
+    QVector<EntityItemProperties> properties;
+    makeMixedEntities(50000, entityIDs, properties);
+
+    QBENCHMARK {
+        addSequentially(makeEmptyTree(), entityIDs, properties, 0, entityIDs.size());
+    }
+}
+
+void BulkEntityInserterTests::benchmarkBulkInsert() {
+    QVector<EntityItemID> entityIDs;
+    QVector<EntityItemProperties> properties;
+    makeMixedEntities(50000, entityIDs, properties);
+
+    QBENCHMARK {
+        addInBulk(makeEmptyTree(), entityIDs, properties, 0, entityIDs.size());
+    }
+}
@@ -0,0 +1,29 @@
+//
+//  BulkEntityInserterTests.h
+//  tests/octree/src
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_BulkEntityInserterTests_h
+#define hifi_BulkEntityInserterTests_h
+
+#include <QtTest/QtTest>
+
+class BulkEntityInserterTests : public QObject {
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void mortonCodes();
+    void matchesSequentialInsert();
+    void mergesIntoExistingTree();
+    void buildsSubtreesInParallel();
+    void benchmarkSequentialInsert();
+    void benchmarkBulkInsert();
+};
+
+#endif // hifi_BulkEntityInserterTests_h
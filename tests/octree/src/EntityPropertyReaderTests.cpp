@@ -0,0 +1,145 @@
+//
+//  EntityPropertyReaderTests.cpp
+//  tests/octree/src
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "EntityPropertyReaderTests.h"
+
+#include <QtCore/QJsonDocument>
+#include <QtScript/QScriptEngine>
+
+#include <EntityItemProperties.h>
+#include <EntityPropertyReader.h>
+#include <EntityTypes.h>
+#include <SharedUtil.h>
+
+QTEST_MAIN(EntityPropertyReaderTests)
+
+namespace {
+
+const int NUM_ENTITIES = 1000;
+
+std::vector<EntityItemPointer> makeEntities(int count) {
+    std::vector<EntityItemPointer> entities;
+    for (int i = 0; i < count; i++) {
+        EntityItemProperties properties;
+        properties.setType(EntityTypes::Box);
+        properties.setName(QString("box %1").arg(i));
+        properties.setPosition(glm::vec3((float)i, 2.0f, -3.0f));
+        properties.setDimensions(glm::vec3(0.5f, 1.0f, 2.0f));
+        properties.setRotation(glm::angleAxis((float)i * 0.01f, glm::vec3(0.0f, 1.0f, 0.0f)));
+        properties.setVelocity(glm::vec3(0.0f, -1.0f, 0.0f));
+        properties.setUserData("{\"index\": " + QString::number(i) + "}");
+        properties.setLocked(i % 2 == 0);
+        properties.setCreated(usecTimestampNow());
+        entities.push_back(EntityTypes::constructEntityItem(QUuid::createUuid(), properties));
+    }
+    return entities;
+}
+
+EntityPropertyFlags desiredPropertiesFor(const QStringList& names) {
+    EntityPropertyFlags desiredProperties;
+    for (const auto& name : names) {
+        EntityPropertyInfo propertyInfo;
+        if (EntityItemProperties::getPropertyInfo(name, propertyInfo)) {
+            desiredProperties.setHasProperty(propertyInfo.propertyEnum);
+        }
+    }
+    return desiredProperties;
+}
+
+EntityPsuedoPropertyFlags psuedoPropertiesFor(const QStringList& names) {
+    EntityPsuedoPropertyFlags psuedoPropertyFlags;
+    psuedoPropertyFlags.set(EntityPsuedoPropertyFlag::FlagsActive);
+    if (names.contains("id")) {
+        psuedoPropertyFlags.set(EntityPsuedoPropertyFlag::ID);
+    }
+    if (names.contains("type")) {
+        psuedoPropertyFlags.set(EntityPsuedoPropertyFlag::Type);
+    }
+    if (names.contains("boundingBox")) {
+        psuedoPropertyFlags.set(EntityPsuedoPropertyFlag::BoundingBox);
+    }
+    return psuedoPropertyFlags;
+}
+
+QScriptValue getPropertiesScriptValue(QScriptEngine& engine, const std::vector<EntityItemPointer>& entities,
+        const EntityPropertyFlags& desiredProperties, const EntityPsuedoPropertyFlags& psuedoPropertyFlags) {
+    QScriptValue result = engine.newArray((uint)entities.size());
+    quint32 i = 0;
+    for (const auto& entity : entities) {
+        auto properties = entity->getProperties(desiredProperties, true);
+        result.setProperty(i++, properties.copyToScriptValue(&engine, false, false, false, psuedoPropertyFlags));
+    }
+    return result;
+}
+
+QByteArray toJson(const QScriptValue& value) {
+    return QJsonDocument::fromVariant(value.toVariant()).toJson(QJsonDocument::Compact);
+}
+
+// the common bulk queries, the entities have no parents so these don't depend on the script semantics conversion
+const QStringList QUERY_PROPERTIES = { "id", "type", "name", "position", "rotation", "dimensions", "velocity",
+    "userData", "locked", "visible", "parentID", "collisionless", "queryAACube" };
+
+}
+
+void EntityPropertyReaderTests::matchesCopyToScriptValue() {
+    QScriptEngine engine;
+    auto entities = makeEntities(10);
+    auto desiredProperties = desiredPropertiesFor(QUERY_PROPERTIES);
+    auto psuedoPropertyFlags = psuedoPropertiesFor(QUERY_PROPERTIES);
+
+    auto reader = EntityPropertyReader::compile(desiredProperties, psuedoPropertyFlags, true);
+    QVERIFY(reader);
+    for (const auto& entity : entities) {
+        reader->read(*entity);
+    }
+    QCOMPARE(reader->getEntityCount(), (int)entities.size());
+
+    auto expected = getPropertiesScriptValue(engine, entities, desiredProperties, psuedoPropertyFlags);
+    QCOMPARE(toJson(reader->toScriptValue(&engine)), toJson(expected));
+}
+
+void EntityPropertyReaderTests::unsupportedPropertiesFallBack() {
+    EntityPsuedoPropertyFlags noFlags;
+    QVERIFY(!EntityPropertyReader::compile(EntityPropertyFlags(), noFlags, false));
+
+    // type specific properties go through EntityItemProperties
+    QStringList names = { "id", "modelURL" };
+    QVERIFY(!EntityPropertyReader::compile(desiredPropertiesFor(names), psuedoPropertiesFor(names), false));
+
+    names = { "id", "boundingBox" };
+    QVERIFY(!EntityPropertyReader::compile(desiredPropertiesFor(names), psuedoPropertiesFor(names), false));
+}
+
+void EntityPropertyReaderTests::benchmarkReader() {
+    QScriptEngine engine;
+    auto entities = makeEntities(NUM_ENTITIES);
+    auto desiredProperties = desiredPropertiesFor(QUERY_PROPERTIES);
+    auto psuedoPropertyFlags = psuedoPropertiesFor(QUERY_PROPERTIES);
+
+    QBENCHMARK {
+        auto reader = EntityPropertyReader::compile(desiredProperties, psuedoPropertyFlags, true);
+        for (const auto& entity : entities) {
+            reader->read(*entity);
+        }
+        reader->toScriptValue(&engine);
+    }
+}
+
+void EntityPropertyReaderTests::benchmarkGetProperties() {
+    QScriptEngine engine;
+    auto entities = makeEntities(NUM_ENTITIES);
+    auto desiredProperties = desiredPropertiesFor(QUERY_PROPERTIES);
+    auto psuedoPropertyFlags = psuedoPropertiesFor(QUERY_PROPERTIES);
+
+    QBENCHMARK {
+        getPropertiesScriptValue(engine, entities, desiredProperties, psuedoPropertyFlags);
+    }
+}
@@ -0,0 +1,26 @@
+//
+//  EntityPropertyReaderTests.h
+//  tests/octree/src
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_EntityPropertyReaderTests_h
+#define hifi_EntityPropertyReaderTests_h
+
+#include <QtTest/QtTest>
+
+class EntityPropertyReaderTests : public QObject {
+    Q_OBJECT
+
+private slots:
+    void matchesCopyToScriptValue();
+    void unsupportedPropertiesFallBack();
+    void benchmarkReader();
+    void benchmarkGetProperties();
+};
+
+#endif // hifi_EntityPropertyReaderTests_h
@@ -0,0 +1,237 @@
+//
+//  EntityRayIntersectionTests.cpp
+//  tests/octree/src
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "EntityRayIntersectionTests.h"
+
+#include "EntityTreeTestUtils.h"
+
+QTEST_MAIN(EntityRayIntersectionTests)
+
+namespace {
+
+const float WORLD_SIZE = 200.0f;
+const float DISTANCE_TOLERANCE = 0.001f;
+const PickFilter SEARCH_FILTER(PickFilter::getBitMask(PickFilter::FlagBit::DOMAIN_ENTITIES) |
+    PickFilter::getBitMask(PickFilter::FlagBit::AVATAR_ENTITIES) | PickFilter::getBitMask(PickFilter::FlagBit::COLLIDABLE) |
+    PickFilter::getBitMask(PickFilter::FlagBit::NONCOLLIDABLE));
+
+glm::vec3 randomPosition() {
+    return glm::vec3(randFloatInRange(0.0f, WORLD_SIZE), randFloatInRange(0.0f, WORLD_SIZE), randFloatInRange(0.0f, WORLD_SIZE));
+}
+
+glm::vec3 randomDirection() {
+    glm::vec3 direction;
+    do {
+        direction = glm::vec3(randFloatInRange(-1.0f, 1.0f), randFloatInRange(-1.0f, 1.0f), randFloatInRange(-1.0f, 1.0f));
+    } while (glm::length2(direction) < 0.01f);
+    return glm::normalize(direction);
+}
+
+// unrotated boxes, so the closest hit can be found by testing every entity's AABox, boxes is left empty unless the tree
+// took them all
+EntityTreePointer makeTree(int numEntities, std::vector<AABox>& boxes) {
+    QVector<EntityItemID> entityIDs;
+    QVector<EntityItemProperties> properties;
+    EntityTreeTestUtils::makeEntities(numEntities, [](int index, EntityItemProperties& entityProperties) {
+        entityProperties.setType(EntityTypes::Box);
+        entityProperties.setPosition(randomPosition());
+        entityProperties.setDimensions(glm::vec3(randFloatInRange(0.2f, 3.0f), randFloatInRange(0.2f, 3.0f),
+            randFloatInRange(0.2f, 3.0f)));
+    }, entityIDs, properties);
+
+    auto tree = EntityTreeTestUtils::makeEmptyTree();
+    if (EntityTreeTestUtils::addEntities(tree, entityIDs, properties) == numEntities) {
+        for (const auto& entityProperties : properties) {
+            glm::vec3 dimensions = entityProperties.getDimensions();
+            boxes.push_back(AABox(entityProperties.getPosition() - 0.5f * dimensions, dimensions));
+        }
+    }
+    return tree;
+}
+
+float findClosestBox(const std::vector<AABox>& boxes, const glm::vec3& origin, const glm::vec3& direction) {
+    float closest = FLT_MAX;
+    for (const auto& box : boxes) {
+        float distance;
+        BoxFace face;
+        glm::vec3 surfaceNormal;
+        if (box.findRayIntersection(origin, direction, 1.0f / direction, distance, face, surfaceNormal)) {
+            closest = glm::min(closest, distance);
+        }
+    }
+    return closest;
+}
+
+float findClosestBox(const std::vector<AABox>& boxes, const PickParabola& parabola) {
+    float closest = FLT_MAX;
+    for (const auto& box : boxes) {
+        float parabolicDistance;
+        BoxFace face;
+        glm::vec3 surfaceNormal;
+        if (box.findParabolaIntersection(parabola.origin, parabola.velocity, parabola.acceleration, parabolicDistance,
+                face, surfaceNormal)) {
+            closest = glm::min(closest, parabolicDistance);
+        }
+    }
+    return closest;
+}
+
+EntityItemID evalRayIntersection(EntityTreePointer tree, const glm::vec3& origin, const glm::vec3& direction,
+        float& distance) {
+    OctreeElementPointer element;
+    BoxFace face;
+    glm::vec3 surfaceNormal;
+    QVariantMap extraInfo;
+    return tree->evalRayIntersection(origin, direction, QVector<EntityItemID>(), QVector<EntityItemID>(), SEARCH_FILTER,
+        element, distance, face, surfaceNormal, extraInfo, Octree::Lock);
+}
+
+EntityItemID evalParabolaIntersection(EntityTreePointer tree, const PickParabola& parabola, float& parabolicDistance) {
+    OctreeElementPointer element;
+    glm::vec3 intersection;
+    float distance;
+    BoxFace face;
+    glm::vec3 surfaceNormal;
+    QVariantMap extraInfo;
+    return tree->evalParabolaIntersection(parabola, QVector<EntityItemID>(), QVector<EntityItemID>(), SEARCH_FILTER,
+        element, intersection, distance, parabolicDistance, face, surfaceNormal, extraInfo, Octree::Lock);
+}
+
+void compareDistances(float actual, float expected) {
+    if (expected == FLT_MAX) {
+        QCOMPARE(actual, FLT_MAX);
+    } else {
+        QVERIFY2(glm::abs(actual - expected) < DISTANCE_TOLERANCE,
+            qPrintable(QString("distance %1 expected %2").arg(actual).arg(expected)));
+    }
+}
+
+}
+
+void EntityRayIntersectionTests::initTestCase() {
+    EntityTreeTestUtils::setUpNodeList();
+}
+
+void EntityRayIntersectionTests::raysFindClosestEntity() {
+    std::vector<AABox> boxes;
+    auto tree = makeTree(2000, boxes);
+    QCOMPARE((int)boxes.size(), 2000);
+
+    int numHits = 0;
+    for (int i = 0; i < 500; i++) {
+        // half the rays start outside the world
+        glm::vec3 origin = randomPosition() + (i % 2 == 0 ? glm::vec3(0.0f) : glm::vec3(-WORLD_SIZE, 0.0f, 0.0f));
+        glm::vec3 direction = randomDirection();
+
+        float distance;
+        EntityItemID entityID = evalRayIntersection(tree, origin, direction, distance);
+        float expected = findClosestBox(boxes, origin, direction);
+        QCOMPARE(entityID.isNull(), expected == FLT_MAX);
+        compareDistances(distance, expected);
+        numHits += entityID.isNull() ? 0 : 1;
+    }
+    QVERIFY(numHits > 0);
+}
+
+void EntityRayIntersectionTests::batchedRaysMatchSingleRays() {
+    std::vector<AABox> boxes;
+    auto tree = makeTree(2000, boxes);
+
+    // more rays than fit in a batch
+    const int NUM_RAYS = EntityTreeElement::MAX_RAYS_PER_BATCH * 2 + 5;
+    glm::vec3 origin(WORLD_SIZE / 2.0f);
+    QVector<glm::vec3> directions;
+    for (int i = 0; i < NUM_RAYS; i++) {
+        directions.push_back(randomDirection());
+    }
+
+    QVector<EntityRayIntersection> intersections;
+    tree->evalRayIntersections(origin, directions, QVector<EntityItemID>(), QVector<EntityItemID>(), SEARCH_FILTER,
+        intersections, Octree::Lock);
+    QCOMPARE(intersections.size(), NUM_RAYS);
+
+    for (int i = 0; i < NUM_RAYS; i++) {
+        float distance;
+        EntityItemID entityID = evalRayIntersection(tree, origin, directions[i], distance);
+        QCOMPARE(intersections[i].entityID, entityID);
+        QCOMPARE(intersections[i].distance, distance);
+    }
+}
+
+void EntityRayIntersectionTests::parabolasFindClosestEntity() {
+    std::vector<AABox> boxes;
+    auto tree = makeTree(2000, boxes);
+
+    const glm::vec3 GRAVITY(0.0f, -9.8f, 0.0f);
+    for (int i = 0; i < 200; i++) {
+        // a teleport arc, and a few with no acceleration, which are rays
+        glm::vec3 acceleration = i % 10 == 0 ? glm::vec3(0.0f) : GRAVITY;
+        PickParabola parabola(randomPosition(), 20.0f * randomDirection(), acceleration);
+
+        float parabolicDistance;
+        EntityItemID entityID = evalParabolaIntersection(tree, parabola, parabolicDistance);
+        float expected = findClosestBox(boxes, parabola);
+        QCOMPARE(entityID.isNull(), expected == FLT_MAX);
+        compareDistances(parabolicDistance, expected);
+    }
+}
+
+void EntityRayIntersectionTests::benchmarkRayIntersection() {
+    std::vector<AABox> boxes;
+    auto tree = makeTree(100000, boxes);
+
+    std::vector<std::pair<glm::vec3, glm::vec3>> rays;
+    for (int i = 0; i < 100; i++) {
+        rays.emplace_back(randomPosition(), randomDirection());
+    }
+
+    QBENCHMARK {
+        for (const auto& ray : rays) {
+            float distance;
+            evalRayIntersection(tree, ray.first, ray.second, distance);
+        }
+    }
+}
+
+void EntityRayIntersectionTests::benchmarkBatchedRayIntersection() {
+    std::vector<AABox> boxes;
+    auto tree = makeTree(100000, boxes);
+
+    // hand lasers and the mouse all start near the camera
+    glm::vec3 origin(WORLD_SIZE / 2.0f);
+    QVector<glm::vec3> directions;
+    for (int i = 0; i < EntityTreeElement::MAX_RAYS_PER_BATCH; i++) {
+        directions.push_back(randomDirection());
+    }
+
+    QVector<EntityRayIntersection> intersections;
+    QBENCHMARK {
+        tree->evalRayIntersections(origin, directions, QVector<EntityItemID>(), QVector<EntityItemID>(), SEARCH_FILTER,
+            intersections, Octree::Lock);
+    }
+}
+
+void EntityRayIntersectionTests::benchmarkParabolaIntersection() {
+    std::vector<AABox> boxes;
+    auto tree = makeTree(100000, boxes);
+
+    const glm::vec3 GRAVITY(0.0f, -9.8f, 0.0f);
+    std::vector<PickParabola> parabolas;
+    for (int i = 0; i < 100; i++) {
+        parabolas.emplace_back(randomPosition(), 20.0f * randomDirection(), GRAVITY);
+    }
+
+    QBENCHMARK {
+        for (const auto& parabola : parabolas) {
+            float parabolicDistance;
+            evalParabolaIntersection(tree, parabola, parabolicDistance);
+        }
+    }
+}
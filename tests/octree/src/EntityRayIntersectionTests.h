@@ -0,0 +1,29 @@
+//
+//  EntityRayIntersectionTests.h
+//  tests/octree/src
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_EntityRayIntersectionTests_h
+#define hifi_EntityRayIntersectionTests_h
+
+#include <QtTest/QtTest>
+
+class EntityRayIntersectionTests : public QObject {
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void raysFindClosestEntity();
+    void batchedRaysMatchSingleRays();
+    void parabolasFindClosestEntity();
+    void benchmarkRayIntersection();
+    void benchmarkBatchedRayIntersection();
+    void benchmarkParabolaIntersection();
+};
+
+#endif // hifi_EntityRayIntersectionTests_h
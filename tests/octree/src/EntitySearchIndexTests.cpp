@@ -0,0 +1,157 @@
+//
+//  EntitySearchIndexTests.cpp
+//  tests/octree/src
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "EntitySearchIndexTests.h"
+
+#include "EntityTreeTestUtils.h"
+
+QTEST_MAIN(EntitySearchIndexTests)
+
+using namespace EntityTreeTestUtils;
+
+namespace {
+
+const int NUM_NAMES = 100;
+const PickFilter SEARCH_FILTER(PickFilter::getBitMask(PickFilter::FlagBit::DOMAIN_ENTITIES) |
+    PickFilter::getBitMask(PickFilter::FlagBit::AVATAR_ENTITIES));
+
+// spread through the world, NUM_NAMES of them share each name, entityIDs is left empty unless the tree took them all
+EntityTreePointer makeTree(int numEntities, std::vector<EntityItemID>& entityIDs) {
+    QVector<EntityItemID> newEntityIDs;
+    QVector<EntityItemProperties> properties;
+    makeEntities(numEntities, [](int index, EntityItemProperties& entityProperties) {
+        entityProperties.setName(QString("Entity %1").arg(index % NUM_NAMES));
+        entityProperties.setPosition(glm::vec3(randFloatInRange(0.0f, WORLD_SIZE), randFloatInRange(0.0f, 10.0f),
+            randFloatInRange(0.0f, WORLD_SIZE)));
+        entityProperties.setDimensions(glm::vec3(1.0f));
+    }, newEntityIDs, properties);
+
+    auto tree = makeEmptyTree();
+    if (addEntities(tree, newEntityIDs, properties) == numEntities) {
+        entityIDs.assign(newEntityIDs.begin(), newEntityIDs.end());
+    }
+    return tree;
+}
+
+// what the octree search would find, checking every entity
+QSet<QUuid> findEntitiesInSphere(EntityTreePointer tree, const std::vector<EntityItemID>& entityIDs,
+        const glm::vec3& center, float radius, std::function<bool(const EntityItemPointer&)> matches) {
+    QSet<QUuid> found;
+    for (const auto& entityID : entityIDs) {
+        auto entity = tree->findEntityByEntityItemID(entityID);
+        if (entity && matches(entity) && EntityTreeElement::checkFilterSettings(entity, SEARCH_FILTER) &&
+                EntityTreeElement::checkEntityInSphere(entity, center, radius)) {
+            found.insert(entityID);
+        }
+    }
+    return found;
+}
+
+QSet<QUuid> findEntitiesWithName(EntityTreePointer tree, const glm::vec3& center, float radius, const QString& name,
+        bool caseSensitive) {
+    QVector<QUuid> found;
+    tree->withReadLock([&] {
+        tree->evalEntitiesInSphereWithName(center, radius, name, caseSensitive, SEARCH_FILTER, found);
+    });
+    return QSet<QUuid>::fromList(found.toList());
+}
+
+QSet<QUuid> findEntitiesWithType(EntityTreePointer tree, const glm::vec3& center, float radius,
+        EntityTypes::EntityType type) {
+    QVector<QUuid> found;
+    tree->withReadLock([&] {
+        tree->evalEntitiesInSphereWithType(center, radius, type, SEARCH_FILTER, found);
+    });
+    return QSet<QUuid>::fromList(found.toList());
+}
+
+}
+
+void EntitySearchIndexTests::initTestCase() {
+    setUpNodeList();
+}
+
+void EntitySearchIndexTests::findsSameEntities() {
+    std::vector<EntityItemID> entityIDs;
+    auto tree = makeTree(2000, entityIDs);
+    QCOMPARE((int)entityIDs.size(), 2000);
+
+    // small spheres search the octree, large ones use the index
+    const glm::vec3 center(WORLD_SIZE / 2.0f, 0.0f, WORLD_SIZE / 2.0f);
+    const std::vector<float> radii = { 10.0f, 100.0f, 400.0f, WORLD_SIZE * 2.0f };
+    for (float radius : radii) {
+        auto expected = findEntitiesInSphere(tree, entityIDs, center, radius, [](const EntityItemPointer& entity) {
+            return entity->getName() == "Entity 7";
+        });
+        QCOMPARE(findEntitiesWithName(tree, center, radius, "Entity 7", true), expected);
+        QCOMPARE(findEntitiesWithName(tree, center, radius, "ENTITY 7", false), expected);
+        QVERIFY(findEntitiesWithName(tree, center, radius, "ENTITY 7", true).isEmpty());
+
+        expected = findEntitiesInSphere(tree, entityIDs, center, radius, [](const EntityItemPointer& entity) {
+            return entity->getType() == EntityTypes::Sphere;
+        });
+        QCOMPARE(findEntitiesWithType(tree, center, radius, EntityTypes::Sphere), expected);
+    }
+    QVERIFY(findEntitiesWithType(tree, center, WORLD_SIZE * 2.0f, EntityTypes::Model).isEmpty());
+}
+
+void EntitySearchIndexTests::renamedEntities() {
+    std::vector<EntityItemID> entityIDs;
+    auto tree = makeTree(100, entityIDs);
+    const glm::vec3 center(0.0f);
+    const float radius = WORLD_SIZE * 2.0f;
+
+    EntityItemProperties properties;
+    properties.setName("Renamed");
+    tree->withWriteLock([&] {
+        tree->updateEntity(entityIDs[3], properties);
+    });
+
+    QSet<QUuid> expected { entityIDs[3] };
+    QCOMPARE(findEntitiesWithName(tree, center, radius, "renamed", false), expected);
+    QVERIFY(!findEntitiesWithName(tree, center, radius, "Entity 3", true).contains(entityIDs[3]));
+}
+
+void EntitySearchIndexTests::deletedEntities() {
+    std::vector<EntityItemID> entityIDs;
+    auto tree = makeTree(100, entityIDs);
+    const glm::vec3 center(0.0f);
+    const float radius = WORLD_SIZE * 2.0f;
+
+    QCOMPARE(findEntitiesWithName(tree, center, radius, "Entity 5", true).size(), 1);
+    tree->withWriteLock([&] {
+        tree->deleteEntity(entityIDs[5], true);
+    });
+    QVERIFY(findEntitiesWithName(tree, center, radius, "Entity 5", true).isEmpty());
+
+    tree->eraseAllOctreeElements();
+    QVERIFY(findEntitiesWithType(tree, center, radius, EntityTypes::Box).isEmpty());
+}
+
+void EntitySearchIndexTests::benchmarkFindByName() {
+    std::vector<EntityItemID> entityIDs;
+    auto tree = makeTree(100000, entityIDs);
+    const glm::vec3 center(WORLD_SIZE / 2.0f, 0.0f, WORLD_SIZE / 2.0f);
+
+    // what scripts that poll for an entity every frame do
+    QBENCHMARK {
+        findEntitiesWithName(tree, center, WORLD_SIZE, "Entity 42", false);
+    }
+}
+
+void EntitySearchIndexTests::benchmarkFindByType() {
+    std::vector<EntityItemID> entityIDs;
+    auto tree = makeTree(100000, entityIDs);
+    const glm::vec3 center(WORLD_SIZE / 2.0f, 0.0f, WORLD_SIZE / 2.0f);
+
+    QBENCHMARK {
+        findEntitiesWithType(tree, center, 50.0f, EntityTypes::Sphere);
+    }
+}
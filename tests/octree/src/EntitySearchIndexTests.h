@@ -0,0 +1,28 @@
+//
+//  EntitySearchIndexTests.h
+//  tests/octree/src
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_EntitySearchIndexTests_h
+#define hifi_EntitySearchIndexTests_h
+
+#include <QtTest/QtTest>
+
+class EntitySearchIndexTests : public QObject {
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void findsSameEntities();
+    void renamedEntities();
+    void deletedEntities();
+    void benchmarkFindByName();
+    void benchmarkFindByType();
+};
+
+#endif // hifi_EntitySearchIndexTests_h
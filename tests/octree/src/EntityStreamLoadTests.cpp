@@ -0,0 +1,297 @@
+//
+//  EntityStreamLoadTests.cpp
+//  tests/octree/src
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "EntityStreamLoadTests.h"
+
+#include <QtCore/QTemporaryDir>
+
+#include <Gzip.h>
+#include <OctreeDataUtils.h>
+#include <OctreeEntitiesFileParser.h>
+
+#include "EntityTreeTestUtils.h"
+
+QTEST_MAIN(EntityStreamLoadTests)
+
+using namespace EntityTreeTestUtils;
+
+namespace {
+
+// of two sizes, spread through the world
+void makeSpreadEntities(int numEntities, QVector<EntityItemID>& entityIDs, QVector<EntityItemProperties>& properties) {
+    makeEntities(numEntities, [](int index, EntityItemProperties& entityProperties) {
+        entityProperties.setPosition(glm::vec3(randFloatInRange(0.0f, WORLD_SIZE), randFloatInRange(0.0f, 10.0f),
+            randFloatInRange(0.0f, WORLD_SIZE)));
+        entityProperties.setDimensions(glm::vec3(index % 10 == 0 ? 100.0f : 1.0f));
+    }, entityIDs, properties);
+}
+
+EntityTreePointer makeTree(int numEntities) {
+    QVector<EntityItemID> entityIDs;
+    QVector<EntityItemProperties> properties;
+    makeSpreadEntities(numEntities, entityIDs, properties);
+
+    auto tree = makeEmptyTree();
+    addEntities(tree, entityIDs, properties);
+    return tree;
+}
+
+QString writeTree(EntityTreePointer tree, const QString& fileName) {
+    bool success = false;
+    tree->withReadLock([&] {
+        success = tree->writeToFile(fileName.toLocal8Bit().constData(), nullptr, "json.gz");
+    });
+    return success ? fileName + ".json.gz" : QString();
+}
+
+QVector<EntityItemPointer> getEntities(EntityTreePointer tree) {
+    QVector<EntityItemPointer> entities;
+    tree->withReadLock([&] {
+        tree->recurseTreeWithOperation([&](const OctreeElementPointer& element, void*) {
+            std::static_pointer_cast<EntityTreeElement>(element)->forEachEntity([&](EntityItemPointer entity) {
+                entities.push_back(entity);
+            });
+            return true;
+        });
+    });
+    return entities;
+}
+
+// each entity is in an element with the same bounds in both trees
+void compareTrees(EntityTreePointer expected, EntityTreePointer actual) {
+    auto expectedEntities = getEntities(expected);
+    QVERIFY(!expectedEntities.isEmpty());
+    QCOMPARE(getEntities(actual).size(), expectedEntities.size());
+
+    actual->withReadLock([&] {
+        for (const auto& expectedEntity : expectedEntities) {
+            auto entity = actual->findEntityByEntityItemID(expectedEntity->getEntityItemID());
+            QVERIFY(entity);
+            QCOMPARE(entity->getName(), expectedEntity->getName());
+            QCOMPARE(entity->getWorldPosition(), expectedEntity->getWorldPosition());
+            QVERIFY(entity->getElement());
+            QCOMPARE(entity->getElement()->getAACube(), expectedEntity->getElement()->getAACube());
+        }
+    });
+}
+
+void EntityStreamLoadTests::initTestCase() {
+    setUpNodeList();
+}
+
+void EntityStreamLoadTests::parsesInChunks() {
+    QByteArray json = "{\n  \"DataVersion\": 3,\n  \"Entities\": [\n"
+        "    { \"name\": \"a \\\"quoted\\\" }\", \"userData\": \"{\\u007b\" },\n"
+        "    { \"name\": \"b\", \"position\": { \"x\": 1 } }\n"
+        "  ],\n  \"Id\": \"{5ab2b1a9-1d1e-4f5a-8b3f-2b4f1c7e3a10}\",\n  \"Version\": 120\n}\n";
+
+    OctreeEntitiesFileParser wholeParser;
+    wholeParser.setEntitiesString(json);
+    QVariantMap expected;
+    QVERIFY(wholeParser.parseEntities(expected));
+
+    // a few bytes at a time, so that every token gets split across reads
+    int position = 0;
+    OctreeEntitiesFileParser chunkedParser;
+    chunkedParser.setEntitiesSource([&](char* data, qint64 maxSize) {
+        qint64 size = std::min(std::min(maxSize, (qint64)3), (qint64)(json.size() - position));
+        memcpy(data, json.constData() + position, size);
+        position += size;
+        return size;
+    });
+    QVariantList entities;
+    chunkedParser.setEntityFunction([&](const char* data, int length) {
+        entities.append(QJsonDocument::fromJson(QByteArray(data, length)).object());
+        return true;
+    });
+    QVariantMap header;
+    QVERIFY2(chunkedParser.parseEntities(header), chunkedParser.getErrorString().c_str());
+
+    QCOMPARE(header["DataVersion"], expected["DataVersion"]);
+    QCOMPARE(header["Id"], expected["Id"]);
+    QCOMPARE(header["Version"], expected["Version"]);
+    QVERIFY(!header.contains("Entities"));
+    QCOMPARE(entities, expected["Entities"].toList());
+}
+
+void EntityStreamLoadTests::addsEntitiesInBatches() {
+    QVector<EntityItemID> entityIDs;
+    QVector<EntityItemProperties> properties;
+    makeSpreadEntities(2000, entityIDs, properties);
+    // an entity already in the batch isn't added twice
+    entityIDs.push_back(entityIDs[5]);
+    properties.push_back(properties[5]);
+
+    auto expected = makeEmptyTree();
+    expected->withWriteLock([&] {
+        for (int i = 0; i < 2000; ++i) {
+            expected->addEntity(entityIDs[i], properties[i]);
+        }
+    });
+
+    auto tree = makeEmptyTree();
+    QVector<EntityItemPointer> entities;
+    tree->withWriteLock([&] {
+        entities = tree->addEntities(entityIDs, properties);
+    });
+
+    QCOMPARE(entities.size(), entityIDs.size());
+    for (int i = 0; i < 2000; ++i) {
+        QVERIFY(entities[i]);
+    }
+    QVERIFY(!entities.last());
+    compareTrees(expected, tree);
+
+    // entities already in the tree aren't added again
+    tree->withWriteLock([&] {
+        entities = tree->addEntities({ entityIDs[0] }, { properties[0] });
+    });
+    QVERIFY(!entities[0]);
+}
+
+void EntityStreamLoadTests::streamsGzippedFile() {
+    QTemporaryDir directory;
+    QVERIFY(directory.isValid());
+
+    auto expected = makeTree(3000);
+    auto fileName = writeTree(expected, directory.filePath("models"));
+    QVERIFY(!fileName.isEmpty());
+
+    auto tree = makeEmptyTree();
+    bool success = false;
+    tree->withWriteLock([&] {
+        success = tree->readFromFile(fileName.toLocal8Bit().constData());
+    });
+    QVERIFY(success);
+    compareTrees(expected, tree);
+}
+
+void EntityStreamLoadTests::readsHeaderWithoutEntities() {
+    QTemporaryDir directory;
+    QVERIFY(directory.isValid());
+
+    auto expected = makeTree(1000);
+    QUuid id = QUuid::createUuid();
+    expected->setOctreeVersionInfo(id, 42);
+    auto fileName = writeTree(expected, directory.filePath("models"));
+    QVERIFY(!fileName.isEmpty());
+
+    // as the persist thread reads it before asking the domain server for newer data
+    OctreeUtils::RawEntityData data;
+    QVERIFY(data.readOctreeDataHeaderFromFile(fileName));
+    QCOMPARE(data.id, id);
+    QCOMPARE(data.dataVersion, (OctreeUtils::Version)42);
+    QVERIFY(data.version > 0);
+    QVERIFY(data.variantEntityData.isEmpty());
+
+    // replacement data is written as is, so a gzipped file may not have the extension for it
+    QString plainFileName = directory.filePath("replaced.json");
+    QVERIFY(QFile::copy(fileName, plainFileName));
+    OctreeUtils::RawOctreeData plainData;
+    QVERIFY(plainData.readOctreeDataHeaderFromFile(plainFileName));
+    QCOMPARE(plainData.id, id);
+
+    auto tree = makeEmptyTree();
+    bool success = false;
+    tree->withWriteLock([&] {
+        success = tree->readFromFile(plainFileName.toLocal8Bit().constData());
+    });
+    QVERIFY(success);
+    compareTrees(expected, tree);
+}
+
+void EntityStreamLoadTests::streamsSameAsMap() {
+    auto expected = makeTree(1500);
+    QByteArray json;
+    expected->withReadLock([&] {
+        QVERIFY(expected->toJSON(&json));
+    });
+
+    // the models file from memory, as imports pass it
+    auto tree = makeEmptyTree();
+    bool success = false;
+    tree->withWriteLock([&] {
+        QDataStream jsonStream(json);
+        success = tree->readFromStream(-1, jsonStream);
+    });
+    QVERIFY(success);
+    compareTrees(expected, tree);
+
+    // and through the whole map
+    OctreeEntitiesFileParser parser;
+    parser.setEntitiesString(json);
+    QVariantMap map;
+    QVERIFY(parser.parseEntities(map));
+    auto mapTree = makeEmptyTree();
+    mapTree->withWriteLock([&] {
+        success = mapTree->readFromMap(map);
+    });
+    QVERIFY(success);
+    compareTrees(tree, mapTree);
+}
+
+void EntityStreamLoadTests::rejectsIllFormedEntity() {
+    // the ill-formed entity still has balanced braces, so it is only found once the batches before it were added
+    const int NUM_ENTITIES = 3000;
+    const int ILL_FORMED_INDEX = 1500;
+    QByteArray json = "{ \"DataVersion\": 1, \"Entities\": [ ";
+    for (int i = 0; i < NUM_ENTITIES; i++) {
+        if (i > 0) {
+            json += ", ";
+        }
+        if (i == ILL_FORMED_INDEX) {
+            json += "{ \"type\": \"Box\", \"name\": nope }";
+        } else {
+            json += QString("{ \"id\": \"%1\", \"type\": \"Box\" }").arg(QUuid::createUuid().toString()).toUtf8();
+        }
+    }
+    json += " ], \"Version\": 120 }";
+    QByteArray gzipped;
+    QVERIFY(gzip(json, gzipped));
+
+    QTemporaryDir directory;
+    QVERIFY(directory.isValid());
+    QFile file(directory.filePath("models.json.gz"));
+    QVERIFY(file.open(QIODevice::WriteOnly));
+    file.write(gzipped.left(gzipped.size() / 2));
+    file.close();
+
+    auto tree = makeEmptyTree();
+    bool success = true;
+    tree->withWriteLock([&] {
+        // truncated
+        success = tree->readFromFile(file.fileName().toLocal8Bit().constData());
+    });
+    QVERIFY(!success);
+    QVERIFY(getEntities(tree).isEmpty());
+
+    QVERIFY(file.open(QIODevice::WriteOnly));
+    file.write(gzipped);
+    file.close();
+    tree->withWriteLock([&] {
+        success = tree->readFromFile(file.fileName().toLocal8Bit().constData());
+    });
+    QVERIFY(!success);
+    QVERIFY(getEntities(tree).isEmpty());
+}
+
+void EntityStreamLoadTests::benchmarkStreamedLoad() {
+    QTemporaryDir directory;
+    QVERIFY(directory.isValid());
+    auto fileName = writeTree(makeTree(20000), directory.filePath("models"));
+    QVERIFY(!fileName.isEmpty());
+
+    QBENCHMARK {
+        auto tree = makeEmptyTree();
+        tree->withWriteLock([&] {
+            tree->readFromFile(fileName.toLocal8Bit().constData());
+        });
+    }
+}
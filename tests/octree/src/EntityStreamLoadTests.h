@@ -0,0 +1,30 @@
+//
+//  EntityStreamLoadTests.h
+//  tests/octree/src
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_EntityStreamLoadTests_h
+#define hifi_EntityStreamLoadTests_h
+
+#include <QtTest/QtTest>
+
+class EntityStreamLoadTests : public QObject {
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void parsesInChunks();
+    void addsEntitiesInBatches();
+    void streamsGzippedFile();
+    void readsHeaderWithoutEntities();
+    void streamsSameAsMap();
+    void rejectsIllFormedEntity();
+    void benchmarkStreamedLoad();
+};
+
+#endif // hifi_EntityStreamLoadTests_h
@@ -0,0 +1,78 @@
+//
+//  EntityTreeTestUtils.h
+//  tests/octree/src
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_EntityTreeTestUtils_h
+#define hifi_EntityTreeTestUtils_h
+
+#include <functional>
+
+#include <QtCore/QVector>
+
+#include <AccountManager.h>
+#include <AddressManager.h>
+#include <DependencyManager.h>
+#include <EntityTree.h>
+#include <NodeList.h>
+#include <SharedUtil.h>
+
+// Fixtures shared by the entity tree tests.
+namespace EntityTreeTestUtils {
+
+const float WORLD_SIZE = 1000.0f;
+
+// entity trees reach the node list while they add entities, call this from initTestCase()
+inline void setUpNodeList() {
+    DependencyManager::registerInheritance<LimitedNodeList, NodeList>();
+    DependencyManager::set<AccountManager>();
+    DependencyManager::set<AddressManager>();
+    DependencyManager::set<NodeList>(NodeType::Agent);
+}
+
+inline EntityTreePointer makeEmptyTree() {
+    auto tree = std::make_shared<EntityTree>();
+    tree->createRootElement();
+    tree->setIsServer(true);
+    return tree;
+}
+
+using EntityPropertiesSetter = std::function<void(int index, EntityItemProperties& properties)>;
+
+// The same entities every run: boxes and spheres named "Entity <index>", with setProperties filling in the rest.
+// The random numbers are seeded here, so setProperties can use randFloatInRange().
+inline void makeEntities(int numEntities, const EntityPropertiesSetter& setProperties, QVector<EntityItemID>& entityIDs,
+        QVector<EntityItemProperties>& properties) {
+    qsrand(1);
+    for (int i = 0; i < numEntities; i++) {
+        EntityItemProperties entityProperties;
+        entityProperties.setType(i % 2 == 0 ? EntityTypes::Box : EntityTypes::Sphere);
+        entityProperties.setName(QString("Entity %1").arg(i));
+        setProperties(i, entityProperties);
+        entityIDs.push_back(EntityItemID(QUuid::createUuid()));
+        properties.push_back(entityProperties);
+    }
+}
+
+// adds the entities one at a time, returns how many of them the tree took
+inline int addEntities(EntityTreePointer tree, const QVector<EntityItemID>& entityIDs,
+        const QVector<EntityItemProperties>& properties) {
+    int numAdded = 0;
+    tree->withWriteLock([&] {
+        for (int i = 0; i < entityIDs.size(); ++i) {
+            if (tree->addEntity(entityIDs[i], properties[i])) {
+                numAdded++;
+            }
+        }
+    });
+    return numAdded;
+}
+
+}
+
+#endif // hifi_EntityTreeTestUtils_h
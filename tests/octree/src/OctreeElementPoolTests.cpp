@@ -0,0 +1,142 @@
+//
+//  OctreeElementPoolTests.cpp
+//  tests/octree/src
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "OctreeElementPoolTests.h"
+
+#include <vector>
+
+#include <OctreeElementPool.h>
+
+QTEST_MAIN(OctreeElementPoolTests)
+
+namespace {
+
+// stands in for an element, the pools are per block size and alignment so each tag gets a different size to keep
+// the tests from seeing each other's blocks
+template <int Tag>
+class TestElement {
+public:
+    TestElement(int value) : value(value) { ++liveCount; }
+    virtual ~TestElement() { --liveCount; }
+
+    int value;
+    char padding[100 + Tag * alignof(void*)];
+
+    static int liveCount;
+};
+
+template <int Tag>
+int TestElement<Tag>::liveCount = 0;
+
+}
+
+void OctreeElementPoolTests::contiguousAllocation() {
+    using Element = TestElement<0>;
+    auto& pool = OctreeElementPool<Element>::getInstance();
+
+    const int NUM_BLOCKS = 10;
+    std::vector<char*> blocks;
+    for (int i = 0; i < NUM_BLOCKS; ++i) {
+        blocks.push_back(static_cast<char*>(pool.allocate()));
+    }
+
+    // consecutive elements come from the same slab, side by side
+    for (int i = 1; i < NUM_BLOCKS; ++i) {
+        QCOMPARE((size_t)(blocks[i] - blocks[i - 1]), sizeof(Element));
+        QCOMPARE((size_t)blocks[i] % alignof(Element), (size_t)0);
+    }
+
+    for (auto block : blocks) {
+        pool.deallocate(block);
+    }
+}
+
+void OctreeElementPoolTests::recycledBlocks() {
+    using Element = TestElement<1>;
+    auto& pool = OctreeElementPool<Element>::getInstance();
+
+    void* first = pool.allocate();
+    size_t reservedMemory = pool.getReservedMemory();
+    QVERIFY(reservedMemory >= sizeof(Element));
+
+    pool.deallocate(first);
+    QCOMPARE(pool.allocate(), first);
+
+    // churning through elements doesn't grow the pool
+    for (int i = 0; i < 1000; ++i) {
+        pool.deallocate(pool.allocate());
+    }
+    QCOMPARE(pool.getReservedMemory(), reservedMemory);
+
+    pool.deallocate(first);
+}
+
+void OctreeElementPoolTests::pooledSharedPointer() {
+    using Element = TestElement<2>;
+
+    std::weak_ptr<Element> weakElement;
+    void* address = nullptr;
+    {
+        auto element = adoptPooledOctreeElement(new (allocatePooledOctreeElement<Element>()) Element(42));
+        QCOMPARE(element->value, 42);
+        QCOMPARE(Element::liveCount, 1);
+        address = element.get();
+
+        // shared ownership works as usual
+        std::shared_ptr<Element> copy = element;
+        weakElement = copy;
+        QCOMPARE(element.use_count(), 2L);
+    }
+
+    // destroyed by the last owner, its block back in the pool
+    QVERIFY(weakElement.expired());
+    QCOMPARE(Element::liveCount, 0);
+
+    auto& pool = OctreeElementPool<Element>::getInstance();
+    void* recycled = pool.allocate();
+    QCOMPARE(recycled, address);
+    pool.deallocate(recycled);
+}
+
+void OctreeElementPoolTests::releasesEmptySlabs() {
+    using Element = TestElement<3>;
+    using Pool = OctreeElementPool<Element>;
+    auto& pool = Pool::getInstance();
+    const size_t BLOCKS_PER_SLAB = Pool::BLOCKS_PER_SLAB;
+    const size_t NUM_SLABS = 4;
+
+    std::vector<void*> blocks;
+    for (size_t i = 0; i < NUM_SLABS * BLOCKS_PER_SLAB; ++i) {
+        blocks.push_back(pool.allocate());
+    }
+    size_t slabSize = pool.getReservedMemory() / NUM_SLABS;
+    QCOMPARE(pool.getReservedMemory(), NUM_SLABS * slabSize);
+
+    // a slab with any block still in use is kept
+    for (size_t i = 0; i < NUM_SLABS * BLOCKS_PER_SLAB; i += BLOCKS_PER_SLAB) {
+        for (size_t j = 1; j < BLOCKS_PER_SLAB; ++j) {
+            pool.deallocate(blocks[i + j]);
+        }
+    }
+    QCOMPARE(pool.getReservedMemory(), NUM_SLABS * slabSize);
+
+    // once they are empty only one spare slab is kept
+    for (size_t i = 0; i < NUM_SLABS * BLOCKS_PER_SLAB; i += BLOCKS_PER_SLAB) {
+        pool.deallocate(blocks[i]);
+    }
+    QCOMPARE(pool.getReservedMemory(), slabSize);
+
+    // which is used again rather than allocating a new one
+    void* block = pool.allocate();
+    pool.deallocate(pool.allocate());
+    QCOMPARE(pool.getReservedMemory(), slabSize);
+    pool.deallocate(block);
+    QCOMPARE(pool.getReservedMemory(), slabSize);
+}
@@ -0,0 +1,26 @@
+//
+//  OctreeElementPoolTests.h
+//  tests/octree/src
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_OctreeElementPoolTests_h
+#define hifi_OctreeElementPoolTests_h
+
+#include <QtTest/QtTest>
+
+class OctreeElementPoolTests : public QObject {
+    Q_OBJECT
+
+private slots:
+    void contiguousAllocation();
+    void recycledBlocks();
+    void pooledSharedPointer();
+    void releasesEmptySlabs();
+};
+
+#endif // hifi_OctreeElementPoolTests_h
@@ -0,0 +1,239 @@
+//
+//  PickCacheOptimizerTests.cpp
+//  tests/pointers/src
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "PickCacheOptimizerTests.h"
+
+#include <atomic>
+
+#include <GeometryUtil.h>
+#include <PickCacheOptimizer.h>
+#include <RegisteredMetaTypes.h>
+#include <SharedUtil.h>
+
+QTEST_MAIN(PickCacheOptimizerTests)
+
+namespace {
+
+class TestPickResult : public PickResult {
+public:
+    TestPickResult(const QVariantMap& pickVariant) : PickResult(pickVariant) {}
+    TestPickResult(const QUuid& objectID, float distance, const QVariantMap& pickVariant) :
+        PickResult(pickVariant), objectID(objectID), distance(distance), intersects(true) {}
+
+    QVariantMap toVariantMap() const override {
+        QVariantMap result = pickVariant;
+        result["objectID"] = objectID;
+        result["distance"] = distance;
+        result["intersects"] = intersects;
+        return result;
+    }
+
+    bool doesIntersect() const override { return intersects; }
+    bool checkOrFilterAgainstMaxDistance(float maxDistance) override { return distance < maxDistance; }
+
+    PickResultPointer compareAndProcessNewResult(const PickResultPointer& newRes) override {
+        auto newTestRes = std::static_pointer_cast<TestPickResult>(newRes);
+        if (newTestRes->distance < distance) {
+            return std::make_shared<TestPickResult>(*newTestRes);
+        } else {
+            return std::make_shared<TestPickResult>(*this);
+        }
+    }
+
+    QUuid objectID;
+    float distance { FLT_MAX };
+    bool intersects { false };
+};
+
+class Target {
+public:
+    QUuid id;
+    glm::vec3 position;
+    float radius;
+};
+
+std::vector<Target> makeTargets(int numTargets) {
+    std::vector<Target> targets;
+    for (int i = 0; i < numTargets; ++i) {
+        targets.push_back({ QUuid::createUuid(), glm::vec3(randFloatInRange(-10.0f, 10.0f), randFloatInRange(-10.0f, 10.0f),
+            randFloatInRange(5.0f, 50.0f)), randFloatInRange(0.5f, 3.0f) });
+    }
+    return targets;
+}
+
+// counts the intersections of picks that aren't thread safe made off the main thread
+std::atomic<int> unsafeIntersectionsOffMainThread { 0 };
+
+// picks spheres, the HUD being everything above the horizon at a fixed distance
+class TestPick : public Pick<PickRay> {
+public:
+    TestPick(const PickRay& ray, const PickFilter& filter, float maxDistance, bool enabled, bool threadSafe,
+             const std::vector<Target>& entities, const std::vector<Target>& avatars) :
+        Pick(ray, filter, maxDistance, enabled),
+        _threadSafe(threadSafe),
+        _entities(entities),
+        _avatars(avatars) {
+    }
+
+    PickRay getMathematicalPick() const override { return _mathPick; }
+    PickResultPointer getDefaultResult(const QVariantMap& pickVariant) const override {
+        return std::make_shared<TestPickResult>(pickVariant);
+    }
+
+    PickResultPointer getEntityIntersection(const PickRay& pick) override {
+        if (!_threadSafe && QThread::currentThread() != qApp->thread()) {
+            unsafeIntersectionsOffMainThread++;
+        }
+        return intersect(pick, _entities);
+    }
+
+    PickResultPointer getAvatarIntersection(const PickRay& pick) override {
+        if (QThread::currentThread() != qApp->thread()) {
+            unsafeIntersectionsOffMainThread++;
+        }
+        return intersect(pick, _avatars);
+    }
+
+    PickResultPointer getHUDIntersection(const PickRay& pick) override {
+        const float HUD_DISTANCE = 20.0f;
+        if (pick.direction.y > 0.0f) {
+            return std::make_shared<TestPickResult>(QUuid(), HUD_DISTANCE, pick.toVariantMap());
+        }
+        return getDefaultResult(pick.toVariantMap());
+    }
+
+    Transform getResultTransform() const override { return Transform(); }
+    bool isThreadSafe() const override { return _threadSafe; }
+
+private:
+    PickResultPointer intersect(const PickRay& pick, const std::vector<Target>& targets) const {
+        auto include = getIncludeItems();
+        auto ignore = getIgnoreItems();
+        auto result = std::make_shared<TestPickResult>(pick.toVariantMap());
+        for (const auto& target : targets) {
+            if ((!include.isEmpty() && !include.contains(target.id)) || ignore.contains(target.id)) {
+                continue;
+            }
+            float distance;
+            if (findRaySphereIntersection(pick.origin, pick.direction, target.position, target.radius, distance) &&
+                    distance < result->distance) {
+                result = std::make_shared<TestPickResult>(target.id, distance, pick.toVariantMap());
+            }
+        }
+        return result;
+    }
+
+    bool _threadSafe;
+    const std::vector<Target>& _entities;
+    const std::vector<Target>& _avatars;
+};
+
+class TestPickCacheOptimizer : public PickCacheOptimizer<PickRay> {
+public:
+    const PickCache& getResults() const { return _results; }
+};
+
+using Picks = std::unordered_map<uint32_t, std::shared_ptr<PickQuery>>;
+
+// The same picks every run: a few rays shared by several picks, with different filters, include and ignore lists and
+// maximum distances, some of them disabled or not thread safe
+Picks makePicks(int numPicks, const std::vector<Target>& entities, const std::vector<Target>& avatars) {
+    const std::vector<PickFilter::Flags> filters = {
+        PickFilter::Flags(),
+        PickFilter::Flags(PickFilter::getBitMask(PickFilter::DOMAIN_ENTITIES)),
+        PickFilter::Flags(PickFilter::getBitMask(PickFilter::AVATARS)),
+        PickFilter::Flags(PickFilter::getBitMask(PickFilter::DOMAIN_ENTITIES) | PickFilter::getBitMask(PickFilter::HUD)),
+        PickFilter::Flags(PickFilter::getBitMask(PickFilter::LOCAL_ENTITIES) | PickFilter::getBitMask(PickFilter::AVATARS) |
+            PickFilter::getBitMask(PickFilter::COARSE)),
+    };
+    const std::vector<float> maxDistances = { 0.0f, 0.0f, 15.0f, 100.0f, -1.0f };
+
+    std::vector<PickRay> rays;
+    for (int i = 0; i < numPicks / 4; ++i) {
+        rays.push_back(PickRay(glm::vec3(randFloatInRange(-2.0f, 2.0f), randFloatInRange(-2.0f, 2.0f), 0.0f),
+            glm::normalize(glm::vec3(randFloatInRange(-0.3f, 0.3f), randFloatInRange(-0.3f, 0.3f), 1.0f))));
+    }
+
+    Picks picks;
+    for (int i = 0; i < numPicks; ++i) {
+        auto pick = std::make_shared<TestPick>(rays[i % rays.size()], PickFilter(filters[i % filters.size()]),
+            maxDistances[(i / 3) % maxDistances.size()], i % 11 != 0, i % 3 != 0, entities, avatars);
+        if (i % 7 == 0) {
+            pick->setIgnoreItems({ entities[i % entities.size()].id, avatars[i % avatars.size()].id });
+        } else if (i % 13 == 0) {
+            pick->setIncludeItems({ entities[i % entities.size()].id });
+        }
+        picks[i + 1] = pick;
+    }
+    return picks;
+}
+
+}
+
+void PickCacheOptimizerTests::parallelMatchesSerial() {
+    qsrand(1);
+    auto entities = makeTargets(200);
+    auto avatars = makeTargets(20);
+    Picks picks = makePicks(400, entities, avatars);
+
+    for (bool shouldPickHUD : { true, false }) {
+        TestPickCacheOptimizer serialOptimizer;
+        uint32_t nextToUpdate = 0;
+        serialOptimizer.update(picks, nextToUpdate, std::numeric_limits<uint64_t>::max(), shouldPickHUD);
+        std::unordered_map<uint32_t, PickResultPointer> expectedResults;
+        for (const auto& entry : picks) {
+            expectedResults[entry.first] = entry.second->getPrevPickResult();
+        }
+
+        TestPickCacheOptimizer parallelOptimizer;
+        parallelOptimizer.updateParallel(picks, shouldPickHUD);
+
+        int intersectingPicks = 0;
+        for (const auto& entry : picks) {
+            auto expected = expectedResults[entry.first];
+            auto result = entry.second->getPrevPickResult();
+            QVERIFY(expected && result);
+            QVERIFY(result != expected);
+            QCOMPARE(result->doesIntersect(), expected->doesIntersect());
+            QCOMPARE(result->toVariantMap(), expected->toVariantMap());
+            intersectingPicks += expected->doesIntersect() ? 1 : 0;
+        }
+        // enough of the picks hit something for the comparison to mean anything
+        QVERIFY(intersectingPicks > 40);
+
+        const auto& expectedCache = serialOptimizer.getResults();
+        const auto& cache = parallelOptimizer.getResults();
+        QCOMPARE(cache.size(), expectedCache.size());
+        for (const auto& expectedEntry : expectedCache) {
+            auto entry = cache.find(expectedEntry.first);
+            QVERIFY(entry != cache.end());
+            QCOMPARE(entry->second.size(), expectedEntry.second.size());
+            for (const auto& expectedResult : expectedEntry.second) {
+                auto result = entry->second.find(expectedResult.first);
+                QVERIFY(result != entry->second.end());
+                QCOMPARE(result->second->toVariantMap(), expectedResult.second->toVariantMap());
+            }
+        }
+    }
+}
+
+void PickCacheOptimizerTests::unsafePicksStayOnMainThread() {
+    qsrand(2);
+    auto entities = makeTargets(500);
+    auto avatars = makeTargets(20);
+    Picks picks = makePicks(2000, entities, avatars);
+
+    unsafeIntersectionsOffMainThread = 0;
+    TestPickCacheOptimizer optimizer;
+    for (int i = 0; i < 10; ++i) {
+        optimizer.updateParallel(picks, true);
+    }
+    QCOMPARE(unsafeIntersectionsOffMainThread.load(), 0);
+}
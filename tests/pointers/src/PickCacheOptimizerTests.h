@@ -0,0 +1,24 @@
+//
+//  PickCacheOptimizerTests.h
+//  tests/pointers/src
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_PickCacheOptimizerTests_h
+#define hifi_PickCacheOptimizerTests_h
+
+#include <QtTest/QtTest>
+
+class PickCacheOptimizerTests : public QObject {
+    Q_OBJECT
+
+private slots:
+    void parallelMatchesSerial();
+    void unsafePicksStayOnMainThread();
+};
+
+#endif // hifi_PickCacheOptimizerTests_h
@@ -0,0 +1,173 @@
+//
+//  MeshBlendshapesTests.cpp
+//  tests/render-utils/src
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "MeshBlendshapesTests.h"
+
+#include <cmath>
+
+#include <glm/gtc/packing.hpp>
+
+#include <GLMHelpers.h>
+#include <MeshBlendshapes.h>
+#include <Model.h>
+#include <SharedUtil.h>
+
+QTEST_MAIN(MeshBlendshapesTests)
+
+namespace {
+
+// what the blender packed before MeshBlendshapes
+glm::uvec4 referencePack(const glm::vec3& position, const glm::vec3& normal, const glm::vec3& tangent) {
+    float len = glm::compMax(glm::abs(position));
+    glm::vec3 normalizedPos(position);
+    if (len > 1.0f) {
+        normalizedPos /= len;
+    } else {
+        len = 1.0f;
+    }
+
+    return glm::uvec4(
+        glm::floatBitsToUint(len),
+        glm::packSnorm3x10_1x2(glm::vec4(normalizedPos, 0.0f)),
+        glm::packSnorm3x10_1x2(glm::vec4(normal, 0.0f)),
+        glm::packSnorm3x10_1x2(glm::vec4(tangent, 0.0f))
+    );
+}
+
+void comparePack(const glm::vec3& position, const glm::vec3& normal, const glm::vec3& tangent) {
+    glm::uvec4 packed;
+    MeshBlendshapes::packOffset(position, normal, tangent, packed);
+    glm::uvec4 expected = referencePack(position, normal, tangent);
+    QVERIFY2(packed == expected, qPrintable(QString("(%1, %2, %3) (%4, %5, %6) (%7, %8, %9)")
+        .arg(position.x).arg(position.y).arg(position.z).arg(normal.x).arg(normal.y).arg(normal.z)
+        .arg(tangent.x).arg(tangent.y).arg(tangent.z)));
+}
+
+// the summed offsets of each vertex, a blendshape at a time, then packed, as the blender did before MeshBlendshapes
+std::vector<glm::uvec4> blendPerBlendshape(const HFMMesh& mesh, const QVector<float>& coefficients) {
+    std::vector<BlendshapeOffsetUnpacked> unpacked(mesh.vertices.size(), { glm::vec3(0.0f), glm::vec3(0.0f), glm::vec3(0.0f) });
+
+    const float NORMAL_COEFFICIENT_SCALE = 0.01f;
+    for (int i = 0, n = qMin(coefficients.size(), mesh.blendshapes.size()); i < n; i++) {
+        float vertexCoefficient = coefficients.at(i);
+        const float EPSILON = 0.0001f;
+        if (vertexCoefficient < EPSILON) {
+            continue;
+        }
+
+        float normalCoefficient = vertexCoefficient * NORMAL_COEFFICIENT_SCALE;
+        const HFMBlendshape& blendshape = mesh.blendshapes.at(i);
+        for (int j = 0; j < blendshape.indices.size(); j++) {
+            auto& offset = unpacked[blendshape.indices.at(j)];
+            offset.positionOffset += blendshape.vertices.at(j) * vertexCoefficient;
+            offset.normalOffset += blendshape.normals.at(j) * normalCoefficient;
+            if (j < blendshape.tangents.size()) {
+                offset.tangentOffset += blendshape.tangents.at(j) * normalCoefficient;
+            }
+        }
+    }
+
+    std::vector<glm::uvec4> packed;
+    for (const auto& offset : unpacked) {
+        packed.push_back(referencePack(offset.positionOffset, offset.normalOffset, offset.tangentOffset));
+    }
+    return packed;
+}
+
+glm::vec3 randVec3(float range) {
+    return glm::vec3(randFloatInRange(-range, range), randFloatInRange(-range, range), randFloatInRange(-range, range));
+}
+
+}
+
+void MeshBlendshapesTests::packsEdgeValues() {
+    const float NaN = std::numeric_limits<float>::quiet_NaN();
+    const float INF = std::numeric_limits<float>::infinity();
+    std::vector<float> values = { 0.0f, -0.0f, 1.0f, -1.0f, 1.0001f, -1.0001f, 2.0f, -3.5f, 1000.0f, -1000.0f, INF, -INF, NaN,
+        FLT_MIN, -FLT_MIN, FLT_MAX, -FLT_MAX };
+    // the values that land exactly halfway between two steps, and right next to them
+    for (int step = -511; step < 511; step++) {
+        float half = ((float)step + 0.5f) / 511.0f;
+        values.push_back(half);
+        values.push_back(std::nextafter(half, -2.0f));
+        values.push_back(std::nextafter(half, 2.0f));
+    }
+
+    for (float value : values) {
+        // each lane in each component, with the other lanes away from the edge
+        comparePack(glm::vec3(value, 0.25f, -0.75f), glm::vec3(value, 0.5f, 0.0f), glm::vec3(value));
+        comparePack(glm::vec3(0.25f, value, 0.5f), glm::vec3(-0.5f, value, 0.125f), glm::vec3(0.0f, value, 0.0f));
+        comparePack(glm::vec3(-0.5f, 0.5f, value), glm::vec3(0.0f, 0.0f, value), glm::vec3(1.0f, -1.0f, value));
+    }
+}
+
+void MeshBlendshapesTests::packsRandomValues() {
+    qsrand(1);
+    for (int i = 0; i < 100000; i++) {
+        float range = (i % 3 == 0) ? 0.01f : (i % 3 == 1) ? 1.0f : 100.0f;
+        comparePack(randVec3(range), randVec3(range / 10.0f), randVec3(range / 10.0f));
+    }
+}
+
+void MeshBlendshapesTests::blendsSameAsPerBlendshape() {
+    qsrand(2);
+    HFMMesh mesh;
+    const int NUM_VERTICES = 3000;
+    for (int i = 0; i < NUM_VERTICES; i++) {
+        mesh.vertices.push_back(randVec3(1.0f));
+    }
+
+    // blendshapes moving overlapping sets of vertices, some of them without tangents
+    const int NUM_BLENDSHAPES = 12;
+    for (int i = 0; i < NUM_BLENDSHAPES; i++) {
+        HFMBlendshape blendshape;
+        for (int index = i % 5; index < NUM_VERTICES; index += 1 + i % 4) {
+            blendshape.indices.push_back(index);
+            blendshape.vertices.push_back(randVec3(i % 2 == 0 ? 0.5f : 2.0f));
+            blendshape.normals.push_back(randVec3(1.0f));
+            if (i % 3 != 0) {
+                blendshape.tangents.push_back(randVec3(1.0f));
+            }
+        }
+        mesh.blendshapes.push_back(blendshape);
+    }
+
+    MeshBlendshapes meshBlendshapes(mesh);
+    QCOMPARE(meshBlendshapes.getNumVertices(), NUM_VERTICES);
+
+    // weights over and under the threshold, some blendshapes past the coefficients and some coefficients past them
+    std::vector<QVector<float>> coefficientSets = {
+        QVector<float>(NUM_BLENDSHAPES, 0.0f),
+        QVector<float>(NUM_BLENDSHAPES, 1.0f),
+        { 0.5f, 0.0f, 0.00005f, 1.0f, 0.25f, 0.0001f, 0.75f },
+        QVector<float>(NUM_BLENDSHAPES + 4, 0.3f),
+    };
+    QVector<float> randomCoefficients;
+    for (int i = 0; i < NUM_BLENDSHAPES; i++) {
+        randomCoefficients.push_back(randFloat());
+    }
+    coefficientSets.push_back(randomCoefficients);
+
+    for (const auto& coefficients : coefficientSets) {
+        std::vector<float> weights;
+        MeshBlendshapes::computeWeights(coefficients, weights);
+
+        // blended in uneven ranges, as the blender splits meshes
+        std::vector<BlendshapeOffsetPacked> offsets(NUM_VERTICES);
+        for (int begin = 0; begin < NUM_VERTICES; begin += 1000) {
+            meshBlendshapes.blend(weights, begin, std::min(begin + 1000, NUM_VERTICES), offsets.data());
+        }
+
+        auto expected = blendPerBlendshape(mesh, coefficients);
+        for (int i = 0; i < NUM_VERTICES; i++) {
+            QVERIFY(offsets[i].packedPosNorTan == expected[i]);
+        }
+    }
+}
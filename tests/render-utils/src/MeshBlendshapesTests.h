@@ -0,0 +1,25 @@
+//
+//  MeshBlendshapesTests.h
+//  tests/render-utils/src
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_MeshBlendshapesTests_h
+#define hifi_MeshBlendshapesTests_h
+
+#include <QtTest/QtTest>
+
+class MeshBlendshapesTests : public QObject {
+    Q_OBJECT
+
+private slots:
+    void packsEdgeValues();
+    void packsRandomValues();
+    void blendsSameAsPerBlendshape();
+};
+
+#endif // hifi_MeshBlendshapesTests_h
@@ -0,0 +1,208 @@
+//
+//  LogHandlerTests.cpp
+//  tests/shared/src
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "LogHandlerTests.h"
+
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <QtCore/QRegExp>
+#include <QtCore/QTemporaryDir>
+
+#include <LogHandler.h>
+
+QTEST_MAIN(LogHandlerTests)
+
+namespace {
+
+const int NUM_THREADS = 4;
+const int MESSAGES_PER_THREAD = 1000;
+
+class CapturingLogSink : public LogSink {
+public:
+    void writeBatch(const std::vector<LogRecord>& records, const QString& text) override {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _records.insert(_records.end(), records.begin(), records.end());
+        _text.append(text);
+    }
+
+    std::vector<LogRecord> takeRecords() {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _text.clear();
+        std::vector<LogRecord> records;
+        records.swap(_records);
+        return records;
+    }
+
+    QString takeText() {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _records.clear();
+        QString text = _text;
+        _text.clear();
+        return text;
+    }
+
+private:
+    std::mutex _mutex;
+    std::vector<LogRecord> _records;
+    QString _text;
+};
+
+std::shared_ptr<CapturingLogSink> sink;
+
+const QMessageLogContext TEST_CONTEXT("LogHandlerTests.cpp", 0, "test", "log.test");
+
+// a different message ends any run of repeats left over from the previous test
+void endRepeats() {
+    LogHandler::getInstance().queueMessage(LogDebug, TEST_CONTEXT, "end of repeats");
+    LogHandler::getInstance().flush();
+}
+
+}
+
+void LogHandlerTests::initTestCase() {
+    sink = std::make_shared<CapturingLogSink>();
+    LogHandler::getInstance().setShouldOutputToStdout(false);
+    LogHandler::getInstance().addSink(sink);
+    LogHandler::getInstance().setAsynchronous(true);
+    QVERIFY(LogHandler::getInstance().isAsynchronous());
+}
+
+void LogHandlerTests::cleanupTestCase() {
+    LogHandler::getInstance().setAsynchronous(false);
+    LogHandler::getInstance().removeSink(sink);
+    LogHandler::getInstance().setShouldOutputToStdout(true);
+    sink.reset();
+}
+
+void LogHandlerTests::init() {
+    endRepeats();
+    sink->takeRecords();
+}
+
+void LogHandlerTests::multipleProducers() {
+    std::vector<std::thread> threads;
+    for (int t = 0; t < NUM_THREADS; t++) {
+        threads.emplace_back([t] {
+            for (int i = 0; i < MESSAGES_PER_THREAD; i++) {
+                LogHandler::getInstance().queueMessage(LogInfo, TEST_CONTEXT, QString("thread %1 message %2").arg(t).arg(i));
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    LogHandler::getInstance().flush();
+
+    std::vector<int> nextMessage(NUM_THREADS, 0);
+    for (const auto& record : sink->takeRecords()) {
+        QCOMPARE(record.repeatCount, 1);
+        QCOMPARE(record.type, LogInfo);
+        QCOMPARE(record.category, QByteArray("log.test"));
+
+        QStringList parts = record.message.split(' ');
+        QCOMPARE(parts.size(), 4);
+        int thread = parts[1].toInt();
+        QCOMPARE(parts[3].toInt(), nextMessage[thread]);
+        ++nextMessage[thread];
+    }
+
+    for (int t = 0; t < NUM_THREADS; t++) {
+        QCOMPARE(nextMessage[t], MESSAGES_PER_THREAD);
+    }
+}
+
+void LogHandlerTests::repeatedMessagesCollapse() {
+    const int NUM_REPEATS = 1000;
+    for (int i = 0; i < NUM_REPEATS; i++) {
+        LogHandler::getInstance().queueMessage(LogWarning, TEST_CONTEXT, "Packet hash mismatch");
+    }
+    endRepeats();
+
+    auto records = sink->takeRecords();
+    QCOMPARE((int)records.size(), 3);
+    QCOMPARE(records[0].message, QString("Packet hash mismatch"));
+    QCOMPARE(records[0].repeatCount, 1);
+    QCOMPARE(records[1].message, QString("Packet hash mismatch"));
+    QCOMPARE(records[1].repeatCount, NUM_REPEATS - 1);
+    QCOMPARE(records[2].message, QString("end of repeats"));
+
+    for (int i = 0; i < NUM_REPEATS; i++) {
+        LogHandler::getInstance().queueMessage(LogWarning, TEST_CONTEXT, "Packet hash mismatch");
+    }
+    endRepeats();
+    QString text = sink->takeText();
+    QVERIFY(text.contains(QString("[SUPPRESS] [log.test] %1 repeated log entries - Last entry: \"Packet hash mismatch\"")
+        .arg(NUM_REPEATS - 1)));
+}
+
+void LogHandlerTests::matchesPrintMessage() {
+    LogHandler::getInstance().queueMessage(LogCritical, TEST_CONTEXT, "first line\nsecond line");
+    LogHandler::getInstance().flush();
+    QString queuedText = sink->takeText();
+
+    QString printedText = LogHandler::getInstance().printMessage(LogCritical, TEST_CONTEXT, "first line\nsecond line");
+
+    // the timestamps may differ by a second, compare everything after them
+    auto stripTimestamps = [](QString text) {
+        return text.replace(QRegExp("\\[\\d\\d/\\d\\d \\d\\d:\\d\\d:\\d\\d\\]"), "[]");
+    };
+    QCOMPARE(stripTimestamps(queuedText), stripTimestamps(printedText));
+    QVERIFY(queuedText.contains("[CRITICAL] [log.test] second line"));
+}
+
+void LogHandlerTests::binarySink() {
+    QTemporaryDir temporaryDir;
+    QString filename = temporaryDir.filePath("test.hflog");
+
+    auto binarySink = std::make_shared<BinaryLogSink>(filename);
+    QVERIFY(binarySink->isOpen());
+    LogHandler::getInstance().addSink(binarySink);
+
+    LogHandler::getInstance().queueMessage(LogInfo, TEST_CONTEXT, "first");
+    for (int i = 0; i < 10; i++) {
+        LogHandler::getInstance().queueMessage(LogWarning, TEST_CONTEXT, "repeated");
+    }
+    LogHandler::getInstance().queueMessage(LogDebug, TEST_CONTEXT, "last");
+    LogHandler::getInstance().flush();
+
+    LogHandler::getInstance().removeSink(binarySink);
+    binarySink.reset();
+
+    auto records = BinaryLogSink::readRecords(filename);
+    auto captured = sink->takeRecords();
+    QVERIFY(records.size() >= 4);
+    QCOMPARE(records.size(), captured.size());
+    for (size_t i = 0; i < records.size(); i++) {
+        QCOMPARE(records[i].type, captured[i].type);
+        QCOMPARE(records[i].timestamp, captured[i].timestamp);
+        QCOMPARE(records[i].threadID, captured[i].threadID);
+        QCOMPARE(records[i].category, captured[i].category);
+        QCOMPARE(records[i].message, captured[i].message);
+        QCOMPARE(records[i].repeatCount, captured[i].repeatCount);
+    }
+}
+
+void LogHandlerTests::benchmarkQueueMessage() {
+    int i = 0;
+    QBENCHMARK {
+        LogHandler::getInstance().queueMessage(LogDebug, TEST_CONTEXT, QString("message %1").arg(i++));
+    }
+    LogHandler::getInstance().flush();
+}
+
+void LogHandlerTests::benchmarkQueueRepeatedMessage() {
+    const QString message { "Packet hash mismatch" };
+    QBENCHMARK {
+        LogHandler::getInstance().queueMessage(LogWarning, TEST_CONTEXT, message);
+    }
+    endRepeats();
+}
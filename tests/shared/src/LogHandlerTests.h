@@ -0,0 +1,39 @@
+//
+//  LogHandlerTests.h
+//  tests/shared/src
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_LogHandlerTests_h
+#define hifi_LogHandlerTests_h
+
+#include <QtTest/QtTest>
+
+class LogHandlerTests : public QObject {
+    Q_OBJECT
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+    void init();
+
+    // every message queued from several threads is written once, in order per thread
+    void multipleProducers();
+
+    // a run of identical messages is written as the first message plus a single repeat count
+    void repeatedMessagesCollapse();
+
+    // the written text matches what the synchronous path prints
+    void matchesPrintMessage();
+
+    // records read back from a binary sink match what was queued
+    void binarySink();
+
+    void benchmarkQueueMessage();
+    void benchmarkQueueRepeatedMessage();
+};
+
+#endif // hifi_LogHandlerTests_h
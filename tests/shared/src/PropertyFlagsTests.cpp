@@ -0,0 +1,250 @@
+//
+//  PropertyFlagsTests.cpp
+//  tests/shared/src
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "PropertyFlagsTests.h"
+
+#include <random>
+
+#include <PropertyFlags.h>
+
+QTEST_MAIN(PropertyFlagsTests)
+
+enum TestPropertyList {
+    PROP_TEST_FIRST,
+
+    // about as many properties as entities have, and not a multiple of the word size
+    PROP_TEST_AFTER_LAST = 283
+};
+
+template<> struct PropertyFlagsTraits<TestPropertyList> {
+    static const int FLAG_COUNT = PROP_TEST_AFTER_LAST;
+};
+
+typedef PropertyFlags<TestPropertyList> FixedFlags;
+typedef PropertyFlags<TestPropertyList, 0> BitArrayFlags;
+
+namespace {
+
+const int NUM_RANDOM_OPERATIONS = 100000;
+
+// everything that can be observed from outside the flags
+template<typename Flags>
+QString describe(Flags& flags) {
+    QByteArray encoded = flags.encode();
+    QString result = QString("%1 first=%2 last=%3 empty=%4 none=%5 length=%6 ")
+        .arg(QString(encoded.toHex()))
+        .arg((int)flags.firstFlag())
+        .arg((int)flags.lastFlag())
+        .arg((int)flags.isEmpty())
+        .arg((int)!flags)
+        .arg(flags.getEncodedLength());
+    for (int i = 0; i < PROP_TEST_AFTER_LAST + 8; i++) {
+        result += flags.getHasProperty((TestPropertyList)i) ? "1" : "0";
+    }
+    return result;
+}
+
+void verifyDecode(const QByteArray& encoded) {
+    FixedFlags fixed;
+    BitArrayFlags bitArray;
+    QCOMPARE(fixed.decode(encoded), bitArray.decode(encoded));
+    QCOMPARE(describe(fixed), describe(bitArray));
+}
+
+template<typename Flags>
+Flags createEntityLikeFlags() {
+    Flags flags;
+    for (int i = 0; i < PROP_TEST_AFTER_LAST; i += 3) {
+        flags.setHasProperty((TestPropertyList)i);
+    }
+    return flags;
+}
+
+template<typename Flags>
+int runBenchmarkIteration(const Flags& requested, const Flags& changed) {
+    Flags flags = requested;
+    flags |= changed;
+    flags -= changed;
+    flags += changed;
+    QByteArray encoded = flags.encode();
+    Flags decoded(encoded);
+    int count = 0;
+    decoded.forEachFlag([&](TestPropertyList) {
+        count++;
+    });
+    return count;
+}
+
+}
+
+void PropertyFlagsTests::singleFlagRoundTrip() {
+    for (int i = 0; i < PROP_TEST_AFTER_LAST; i++) {
+        FixedFlags fixed((TestPropertyList)i);
+        BitArrayFlags bitArray((TestPropertyList)i);
+        QCOMPARE(describe(fixed), describe(bitArray));
+        verifyDecode(fixed.encode());
+
+        FixedFlags decoded(fixed.encode());
+        QCOMPARE(decoded, fixed);
+    }
+}
+
+void PropertyFlagsTests::flagPairRoundTrip() {
+    for (int i = 0; i < PROP_TEST_AFTER_LAST; i++) {
+        for (int j = i + 1; j < PROP_TEST_AFTER_LAST; j++) {
+            FixedFlags fixed;
+            BitArrayFlags bitArray;
+            fixed << (TestPropertyList)j << (TestPropertyList)i;
+            bitArray << (TestPropertyList)j << (TestPropertyList)i;
+            QByteArray encoded = fixed.encode();
+            if (encoded != bitArray.encode()) {
+                QFAIL(qPrintable(QString("flags %1 and %2 encoded differently").arg(i).arg(j)));
+            }
+            FixedFlags decoded(encoded);
+            if (decoded != fixed || (int)decoded.firstFlag() != i || (int)decoded.lastFlag() != j) {
+                QFAIL(qPrintable(QString("flags %1 and %2 decoded differently").arg(i).arg(j)));
+            }
+        }
+    }
+}
+
+void PropertyFlagsTests::randomOperations() {
+    std::mt19937 generator(1);
+
+    auto randomize = [&](FixedFlags& fixed, BitArrayFlags& bitArray) {
+        int range = 1 + generator() % PROP_TEST_AFTER_LAST;
+        int count = generator() % 8;
+        for (int i = 0; i < count; i++) {
+            auto flag = (TestPropertyList)(generator() % range);
+            bool value = generator() % 3 != 0;
+            fixed.setHasProperty(flag, value);
+            bitArray.setHasProperty(flag, value);
+        }
+        if (generator() % 4 == 0) {
+            fixed = ~fixed;
+            bitArray = ~bitArray;
+        }
+    };
+
+    for (int i = 0; i < NUM_RANDOM_OPERATIONS; i++) {
+        FixedFlags fixedA, fixedB, fixedResult;
+        BitArrayFlags bitArrayA, bitArrayB, bitArrayResult;
+        randomize(fixedA, bitArrayA);
+        randomize(fixedB, bitArrayB);
+        auto flag = (TestPropertyList)(generator() % PROP_TEST_AFTER_LAST);
+
+        int operation = generator() % 10;
+        switch (operation) {
+            case 0:
+                fixedResult = fixedA | fixedB;
+                bitArrayResult = bitArrayA | bitArrayB;
+                break;
+            case 1:
+                fixedResult = fixedA & fixedB;
+                bitArrayResult = bitArrayA & bitArrayB;
+                break;
+            case 2:
+                fixedResult = fixedA ^ fixedB;
+                bitArrayResult = bitArrayA ^ bitArrayB;
+                break;
+            case 3:
+                fixedResult = fixedA + fixedB;
+                bitArrayResult = bitArrayA + bitArrayB;
+                break;
+            case 4:
+                fixedResult = fixedA - fixedB;
+                bitArrayResult = bitArrayA - bitArrayB;
+                break;
+            case 5:
+                fixedResult = fixedA << fixedB;
+                bitArrayResult = bitArrayA << bitArrayB;
+                break;
+            case 6:
+                fixedResult = fixedA - flag;
+                bitArrayResult = bitArrayA - flag;
+                break;
+            case 7:
+                fixedResult = fixedA | flag;
+                bitArrayResult = bitArrayA | flag;
+                break;
+            case 8:
+                fixedResult = fixedA ^ fixedB;
+                fixedResult += fixedA;
+                fixedResult -= fixedB;
+                fixedResult &= ~fixedA;
+                bitArrayResult = bitArrayA ^ bitArrayB;
+                bitArrayResult += bitArrayA;
+                bitArrayResult -= bitArrayB;
+                bitArrayResult &= ~bitArrayA;
+                break;
+            default:
+                fixedResult = FixedFlags(fixedA);
+                bitArrayResult = BitArrayFlags(bitArrayA);
+                break;
+        }
+
+        QString fixedDescription = describe(fixedResult);
+        QString bitArrayDescription = describe(bitArrayResult);
+        if (fixedDescription != bitArrayDescription) {
+            QFAIL(qPrintable(QString("operation %1 differs\n%2\n%3").arg(operation)
+                .arg(fixedDescription).arg(bitArrayDescription)));
+        }
+        QCOMPARE(fixedResult == fixedA, bitArrayResult == bitArrayA);
+        verifyDecode(fixedResult.encode());
+    }
+}
+
+void PropertyFlagsTests::decodeTruncated() {
+    FixedFlags flags;
+    flags << (TestPropertyList)3 << (TestPropertyList)100;
+    QByteArray encoded = flags.encode();
+
+    FixedFlags truncated;
+    QCOMPARE(truncated.decode(encoded.left(encoded.size() - 2)), (size_t)(encoded.size() - 2));
+    QVERIFY(truncated.getHasProperty((TestPropertyList)3));
+    QVERIFY(!truncated.getHasProperty((TestPropertyList)100));
+
+    // no end to the lead bits
+    FixedFlags leadBitsOnly;
+    QCOMPARE(leadBitsOnly.decode(QByteArray(4, (char)0xFF)), (size_t)4);
+    QVERIFY(!leadBitsOnly);
+
+    // encoded by a peer with more properties than we know about
+    BitArrayFlags newer;
+    newer << (TestPropertyList)10 << (TestPropertyList)(PROP_TEST_AFTER_LAST + 20);
+    QByteArray newerEncoded = newer.encode();
+    FixedFlags older;
+    QCOMPARE(older.decode(newerEncoded), (size_t)newerEncoded.size());
+    QCOMPARE((int)older.lastFlag(), 10);
+}
+
+void PropertyFlagsTests::benchmarkFixedFlags() {
+    auto requested = createEntityLikeFlags<FixedFlags>();
+    FixedFlags changed;
+    changed << (TestPropertyList)2 << (TestPropertyList)80 << (TestPropertyList)200;
+
+    int count = 0;
+    QBENCHMARK {
+        count = runBenchmarkIteration(requested, changed);
+    }
+    QCOMPARE(count, (PROP_TEST_AFTER_LAST + 2) / 3 + 3);
+}
+
+void PropertyFlagsTests::benchmarkBitArrayFlags() {
+    auto requested = createEntityLikeFlags<BitArrayFlags>();
+    BitArrayFlags changed;
+    changed << (TestPropertyList)2 << (TestPropertyList)80 << (TestPropertyList)200;
+
+    int count = 0;
+    QBENCHMARK {
+        count = runBenchmarkIteration(requested, changed);
+    }
+    QCOMPARE(count, (PROP_TEST_AFTER_LAST + 2) / 3 + 3);
+}
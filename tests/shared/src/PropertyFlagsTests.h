@@ -0,0 +1,33 @@
+//
+//  PropertyFlagsTests.h
+//  tests/shared/src
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_PropertyFlagsTests_h
+#define hifi_PropertyFlagsTests_h
+
+#include <QtTest/QtTest>
+
+class PropertyFlagsTests : public QObject {
+    Q_OBJECT
+private slots:
+    // the fixed size flags must encode every single flag and every pair of flags exactly as the QBitArray flags do
+    void singleFlagRoundTrip();
+    void flagPairRoundTrip();
+
+    // random sets of flags through every operator, compared against the QBitArray flags
+    void randomOperations();
+
+    void decodeTruncated();
+
+    // an entity sized set of flags, copied, merged, encoded and decoded
+    void benchmarkFixedFlags();
+    void benchmarkBitArrayFlags();
+};
+
+#endif // hifi_PropertyFlagsTests_h
@@ -0,0 +1,235 @@
+//
+//  SpatiallyNestableTests.cpp
+//  tests/shared/src
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "SpatiallyNestableTests.h"
+
+#include <glm/gtc/quaternion.hpp>
+
+#include <GLMHelpers.h>
+#include <SpatiallyNestable.h>
+
+#include <test-utils/GLMTestUtils.h>
+#include <test-utils/QTestExtensions.h>
+
+QTEST_MAIN(SpatiallyNestableTests)
+
+namespace {
+
+const float TEST_EPSILON = 0.001f;
+
+const int NUM_BENCHMARK_NESTABLES = 10000;
+const int BENCHMARK_CHAIN_DEPTH = 25; // the parenting chain is limited to 30
+
+class TestParentFinder : public SpatialParentFinder {
+public:
+    SpatiallyNestableWeakPointer find(QUuid parentID, bool& success, SpatialParentTree* entityTree = nullptr) const override {
+        auto it = _nestables.find(parentID);
+        success = parentID.isNull() || it != _nestables.end();
+        return it != _nestables.end() ? it.value() : SpatiallyNestableWeakPointer();
+    }
+
+    QHash<QUuid, SpatiallyNestableWeakPointer> _nestables;
+};
+
+// a nestable with a single joint that can move without its children being told, like an avatar's
+class JointedNestable : public SpatiallyNestable {
+public:
+    JointedNestable() : SpatiallyNestable(NestableType::Avatar, QUuid::createUuid()) {}
+
+    glm::vec3 getAbsoluteJointTranslationInObjectFrame(int index) const override {
+        return index == 0 ? jointTranslation : glm::vec3();
+    }
+
+    glm::vec3 jointTranslation;
+};
+
+using Chain = std::vector<SpatiallyNestablePointer>;
+
+void addNestable(const SpatiallyNestablePointer& nestable) {
+    DependencyManager::get<TestParentFinder>()->_nestables[nestable->getID()] = nestable;
+}
+
+Chain createChain(int depth, const glm::vec3& rootPosition) {
+    const glm::quat LINK_ROTATION = glm::angleAxis(0.1f, glm::normalize(glm::vec3(1.0f, 2.0f, 3.0f)));
+
+    Chain chain;
+    for (int i = 0; i < depth; ++i) {
+        auto nestable = std::make_shared<SpatiallyNestable>(NestableType::Entity, QUuid::createUuid());
+        addNestable(nestable);
+        if (chain.empty()) {
+            nestable->setLocalPosition(rootPosition);
+        } else {
+            nestable->setParentID(chain.back()->getID());
+            nestable->setLocalPosition(glm::vec3(0.0f, 0.5f, 0.1f * i));
+            nestable->setLocalOrientation(LINK_ROTATION);
+        }
+        chain.push_back(nestable);
+    }
+    return chain;
+}
+
+// the world transform the long way, from the local transforms
+Transform expectedTransform(const Chain& chain, size_t index) {
+    Transform result;
+    for (size_t i = 0; i <= index; ++i) {
+        Transform::mult(result, result, chain[i]->getLocalTransform());
+    }
+    return result;
+}
+
+void verifyChain(const Chain& chain) {
+    for (size_t i = 0; i < chain.size(); ++i) {
+        bool success = false;
+        auto transform = chain[i]->getTransform(success);
+        QVERIFY(success);
+        auto expected = expectedTransform(chain, i);
+        QCOMPARE_WITH_ABS_ERROR(transform.getTranslation(), expected.getTranslation(), TEST_EPSILON);
+        QCOMPARE_WITH_ABS_ERROR(transform.getRotation(), expected.getRotation(), TEST_EPSILON);
+    }
+}
+
+std::vector<Chain> createBenchmarkHierarchy() {
+    std::vector<Chain> chains;
+    for (int i = 0; i < NUM_BENCHMARK_NESTABLES / BENCHMARK_CHAIN_DEPTH; ++i) {
+        chains.push_back(createChain(BENCHMARK_CHAIN_DEPTH, glm::vec3((float)i, 0.0f, 0.0f)));
+    }
+    return chains;
+}
+
+glm::vec3 sumWorldPositions(const std::vector<Chain>& chains) {
+    glm::vec3 sum;
+    for (auto& chain : chains) {
+        for (auto& nestable : chain) {
+            sum += nestable->getWorldPosition();
+        }
+    }
+    return sum;
+}
+
+}
+
+void SpatiallyNestableTests::initTestCase() {
+    DependencyManager::registerInheritance<SpatialParentFinder, TestParentFinder>();
+    DependencyManager::set<TestParentFinder>();
+}
+
+void SpatiallyNestableTests::cleanupTestCase() {
+    DependencyManager::destroy<TestParentFinder>();
+}
+
+void SpatiallyNestableTests::parentChainChanges() {
+    auto chain = createChain(10, glm::vec3(1.0f, 2.0f, 3.0f));
+    verifyChain(chain);
+
+    // again, now from the cache
+    verifyChain(chain);
+
+    chain.front()->setWorldPosition(glm::vec3(-5.0f, 0.0f, 5.0f));
+    verifyChain(chain);
+
+    chain[4]->setLocalOrientation(glm::angleAxis(1.0f, Vectors::UNIT_Y));
+    verifyChain(chain);
+
+    chain[6]->setLocalSNScale(glm::vec3(2.0f));
+    verifyChain(chain);
+
+    Transform rootTransform;
+    rootTransform.setTranslation(glm::vec3(10.0f, 0.0f, 0.0f));
+    rootTransform.setRotation(glm::angleAxis(0.5f, Vectors::UNIT_X));
+    chain.front()->setLocalTransformAndVelocities(rootTransform, glm::vec3(), glm::vec3());
+    verifyChain(chain);
+}
+
+void SpatiallyNestableTests::reparenting() {
+    auto first = createChain(5, glm::vec3(1.0f, 0.0f, 0.0f));
+    auto second = createChain(5, glm::vec3(0.0f, 0.0f, -7.0f));
+    verifyChain(first);
+    verifyChain(second);
+
+    // move the tail of the first chain over to the second one
+    Chain moved(second.begin(), second.end());
+    moved.insert(moved.end(), first.begin() + 2, first.end());
+    first.resize(2);
+
+    moved[5]->setParentID(second.back()->getID());
+    verifyChain(first);
+    verifyChain(moved);
+
+    second.front()->setWorldPosition(glm::vec3(3.0f, 3.0f, 3.0f));
+    verifyChain(moved);
+}
+
+void SpatiallyNestableTests::parentDeleted() {
+    auto chain = createChain(3, glm::vec3(1.0f, 0.0f, 0.0f));
+    verifyChain(chain);
+
+    auto child = chain.back();
+    chain.pop_back();
+    chain.back().reset();
+    chain.pop_back();
+
+    // the parent is gone, the child's world transform can't be known any more
+    bool success = true;
+    child->getTransform(success);
+    QVERIFY(!success);
+}
+
+void SpatiallyNestableTests::jointParenting() {
+    auto avatar = std::make_shared<JointedNestable>();
+    addNestable(avatar);
+    avatar->setWorldPosition(glm::vec3(1.0f, 0.0f, 0.0f));
+
+    auto attachment = std::make_shared<SpatiallyNestable>(NestableType::Entity, QUuid::createUuid());
+    addNestable(attachment);
+    attachment->setParentID(avatar->getID());
+    attachment->setParentJointIndex(0);
+    attachment->setLocalPosition(glm::vec3(0.0f, 1.0f, 0.0f));
+
+    QCOMPARE_WITH_ABS_ERROR(attachment->getWorldPosition(), glm::vec3(1.0f, 1.0f, 0.0f), TEST_EPSILON);
+
+    avatar->jointTranslation = glm::vec3(0.0f, 0.0f, 2.0f);
+    QCOMPARE_WITH_ABS_ERROR(attachment->getWorldPosition(), glm::vec3(1.0f, 1.0f, 2.0f), TEST_EPSILON);
+
+    // parented to the avatar itself rather than one of its joints
+    attachment->setParentJointIndex(INVALID_JOINT_INDEX);
+    QCOMPARE_WITH_ABS_ERROR(attachment->getWorldPosition(), glm::vec3(1.0f, 1.0f, 0.0f), TEST_EPSILON);
+
+    avatar->setWorldPosition(glm::vec3(0.0f, 0.0f, 0.0f));
+    QCOMPARE_WITH_ABS_ERROR(attachment->getWorldPosition(), glm::vec3(0.0f, 1.0f, 0.0f), TEST_EPSILON);
+}
+
+void SpatiallyNestableTests::benchmarkStaticHierarchy() {
+    auto chains = createBenchmarkHierarchy();
+
+    glm::vec3 sum;
+    QBENCHMARK {
+        sum = sumWorldPositions(chains);
+    }
+    QVERIFY(!isNaN(sum));
+}
+
+void SpatiallyNestableTests::benchmarkMovingHierarchy() {
+    auto chains = createBenchmarkHierarchy();
+
+    // every frame the roots move and all the descendants are queried, a few times each
+    const int QUERIES_PER_FRAME = 4;
+    float time = 0.0f;
+    glm::vec3 sum;
+    QBENCHMARK {
+        time += 0.01f;
+        for (size_t i = 0; i < chains.size(); ++i) {
+            chains[i].front()->setWorldPosition(glm::vec3((float)i, sinf(time), 0.0f));
+        }
+        for (int i = 0; i < QUERIES_PER_FRAME; ++i) {
+            sum = sumWorldPositions(chains);
+        }
+    }
+    QVERIFY(!isNaN(sum));
+}
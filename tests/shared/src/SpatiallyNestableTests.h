@@ -0,0 +1,35 @@
+//
+//  SpatiallyNestableTests.h
+//  tests/shared/src
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_SpatiallyNestableTests_h
+#define hifi_SpatiallyNestableTests_h
+
+#include <QtTest/QtTest>
+
+class SpatiallyNestableTests : public QObject {
+    Q_OBJECT
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+
+    // world transforms follow changes anywhere up the parent chain
+    void parentChainChanges();
+    void reparenting();
+    void parentDeleted();
+
+    // transforms relative to a joint follow the joint, which moves without telling its children
+    void jointParenting();
+
+    // 10k nestables in chains as deep as the parenting limit allows
+    void benchmarkStaticHierarchy();
+    void benchmarkMovingHierarchy();
+};
+
+#endif // hifi_SpatiallyNestableTests_h
@@ -0,0 +1,224 @@
+//
+//  TraceRecorderTests.cpp
+//  tests/shared/src
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "TraceRecorderTests.h"
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include <QtCore/QDir>
+#include <QtCore/QJsonArray>
+#include <QtCore/QJsonDocument>
+#include <QtCore/QJsonObject>
+#include <QtCore/QTemporaryDir>
+
+#include <Profile.h>
+#include <TraceRecorder.h>
+
+QTEST_MAIN(TraceRecorderTests)
+Q_LOGGING_CATEGORY(trace_test_recorder, "trace.test.recorder")
+
+using namespace tracing;
+
+namespace {
+
+const int NUM_THREADS = 4;
+const int RANGES_PER_THREAD = 1000;
+
+QTemporaryDir* temporaryDir { nullptr };
+
+// dumps the recording and converts it, returning the events that came from category
+QJsonArray dumpAndConvert(const QString& name) {
+    QString recording = temporaryDir->filePath(name + ".hftrace");
+    QString json = temporaryDir->filePath(name + ".json");
+    if (!TraceRecorder::dump(recording) || !TraceRecorder::convertToJson(recording, json)) {
+        return QJsonArray();
+    }
+
+    QFile file(json);
+    file.open(QIODevice::ReadOnly);
+    QJsonArray events;
+    for (const auto& event : QJsonDocument::fromJson(file.readAll()).array()) {
+        if (event.toObject()["cat"].toString() == trace_test_recorder().categoryName()) {
+            events.append(event);
+        }
+    }
+    return events;
+}
+
+}
+
+void TraceRecorderTests::initTestCase() {
+    temporaryDir = new QTemporaryDir();
+    QVERIFY(temporaryDir->isValid());
+    TraceRecorder::startRecording();
+}
+
+void TraceRecorderTests::cleanupTestCase() {
+    TraceRecorder::stopRecording();
+    delete temporaryDir;
+    temporaryDir = nullptr;
+}
+
+void TraceRecorderTests::recordAndConvert() {
+    std::vector<std::thread> threads;
+    std::atomic<int> finishedThreads { 0 };
+    for (int i = 0; i < NUM_THREADS; ++i) {
+        threads.emplace_back([i, &finishedThreads] {
+            TraceRecorder::setThreadName(QString("RecorderThread%1").arg(i));
+            for (int j = 0; j < RANGES_PER_THREAD; ++j) {
+                Duration outer(trace_test_recorder(), "Outer", 0xff0000ff, j);
+                Duration inner(trace_test_recorder(), QString("Inner%1").arg(j % 4));
+            }
+            // keep every thread alive until they've all recorded, so none of them share a thread ID
+            ++finishedThreads;
+            while (finishedThreads.load() < NUM_THREADS) {
+                std::this_thread::yield();
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    QJsonArray events = dumpAndConvert("recordAndConvert");
+    QCOMPARE(events.size(), NUM_THREADS * RANGES_PER_THREAD * 4);
+
+    // every thread's events nest properly
+    QHash<qint64, QStringList> openRanges;
+    QSet<qint64> threadIDs;
+    for (const auto& value : events) {
+        QJsonObject event = value.toObject();
+        qint64 threadID = (qint64)event["tid"].toDouble();
+        threadIDs.insert(threadID);
+        QString name = event["name"].toString();
+        QString type = event["ph"].toString();
+        if (type == "B") {
+            openRanges[threadID].push_back(name);
+        } else {
+            QCOMPARE(type, QString("E"));
+            QVERIFY(!openRanges[threadID].isEmpty());
+            QCOMPARE(openRanges[threadID].takeLast(), name);
+        }
+    }
+    QCOMPARE(threadIDs.size(), NUM_THREADS);
+    for (const auto& ranges : openRanges) {
+        QVERIFY(ranges.isEmpty());
+    }
+}
+
+void TraceRecorderTests::ringBufferWraps() {
+    const uint32_t RECORDS_PER_THREAD = 64;
+    const int NUM_RECORDS = 1000;
+    TraceRecorder::startRecording(RECORDS_PER_THREAD);
+
+    // a new thread, so its buffer uses the smaller size
+    std::thread thread([] {
+        uint32_t nameID = TraceRecorder::internName("Wrapped");
+        for (int i = 0; i < NUM_RECORDS; ++i) {
+            TraceRecorder::record(trace_test_recorder(), nameID, DurationBegin, i);
+        }
+    });
+    thread.join();
+    TraceRecorder::startRecording();
+
+    QJsonArray events;
+    for (const auto& event : dumpAndConvert("ringBufferWraps")) {
+        if (event.toObject()["name"].toString() == "Wrapped") {
+            events.append(event);
+        }
+    }
+    QCOMPARE(events.size(), (int)RECORDS_PER_THREAD);
+    for (int i = 0; i < events.size(); ++i) {
+        int payload = events[i].toObject()["args"].toObject()["nv_payload"].toInt();
+        QCOMPARE(payload, NUM_RECORDS - (int)RECORDS_PER_THREAD + i);
+    }
+}
+
+void TraceRecorderTests::window() {
+    uint32_t oldNameID = TraceRecorder::internName("Old");
+    uint32_t newNameID = TraceRecorder::internName("New");
+
+    TraceRecorder::record(trace_test_recorder(), oldNameID, Instant);
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    TraceRecorder::record(trace_test_recorder(), newNameID, Instant);
+
+    TraceRecorder::setWindow(std::chrono::milliseconds(100));
+    QJsonArray events = dumpAndConvert("window");
+    TraceRecorder::setWindow(TraceRecorder::DEFAULT_WINDOW);
+
+    bool hasOld = false;
+    bool hasNew = false;
+    for (const auto& event : events) {
+        QString name = event.toObject()["name"].toString();
+        hasOld = hasOld || name == "Old";
+        hasNew = hasNew || name == "New";
+    }
+    QVERIFY(!hasOld);
+    QVERIFY(hasNew);
+}
+
+void TraceRecorderTests::dumpWhileRecording() {
+    const uint32_t RECORDS_PER_THREAD = 64;
+    const int NUM_DUMPS = 20;
+    TraceRecorder::startRecording(RECORDS_PER_THREAD);
+
+    // the name of every record matches the parity of its payload, so a torn record shows up as a mismatch
+    std::atomic<bool> stop { false };
+    std::thread thread([&stop] {
+        uint32_t evenNameID = TraceRecorder::internName("Even");
+        uint32_t oddNameID = TraceRecorder::internName("Odd");
+        for (uint64_t i = 0; !stop.load(); ++i) {
+            TraceRecorder::record(trace_test_recorder(), (i % 2) ? oddNameID : evenNameID, DurationBegin, i);
+        }
+    });
+
+    for (int dump = 0; dump < NUM_DUMPS; ++dump) {
+        qint64 lastPayload = -1;
+        for (const auto& value : dumpAndConvert("dumpWhileRecording")) {
+            QJsonObject event = value.toObject();
+            QString name = event["name"].toString();
+            if (name != "Even" && name != "Odd") {
+                continue;
+            }
+            qint64 payload = (qint64)event["args"].toObject()["nv_payload"].toDouble();
+            QCOMPARE(name, QString((payload % 2) ? "Odd" : "Even"));
+            QVERIFY(payload > lastPayload);
+            lastPayload = payload;
+        }
+    }
+    stop.store(true);
+    thread.join();
+    TraceRecorder::startRecording();
+}
+
+void TraceRecorderTests::slowFrameDumps() {
+    QString directory = temporaryDir->filePath("slowFrameDumps");
+    QVERIFY(QDir().mkpath(directory));
+    TraceRecorder::setFrameTimeThreshold(std::chrono::milliseconds(10), directory);
+
+    TraceRecorder::record(trace_test_recorder(), TraceRecorder::internName("BeforeSlowFrame"), Instant);
+    TraceRecorder::checkFrameTime("FastFrame", std::chrono::milliseconds(1));
+    TraceRecorder::checkFrameTime("SlowFrame", std::chrono::milliseconds(20));
+    TraceRecorder::stopRecording();
+    TraceRecorder::setFrameTimeThreshold(std::chrono::microseconds(0), QString());
+    TraceRecorder::startRecording();
+
+    QStringList dumps = QDir(directory).entryList({ "*.hftrace" }, QDir::Files);
+    QCOMPARE(dumps.size(), 1);
+    QVERIFY(dumps[0].startsWith("SlowFrame-"));
+}
+
+void TraceRecorderTests::benchmarkRecordRange() {
+    QBENCHMARK {
+        PROFILE_RANGE(test_recorder, "BenchmarkRange");
+    }
+}
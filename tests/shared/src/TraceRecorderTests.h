@@ -0,0 +1,40 @@
+//
+//  TraceRecorderTests.h
+//  tests/shared/src
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_TraceRecorderTests_h
+#define hifi_TraceRecorderTests_h
+
+#include <QtTest/QtTest>
+
+class TraceRecorderTests : public QObject {
+    Q_OBJECT
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+
+    // ranges recorded on several threads come out of the converter as matching begin and end events
+    void recordAndConvert();
+
+    // only the newest records survive once a thread's ring buffer wraps
+    void ringBufferWraps();
+
+    // dumps leave out everything older than the window
+    void window();
+
+    // records copied while their thread is overwriting them are left out rather than torn
+    void dumpWhileRecording();
+
+    // a slow frame dumps on a background thread that stopRecording() waits for
+    void slowFrameDumps();
+
+    void benchmarkRecordRange();
+};
+
+#endif // hifi_TraceRecorderTests_h
@@ -0,0 +1,288 @@
+//
+//  TriangleSetTests.cpp
+//  tests/shared/src
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "TriangleSetTests.h"
+
+#include <random>
+
+#include <GLMHelpers.h>
+#include <TriangleSet.h>
+
+QTEST_MAIN(TriangleSetTests)
+
+namespace {
+
+const float DISTANCE_TOLERANCE = 0.0001f;
+
+// small triangles scattered through a box, like the parts of a detailed model
+std::vector<Triangle> makeTriangles(int count, std::mt19937& generator) {
+    std::uniform_real_distribution<float> position(-10.0f, 10.0f);
+    std::uniform_real_distribution<float> offset(-1.0f, 1.0f);
+    std::vector<Triangle> triangles;
+    for (int i = 0; i < count; i++) {
+        glm::vec3 v0(position(generator), position(generator), position(generator));
+        glm::vec3 v1 = v0 + glm::vec3(offset(generator), offset(generator), offset(generator));
+        glm::vec3 v2 = v0 + glm::vec3(offset(generator), offset(generator), offset(generator));
+        triangles.push_back({ v0, v1, v2 });
+    }
+    return triangles;
+}
+
+TriangleSet makeTriangleSet(const std::vector<Triangle>& triangles) {
+    TriangleSet triangleSet;
+    triangleSet.reserve(triangles.size());
+    for (const auto& triangle : triangles) {
+        triangleSet.insert(triangle);
+    }
+    return triangleSet;
+}
+
+bool findClosestRayIntersection(const std::vector<Triangle>& triangles, const glm::vec3& origin, const glm::vec3& direction,
+        bool allowBackface, float& distance) {
+    bool intersects = false;
+    distance = FLT_MAX;
+    for (const auto& triangle : triangles) {
+        float triangleDistance;
+        if (findRayTriangleIntersection(origin, direction, triangle, triangleDistance, allowBackface) &&
+                triangleDistance < distance) {
+            distance = triangleDistance;
+            intersects = true;
+        }
+    }
+    return intersects;
+}
+
+bool findClosestParabolaIntersection(const std::vector<Triangle>& triangles, const glm::vec3& origin,
+        const glm::vec3& velocity, const glm::vec3& acceleration, float& distance) {
+    bool intersects = false;
+    distance = FLT_MAX;
+    for (const auto& triangle : triangles) {
+        float triangleDistance;
+        if (findParabolaTriangleIntersection(origin, velocity, acceleration, triangle, triangleDistance) &&
+                triangleDistance < distance) {
+            distance = triangleDistance;
+            intersects = true;
+        }
+    }
+    return intersects;
+}
+
+// the twelve triangles of the faces of an axis aligned box, facing out
+void addBoxTriangles(std::vector<Triangle>& triangles, const glm::vec3& minimum, const glm::vec3& maximum) {
+    for (int axis = 0; axis < 3; axis++) {
+        int first = (axis + 1) % 3;
+        int second = (axis + 2) % 3;
+        for (int side = 0; side < 2; side++) {
+            glm::vec3 corners[4];
+            for (int corner = 0; corner < 4; corner++) {
+                corners[corner][axis] = side ? maximum[axis] : minimum[axis];
+                corners[corner][first] = (corner == 1 || corner == 2) ? maximum[first] : minimum[first];
+                corners[corner][second] = (corner >= 2) ? maximum[second] : minimum[second];
+            }
+            if (side) {
+                triangles.push_back({ corners[0], corners[1], corners[2] });
+                triangles.push_back({ corners[0], corners[2], corners[3] });
+            } else {
+                triangles.push_back({ corners[0], corners[2], corners[1] });
+                triangles.push_back({ corners[0], corners[3], corners[2] });
+            }
+        }
+    }
+}
+
+void compareRayIntersections(TriangleSet& triangleSet, const std::vector<Triangle>& triangles, int numRays,
+        std::mt19937& generator) {
+    std::uniform_real_distribution<float> position(-15.0f, 15.0f);
+    std::uniform_real_distribution<float> direction(-1.0f, 1.0f);
+    for (int i = 0; i < numRays; i++) {
+        glm::vec3 rayOrigin(position(generator), position(generator), position(generator));
+        glm::vec3 rayDirection(direction(generator), direction(generator), direction(generator));
+        if (i % 8 == 0) {
+            // axis aligned rays divide by zero in the bounds tests
+            rayDirection = glm::vec3(0.0f, 0.0f, -1.0f);
+        }
+        bool allowBackface = i % 2 == 0;
+
+        float expectedDistance;
+        bool expected = findClosestRayIntersection(triangles, rayOrigin, rayDirection, allowBackface, expectedDistance);
+
+        float distance = FLT_MAX;
+        BoxFace face;
+        Triangle triangle;
+        bool intersects = triangleSet.findRayIntersection(rayOrigin, rayDirection, 1.0f / rayDirection, distance, face,
+            triangle, true, allowBackface);
+        QCOMPARE(intersects, expected);
+        if (intersects) {
+            QVERIFY(fabsf(distance - expectedDistance) < DISTANCE_TOLERANCE * std::max(1.0f, expectedDistance));
+
+            float triangleDistance;
+            QVERIFY(findRayTriangleIntersection(rayOrigin, rayDirection, triangle, triangleDistance, allowBackface));
+            QVERIFY(fabsf(triangleDistance - distance) < DISTANCE_TOLERANCE * std::max(1.0f, distance));
+        }
+    }
+}
+
+}
+
+void TriangleSetTests::rayIntersections() {
+    std::mt19937 generator(1);
+    auto triangles = makeTriangles(10000, generator);
+    auto triangleSet = makeTriangleSet(triangles);
+    compareRayIntersections(triangleSet, triangles, 1000, generator);
+}
+
+void TriangleSetTests::axisAlignedRaysOnBounds() {
+    // a grid of unit boxes, so that the node bounds lie on the planes of the box faces
+    const int GRID_SIZE = 3;
+    const float SPACING = 2.0f;
+    std::vector<Triangle> triangles;
+    for (int x = 0; x < GRID_SIZE; x++) {
+        for (int y = 0; y < GRID_SIZE; y++) {
+            for (int z = 0; z < GRID_SIZE; z++) {
+                glm::vec3 minimum = glm::vec3(x, y, z) * SPACING;
+                addBoxTriangles(triangles, minimum, minimum + glm::vec3(1.0f));
+            }
+        }
+    }
+    auto triangleSet = makeTriangleSet(triangles);
+
+    // rays along each axis, in both directions, starting on the face planes, between them and inside the boxes
+    const float GRID_END = (GRID_SIZE - 1) * SPACING + 1.0f;
+    const float OFFSETS[] = { 0.0f, 0.5f, 1.0f, 1.5f, 2.0f, 2.5f, 3.0f, 4.0f, 4.5f, 5.0f };
+    const float STARTS[] = { -1.0f, 0.0f, 0.5f, 1.0f, GRID_END, GRID_END + 1.0f };
+    for (int axis = 0; axis < 3; axis++) {
+        for (float sign : { 1.0f, -1.0f }) {
+            // the zero components are signed too, so both infinities come up in the inverse direction
+            glm::vec3 direction(sign * 0.0f);
+            direction[axis] = sign;
+            for (float start : STARTS) {
+                for (float firstOffset : OFFSETS) {
+                    for (float secondOffset : OFFSETS) {
+                        glm::vec3 origin;
+                        origin[axis] = start;
+                        origin[(axis + 1) % 3] = firstOffset;
+                        origin[(axis + 2) % 3] = secondOffset;
+                        for (bool allowBackface : { false, true }) {
+                            float expectedDistance;
+                            bool expected = findClosestRayIntersection(triangles, origin, direction, allowBackface,
+                                expectedDistance);
+
+                            float distance = FLT_MAX;
+                            BoxFace face;
+                            Triangle triangle;
+                            bool intersects = triangleSet.findRayIntersection(origin, direction, 1.0f / direction, distance,
+                                face, triangle, true, allowBackface);
+                            QCOMPARE(intersects, expected);
+                            if (intersects) {
+                                QCOMPARE(distance, expectedDistance);
+                            }
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
+
+void TriangleSetTests::parabolaIntersections() {
+    std::mt19937 generator(2);
+    auto triangles = makeTriangles(2000, generator);
+    auto triangleSet = makeTriangleSet(triangles);
+
+    std::uniform_real_distribution<float> position(-15.0f, 15.0f);
+    std::uniform_real_distribution<float> velocity(-5.0f, 5.0f);
+    const glm::vec3 GRAVITY(0.0f, -9.8f, 0.0f);
+    for (int i = 0; i < 200; i++) {
+        glm::vec3 origin(position(generator), position(generator), position(generator));
+        glm::vec3 initialVelocity(velocity(generator), velocity(generator), velocity(generator));
+
+        float expectedDistance;
+        bool expected = findClosestParabolaIntersection(triangles, origin, initialVelocity, GRAVITY, expectedDistance);
+
+        float distance = FLT_MAX;
+        BoxFace face;
+        Triangle triangle;
+        bool intersects = triangleSet.findParabolaIntersection(origin, initialVelocity, GRAVITY, distance, face, triangle, true);
+        QCOMPARE(intersects, expected);
+        if (intersects) {
+            QVERIFY(fabsf(distance - expectedDistance) < DISTANCE_TOLERANCE * std::max(1.0f, expectedDistance));
+        }
+    }
+}
+
+void TriangleSetTests::smallSets() {
+    std::mt19937 generator(3);
+    for (int count : { 0, 1, 3, 4, 5, 17 }) {
+        auto triangles = makeTriangles(count, generator);
+        auto triangleSet = makeTriangleSet(triangles);
+        compareRayIntersections(triangleSet, triangles, 200, generator);
+    }
+
+    // a ray straight at a single triangle
+    TriangleSet triangleSet;
+    triangleSet.insert({ glm::vec3(-1.0f, -1.0f, 0.0f), glm::vec3(1.0f, -1.0f, 0.0f), glm::vec3(0.0f, 1.0f, 0.0f) });
+    glm::vec3 direction(0.0f, 0.0f, -1.0f);
+    float distance = FLT_MAX;
+    BoxFace face;
+    Triangle triangle;
+    QVERIFY(triangleSet.findRayIntersection(glm::vec3(0.0f, 0.0f, 2.0f), direction, 1.0f / direction, distance, face,
+        triangle, true));
+    QCOMPARE(distance, 2.0f);
+}
+
+void TriangleSetTests::insertAfterPicking() {
+    std::mt19937 generator(4);
+    auto triangles = makeTriangles(500, generator);
+    auto triangleSet = makeTriangleSet(triangles);
+    compareRayIntersections(triangleSet, triangles, 100, generator);
+
+    // the hierarchy is rebuilt on the next pick
+    auto moreTriangles = makeTriangles(500, generator);
+    for (const auto& triangle : moreTriangles) {
+        triangleSet.insert(triangle);
+    }
+    triangles.insert(triangles.end(), moreTriangles.begin(), moreTriangles.end());
+    QCOMPARE(triangleSet.size(), triangles.size());
+    compareRayIntersections(triangleSet, triangles, 100, generator);
+}
+
+void TriangleSetTests::benchmarkBalanceTree() {
+    std::mt19937 generator(5);
+    auto triangles = makeTriangles(500000, generator);
+    auto triangleSet = makeTriangleSet(triangles);
+
+    QBENCHMARK {
+        triangleSet.balanceTree();
+    }
+}
+
+void TriangleSetTests::benchmarkRayIntersection() {
+    std::mt19937 generator(6);
+    auto triangles = makeTriangles(500000, generator);
+    auto triangleSet = makeTriangleSet(triangles);
+    triangleSet.balanceTree();
+
+    std::uniform_real_distribution<float> position(-15.0f, 15.0f);
+    std::vector<std::pair<glm::vec3, glm::vec3>> rays;
+    for (int i = 0; i < 1000; i++) {
+        glm::vec3 origin(position(generator), position(generator), position(generator));
+        glm::vec3 target(position(generator), position(generator), position(generator));
+        rays.emplace_back(origin, glm::normalize(target - origin));
+    }
+
+    QBENCHMARK {
+        for (const auto& ray : rays) {
+            float distance = FLT_MAX;
+            BoxFace face;
+            Triangle triangle;
+            triangleSet.findRayIntersection(ray.first, ray.second, 1.0f / ray.second, distance, face, triangle, true);
+        }
+    }
+}
@@ -0,0 +1,29 @@
+//
+//  TriangleSetTests.h
+//  tests/shared/src
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_TriangleSetTests_h
+#define hifi_TriangleSetTests_h
+
+#include <QtTest/QtTest>
+
+class TriangleSetTests : public QObject {
+    Q_OBJECT
+
+private slots:
+    void rayIntersections();
+    void axisAlignedRaysOnBounds();
+    void parabolaIntersections();
+    void smallSets();
+    void insertAfterPicking();
+    void benchmarkBalanceTree();
+    void benchmarkRayIntersection();
+};
+
+#endif // hifi_TriangleSetTests_h
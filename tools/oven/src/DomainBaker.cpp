@@ -17,6 +17,11 @@
 #include <QtCore/QFileInfo>
 #include <QtCore/QJsonDocument>
 #include <QtCore/QJsonObject>
+#include <QtCore/QTimer>
+#include <QtNetwork/QNetworkReply>
+
+#include <NetworkAccessManager.h>
+#include <NetworkingConstants.h>
 
 #include "Gzip.h"
 #include "Oven.h"
@@ -52,6 +57,12 @@ void DomainBaker::bake() {
         return;
     }
 
+    if (_bakeCacheSizeLimit > 0) {
+        // the cache is shared by every bake into the same output folder
+        static const QString BAKE_CACHE_FOLDER_NAME = ".bake-cache";
+        _bakeCache.reset(new BakeCache(QDir(_baseOutputPath).filePath(BAKE_CACHE_FOLDER_NAME), _bakeCacheSizeLimit));
+    }
+
     enumerateEntities();
 
     if (hasErrors()) {
@@ -194,8 +205,8 @@ void DomainBaker::enumerateEntities() {
                         modelURL = modelURL.adjusted(QUrl::RemoveQuery | QUrl::RemoveFragment);
                     }
 
-                    // setup a ModelBaker for this URL, as long as we don't already have one
-                    if (!_modelBakers.contains(modelURL)) {
+                    // reserve an output folder for this URL, as long as we don't already have one
+                    if (!_pendingModels.contains(modelURL)) {
                         auto filename = modelURL.fileName();
                         auto baseName = filename.left(filename.lastIndexOf('.'));
                         auto subDirName = "/" + baseName;
@@ -204,33 +215,13 @@ void DomainBaker::enumerateEntities() {
                             subDirName = "/" + baseName + "-" + QString::number(i++);
                         }
 
-                        QSharedPointer<ModelBaker> baker;
-                        if (isBakeableFBX) {
-                            baker = {
-                                new FBXBaker(modelURL, []() -> QThread* {
-                                    return Oven::instance().getNextWorkerThread();
-                                }, _contentOutputPath + subDirName + "/baked", _contentOutputPath + subDirName + "/original"),
-                                &FBXBaker::deleteLater
-                            };
-                        } else {
-                            baker = {
-                                new OBJBaker(modelURL, []() -> QThread* {
-                                    return Oven::instance().getNextWorkerThread();
-                                }, _contentOutputPath + subDirName + "/baked", _contentOutputPath + subDirName + "/original"),
-                                &OBJBaker::deleteLater
-                            };
-                        }
-
-                        // make sure our handler is called when the baker is done
-                        connect(baker.data(), &Baker::finished, this, &DomainBaker::handleFinishedModelBaker);
-
-                        // insert it into our bakers hash so we hold a strong pointer to it
-                        _modelBakers.insert(modelURL, baker);
+                        // create it now, since the bakes only start once every entity has been enumerated
+                        QDir().mkpath(_contentOutputPath + subDirName);
 
-                        // move the baker to the baker thread
-                        // and kickoff the bake
-                        baker->moveToThread(Oven::instance().getNextWorkerThread());
-                        QMetaObject::invokeMethod(baker.data(), "bake");
+                        PendingModel pendingModel;
+                        pendingModel.subDirPath = _contentOutputPath + subDirName;
+                        pendingModel.isFBX = isBakeableFBX;
+                        _pendingModels.insert(modelURL, pendingModel);
 
                         // keep track of the total number of baking entities
                         ++_totalNumberOfSubBakes;
@@ -269,6 +260,163 @@ void DomainBaker::enumerateEntities() {
 
     // emit progress now to say we're just starting
     emit bakeProgress(0, _totalNumberOfSubBakes);
+
+    // look for each model in the bake cache once we're done enumerating, so that models restored right away
+    // can't finish the domain bake before every entity needing a re-write is known
+    for (auto modelURL : _pendingModels.keys()) {
+        QTimer::singleShot(0, this, [this, modelURL] {
+            if (_bakeCache) {
+                lookupBakedModel(modelURL);
+            } else {
+                bakeModel(modelURL, QString());
+            }
+        });
+    }
+}
+
+void DomainBaker::lookupBakedModel(const QUrl& modelURL) {
+    fetchContent(modelURL, [this, modelURL](bool success, QByteArray content) {
+        if (!success) {
+            // let the baker report why the model can't be loaded
+            bakeModel(modelURL, QString());
+            return;
+        }
+
+        // anything that changes the baked output for the same source needs to be part of the key
+        QJsonObject options;
+        options["type"] = _pendingModels[modelURL].isFBX ? "fbx" : "obj";
+        options["fileName"] = modelURL.fileName();
+        options["textureCompression"] = TextureBaker::isCompressionEnabled();
+
+        auto cacheKey = BakeCache::computeKey(content, QCoreApplication::applicationVersion(), options);
+
+        if (_bakeCache->contains(cacheKey)) {
+            // the cache only holds the baked output, the originals are written again from the content fetched here
+            QHash<QUrl, QByteArray> originals;
+            originals[modelURL] = content;
+            checkBakedModelDependencies(modelURL, cacheKey, _bakeCache->getDependencies(cacheKey).keys(), originals);
+        } else {
+            bakeModel(modelURL, cacheKey);
+        }
+    });
+}
+
+void DomainBaker::checkBakedModelDependencies(const QUrl& modelURL, const QString& cacheKey, QList<QUrl> dependencies,
+                                              QHash<QUrl, QByteArray> originals) {
+    if (dependencies.isEmpty()) {
+        restoreBakedModel(modelURL, cacheKey, originals);
+        return;
+    }
+
+    auto dependencyURL = dependencies.takeFirst();
+    fetchContent(dependencyURL, [this, modelURL, cacheKey, dependencies, dependencyURL, originals](bool success,
+                                                                                                  QByteArray content) mutable {
+        auto expectedHash = _bakeCache->getDependencies(cacheKey).value(dependencyURL);
+        if (success && BakeCache::hashDependency(content) == expectedHash) {
+            originals[dependencyURL] = content;
+            checkBakedModelDependencies(modelURL, cacheKey, dependencies, originals);
+        } else {
+            qDebug() << "Re-baking" << modelURL << "since" << dependencyURL << "changed";
+            bakeModel(modelURL, cacheKey);
+        }
+    });
+}
+
+void DomainBaker::restoreBakedModel(const QUrl& modelURL, const QString& cacheKey, const QHash<QUrl, QByteArray>& originals) {
+    auto bakedModelFilePath = _bakeCache->restore(cacheKey, _pendingModels[modelURL].subDirPath + "/baked");
+    if (bakedModelFilePath.isEmpty() || !writeOriginals(modelURL, originals)) {
+        bakeModel(modelURL, cacheKey);
+        return;
+    }
+
+    qDebug() << "Re-using the previous bake of" << modelURL;
+
+    rewriteModelURL(modelURL, bakedModelFilePath);
+    finishModel(modelURL);
+}
+
+// lays out the original model and its linked textures the same way the model bakers copy them
+bool DomainBaker::writeOriginals(const QUrl& modelURL, const QHash<QUrl, QByteArray>& originals) {
+    QDir originalDir { _pendingModels[modelURL].subDirPath + "/original" };
+    for (auto it = originals.begin(); it != originals.end(); ++it) {
+        auto relativePath = ModelBaker::texturePathRelativeToModel(modelURL, it.key());
+        QFile originalFile { originalDir.filePath(relativePath + it.key().fileName()) };
+        if (!QDir().mkpath(QFileInfo(originalFile).absolutePath()) || !originalFile.open(QIODevice::WriteOnly) ||
+                originalFile.write(it.value()) == -1) {
+            qWarning() << "Could not write the original" << it.key() << "to" << originalFile.fileName();
+            return false;
+        }
+    }
+    return true;
+}
+
+void DomainBaker::bakeModel(const QUrl& modelURL, const QString& cacheKey) {
+    auto pendingModel = _pendingModels[modelURL];
+
+    QSharedPointer<ModelBaker> baker;
+    if (pendingModel.isFBX) {
+        baker = {
+            new FBXBaker(modelURL, []() -> QThread* {
+                return Oven::instance().getNextWorkerThread();
+            }, pendingModel.subDirPath + "/baked", pendingModel.subDirPath + "/original"),
+            &FBXBaker::deleteLater
+        };
+    } else {
+        baker = {
+            new OBJBaker(modelURL, []() -> QThread* {
+                return Oven::instance().getNextWorkerThread();
+            }, pendingModel.subDirPath + "/baked", pendingModel.subDirPath + "/original"),
+            &OBJBaker::deleteLater
+        };
+    }
+
+    // make sure our handler is called when the baker is done
+    connect(baker.data(), &Baker::finished, this, &DomainBaker::handleFinishedModelBaker);
+
+    // insert it into our bakers hash so we hold a strong pointer to it
+    _modelBakers.insert(modelURL, baker);
+
+    // remember where to store the result once the bake is done
+    if (!cacheKey.isEmpty()) {
+        _modelCacheKeys.insert(modelURL, cacheKey);
+    }
+
+    // move the baker to the baker thread
+    // and kickoff the bake
+    baker->moveToThread(Oven::instance().getNextWorkerThread());
+    QMetaObject::invokeMethod(baker.data(), "bake");
+}
+
+void DomainBaker::fetchContent(const QUrl& url, std::function<void(bool, QByteArray)> callback) {
+    if (url.isLocalFile()) {
+        QFile localFile { url.toLocalFile() };
+        if (!localFile.open(QIODevice::ReadOnly)) {
+            callback(false, QByteArray());
+            return;
+        }
+        callback(true, localFile.readAll());
+    } else {
+        auto& networkAccessManager = NetworkAccessManager::getInstance();
+
+        QNetworkRequest networkRequest;
+
+        // setup the request to follow re-directs and always hit the network
+        networkRequest.setAttribute(QNetworkRequest::FollowRedirectsAttribute, true);
+        networkRequest.setAttribute(QNetworkRequest::CacheLoadControlAttribute, QNetworkRequest::AlwaysNetwork);
+        networkRequest.setHeader(QNetworkRequest::UserAgentHeader, HIGH_FIDELITY_USER_AGENT);
+
+        networkRequest.setUrl(url);
+
+        auto networkReply = networkAccessManager.get(networkRequest);
+        connect(networkReply, &QNetworkReply::finished, this, [networkReply, callback] {
+            networkReply->deleteLater();
+            if (networkReply->error() == QNetworkReply::NoError) {
+                callback(true, networkReply->readAll());
+            } else {
+                callback(false, QByteArray());
+            }
+        });
+    }
 }
 
 void DomainBaker::bakeSkybox(QUrl skyboxURL, QJsonValueRef entity) {
@@ -319,83 +467,103 @@ void DomainBaker::handleFinishedModelBaker() {
     if (baker) {
         if (!baker->hasErrors()) {
             // this FBXBaker is done and everything went according to plan
-            qDebug() << "Re-writing entity references to" << baker->getModelURL();
+            rewriteModelURL(baker->getModelURL(), baker->getBakedModelFilePath());
+
+            // store the output so that the next bake of the same source can re-use it
+            if (_bakeCache && _modelCacheKeys.contains(baker->getModelURL())) {
+                // only the baked output, the originals are the sources fetched again to look the bake up
+                _bakeCache->insert(_modelCacheKeys[baker->getModelURL()],
+                                   _pendingModels[baker->getModelURL()].subDirPath + "/baked",
+                                   baker->getBakedModelFilePath(), baker->getTextureDependencies());
+            }
+        } else {
+            // this model failed to bake - this doesn't fail the entire bake but we need to add
+            // the errors from the model to our warnings
+            _warningList << baker->getErrors();
+        }
 
-            // enumerate the QJsonRef values for the URL of this FBX from our multi hash of
-            // entity objects needing a URL re-write
-            for (QJsonValueRef entityValue : _entitiesNeedingRewrite.values(baker->getModelURL())) {
+        // drop our shared pointer to this baker so that it gets cleaned up
+        _modelBakers.remove(baker->getModelURL());
 
-                // convert the entity QJsonValueRef to a QJsonObject so we can modify its URL
-                auto entity = entityValue.toObject();
+        finishModel(baker->getModelURL());
+    }
+}
 
-                // grab the old URL
-                QUrl oldModelURL { entity[ENTITY_MODEL_URL_KEY].toString() };
+void DomainBaker::rewriteModelURL(const QUrl& modelURL, const QString& bakedModelFilePath) {
+    qDebug() << "Re-writing entity references to" << modelURL;
 
-                // setup a new URL using the prefix we were passed
-                auto relativeFBXFilePath = baker->getBakedModelFilePath().remove(_contentOutputPath);
-                if (relativeFBXFilePath.startsWith("/")) {
-                    relativeFBXFilePath = relativeFBXFilePath.right(relativeFBXFilePath.length() - 1);
-                }
-                QUrl newModelURL = _destinationPath.resolved(relativeFBXFilePath);
+    // setup a new URL using the prefix we were passed
+    auto relativeFBXFilePath = QString(bakedModelFilePath).remove(_contentOutputPath);
+    if (relativeFBXFilePath.startsWith("/")) {
+        relativeFBXFilePath = relativeFBXFilePath.right(relativeFBXFilePath.length() - 1);
+    }
 
-                // copy the fragment and query, and user info from the old model URL
-                newModelURL.setQuery(oldModelURL.query());
-                newModelURL.setFragment(oldModelURL.fragment());
-                newModelURL.setUserInfo(oldModelURL.userInfo());
+    // enumerate the QJsonRef values for the URL of this FBX from our multi hash of
+    // entity objects needing a URL re-write
+    for (QJsonValueRef entityValue : _entitiesNeedingRewrite.values(modelURL)) {
 
-                // set the new model URL as the value in our temp QJsonObject
-                entity[ENTITY_MODEL_URL_KEY] = newModelURL.toString();
+        // convert the entity QJsonValueRef to a QJsonObject so we can modify its URL
+        auto entity = entityValue.toObject();
 
-                // check if the entity also had an animation at the same URL
-                // in which case it should be replaced with our baked model URL too
-                const QString ENTITY_ANIMATION_KEY = "animation";
-                const QString ENTITIY_ANIMATION_URL_KEY = "url";
+        // grab the old URL
+        QUrl oldModelURL { entity[ENTITY_MODEL_URL_KEY].toString() };
 
-                if (entity.contains(ENTITY_ANIMATION_KEY)) {
-                    auto animationObject = entity[ENTITY_ANIMATION_KEY].toObject();
+        QUrl newModelURL = _destinationPath.resolved(relativeFBXFilePath);
 
-                    if (animationObject.contains(ENTITIY_ANIMATION_URL_KEY)) {
-                        // grab the old animation URL
-                        QUrl oldAnimationURL { animationObject[ENTITIY_ANIMATION_URL_KEY].toString() };
+        // copy the fragment and query, and user info from the old model URL
+        newModelURL.setQuery(oldModelURL.query());
+        newModelURL.setFragment(oldModelURL.fragment());
+        newModelURL.setUserInfo(oldModelURL.userInfo());
 
-                        // check if its stripped down version matches our stripped down model URL
-                        if (oldAnimationURL.matches(oldModelURL, QUrl::RemoveQuery | QUrl::RemoveFragment)) {
-                            // the animation URL matched the old model URL, so make the animation URL point to the baked FBX
-                            // with its original query and fragment
-                            auto newAnimationURL = _destinationPath.resolved(relativeFBXFilePath);
-                            newAnimationURL.setQuery(oldAnimationURL.query());
-                            newAnimationURL.setFragment(oldAnimationURL.fragment());
-                            newAnimationURL.setUserInfo(oldAnimationURL.userInfo());
+        // set the new model URL as the value in our temp QJsonObject
+        entity[ENTITY_MODEL_URL_KEY] = newModelURL.toString();
 
-                            animationObject[ENTITIY_ANIMATION_URL_KEY] = newAnimationURL.toString();
+        // check if the entity also had an animation at the same URL
+        // in which case it should be replaced with our baked model URL too
+        const QString ENTITY_ANIMATION_KEY = "animation";
+        const QString ENTITIY_ANIMATION_URL_KEY = "url";
 
-                            // replace the animation object in the entity object
-                            entity[ENTITY_ANIMATION_KEY] = animationObject;
-                        }
-                    }
+        if (entity.contains(ENTITY_ANIMATION_KEY)) {
+            auto animationObject = entity[ENTITY_ANIMATION_KEY].toObject();
+
+            if (animationObject.contains(ENTITIY_ANIMATION_URL_KEY)) {
+                // grab the old animation URL
+                QUrl oldAnimationURL { animationObject[ENTITIY_ANIMATION_URL_KEY].toString() };
+
+                // check if its stripped down version matches our stripped down model URL
+                if (oldAnimationURL.matches(oldModelURL, QUrl::RemoveQuery | QUrl::RemoveFragment)) {
+                    // the animation URL matched the old model URL, so make the animation URL point to the baked FBX
+                    // with its original query and fragment
+                    auto newAnimationURL = _destinationPath.resolved(relativeFBXFilePath);
+                    newAnimationURL.setQuery(oldAnimationURL.query());
+                    newAnimationURL.setFragment(oldAnimationURL.fragment());
+                    newAnimationURL.setUserInfo(oldAnimationURL.userInfo());
+
+                    animationObject[ENTITIY_ANIMATION_URL_KEY] = newAnimationURL.toString();
+
+                    // replace the animation object in the entity object
+                    entity[ENTITY_ANIMATION_KEY] = animationObject;
                 }
-                
-                // replace our temp object with the value referenced by our QJsonValueRef
-                entityValue = entity;
             }
-        } else {
-            // this model failed to bake - this doesn't fail the entire bake but we need to add
-            // the errors from the model to our warnings
-            _warningList << baker->getErrors();
         }
+        
+        // replace our temp object with the value referenced by our QJsonValueRef
+        entityValue = entity;
+    }
+}
 
-        // remove the baked URL from the multi hash of entities needing a re-write
-        _entitiesNeedingRewrite.remove(baker->getModelURL());
+void DomainBaker::finishModel(const QUrl& modelURL) {
+    // remove the baked URL from the multi hash of entities needing a re-write
+    _entitiesNeedingRewrite.remove(modelURL);
 
-        // drop our shared pointer to this baker so that it gets cleaned up
-        _modelBakers.remove(baker->getModelURL());
+    _pendingModels.remove(modelURL);
+    _modelCacheKeys.remove(modelURL);
 
-        // emit progress to tell listeners how many models we have baked
-        emit bakeProgress(++_completedSubBakes, _totalNumberOfSubBakes);
+    // emit progress to tell listeners how many models we have baked
+    emit bakeProgress(++_completedSubBakes, _totalNumberOfSubBakes);
 
-        // check if this was the last model we needed to re-write and if we are done now
-        checkIfRewritingComplete();
-    }
+    // check if this was the last model we needed to re-write and if we are done now
+    checkIfRewritingComplete();
 }
 
 void DomainBaker::handleFinishedSkyboxBaker() {
@@ -17,6 +17,10 @@
 #include <QtCore/QUrl>
 #include <QtCore/QThread>
 
+#include <functional>
+#include <memory>
+
+#include "BakeCache.h"
 #include "Baker.h"
 #include "FBXBaker.h"
 #include "TextureBaker.h"
@@ -31,6 +35,9 @@ public:
                 const QString& baseOutputPath, const QUrl& destinationPath,
                 bool shouldRebakeOriginals = false);
 
+    // the size past which the least recently used baked models are dropped from the bake cache, 0 disables the cache
+    void setBakeCacheSizeLimit(qint64 sizeLimit) { _bakeCacheSizeLimit = sizeLimit; }
+
 signals:
     void allModelsFinished();
     void bakeProgress(int baked, int total);
@@ -47,6 +54,16 @@ private:
     void checkIfRewritingComplete();
     void writeNewEntitiesFile();
 
+    void lookupBakedModel(const QUrl& modelURL);
+    void checkBakedModelDependencies(const QUrl& modelURL, const QString& cacheKey, QList<QUrl> dependencies,
+                                     QHash<QUrl, QByteArray> originals);
+    void restoreBakedModel(const QUrl& modelURL, const QString& cacheKey, const QHash<QUrl, QByteArray>& originals);
+    bool writeOriginals(const QUrl& modelURL, const QHash<QUrl, QByteArray>& originals);
+    void bakeModel(const QUrl& modelURL, const QString& cacheKey);
+    void rewriteModelURL(const QUrl& modelURL, const QString& bakedModelFilePath);
+    void finishModel(const QUrl& modelURL);
+    void fetchContent(const QUrl& url, std::function<void(bool, QByteArray)> callback);
+
     void bakeSkybox(QUrl skyboxURL, QJsonValueRef entity);
     bool rewriteSkyboxURL(QJsonValueRef urlValue, TextureBaker* baker);
 
@@ -61,7 +78,15 @@ private:
 
     QJsonArray _entities;
 
+    class PendingModel {
+    public:
+        QString subDirPath;
+        bool isFBX { false };
+    };
+
+    QHash<QUrl, PendingModel> _pendingModels;
     QHash<QUrl, QSharedPointer<ModelBaker>> _modelBakers;
+    QHash<QUrl, QString> _modelCacheKeys;
     QHash<QUrl, QSharedPointer<TextureBaker>> _skyboxBakers;
     
     QMultiHash<QUrl, QJsonValueRef> _entitiesNeedingRewrite;
@@ -70,6 +95,9 @@ private:
     int _completedSubBakes { 0 };
 
     bool _shouldRebakeOriginals { false };
+
+    std::unique_ptr<BakeCache> _bakeCache;
+    qint64 _bakeCacheSizeLimit { BakeCache::DEFAULT_SIZE_LIMIT };
 };
 
 #endif // hifi_DomainBaker_h
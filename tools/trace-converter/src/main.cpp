@@ -0,0 +1,53 @@
+//
+//  main.cpp
+//  tools/trace-converter/src
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include <QtCore/QCommandLineParser>
+#include <QtCore/QCoreApplication>
+#include <QtCore/QDebug>
+#include <QtCore/QDir>
+#include <QtCore/QFileInfo>
+
+#include <SharedUtil.h>
+#include <TraceRecorder.h>
+
+// Converts the binary recordings dumped by the TraceRecorder to Chrome trace JSON, for chrome://tracing
+int main(int argc, char* argv[]) {
+    setupHifiApplication("Trace Converter");
+
+    QCoreApplication app(argc, argv);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("High Fidelity Trace Recording Converter");
+    parser.addHelpOption();
+    parser.addPositionalArgument("recording", "The .hftrace file to convert.");
+    parser.addPositionalArgument("output", "The JSON file to write, gzipped if it ends in .gz. Defaults to the recording "
+                                           "name with a .json.gz extension.", "[output]");
+    parser.process(app);
+
+    const QStringList arguments = parser.positionalArguments();
+    if (arguments.isEmpty() || arguments.size() > 2) {
+        parser.showHelp(1);
+    }
+
+    QString recording = arguments[0];
+    QString output;
+    if (arguments.size() > 1) {
+        output = arguments[1];
+    } else {
+        QFileInfo recordingInfo(recording);
+        output = recordingInfo.dir().filePath(recordingInfo.completeBaseName() + ".json.gz");
+    }
+
+    if (!tracing::TraceRecorder::convertToJson(recording, output)) {
+        return 2;
+    }
+    qInfo() << "Wrote" << output;
+    return 0;
+}